@@ -10,36 +10,47 @@
  */
 
 import LiveDash from '../../src/services/livedash.js';
-import { getPreferences } from '../../src/data/kv-preferences.js';
-import { renderFullScreenBMP } from '../../src/services/ccdash-renderer.js';
+import {
+  decodeConfigToken,
+  loadSmartCommuteSettings,
+  buildDevicePreferences,
+  buildDeviceFrameData,
+  deviceTimetableSlice,
+  renderDeviceBMP,
+  renderDevicePage
+} from '../../src/services/device-frame.js';
+import {
+  deviceIdForToken,
+  expectedNextFetch,
+  noteDeviceFetch,
+  getPrerenderedFrame,
+  minuteOf
+} from '../../src/services/frame-prerender.js';
+import { SLICE_HEADER } from '../../src/services/timetable-slice.js';
+import { ZONE_HASH_HEADER, encodeZoneHashes } from '../../src/services/zone-sync.js';
+import { FRESH_HASH_HEADER } from '../../src/services/fresh-check.js';
+import { MODEL_VERSION_HEADER, answerModelRequest } from '../../src/services/model-patch.js';
+import { PAGES_HEADER, PAGE_HASH_HEADER, encodePageList } from '../../src/services/device-pages.js';
 
 /**
- * Decode config token back to config object
+ * Send a full-screen BMP (+ timetable slice) to the device
  */
-function decodeConfigToken(token) {
-  try {
-    const json = Buffer.from(token, 'base64url').toString('utf8');
-    const minified = JSON.parse(json);
-    
-    return {
-      addresses: minified.a || {},
-      journey: {
-        transitRoute: minified.j || {},
-        arrivalTime: minified.t || '09:00',
-        coffeeEnabled: minified.c !== false
-      },
-      locations: minified.l || {},
-      state: minified.s || 'VIC',
-      api: {
-        key: minified.k || ''
-      },
-      cafe: minified.cf || null,
-      apiMode: minified.m || 'cached'
-    };
-  } catch (error) {
-    console.error('Error decoding config token:', error);
-    return null;
-  }
+function sendBmp(res, { bmp, slice, zoneHashes, freshHashes }, source) {
+  res.setHeader('Content-Type', 'application/octet-stream');
+  res.setHeader('Content-Length', bmp.length);
+  res.setHeader('Cache-Control', 'public, max-age=20');
+  res.setHeader('X-Frame-Source', source);
+  // Offline timetable slice - lets CCFirm keep advancing the journey
+  // from scheduled departures if later fetches fail
+  if (slice) res.setHeader(SLICE_HEADER, slice);
+  // Zones in this frame, and their clock-independent hashes - CCFirm sends
+  // the latter back in its UDP freshness check (fresh-check.js) to learn
+  // whether the next fetch is needed
+  if (zoneHashes) res.setHeader(ZONE_HASH_HEADER, encodeZoneHashes(zoneHashes));
+  if (freshHashes) res.setHeader(FRESH_HASH_HEADER, encodeZoneHashes(freshHashes));
+  // Pages the button flips through - CCFirm prefetches them (device-pages.js)
+  res.setHeader(PAGES_HEADER, encodePageList());
+  return res.send(bmp);
 }
 
 export default async function handler(req, res) {
@@ -69,58 +80,69 @@ export default async function handler(req, res) {
     const format = req.query.format || 'image';
     const device = req.query.device || 'trmnl-og';
 
-    // Try to load SmartCommute settings from KV (user's saved preferences)
-    let kvPrefs = null;
-    try {
-      kvPrefs = await getPreferences();
-    } catch (e) {
-      console.log('[device] KV preferences not available, using defaults');
+    // BMP for CCFirm: serve the pre-rendered frame for this minute if there
+    // is one, and register the device's next fetch for pre-rendering
+    if (format === 'bmp') {
+      const now = Date.now();
+      // Awaited alongside the frame lookup: Vercel may freeze the function
+      // once the response is sent, and the cron only finds devices in KV
+      const [prerendered] = await Promise.all([
+        getPrerenderedFrame(token, device, minuteOf(now)),
+        noteDeviceFetch(token, { device, nextFetchAt: expectedNextFetch(req, now), now })
+          .catch(error => console.error(`[prerender] Could not share device: ${error.message}`))
+      ]);
+      if (prerendered) {
+        return sendBmp(res, prerendered, `prerendered-${prerendered.source}`);
+      }
     }
 
-    // Extract SmartCommute settings from KV preferences
-    const scSettings = kvPrefs?.smartcommute || {};
-
-    // Transform config to SmartCommute preferences format
+    const scSettings = await loadSmartCommuteSettings();
     const apiKey = config.api?.key;
     console.log(`[device] API key from token: ${apiKey ? apiKey.substring(0,8)+'...' : 'null'}`);
 
-    const preferences = {
-      homeAddress: config.addresses?.home,
-      homeLocation: config.locations?.home,
-      workAddress: config.addresses?.work,
-      workLocation: config.locations?.work,
-      cafeLocation: config.cafe || config.locations?.cafe,
-      coffeeAddress: config.addresses?.cafe,
-      targetArrival: config.journey?.arrivalTime,
-      arrivalTime: config.journey?.arrivalTime,
-      coffeeEnabled: config.journey?.coffeeEnabled,
-      preferCoffee: config.journey?.coffeeEnabled,
-      preferredRoute: config.journey?.transitRoute,
-      apiMode: config.apiMode,
-      state: config.state || 'VIC',
-      // SmartCommute settings from KV (or defaults)
-      homeToStop: scSettings.homeToStop || 5,
-      homeToCafe: scSettings.homeToCafe || 5,
-      cafeToTransit: scSettings.cafeToStop || 2,
-      walkToWork: scSettings.stopToWork || 5,
-      cafeDuration: scSettings.coffeeDuration || 5,
-      coffeeBuffer: scSettings.bufferTime || 3,
-      coffeePosition: scSettings.coffeePosition || 'auto',
-      preferTrain: scSettings.preferTrain !== false,
-      preferTram: scSettings.preferTram !== false,
-      preferBus: scSettings.preferBus || false,
-      minimizeWalking: scSettings.minimizeWalking !== false,
-      walkingSpeed: scSettings.walkingSpeed || 80,
-      maxWalkingDistance: scSettings.maxWalk || 600,
-      // API keys in format expected by SmartCommute engine
-      api: {
-        key: apiKey
-      },
-      transitApiKey: apiKey
-    };
-    
-    console.log(`[device] preferences.api.key: ${preferences.api?.key ? preferences.api.key.substring(0,8)+'...' : 'null'}`);
-    console.log(`[device] preferences.transitApiKey: ${preferences.transitApiKey ? preferences.transitApiKey.substring(0,8)+'...' : 'null'}`);
+    if (format === 'bmp') {
+      const frame = await renderDeviceBMP(config, { device, scSettings });
+      res.setHeader('X-Render-Ms', frame.renderMs);
+      return sendBmp(res, frame, 'live');
+    }
+
+    // Data model for CCFirm's local renderer (CC_LOCAL_RENDER): a patch
+    // against the model version the device reports holding, or a full model
+    if (format === 'model') {
+      const have = Number.parseInt(req.query.mv ?? req.headers[MODEL_VERSION_HEADER.toLowerCase()] ?? '0', 10) || 0;
+      const { dashboardData, journeyData } = await buildDeviceFrameData(config, { device, scSettings });
+      const answer = await answerModelRequest(deviceIdForToken(token), have, dashboardData);
+      const slice = deviceTimetableSlice(dashboardData, journeyData);
+      res.setHeader('Content-Type', 'application/octet-stream');
+      res.setHeader('Cache-Control', 'no-cache, no-store');
+      res.setHeader('Content-Length', answer.body.length);
+      res.setHeader(MODEL_VERSION_HEADER, answer.version);
+      res.setHeader(PAGES_HEADER, encodePageList());
+      if (slice) res.setHeader(SLICE_HEADER, slice);
+      return res.send(answer.body);
+    }
+
+    // One device page as a full-screen CCZF frame for CCFirm's flash page
+    // cache; 304 if the device's cached copy (&ph=<hash>) is still current
+    if (format === 'page') {
+      const page = await renderDevicePage(config, String(req.query.page || ''), { device, scSettings });
+      if (!page) {
+        return res.status(404).json({ error: 'Unknown page' });
+      }
+      res.setHeader('Cache-Control', 'no-cache, no-store');
+      res.setHeader(PAGE_HASH_HEADER, page.hash);
+      res.setHeader('X-Page-Max-Age', page.maxAge);
+      res.setHeader('X-Render-Ms', page.renderMs);
+      if (req.query.ph === page.hash) {
+        return res.status(304).end();
+      }
+      res.setHeader('Content-Type', 'application/octet-stream');
+      res.setHeader('Content-Length', page.frame.length);
+      return res.send(page.frame);
+    }
+
+    // Transform config to SmartCommute preferences format
+    const preferences = buildDevicePreferences(config, scSettings);
 
     // Initialize LiveDash with the config
     const liveDash = new LiveDash();
@@ -154,68 +176,16 @@ export default async function handler(req, res) {
       return res.json(result);
     }
 
-    // Render dashboard image
-    if (format === 'bmp') {
-      // BMP format for e-ink devices - use ccdash-renderer
-      const journeyData = await liveDash.smartCommute.getJourneyRecommendation({});
-
-      console.log('[device] journeyData legs count:', journeyData?.legs?.length || 0);
-      console.log('[device] journeyData status:', journeyData?.status);
-
-      // Build dashboard data in format expected by ccdash-renderer
-      const localTime = liveDash.smartCommute.getLocalTime();
-      const days = ['Sunday', 'Monday', 'Tuesday', 'Wednesday', 'Thursday', 'Friday', 'Saturday'];
-      const months = ['January', 'February', 'March', 'April', 'May', 'June', 'July', 'August', 'September', 'October', 'November', 'December'];
-
-      const hours24 = localTime.getHours();
-      const hours12 = hours24 % 12 || 12;
-      const minutes = localTime.getMinutes().toString().padStart(2, '0');
-
-      // Map journey legs or provide fallback demo legs
-      let journeyLegs = (journeyData?.legs || []).map((leg, idx) => ({
-        number: idx + 1,
-        type: leg.type || 'walk',
-        title: leg.title || leg.description || '',
-        subtitle: leg.subtitle || '',
-        minutes: leg.duration || leg.minutes || 0,
-        state: leg.status === 'delayed' ? 'delayed' :
-               leg.status === 'skipped' ? 'skip' : 'normal',
-        canGet: leg.type === 'coffee' ? leg.canGet !== false : undefined
-      }));
-
-      // Fallback demo legs if no data available
-      if (journeyLegs.length === 0) {
-        console.log('[device] No legs from engine, using fallback demo data');
-        journeyLegs = [
-          { number: 1, type: 'walk', title: 'Walk to tram stop', subtitle: 'South Yarra Station', minutes: 5 },
-          { number: 2, type: 'tram', title: 'Tram 8 to Collins St', subtitle: 'Departs 8:15am', minutes: 12 },
-          { number: 3, type: 'coffee', title: 'Coffee at Norman', subtitle: 'Order ahead via app', minutes: 5, canGet: true },
-          { number: 4, type: 'walk', title: 'Walk to office', subtitle: '123 Example Street', minutes: 8 }
-        ];
-      }
-
-      const dashboardData = {
-        location: preferences.homeAddress || 'Home',
-        current_time: `${hours12}:${minutes}`,
-        day: days[localTime.getDay()],
-        date: `${localTime.getDate()} ${months[localTime.getMonth()]}`,
-        temp: journeyData?.weather?.temp ?? '--',
-        condition: journeyData?.weather?.condition || 'N/A',
-        umbrella: journeyData?.weather?.umbrella || false,
-        status_type: journeyData?.status || 'normal',
-        arrive_by: preferences.arrivalTime || '09:00',
-        total_minutes: journeyData?.totalDuration || 30,
-        leave_in_minutes: journeyData?.leaveIn || null,
-        journey_legs: journeyLegs,
-        destination: preferences.workAddress || 'Work'
-      };
-
-      const bmpBuffer = renderFullScreenBMP(dashboardData);
-
+    // CCZF zone frames at the device's resolution (native Kindle client)
+    if (format === 'cczf') {
+      const { frames, zones, encodedBytes } = await liveDash.renderFrames({
+        fullRefresh: req.query.full === '1'
+      });
       res.setHeader('Content-Type', 'application/octet-stream');
-      res.setHeader('Content-Length', bmpBuffer.length);
-      res.setHeader('Cache-Control', 'public, max-age=20');
-      return res.send(bmpBuffer);
+      res.setHeader('Cache-Control', 'no-cache, no-store');
+      res.setHeader('X-Frame-Zones', zones.join(','));
+      res.setHeader('Content-Length', encodedBytes);
+      return res.send(Buffer.concat(frames));
     }
 
     // Default: return PNG image
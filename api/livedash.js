@@ -6,7 +6,7 @@
  * 
  * Query params:
  * - device: Device ID (trmnl-og, trmnl-mini, kindle-pw3, etc.)
- * - format: Output format (png, json, html)
+ * - format: Output format (png, json, html, cczf)
  * - refresh: Force refresh (true/false)
  * 
  * Copyright (c) 2026 Angus Bergman
@@ -172,6 +172,21 @@ export default async function handler(req, res) {
       return res.send(html);
     }
     
+    // CCZF zone frames for the native Kindle client (firmware/kindle/native)
+    if (format === 'cczf') {
+      const { frames, zones, rawBytes, encodedBytes } = await dash.renderFrames({
+        forceRefresh: refresh === 'true',
+        fullRefresh: req.query.full === '1'
+      });
+      res.setHeader('Content-Type', 'application/octet-stream');
+      res.setHeader('Cache-Control', 'no-cache, no-store');
+      res.setHeader('X-Device', device);
+      res.setHeader('X-Frame-Zones', zones.join(','));
+      res.setHeader('X-Frame-Raw-Bytes', rawBytes.toString());
+      res.setHeader('Content-Length', encodedBytes);
+      return res.send(Buffer.concat(frames));
+    }
+    
     // PNG format (default)
     const pngBuffer = await dash.render({
       forceRefresh: refresh === 'true'
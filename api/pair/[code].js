@@ -8,11 +8,16 @@
  * Uses Vercel KV for persistent storage across serverless invocations.
  * Fallback to in-memory for local development.
  *
+ * The paired reply also carries a per-device TLS-PSK identity and key (and
+ * the PSK endpoint when one is configured) - see src/utils/device-psk.js.
+ *
  * Copyright (c) 2026 Angus Bergman
  * SPDX-License-Identifier: AGPL-3.0-or-later
  */
 
 import { kv } from '@vercel/kv';
+import { provisionDevicePsk } from '../../src/utils/device-psk.js';
+import { provisionFreshEndpoint } from '../../src/services/fresh-check.js';
 
 // Pairing codes expire after 10 minutes
 const CODE_EXPIRY_MS = 10 * 60 * 1000;
@@ -96,18 +101,21 @@ export default async function handler(req, res) {
     if (pairingData.webhookUrl) {
       // Config is ready! Return it to device
       const webhookUrl = pairingData.webhookUrl;
+      const paired = {
+        success: true,
+        status: 'paired',
+        webhookUrl: webhookUrl,
+        ...provisionDevicePsk(req, webhookUrl),
+        ...provisionFreshEndpoint(req, webhookUrl),
+        message: 'Device paired successfully!'
+      };
 
       // Delete the pairing code after successful retrieval
       await deletePairingData(normalizedCode);
 
       console.log(`[pair] Device retrieved config for code ${normalizedCode}`);
 
-      return res.json({
-        success: true,
-        status: 'paired',
-        webhookUrl: webhookUrl,
-        message: 'Device paired successfully!'
-      });
+      return res.json(paired);
     }
 
     // Code registered but no config yet
@@ -0,0 +1,52 @@
+/**
+ * /api/prerender - Speculative frame pre-render (per-minute cron)
+ * Part of the Commute Compute System™
+ *
+ * Invoked near the start of each minute by a Vercel cron, which is opt-in:
+ * Hobby plans cannot run one every minute, so vercel.json ships without it
+ * (INSTALL.md, "Frame Pre-render").
+ * Waits until a few seconds before the next minute boundary, then renders
+ * that minute's frame for every recently active device (see
+ * src/services/frame-prerender.js) so /api/device/[token] can serve it
+ * without rendering.
+ *
+ * GET /api/prerender?stats=1  - frame and zone cache hit rates, no rendering
+ * GET /api/prerender?now=1    - render the next minute immediately
+ *
+ * If CRON_SECRET is set, requests must carry it as a Bearer token
+ * (Vercel cron does this automatically).
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+import {
+  prerenderBeforeBoundary,
+  prerenderMinute,
+  getPrerenderStats
+} from '../src/services/frame-prerender.js';
+import { getZoneCacheStats } from '../src/services/zone-render-cache.js';
+
+export default async function handler(req, res) {
+  res.setHeader('Cache-Control', 'no-store');
+
+  if (req.query.stats === '1') {
+    return res.json({ status: 'ok', prerender: getPrerenderStats(), zoneCache: getZoneCacheStats() });
+  }
+
+  const secret = process.env.CRON_SECRET;
+  if (secret && req.headers.authorization !== `Bearer ${secret}`) {
+    return res.status(401).json({ error: 'Unauthorized' });
+  }
+
+  try {
+    const result = req.query.now === '1'
+      ? await prerenderMinute()
+      : await prerenderBeforeBoundary();
+    res.json({ status: 'ok', result, prerender: getPrerenderStats() });
+  } catch (error) {
+    console.error('[prerender] Error:', error);
+    res.status(500).json({ status: 'error', error: error.message });
+  }
+}
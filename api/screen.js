@@ -15,6 +15,8 @@ import SmartCommute from '../src/engines/smart-commute.js';
 import { getTransitApiKey, getPreferences, getUserState } from '../src/data/kv-preferences.js';
 import { renderFullDashboard, renderFullScreenBMP } from '../src/services/ccdash-renderer.js';
 import { getScenario, getScenarioNames } from '../src/services/journey-scenarios.js';
+import { attachTimetableSlice } from '../src/services/timetable-slice.js';
+import { bmpToZoneFrames } from '../src/services/frame-codec.js';
 
 // Engine cache - re-initialized when preferences change
 let journeyEngine = null;
@@ -669,6 +671,23 @@ function generateRandomJourney(targetLegs = null) {
   };
 }
 
+/**
+ * Send the dashboard as compressed zone frames (CCZF) for BLE frame push
+ * from the setup wizard or tools/ble_frame_push.py
+ */
+function sendZoneFrames(res, dashboardData) {
+  const bmp = renderFullScreenBMP(dashboardData);
+  const { frames, rawBytes, encodedBytes } = bmpToZoneFrames(bmp, { fullRefresh: true });
+  const body = Buffer.concat(frames);
+
+  res.setHeader('Content-Type', 'application/octet-stream');
+  res.setHeader('Cache-Control', 'no-cache, no-store');
+  res.setHeader('X-Frame-Zones', frames.length.toString());
+  res.setHeader('X-Frame-Raw-Bytes', rawBytes.toString());
+  res.setHeader('Content-Length', encodedBytes);
+  return res.status(200).send(body);
+}
+
 /**
  * Handle random journey mode - dynamic SmartJourney simulation
  */
@@ -755,6 +774,10 @@ async function handleDemoMode(req, res, scenarioName) {
       destination: scenario.destination || 'WORK'
     };
 
+    if ((req.query?.format || '').toLowerCase() === 'cczf') {
+      return sendZoneFrames(res, dashboardData);
+    }
+
     // Render to PNG
     const png = renderFullDashboard(dashboardData);
 
@@ -959,9 +982,24 @@ export default async function handler(req, res) {
       res.setHeader('Cache-Control', 'public, max-age=20');
       res.setHeader('X-Dashboard-Timestamp', now.toISOString());
       res.setHeader('Content-Length', bmp.length);
+
+      // Offline timetable slice for CCFirm (not for simulator previews -
+      // simulated times/statuses must never be cached on a real device)
+      if (!hasSimOverrides) {
+        attachTimetableSlice(res, {
+          legs: journeyLegs,
+          transitData,
+          arriveBy: displayArrival,
+          live: !!transitApiKey
+        });
+      }
       return res.status(200).send(bmp);
     }
 
+    if (format === 'cczf') {
+      return sendZoneFrames(res, dashboardData);
+    }
+
     // Render to PNG (V12 Renderer)
     const png = renderFullDashboard(dashboardData);
 
@@ -10,6 +10,7 @@
  */
 
 import { getTransitApiKey, getGoogleApiKey, getStorageStatus } from '../src/data/kv-preferences.js';
+import { getZoneCacheStats } from '../src/services/zone-render-cache.js';
 
 export default async function handler(req, res) {
   res.setHeader('Access-Control-Allow-Origin', '*');
@@ -54,6 +55,8 @@ export default async function handler(req, res) {
         hasTransitKey: kvStatus.hasTransitKey,
         hasGoogleKey: kvStatus.hasGoogleKey
       },
+      // Zone render cache hit rates for this instance
+      zoneCache: getZoneCacheStats(),
       environment: 'vercel-serverless'
     });
   } catch (error) {
@@ -17,7 +17,7 @@
 import { createHash } from 'crypto';
 import { getDepartures, getDisruptions, getWeather } from '../../src/services/opendata-client.js';
 import SmartCommute from '../../src/engines/smart-commute.js';
-import { renderSingleZone, renderFullScreen, ZONES } from '../../src/services/ccdash-renderer.js';
+import { renderSingleZone, renderFullScreen, warmZoneRenders, shareZoneRenders, ZONES } from '../../src/services/ccdash-renderer.js';
 import { getScenario } from '../../src/services/journey-scenarios.js';
 import { createCanvas } from '@napi-rs/canvas';
 
@@ -435,6 +435,8 @@ export default async function handler(req, res) {
     
     // Render zone to BMP (composite or single)
     let bmpBuffer;
+    const renderIds = isComposite ? (zone.subzones || []).filter(sz => ZONES[sz]) : [id];
+    await warmZoneRenders(dashboardData, renderIds);
     
     if (isComposite) {
       if (id === 'divider') {
@@ -475,6 +477,7 @@ export default async function handler(req, res) {
     if (!bmpBuffer) {
       return res.status(500).json({ error: 'Zone render failed' });
     }
+    await shareZoneRenders();
     
     // Generate ETag from content hash
     const etag = generateETag(bmpBuffer);
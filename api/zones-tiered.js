@@ -266,8 +266,11 @@ export default async function handler(req, res) {
       });
     }
     
-    // Render zones
+    // Render zones (reusing renders other devices/instances already made)
     let result = {};
+    await ccdashRenderer.warmZoneRenders(dashboardData, tierParam === 'all'
+      ? undefined
+      : ccdashRenderer.getZonesForTier(parseInt(tierParam)));
     if (tierParam === 'all') {
       // Render all zones
       result = ccdashRenderer.renderZones(dashboardData, forceAll);
@@ -279,6 +282,8 @@ export default async function handler(req, res) {
       }
     }
 
+    await ccdashRenderer.shareZoneRenders();
+
     // Add tier intervals to response
     result.intervals = TIER_CONFIG;
     result.tier = tierParam;
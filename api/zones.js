@@ -10,6 +10,8 @@
  * Query params:
  * - force=1: Return all zones (full refresh)
  * - format=json: Return zone metadata only (no BMP data)
+ * - format=cczf (or an X-Zone-Hashes header): only the zones whose hash the
+ *   device did not send, as CCZF frames - see src/services/zone-sync.js
  * - demo=<scenario>: Use demo scenario (normal, delay-skip-coffee, multi-delay, disruption, etc.)
  * - random=1: Generate random journey for testing
  * 
@@ -21,7 +23,8 @@
 import { getDepartures, getDisruptions, getWeather } from '../src/services/opendata-client.js';
 import SmartCommute from '../src/engines/smart-commute.js';
 import { getTransitApiKey } from '../src/data/kv-preferences.js';
-import { renderZones, clearCache, ZONES } from '../src/services/ccdash-renderer.js';
+import { renderZones, renderZoneDelta, clearCache, warmZoneRenders, shareZoneRenders, ZONES } from '../src/services/ccdash-renderer.js';
+import { ZONE_HASH_HEADER, parseZoneHashes, wantsZoneDelta, sendZoneDelta } from '../src/services/zone-sync.js';
 import { getScenario, getScenarioNames } from '../src/services/journey-scenarios.js';
 import { generateRandomJourney } from '../src/services/random-journey.js';
 import PreferencesManager from '../src/data/preferences-manager.js';
@@ -365,6 +368,8 @@ export default async function handler(req, res) {
     const formatJson = req.query?.format === 'json';
     const metadataOnly = req.query?.metadata === '1';
     const demoScenario = req.query?.demo;
+    const delta = wantsZoneDelta(req);
+    const deviceHashes = parseZoneHashes(req.headers?.[ZONE_HASH_HEADER.toLowerCase()]);
     
     // Ultra-lightweight metadata response for ESP32 (tiny JSON)
     if (metadataOnly) {
@@ -380,8 +385,8 @@ export default async function handler(req, res) {
       });
     }
     
-    // Clear cache if forced
-    if (forceAll) clearCache();
+    // Clear cache if forced (delta requests carry their own state)
+    if (forceAll && !delta) clearCache();
     
     // Handle demo mode
     if (demoScenario) {
@@ -406,6 +411,10 @@ export default async function handler(req, res) {
         });
       }
       
+      if (delta) {
+        return sendZoneDelta(res, renderZoneDelta(dashboardData, deviceHashes, forceAll));
+      }
+      
       const zonesResult = renderZones(dashboardData, true); // Always force for demo
       
       res.setHeader('Content-Type', 'application/json');
@@ -559,8 +568,16 @@ export default async function handler(req, res) {
       });
     }
     
-    // Render zones
+    // Render zones (reusing renders other devices/instances already made)
+    await warmZoneRenders(dashboardData);
+    if (delta) {
+      const zoneDelta = renderZoneDelta(dashboardData, deviceHashes, forceAll);
+      await shareZoneRenders();
+      res.setHeader('X-Dashboard-Timestamp', now.toISOString());
+      return sendZoneDelta(res, zoneDelta);
+    }
     const zonesResult = renderZones(dashboardData, forceAll);
+    await shareZoneRenders();
     
     // Return zone data
     res.setHeader('Content-Type', 'application/json');
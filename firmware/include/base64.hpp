@@ -18,49 +18,83 @@
 static const char base64_chars[] = 
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+// base64_lut[] classes above the 6-bit symbol values
+#define BASE64_PAD    0x40    // '='
+#define BASE64_SPACE  0x41    // '\n', '\r', ' ', '\t'
+#define BASE64_BAD    0xFF
+
+// decode_base64_inplace() errors
+#define BASE64_ERR_CHAR     -1    // Not in the alphabet, not padding or whitespace
+#define BASE64_ERR_PADDING  -2    // Missing, misplaced or surplus '='
+
+#define B64P BASE64_PAD
+#define B64S BASE64_SPACE
+#define B64X BASE64_BAD
+
+/**
+ * Symbol value (0-63) or class of every byte, so the decoders do one load
+ * per character instead of a chain of range compares. Bytes >= 0x80 are
+ * BASE64_BAD; a value with either of the top two bits set is not a symbol.
+ */
+static constexpr uint8_t base64_lut[256] = {
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64S, B64S, B64X, B64X, B64S, B64X, B64X,
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+    B64S, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,   62, B64X, B64X, B64X,   63,
+      52,   53,   54,   55,   56,   57,   58,   59,   60,   61, B64X, B64X, B64X, B64P, B64X, B64X,
+    B64X,    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
+      15,   16,   17,   18,   19,   20,   21,   22,   23,   24,   25, B64X, B64X, B64X, B64X, B64X,
+    B64X,   26,   27,   28,   29,   30,   31,   32,   33,   34,   35,   36,   37,   38,   39,   40,
+      41,   42,   43,   44,   45,   46,   47,   48,   49,   50,   51, B64X, B64X, B64X, B64X, B64X,
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X,
+    B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X, B64X
+};
+
+#undef B64P
+#undef B64S
+#undef B64X
+
 static inline int base64_char_value(char c) {
-    if (c >= 'A' && c <= 'Z') return c - 'A';
-    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
-    if (c >= '0' && c <= '9') return c - '0' + 52;
-    if (c == '+') return 62;
-    if (c == '/') return 63;
-    return -1;
+    uint8_t v = base64_lut[(uint8_t)c];
+    return v < 64 ? v : -1;
 }
 
 /**
  * Calculate decoded length from base64 string
+ * Exact count under the same rules as decode_base64() (whitespace and
+ * invalid characters skipped, stop at '='), so it is safe to size or
+ * bound the output buffer with it.
  */
 static inline size_t decode_base64_length(const unsigned char* input, size_t inputLen) {
-    if (inputLen == 0) return 0;
-    
-    size_t padding = 0;
-    if (inputLen >= 1 && input[inputLen - 1] == '=') padding++;
-    if (inputLen >= 2 && input[inputLen - 2] == '=') padding++;
-    
-    return (inputLen * 3) / 4 - padding;
+    size_t symbols = 0;
+    for (size_t i = 0; i < inputLen; i++) {
+        uint8_t v = base64_lut[input[i]];
+        if (v == BASE64_PAD) break;
+        symbols += v < 64;
+    }
+    return (symbols * 6) / 8;
 }
 
 /**
  * Decode base64 string to binary
+ * Lenient: whitespace and invalid characters are skipped, '=' ends the input.
  */
 static inline size_t decode_base64(const unsigned char* input, size_t inputLen, unsigned char* output) {
-    if (inputLen == 0) return 0;
-    
     size_t outputLen = 0;
     uint32_t buffer = 0;
     int bits = 0;
     
     for (size_t i = 0; i < inputLen; i++) {
-        char c = input[i];
-        
-        // Skip whitespace
-        if (c == '\n' || c == '\r' || c == ' ' || c == '\t') continue;
-        
-        // Stop at padding
-        if (c == '=') break;
-        
-        int value = base64_char_value(c);
-        if (value < 0) continue;  // Invalid char, skip
+        uint8_t value = base64_lut[input[i]];
+        if (value >= 64) {
+            if (value == BASE64_PAD) break;     // Stop at padding
+            continue;                           // Whitespace or invalid, skip
+        }
         
         buffer = (buffer << 6) | value;
         bits += 6;
@@ -74,4 +108,74 @@ static inline size_t decode_base64(const unsigned char* input, size_t inputLen,
     return outputLen;
 }
 
+/**
+ * Decode base64 text over itself
+ * The output (3 bytes per 4 symbols) never overtakes the input, so a zone
+ * payload can be decoded where it was received and the BMP needs no buffer
+ * of its own. Four symbols per step while the input is plain base64; a
+ * quad containing whitespace or '=' goes through one character at a time.
+ *
+ * Strict, unlike decode_base64(): whitespace is skipped, anything else
+ * outside the alphabet is an error, and the symbol count must be a
+ * multiple of 4 once "=" / "==" padding is counted, with only whitespace
+ * after it.
+ *
+ * @returns decoded length, or BASE64_ERR_* (buf contents then undefined)
+ */
+static inline long decode_base64_inplace(unsigned char* buf, size_t len) {
+    size_t r = 0, w = 0;
+    uint32_t acc = 0;
+    int n = 0;                  // Symbols in acc
+    
+    while (r < len) {
+        if (n == 0 && len - r >= 4) {
+            uint32_t a = base64_lut[buf[r]], b = base64_lut[buf[r + 1]];
+            uint32_t c = base64_lut[buf[r + 2]], d = base64_lut[buf[r + 3]];
+            if (((a | b | c | d) & 0xC0) == 0) {
+                uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+                buf[w] = (unsigned char)(v >> 16);
+                buf[w + 1] = (unsigned char)(v >> 8);
+                buf[w + 2] = (unsigned char)v;
+                r += 4;
+                w += 3;
+                continue;
+            }
+        }
+        
+        uint8_t value = base64_lut[buf[r++]];
+        if (value < 64) {
+            acc = (acc << 6) | value;
+            if (++n == 4) {
+                buf[w] = (unsigned char)(acc >> 16);
+                buf[w + 1] = (unsigned char)(acc >> 8);
+                buf[w + 2] = (unsigned char)acc;
+                w += 3;
+                acc = 0;
+                n = 0;
+            }
+            continue;
+        }
+        if (value == BASE64_SPACE) continue;
+        if (value != BASE64_PAD) return BASE64_ERR_CHAR;
+        
+        // Padding: 2 symbols + "==" or 3 symbols + "=", then the end
+        int pads = 1;
+        while (r < len) {
+            value = base64_lut[buf[r++]];
+            if (value == BASE64_PAD) pads++;
+            else if (value != BASE64_SPACE) return BASE64_ERR_PADDING;
+        }
+        if (n < 2 || pads != 4 - n) return BASE64_ERR_PADDING;
+        if (n == 2) {
+            buf[w++] = (unsigned char)(acc >> 4);
+        } else {
+            buf[w++] = (unsigned char)(acc >> 10);
+            buf[w++] = (unsigned char)(acc >> 2);
+        }
+        return (long)w;
+    }
+    
+    return n == 0 ? (long)w : BASE64_ERR_PADDING;
+}
+
 #endif // BASE64_HPP
@@ -0,0 +1,282 @@
+/**
+ * Streaming 1-bit BMP decoder
+ * Part of the Commute Compute System™
+ *
+ * Parses a 1-bit uncompressed BMP incrementally (any chunk size) and emits
+ * its rows to a RowSink, so a full-screen image never has to be buffered
+ * before it is validated. All header fields are read byte-wise (no
+ * unaligned casts) and checked before any pixel data is accepted:
+ *   - pixel offset comes from the header, not a hard-coded 62
+ *   - bottom-up and top-down (negative height) images are both handled
+ *   - palettes with index 0 = white are normalised to bit = 1 white
+ *
+ * bmp_image_check() applies the same checks to a BMP that is already fully
+ * in memory and also confirms every pixel row is present, for callers
+ * that download a zone into a buffer before drawing it.
+ *
+ * Also writes the 62-byte top-down header used for the device's shadow
+ * framebuffer so bb_epaper's loadBMP() can draw it directly.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef BMP_STREAM_H
+#define BMP_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "row-sink.h"
+
+#define BMP_HEADER_MAX      256   // File header + DIB header + palette we accept
+#define BMP_SHADOW_HEADER   62    // 14 file + 40 DIB + 2 x 4 palette
+
+enum BmpStreamResult {
+    BMP_STREAM_MORE = 0,          // Need more bytes
+    BMP_STREAM_DONE = 1,          // All rows delivered
+    BMP_STREAM_ERR_SIGNATURE = -1,
+    BMP_STREAM_ERR_HEADER = -2,
+    BMP_STREAM_ERR_FORMAT = -3,   // Not 1-bit / compressed / too wide
+    BMP_STREAM_ERR_SINK = -4,
+    BMP_STREAM_ERR_TRUNCATED = -5 // Buffer ends before the last pixel row
+};
+
+// Validated header fields
+struct BmpInfo {
+    uint32_t pixelOffset;
+    int32_t width;
+    int32_t height;               // Always positive
+    bool topDown;
+    bool invert;                  // Palette index 0 is the light colour
+    uint32_t stride;              // Bytes per row incl. padding
+};
+
+struct BmpStream {
+    const RowSink* sink;
+    int originX, originY;
+    uint8_t header[BMP_HEADER_MAX];
+    uint32_t headerLen;
+    uint32_t pixelOffset;
+    uint32_t consumed;            // Total bytes seen
+    int32_t width;
+    int32_t height;
+    bool topDown;
+    bool invert;                  // Palette index 0 is the light colour
+    uint32_t stride;              // Bytes per row incl. padding
+    uint8_t row[ROW_SINK_MAX_WIDTH / 8 + 4];
+    uint32_t rowPos;
+    int32_t rowIndex;             // Rows completed (file order)
+    int state;                    // 0 header, 1 palette/gap, 2 pixels, 3 done, <0 error
+};
+
+static inline uint16_t bmp_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t bmp_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void bmp_put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void bmp_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static inline void bmp_stream_init(BmpStream* s, const RowSink* sink, int x, int y) {
+    memset(s, 0, sizeof(*s));
+    s->sink = sink;
+    s->originX = x;
+    s->originY = y;
+}
+
+/**
+ * Validate the first len bytes of a BMP as a 1-bit uncompressed header.
+ * Returns 1 when parsed, 0 if more header bytes are needed, or an error.
+ */
+static inline int bmp_parse_header(const uint8_t* h, size_t len, BmpInfo* info) {
+    if (len < 2) return 0;
+    if (h[0] != 'B' || h[1] != 'M') return BMP_STREAM_ERR_SIGNATURE;
+    if (len < 54) return 0;
+
+    uint32_t pixelOffset = bmp_u32(h + 10);
+    uint32_t dibSize = bmp_u32(h + 14);
+    // dibSize is bounded first so 14 + dibSize + 8 cannot wrap
+    if (dibSize < 40 || dibSize > BMP_HEADER_MAX - 22 ||
+        pixelOffset > BMP_HEADER_MAX || pixelOffset < 14 + dibSize + 8) {
+        return BMP_STREAM_ERR_HEADER;
+    }
+    if (len < 14 + dibSize + 8) return 0;
+
+    int32_t width = (int32_t)bmp_u32(h + 18);
+    int32_t height = (int32_t)bmp_u32(h + 22);
+    uint16_t planes = bmp_u16(h + 26);
+    uint16_t bpp = bmp_u16(h + 28);
+    uint32_t compression = bmp_u32(h + 30);
+
+    if (planes != 1 || bpp != 1 || compression != 0) return BMP_STREAM_ERR_FORMAT;
+    if (width <= 0 || width > ROW_SINK_MAX_WIDTH || height == 0 || height == INT32_MIN) {
+        return BMP_STREAM_ERR_FORMAT;
+    }
+
+    info->pixelOffset = pixelOffset;
+    info->width = width;
+    info->topDown = height < 0;
+    info->height = height < 0 ? -height : height;
+    info->stride = (((uint32_t)width + 31) / 32) * 4;
+
+    // Palette: BGRA entries right after the DIB header
+    const uint8_t* pal = h + 14 + dibSize;
+    int lum0 = pal[0] + pal[1] + pal[2];
+    int lum1 = pal[4] + pal[5] + pal[6];
+    info->invert = lum0 > lum1;
+    return 1;
+}
+
+static inline int bmp_stream_parse_header(BmpStream* s) {
+    BmpInfo info;
+    int r = bmp_parse_header(s->header, s->headerLen, &info);
+    if (r != 1) return r;
+    s->pixelOffset = info.pixelOffset;
+    s->width = info.width;
+    s->height = info.height;
+    s->topDown = info.topDown;
+    s->invert = info.invert;
+    s->stride = info.stride;
+    return 1;
+}
+
+/**
+ * Validate a BMP held entirely in buf: header checks as above, plus every
+ * pixel row must lie inside the buffer. Returns BMP_STREAM_DONE or an error.
+ */
+static inline int bmp_image_check(const uint8_t* buf, size_t len, BmpInfo* info) {
+    int r = bmp_parse_header(buf, len, info);
+    if (r == 0) return BMP_STREAM_ERR_TRUNCATED;
+    if (r < 0) return r;
+    uint64_t end = (uint64_t)info->pixelOffset + (uint64_t)info->stride * (uint32_t)info->height;
+    if (end > len) return BMP_STREAM_ERR_TRUNCATED;
+    return BMP_STREAM_DONE;
+}
+
+/**
+ * Pixel row y (0 = top) of a buffer accepted by bmp_image_check().
+ * Bits are as stored: 1 = white only when info->invert is false.
+ */
+static inline const uint8_t* bmp_image_row(const uint8_t* buf, const BmpInfo* info, int32_t y) {
+    int32_t fileRow = info->topDown ? y : info->height - 1 - y;
+    return buf + info->pixelOffset + (size_t)info->stride * (uint32_t)fileRow;
+}
+
+/**
+ * Feed the next chunk of the file. Returns BMP_STREAM_MORE until every row
+ * has been delivered, then BMP_STREAM_DONE; trailing bytes are ignored.
+ */
+static inline int bmp_stream_feed(BmpStream* s, const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        if (s->state < 0 || s->state == 3) return s->state < 0 ? s->state : BMP_STREAM_DONE;
+
+        if (s->state == 0 || s->state == 1) {
+            // Buffer header bytes until the header parses, then up to the pixel offset
+            uint32_t want = s->state == 1 ? s->pixelOffset : BMP_HEADER_MAX;
+            while (i < len && s->headerLen < want) {
+                s->header[s->headerLen++] = data[i++];
+                s->consumed++;
+                if (s->state == 0) {
+                    int r = bmp_stream_parse_header(s);
+                    if (r < 0) return s->state = r;
+                    if (r == 1) {
+                        s->state = 1;
+                        want = s->pixelOffset;
+                    }
+                }
+            }
+            if (s->state == 1 && s->headerLen >= s->pixelOffset) {
+                if (!s->sink->begin(s->sink->ctx, s->originX, s->originY, s->width, s->height)) {
+                    return s->state = BMP_STREAM_ERR_SINK;
+                }
+                s->state = 2;
+            }
+            continue;
+        }
+
+        // Pixel rows
+        size_t take = s->stride - s->rowPos;
+        if (take > len - i) take = len - i;
+        memcpy(s->row + s->rowPos, data + i, take);   // stride <= sizeof(row)
+        s->rowPos += take;
+        s->consumed += take;
+        i += take;
+
+        if (s->rowPos == s->stride) {
+            if (s->invert) {
+                uint32_t bytes = ((uint32_t)s->width + 7) / 8;
+                for (uint32_t b = 0; b < bytes; b++) s->row[b] = (uint8_t)~s->row[b];
+            }
+            int32_t fileRow = s->rowIndex;
+            int32_t y = s->originY + (s->topDown ? fileRow : s->height - 1 - fileRow);
+            if (!s->sink->row(s->sink->ctx, y, s->row, s->width)) {
+                s->sink->end(s->sink->ctx, false);
+                return s->state = BMP_STREAM_ERR_SINK;
+            }
+            s->rowPos = 0;
+            s->rowIndex++;
+            if (s->rowIndex == s->height) {
+                s->sink->end(s->sink->ctx, true);
+                s->state = 3;
+                return BMP_STREAM_DONE;
+            }
+        }
+    }
+    if (s->state == 3) return BMP_STREAM_DONE;
+    return s->state < 0 ? s->state : BMP_STREAM_MORE;
+}
+
+/**
+ * Total file size implied by the header (0 until the header is parsed)
+ */
+static inline uint32_t bmp_stream_expected_size(const BmpStream* s) {
+    if (s->state < 1) return 0;
+    return s->pixelOffset + s->stride * (uint32_t)s->height;
+}
+
+/**
+ * Write a top-down 1-bit BMP header (palette 0 = black, 1 = white) into buf
+ * and describe the pixel area that follows it as a FrameBuffer.
+ * Returns false if buf is too small for width x height.
+ */
+static inline bool bmp_shadow_init(uint8_t* buf, size_t bufSize, int width, int height, FrameBuffer* fb) {
+    uint32_t stride = (((uint32_t)width + 31) / 32) * 4;
+    uint32_t imageSize = stride * (uint32_t)height;
+    if (width <= 0 || height <= 0 || BMP_SHADOW_HEADER + imageSize > bufSize) return false;
+
+    memset(buf, 0, BMP_SHADOW_HEADER);
+    buf[0] = 'B'; buf[1] = 'M';
+    bmp_put_u32(buf + 2, BMP_SHADOW_HEADER + imageSize);
+    bmp_put_u32(buf + 10, BMP_SHADOW_HEADER);
+    bmp_put_u32(buf + 14, 40);
+    bmp_put_u32(buf + 18, (uint32_t)width);
+    bmp_put_u32(buf + 22, (uint32_t)(-height));   // Negative = top-down
+    bmp_put_u16(buf + 26, 1);
+    bmp_put_u16(buf + 28, 1);
+    bmp_put_u32(buf + 34, imageSize);
+    bmp_put_u32(buf + 38, 2835);
+    bmp_put_u32(buf + 42, 2835);
+    bmp_put_u32(buf + 46, 2);
+    bmp_put_u32(buf + 50, 2);
+    // Palette: index 0 black (0,0,0), index 1 white
+    buf[58] = 0xFF; buf[59] = 0xFF; buf[60] = 0xFF;
+
+    fb->pixels = buf + BMP_SHADOW_HEADER;
+    fb->width = width;
+    fb->height = height;
+    fb->stride = (int)stride;
+    memset(fb->pixels, 0xFF, imageSize);   // Start white
+    return true;
+}
+
+#endif // BMP_STREAM_H
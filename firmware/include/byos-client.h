@@ -0,0 +1,162 @@
+/**
+ * BYOS Client - TRMNL "bring your own server" protocol state
+ * Part of the Commute Compute System™
+ *
+ * The device side of the TRMNL BYOS protocol used by main-byos.cpp:
+ *   GET /api/setup    (ID: <mac>)                     -> api_key, friendly_id
+ *   GET /api/display  (ID, Access-Token, Refresh-Rate,
+ *                      Battery-Voltage, FW-Version, RSSI) -> image_url,
+ *                      filename, refresh_rate, update/reset_firmware
+ *
+ * The reply is parsed with json-scan.h. refresh_rate may arrive as a
+ * number or a string ("900") and is used as-is: the device wakes every
+ * refresh_rate seconds, so the time spent awake is taken off the sleep.
+ *
+ * The image is only downloaded when its key changes. The key is filename
+ * when the server sends one (hosted TRMNL signs image_url, so the URL
+ * changes every call), otherwise image_url. A hash of the last drawn key
+ * lives in RTC memory across deep sleep, together with the partial
+ * refresh count and the error streak.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef BYOS_CLIENT_H
+#define BYOS_CLIENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "json-scan.h"
+
+#define BYOS_URL_MAX             512
+#define BYOS_NAME_MAX            128
+#define BYOS_DEFAULT_REFRESH_S   900      // Used when the server sends none
+#define BYOS_MIN_REFRESH_S       5        // Guards against 0 / negative values
+#define BYOS_MAX_REFRESH_S       86400
+#define BYOS_MIN_SLEEP_S         5        // Floor when a cycle overruns refresh_rate
+#define BYOS_RETRY_BASE_S        30       // First retry after a failed cycle
+#define BYOS_CACHE_MAGIC         0x43434259  // "CCBY"
+
+enum ByosResult {
+    BYOS_OK = 0,
+    BYOS_ERR_JSON = -1,          // Not a display reply (no status / malformed)
+    BYOS_ERR_STATUS = -2,        // status != 0 (device unknown, server error)
+    BYOS_ERR_NO_IMAGE = -3       // status 0 but no image_url
+};
+
+struct ByosDisplay {
+    long status;
+    char imageUrl[BYOS_URL_MAX];
+    char filename[BYOS_NAME_MAX];
+    uint32_t refreshRateS;
+    bool updateFirmware;
+    bool resetFirmware;
+};
+
+// Kept in RTC memory (RTC_NOINIT_ATTR) across deep sleep
+struct ByosCache {
+    uint32_t magic;
+    uint32_t imageKeyHash;       // FNV-1a of the key last drawn
+    uint16_t imageKeyLen;
+    uint16_t partialCount;       // Partial refreshes since the last full one
+    uint16_t errorStreak;        // Consecutive failed cycles
+    uint32_t refreshRateS;       // Last refresh_rate from the server
+};
+
+static inline uint32_t byos_fnv1a(const char* s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/** Start over after power loss (RTC contents are garbage) */
+static inline void byos_cache_validate(ByosCache* c) {
+    if (c->magic == BYOS_CACHE_MAGIC) return;
+    memset(c, 0, sizeof(*c));
+    c->magic = BYOS_CACHE_MAGIC;
+    c->refreshRateS = BYOS_DEFAULT_REFRESH_S;
+}
+
+static inline uint32_t byos_clamp_refresh(long seconds) {
+    if (seconds < BYOS_MIN_REFRESH_S) return BYOS_MIN_REFRESH_S;
+    if (seconds > BYOS_MAX_REFRESH_S) return BYOS_MAX_REFRESH_S;
+    return (uint32_t)seconds;
+}
+
+/**
+ * Parse an /api/display reply. refreshRateS is filled in even when status
+ * is an error so the device still backs off at the server's pace.
+ */
+static inline int byos_parse_display(const char* json, size_t len, ByosDisplay* out) {
+    memset(out, 0, sizeof(*out));
+    out->refreshRateS = BYOS_DEFAULT_REFRESH_S;
+
+    long rate;
+    if (json_get_long(json, len, "refresh_rate", &rate)) out->refreshRateS = byos_clamp_refresh(rate);
+    json_get_bool(json, len, "update_firmware", &out->updateFirmware);
+    json_get_bool(json, len, "reset_firmware", &out->resetFirmware);
+
+    if (!json_get_long(json, len, "status", &out->status)) return BYOS_ERR_JSON;
+    if (out->status != 0) return BYOS_ERR_STATUS;
+
+    if (json_get_string(json, len, "image_url", out->imageUrl, sizeof(out->imageUrl)) <= 0) {
+        out->imageUrl[0] = '\0';
+        return BYOS_ERR_NO_IMAGE;
+    }
+    if (json_get_string(json, len, "filename", out->filename, sizeof(out->filename)) < 0) {
+        out->filename[0] = '\0';
+    }
+    return BYOS_OK;
+}
+
+/** filename when present, else image_url */
+static inline const char* byos_image_key(const ByosDisplay* d) {
+    return d->filename[0] ? d->filename : d->imageUrl;
+}
+
+/** true if the panel is not already showing this image */
+static inline bool byos_image_changed(const ByosCache* c, const ByosDisplay* d) {
+    const char* key = byos_image_key(d);
+    size_t len = strlen(key);
+    return c->imageKeyLen == 0 || c->imageKeyLen != (uint16_t)len ||
+           c->imageKeyHash != byos_fnv1a(key, len);
+}
+
+/** Record a successful draw */
+static inline void byos_image_drawn(ByosCache* c, const ByosDisplay* d) {
+    const char* key = byos_image_key(d);
+    size_t len = strlen(key);
+    c->imageKeyHash = byos_fnv1a(key, len);
+    c->imageKeyLen = (uint16_t)(len ? len : 1);
+}
+
+/** Forget the drawn image so the next cycle downloads it again */
+static inline void byos_image_forget(ByosCache* c) {
+    c->imageKeyHash = 0;
+    c->imageKeyLen = 0;
+}
+
+/**
+ * Deep sleep length so that wake-ups are refreshRateS apart: the time this
+ * cycle was awake is taken off, with a short floor if it overran.
+ */
+static inline uint64_t byos_sleep_us(uint32_t refreshRateS, uint32_t awakeMs) {
+    uint64_t periodMs = (uint64_t)refreshRateS * 1000;
+    uint64_t floorMs = (uint64_t)BYOS_MIN_SLEEP_S * 1000;
+    uint64_t sleepMs = periodMs > awakeMs + floorMs ? periodMs - awakeMs : floorMs;
+    return sleepMs * 1000;
+}
+
+/** Retry delay after errorStreak failed cycles: 30 s doubling, capped at refresh_rate */
+static inline uint32_t byos_retry_s(uint16_t errorStreak, uint32_t refreshRateS) {
+    uint32_t s = BYOS_RETRY_BASE_S;
+    for (uint16_t i = 1; i < errorStreak && s < refreshRateS; i++) s *= 2;
+    return s < refreshRateS ? s : refreshRateS;
+}
+
+#endif // BYOS_CLIENT_H
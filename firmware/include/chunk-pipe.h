@@ -0,0 +1,129 @@
+/**
+ * Chunk Pipe - lock-free hand-off between a network stage and a decode stage
+ * Part of the Commute Compute System™
+ *
+ * Single-producer / single-consumer queue of fixed-size byte chunks. The
+ * producer (HTTP/TLS reader) fills a free slot and commits it; the consumer
+ * (decoder -> shadow framebuffer -> SPI) takes committed slots in order and
+ * releases them. Slots are owned by exactly one side at a time, so no
+ * copies and no locks are needed - only acquire/release ordering on the
+ * two indices, which is what makes it safe across the two ESP32-S3 cores
+ * (and across host threads in the native benchmark).
+ *
+ * The caller provides the storage (internal RAM on the S3 so the TLS task
+ * is never stalled on PSRAM, static on the host).
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef CHUNK_PIPE_H
+#define CHUNK_PIPE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define CHUNK_PIPE_MAX_SLOTS  32
+
+#define CHUNK_FLAG_END        0x01    // Last chunk of the stream (may be empty)
+#define CHUNK_FLAG_ERROR      0x02    // Producer failed; status holds the reason
+
+struct ChunkSlot {
+    uint8_t* data;
+    uint32_t len;
+    uint8_t flags;
+    int32_t status;
+};
+
+struct ChunkPipe {
+    ChunkSlot slots[CHUNK_PIPE_MAX_SLOTS];
+    uint32_t slotCount;           // Power of two
+    uint32_t slotSize;
+    uint32_t head;                // Next slot the producer fills (producer-owned)
+    uint32_t tail;                // Next slot the consumer reads (consumer-owned)
+
+    // Producer-side stats
+    uint32_t producerStalls;      // acquire() found the pipe full
+    uint32_t maxDepth;
+};
+
+static inline uint32_t chunkpipe_load(const uint32_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void chunkpipe_store(uint32_t* p, uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+/**
+ * Split storage into slotCount slots of slotSize bytes.
+ * slotCount must be a power of two <= CHUNK_PIPE_MAX_SLOTS.
+ */
+static inline bool chunkpipe_init(ChunkPipe* p, uint8_t* storage, uint32_t slotCount, uint32_t slotSize) {
+    if (!storage || slotCount < 2 || slotCount > CHUNK_PIPE_MAX_SLOTS) return false;
+    if ((slotCount & (slotCount - 1)) != 0 || slotSize == 0) return false;
+    memset(p, 0, sizeof(*p));
+    p->slotCount = slotCount;
+    p->slotSize = slotSize;
+    for (uint32_t i = 0; i < slotCount; i++) {
+        p->slots[i].data = storage + (size_t)i * slotSize;
+    }
+    return true;
+}
+
+/**
+ * Reset for a new stream. Only call while neither side is running.
+ */
+static inline void chunkpipe_reset(ChunkPipe* p) {
+    p->head = p->tail = 0;
+    p->producerStalls = 0;
+    p->maxDepth = 0;
+}
+
+// ---- Producer ----
+
+/**
+ * Free slot to fill, or nullptr if the consumer has not caught up
+ */
+static inline ChunkSlot* chunkpipe_acquire(ChunkPipe* p) {
+    uint32_t tail = chunkpipe_load(&p->tail);
+    if (p->head - tail >= p->slotCount) {
+        p->producerStalls++;
+        return nullptr;
+    }
+    ChunkSlot* s = &p->slots[p->head & (p->slotCount - 1)];
+    s->len = 0;
+    s->flags = 0;
+    s->status = 0;
+    return s;
+}
+
+/**
+ * Publish the slot returned by the last acquire()
+ */
+static inline void chunkpipe_commit(ChunkPipe* p) {
+    uint32_t depth = p->head + 1 - chunkpipe_load(&p->tail);
+    if (depth > p->maxDepth) p->maxDepth = depth;
+    chunkpipe_store(&p->head, p->head + 1);
+}
+
+// ---- Consumer ----
+
+/**
+ * Oldest committed slot, or nullptr if none is ready
+ */
+static inline const ChunkSlot* chunkpipe_peek(ChunkPipe* p) {
+    uint32_t head = chunkpipe_load(&p->head);
+    if (head == p->tail) return nullptr;
+    return &p->slots[p->tail & (p->slotCount - 1)];
+}
+
+/**
+ * Hand the slot returned by peek() back to the producer
+ */
+static inline void chunkpipe_release(ChunkPipe* p) {
+    chunkpipe_store(&p->tail, p->tail + 1);
+}
+
+#endif // CHUNK_PIPE_H
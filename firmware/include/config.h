@@ -71,6 +71,22 @@
 #define SCREEN_H 480
 #endif
 
+#ifdef BOARD_CC_S3
+// =============================================================================
+// E-INK SPI PINS (ESP32-S3 N16R8 DevKitC + Waveshare 7.5" HAT)
+// GPIO 26-37 are taken by octal flash/PSRAM
+// =============================================================================
+
+#define EPD_SCK_PIN  12
+#define EPD_MOSI_PIN 11
+#define EPD_CS_PIN   10
+#define EPD_RST_PIN  13
+#define EPD_DC_PIN   14
+#define EPD_BUSY_PIN 4
+
+#define PIN_INTERRUPT 2
+#define PIN_BATTERY 1
+#else
 // =============================================================================
 // E-INK SPI PINS (TRMNL OG - ESP32-C3)
 // =============================================================================
@@ -88,6 +104,7 @@
 
 #define PIN_INTERRUPT 2
 #define PIN_BATTERY 3
+#endif
 
 // =============================================================================
 // ZONE LAYOUT (V10 Dashboard)
@@ -0,0 +1,238 @@
+/**
+ * Dash Model - dashboard data model kept on the device, updated by patches
+ * Part of the Commute Compute System™
+ *
+ * With CC_LOCAL_RENDER the device draws the dashboard itself
+ * (dash_render_model() in dash-template.h) from this model instead of
+ * loading a 48 KB BMP each minute. The server (src/services/model-patch.js)
+ * sends field ops against the version the device holds:
+ *
+ *   u8 version=1, u8 kind (0 full, 1 patch), u16le base, u16le version,
+ *   u8 opCount, u8 flags,
+ *   ops: u8 op, u8 field, value
+ *        1 SET_STR  u8 len, bytes
+ *        2 SET_U16  u16le
+ *        3 CLEAR    -
+ *   u32le check - FNV-1a of the resulting model (dashmodel_check())
+ *
+ * A patch only applies to the model whose version is `base`; a result
+ * whose check does not match is dropped. Either way the caller asks again
+ * with version 0 and gets a full model.
+ *
+ * Each field belongs to one screen region; dashmodel_apply() reports the
+ * regions whose fields actually changed so only those are redrawn. Field
+ * ids and sizes must match MODEL_FIELDS in model-patch.js.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef DASH_MODEL_H
+#define DASH_MODEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define DASHMODEL_VERSION      1
+#define DASHMODEL_KIND_FULL    0
+#define DASHMODEL_KIND_PATCH   1
+#define DASHMODEL_OP_SET_STR   1
+#define DASHMODEL_OP_SET_U16   2
+#define DASHMODEL_OP_CLEAR     3
+#define DASHMODEL_HEADER_BYTES 8
+#define DASHMODEL_MAX_LEGS     6
+#define DASHMODEL_LEG_FIELD(i, offset) (0x20 + 8 * (i) + (offset))
+#define DASHMODEL_NO_LEAVE_IN  0xFFFF
+#define DASHMODEL_MAX_BYTES    1024     // Largest full model is ~700 B
+
+#define DASHMODEL_OK           0
+#define DASHMODEL_ERR_FORMAT  -1        // Malformed or truncated
+#define DASHMODEL_ERR_VERSION -2        // Patch for a model we do not hold
+#define DASHMODEL_ERR_CHECK   -3        // Result differs from the server's
+#define DASHMODEL_ERR_FIELD   -4        // Unknown field, wrong type or too long
+
+// Screen regions (dash_render_model())
+#define DASH_REGION_HEADER    (1u << 0)   // Location, day, date
+#define DASH_REGION_CLOCK     (1u << 1)
+#define DASH_REGION_WEATHER   (1u << 2)
+#define DASH_REGION_STATUS    (1u << 3)
+#define DASH_REGION_FOOTER    (1u << 4)
+#define DASH_REGION_LEG(i)    (1u << (8 + (i)))
+#define DASH_REGION_LEGS      (0x3Fu << 8)
+#define DASH_REGION_ALL       (0x1Fu | DASH_REGION_LEGS)
+
+struct DashModelLeg {
+    char type[12];
+    char title[41];
+    char subtitle[41];
+    uint16_t minutes;
+    char state[12];
+    uint16_t canGet;          // 0 no, 1 yes, 2 not a coffee leg
+};
+
+struct DashModel {
+    uint16_t version;         // 0 = holds nothing
+    char location[41];
+    char time[8];             // "H:MM"
+    char day[12];
+    char date[12];
+    char temp[8];
+    char condition[24];
+    uint16_t umbrella;
+    char statusType[16];
+    char arriveBy[8];
+    uint16_t totalMinutes;
+    uint16_t leaveIn;         // DASHMODEL_NO_LEAVE_IN if none
+    char destination[41];
+    uint16_t legCount;
+    DashModelLeg legs[DASHMODEL_MAX_LEGS];
+};
+
+// Where a field lives: a string (size > 0, incl. NUL) or a u16
+struct DashModelField {
+    char* str;
+    size_t size;
+    uint16_t* num;
+    uint32_t region;
+};
+
+static inline bool dashmodel_field(DashModel* m, uint8_t id, DashModelField* f) {
+    f->str = nullptr;
+    f->size = 0;
+    f->num = nullptr;
+#define DASHMODEL_STR(member, r) { f->str = member; f->size = sizeof(member); f->region = r; return true; }
+#define DASHMODEL_U16(member, r) { f->num = &member; f->region = r; return true; }
+    switch (id) {
+        case 1:  DASHMODEL_STR(m->location, DASH_REGION_HEADER)
+        case 2:  DASHMODEL_STR(m->time, DASH_REGION_CLOCK)
+        case 3:  DASHMODEL_STR(m->day, DASH_REGION_HEADER)
+        case 4:  DASHMODEL_STR(m->date, DASH_REGION_HEADER)
+        case 5:  DASHMODEL_STR(m->temp, DASH_REGION_WEATHER)
+        case 6:  DASHMODEL_STR(m->condition, DASH_REGION_WEATHER)
+        case 7:  DASHMODEL_U16(m->umbrella, DASH_REGION_WEATHER)
+        case 8:  DASHMODEL_STR(m->statusType, DASH_REGION_STATUS)
+        case 9:  DASHMODEL_STR(m->arriveBy, DASH_REGION_STATUS)
+        case 10: DASHMODEL_U16(m->totalMinutes, DASH_REGION_STATUS)
+        case 11: DASHMODEL_U16(m->leaveIn, DASH_REGION_STATUS)
+        case 12: DASHMODEL_STR(m->destination, DASH_REGION_FOOTER)
+        case 13: DASHMODEL_U16(m->legCount, DASH_REGION_LEGS)   // Leg layout depends on the count
+        default: break;
+    }
+    if (id < 0x20 || id >= DASHMODEL_LEG_FIELD(DASHMODEL_MAX_LEGS, 0)) return false;
+    DashModelLeg* leg = &m->legs[(id - 0x20) / 8];
+    uint32_t region = DASH_REGION_LEG((id - 0x20) / 8);
+    switch ((id - 0x20) % 8) {
+        case 0:  DASHMODEL_STR(leg->type, region)
+        case 1:  DASHMODEL_STR(leg->title, region)
+        case 2:  DASHMODEL_STR(leg->subtitle, region)
+        case 3:  DASHMODEL_U16(leg->minutes, region)
+        case 4:  DASHMODEL_STR(leg->state, region)
+        case 5:  DASHMODEL_U16(leg->canGet, region)
+        default: return false;
+    }
+#undef DASHMODEL_STR
+#undef DASHMODEL_U16
+}
+
+static inline void dashmodel_clear(DashModel* m) {
+    memset(m, 0, sizeof(*m));
+}
+
+static inline uint32_t dashmodel_fnv(uint32_t hash, uint8_t b) {
+    return (hash ^ b) * 0x01000193u;
+}
+
+/**
+ * FNV-1a over every field in id order: id, then u8 length + bytes for
+ * strings or u16le for numbers (modelCheck() in model-patch.js)
+ */
+static inline uint32_t dashmodel_check(const DashModel* m) {
+    DashModel* mm = const_cast<DashModel*>(m);     // dashmodel_field() only reads here
+    uint32_t hash = 0x811c9dc5u;
+    DashModelField f;
+    for (int id = 1; id < DASHMODEL_LEG_FIELD(DASHMODEL_MAX_LEGS, 0); id++) {
+        if (!dashmodel_field(mm, (uint8_t)id, &f)) continue;
+        hash = dashmodel_fnv(hash, (uint8_t)id);
+        if (f.str) {
+            size_t n = strlen(f.str);
+            hash = dashmodel_fnv(hash, (uint8_t)n);
+            for (size_t i = 0; i < n; i++) hash = dashmodel_fnv(hash, (uint8_t)f.str[i]);
+        } else {
+            hash = dashmodel_fnv(hash, (uint8_t)(*f.num & 0xFF));
+            hash = dashmodel_fnv(hash, (uint8_t)(*f.num >> 8));
+        }
+    }
+    return hash;
+}
+
+/**
+ * Apply a full model or patch to current, result in out (out may be
+ * current only if the caller can afford to lose it on failure)
+ * @param regions  Set to the regions to redraw: all for a full model, else
+ *                 those with a field whose value changed
+ * @returns DASHMODEL_OK or a DASHMODEL_ERR_* code (out is then unusable)
+ */
+static inline int dashmodel_apply(const DashModel* current, DashModel* out,
+                                  const uint8_t* buf, size_t len, uint32_t* regions) {
+    *regions = 0;
+    if (len < DASHMODEL_HEADER_BYTES + 4 || buf[0] != DASHMODEL_VERSION) return DASHMODEL_ERR_FORMAT;
+    uint8_t kind = buf[1];
+    uint16_t base = (uint16_t)(buf[2] | (buf[3] << 8));
+    uint16_t version = (uint16_t)(buf[4] | (buf[5] << 8));
+    if (kind > DASHMODEL_KIND_PATCH || version == 0) return DASHMODEL_ERR_FORMAT;
+
+    if (kind == DASHMODEL_KIND_FULL) {
+        dashmodel_clear(out);
+        *regions = DASH_REGION_ALL;
+    } else {
+        if (current->version == 0 || base != current->version) return DASHMODEL_ERR_VERSION;
+        if (out != current) *out = *current;
+    }
+
+    size_t o = DASHMODEL_HEADER_BYTES;
+    size_t end = len - 4;
+    DashModelField f;
+    for (int i = 0; i < buf[6]; i++) {
+        if (o + 2 > end) return DASHMODEL_ERR_FORMAT;
+        uint8_t op = buf[o];
+        if (!dashmodel_field(out, buf[o + 1], &f)) return DASHMODEL_ERR_FIELD;
+        o += 2;
+        bool changed;
+        if (op == DASHMODEL_OP_SET_STR && f.str) {
+            if (o + 1 > end) return DASHMODEL_ERR_FORMAT;
+            size_t n = buf[o++];
+            if (n >= f.size) return DASHMODEL_ERR_FIELD;
+            if (o + n > end) return DASHMODEL_ERR_FORMAT;
+            for (size_t k = 0; k < n; k++) {
+                if (buf[o + k] < 0x20 || buf[o + k] > 0x7E) return DASHMODEL_ERR_FIELD;
+            }
+            changed = strlen(f.str) != n || memcmp(f.str, buf + o, n) != 0;
+            memcpy(f.str, buf + o, n);
+            f.str[n] = '\0';
+            o += n;
+        } else if (op == DASHMODEL_OP_SET_U16 && f.num) {
+            if (o + 2 > end) return DASHMODEL_ERR_FORMAT;
+            uint16_t v = (uint16_t)(buf[o] | (buf[o + 1] << 8));
+            changed = *f.num != v;
+            *f.num = v;
+            o += 2;
+        } else if (op == DASHMODEL_OP_CLEAR) {
+            changed = f.str ? f.str[0] != '\0' : *f.num != 0;
+            if (f.str) f.str[0] = '\0'; else *f.num = 0;
+        } else {
+            return DASHMODEL_ERR_FIELD;
+        }
+        if (changed) *regions |= f.region;
+    }
+    if (o != end) return DASHMODEL_ERR_FORMAT;
+    if (out->legCount > DASHMODEL_MAX_LEGS) return DASHMODEL_ERR_FIELD;
+
+    uint32_t check = (uint32_t)buf[end] | ((uint32_t)buf[end + 1] << 8) |
+                     ((uint32_t)buf[end + 2] << 16) | ((uint32_t)buf[end + 3] << 24);
+    if (dashmodel_check(out) != check) return DASHMODEL_ERR_CHECK;
+    out->version = version;
+    return DASHMODEL_OK;
+}
+
+#endif // DASH_MODEL_H
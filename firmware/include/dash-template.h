@@ -0,0 +1,400 @@
+/**
+ * Device-side Dashboard Template Renderer
+ * Part of the Commute Compute System™
+ *
+ * Draws a V12-layout dashboard from an offline timetable slice when the
+ * server cannot be reached. Output is deliberately marked SCHEDULED so it is
+ * never mistaken for live data. dash_render_model() draws the live
+ * dashboard from a server data model (dash-model.h, CC_LOCAL_RENDER),
+ * region by region.
+ *
+ * Templated on the display type so the same code drives bb_epaper on the
+ * device and a plain framebuffer on the host. The display must provide:
+ *   fillScreen(c), fillRect(x, y, w, h, c), drawRect(x, y, w, h, c),
+ *   drawLine(x0, y0, x1, y1, c), setCursor(x, y), setTextColor(fg, bg),
+ *   print(const char*)   (8x8 font, per DEVELOPMENT-RULES.md)
+ *
+ * Layout (800x480, matches ccdash-renderer.js V12 zones):
+ *   header 0-94, status bar 96-124, legs 132-440, footer 448-480
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef DASH_TEMPLATE_H
+#define DASH_TEMPLATE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "timetable-slice.h"
+#include "dash-model.h"
+
+#ifndef DASH_BLACK
+#define DASH_BLACK 0
+#endif
+#ifndef DASH_WHITE
+#define DASH_WHITE 1
+#endif
+
+#define DASH_FONT_W       8
+#define DASH_HEADER_H     94
+#define DASH_STATUS_Y     96
+#define DASH_STATUS_H     28
+#define DASH_LEGS_Y       132
+#define DASH_LEG_GAP      14
+#define DASH_LEG_MAX_H    52
+#define DASH_FOOTER_H     32
+#define DASH_MARGIN       8
+#define DASH_CLOCK_W      320     // Header: location over clock | day, date | weather
+#define DASH_LOCATION_H   20      // (the header.* zones of ccdash-renderer.js)
+#define DASH_WEATHER_W    200
+
+// 7-segment digits for the clock (FONT_8x8 is too small for the header)
+#define DASH_SEG_W        26
+#define DASH_SEG_H        50
+#define DASH_SEG_T        6
+
+static const uint8_t DASH_SEGMENTS[10] = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F
+};
+
+static inline const char* dash_leg_name(uint8_t type) {
+    switch (type) {
+        case SLICE_LEG_TRAIN:  return "TRAIN";
+        case SLICE_LEG_TRAM:   return "TRAM";
+        case SLICE_LEG_BUS:    return "BUS";
+        case SLICE_LEG_COFFEE: return "COFFEE";
+        case SLICE_LEG_FERRY:  return "FERRY";
+        case SLICE_LEG_VLINE:  return "VLINE";
+        default:               return "WALK";
+    }
+}
+
+/**
+ * "8:05am" style time for a local minutes-after-midnight value
+ */
+static inline void dash_format_time(int localMinutes, char* out, size_t len) {
+    int h24 = (localMinutes / 60) % 24;
+    int h12 = h24 % 12 == 0 ? 12 : h24 % 12;
+    snprintf(out, len, "%d:%02d%s", h12, localMinutes % 60, h24 < 12 ? "am" : "pm");
+}
+
+template <typename Display>
+static void dash_draw_digit(Display& d, int x, int y, int digit, uint16_t color) {
+    uint8_t s = DASH_SEGMENTS[digit % 10];
+    const int w = DASH_SEG_W, h = DASH_SEG_H, t = DASH_SEG_T, half = DASH_SEG_H / 2;
+    if (s & 0x01) d.fillRect(x, y, w, t, color);                       // a
+    if (s & 0x02) d.fillRect(x + w - t, y, t, half, color);            // b
+    if (s & 0x04) d.fillRect(x + w - t, y + half, t, h - half, color); // c
+    if (s & 0x08) d.fillRect(x, y + h - t, w, t, color);               // d
+    if (s & 0x10) d.fillRect(x, y + half, t, h - half, color);         // e
+    if (s & 0x20) d.fillRect(x, y, t, half, color);                    // f
+    if (s & 0x40) d.fillRect(x, y + half - t / 2, w, t, color);        // g
+}
+
+/**
+ * Large H:MM clock. Returns the x coordinate after the last digit.
+ */
+template <typename Display>
+static int dash_draw_clock(Display& d, int x, int y, int localMinutes) {
+    int h12 = ((localMinutes / 60) % 12) == 0 ? 12 : (localMinutes / 60) % 12;
+    const int step = DASH_SEG_W + 8;
+    if (h12 >= 10) {
+        dash_draw_digit(d, x, y, h12 / 10, DASH_BLACK);
+        x += step;
+    }
+    dash_draw_digit(d, x, y, h12 % 10, DASH_BLACK);
+    x += step;
+    d.fillRect(x, y + 12, DASH_SEG_T, DASH_SEG_T, DASH_BLACK);
+    d.fillRect(x, y + DASH_SEG_H - 18, DASH_SEG_T, DASH_SEG_T, DASH_BLACK);
+    x += DASH_SEG_T + 8;
+    dash_draw_digit(d, x, y, (localMinutes % 60) / 10, DASH_BLACK);
+    x += step;
+    dash_draw_digit(d, x, y, localMinutes % 10, DASH_BLACK);
+    return x + DASH_SEG_W;
+}
+
+/**
+ * Render the offline dashboard for nowUnix into the display buffer.
+ * The caller is responsible for refreshing the panel afterwards.
+ *
+ * @param lastLiveUnix  Time of the last successful live fetch (0 = unknown)
+ */
+template <typename Display>
+static void dash_render_offline(Display& d, int width, int height,
+                                const TimetableSlice* slice, const SlicePlan* plan,
+                                uint32_t nowUnix, uint32_t lastLiveUnix) {
+    char buf[64];
+    char timeBuf[16];
+    int nowLocal = slice_local_minutes(slice, nowUnix);
+
+    d.fillScreen(DASH_WHITE);
+
+    // ---- Header: clock + SCHEDULED badge ----
+    int clockEnd = dash_draw_clock(d, 16, 22, nowLocal);
+    d.setTextColor(DASH_BLACK, DASH_WHITE);
+    d.setCursor(clockEnd + 16, 30);
+    d.print("NO CONNECTION");
+    d.setCursor(clockEnd + 16, 46);
+    d.print("Using stored timetable");
+
+    const char* badge = "SCHEDULED";
+    int badgeW = (int)strlen(badge) * DASH_FONT_W + 16;
+    int badgeX = width - badgeW - 16;
+    d.fillRect(badgeX, 30, badgeW, 24, DASH_BLACK);
+    d.setTextColor(DASH_WHITE, DASH_BLACK);
+    d.setCursor(badgeX + 8, 38);
+    d.print(badge);
+
+    d.fillRect(0, DASH_HEADER_H, width, 2, DASH_BLACK);
+
+    // ---- Status bar ----
+    d.fillRect(0, DASH_STATUS_Y, width, DASH_STATUS_H, DASH_BLACK);
+    d.setTextColor(DASH_WHITE, DASH_BLACK);
+    d.setCursor(16, DASH_STATUS_Y + 10);
+    if (plan->valid) {
+        dash_format_time(slice_local_minutes(slice, plan->arriveAt), timeBuf, sizeof(timeBuf));
+        if (plan->leaveInMinutes <= 0) {
+            snprintf(buf, sizeof(buf), "LEAVE NOW - ARRIVE %s", timeBuf);
+        } else {
+            snprintf(buf, sizeof(buf), "LEAVE IN %d MIN - ARRIVE %s", plan->leaveInMinutes, timeBuf);
+        }
+    } else {
+        snprintf(buf, sizeof(buf), "NO SCHEDULED SERVICES IN STORED TIMETABLE");
+    }
+    d.print(buf);
+
+    if (slice->arriveBy != SLICE_NO_ARRIVE_BY) {
+        dash_format_time(slice->arriveBy, timeBuf, sizeof(timeBuf));
+        snprintf(buf, sizeof(buf), "TARGET %s", timeBuf);
+        d.setCursor(width - 16 - (int)strlen(buf) * DASH_FONT_W, DASH_STATUS_Y + 10);
+        d.print(buf);
+    }
+
+    // ---- Journey legs ----
+    int legsBottom = height - DASH_FOOTER_H - 8;
+    int count = slice->legCount;
+    if (count > 0) {
+        int legH = (legsBottom - DASH_LEGS_Y - DASH_LEG_GAP * (count - 1)) / count;
+        if (legH > DASH_LEG_MAX_H) legH = DASH_LEG_MAX_H;
+        int legW = width - DASH_MARGIN * 2;
+
+        for (int i = 0; i < count; i++) {
+            const SliceLeg& leg = slice->legs[i];
+            int y = DASH_LEGS_Y + i * (legH + DASH_LEG_GAP);
+            int textY = y + legH / 2 - 4;
+
+            d.drawRect(DASH_MARGIN, y, legW, legH, DASH_BLACK);
+            d.drawRect(DASH_MARGIN + 1, y + 1, legW - 2, legH - 2, DASH_BLACK);
+
+            // Step number box
+            d.fillRect(DASH_MARGIN + 8, y + legH / 2 - 12, 24, 24, DASH_BLACK);
+            d.setTextColor(DASH_WHITE, DASH_BLACK);
+            snprintf(buf, sizeof(buf), "%d", i + 1);
+            d.setCursor(DASH_MARGIN + 16, textY);
+            d.print(buf);
+
+            d.setTextColor(DASH_BLACK, DASH_WHITE);
+            d.setCursor(DASH_MARGIN + 44, textY - (legH >= 36 ? 8 : 0));
+            d.print(dash_leg_name(leg.type));
+            if (leg.label[0] && legH >= 36) {
+                d.setCursor(DASH_MARGIN + 44, textY + 8);
+                d.print(leg.label);
+            } else if (leg.label[0]) {
+                d.setCursor(DASH_MARGIN + 44 + 8 * DASH_FONT_W, textY);
+                d.print(leg.label);
+            }
+
+            // Right column: scheduled departure for transit, duration otherwise
+            if (plan->valid && slice_is_transit(leg.type)) {
+                dash_format_time(slice_local_minutes(slice, plan->legStart[i]), timeBuf, sizeof(timeBuf));
+                snprintf(buf, sizeof(buf), "DEP %s  %d MIN", timeBuf, leg.minutes);
+            } else {
+                snprintf(buf, sizeof(buf), "%d MIN", leg.minutes);
+            }
+            d.setCursor(DASH_MARGIN + legW - 16 - (int)strlen(buf) * DASH_FONT_W, textY);
+            d.print(buf);
+        }
+    }
+
+    // ---- Footer (black bar, as the server draws it) ----
+    int footerY = height - DASH_FOOTER_H;
+    d.fillRect(0, footerY, width, DASH_FOOTER_H, DASH_BLACK);
+    d.setTextColor(DASH_WHITE, DASH_BLACK);
+    d.setCursor(16, footerY + 12);
+    if (lastLiveUnix > 0) {
+        dash_format_time(slice_local_minutes(slice, lastLiveUnix), timeBuf, sizeof(timeBuf));
+        snprintf(buf, sizeof(buf), "OFFLINE - SCHEDULED TIMES - LAST LIVE %s", timeBuf);
+    } else {
+        snprintf(buf, sizeof(buf), "OFFLINE - SCHEDULED TIMES");
+    }
+    d.print(buf);
+    if (slice->flags & SLICE_FLAG_PROJECTED) {
+        const char* note = "INCL. ESTIMATED";
+        d.setCursor(width - 16 - (int)strlen(note) * DASH_FONT_W, footerY + 12);
+        d.print(note);
+    }
+}
+
+/** Upper-case copy of src (leg types and states arrive lower case) */
+static inline const char* dash_upper(const char* src, char* out, size_t len) {
+    size_t i = 0;
+    for (; src[i] && i + 1 < len; i++) out[i] = (src[i] >= 'a' && src[i] <= 'z') ? (char)(src[i] - 32) : src[i];
+    out[i] = '\0';
+    return out;
+}
+
+/** Print at most maxChars characters of s */
+template <typename Display>
+static void dash_print_clipped(Display& d, const char* s, int maxChars) {
+    char buf[48];
+    int n = 0;
+    for (; s[n] && n < maxChars && n < (int)sizeof(buf) - 1; n++) buf[n] = s[n];
+    buf[n] = '\0';
+    d.print(buf);
+}
+
+/**
+ * Redraw the regions (DASH_REGION_*) of the live dashboard for model m.
+ * Each region is cleared to its background first, so the rest of the
+ * display buffer is left as it was. The caller refreshes the panel.
+ */
+template <typename Display>
+static void dash_render_model(Display& d, int width, int height, const DashModel* m, uint32_t regions) {
+    char buf[64];
+    char up[16];
+
+    // ---- Header: clock ----
+    if (regions & DASH_REGION_CLOCK) {
+        d.fillRect(0, DASH_LOCATION_H, DASH_CLOCK_W, DASH_HEADER_H - DASH_LOCATION_H, DASH_WHITE);
+        int h = 0, mm = 0;
+        if (sscanf(m->time, "%d:%d", &h, &mm) == 2) {
+            dash_draw_clock(d, 16, 22, (h % 24) * 60 + mm % 60);
+        } else {
+            d.setTextColor(DASH_BLACK, DASH_WHITE);
+            d.setCursor(16, 42);
+            d.print(m->time);
+        }
+    }
+
+    // ---- Header: location above the clock, day and date beside it ----
+    if (regions & DASH_REGION_HEADER) {
+        d.fillRect(0, 0, DASH_CLOCK_W, DASH_LOCATION_H, DASH_WHITE);
+        d.fillRect(DASH_CLOCK_W, 0, width - DASH_CLOCK_W - DASH_WEATHER_W, DASH_HEADER_H, DASH_WHITE);
+        d.setTextColor(DASH_BLACK, DASH_WHITE);
+        d.setCursor(16, 12);
+        dash_print_clipped(d, m->location, (DASH_CLOCK_W - 16 - DASH_MARGIN) / DASH_FONT_W);
+        int chars = (width - DASH_CLOCK_W - DASH_WEATHER_W - DASH_MARGIN) / DASH_FONT_W;
+        d.setCursor(DASH_CLOCK_W, 20);
+        dash_print_clipped(d, m->day, chars);
+        d.setCursor(DASH_CLOCK_W, 48);
+        dash_print_clipped(d, m->date, chars);
+        d.fillRect(0, DASH_HEADER_H, width, 2, DASH_BLACK);
+    }
+
+    // ---- Header: weather box, umbrella bar below ----
+    if (regions & DASH_REGION_WEATHER) {
+        int x = width - DASH_WEATHER_W;
+        int mid = x + (DASH_WEATHER_W - 8) / 2;  // Centre of the box (ccdash-renderer.js: 192 px wide)
+        d.fillRect(x, 0, DASH_WEATHER_W, DASH_HEADER_H, DASH_WHITE);
+        d.drawRect(x + 2, 10, DASH_WEATHER_W - 12, 60, DASH_BLACK);
+        d.drawRect(x + 3, 11, DASH_WEATHER_W - 14, 58, DASH_BLACK);
+        d.setTextColor(DASH_BLACK, DASH_WHITE);
+        snprintf(buf, sizeof(buf), "%s C", m->temp);
+        d.setCursor(mid - (int)strlen(buf) * DASH_FONT_W / 2, 24);
+        d.print(buf);
+        d.setCursor(mid - (int)strlen(m->condition) * DASH_FONT_W / 2, 50);
+        d.print(m->condition);
+        const char* umbrella = m->umbrella ? "BRING UMBRELLA" : "NO UMBRELLA";
+        if (m->umbrella) {
+            d.fillRect(x + 4, 74, DASH_WEATHER_W - 16, 18, DASH_BLACK);
+            d.setTextColor(DASH_WHITE, DASH_BLACK);
+        } else {
+            d.drawRect(x + 4, 74, DASH_WEATHER_W - 16, 18, DASH_BLACK);
+        }
+        d.setCursor(mid - (int)strlen(umbrella) * DASH_FONT_W / 2, 79);
+        d.print(umbrella);
+    }
+
+    // ---- Status bar ----
+    if (regions & DASH_REGION_STATUS) {
+        d.fillRect(0, DASH_STATUS_Y, width, DASH_STATUS_H, DASH_BLACK);
+        d.setTextColor(DASH_WHITE, DASH_BLACK);
+        d.setCursor(16, DASH_STATUS_Y + 10);
+        const char* prefix = strcmp(m->statusType, "normal") == 0 || !m->statusType[0]
+            ? "" : dash_upper(m->statusType, up, sizeof(up));
+        if (m->leaveIn == DASHMODEL_NO_LEAVE_IN) {
+            snprintf(buf, sizeof(buf), "%s%sARRIVE BY %s", prefix, prefix[0] ? " - " : "", m->arriveBy);
+        } else if (m->leaveIn == 0) {
+            snprintf(buf, sizeof(buf), "%s%sLEAVE NOW - ARRIVE %s", prefix, prefix[0] ? " - " : "", m->arriveBy);
+        } else {
+            snprintf(buf, sizeof(buf), "%s%sLEAVE IN %u MIN - ARRIVE %s", prefix, prefix[0] ? " - " : "",
+                     (unsigned)m->leaveIn, m->arriveBy);
+        }
+        d.print(buf);
+        snprintf(buf, sizeof(buf), "%u MIN", (unsigned)m->totalMinutes);
+        d.setCursor(width - 16 - (int)strlen(buf) * DASH_FONT_W, DASH_STATUS_Y + 10);
+        d.print(buf);
+    }
+
+    // ---- Journey legs ----
+    int legsBottom = height - DASH_FOOTER_H - 8;
+    if ((regions & DASH_REGION_LEGS) == DASH_REGION_LEGS) {
+        d.fillRect(0, DASH_LEGS_Y, width, legsBottom - DASH_LEGS_Y, DASH_WHITE);
+    }
+    int count = m->legCount;
+    if (count > 0 && (regions & DASH_REGION_LEGS)) {
+        int legH = (legsBottom - DASH_LEGS_Y - DASH_LEG_GAP * (count - 1)) / count;
+        if (legH > DASH_LEG_MAX_H) legH = DASH_LEG_MAX_H;
+        int legW = width - DASH_MARGIN * 2;
+
+        for (int i = 0; i < count; i++) {
+            if (!(regions & DASH_REGION_LEG(i))) continue;
+            const DashModelLeg& leg = m->legs[i];
+            int y = DASH_LEGS_Y + i * (legH + DASH_LEG_GAP);
+            int textY = y + legH / 2 - 4;
+
+            d.fillRect(DASH_MARGIN, y, legW, legH, DASH_WHITE);
+            d.drawRect(DASH_MARGIN, y, legW, legH, DASH_BLACK);
+            d.drawRect(DASH_MARGIN + 1, y + 1, legW - 2, legH - 2, DASH_BLACK);
+
+            d.fillRect(DASH_MARGIN + 8, y + legH / 2 - 12, 24, 24, DASH_BLACK);
+            d.setTextColor(DASH_WHITE, DASH_BLACK);
+            snprintf(buf, sizeof(buf), "%d", i + 1);
+            d.setCursor(DASH_MARGIN + 16, textY);
+            d.print(buf);
+
+            d.setTextColor(DASH_BLACK, DASH_WHITE);
+            d.setCursor(DASH_MARGIN + 44, textY - (legH >= 36 ? 8 : 0));
+            d.print(leg.title[0] ? leg.title : dash_upper(leg.type, up, sizeof(up)));
+            if (leg.subtitle[0] && legH >= 36) {
+                d.setCursor(DASH_MARGIN + 44, textY + 8);
+                d.print(leg.subtitle);
+            }
+
+            // Right column: minutes, with the state when it is not normal
+            // and the coffee decision on coffee legs
+            if (leg.canGet != 2) {
+                snprintf(buf, sizeof(buf), "%s  %u MIN", leg.canGet ? "GET COFFEE" : "SKIP", (unsigned)leg.minutes);
+            } else if (leg.state[0] && strcmp(leg.state, "normal") != 0) {
+                snprintf(buf, sizeof(buf), "%s  %u MIN", dash_upper(leg.state, up, sizeof(up)), (unsigned)leg.minutes);
+            } else {
+                snprintf(buf, sizeof(buf), "%u MIN", (unsigned)leg.minutes);
+            }
+            d.setCursor(DASH_MARGIN + legW - 16 - (int)strlen(buf) * DASH_FONT_W, textY);
+            d.print(buf);
+        }
+    }
+
+    // ---- Footer ----
+    if (regions & DASH_REGION_FOOTER) {
+        int footerY = height - DASH_FOOTER_H;
+        d.fillRect(0, footerY, width, DASH_FOOTER_H, DASH_BLACK);
+        d.setTextColor(DASH_WHITE, DASH_BLACK);
+        d.setCursor(16, footerY + 12);
+        snprintf(buf, sizeof(buf), "TO %s", m->destination);
+        d.print(buf);
+    }
+}
+
+#endif // DASH_TEMPLATE_H
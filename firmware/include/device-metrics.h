@@ -0,0 +1,148 @@
+/**
+ * Device Metrics - fetch/refresh counters and phase timings
+ * Part of the Commute Compute System™
+ *
+ * main.cpp records each fetch and panel refresh here; the diagnostic HTTP
+ * server (/metrics) and the serial shell print them. Output is the
+ * Prometheus text format so a scraper on the LAN can collect it as-is.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef DEVICE_METRICS_H
+#define DEVICE_METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Last value + running total of one pipeline phase
+struct MetricsPhase {
+    uint32_t lastMs;
+    uint32_t totalMs;
+    uint32_t count;
+};
+
+struct DeviceMetrics {
+    // Fetch pipeline phases
+    MetricsPhase tls;         // TCP connect + TLS handshake (pinned, verified or PSK)
+    MetricsPhase http;        // Request sent -> response headers
+    MetricsPhase body;        // Body download + BMP decode into the shadow framebuffer
+    MetricsPhase load;        // loadBMP() into the panel controller
+    MetricsPhase refreshFull;
+    MetricsPhase refreshPartial;
+    MetricsPhase fresh;       // UDP freshness check round trip (fresh-check.h)
+
+    uint32_t fetchOk;
+    uint32_t fetchFailed;
+    uint32_t framesUnchanged;
+    uint32_t lastFetchBytes;
+    uint64_t fetchBytesTotal;
+    int32_t lastHttpStatus;
+
+    // Handshakes by how the server was authenticated
+    uint32_t tlsPinned;       // Leaf matched the cached pin (no chain check)
+    uint32_t tlsVerified;     // Full chain verification against tls-roots.h
+    uint32_t tlsPsk;          // Pre-shared key
+    uint32_t tlsFailed;
+
+    // Freshness checks by answer
+    uint32_t freshUnchanged;  // Fetch skipped
+    uint32_t freshChanged;
+    uint32_t freshUnknown;    // Server had not seen the device - fetched
+    uint32_t freshNoReply;    // Timeout or invalid reply - fetched
+};
+
+// Values sampled when the metrics are read
+struct MetricsRuntime {
+    uint32_t uptimeMs;
+    uint32_t heapFree;
+    uint32_t heapMin;
+    uint32_t heapMaxBlock;
+    int32_t rssi;
+    int32_t partialSinceFull;
+    int32_t consecutiveErrors;
+    uint32_t logDropped;
+};
+
+static inline void metrics_phase(MetricsPhase* p, uint32_t ms) {
+    p->lastMs = ms;
+    p->totalMs += ms;
+    p->count++;
+}
+
+/**
+ * Count a finished fetch. The fetch path sets lastHttpStatus and
+ * lastFetchBytes as it goes.
+ */
+static inline void metrics_fetch_done(DeviceMetrics* m, bool ok) {
+    if (ok) {
+        m->fetchOk++;
+        m->fetchBytesTotal += m->lastFetchBytes;
+    } else {
+        m->fetchFailed++;
+    }
+}
+
+/**
+ * Prometheus text exposition of the metrics
+ * @returns bytes written (output is truncated to outSize - 1)
+ */
+static inline size_t metrics_format(const DeviceMetrics* m, const MetricsRuntime* rt, char* out, size_t outSize) {
+    size_t o = 0;
+    auto put = [&](const char* fmt, const char* name, unsigned long long v) {
+        if (o + 1 >= outSize) return;
+        int n = snprintf(out + o, outSize - o, fmt, name, v);
+        if (n > 0) o += (size_t)n < outSize - o ? (size_t)n : outSize - o - 1;
+    };
+    auto counter = [&](const char* name, unsigned long long v) { put("cc_%s_total %llu\n", name, v); };
+    auto gauge = [&](const char* name, unsigned long long v) { put("cc_%s %llu\n", name, v); };
+    auto phase = [&](const char* name, const MetricsPhase* p) {
+        put("cc_phase_last_ms{phase=\"%s\"} %llu\n", name, p->lastMs);
+        put("cc_phase_ms_sum{phase=\"%s\"} %llu\n", name, p->totalMs);
+        put("cc_phase_ms_count{phase=\"%s\"} %llu\n", name, p->count);
+    };
+
+    phase("tls", &m->tls);
+    phase("http", &m->http);
+    phase("body", &m->body);
+    phase("load", &m->load);
+    phase("refresh_full", &m->refreshFull);
+    phase("refresh_partial", &m->refreshPartial);
+    phase("fresh", &m->fresh);
+
+    counter("fetch_ok", m->fetchOk);
+    counter("fetch_failed", m->fetchFailed);
+    counter("frames_unchanged", m->framesUnchanged);
+    counter("fetch_bytes", m->fetchBytesTotal);
+    counter("refresh_full", m->refreshFull.count);
+    counter("refresh_partial", m->refreshPartial.count);
+    counter("log_dropped", rt->logDropped);
+    put("cc_tls_handshakes_total{mode=\"%s\"} %llu\n", "pinned", m->tlsPinned);
+    put("cc_tls_handshakes_total{mode=\"%s\"} %llu\n", "verified", m->tlsVerified);
+    put("cc_tls_handshakes_total{mode=\"%s\"} %llu\n", "psk", m->tlsPsk);
+    put("cc_tls_handshakes_total{mode=\"%s\"} %llu\n", "failed", m->tlsFailed);
+    put("cc_fresh_checks_total{result=\"%s\"} %llu\n", "unchanged", m->freshUnchanged);
+    put("cc_fresh_checks_total{result=\"%s\"} %llu\n", "changed", m->freshChanged);
+    put("cc_fresh_checks_total{result=\"%s\"} %llu\n", "unknown", m->freshUnknown);
+    put("cc_fresh_checks_total{result=\"%s\"} %llu\n", "no_reply", m->freshNoReply);
+
+    gauge("last_fetch_bytes", m->lastFetchBytes);
+    gauge("uptime_ms", rt->uptimeMs);
+    gauge("heap_free_bytes", rt->heapFree);
+    gauge("heap_min_free_bytes", rt->heapMin);
+    gauge("heap_max_block_bytes", rt->heapMaxBlock);
+    gauge("partial_since_full", (unsigned long long)(rt->partialSinceFull < 0 ? 0 : rt->partialSinceFull));
+    gauge("consecutive_errors", (unsigned long long)(rt->consecutiveErrors < 0 ? 0 : rt->consecutiveErrors));
+
+    // Signed values
+    if (o + 1 < outSize) {
+        int n = snprintf(out + o, outSize - o, "cc_wifi_rssi_dbm %ld\ncc_last_http_status %ld\n",
+                         (long)rt->rssi, (long)m->lastHttpStatus);
+        if (n > 0) o += (size_t)n < outSize - o ? (size_t)n : outSize - o - 1;
+    }
+    return o;
+}
+
+#endif // DEVICE_METRICS_H
@@ -0,0 +1,121 @@
+/**
+ * Fake BBEPAPER - host framebuffer with the bb_epaper drawing calls
+ * Part of the Commute Compute System™
+ *
+ * Lets device-side renderers (dash-template.h) run on the host: the same
+ * fillRect/drawRect/drawLine/setCursor/print calls draw into a top-down
+ * 1-bit BMP laid out like the device's shadow framebuffer (see
+ * bmp_shadow_init()), so the result can be written to disk and compared
+ * with the server's BMP pixel for pixel.
+ *
+ * Colours follow bb_epaper: 0 = black, 1 = white. Text uses font8x8.h,
+ * the same cell size as bb_epaper's FONT_8x8. Glyph shapes may differ
+ * slightly from the library's, so golden tests mask text areas rather than
+ * compare them exactly.
+ *
+ * Host only.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef FAKE_BBEPAPER_H
+#define FAKE_BBEPAPER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "bmp-stream.h"
+#include "font8x8.h"
+
+class FakeBBEPAPER {
+public:
+    FakeBBEPAPER(int width, int height)
+        : bmp_(BMP_SHADOW_HEADER + (size_t)(((width + 31) / 32) * 4) * height) {
+        bmp_shadow_init(bmp_.data(), bmp_.size(), width, height, &fb_);
+    }
+
+    int width() const { return fb_.width; }
+    int height() const { return fb_.height; }
+
+    // Complete BMP file (header + pixels), as the device's shadow buffer holds it
+    const uint8_t* bmp() const { return bmp_.data(); }
+    size_t bmpSize() const { return bmp_.size(); }
+    const FrameBuffer& frame() const { return fb_; }
+
+    void drawPixel(int x, int y, int color) {
+        if (x < 0 || y < 0 || x >= fb_.width || y >= fb_.height) return;
+        uint8_t* p = fb_.pixels + y * fb_.stride + (x >> 3);
+        uint8_t bit = (uint8_t)(0x80 >> (x & 7));
+        if (color) *p |= bit;
+        else *p &= (uint8_t)~bit;
+    }
+
+    void fillScreen(int color) {
+        memset(fb_.pixels, color ? 0xFF : 0x00, (size_t)fb_.stride * fb_.height);
+    }
+
+    void fillRect(int x, int y, int w, int h, int color) {
+        int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int x1 = x + w > fb_.width ? fb_.width : x + w;
+        int y1 = y + h > fb_.height ? fb_.height : y + h;
+        for (int yy = y0; yy < y1; yy++) {
+            for (int xx = x0; xx < x1; xx++) drawPixel(xx, yy, color);
+        }
+    }
+
+    void drawRect(int x, int y, int w, int h, int color) {
+        if (w <= 0 || h <= 0) return;
+        fillRect(x, y, w, 1, color);
+        fillRect(x, y + h - 1, w, 1, color);
+        fillRect(x, y, 1, h, color);
+        fillRect(x + w - 1, y, 1, h, color);
+    }
+
+    void drawLine(int x0, int y0, int x1, int y1, int color) {
+        int dx = x1 > x0 ? x1 - x0 : x0 - x1, sx = x0 < x1 ? 1 : -1;
+        int dy = y1 > y0 ? y0 - y1 : y1 - y0, sy = y0 < y1 ? 1 : -1;
+        int err = dx + dy;
+        for (;;) {
+            drawPixel(x0, y0, color);
+            if (x0 == x1 && y0 == y1) break;
+            int e2 = 2 * err;
+            if (e2 >= dy) { err += dy; x0 += sx; }
+            if (e2 <= dx) { err += dx; y0 += sy; }
+        }
+    }
+
+    void setFont(int) {}
+    void setCursor(int x, int y) { cx_ = x; cy_ = y; }
+    void setTextColor(int fg, int bg = -1) { fg_ = fg; bg_ = bg; }
+
+    void print(const char* text) {
+        for (; *text; text++) {
+            unsigned char c = (unsigned char)*text;
+            const uint8_t* glyph = font8x8_glyph(c);
+            for (int row = 0; row < 8; row++) {
+                for (int col = 0; col < 8; col++) {
+                    if (glyph[row] & (1 << col)) drawPixel(cx_ + col, cy_ + row, fg_);
+                    else if (bg_ >= 0) drawPixel(cx_ + col, cy_ + row, bg_);
+                }
+            }
+            cx_ += 8;
+        }
+    }
+
+    bool writeBMP(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        bool ok = fwrite(bmp_.data(), 1, bmp_.size(), f) == bmp_.size();
+        return fclose(f) == 0 && ok;
+    }
+
+private:
+    std::vector<uint8_t> bmp_;
+    FrameBuffer fb_;
+    int cx_ = 0, cy_ = 0;
+    int fg_ = 0, bg_ = -1;
+};
+
+#endif // FAKE_BBEPAPER_H
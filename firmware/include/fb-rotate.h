@@ -0,0 +1,225 @@
+/**
+ * FB Rotate - 90/180/270° rotation of 1-bit rows on their way to the framebuffer
+ * Part of the Commute Compute System™
+ *
+ * Lets a panel be mounted portrait (or upside down) without a separate
+ * server render path: frames and zones arrive in the mounted ("logical")
+ * orientation and a RotateSink in front of the framebuffer turns them
+ * into panel rows as they decode.
+ *
+ *   180°      each row is bit-reversed and written to the mirrored row,
+ *             no buffering
+ *   90°/270°  eight rows are collected into a strip, then every 8×8 tile
+ *             is transposed (fb_transpose8(), 32-bit shifts and masks) and
+ *             its eight bytes land in eight consecutive panel rows
+ *
+ * Coordinates passed to begin()/row() are logical: for 90°/270° the
+ * logical screen is fb->height wide and fb->width tall. 90° turns content
+ * clockwise onto the panel, so logical (x, y) is panel (W - 1 - y, x).
+ * Rows may arrive bottom-up (BMP) as with FrameBufferSink, but each band
+ * of eight must be complete before the next starts.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef FB_ROTATE_H
+#define FB_ROTATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "row-sink.h"
+
+enum FbRotation {
+    FB_ROT_0 = 0,
+    FB_ROT_90 = 1,        // Clockwise
+    FB_ROT_180 = 2,
+    FB_ROT_270 = 3
+};
+
+/** Rotation for 0/90/180/270 degrees, -1 for anything else */
+static inline int fb_rotation_from_degrees(long degrees) {
+    if (degrees < 0 || degrees > 270 || degrees % 90 != 0) return -1;
+    return (int)(degrees / 90);
+}
+
+static inline uint8_t fb_reverse8(uint8_t b) {
+    b = (uint8_t)((b >> 4) | (b << 4));
+    b = (uint8_t)(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+    return (uint8_t)(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+}
+
+/**
+ * Transpose an 8×8 bit matrix, one byte per row, MSB = column 0:
+ * bit (7 - c) of out[r] is bit (7 - r) of in[c]. Two 32-bit halves so it
+ * stays in single registers on the ESP32.
+ */
+static inline void fb_transpose8(const uint8_t in[8], uint8_t out[8]) {
+    uint32_t x = ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+    uint32_t y = ((uint32_t)in[4] << 24) | ((uint32_t)in[5] << 16) | ((uint32_t)in[6] << 8) | in[7];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AAu;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AAu;
+    y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000CCCCu;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCCu;
+    y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0u) | ((y >> 4) & 0x0F0F0F0Fu);
+    y = ((x << 4) & 0xF0F0F0F0u) | (y & 0x0F0F0F0Fu);
+    x = t;
+
+    out[0] = (uint8_t)(x >> 24);
+    out[1] = (uint8_t)(x >> 16);
+    out[2] = (uint8_t)(x >> 8);
+    out[3] = (uint8_t)x;
+    out[4] = (uint8_t)(y >> 24);
+    out[5] = (uint8_t)(y >> 16);
+    out[6] = (uint8_t)(y >> 8);
+    out[7] = (uint8_t)y;
+}
+
+/** Logical screen size for a framebuffer mounted at rot */
+static inline void fb_rotated_size(const FrameBuffer* fb, int rot, int* w, int* h) {
+    bool swap = rot == FB_ROT_90 || rot == FB_ROT_270;
+    *w = swap ? fb->height : fb->width;
+    *h = swap ? fb->width : fb->height;
+}
+
+/**
+ * 90° clockwise rotation of a w × h image one pixel at a time into fb
+ * (fb->width must be h, fb->height w). Reference for benches and tests.
+ */
+static inline void fb_rotate90_pixelwise(const uint8_t* src, int srcStride, int w, int h, FrameBuffer* fb) {
+    for (int y = 0; y < h; y++) {
+        const uint8_t* row = src + (size_t)y * srcStride;
+        int px = h - 1 - y;
+        uint8_t bit = (uint8_t)(0x80 >> (px & 7));
+        for (int x = 0; x < w; x++) {
+            uint8_t* d = fb->pixels + (size_t)x * fb->stride + (px >> 3);
+            if ((row[x >> 3] >> (7 - (x & 7))) & 1) *d |= bit;
+            else *d &= (uint8_t)~bit;
+        }
+    }
+}
+
+// ============================================================================
+// ROTATING SINK
+// ============================================================================
+
+#define ROTATE_STRIP_BYTES ((ROW_SINK_MAX_WIDTH + 7) / 8)
+
+struct RotateSink {
+    FrameBuffer* fb;
+    int rot;                // FbRotation
+    int lw, lh;             // Logical screen
+    int x, y, w, h;         // Current image, logical
+    int band;               // 8-row band being collected (90/270), -1 none
+    int bandRows;
+    uint32_t rows;          // Rows accepted for the current image
+    uint8_t strip[8][ROTATE_STRIP_BYTES];
+};
+
+// Transpose the collected band into the framebuffer, tile by tile
+static inline void rotsink_flush_band(RotateSink* s) {
+    int n = s->h - s->band * 8;
+    if (n > 8) n = 8;
+    int ly = s->y + s->band * 8;
+    bool cw = s->rot == FB_ROT_90;
+    // 90: the band's last row comes first along the panel row
+    int px = cw ? s->lh - ly - n : ly;
+    bool whole = n == 8 && (px & 7) == 0;
+    const uint8_t* rows[8];
+    for (int k = 0; k < n; k++) rows[k] = s->strip[cw ? n - 1 - k : k];
+    // Panel row of logical column s->x and the step to the next column
+    ptrdiff_t step = cw ? s->fb->stride : -(ptrdiff_t)s->fb->stride;
+    uint8_t* first = s->fb->pixels + (size_t)(cw ? s->x : s->lw - 1 - s->x) * s->fb->stride;
+    uint8_t tile[8] = { 0 };
+    uint8_t out[8];
+
+    for (int c = 0; c * 8 < s->w; c++) {
+        for (int k = 0; k < n; k++) tile[k] = rows[k][c];
+        fb_transpose8(tile, out);
+        int cols = s->w - c * 8;
+        if (cols > 8) cols = 8;
+        uint8_t* row = first + step * (c * 8);
+        if (whole) {
+            for (int j = 0; j < cols; j++, row += step) row[px >> 3] = out[j];
+        } else {
+            for (int j = 0; j < cols; j++, row += step) fb_copy_bits(row, px, &out[j], n);
+        }
+    }
+    s->band = -1;
+    s->bandRows = 0;
+}
+
+static inline bool rotsink_begin(void* ctx, int x, int y, int w, int h) {
+    RotateSink* s = (RotateSink*)ctx;
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 || w > ROW_SINK_MAX_WIDTH) return false;
+    fb_rotated_size(s->fb, s->rot, &s->lw, &s->lh);
+    if (x + w > s->lw || y + h > s->lh) return false;
+    s->x = x; s->y = y; s->w = w; s->h = h;
+    s->band = -1;
+    s->bandRows = 0;
+    s->rows = 0;
+    return true;
+}
+
+static inline bool rotsink_row(void* ctx, int y, const uint8_t* bits, int w) {
+    RotateSink* s = (RotateSink*)ctx;
+    if (y < s->y || y >= s->y + s->h || w != s->w) return false;
+    int nb = (w + 7) >> 3;
+
+    if (s->rot == FB_ROT_0) {
+        fb_copy_bits(s->fb->pixels + (size_t)y * s->fb->stride, s->x, bits, w);
+    } else if (s->rot == FB_ROT_180) {
+        // Reverse the bytes and their bits, then drop the pad bits that
+        // moved to the front
+        uint8_t* rev = s->strip[0];
+        for (int i = 0; i < nb; i++) rev[i] = fb_reverse8(bits[nb - 1 - i]);
+        int pad = nb * 8 - w;
+        if (pad) {
+            for (int i = 0; i < nb - 1; i++) rev[i] = (uint8_t)((rev[i] << pad) | (rev[i + 1] >> (8 - pad)));
+            rev[nb - 1] = (uint8_t)(rev[nb - 1] << pad);
+        }
+        uint8_t* row = s->fb->pixels + (size_t)(s->lh - 1 - y) * s->fb->stride;
+        fb_copy_bits(row, s->lw - s->x - w, rev, w);
+    } else {
+        int band = (y - s->y) >> 3;
+        if (s->band != band) {
+            if (s->band >= 0) return false;      // Previous band incomplete
+            s->band = band;
+        }
+        memcpy(s->strip[(y - s->y) & 7], bits, nb);
+        int n = s->h - band * 8;
+        if (++s->bandRows >= (n > 8 ? 8 : n)) rotsink_flush_band(s);
+    }
+    s->rows++;
+    return true;
+}
+
+static inline void rotsink_end(void* ctx, bool ok) {
+    RotateSink* s = (RotateSink*)ctx;
+    (void)ok;
+    s->band = -1;           // A partial band is dropped, like a short image
+    s->bandRows = 0;
+}
+
+static inline RowSink rotsink_make(RotateSink* s, FrameBuffer* fb, int rot) {
+    s->fb = fb;
+    s->rot = rot & 3;
+    s->x = s->y = s->w = s->h = 0;
+    s->band = -1;
+    s->bandRows = 0;
+    s->rows = 0;
+    fb_rotated_size(fb, s->rot, &s->lw, &s->lh);
+    RowSink sink = { s, rotsink_begin, rotsink_row, rotsink_end };
+    return sink;
+}
+
+#endif // FB_ROTATE_H
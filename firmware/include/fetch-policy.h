@@ -0,0 +1,276 @@
+/**
+ * Fetch Policy - when the firmware talks to the server
+ * Part of the Commute Compute System™
+ *
+ * The request pattern a fleet puts on the backend is decided here: pairing
+ * polls, the dashboard refresh cadence, full vs partial refreshes, tier
+ * schedules and error backoff. main.cpp uses these timings directly; the
+ * host fleet simulator (src/fleet-sim.cpp) runs this state machine for
+ * hundreds of devices on a simulated clock so that server load can be
+ * measured before the devices exist.
+ *
+ * Two schedules are modelled:
+ *   POLICY_FULL_FRAME - main.cpp: one full-screen BMP every minute, a full
+ *                       panel refresh every 5 min / 30 partials, 5 s retry
+ *                       then a 30 s error hold-off after 5 failures
+ *   POLICY_TIERED     - main-tiered.cpp: tier 1/2/3 zone fetches at 1/2/5
+ *                       min, all zones every 10 min, 2^n s backoff
+ *
+ * With POLICY_PUSH the interval polls are replaced by server notifications
+ * (policy_notify()) plus a slow heartbeat fetch in case one is missed.
+ *
+ * Pure C, no Arduino dependencies - times are milliseconds on any clock.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef FETCH_POLICY_H
+#define FETCH_POLICY_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Pairing
+#define PAIR_POLL_INTERVAL_MS     5000
+#define PAIR_TIMEOUT_MS           600000
+
+// Full-frame schedule (main.cpp)
+#define FETCH_INTERVAL_MS         60000
+#define FULL_REFRESH_MAX_AGE_MS   300000
+#define FETCH_RETRY_DELAY_MS      5000
+#define FETCH_MAX_RETRIES         5
+#define ERROR_HOLDOFF_MS          30000
+
+// Tiered schedule (main-tiered.cpp)
+#define POLICY_TIER1_MS           60000
+#define POLICY_TIER2_MS           120000
+#define POLICY_TIER3_MS           300000
+#define POLICY_TIERED_FULL_MS     600000
+#define POLICY_TIER_TICK_MS       5000
+#define POLICY_MAX_BACKOFF_ERRORS 5
+
+// Push transport
+#define PUSH_HEARTBEAT_MS         900000
+
+// Request header announcing when the device will fetch next (seconds) so
+// the server can pre-render that minute's frame
+#define NEXT_FETCH_HEADER         "X-Next-Fetch"
+
+#ifdef MAX_PARTIAL_BEFORE_FULL
+#define POLICY_MAX_PARTIALS       MAX_PARTIAL_BEFORE_FULL
+#else
+#define POLICY_MAX_PARTIALS       30
+#endif
+
+enum PolicyMode { POLICY_FULL_FRAME = 0, POLICY_TIERED = 1 };
+enum PolicyTransport { POLICY_POLL = 0, POLICY_PUSH = 1 };
+
+enum PolicyAction {
+    POLICY_NONE = 0,
+    POLICY_PAIR_POLL,
+    POLICY_FETCH_FULL,            // Whole screen (full-frame BMP or all zones)
+    POLICY_FETCH_TIER             // One tier's zones (tier in PolicyRequest)
+};
+
+struct PolicyRequest {
+    PolicyAction action;
+    int tier;                     // POLICY_FETCH_TIER only
+    bool fullRefresh;             // Panel will do a full (flashing) refresh
+};
+
+struct FetchPolicy {
+    PolicyMode mode;
+    PolicyTransport transport;
+
+    bool paired;
+    uint32_t pairStart;
+    uint32_t lastPairPoll;
+    bool pairPolled;
+
+    bool initialDrawDone;
+    uint32_t lastFetch;
+    uint32_t lastFullRefresh;
+    uint32_t lastTier[4];
+    int partials;
+
+    int errors;
+    uint32_t retryAt;             // No request before this time
+
+    uint8_t pushPending;          // Bit 0: full frame, bits 1-3: tiers
+    uint32_t lastPushFetch;
+
+    // Counters
+    uint32_t fullRefreshes, partialRefreshes;
+};
+
+static inline void policy_init(FetchPolicy* p, PolicyMode mode, PolicyTransport transport,
+                               bool paired, uint32_t now) {
+    memset(p, 0, sizeof(*p));
+    p->mode = mode;
+    p->transport = transport;
+    p->paired = paired;
+    p->pairStart = now;
+    p->retryAt = now;
+}
+
+static inline bool policy_elapsed(uint32_t now, uint32_t since, uint32_t interval) {
+    return (uint32_t)(now - since) >= interval;
+}
+
+static inline bool policy_needs_full(const FetchPolicy* p, uint32_t now) {
+    uint32_t maxAge = p->mode == POLICY_TIERED ? POLICY_TIERED_FULL_MS : FULL_REFRESH_MAX_AGE_MS;
+    return !p->initialDrawDone || policy_elapsed(now, p->lastFullRefresh, maxAge) ||
+           p->partials >= POLICY_MAX_PARTIALS;
+}
+
+/**
+ * Pairing completed - fetch the dashboard straight away (initial full draw)
+ */
+static inline void policy_paired(FetchPolicy* p, uint32_t now) {
+    p->paired = true;
+    p->initialDrawDone = false;
+    p->retryAt = now;
+}
+
+/**
+ * Server-side change notification (push transport). tierMask bit n set
+ * means tier n changed; bit 0 means "the full frame changed".
+ */
+static inline void policy_notify(FetchPolicy* p, uint8_t tierMask) {
+    p->pushPending |= tierMask;
+}
+
+/**
+ * What (if anything) the device does at `now`
+ */
+static inline bool policy_due(FetchPolicy* p, uint32_t now, PolicyRequest* req) {
+    memset(req, 0, sizeof(*req));
+    if ((int32_t)(now - p->retryAt) < 0) return false;
+
+    if (!p->paired) {
+        if (policy_elapsed(now, p->pairStart, PAIR_TIMEOUT_MS)) {
+            p->pairStart = now;   // New code, new setup screen
+        }
+        if (!p->pairPolled || policy_elapsed(now, p->lastPairPoll, PAIR_POLL_INTERVAL_MS)) {
+            req->action = POLICY_PAIR_POLL;
+            return true;
+        }
+        return false;
+    }
+
+    bool needsFull = policy_needs_full(p, now);
+    bool push = p->transport == POLICY_PUSH;
+    bool heartbeat = push && policy_elapsed(now, p->lastPushFetch, PUSH_HEARTBEAT_MS);
+
+    if (p->mode == POLICY_FULL_FRAME) {
+        bool due = push ? (p->pushPending || heartbeat || !p->initialDrawDone)
+                        : (!p->initialDrawDone || policy_elapsed(now, p->lastFetch, FETCH_INTERVAL_MS));
+        if (!due) return false;
+        req->action = POLICY_FETCH_FULL;
+        req->fullRefresh = needsFull;
+        return true;
+    }
+
+    // Tiered: push still honours the 10 min all-zones refresh (ghosting)
+    if (needsFull || heartbeat) {
+        req->action = POLICY_FETCH_FULL;
+        req->fullRefresh = true;
+        return true;
+    }
+    static const uint32_t intervals[4] = { 0, POLICY_TIER1_MS, POLICY_TIER2_MS, POLICY_TIER3_MS };
+    for (int t = 1; t <= 3; t++) {
+        bool due = push ? (p->pushPending & (1 << t)) != 0
+                        : policy_elapsed(now, p->lastTier[t], intervals[t]);
+        if (due) {
+            req->action = POLICY_FETCH_TIER;
+            req->tier = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Record the outcome of the request returned by policy_due()
+ */
+static inline void policy_done(FetchPolicy* p, const PolicyRequest* req, uint32_t now, bool ok) {
+    switch (req->action) {
+        case POLICY_PAIR_POLL:
+            p->pairPolled = true;
+            p->lastPairPoll = now;
+            return;
+
+        case POLICY_FETCH_FULL:
+            if (ok) {
+                p->errors = 0;
+                p->retryAt = now;
+                p->lastFetch = now;
+                p->lastPushFetch = now;
+                p->pushPending = 0;
+                p->initialDrawDone = true;
+                if (req->fullRefresh) {
+                    p->lastFullRefresh = now;
+                    p->partials = 0;
+                    p->fullRefreshes++;
+                    for (int t = 1; t <= 3; t++) p->lastTier[t] = now;
+                } else {
+                    p->partials++;
+                    p->partialRefreshes++;
+                }
+                return;
+            }
+            break;
+
+        case POLICY_FETCH_TIER:
+            if (ok) {
+                p->errors = 0;
+                p->retryAt = now;
+                p->lastTier[req->tier] = now;
+                p->pushPending &= (uint8_t)~(1 << req->tier);
+                p->partials++;
+                p->partialRefreshes++;
+                return;
+            }
+            break;
+
+        default:
+            return;
+    }
+
+    // Failure
+    p->errors++;
+    if (p->mode == POLICY_TIERED) {
+        int capped = p->errors < POLICY_MAX_BACKOFF_ERRORS ? p->errors : POLICY_MAX_BACKOFF_ERRORS;
+        p->retryAt = now + (1UL << capped) * 1000UL;
+    } else if (p->errors > FETCH_MAX_RETRIES) {
+        p->errors = 0;
+        p->retryAt = now + ERROR_HOLDOFF_MS;
+    } else {
+        p->retryAt = now + FETCH_RETRY_DELAY_MS;
+    }
+}
+
+/**
+ * Earliest time policy_due() can next return true (push: excluding
+ * notifications, which wake the device on their own)
+ */
+static inline uint32_t policy_next_wake(const FetchPolicy* p, uint32_t now) {
+    if ((int32_t)(now - p->retryAt) < 0) return p->retryAt;
+    if (!p->paired) return p->pairPolled ? p->lastPairPoll + PAIR_POLL_INTERVAL_MS : now;
+    if (p->mode == POLICY_TIERED && p->transport == POLICY_POLL) return now + POLICY_TIER_TICK_MS;
+
+    uint32_t wake;
+    if (p->transport == POLICY_PUSH) {
+        wake = p->lastPushFetch + PUSH_HEARTBEAT_MS;
+        if (p->mode == POLICY_TIERED) {
+            uint32_t full = p->lastFullRefresh + POLICY_TIERED_FULL_MS;
+            if ((int32_t)(full - wake) < 0) wake = full;
+        }
+    } else {
+        wake = p->lastFetch + FETCH_INTERVAL_MS;
+    }
+    return (int32_t)(wake - now) < 0 ? now : wake;
+}
+
+#endif // FETCH_POLICY_H
@@ -0,0 +1,162 @@
+/**
+ * Frame Cache - multi-slot shadow framebuffers for PSRAM builds
+ * Part of the Commute Compute System™
+ *
+ * Each slot is a complete top-down 1-bit BMP (see bmp_shadow_init()) so
+ * bb_epaper's loadBMP() can draw any slot directly. One slot is the
+ * "front" (what the panel shows); new frames are decoded into a "back"
+ * slot and only become the front once they have decoded completely, so a
+ * truncated download never leaves a half-written shadow behind.
+ *
+ * Committed frames are hashed: a frame identical to the front needs no
+ * panel refresh at all, and a frame identical to an older slot is
+ * recognised as a cache hit (e.g. pages that alternate).
+ *
+ * The caller provides the storage (PSRAM on the ESP32-S3).
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "row-sink.h"
+#include "bmp-stream.h"
+
+#define FRAME_CACHE_MAX_SLOTS 8
+
+enum FrameCacheResult {
+    FRAMECACHE_NEW = 0,           // New content, now the front
+    FRAMECACHE_HIT = 1,           // Same as an older slot, which is now the front
+    FRAMECACHE_UNCHANGED = 2,     // Same as the front - nothing to draw
+    FRAMECACHE_ERR = -1
+};
+
+struct FrameCacheSlot {
+    uint8_t* bmp;                 // BMP header + pixels (loadBMP-ready)
+    FrameBuffer fb;
+    uint32_t hash;
+    uint32_t lastUsed;
+    bool valid;
+};
+
+struct FrameCache {
+    FrameCacheSlot slots[FRAME_CACHE_MAX_SLOTS];
+    int count;
+    int front;                    // Slot the panel shows (starts at 0, white)
+    int back;                     // -1 when no frame is being decoded
+    uint32_t clock;
+    uint32_t hits, misses, unchanged;
+};
+
+static inline uint32_t framecache_hash(const FrameBuffer* fb) {
+    uint32_t h = 0x811C9DC5u;
+    size_t n = (size_t)fb->stride * fb->height;
+    for (size_t i = 0; i < n; i++) {
+        h ^= fb->pixels[i];
+        h *= 0x01000193u;
+    }
+    return h;
+}
+
+/**
+ * Split storage into `count` slots of slotBytes, each initialised as a
+ * white width x height shadow BMP
+ */
+static inline bool framecache_init(FrameCache* c, uint8_t* storage, int count, size_t slotBytes,
+                                   int width, int height) {
+    if (!storage || count < 2 || count > FRAME_CACHE_MAX_SLOTS) return false;
+    memset(c, 0, sizeof(*c));
+    c->count = count;
+    c->front = 0;
+    c->back = -1;
+    for (int i = 0; i < count; i++) {
+        FrameCacheSlot* s = &c->slots[i];
+        s->bmp = storage + (size_t)i * slotBytes;
+        if (!bmp_shadow_init(s->bmp, slotBytes, width, height, &s->fb)) return false;
+    }
+    return true;
+}
+
+/**
+ * Pick the least recently used non-front slot to decode into.
+ * copyFront seeds it with the front's pixels (for partial/zone updates).
+ */
+static inline FrameBuffer* framecache_begin(FrameCache* c, bool copyFront) {
+    int best = -1;
+    for (int i = 0; i < c->count; i++) {
+        if (i == c->front) continue;
+        if (best < 0 || !c->slots[i].valid ||
+            (c->slots[best].valid && c->slots[i].lastUsed < c->slots[best].lastUsed)) {
+            best = i;
+        }
+        if (!c->slots[best].valid) break;
+    }
+    c->back = best;
+    FrameCacheSlot* s = &c->slots[best];
+    s->valid = false;
+    if (copyFront) {
+        memcpy(s->fb.pixels, c->slots[c->front].fb.pixels, (size_t)s->fb.stride * s->fb.height);
+    }
+    return &s->fb;
+}
+
+/**
+ * Discard the back slot (decode failed)
+ */
+static inline void framecache_abort(FrameCache* c) {
+    c->back = -1;
+}
+
+/**
+ * Promote the fully decoded back slot
+ */
+static inline int framecache_commit(FrameCache* c) {
+    if (c->back < 0) return FRAMECACHE_ERR;
+    FrameCacheSlot* b = &c->slots[c->back];
+    uint32_t hash = framecache_hash(&b->fb);
+    c->clock++;
+
+    if (c->slots[c->front].valid && c->slots[c->front].hash == hash) {
+        c->slots[c->front].lastUsed = c->clock;
+        c->back = -1;
+        c->unchanged++;
+        return FRAMECACHE_UNCHANGED;
+    }
+    for (int i = 0; i < c->count; i++) {
+        if (i != c->back && c->slots[i].valid && c->slots[i].hash == hash) {
+            c->slots[i].lastUsed = c->clock;
+            c->front = i;
+            c->back = -1;
+            c->hits++;
+            return FRAMECACHE_HIT;
+        }
+    }
+    b->hash = hash;
+    b->valid = true;
+    b->lastUsed = c->clock;
+    c->front = c->back;
+    c->back = -1;
+    c->misses++;
+    return FRAMECACHE_NEW;
+}
+
+/**
+ * The front slot was written outside begin/commit (e.g. BLE frame push)
+ * or the panel shows something else - forget its hash so the next
+ * commit is always drawn
+ */
+static inline void framecache_dirty_front(FrameCache* c) {
+    c->slots[c->front].valid = false;
+    c->slots[c->front].hash = 0;
+}
+
+static inline FrameCacheSlot* framecache_front(FrameCache* c) {
+    return &c->slots[c->front];
+}
+
+#endif // FRAME_CACHE_H
@@ -0,0 +1,247 @@
+/**
+ * Compressed Zone Frame Codec (CCZF)
+ * Part of the Commute Compute System™
+ *
+ * Wire format for pushing dashboard zones straight to the device without
+ * HTTP (BLE frame push, local tools). A push is a sequence of zone frames:
+ *
+ *   off  size  field
+ *   0    4     magic "CCZF"
+ *   4    1     version (1)
+ *   5    1     flags (bit0 = refresh panel after this zone,
+ *                     bit1 = full refresh instead of partial)
+ *   6    2     x        (all little-endian)
+ *   8    2     y
+ *   10   2     width
+ *   12   2     height
+ *   14   4     payload length (compressed bytes that follow)
+ *   18   ...   PackBits-compressed rows, ((width + 7) / 8) bytes per row,
+ *              1-bit MSB first, bit = 1 white
+ *
+ * Decoding is fully incremental: bytes can arrive in any split (e.g. one
+ * BLE write at a time) and rows are emitted to a RowSink as soon as they
+ * are complete. Encoder: src/services/frame-codec.js.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "row-sink.h"
+
+#define FRAME_HEADER_SIZE     18
+#define FRAME_VERSION         1
+#define FRAME_FLAG_REFRESH    0x01
+#define FRAME_FLAG_FULL       0x02
+
+enum FrameDecodeResult {
+    FRAME_OK = 0,
+    FRAME_ERR_MAGIC = -1,
+    FRAME_ERR_BOUNDS = -2,        // Zone outside screen / too wide
+    FRAME_ERR_DATA = -3,          // Payload too short/long for the zone
+    FRAME_ERR_SINK = -4
+};
+
+struct FrameZone {
+    uint8_t flags;
+    uint16_t x, y, w, h;
+    uint32_t payloadLen;
+};
+
+struct FrameDecoder {
+    const RowSink* sink;
+    int screenW, screenH;
+
+    // Called after each completed zone (may be nullptr)
+    void (*onZone)(void* ctx, const FrameZone* zone);
+    void* onZoneCtx;
+
+    uint8_t header[FRAME_HEADER_SIZE];
+    uint8_t headerLen;
+    FrameZone zone;
+    uint32_t payloadLeft;
+
+    // PackBits state
+    int literalLeft;
+    int repeatLeft;
+    bool needRepeatByte;
+
+    uint8_t row[ROW_SINK_MAX_WIDTH / 8];
+    uint16_t rowBytes;
+    uint16_t rowPos;
+    uint16_t rowY;
+
+    uint32_t zonesDone;
+    uint32_t bytesIn;
+    int error;
+};
+
+static inline void frame_decoder_init(FrameDecoder* d, const RowSink* sink, int screenW, int screenH) {
+    memset(d, 0, sizeof(*d));
+    d->sink = sink;
+    d->screenW = screenW;
+    d->screenH = screenH;
+}
+
+/**
+ * Drop any partial zone (e.g. after a disconnect) and wait for a new header
+ */
+static inline void frame_decoder_reset(FrameDecoder* d) {
+    if (d->headerLen == FRAME_HEADER_SIZE && d->sink) d->sink->end(d->sink->ctx, false);
+    d->headerLen = 0;
+    d->payloadLeft = 0;
+    d->literalLeft = d->repeatLeft = 0;
+    d->needRepeatByte = false;
+    d->rowPos = d->rowY = 0;
+    d->error = FRAME_OK;
+}
+
+static inline int frame_decoder_fail(FrameDecoder* d, int err) {
+    if (d->headerLen == FRAME_HEADER_SIZE) d->sink->end(d->sink->ctx, false);
+    d->headerLen = 0;
+    d->error = err;
+    return err;
+}
+
+static inline int frame_decoder_start_zone(FrameDecoder* d) {
+    const uint8_t* h = d->header;
+    if (memcmp(h, "CCZF", 4) != 0 || h[4] != FRAME_VERSION) return FRAME_ERR_MAGIC;
+
+    FrameZone& z = d->zone;
+    z.flags = h[5];
+    z.x = (uint16_t)(h[6] | (h[7] << 8));
+    z.y = (uint16_t)(h[8] | (h[9] << 8));
+    z.w = (uint16_t)(h[10] | (h[11] << 8));
+    z.h = (uint16_t)(h[12] | (h[13] << 8));
+    z.payloadLen = (uint32_t)h[14] | ((uint32_t)h[15] << 8) | ((uint32_t)h[16] << 16) | ((uint32_t)h[17] << 24);
+
+    if (z.w == 0 || z.h == 0 || z.w > ROW_SINK_MAX_WIDTH) return FRAME_ERR_BOUNDS;
+    if ((int)z.x + z.w > d->screenW || (int)z.y + z.h > d->screenH) return FRAME_ERR_BOUNDS;
+    if (z.payloadLen == 0) return FRAME_ERR_DATA;
+    if (!d->sink->begin(d->sink->ctx, z.x, z.y, z.w, z.h)) return FRAME_ERR_SINK;
+
+    d->payloadLeft = z.payloadLen;
+    d->rowBytes = (uint16_t)((z.w + 7) / 8);
+    d->rowPos = 0;
+    d->rowY = 0;
+    d->literalLeft = d->repeatLeft = 0;
+    d->needRepeatByte = false;
+    return FRAME_OK;
+}
+
+/**
+ * Append one decompressed byte to the current row, emitting full rows.
+ * Returns false if the zone overflows or the sink rejects a row.
+ */
+static inline bool frame_decoder_put(FrameDecoder* d, uint8_t b) {
+    if (d->rowY >= d->zone.h) return false;
+    d->row[d->rowPos++] = b;
+    if (d->rowPos == d->rowBytes) {
+        if (!d->sink->row(d->sink->ctx, d->zone.y + d->rowY, d->row, d->zone.w)) return false;
+        d->rowPos = 0;
+        d->rowY++;
+    }
+    return true;
+}
+
+/**
+ * Feed received bytes. Returns FRAME_OK or a negative error; after an error
+ * the decoder must be reset before it accepts more data.
+ */
+static inline int frame_decoder_feed(FrameDecoder* d, const uint8_t* data, size_t len) {
+    if (d->error) return d->error;
+    d->bytesIn += len;
+
+    size_t i = 0;
+    while (i < len) {
+        if (d->headerLen < FRAME_HEADER_SIZE) {
+            d->header[d->headerLen++] = data[i++];
+            if (d->headerLen == FRAME_HEADER_SIZE) {
+                int r = frame_decoder_start_zone(d);
+                if (r != FRAME_OK) {
+                    d->headerLen = 0;
+                    d->error = r;
+                    return r;
+                }
+            }
+            continue;
+        }
+
+        uint8_t b = data[i++];
+        d->payloadLeft--;
+
+        if (d->needRepeatByte) {
+            d->needRepeatByte = false;
+            while (d->repeatLeft > 0) {
+                if (!frame_decoder_put(d, b)) return frame_decoder_fail(d, FRAME_ERR_DATA);
+                d->repeatLeft--;
+            }
+        } else if (d->literalLeft > 0) {
+            if (!frame_decoder_put(d, b)) return frame_decoder_fail(d, FRAME_ERR_DATA);
+            d->literalLeft--;
+        } else {
+            int8_t n = (int8_t)b;
+            if (n >= 0) {
+                d->literalLeft = n + 1;
+            } else if (n != -128) {
+                d->repeatLeft = 1 - n;
+                d->needRepeatByte = true;
+            }
+        }
+
+        if (d->payloadLeft == 0) {
+            // Zone payload consumed - it must have filled every row exactly
+            if (d->rowY != d->zone.h || d->literalLeft || d->needRepeatByte) {
+                return frame_decoder_fail(d, FRAME_ERR_DATA);
+            }
+            d->sink->end(d->sink->ctx, true);
+            d->zonesDone++;
+            if (d->onZone) d->onZone(d->onZoneCtx, &d->zone);
+            d->headerLen = 0;
+        }
+    }
+    return FRAME_OK;
+}
+
+// ============================================================================
+// ENCODER (host tools / tests; the device only decodes)
+// ============================================================================
+
+/**
+ * PackBits-compress src into dst. Returns bytes written, or 0 if dst is too
+ * small (worst case is len + (len + 127) / 128).
+ */
+static inline size_t frame_packbits(const uint8_t* src, size_t len, uint8_t* dst, size_t dstSize) {
+    size_t i = 0, o = 0;
+    while (i < len) {
+        size_t run = 1;
+        while (i + run < len && run < 128 && src[i + run] == src[i]) run++;
+        if (run >= 3 || (run == 2 && i + run == len)) {
+            if (o + 2 > dstSize) return 0;
+            dst[o++] = (uint8_t)(int8_t)(1 - (int)run);
+            dst[o++] = src[i];
+            i += run;
+            continue;
+        }
+        // Literal run until the next 3-byte repeat
+        size_t start = i;
+        size_t lit = 0;
+        while (i < len && lit < 128) {
+            if (i + 2 < len && src[i] == src[i + 1] && src[i] == src[i + 2]) break;
+            i++;
+            lit++;
+        }
+        if (o + 1 + lit > dstSize) return 0;
+        dst[o++] = (uint8_t)(lit - 1);
+        memcpy(dst + o, src + start, lit);
+        o += lit;
+    }
+    return o;
+}
+
+#endif // FRAME_CODEC_H
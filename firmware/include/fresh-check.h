@@ -0,0 +1,203 @@
+/**
+ * Fresh Check - UDP "has my frame changed?" query before an HTTPS fetch
+ * Part of the Commute Compute System™
+ *
+ * Most polls find the frame unchanged, but finding that out over HTTPS
+ * costs a TCP connect and a TLS handshake with the radio on. main.cpp
+ * first sends one datagram with the freshness hashes of the frame it
+ * shows (X-Fresh-Hashes from the last BMP response) and only fetches if
+ * the reply says something changed - or if no valid reply arrives in time.
+ *
+ * Freshness hashes leave out the clock and the departure countdowns, or
+ * a poll a minute after its frame would never match; "unchanged" means
+ * only those moved. The device skips at most FRESH_MAX_SKIPS polls in a
+ * row on it, which bounds how far the clock and countdowns lag.
+ * Protocol and responder: src/services/fresh-check.js
+ *
+ *   Query  u8 version=1, u8 type=1, u8 idLen, identity[idLen],
+ *          u8 deviceId[8], u32le nonce, u8 count, u32le hash × count,
+ *          u8 tag[16]
+ *   Reply  u8 version=1, u8 type=2, u8 status, u8 zones, u32le nonce,
+ *          u32le changed, u8 tag[16]
+ *
+ * Tags are HMAC-SHA256 truncated to 16 bytes, keyed with
+ * HMAC-SHA256(PSK, "cc-fresh-v1") - the PSK from pairing (tls-psk.h).
+ * The HMAC itself comes from the caller (mbedTLS on the device) through
+ * FreshMacFn. deviceId is the first 8 bytes of SHA-256 of the config
+ * token in the webhook URL.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef FRESH_CHECK_H
+#define FRESH_CHECK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define FRESH_HASH_HEADER     "X-Fresh-Hashes"
+#define FRESH_VERSION         1
+#define FRESH_TYPE_QUERY      1
+#define FRESH_TYPE_REPLY      2
+#define FRESH_TAG_BYTES       16
+#define FRESH_DEVICE_ID_BYTES 8
+#define FRESH_IDENTITY_MAX    32
+#define FRESH_HASH_MAX        16
+#define FRESH_QUERY_MAX       (3 + FRESH_IDENTITY_MAX + FRESH_DEVICE_ID_BYTES + 5 + 4 * FRESH_HASH_MAX + FRESH_TAG_BYTES)
+#define FRESH_REPLY_BYTES     (12 + FRESH_TAG_BYTES)
+#define FRESH_ENDPOINT_MAX    72      // "host:port" + NUL
+#define FRESH_TIMEOUT_MS      400     // Reply wait before falling back to HTTPS
+#define FRESH_FAIL_LIMIT      3
+#define FRESH_RETRY_POLLS     10
+#ifndef FRESH_MAX_SKIPS
+#define FRESH_MAX_SKIPS       1       // "Unchanged" polls in a row before fetching anyway
+#endif
+
+enum FreshStatus {
+    FRESH_UNCHANGED = 0,
+    FRESH_CHANGED = 1,
+    FRESH_UNKNOWN = 2,        // Server has not seen this device recently
+    FRESH_NO_REPLY = -1       // Timeout, bad tag or wrong nonce (device side only)
+};
+
+// HMAC-SHA256 of data under the check key, full 32 bytes
+typedef void (*FreshMacFn)(void* ctx, const uint8_t* data, size_t len, uint8_t out[32]);
+
+struct FreshQuery {
+    const char* identity;                     // PSK identity
+    uint8_t deviceId[FRESH_DEVICE_ID_BYTES];
+    uint32_t nonce;                           // Random per query
+    uint8_t count;                            // 0 = showing nothing
+    const uint32_t* hash;
+};
+
+struct FreshReply {
+    uint8_t status;           // FreshStatus
+    uint8_t zones;            // Active zones on the server
+    uint32_t changed;         // Bit i: server zone i is not among the sent hashes
+};
+
+// Skips the check for a while after repeated silence (UDP blocked, no
+// responder), and after FRESH_MAX_SKIPS fetches saved in a row
+struct FreshState {
+    uint8_t failures;
+    uint8_t skip;
+    uint8_t unchanged;
+};
+
+static inline void fresh_put_u32(uint8_t* p, uint32_t v) {
+    for (int b = 0; b < 4; b++) p[b] = (uint8_t)(v >> (8 * b));
+}
+
+static inline uint32_t fresh_get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * Build and tag a query datagram
+ * @returns bytes written, or 0 if the identity or hash count is out of range
+ */
+static inline size_t fresh_encode_query(const FreshQuery* q, uint8_t* out, size_t outSize,
+                                        FreshMacFn mac, void* ctx) {
+    size_t idLen = strlen(q->identity);
+    if (idLen == 0 || idLen > FRESH_IDENTITY_MAX || q->count > FRESH_HASH_MAX) return 0;
+    size_t len = 3 + idLen + FRESH_DEVICE_ID_BYTES + 5 + 4 * (size_t)q->count;
+    if (len + FRESH_TAG_BYTES > outSize) return 0;
+
+    uint8_t* p = out;
+    *p++ = FRESH_VERSION;
+    *p++ = FRESH_TYPE_QUERY;
+    *p++ = (uint8_t)idLen;
+    memcpy(p, q->identity, idLen);
+    p += idLen;
+    memcpy(p, q->deviceId, FRESH_DEVICE_ID_BYTES);
+    p += FRESH_DEVICE_ID_BYTES;
+    fresh_put_u32(p, q->nonce);
+    p += 4;
+    *p++ = q->count;
+    for (uint8_t i = 0; i < q->count; i++, p += 4) fresh_put_u32(p, q->hash[i]);
+
+    uint8_t tag[32];
+    mac(ctx, out, len, tag);
+    memcpy(out + len, tag, FRESH_TAG_BYTES);
+    return len + FRESH_TAG_BYTES;
+}
+
+/**
+ * Check a reply datagram against the query it answers
+ * @returns false (r untouched) unless the tag verifies and the nonce matches
+ */
+static inline bool fresh_decode_reply(const uint8_t* data, size_t len, uint32_t nonce,
+                                      FreshReply* r, FreshMacFn mac, void* ctx) {
+    if (len != FRESH_REPLY_BYTES || data[0] != FRESH_VERSION || data[1] != FRESH_TYPE_REPLY) return false;
+    uint8_t tag[32];
+    mac(ctx, data, 12, tag);
+    uint8_t diff = 0;
+    for (int i = 0; i < FRESH_TAG_BYTES; i++) diff |= (uint8_t)(tag[i] ^ data[12 + i]);
+    if (diff != 0 || fresh_get_u32(data + 4) != nonce) return false;
+    if (data[2] > FRESH_UNKNOWN) return false;
+    r->status = data[2];
+    r->zones = data[3];
+    r->changed = fresh_get_u32(data + 8);
+    return true;
+}
+
+/**
+ * Host and port of a "host:port" endpoint
+ * @returns false if either part is missing or host does not fit
+ */
+static inline bool fresh_endpoint(const char* endpoint, char* host, size_t hostSize, uint16_t* port) {
+    const char* colon = strrchr(endpoint, ':');
+    if (!colon || colon == endpoint || (size_t)(colon - endpoint) >= hostSize) return false;
+    long p = 0;
+    for (const char* c = colon + 1; *c; c++) {
+        if (*c < '0' || *c > '9' || (p = p * 10 + (*c - '0')) > 65535) return false;
+    }
+    if (p == 0) return false;
+    memcpy(host, endpoint, colon - endpoint);
+    host[colon - endpoint] = '\0';
+    *port = (uint16_t)p;
+    return true;
+}
+
+/**
+ * Config token of a webhook URL (".../api/device/<token>[?...]")
+ * @returns token length, 0 if the URL has none; *token points into url
+ */
+static inline size_t fresh_url_token(const char* url, const char** token) {
+    const char* p = strstr(url, "/api/device/");
+    if (!p) return 0;
+    p += 12;
+    size_t n = 0;
+    while (p[n] && p[n] != '?' && p[n] != '/' && p[n] != '#') n++;
+    *token = p;
+    return n;
+}
+
+/** true if this poll should be checked over UDP first */
+static inline bool fresh_should_try(FreshState* s) {
+    if (s->unchanged >= FRESH_MAX_SKIPS) {
+        s->unchanged = 0;         // Clock and countdowns are due a redraw
+        return false;
+    }
+    if (s->skip == 0) return true;
+    s->skip--;
+    return false;
+}
+
+/** Record the answer to a check (a FreshStatus, or FRESH_NO_REPLY) */
+static inline void fresh_record(FreshState* s, int status) {
+    s->unchanged = status == FRESH_UNCHANGED ? s->unchanged + 1 : 0;
+    if (status != FRESH_NO_REPLY) {
+        s->failures = 0;
+        return;
+    }
+    if (++s->failures >= FRESH_FAIL_LIMIT) {
+        s->failures = 0;
+        s->skip = FRESH_RETRY_POLLS;
+    }
+}
+
+#endif // FRESH_CHECK_H
@@ -0,0 +1,39 @@
+/**
+ * Fuzz Target - shared entry-point macro for the host fuzz harnesses
+ * Part of the Commute Compute System™
+ *
+ * Each src/fuzz-*.cpp harness declares its entry with CC_FUZZ_TARGET(name).
+ * Built with -D CC_LIBFUZZER (env:native-fuzz-*) it becomes libFuzzer's
+ * LLVMFuzzerTestOneInput; otherwise it is an ordinary function that
+ * src/fuzz-bench.cpp links together with the other harnesses to replay and
+ * time the corpus (env:native-fuzz-bench).
+ *
+ * CC_FUZZ_CHECK() aborts on a broken invariant so both libFuzzer and the
+ * replay driver report it as a crash with the offending input.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef FUZZ_TARGET_H
+#define FUZZ_TARGET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef CC_LIBFUZZER
+#define CC_FUZZ_TARGET(name) extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+#else
+#define CC_FUZZ_TARGET(name) int cc_fuzz_##name(const uint8_t* data, size_t size)
+#endif
+
+#define CC_FUZZ_CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "fuzz check failed: %s (%s:%d)\n", #cond, __FILE__, __LINE__); \
+        abort(); \
+    } \
+} while (0)
+
+#endif // FUZZ_TARGET_H
@@ -0,0 +1,509 @@
+/**
+ * HTTP Lite - fixed-buffer HTTP/1.1 client for the dashboard fetch
+ * Part of the Commute Compute System™
+ *
+ * Replaces HTTPClient on the fetch path. HTTPClient builds a String for
+ * the URL, every request header and every collected response header, and
+ * headers have to be registered with collectHeaders() before each request.
+ * Here nothing is allocated:
+ *
+ *   - the request is formatted into a stack buffer and written in one go;
+ *   - response lines go through a line buffer the caller provides (sized
+ *     for the longest header it cares about). Each header is handed to
+ *     onHeader(name, value) and then dropped. Lines that do not fit are
+ *     skipped and counted;
+ *   - body bytes go to onBody() straight out of the receive buffer, with
+ *     Content-Length, chunked and read-until-close framing;
+ *   - the connection stays open between responses unless the server says
+ *     Connection: close. Several requests can be sent before the first
+ *     response is read (pipelining); bytes of the next response left in the
+ *     receive buffer are kept for it.
+ *
+ * The socket is reached through HttpLiteIo callbacks. main.cpp wraps the
+ * TlsClient that tlsConnect() has already authenticated, so pinning and
+ * PSK still apply.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef HTTP_LITE_H
+#define HTTP_LITE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef HTTP_LITE_RX_MAX
+#define HTTP_LITE_RX_MAX        1024    // Receive buffer per connection
+#endif
+#ifndef HTTP_LITE_REQUEST_MAX
+#define HTTP_LITE_REQUEST_MAX   1536    // Formatted request (URL tokens are long)
+#endif
+#define HTTP_LITE_MAX_BODY      0x7FFFFFFFu
+
+// Results below 0 (HTTPClient uses -1..-11, so these do not overlap)
+#define HTTP_LITE_ERR_CLOSED    -20     // Connection closed before the response ended
+#define HTTP_LITE_ERR_TIMEOUT   -21     // No data within the read timeout
+#define HTTP_LITE_ERR_PROTOCOL  -22     // Bad status line, header or chunk framing
+#define HTTP_LITE_ERR_SINK      -23     // onBody refused the data
+#define HTTP_LITE_ERR_REQUEST   -24     // Request too long or write failed
+#define HTTP_LITE_ERR_STATE     -25     // Connection unusable, or nothing in flight
+
+// Name and value are NUL-terminated, value trimmed; both are gone after the call
+typedef void (*HttpLiteHeaderFn)(void* ctx, const char* name, const char* value);
+// false stops the response with HTTP_LITE_ERR_SINK
+typedef bool (*HttpLiteBodyFn)(void* ctx, const uint8_t* data, size_t len);
+
+enum HttpLitePhase : uint8_t {
+    HTTP_LITE_STATUS,
+    HTTP_LITE_HEADERS,
+    HTTP_LITE_BODY,         // Content-Length or until close
+    HTTP_LITE_CHUNK_SIZE,
+    HTTP_LITE_CHUNK_DATA,
+    HTTP_LITE_CHUNK_END,    // CRLF after chunk data
+    HTTP_LITE_TRAILERS,
+    HTTP_LITE_DONE,
+    HTTP_LITE_FAILED
+};
+
+struct HttpLiteResponse {
+    // Set up by httplite_response_init; onBody/ctx may change before the body
+    HttpLiteHeaderFn onHeader;
+    HttpLiteBodyFn onBody;
+    void* ctx;
+    char* line;
+    size_t lineSize;
+    bool head;              // HEAD request: headers only
+
+    // Result
+    int status;             // 0 until the status line is parsed
+    int64_t contentLength;  // -1 if not sent
+    bool chunked;
+    bool keepAlive;         // Connection may carry another request afterwards
+    bool untilClose;        // Body ends when the server closes
+    uint32_t bodyBytes;
+    uint16_t headersDropped;  // Lines longer than lineSize
+    int error;              // HTTP_LITE_ERR_* once phase is FAILED
+
+    // Parser state
+    uint8_t phase;
+    bool http10;
+    bool skipLine;          // Discarding the rest of an overlong line
+    size_t lineLen;
+    uint64_t remaining;     // Body or chunk bytes left
+};
+
+// Byte stream the connection runs over
+struct HttpLiteIo {
+    // Up to len bytes: > 0 read, 0 = nothing within the timeout, < 0 = closed
+    int (*read)(void* ctx, uint8_t* buf, size_t len);
+    // true once all len bytes are written
+    bool (*write)(void* ctx, const uint8_t* buf, size_t len);
+    void* ctx;
+};
+
+struct HttpLiteConn {
+    HttpLiteIo io;
+    uint8_t rx[HTTP_LITE_RX_MAX];
+    size_t rxPos;
+    size_t rxLen;
+    uint8_t inFlight;       // Requests sent whose response has not been read
+    bool usable;            // false after Connection: close, an error or EOF
+};
+
+// ============================================================================
+// RESPONSE PARSER
+// ============================================================================
+
+/** ASCII case-insensitive header name comparison */
+static inline bool httplite_name_is(const char* name, const char* want) {
+    for (; *name && *want; name++, want++) {
+        char a = *name, b = *want;
+        if (a >= 'A' && a <= 'Z') a += 'a' - 'A';
+        if (b >= 'A' && b <= 'Z') b += 'a' - 'A';
+        if (a != b) return false;
+    }
+    return *name == *want;
+}
+
+/** true if a comma-separated header value contains token (case-insensitive) */
+static inline bool httplite_has_token(const char* value, const char* token) {
+    size_t tokLen = strlen(token);
+    const char* p = value;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        const char* start = p;
+        while (*p && *p != ',') p++;
+        const char* end = p;
+        while (end > start && (end[-1] == ' ' || end[-1] == '\t')) end--;
+        if ((size_t)(end - start) == tokLen) {
+            bool same = true;
+            for (size_t i = 0; i < tokLen && same; i++) {
+                char a = start[i], b = token[i];
+                if (a >= 'A' && a <= 'Z') a += 'a' - 'A';
+                if (b >= 'A' && b <= 'Z') b += 'a' - 'A';
+                same = a == b;
+            }
+            if (same) return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @param line Buffer for the status line and one header line at a time
+ * @param head true for a HEAD request (no body follows the headers)
+ */
+static inline void httplite_response_init(HttpLiteResponse* r, char* line, size_t lineSize,
+                                          HttpLiteHeaderFn onHeader, HttpLiteBodyFn onBody,
+                                          void* ctx, bool head) {
+    memset(r, 0, sizeof(*r));
+    r->onHeader = onHeader;
+    r->onBody = onBody;
+    r->ctx = ctx;
+    r->line = line;
+    r->lineSize = lineSize;
+    r->head = head;
+    r->contentLength = -1;
+    r->phase = HTTP_LITE_STATUS;
+}
+
+static inline int httplite_fail(HttpLiteResponse* r, int error) {
+    r->phase = HTTP_LITE_FAILED;
+    r->error = error;
+    r->keepAlive = false;
+    return error;
+}
+
+// "HTTP/1.x NNN reason"
+static inline bool httplite_status_line(HttpLiteResponse* r, const char* s) {
+    if (strncmp(s, "HTTP/1.", 7) != 0 || (s[7] != '0' && s[7] != '1') || s[8] != ' ') return false;
+    if (s[9] < '1' || s[9] > '5' || s[10] < '0' || s[10] > '9' || s[11] < '0' || s[11] > '9') return false;
+    if (s[12] != '\0' && s[12] != ' ') return false;
+    r->http10 = s[7] == '0';
+    r->keepAlive = !r->http10;
+    r->status = (s[9] - '0') * 100 + (s[10] - '0') * 10 + (s[11] - '0');
+    return true;
+}
+
+static inline bool httplite_parse_length(const char* s, int64_t* out) {
+    if (!*s) return false;
+    int64_t v = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9' || v > (int64_t)HTTP_LITE_MAX_BODY) return false;
+        v = v * 10 + (*s - '0');
+    }
+    if (v > (int64_t)HTTP_LITE_MAX_BODY) return false;
+    *out = v;
+    return true;
+}
+
+// Body framing once the blank line after the headers arrives
+static inline void httplite_headers_done(HttpLiteResponse* r) {
+    int s = r->status;
+    if (r->head || s == 204 || s == 304 || s / 100 == 1) {
+        r->phase = HTTP_LITE_DONE;
+    } else if (r->chunked) {
+        r->phase = HTTP_LITE_CHUNK_SIZE;
+    } else if (r->contentLength >= 0) {
+        r->remaining = (uint64_t)r->contentLength;
+        r->phase = r->remaining ? HTTP_LITE_BODY : HTTP_LITE_DONE;
+    } else {
+        r->untilClose = true;
+        r->keepAlive = false;
+        r->phase = HTTP_LITE_BODY;
+    }
+}
+
+static inline int httplite_header_line(HttpLiteResponse* r, char* s) {
+    if (*s == ' ' || *s == '\t') return HTTP_LITE_ERR_PROTOCOL;   // Obsolete line folding
+    char* colon = strchr(s, ':');
+    if (!colon || colon == s) return HTTP_LITE_ERR_PROTOCOL;
+    char* nameEnd = colon;
+    if (nameEnd[-1] == ' ' || nameEnd[-1] == '\t') return HTTP_LITE_ERR_PROTOCOL;
+    *nameEnd = '\0';
+    char* value = colon + 1;
+    while (*value == ' ' || *value == '\t') value++;
+    char* end = value + strlen(value);
+    while (end > value && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+
+    if (r->phase == HTTP_LITE_HEADERS) {
+        if (httplite_name_is(s, "Content-Length")) {
+            int64_t len;
+            if (!httplite_parse_length(value, &len)) return HTTP_LITE_ERR_PROTOCOL;
+            if (r->contentLength >= 0 && r->contentLength != len) return HTTP_LITE_ERR_PROTOCOL;
+            r->contentLength = len;
+        } else if (httplite_name_is(s, "Transfer-Encoding")) {
+            // Only plain chunked is understood; anything else has no usable length
+            if (!httplite_name_is(value, "chunked")) return HTTP_LITE_ERR_PROTOCOL;
+            r->chunked = true;
+        } else if (httplite_name_is(s, "Connection")) {
+            if (httplite_has_token(value, "close")) r->keepAlive = false;
+            else if (httplite_has_token(value, "keep-alive")) r->keepAlive = true;
+        }
+    }
+    if (r->onHeader) r->onHeader(r->ctx, s, value);
+    return 0;
+}
+
+// One complete line (CR stripped, NUL-terminated) in the status/header phases
+static inline int httplite_line(HttpLiteResponse* r) {
+    char* s = r->line;
+    if (r->phase == HTTP_LITE_STATUS) {
+        if (!httplite_status_line(r, s)) return HTTP_LITE_ERR_PROTOCOL;
+        r->phase = HTTP_LITE_HEADERS;
+        return 0;
+    }
+    if (r->phase == HTTP_LITE_CHUNK_SIZE) {
+        uint64_t size = 0;
+        int digits = 0;
+        for (; (*s >= '0' && *s <= '9') || (*s >= 'a' && *s <= 'f') || (*s >= 'A' && *s <= 'F'); s++) {
+            if (++digits > 8) return HTTP_LITE_ERR_PROTOCOL;
+            size = size * 16 + (uint64_t)(*s <= '9' ? *s - '0' : (*s | 0x20) - 'a' + 10);
+        }
+        while (*s == ' ' || *s == '\t') s++;
+        if (digits == 0 || (*s != '\0' && *s != ';')) return HTTP_LITE_ERR_PROTOCOL;  // ;ext ignored
+        r->remaining = size;
+        r->phase = size ? HTTP_LITE_CHUNK_DATA : HTTP_LITE_TRAILERS;
+        return 0;
+    }
+    if (r->phase == HTTP_LITE_CHUNK_END) {
+        if (*s != '\0') return HTTP_LITE_ERR_PROTOCOL;
+        r->phase = HTTP_LITE_CHUNK_SIZE;
+        return 0;
+    }
+    // Headers or trailers
+    if (*s == '\0') {
+        if (r->phase == HTTP_LITE_TRAILERS) {
+            r->phase = HTTP_LITE_DONE;
+        } else if (r->status / 100 == 1 && r->status != 101) {
+            // Interim response (100 Continue): the real one follows
+            r->status = 0;
+            r->contentLength = -1;
+            r->chunked = false;
+            r->phase = HTTP_LITE_STATUS;
+        } else {
+            httplite_headers_done(r);
+        }
+        return 0;
+    }
+    return httplite_header_line(r, s);
+}
+
+static inline bool httplite_line_phase(uint8_t phase) {
+    return phase == HTTP_LITE_STATUS || phase == HTTP_LITE_HEADERS || phase == HTTP_LITE_CHUNK_SIZE ||
+           phase == HTTP_LITE_CHUNK_END || phase == HTTP_LITE_TRAILERS;
+}
+
+/**
+ * Feed received bytes. Stops at the end of the response (DONE) so the
+ * rest of data belongs to the next one, after the headers when
+ * headersOnly, or on an error (FAILED, r->error).
+ * @returns Bytes consumed
+ */
+static inline size_t httplite_parse(HttpLiteResponse* r, const uint8_t* data, size_t len, bool headersOnly) {
+    size_t pos = 0;
+    while (pos < len) {
+        uint8_t phase = r->phase;
+        if (phase == HTTP_LITE_DONE || phase == HTTP_LITE_FAILED) break;
+        if (headersOnly && phase != HTTP_LITE_STATUS && phase != HTTP_LITE_HEADERS) break;
+
+        if (httplite_line_phase(phase)) {
+            const uint8_t* nl = (const uint8_t*)memchr(data + pos, '\n', len - pos);
+            size_t take = (nl ? (size_t)(nl - (data + pos)) : len - pos);
+            if (!r->skipLine) {
+                if (r->lineLen + take >= r->lineSize) {
+                    // Status and framing lines must fit; long headers are skipped
+                    if (phase != HTTP_LITE_HEADERS && phase != HTTP_LITE_TRAILERS) {
+                        httplite_fail(r, HTTP_LITE_ERR_PROTOCOL);
+                        return pos;
+                    }
+                    r->skipLine = true;
+                    r->headersDropped++;
+                } else {
+                    memcpy(r->line + r->lineLen, data + pos, take);
+                    r->lineLen += take;
+                }
+            }
+            pos += take;
+            if (!nl) break;
+            pos++;   // '\n'
+            bool skipped = r->skipLine;
+            r->skipLine = false;
+            size_t n = r->lineLen;
+            r->lineLen = 0;
+            if (skipped) continue;
+            if (n > 0 && r->line[n - 1] == '\r') n--;
+            r->line[n] = '\0';
+            if (memchr(r->line, '\0', n)) {
+                httplite_fail(r, HTTP_LITE_ERR_PROTOCOL);
+                return pos;
+            }
+            int rc = httplite_line(r);
+            if (rc < 0) {
+                httplite_fail(r, rc);
+                return pos;
+            }
+            continue;
+        }
+
+        // Body bytes (Content-Length, until close, or chunk data)
+        size_t take = len - pos;
+        if (!r->untilClose && take > r->remaining) take = (size_t)r->remaining;
+        if ((uint64_t)r->bodyBytes + take > HTTP_LITE_MAX_BODY) {
+            httplite_fail(r, HTTP_LITE_ERR_PROTOCOL);
+            return pos;
+        }
+        if (take > 0 && r->onBody && !r->onBody(r->ctx, data + pos, take)) {
+            httplite_fail(r, HTTP_LITE_ERR_SINK);
+            return pos;
+        }
+        pos += take;
+        r->bodyBytes += (uint32_t)take;
+        if (!r->untilClose) {
+            r->remaining -= take;
+            if (r->remaining == 0) {
+                r->phase = phase == HTTP_LITE_CHUNK_DATA ? HTTP_LITE_CHUNK_END : HTTP_LITE_DONE;
+            }
+        }
+    }
+    return pos;
+}
+
+/**
+ * The server closed the connection. Ends a read-until-close body; any
+ * other unfinished response fails.
+ * @returns 0, or HTTP_LITE_ERR_CLOSED
+ */
+static inline int httplite_eof(HttpLiteResponse* r) {
+    if (r->phase == HTTP_LITE_DONE) return 0;
+    if (r->phase == HTTP_LITE_BODY && r->untilClose) {
+        r->phase = HTTP_LITE_DONE;
+        return 0;
+    }
+    if (r->phase == HTTP_LITE_FAILED) return r->error;
+    return httplite_fail(r, HTTP_LITE_ERR_CLOSED);
+}
+
+// ============================================================================
+// REQUESTS
+// ============================================================================
+
+/** Path and query of an absolute URL ("/" if it has none) */
+static inline const char* httplite_url_path(const char* url) {
+    const char* p = strstr(url, "://");
+    p = p ? p + 3 : url;
+    const char* path = strpbrk(p, "/?");
+    return path ? path : "/";
+}
+
+/**
+ * Format a request head.
+ * @param headers Extra "Name: value\r\n" lines, or nullptr
+ * @param port Added to Host unless it is 80 or 443
+ * @returns Length, or 0 if out is too small
+ */
+static inline size_t httplite_format_request(char* out, size_t outSize, const char* method, const char* host,
+                                             uint16_t port, const char* path, const char* headers, bool keepAlive) {
+    char portText[8] = "";
+    if (port != 80 && port != 443) snprintf(portText, sizeof(portText), ":%u", (unsigned)port);
+    int n = snprintf(out, outSize, "%s %s%s HTTP/1.1\r\nHost: %s%s\r\n%s%s\r\n",
+                     method, path[0] == '/' ? "" : "/", path, host, portText,
+                     headers ? headers : "", keepAlive ? "" : "Connection: close\r\n");
+    return n > 0 && (size_t)n < outSize ? (size_t)n : 0;
+}
+
+// ============================================================================
+// CONNECTION
+// ============================================================================
+
+static inline void httplite_conn_init(HttpLiteConn* c, HttpLiteIo io) {
+    c->io = io;
+    c->rxPos = c->rxLen = 0;
+    c->inFlight = 0;
+    c->usable = true;
+}
+
+/**
+ * Write one request. With keepAlive further requests may follow before
+ * the responses are read (pipelining); they are answered in order.
+ * @returns 0 or HTTP_LITE_ERR_REQUEST / HTTP_LITE_ERR_STATE
+ */
+static inline int httplite_send(HttpLiteConn* c, const char* method, const char* host, uint16_t port,
+                                const char* path, const char* headers, bool keepAlive) {
+    if (!c->usable || c->inFlight == 0xFF) return HTTP_LITE_ERR_STATE;
+    char req[HTTP_LITE_REQUEST_MAX];
+    size_t n = httplite_format_request(req, sizeof(req), method, host, port, path, headers, keepAlive);
+    if (n == 0 || !c->io.write(c->io.ctx, (const uint8_t*)req, n)) {
+        c->usable = false;
+        return HTTP_LITE_ERR_REQUEST;
+    }
+    c->inFlight++;
+    if (!keepAlive) c->usable = false;   // Nothing may follow Connection: close
+    return 0;
+}
+
+// Drive the parser with buffered and then received bytes until it stops
+static inline int httplite_pump(HttpLiteConn* c, HttpLiteResponse* r, bool headersOnly) {
+    for (;;) {
+        if (c->rxPos < c->rxLen) {
+            c->rxPos += httplite_parse(r, c->rx + c->rxPos, c->rxLen - c->rxPos, headersOnly);
+        }
+        if (r->phase == HTTP_LITE_FAILED) break;
+        if (r->phase == HTTP_LITE_DONE) break;
+        // Body still to come: the response stays in flight
+        if (headersOnly && r->phase != HTTP_LITE_STATUS && r->phase != HTTP_LITE_HEADERS) return r->status;
+        if (c->rxPos < c->rxLen) continue;
+
+        c->rxPos = c->rxLen = 0;
+        int n = c->io.read(c->io.ctx, c->rx, sizeof(c->rx));
+        if (n == 0) {
+            httplite_fail(r, HTTP_LITE_ERR_TIMEOUT);
+            break;
+        }
+        if (n < 0) {
+            c->usable = false;
+            if (httplite_eof(r) < 0) break;
+            continue;   // Read-until-close body finished
+        }
+        c->rxLen = (size_t)n;
+    }
+
+    if (c->inFlight) c->inFlight--;
+    if (r->phase == HTTP_LITE_FAILED) {
+        c->usable = false;
+        c->inFlight = 0;
+        return r->error;
+    }
+    if (!r->keepAlive) c->usable = false;
+    return r->status;
+}
+
+/**
+ * Read the status line and headers of the next response. The body is
+ * still on the connection: set r->onBody if needed, then call
+ * httplite_read_body().
+ * @returns HTTP status, or HTTP_LITE_ERR_*
+ */
+static inline int httplite_read_headers(HttpLiteConn* c, HttpLiteResponse* r) {
+    if (c->inFlight == 0) return httplite_fail(r, HTTP_LITE_ERR_STATE);
+    if (r->phase != HTTP_LITE_STATUS) return httplite_fail(r, HTTP_LITE_ERR_STATE);
+    return httplite_pump(c, r, true);
+}
+
+/** Stream the rest of the response to r->onBody. @returns HTTP status or HTTP_LITE_ERR_* */
+static inline int httplite_read_body(HttpLiteConn* c, HttpLiteResponse* r) {
+    if (r->phase == HTTP_LITE_DONE) return r->status;
+    if (r->phase == HTTP_LITE_FAILED) return r->error;
+    return httplite_pump(c, r, false);
+}
+
+/** Read one whole response (headers and body). @returns HTTP status or HTTP_LITE_ERR_* */
+static inline int httplite_receive(HttpLiteConn* c, HttpLiteResponse* r) {
+    int rc = httplite_read_headers(c, r);
+    return rc < 0 ? rc : httplite_read_body(c, r);
+}
+
+#endif // HTTP_LITE_H
@@ -0,0 +1,288 @@
+/**
+ * JSON Scan - bounded tokenizer and value lookup for small server replies
+ * Part of the Commute Compute System™
+ *
+ * Replaces the indexOf()-based jsonGetString() in main.cpp. The input is a
+ * pointer + length (no NUL needed), every read is bounds-checked, string
+ * escapes are decoded (\" \\ \/ \b \f \n \r \t and \uXXXX incl. surrogate
+ * pairs, to UTF-8), and a key only matches where it is actually followed
+ * by ':' - not inside another string value. Malformed input stops the scan
+ * rather than reading past it.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef JSON_SCAN_H
+#define JSON_SCAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define JSON_KEY_MAX 64           // Longest key json_find_value() compares
+
+enum JsonTokType {
+    JSON_TOK_END = 0,
+    JSON_TOK_ERROR,
+    JSON_TOK_STRING,              // start/end exclude the quotes, escapes still raw
+    JSON_TOK_NUMBER,
+    JSON_TOK_LITERAL,             // true / false / null (letters only, not checked)
+    JSON_TOK_PUNCT                // { } [ ] : ,
+};
+
+enum JsonGetResult {
+    JSON_GET_MISSING = -1,        // Key absent, value not a string, or input malformed
+    JSON_GET_TOO_LONG = -2        // Value does not fit in out
+};
+
+struct JsonScanner {
+    const char* text;
+    size_t len;
+    size_t pos;
+};
+
+struct JsonTok {
+    int type;
+    size_t start;
+    size_t end;
+    char punct;
+};
+
+static inline void json_scan_init(JsonScanner* s, const char* text, size_t len) {
+    s->text = text;
+    s->len = len;
+    s->pos = 0;
+}
+
+static inline int json_hex4(const char* p) {
+    int v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= c - '0';
+        else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else return -1;
+    }
+    return v;
+}
+
+/**
+ * Next token. Strings are checked for well-formed escapes here, so a
+ * later json_string_decode() of the span only fails on \u0000, an
+ * unpaired surrogate or a short output buffer.
+ */
+static inline int json_next(JsonScanner* s, JsonTok* t) {
+    const char* p = s->text;
+    while (s->pos < s->len && (p[s->pos] == ' ' || p[s->pos] == '\t' ||
+                               p[s->pos] == '\n' || p[s->pos] == '\r')) {
+        s->pos++;
+    }
+    t->start = s->pos;
+    t->end = s->pos;
+    t->punct = 0;
+    if (s->pos >= s->len) return t->type = JSON_TOK_END;
+
+    char c = p[s->pos];
+    if (c == '"') {
+        size_t i = s->pos + 1;
+        t->start = i;
+        while (i < s->len) {
+            unsigned char ch = (unsigned char)p[i];
+            if (ch == '"') {
+                t->end = i;
+                s->pos = i + 1;
+                return t->type = JSON_TOK_STRING;
+            }
+            if (ch < 0x20) break;
+            if (ch == '\\') {
+                if (i + 1 >= s->len) break;
+                char e = p[i + 1];
+                if (e == 'u') {
+                    if (i + 6 > s->len || json_hex4(p + i + 2) < 0) break;
+                    i += 6;
+                    continue;
+                }
+                if (!strchr("\"\\/bfnrt", e) || e == '\0') break;
+                i += 2;
+                continue;
+            }
+            i++;
+        }
+        t->end = i;
+        s->pos = s->len;
+        return t->type = JSON_TOK_ERROR;
+    }
+    if (strchr("{}[]:,", c) && c != '\0') {
+        t->punct = c;
+        t->end = ++s->pos;
+        return t->type = JSON_TOK_PUNCT;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        while (s->pos < s->len && (strchr("+-.eE", p[s->pos]) || (p[s->pos] >= '0' && p[s->pos] <= '9')) &&
+               p[s->pos] != '\0') {
+            s->pos++;
+        }
+        t->end = s->pos;
+        return t->type = JSON_TOK_NUMBER;
+    }
+    if (c >= 'a' && c <= 'z') {
+        while (s->pos < s->len && p[s->pos] >= 'a' && p[s->pos] <= 'z') s->pos++;
+        t->end = s->pos;
+        return t->type = JSON_TOK_LITERAL;
+    }
+    s->pos = s->len;
+    return t->type = JSON_TOK_ERROR;
+}
+
+/**
+ * Decode the raw contents of a string token into out (NUL-terminated).
+ * \u0000 and unpaired surrogates are rejected.
+ * @returns decoded length, JSON_GET_MISSING if invalid, JSON_GET_TOO_LONG
+ */
+static inline int json_string_decode(const char* raw, size_t rawLen, char* out, size_t outSize) {
+    if (outSize == 0) return JSON_GET_TOO_LONG;
+    size_t o = 0;
+    size_t i = 0;
+    while (i < rawLen) {
+        char c = raw[i];
+        char buf[4];
+        size_t n = 1;
+        buf[0] = c;
+        if (c == '\\') {
+            if (i + 1 >= rawLen) return JSON_GET_MISSING;
+            char e = raw[i + 1];
+            i += 2;
+            switch (e) {
+                case '"': case '\\': case '/': buf[0] = e; break;
+                case 'b': buf[0] = '\b'; break;
+                case 'f': buf[0] = '\f'; break;
+                case 'n': buf[0] = '\n'; break;
+                case 'r': buf[0] = '\r'; break;
+                case 't': buf[0] = '\t'; break;
+                case 'u': {
+                    if (i + 4 > rawLen) return JSON_GET_MISSING;
+                    long cp = json_hex4(raw + i);
+                    if (cp < 0) return JSON_GET_MISSING;
+                    i += 4;
+                    if (cp >= 0xDC00 && cp <= 0xDFFF) return JSON_GET_MISSING;
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        if (i + 6 > rawLen || raw[i] != '\\' || raw[i + 1] != 'u') return JSON_GET_MISSING;
+                        int lo = json_hex4(raw + i + 2);
+                        if (lo < 0xDC00 || lo > 0xDFFF) return JSON_GET_MISSING;
+                        i += 6;
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    }
+                    if (cp == 0) return JSON_GET_MISSING;
+                    if (cp < 0x80) {
+                        buf[0] = (char)cp;
+                    } else if (cp < 0x800) {
+                        buf[0] = (char)(0xC0 | (cp >> 6));
+                        buf[1] = (char)(0x80 | (cp & 0x3F));
+                        n = 2;
+                    } else if (cp < 0x10000) {
+                        buf[0] = (char)(0xE0 | (cp >> 12));
+                        buf[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                        buf[2] = (char)(0x80 | (cp & 0x3F));
+                        n = 3;
+                    } else {
+                        buf[0] = (char)(0xF0 | (cp >> 18));
+                        buf[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+                        buf[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                        buf[3] = (char)(0x80 | (cp & 0x3F));
+                        n = 4;
+                    }
+                    break;
+                }
+                default:
+                    return JSON_GET_MISSING;
+            }
+        } else {
+            if ((unsigned char)c < 0x20) return JSON_GET_MISSING;
+            i++;
+        }
+        if (o + n >= outSize) return JSON_GET_TOO_LONG;
+        memcpy(out + o, buf, n);
+        o += n;
+    }
+    out[o] = '\0';
+    return (int)o;
+}
+
+/**
+ * Find the first "key": value pair (at any depth). Keys are compared after
+ * unescaping. On success *value is the value's first token (the opening
+ * bracket for an object or array).
+ */
+static inline bool json_find_value(const char* json, size_t len, const char* key, JsonTok* value) {
+    JsonScanner s;
+    JsonTok prev = { JSON_TOK_END, 0, 0, 0 };
+    JsonTok tok;
+    json_scan_init(&s, json, len);
+    size_t keyLen = strlen(key);
+    char name[JSON_KEY_MAX + 1];
+
+    while (json_next(&s, &tok) != JSON_TOK_END) {
+        if (tok.type == JSON_TOK_ERROR) return false;
+        if (tok.type == JSON_TOK_PUNCT && tok.punct == ':' && prev.type == JSON_TOK_STRING) {
+            int n = json_string_decode(json + prev.start, prev.end - prev.start, name, sizeof(name));
+            if (json_next(&s, value) == JSON_TOK_ERROR || value->type == JSON_TOK_END) return false;
+            if (n >= 0 && (size_t)n == keyLen && memcmp(name, key, keyLen) == 0) return true;
+            tok = *value;
+        }
+        prev = tok;
+    }
+    return false;
+}
+
+/**
+ * Decode the string value of key into out.
+ * @returns value length, JSON_GET_MISSING or JSON_GET_TOO_LONG
+ */
+static inline int json_get_string(const char* json, size_t len, const char* key, char* out, size_t outSize) {
+    JsonTok value;
+    if (!json_find_value(json, len, key, &value) || value.type != JSON_TOK_STRING) return JSON_GET_MISSING;
+    return json_string_decode(json + value.start, value.end - value.start, out, outSize);
+}
+
+/**
+ * Integer value of key - a number, or a string holding one ("900"), as
+ * servers send both. A fractional part is dropped; exponents are rejected.
+ */
+static inline bool json_get_long(const char* json, size_t len, const char* key, long* out) {
+    JsonTok value;
+    if (!json_find_value(json, len, key, &value)) return false;
+    if (value.type != JSON_TOK_NUMBER && value.type != JSON_TOK_STRING) return false;
+
+    const char* p = json + value.start;
+    const char* end = json + value.end;
+    bool negative = p < end && *p == '-';
+    if (negative) p++;
+    if (p == end || *p < '0' || *p > '9') return false;
+    long v = 0;
+    int digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        if (++digits > 9) return false;   // Keeps v inside a 32-bit long
+        v = v * 10 + (*p - '0');
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++) {}
+    }
+    if (p != end) return false;
+    *out = negative ? -v : v;
+    return true;
+}
+
+/** true / false value of key */
+static inline bool json_get_bool(const char* json, size_t len, const char* key, bool* out) {
+    JsonTok value;
+    if (!json_find_value(json, len, key, &value) || value.type != JSON_TOK_LITERAL) return false;
+    size_t n = value.end - value.start;
+    if (n == 4 && memcmp(json + value.start, "true", 4) == 0) *out = true;
+    else if (n == 5 && memcmp(json + value.start, "false", 5) == 0) *out = false;
+    else return false;
+    return true;
+}
+
+#endif // JSON_SCAN_H
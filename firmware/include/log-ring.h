@@ -0,0 +1,563 @@
+/**
+ * Deferred-Format Binary Log (RTC ring)
+ * Part of the Commute Compute System™
+ *
+ * CCLOG_E/W/I/D("fmt", args...) record the format string's address plus
+ * the raw argument values - no printf, no USB CDC write - into a ring in
+ * RTC_NOINIT memory. Text is only produced when a dump is requested
+ * (logring_dump_text) or on the host: logring_dump_binary() writes a hex
+ * snapshot that tools/log_decode.py turns back into lines, reading the
+ * format strings out of firmware.elf.
+ *
+ * The ring survives panics, watchdog and software resets and deep sleep
+ * (not power loss), so the lines leading up to a crash are still there on
+ * the next boot. It is cleared when the firmware build changes, since the
+ * recorded format addresses would no longer mean anything.
+ *
+ * Levels above CC_LOG_LEVEL compile to nothing (arguments are type-checked
+ * but never evaluated).
+ * -D CC_LOG_ECHO also prints each record as it is logged (development).
+ *
+ * String arguments that live in flash are stored by address; others are
+ * copied (truncated to LOGRING_MAX_STR). Floats are stored as 32-bit.
+ *
+ * Off the device (no ESP_PLATFORM) the ring is ordinary static memory.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+#ifdef ESP_PLATFORM
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include "soc/soc.h"
+#else
+#include <time.h>
+#endif
+
+#define CC_LOG_LEVEL_NONE   0
+#define CC_LOG_LEVEL_ERROR  1
+#define CC_LOG_LEVEL_WARN   2
+#define CC_LOG_LEVEL_INFO   3
+#define CC_LOG_LEVEL_DEBUG  4
+
+#ifndef CC_LOG_LEVEL
+#define CC_LOG_LEVEL CC_LOG_LEVEL_INFO
+#endif
+
+#ifndef LOGRING_BYTES
+#define LOGRING_BYTES     2048    // Power of two; ~60-100 records
+#endif
+#define LOGRING_MAGIC     0x474C4343u  // "CCLG"
+#define LOGRING_VERSION   1
+#define LOGRING_MAX_RECORD 96
+#define LOGRING_MAX_STR   24
+#define LOGRING_MAX_ARGS  8
+
+static_assert((LOGRING_BYTES & (LOGRING_BYTES - 1)) == 0, "LOGRING_BYTES must be a power of two");
+
+// Argument type tags (match tools/log_decode.py)
+enum LogArgType : uint8_t {
+    LOGARG_I32     = 1,
+    LOGARG_U32     = 2,
+    LOGARG_I64     = 3,
+    LOGARG_U64     = 4,
+    LOGARG_F32     = 5,
+    LOGARG_STR_ROM = 6,   // Address of a string in flash
+    LOGARG_STR     = 7,   // u8 length + bytes
+    LOGARG_PTR     = 8
+};
+
+/*
+ * Record (little-endian, packed, may wrap around the ring):
+ *   u16 len | u8 level | u8 argc | u32 ms | ptr fmt | argc x (u8 type + value)
+ */
+struct LogRecordHeader {
+    uint16_t len;
+    uint8_t level;
+    uint8_t argc;
+    uint32_t ms;
+    uintptr_t fmt;
+} __attribute__((packed));
+
+struct LogRing {
+    uint32_t magic;
+    uint32_t buildHash;       // Ring is cleared when this changes
+    uintptr_t buildTag;       // Address of the build tag string (checked by the host tool)
+    uint32_t head;            // Monotonic byte offsets; data[off & (LOGRING_BYTES - 1)]
+    uint32_t tail;
+    uint32_t boots;
+    uint32_t dropped;         // Records overwritten before being dumped
+    uint8_t data[LOGRING_BYTES];
+};
+
+typedef void (*LogOutFn)(const char* text, size_t len, void* ctx);
+
+static const char LOGRING_BUILD_TAG[] = "CCLOG " __DATE__ " " __TIME__;
+
+// The firmware logs from several source files (main.cpp, shell.cpp,
+// diag-server.cpp) into one ring: weak definitions, which the linker folds
+// into one. Host programs are a single file each.
+#ifdef ESP_PLATFORM
+#define LOGRING_GLOBAL __attribute__((weak))
+#else
+#define LOGRING_GLOBAL static
+#endif
+
+#ifdef ESP_PLATFORM
+LOGRING_GLOBAL RTC_NOINIT_ATTR LogRing g_logRing;
+LOGRING_GLOBAL portMUX_TYPE g_logRingMux = portMUX_INITIALIZER_UNLOCKED;
+#define LOGRING_LOCK()    portENTER_CRITICAL_SAFE(&g_logRingMux)
+#define LOGRING_UNLOCK()  portEXIT_CRITICAL_SAFE(&g_logRingMux)
+#else
+LOGRING_GLOBAL LogRing g_logRing;
+#define LOGRING_LOCK()    ((void)0)
+#define LOGRING_UNLOCK()  ((void)0)
+#endif
+
+LOGRING_GLOBAL LogOutFn g_logEcho = nullptr;
+LOGRING_GLOBAL void* g_logEchoCtx = nullptr;
+LOGRING_GLOBAL uint8_t g_logSnap[LOGRING_BYTES];   // Dumps copy the ring here first
+
+static inline uint32_t logring_ms() {
+#ifdef ESP_PLATFORM
+    return (uint32_t)(esp_timer_get_time() / 1000);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+#endif
+}
+
+static inline bool logring_in_flash(const void* p) {
+#ifdef ESP_PLATFORM
+    return (uintptr_t)p >= SOC_DROM_LOW && (uintptr_t)p < SOC_DROM_HIGH;
+#else
+    (void)p;
+    return false;
+#endif
+}
+
+static inline uint32_t logring_build_hash() {
+    uint32_t hash = 0x811c9dc5u;
+    for (const char* c = LOGRING_BUILD_TAG; *c; c++) {
+        hash ^= (uint8_t)*c;
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+static inline void logring_copy_in(LogRing* r, uint32_t off, const uint8_t* src, size_t n) {
+    for (size_t i = 0; i < n; i++) r->data[(off + i) & (LOGRING_BYTES - 1)] = src[i];
+}
+
+static inline void logring_copy_out(const LogRing* r, uint32_t off, uint8_t* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) dst[i] = r->data[(off + i) & (LOGRING_BYTES - 1)];
+}
+
+static inline uint16_t logring_len_at(const LogRing* r, uint32_t off) {
+    uint8_t b[2];
+    logring_copy_out(r, off, b, 2);
+    return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+/**
+ * Check a retained ring: every record from tail to head must have a sane length
+ */
+static inline bool logring_valid(const LogRing* r) {
+    if (r->magic != LOGRING_MAGIC || r->buildHash != logring_build_hash()) return false;
+    if (r->head - r->tail > LOGRING_BYTES) return false;
+    uint32_t off = r->tail;
+    while (off != r->head) {
+        uint16_t len = logring_len_at(r, off);
+        if (len < sizeof(LogRecordHeader) || len > LOGRING_MAX_RECORD || r->head - off < len) return false;
+        off += len;
+    }
+    return true;
+}
+
+// Append one encoded record, dropping the oldest ones to make room
+static inline void logring_append(const uint8_t* rec, uint16_t len) {
+    LogRing* r = &g_logRing;
+    LOGRING_LOCK();
+    while (LOGRING_BYTES - (r->head - r->tail) < len) {
+        r->tail += logring_len_at(r, r->tail);
+        r->dropped++;
+    }
+    logring_copy_in(r, r->head, rec, len);
+    // Publish only once the record is complete - a reset mid-write loses just this record
+    r->head += len;
+    LOGRING_UNLOCK();
+}
+
+// ---------------------------------------------------------------------------
+// Argument encoding
+// ---------------------------------------------------------------------------
+
+struct LogRecordBuilder {
+    uint8_t buf[LOGRING_MAX_RECORD];
+    uint16_t len;
+    uint8_t argc;
+};
+
+static inline void logring_put(LogRecordBuilder* b, uint8_t type, const void* v, size_t n) {
+    if (b->argc >= LOGRING_MAX_ARGS || b->len + 1 + n > LOGRING_MAX_RECORD) return;
+    b->buf[b->len++] = type;
+    memcpy(b->buf + b->len, v, n);
+    b->len += (uint16_t)n;
+    b->argc++;
+}
+
+static inline void logring_put_str(LogRecordBuilder* b, const char* s) {
+    if (!s) s = "(null)";
+    if (logring_in_flash(s)) {
+        uintptr_t p = (uintptr_t)s;
+        logring_put(b, LOGARG_STR_ROM, &p, sizeof(p));
+        return;
+    }
+    size_t n = 0;
+    while (n < LOGRING_MAX_STR && s[n]) n++;
+    if (b->argc >= LOGRING_MAX_ARGS || b->len + 2 + n > LOGRING_MAX_RECORD) return;
+    b->buf[b->len++] = LOGARG_STR;
+    b->buf[b->len++] = (uint8_t)n;
+    memcpy(b->buf + b->len, s, n);
+    b->len += (uint16_t)n;
+    b->argc++;
+}
+
+static inline void logring_put_arg(LogRecordBuilder* b, const char* v) { logring_put_str(b, v); }
+static inline void logring_put_arg(LogRecordBuilder* b, char* v) { logring_put_str(b, v); }
+
+template <typename T>
+static inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+logring_put_arg(LogRecordBuilder* b, T v) {
+    if (sizeof(T) > 4) {
+        if (std::is_signed<T>::value) {
+            int64_t i = (int64_t)v;
+            logring_put(b, LOGARG_I64, &i, 8);
+        } else {
+            uint64_t u = (uint64_t)v;
+            logring_put(b, LOGARG_U64, &u, 8);
+        }
+    } else if (std::is_signed<T>::value) {
+        int32_t i = (int32_t)v;
+        logring_put(b, LOGARG_I32, &i, 4);
+    } else {
+        uint32_t u = (uint32_t)v;
+        logring_put(b, LOGARG_U32, &u, 4);
+    }
+}
+
+template <typename T>
+static inline typename std::enable_if<std::is_floating_point<T>::value>::type
+logring_put_arg(LogRecordBuilder* b, T v) {
+    float f = (float)v;
+    logring_put(b, LOGARG_F32, &f, 4);
+}
+
+template <typename T>
+static inline typename std::enable_if<std::is_pointer<T>::value>::type
+logring_put_arg(LogRecordBuilder* b, T v) {
+    uintptr_t p = (uintptr_t)v;
+    logring_put(b, LOGARG_PTR, &p, sizeof(p));
+}
+
+static inline void logring_put_args(LogRecordBuilder* b) { (void)b; }
+
+template <typename T, typename... Rest>
+static inline void logring_put_args(LogRecordBuilder* b, T first, Rest... rest) {
+    logring_put_arg(b, first);
+    logring_put_args(b, rest...);
+}
+
+// ---------------------------------------------------------------------------
+// Formatting (dump time only)
+// ---------------------------------------------------------------------------
+
+/**
+ * Format one record into `out` (printf subset: flags, width, precision,
+ * h/l/ll/z/j/t modifiers, d i u x X o c s p f e g %)
+ */
+static inline size_t logring_format(const char* fmt, const uint8_t* args, size_t argLen,
+                                    uint8_t argc, char* out, size_t outSize) {
+    size_t o = 0, a = 0;
+    uint8_t used = 0;
+    auto emit = [&](const char* s, size_t n) {
+        if (o + 1 >= outSize) return;
+        if (n > outSize - 1 - o) n = outSize - 1 - o;
+        memcpy(out + o, s, n);
+        o += n;
+    };
+
+    while (*fmt) {
+        if (*fmt != '%') {
+            const char* start = fmt;
+            while (*fmt && *fmt != '%') fmt++;
+            emit(start, fmt - start);
+            continue;
+        }
+        if (fmt[1] == '%') {
+            emit("%", 1);
+            fmt += 2;
+            continue;
+        }
+
+        // Copy flags/width/precision, drop length modifiers
+        char spec[16] = "%";
+        size_t s = 1;
+        fmt++;
+        while (*fmt && strchr("-+ #0123456789.", *fmt) && s < sizeof(spec) - 4) spec[s++] = *fmt++;
+        while (*fmt && strchr("hlzjtL", *fmt)) fmt++;
+        char conv = *fmt ? *fmt++ : 0;
+        if (!conv) break;
+
+        char piece[64];
+        int n = 0;
+        if (used >= argc || a >= argLen) {
+            n = snprintf(piece, sizeof(piece), "<?>");
+        } else {
+            uint8_t type = args[a++];
+            int64_t iv = 0;
+            uint64_t uv = 0;
+            double dv = 0;
+            const char* sv = nullptr;
+            char strBuf[LOGRING_MAX_STR + 1];
+            switch (type) {
+                case LOGARG_I32: { int32_t v; memcpy(&v, args + a, 4); a += 4; iv = v; uv = (uint32_t)v; dv = v; break; }
+                case LOGARG_U32: { uint32_t v; memcpy(&v, args + a, 4); a += 4; iv = v; uv = v; dv = v; break; }
+                case LOGARG_I64: { int64_t v; memcpy(&v, args + a, 8); a += 8; iv = v; uv = (uint64_t)v; dv = (double)v; break; }
+                case LOGARG_U64: { uint64_t v; memcpy(&v, args + a, 8); a += 8; iv = (int64_t)v; uv = v; dv = (double)v; break; }
+                case LOGARG_F32: { float v; memcpy(&v, args + a, 4); a += 4; dv = v; iv = (int64_t)v; uv = (uint64_t)iv; break; }
+                case LOGARG_PTR:
+                case LOGARG_STR_ROM: {
+                    uintptr_t v; memcpy(&v, args + a, sizeof(v)); a += sizeof(v);
+                    uv = v; iv = (int64_t)v;
+                    if (type == LOGARG_STR_ROM) sv = (const char*)v;
+                    break;
+                }
+                case LOGARG_STR: {
+                    uint8_t len = args[a++];
+                    memcpy(strBuf, args + a, len);
+                    strBuf[len] = 0;
+                    a += len;
+                    sv = strBuf;
+                    break;
+                }
+                default:
+                    a = argLen;   // Unknown type - stop decoding arguments
+                    break;
+            }
+            used++;
+
+            switch (conv) {
+                case 'd': case 'i':
+                    memcpy(spec + s, "lld", 4);
+                    n = snprintf(piece, sizeof(piece), spec, (long long)iv);
+                    break;
+                case 'u': case 'x': case 'X': case 'o':
+                    spec[s++] = 'l'; spec[s++] = 'l'; spec[s++] = conv; spec[s] = 0;
+                    n = snprintf(piece, sizeof(piece), spec, (unsigned long long)uv);
+                    break;
+                case 'c':
+                    spec[s++] = 'c'; spec[s] = 0;
+                    n = snprintf(piece, sizeof(piece), spec, (int)iv);
+                    break;
+                case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+                    spec[s++] = conv; spec[s] = 0;
+                    n = snprintf(piece, sizeof(piece), spec, dv);
+                    break;
+                case 's':
+                    spec[s++] = 's'; spec[s] = 0;
+                    n = snprintf(piece, sizeof(piece), spec, sv ? sv : "?");
+                    break;
+                case 'p':
+                    n = snprintf(piece, sizeof(piece), "0x%llx", (unsigned long long)uv);
+                    break;
+                default:
+                    n = snprintf(piece, sizeof(piece), "<%%%c>", conv);
+                    break;
+            }
+        }
+        if (n > 0) emit(piece, (size_t)n < sizeof(piece) ? (size_t)n : sizeof(piece) - 1);
+    }
+    // Trailing newlines are implied by the record boundary
+    while (o > 0 && out[o - 1] == '\n') o--;
+    out[o] = 0;
+    return o;
+}
+
+static inline const char* logring_level_tag(uint8_t level) {
+    switch (level) {
+        case CC_LOG_LEVEL_ERROR: return "E";
+        case CC_LOG_LEVEL_WARN:  return "W";
+        case CC_LOG_LEVEL_INFO:  return "I";
+        default:                 return "D";
+    }
+}
+
+static inline size_t logring_format_line(const uint8_t* rec, char* out, size_t outSize) {
+    LogRecordHeader h;
+    memcpy(&h, rec, sizeof(h));
+    int n = snprintf(out, outSize, "%8lu %s ", (unsigned long)h.ms, logring_level_tag(h.level));
+    if (n < 0 || (size_t)n >= outSize) return 0;
+    return n + logring_format((const char*)h.fmt, rec + sizeof(h), h.len - sizeof(h), h.argc,
+                              out + n, outSize - n);
+}
+
+// ---------------------------------------------------------------------------
+// Logging
+// ---------------------------------------------------------------------------
+
+template <typename... Args>
+static inline void logring_log(uint8_t level, const char* fmt, Args... args) {
+    LogRecordBuilder b;
+    LogRecordHeader h;
+    b.len = sizeof(h);
+    b.argc = 0;
+    logring_put_args(&b, args...);
+
+    h.len = b.len;
+    h.level = level;
+    h.argc = b.argc;
+    h.ms = logring_ms();
+    h.fmt = (uintptr_t)fmt;
+    memcpy(b.buf, &h, sizeof(h));
+    logring_append(b.buf, b.len);
+
+#ifdef CC_LOG_ECHO
+    if (g_logEcho) {
+        char line[160];
+        size_t n = logring_format_line(b.buf, line, sizeof(line) - 1);
+        line[n++] = '\n';
+        g_logEcho(line, n, g_logEchoCtx);
+    }
+#endif
+}
+
+#if CC_LOG_LEVEL >= CC_LOG_LEVEL_ERROR
+#define CCLOG_E(fmt, ...) logring_log(CC_LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define CCLOG_E(fmt, ...) do { if (0) logring_log(CC_LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__); } while (0)
+#endif
+#if CC_LOG_LEVEL >= CC_LOG_LEVEL_WARN
+#define CCLOG_W(fmt, ...) logring_log(CC_LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define CCLOG_W(fmt, ...) do { if (0) logring_log(CC_LOG_LEVEL_WARN, fmt, ##__VA_ARGS__); } while (0)
+#endif
+#if CC_LOG_LEVEL >= CC_LOG_LEVEL_INFO
+#define CCLOG_I(fmt, ...) logring_log(CC_LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define CCLOG_I(fmt, ...) do { if (0) logring_log(CC_LOG_LEVEL_INFO, fmt, ##__VA_ARGS__); } while (0)
+#endif
+#if CC_LOG_LEVEL >= CC_LOG_LEVEL_DEBUG
+#define CCLOG_D(fmt, ...) logring_log(CC_LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define CCLOG_D(fmt, ...) do { if (0) logring_log(CC_LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__); } while (0)
+#endif
+
+/**
+ * Call once at boot. Keeps the retained ring if it is intact and from this
+ * build, then logs a boot marker with the reset reason.
+ * @param echo - Sink for CC_LOG_ECHO builds (may be null)
+ * @returns true if records from before the reset were kept
+ */
+static inline bool logring_begin(LogOutFn echo = nullptr, void* echoCtx = nullptr) {
+    LogRing* r = &g_logRing;
+    g_logEcho = echo;
+    g_logEchoCtx = echoCtx;
+
+    bool kept = logring_valid(r);
+    if (!kept) {
+        memset(r, 0, sizeof(*r));
+        r->magic = LOGRING_MAGIC;
+        r->buildHash = logring_build_hash();
+    }
+    r->buildTag = (uintptr_t)LOGRING_BUILD_TAG;
+    r->boots++;
+#ifdef ESP_PLATFORM
+    CCLOG_I("boot %u, reset reason %d", (unsigned)r->boots, (int)esp_reset_reason());
+#else
+    CCLOG_I("boot %u", (unsigned)r->boots);
+#endif
+    return kept;
+}
+
+static inline void logring_clear() {
+    LOGRING_LOCK();
+    g_logRing.tail = g_logRing.head;
+    g_logRing.dropped = 0;
+    LOGRING_UNLOCK();
+}
+
+// Copy the records out under the lock so dumping never races a writer
+static inline uint32_t logring_snapshot(uint8_t* dst, uint32_t* dropped) {
+    LogRing* r = &g_logRing;
+    LOGRING_LOCK();
+    uint32_t n = r->head - r->tail;
+    logring_copy_out(r, r->tail, dst, n);
+    *dropped = r->dropped;
+    LOGRING_UNLOCK();
+    return n;
+}
+
+/**
+ * Format every retained record as text (oldest first)
+ */
+static inline void logring_dump_text(LogOutFn out, void* ctx) {
+    uint8_t* snap = g_logSnap;
+    uint32_t dropped;
+    uint32_t n = logring_snapshot(snap, &dropped);
+    char line[160];
+    int len = snprintf(line, sizeof(line), "--- log: %u bytes, %u dropped, boot %u ---\n",
+                       (unsigned)n, (unsigned)dropped, (unsigned)g_logRing.boots);
+    out(line, len, ctx);
+    for (uint32_t off = 0; off < n; ) {
+        uint16_t recLen = (uint16_t)(snap[off] | (snap[off + 1] << 8));
+        size_t m = logring_format_line(snap + off, line, sizeof(line) - 1);
+        line[m++] = '\n';
+        out(line, m, ctx);
+        off += recLen;
+    }
+}
+
+/**
+ * Hex snapshot for tools/log_decode.py:
+ *   CCLOG-BEGIN <version> <ptrSize> <buildTag addr> <buildHash> <boots> <dropped> <bytes>
+ *   <hex, 64 bytes per line>
+ *   CCLOG-END
+ */
+static inline void logring_dump_binary(LogOutFn out, void* ctx) {
+    uint8_t* snap = g_logSnap;
+    uint32_t dropped;
+    uint32_t n = logring_snapshot(snap, &dropped);
+    char line[160];
+    int len = snprintf(line, sizeof(line), "CCLOG-BEGIN %d %u %llx %08lx %u %u %u\n",
+                       LOGRING_VERSION, (unsigned)sizeof(uintptr_t),
+                       (unsigned long long)g_logRing.buildTag, (unsigned long)g_logRing.buildHash,
+                       (unsigned)g_logRing.boots, (unsigned)dropped, (unsigned)n);
+    out(line, len, ctx);
+    static const char hex[] = "0123456789abcdef";
+    for (uint32_t off = 0; off < n; off += 64) {
+        size_t m = 0;
+        for (uint32_t i = off; i < n && i < off + 64; i++) {
+            line[m++] = hex[snap[i] >> 4];
+            line[m++] = hex[snap[i] & 0x0F];
+        }
+        line[m++] = '\n';
+        out(line, m, ctx);
+    }
+    out("CCLOG-END\n", 10, ctx);
+}
+
+#endif // LOG_RING_H
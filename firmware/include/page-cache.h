@@ -0,0 +1,340 @@
+/**
+ * Page Cache - server-defined pages kept in raw flash for button switching
+ * Part of the Commute Compute System™
+ *
+ * Every dashboard response lists the pages the device can flip through
+ * (X-Pages: id=maxAgeSeconds,..., src/services/device-pages.js). The first
+ * one is the live dashboard; the others (return journey, weather, alerts)
+ * are fetched as one full-screen CCZF frame each and kept here, so a button
+ * press draws them from flash without waiting for the network.
+ *
+ * The flash region (the unused SPIFFS partition of min_spiffs.csv on the
+ * device, RAM on the host) is split into fixed slots of
+ * PAGECACHE_SLOT_BYTES. Each slot starts with a header:
+ *
+ *   off  size  field
+ *   0    4     magic "CCPG"
+ *   4    1     version (1)
+ *   5    1     id length
+ *   6    2     reserved (0)
+ *   8    16    page id, NUL-padded
+ *   24   4     fetched (unix seconds)
+ *   28   4     frame length
+ *   32   4     frame hash - FNV-1a of the frame (pageHash() on the server)
+ *   36   4     FNV-1a of bytes 0..35
+ *
+ * followed by the frame. A slot is rewritten by erasing its first sector,
+ * streaming the frame in behind the header and writing the header last, so
+ * a write cut short by a reset leaves an empty slot, never a torn page.
+ * Later sectors are erased only as the frame reaches them.
+ *
+ * Freshness checks that come back unchanged (304 against the cached hash)
+ * only move checkedUnix in RAM: the flash is rewritten only when the page
+ * actually changed.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define PAGES_HEADER             "X-Pages"
+#define PAGE_HASH_HEADER         "X-Page-Hash"
+#define PAGE_MAX                 6        // MAX_PAGES in device-pages.js
+#define PAGE_ID_MAX              15
+
+#define PAGECACHE_MAGIC          0x47504343u   // "CCPG" little-endian
+#define PAGECACHE_VERSION        1
+#define PAGECACHE_HEADER_BYTES   40
+#define PAGECACHE_SLOT_BYTES     20480         // A text page is ~11 KB as CCZF
+#define PAGECACHE_FRAME_MAX      (PAGECACHE_SLOT_BYTES - PAGECACHE_HEADER_BYTES)
+#define PAGECACHE_MAX_SLOTS      8
+
+struct PageDef {
+    char id[PAGE_ID_MAX + 1];
+    uint32_t maxAge;              // Seconds a cached copy is shown without a refresh
+};
+
+struct PageList {
+    uint8_t count;
+    PageDef page[PAGE_MAX];
+};
+
+/**
+ * Parse an X-Pages value ("outbound=60,return=900"). Ids are [a-z0-9_-],
+ * 1-15 chars. Returns false (list emptied) on anything malformed.
+ */
+static inline bool page_list_parse(const char* value, PageList* list) {
+    list->count = 0;
+    const char* p = value;
+    for (;;) {
+        if (list->count >= PAGE_MAX) return (list->count = 0), false;
+        PageDef* page = &list->page[list->count];
+        size_t n = 0;
+        while ((*p >= 'a' && *p <= 'z') || (*p >= '0' && *p <= '9') || *p == '_' || *p == '-') {
+            if (n >= PAGE_ID_MAX) return (list->count = 0), false;
+            page->id[n++] = *p++;
+        }
+        page->id[n] = '\0';
+        if (n == 0 || *p++ != '=') return (list->count = 0), false;
+        uint32_t age = 0;
+        int digits = 0;
+        while (*p >= '0' && *p <= '9') {
+            if (++digits > 7) return (list->count = 0), false;
+            age = age * 10 + (uint32_t)(*p++ - '0');
+        }
+        if (digits == 0) return (list->count = 0), false;
+        page->maxAge = age;
+        list->count++;
+        if (*p == '\0') return true;
+        if (*p++ != ',') return (list->count = 0), false;
+    }
+}
+
+/** Index of the page with this id, -1 if the list has none */
+static inline int page_list_find(const PageList* list, const char* id) {
+    for (int i = 0; i < list->count; i++) {
+        if (strcmp(list->page[i].id, id) == 0) return i;
+    }
+    return -1;
+}
+
+// Raw flash access; addresses are relative to the start of the region
+struct PageFlash {
+    bool (*read)(void* ctx, uint32_t addr, void* buf, size_t len);
+    bool (*write)(void* ctx, uint32_t addr, const void* buf, size_t len);
+    bool (*erase)(void* ctx, uint32_t addr, size_t len);   // Whole sectors
+    void* ctx;
+    uint32_t size;
+    uint32_t sectorSize;
+};
+
+struct PageSlot {
+    bool valid;
+    char id[PAGE_ID_MAX + 1];
+    uint32_t fetchedUnix;
+    uint32_t checkedUnix;         // Last time the server confirmed it (RAM only)
+    uint32_t len;
+    uint32_t hash;
+};
+
+struct PageCache {
+    PageFlash flash;
+    uint8_t slots;
+    PageSlot slot[PAGECACHE_MAX_SLOTS];
+
+    // Slot being written (pagecache_write_begin() .. _end()), -1 if none
+    int writeSlot;
+    uint32_t writeLen;
+    uint32_t writeHash;
+    uint32_t erasedTo;            // Slot-relative bytes erased so far
+};
+
+static inline uint32_t pagecache_fnv(uint32_t hash, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) hash = (hash ^ data[i]) * 0x01000193u;
+    return hash;
+}
+
+static inline uint32_t pagecache_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void pagecache_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t pagecache_slot_addr(int slot) {
+    return (uint32_t)slot * PAGECACHE_SLOT_BYTES;
+}
+
+/** Decode a slot header; false if it is not a complete, plausible page */
+static inline bool pagecache_parse_header(const uint8_t* h, PageSlot* out) {
+    memset(out, 0, sizeof(*out));
+    if (pagecache_u32(h) != PAGECACHE_MAGIC || h[4] != PAGECACHE_VERSION) return false;
+    if (pagecache_fnv(0x811c9dc5u, h, 36) != pagecache_u32(h + 36)) return false;
+    uint8_t idLen = h[5];
+    if (idLen == 0 || idLen > PAGE_ID_MAX || memchr(h + 8, '\0', idLen) != nullptr) return false;
+    uint32_t len = pagecache_u32(h + 28);
+    if (len == 0 || len > PAGECACHE_FRAME_MAX) return false;
+    memcpy(out->id, h + 8, idLen);
+    out->id[idLen] = '\0';
+    out->fetchedUnix = out->checkedUnix = pagecache_u32(h + 24);
+    out->len = len;
+    out->hash = pagecache_u32(h + 32);
+    out->valid = true;
+    return true;
+}
+
+/** Empty a slot, on flash too so the next boot does not bring it back */
+static inline void pagecache_drop(PageCache* pc, int slot) {
+    pc->slot[slot].valid = false;
+    pc->flash.erase(pc->flash.ctx, pagecache_slot_addr(slot), pc->flash.sectorSize);
+}
+
+/**
+ * Split the flash region into slots and read their headers. Returns the
+ * number of slots (0 if the region is too small or the sector size does
+ * not divide PAGECACHE_SLOT_BYTES).
+ */
+static inline int pagecache_init(PageCache* pc, const PageFlash* flash) {
+    memset(pc, 0, sizeof(*pc));
+    pc->flash = *flash;
+    pc->writeSlot = -1;
+    if (flash->sectorSize == 0 || PAGECACHE_SLOT_BYTES % flash->sectorSize != 0) return 0;
+    uint32_t n = flash->size / PAGECACHE_SLOT_BYTES;
+    pc->slots = (uint8_t)(n > PAGECACHE_MAX_SLOTS ? PAGECACHE_MAX_SLOTS : n);
+    uint8_t h[PAGECACHE_HEADER_BYTES];
+    for (int i = 0; i < pc->slots; i++) {
+        if (!flash->read(flash->ctx, pagecache_slot_addr(i), h, sizeof(h))) memset(h, 0xFF, sizeof(h));
+        pagecache_parse_header(h, &pc->slot[i]);
+        // Two slots claiming one page (reset between write and cleanup): keep the newer
+        for (int j = 0; j < i && pc->slot[i].valid; j++) {
+            if (!pc->slot[j].valid || strcmp(pc->slot[j].id, pc->slot[i].id) != 0) continue;
+            pagecache_drop(pc, pc->slot[j].fetchedUnix <= pc->slot[i].fetchedUnix ? j : i);
+        }
+    }
+    return pc->slots;
+}
+
+/** Slot holding a page, -1 if it is not cached */
+static inline int pagecache_find(const PageCache* pc, const char* id) {
+    for (int i = 0; i < pc->slots; i++) {
+        if (pc->slot[i].valid && strcmp(pc->slot[i].id, id) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * Slot to write a page into: an empty one, else the least recently
+ * fetched other page. The page's current slot is kept until the new copy
+ * is complete, so it is only reused when it is the only slot.
+ */
+static inline int pagecache_slot_for(const PageCache* pc, const char* id) {
+    int current = pagecache_find(pc, id);
+    int best = -1;
+    for (int i = 0; i < pc->slots; i++) {
+        if (i == current) continue;
+        if (!pc->slot[i].valid) return i;
+        if (best < 0 || pc->slot[i].fetchedUnix < pc->slot[best].fetchedUnix) best = i;
+    }
+    return best >= 0 ? best : current;
+}
+
+/** True if the page was last confirmed more than maxAge seconds ago (or the clock is unset) */
+static inline bool pagecache_stale(const PageSlot* s, uint32_t maxAge, uint32_t nowUnix) {
+    if (!s->valid || nowUnix == 0 || nowUnix < s->checkedUnix) return true;
+    return nowUnix - s->checkedUnix >= maxAge;
+}
+
+/** Erase the slot's first sector (drops the old page) and start a new frame */
+static inline bool pagecache_write_begin(PageCache* pc, int slot) {
+    pc->writeSlot = -1;
+    if (slot < 0 || slot >= pc->slots) return false;
+    pc->slot[slot].valid = false;
+    if (!pc->flash.erase(pc->flash.ctx, pagecache_slot_addr(slot), pc->flash.sectorSize)) return false;
+    pc->writeSlot = slot;
+    pc->writeLen = 0;
+    pc->writeHash = 0x811c9dc5u;
+    pc->erasedTo = pc->flash.sectorSize;
+    return true;
+}
+
+/** Append frame bytes; false (write abandoned) on overflow or a flash error */
+static inline bool pagecache_write(PageCache* pc, const uint8_t* data, size_t len) {
+    if (pc->writeSlot < 0) return false;
+    if (len > PAGECACHE_FRAME_MAX - pc->writeLen) {
+        pc->writeSlot = -1;
+        return false;
+    }
+    uint32_t base = pagecache_slot_addr(pc->writeSlot);
+    uint32_t end = PAGECACHE_HEADER_BYTES + pc->writeLen + (uint32_t)len;
+    while (pc->erasedTo < end) {
+        if (!pc->flash.erase(pc->flash.ctx, base + pc->erasedTo, pc->flash.sectorSize)) {
+            pc->writeSlot = -1;
+            return false;
+        }
+        pc->erasedTo += pc->flash.sectorSize;
+    }
+    if (!pc->flash.write(pc->flash.ctx, base + PAGECACHE_HEADER_BYTES + pc->writeLen, data, len)) {
+        pc->writeSlot = -1;
+        return false;
+    }
+    pc->writeHash = pagecache_fnv(pc->writeHash, data, len);
+    pc->writeLen += (uint32_t)len;
+    return true;
+}
+
+/** Give up on the frame being written; its slot stays empty */
+static inline void pagecache_write_abort(PageCache* pc) {
+    pc->writeSlot = -1;
+}
+
+/**
+ * Write the header, making the page visible, and drop any older copy of
+ * the same page. Returns the slot, -1 if nothing was written.
+ */
+static inline int pagecache_write_end(PageCache* pc, const char* id, uint32_t fetchedUnix) {
+    int slot = pc->writeSlot;
+    pc->writeSlot = -1;
+    size_t idLen = strlen(id);
+    if (slot < 0 || pc->writeLen == 0 || idLen == 0 || idLen > PAGE_ID_MAX) return -1;
+
+    uint8_t h[PAGECACHE_HEADER_BYTES];
+    memset(h, 0, sizeof(h));
+    pagecache_put_u32(h, PAGECACHE_MAGIC);
+    h[4] = PAGECACHE_VERSION;
+    h[5] = (uint8_t)idLen;
+    memcpy(h + 8, id, idLen);
+    pagecache_put_u32(h + 24, fetchedUnix);
+    pagecache_put_u32(h + 28, pc->writeLen);
+    pagecache_put_u32(h + 32, pc->writeHash);
+    pagecache_put_u32(h + 36, pagecache_fnv(0x811c9dc5u, h, 36));
+    if (!pc->flash.write(pc->flash.ctx, pagecache_slot_addr(slot), h, sizeof(h))) return -1;
+
+    int old = pagecache_find(pc, id);
+    if (old >= 0 && old != slot) pagecache_drop(pc, old);   // Or the next boot finds two copies
+    pagecache_parse_header(h, &pc->slot[slot]);
+    return slot;
+}
+
+/** Read part of a cached frame */
+static inline bool pagecache_read(const PageCache* pc, int slot, uint32_t offset, uint8_t* buf, size_t len) {
+    if (slot < 0 || slot >= pc->slots || !pc->slot[slot].valid) return false;
+    if (offset > pc->slot[slot].len || len > pc->slot[slot].len - offset) return false;
+    return pc->flash.read(pc->flash.ctx, pagecache_slot_addr(slot) + PAGECACHE_HEADER_BYTES + offset, buf, len);
+}
+
+/**
+ * Stream a cached frame through onData in chunks of up to bufSize bytes,
+ * checking its hash on the way. A frame that fails the hash has already
+ * been passed on in part: onData's consumer must hold off drawing until
+ * this returns true. The slot is dropped on a mismatch.
+ */
+static inline bool pagecache_stream(PageCache* pc, int slot, uint8_t* buf, size_t bufSize,
+                                    bool (*onData)(void* ctx, const uint8_t* data, size_t len), void* ctx) {
+    if (slot < 0 || slot >= pc->slots || !pc->slot[slot].valid || bufSize == 0) return false;
+    uint32_t hash = 0x811c9dc5u;
+    uint32_t len = pc->slot[slot].len;
+    for (uint32_t off = 0; off < len;) {
+        size_t n = len - off < bufSize ? len - off : bufSize;
+        if (!pagecache_read(pc, slot, off, buf, n)) return false;
+        hash = pagecache_fnv(hash, buf, n);
+        if (onData && !onData(ctx, buf, n)) return false;
+        off += (uint32_t)n;
+    }
+    if (hash != pc->slot[slot].hash) {
+        pagecache_drop(pc, slot);
+        return false;
+    }
+    return true;
+}
+
+#endif // PAGE_CACHE_H
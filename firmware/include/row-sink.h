@@ -0,0 +1,126 @@
+/**
+ * Row Sink - common output stage for 1-bit image decoders
+ * Part of the Commute Compute System™
+ *
+ * Every image source (HTTP BMP fetch, BLE frame push, ...) decodes into
+ * rows of packed 1-bit pixels and hands them to a RowSink, so the display
+ * side only has one path to maintain.
+ *
+ * Pixel format: MSB first, bit = 1 means WHITE (same polarity as the
+ * server's BMP output, see canvasToBMP() in ccdash-renderer.js).
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef ROW_SINK_H
+#define ROW_SINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef ROW_SINK_MAX_WIDTH
+#define ROW_SINK_MAX_WIDTH 1024   // Widest supported row (pixels); Kindle builds raise it
+#endif
+
+/**
+ * Row consumer. begin() is called once per image/zone with its rectangle
+ * in screen coordinates, row() once per row with the absolute screen y
+ * (rows may arrive bottom-up), end() when the image is complete or aborted.
+ */
+struct RowSink {
+    void* ctx;
+    bool (*begin)(void* ctx, int x, int y, int w, int h);
+    bool (*row)(void* ctx, int y, const uint8_t* bits, int w);
+    void (*end)(void* ctx, bool ok);
+};
+
+/**
+ * 1-bit framebuffer (top-down rows, MSB first, bit = 1 white)
+ */
+struct FrameBuffer {
+    uint8_t* pixels;
+    int width;
+    int height;
+    int stride;     // Bytes per row
+};
+
+/**
+ * Copy nbits bits from src (starting at bit 0) to dst starting at bit dstBit
+ */
+static inline void fb_copy_bits(uint8_t* dst, int dstBit, const uint8_t* src, int nbits) {
+    if (nbits <= 0) return;
+    int shift = dstBit & 7;
+    uint8_t* d = dst + (dstBit >> 3);
+
+    if (shift == 0) {
+        int full = nbits >> 3;
+        memcpy(d, src, full);
+        int rem = nbits & 7;
+        if (rem) {
+            uint8_t mask = (uint8_t)(0xFF << (8 - rem));
+            d[full] = (uint8_t)((d[full] & ~mask) | (src[full] & mask));
+        }
+        return;
+    }
+
+    // Unaligned: each source byte straddles two destination bytes
+    int remaining = nbits;
+    int i = 0;
+    while (remaining > 0) {
+        int take = remaining < 8 ? remaining : 8;
+        uint8_t srcMask = (uint8_t)(0xFF << (8 - take));
+        uint8_t b = src[i] & srcMask;
+        uint16_t wide = (uint16_t)b << (8 - shift);
+        uint16_t mask = (uint16_t)srcMask << (8 - shift);
+        d[i] = (uint8_t)((d[i] & ~(mask >> 8)) | (wide >> 8));
+        if (mask & 0xFF) {
+            d[i + 1] = (uint8_t)((d[i + 1] & ~(mask & 0xFF)) | (wide & 0xFF));
+        }
+        remaining -= take;
+        i++;
+    }
+}
+
+// ============================================================================
+// FRAMEBUFFER SINK
+// ============================================================================
+
+struct FrameBufferSink {
+    FrameBuffer* fb;
+    int x, y, w, h;
+    uint32_t rows;          // Rows written for the current image
+};
+
+static inline bool fbsink_begin(void* ctx, int x, int y, int w, int h) {
+    FrameBufferSink* s = (FrameBufferSink*)ctx;
+    if (x < 0 || y < 0 || w <= 0 || h <= 0) return false;
+    if (x + w > s->fb->width || y + h > s->fb->height) return false;
+    s->x = x; s->y = y; s->w = w; s->h = h;
+    s->rows = 0;
+    return true;
+}
+
+static inline bool fbsink_row(void* ctx, int y, const uint8_t* bits, int w) {
+    FrameBufferSink* s = (FrameBufferSink*)ctx;
+    if (y < s->y || y >= s->y + s->h || w != s->w) return false;
+    fb_copy_bits(s->fb->pixels + (size_t)y * s->fb->stride, s->x, bits, w);
+    s->rows++;
+    return true;
+}
+
+static inline void fbsink_end(void* ctx, bool ok) {
+    (void)ctx;
+    (void)ok;
+}
+
+static inline RowSink fbsink_make(FrameBufferSink* s, FrameBuffer* fb) {
+    s->fb = fb;
+    s->x = s->y = s->w = s->h = 0;
+    s->rows = 0;
+    RowSink sink = { s, fbsink_begin, fbsink_row, fbsink_end };
+    return sink;
+}
+
+#endif // ROW_SINK_H
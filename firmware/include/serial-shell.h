@@ -0,0 +1,131 @@
+/**
+ * Serial Shell - line input, tokenising and timing stats for the console
+ * Part of the Commute Compute System™
+ *
+ * main.cpp polls the USB serial port from its idle loop and hands each
+ * character to shell_feed(); a complete line is split into words and
+ * dispatched there (bench fetch, bench blit, heap, net, log dump, ...).
+ * Polling costs one Serial.available() call while nobody is typing.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef SERIAL_SHELL_H
+#define SERIAL_SHELL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SHELL_LINE_MAX 64
+#define SHELL_MAX_ARGS 6
+
+struct ShellLine {
+    char buf[SHELL_LINE_MAX];
+    uint8_t len;
+    bool overflow;   // Line was too long - dropped when it ends
+};
+
+/**
+ * Add one input character
+ * @returns true when a complete line is in line->buf (NUL-terminated);
+ *          call shell_reset() after handling it
+ */
+static inline bool shell_feed(ShellLine* line, char c) {
+    if (c == '\r' || c == '\n') {
+        if (line->overflow || line->len == 0) {
+            line->len = 0;
+            line->overflow = false;
+            return false;
+        }
+        line->buf[line->len] = '\0';
+        return true;
+    }
+    if (c == '\b' || c == 0x7F) {
+        if (line->len > 0) line->len--;
+        return false;
+    }
+    if (c < ' ') return false;
+    if (line->len >= SHELL_LINE_MAX - 1) {
+        line->overflow = true;
+        return false;
+    }
+    line->buf[line->len++] = c;
+    return false;
+}
+
+static inline void shell_reset(ShellLine* line) {
+    line->len = 0;
+    line->overflow = false;
+}
+
+/**
+ * Split a line into words in place
+ * @returns number of words (at most maxArgs)
+ */
+static inline int shell_split(char* text, char** argv, int maxArgs) {
+    int argc = 0;
+    char* p = text;
+    while (*p && argc < maxArgs) {
+        while (*p == ' ' || *p == '\t') *p++ = '\0';
+        if (!*p) break;
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t') p++;
+    }
+    if (*p) *p = '\0';   // Ignore words past maxArgs
+    return argc;
+}
+
+/** Numeric argument, or def if missing/invalid, clamped to [lo, hi] */
+static inline long shell_arg_long(int argc, char** argv, int index, long def, long lo, long hi) {
+    long v = def;
+    if (index < argc) {
+        char* end = nullptr;
+        long parsed = strtol(argv[index], &end, 10);
+        if (end && end != argv[index] && *end == '\0') v = parsed;
+    }
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// Min/avg/max of repeated timings (any unit)
+struct BenchStats {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+};
+
+static inline void bench_reset(BenchStats* s) {
+    s->count = 0;
+    s->min = UINT32_MAX;
+    s->max = 0;
+    s->sum = 0;
+}
+
+static inline void bench_add(BenchStats* s, uint32_t v) {
+    s->count++;
+    s->sum += v;
+    if (v < s->min) s->min = v;
+    if (v > s->max) s->max = v;
+}
+
+/**
+ * "name: min/avg/max 12/15/21 ms (n=5)" into out
+ * @returns bytes written
+ */
+static inline int bench_format(const BenchStats* s, const char* name, const char* unit, char* out, size_t outSize) {
+    if (s->count == 0) return snprintf(out, outSize, "%s: no samples", name);
+    return snprintf(out, outSize, "%s: min/avg/max %lu/%lu/%lu %s (n=%lu)", name,
+                    (unsigned long)s->min, (unsigned long)(s->sum / s->count),
+                    (unsigned long)s->max, unit, (unsigned long)s->count);
+}
+
+/** Throughput in KB/s (x10 for one decimal without floats) */
+static inline uint32_t bench_kbps10(uint64_t bytes, uint64_t elapsedMs) {
+    if (elapsedMs == 0) return 0;
+    return (uint32_t)((bytes * 10000ULL) / (elapsedMs * 1024ULL));
+}
+
+#endif // SERIAL_SHELL_H
@@ -0,0 +1,124 @@
+/**
+ * Sink Display - bb_epaper drawing calls through a RowSink
+ * Part of the Commute Compute System™
+ *
+ * Lets the device-side renderers (dash-template.h) draw into the shadow
+ * framebuffer the same way fetched frames arrive: every fillRect, rule
+ * and line of text becomes a rectangle of rows handed to a RowSink, so a
+ * RotateSink in front of the framebuffer turns them for the mounted
+ * rotation and the shadow buffer (/frame.bmp, loadBMP()) always holds
+ * what the panel shows.
+ *
+ * Coordinates are logical (the sink's screen, see fb_rotated_size()).
+ * Colours follow bb_epaper: 0 = black, 1 = white, the row bit polarity.
+ * Text uses font8x8.h and is always opaque: setTextColor(fg) without a
+ * background paints the rest of each cell in the opposite colour, as
+ * there is no read-back through a sink.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef SINK_DISPLAY_H
+#define SINK_DISPLAY_H
+
+#include <stdint.h>
+#include <string.h>
+#include "row-sink.h"
+#include "font8x8.h"
+
+class SinkDisplay {
+public:
+    SinkDisplay(const RowSink* sink, int width, int height)
+        : sink_(sink), w_(width), h_(height) {}
+
+    int width() const { return w_; }
+    int height() const { return h_; }
+
+    void drawPixel(int x, int y, int color) { fillRect(x, y, 1, 1, color); }
+
+    void fillScreen(int color) { fillRect(0, 0, w_, h_, color); }
+
+    void fillRect(int x, int y, int w, int h, int color) {
+        if (!clip(&x, &y, &w, &h)) return;
+        memset(row_, color ? 0xFF : 0x00, (size_t)(w + 7) >> 3);
+        if (!sink_->begin(sink_->ctx, x, y, w, h)) return;
+        bool ok = true;
+        for (int yy = y; yy < y + h && ok; yy++) ok = sink_->row(sink_->ctx, yy, row_, w);
+        sink_->end(sink_->ctx, ok);
+    }
+
+    void drawRect(int x, int y, int w, int h, int color) {
+        if (w <= 0 || h <= 0) return;
+        fillRect(x, y, w, 1, color);
+        fillRect(x, y + h - 1, w, 1, color);
+        fillRect(x, y, 1, h, color);
+        fillRect(x + w - 1, y, 1, h, color);
+    }
+
+    void drawLine(int x0, int y0, int x1, int y1, int color) {
+        if (y0 == y1) {
+            fillRect(x0 < x1 ? x0 : x1, y0, (x1 > x0 ? x1 - x0 : x0 - x1) + 1, 1, color);
+            return;
+        }
+        if (x0 == x1) {
+            fillRect(x0, y0 < y1 ? y0 : y1, 1, (y1 > y0 ? y1 - y0 : y0 - y1) + 1, color);
+            return;
+        }
+        int dx = x1 > x0 ? x1 - x0 : x0 - x1, sx = x0 < x1 ? 1 : -1;
+        int dy = y1 > y0 ? y0 - y1 : y1 - y0, sy = y0 < y1 ? 1 : -1;
+        int err = dx + dy;
+        for (;;) {
+            drawPixel(x0, y0, color);
+            if (x0 == x1 && y0 == y1) break;
+            int e2 = 2 * err;
+            if (e2 >= dy) { err += dy; x0 += sx; }
+            if (e2 <= dx) { err += dx; y0 += sy; }
+        }
+    }
+
+    void setFont(int) {}
+    void setCursor(int x, int y) { cx_ = x; cy_ = y; }
+    void setTextColor(int fg, int bg = -1) { fg_ = fg; bg_ = bg < 0 ? !fg : bg; }
+
+    // One 8-row strip per call, clipped to the screen
+    void print(const char* text) {
+        int x0 = cx_, y0 = cy_;
+        int x = x0, y = y0, w = (int)strlen(text) * 8, h = 8;
+        cx_ += w;
+        if (!clip(&x, &y, &w, &h)) return;
+        if (!sink_->begin(sink_->ctx, x, y, w, h)) return;
+        bool ok = true;
+        for (int yy = y; yy < y + h && ok; yy++) {
+            memset(row_, bg_ ? 0xFF : 0x00, (size_t)(w + 7) >> 3);
+            for (int col = 0; col < w; col++) {
+                int tx = x - x0 + col;
+                const uint8_t* glyph = font8x8_glyph((unsigned char)text[tx >> 3]);
+                if (!(glyph[yy - y0] & (1 << (tx & 7)))) continue;
+                uint8_t bit = (uint8_t)(0x80 >> (col & 7));
+                if (fg_) row_[col >> 3] |= bit;
+                else row_[col >> 3] &= (uint8_t)~bit;
+            }
+            ok = sink_->row(sink_->ctx, yy, row_, w);
+        }
+        sink_->end(sink_->ctx, ok);
+    }
+
+private:
+    bool clip(int* x, int* y, int* w, int* h) const {
+        if (*x < 0) { *w += *x; *x = 0; }
+        if (*y < 0) { *h += *y; *y = 0; }
+        if (*x + *w > w_) *w = w_ - *x;
+        if (*y + *h > h_) *h = h_ - *y;
+        if (*w > ROW_SINK_MAX_WIDTH) *w = ROW_SINK_MAX_WIDTH;
+        return *w > 0 && *h > 0;
+    }
+
+    const RowSink* sink_;
+    int w_, h_;
+    int cx_ = 0, cy_ = 0;
+    int fg_ = 0, bg_ = 1;
+    uint8_t row_[(ROW_SINK_MAX_WIDTH + 7) / 8];
+};
+
+#endif // SINK_DISPLAY_H
@@ -0,0 +1,216 @@
+/**
+ * Offline Timetable Slice - decoder and local journey planner
+ * Part of the Commute Compute System™
+ *
+ * The server attaches a compact "next N scheduled departures per leg" slice
+ * (X-Timetable-Slice header, base64) to every full-screen BMP. CCFirm keeps
+ * the latest one in RTC memory + NVS so that when fetches fail it can keep
+ * advancing the journey from its SNTP clock. See
+ * src/services/timetable-slice.js for the encoder and wire layout.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef TIMETABLE_SLICE_H
+#define TIMETABLE_SLICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define SLICE_VERSION         1
+#define SLICE_HEADER_SIZE     20
+#define SLICE_MAX_LEGS        6
+#define SLICE_MAX_DEPARTURES  32
+#define SLICE_MAX_LABEL       20
+#define SLICE_MAX_BYTES       1024   // Worst case is ~580 bytes; fits RTC slow memory
+#define SLICE_NO_ARRIVE_BY    0xFFFF
+
+#define SLICE_FLAG_LIVE       0x01
+#define SLICE_FLAG_PROJECTED  0x02
+
+// Leg types (match SLICE_LEG_TYPES on the server)
+enum SliceLegType {
+    SLICE_LEG_WALK   = 0,
+    SLICE_LEG_TRAIN  = 1,
+    SLICE_LEG_TRAM   = 2,
+    SLICE_LEG_BUS    = 3,
+    SLICE_LEG_COFFEE = 4,
+    SLICE_LEG_FERRY  = 5,
+    SLICE_LEG_VLINE  = 6
+};
+
+struct SliceLeg {
+    uint8_t type;
+    uint8_t minutes;                          // Leg duration
+    uint8_t depCount;
+    char label[SLICE_MAX_LABEL + 1];
+    uint16_t departures[SLICE_MAX_DEPARTURES]; // Minutes after generatedAt
+};
+
+struct TimetableSlice {
+    uint8_t flags;
+    uint8_t legCount;
+    uint32_t generatedAt;     // Unix seconds (UTC)
+    uint16_t horizonMinutes;
+    int16_t utcOffsetMinutes;
+    uint16_t arriveBy;        // Minutes after local midnight, or SLICE_NO_ARRIVE_BY
+    SliceLeg legs[SLICE_MAX_LEGS];
+};
+
+// Result of advancing the journey to a given time
+struct SlicePlan {
+    bool valid;               // A catchable departure exists for every transit leg
+    int leaveInMinutes;       // Until the user must leave (0 = leave now)
+    uint32_t leaveAt;         // Unix seconds
+    uint32_t arriveAt;        // Unix seconds
+    uint32_t legStart[SLICE_MAX_LEGS];   // Departure time of each leg (unix seconds)
+    uint8_t legWait[SLICE_MAX_LEGS];     // Minutes spent waiting before each leg
+};
+
+/**
+ * FNV-1a 32-bit hash (matches fnv1a32() on the server)
+ */
+static inline uint32_t slice_fnv1a(const uint8_t* data, size_t len) {
+    uint32_t hash = 0x811c9dc5u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+static inline uint16_t slice_read_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t slice_read_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline bool slice_is_transit(uint8_t type) {
+    return type == SLICE_LEG_TRAIN || type == SLICE_LEG_TRAM || type == SLICE_LEG_BUS ||
+           type == SLICE_LEG_FERRY || type == SLICE_LEG_VLINE;
+}
+
+/**
+ * Validate and decode a raw slice. Rejects bad magic/version, truncated
+ * legs, over-limit counts and checksum mismatches.
+ */
+static inline bool slice_parse(const uint8_t* data, size_t len, TimetableSlice* out) {
+    if (!data || !out || len < SLICE_HEADER_SIZE + 4 || len > SLICE_MAX_BYTES) return false;
+    if (memcmp(data, "CCTS", 4) != 0 || data[4] != SLICE_VERSION) return false;
+    if (slice_fnv1a(data, len - 4) != slice_read_u32(data + len - 4)) return false;
+
+    memset(out, 0, sizeof(*out));
+    out->flags = data[5];
+    out->legCount = data[6];
+    out->generatedAt = slice_read_u32(data + 8);
+    out->horizonMinutes = slice_read_u16(data + 12);
+    out->utcOffsetMinutes = (int16_t)slice_read_u16(data + 14);
+    out->arriveBy = slice_read_u16(data + 16);
+    if (out->legCount > SLICE_MAX_LEGS) return false;
+
+    size_t pos = SLICE_HEADER_SIZE;
+    size_t end = len - 4;
+    for (uint8_t i = 0; i < out->legCount; i++) {
+        if (pos + 4 > end) return false;
+        SliceLeg& leg = out->legs[i];
+        leg.type = data[pos];
+        leg.minutes = data[pos + 1];
+        leg.depCount = data[pos + 2];
+        uint8_t labelLen = data[pos + 3];
+        pos += 4;
+
+        if (leg.depCount > SLICE_MAX_DEPARTURES || labelLen > SLICE_MAX_LABEL) return false;
+        if (pos + labelLen + (size_t)leg.depCount * 2 > end) return false;
+
+        memcpy(leg.label, data + pos, labelLen);
+        leg.label[labelLen] = '\0';
+        pos += labelLen;
+
+        for (uint8_t d = 0; d < leg.depCount; d++) {
+            leg.departures[d] = slice_read_u16(data + pos);
+            pos += 2;
+        }
+    }
+    return pos == end;
+}
+
+/**
+ * True once the clock has moved past the slice's horizon
+ */
+static inline bool slice_expired(const TimetableSlice* slice, uint32_t nowUnix) {
+    return nowUnix >= slice->generatedAt + (uint32_t)slice->horizonMinutes * 60;
+}
+
+/**
+ * Advance the journey to nowUnix: catch the first reachable departure of
+ * each transit leg in order, then work back from the first one to get the
+ * latest time the user can leave.
+ */
+static inline bool slice_plan(const TimetableSlice* slice, uint32_t nowUnix, SlicePlan* plan) {
+    memset(plan, 0, sizeof(*plan));
+    if (!slice || slice->legCount == 0 || nowUnix < slice->generatedAt) return false;
+
+    uint32_t t = nowUnix;
+    int firstTransit = -1;
+    uint32_t preTransitSeconds = 0;
+
+    for (uint8_t i = 0; i < slice->legCount; i++) {
+        const SliceLeg& leg = slice->legs[i];
+        uint32_t start = t;
+
+        if (slice_is_transit(leg.type)) {
+            bool found = false;
+            for (uint8_t d = 0; d < leg.depCount; d++) {
+                uint32_t dep = slice->generatedAt + (uint32_t)leg.departures[d] * 60;
+                if (dep >= t) {
+                    start = dep;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) return false;
+            if (firstTransit < 0) firstTransit = i;
+        } else if (firstTransit < 0) {
+            preTransitSeconds += (uint32_t)leg.minutes * 60;
+        }
+
+        uint32_t wait = (start - t) / 60;
+        plan->legWait[i] = wait > 255 ? 255 : (uint8_t)wait;
+        plan->legStart[i] = start;
+        t = start + (uint32_t)leg.minutes * 60;
+    }
+
+    // Walking-only journeys can leave whenever; otherwise leave just in
+    // time for the first transit departure
+    plan->leaveAt = firstTransit < 0 ? nowUnix : plan->legStart[firstTransit] - preTransitSeconds;
+    if (plan->leaveAt < nowUnix) plan->leaveAt = nowUnix;
+    plan->leaveInMinutes = (int)((plan->leaveAt - nowUnix) / 60);
+
+    // Legs up to the first transit leg start from the leave time, not now,
+    // so there is no waiting before boarding
+    uint32_t walk = plan->leaveAt;
+    for (int i = 0; i < firstTransit; i++) {
+        plan->legStart[i] = walk;
+        plan->legWait[i] = 0;
+        walk += (uint32_t)slice->legs[i].minutes * 60;
+    }
+    if (firstTransit >= 0) plan->legWait[firstTransit] = 0;
+    plan->arriveAt = t;
+    plan->valid = true;
+    return true;
+}
+
+/**
+ * Local wall-clock minutes after midnight for a unix time
+ */
+static inline int slice_local_minutes(const TimetableSlice* slice, uint32_t unixTime) {
+    int64_t local = (int64_t)unixTime + (int64_t)slice->utcOffsetMinutes * 60;
+    int64_t mins = (local / 60) % (24 * 60);
+    return (int)(mins < 0 ? mins + 24 * 60 : mins);
+}
+
+#endif // TIMETABLE_SLICE_H
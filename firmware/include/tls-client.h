@@ -0,0 +1,514 @@
+/**
+ * TLS Client - tuned mbedTLS profile for the ESP32-C3 (-D CC_TLS_PROFILE)
+ * Part of the Commute Compute System™
+ *
+ * Stand-in for WiFiClientSecure with the calls main.cpp uses (setCACert,
+ * setInsecure, setPreSharedKey, connect, getPeerCertificate, lastError),
+ * but with a fixed handshake profile instead of whatever the server picks
+ * from the stock list:
+ *
+ *   - TLS 1.2, ECDHE on P-256 only
+ *   - ECDHE-ECDSA / ECDHE-RSA with AES-128-GCM-SHA256, and
+ *     PSK-AES-128-GCM-SHA256 for the PSK endpoint (tls-psk.h). AES and
+ *     SHA-256 both run on the C3 accelerators; SHA-384 suites would not
+ *   - SHA-256 signatures for the key exchange
+ *   - max_fragment_length (TLS_CLIENT_MFL, 4096) requested. If the server
+ *     accepts and mbedTLS has MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH, the
+ *     record buffers shrink to it after the handshake; stats shows what
+ *     was negotiated and the heap the connection holds
+ *   - the root bundle is parsed and the DRBG seeded once per boot, not
+ *     on every connect
+ *
+ * tlsclient_hw() reports which mbedTLS primitives the SDK routes to the
+ * accelerators; "bench crypto" on the serial shell measures them.
+ *
+ * ESP32 only (mbedTLS + lwIP sockets). One connection at a time: the
+ * DRBG and parsed roots are shared without locking.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef TLS_CLIENT_H
+#define TLS_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/error.h>
+#include <mbedtls/x509_crt.h>
+#include <mbedtls/gcm.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/ecp.h>
+#include "sdkconfig.h"
+
+#ifndef TLS_CLIENT_MFL
+#define TLS_CLIENT_MFL          MBEDTLS_SSL_MAX_FRAG_LEN_4096
+#endif
+#define TLS_CLIENT_CONNECT_MS   5000
+#define TLS_CLIENT_IO_MS        10000   // Write stall limit
+#define TLS_CLIENT_POLL_MS      20
+
+static const int TLS_CLIENT_CERT_SUITES[] = {
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
+    0
+};
+static const int TLS_CLIENT_PSK_SUITES[] = {
+    MBEDTLS_TLS_PSK_WITH_AES_128_GCM_SHA256,
+    0
+};
+static const mbedtls_ecp_group_id TLS_CLIENT_CURVES[] = {
+    MBEDTLS_ECP_DP_SECP256R1,
+    MBEDTLS_ECP_DP_NONE
+};
+static const int TLS_CLIENT_SIG_HASHES[] = {
+    MBEDTLS_MD_SHA256,
+    MBEDTLS_MD_NONE
+};
+
+// mbedTLS primitives the SDK build routes to the hardware accelerators
+struct TlsHwInfo {
+    bool aes;
+    bool sha;
+    bool mpi;   // Big-number (RSA verify, ECDHE, ECDSA)
+};
+
+static inline TlsHwInfo tlsclient_hw() {
+    TlsHwInfo hw = { false, false, false };
+#if defined(CONFIG_MBEDTLS_HARDWARE_AES)
+    hw.aes = true;
+#endif
+#if defined(CONFIG_MBEDTLS_HARDWARE_SHA)
+    hw.sha = true;
+#endif
+#if defined(CONFIG_MBEDTLS_HARDWARE_MPI)
+    hw.mpi = true;
+#endif
+    return hw;
+}
+
+// Per connection, filled in by connect()
+struct TlsClientStats {
+    uint32_t connectMs;     // TCP connect
+    uint32_t handshakeMs;   // TLS handshake after TCP
+    int32_t heapHeld;       // Free heap before connect minus after the handshake
+    uint32_t maxFragIn;     // Largest record the server may send (0 = not negotiated)
+    const char* suite;
+};
+
+// Shared by every connection for the life of the firmware
+struct TlsClientShared {
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_x509_crt roots;
+    const char* rootsPem;   // Bundle roots was parsed from
+    bool seeded;
+};
+// Weak so every source file that connects (main.cpp, shell.cpp) shares one
+__attribute__((weak)) TlsClientShared tlsClientShared;
+
+static inline int tlsclient_shared_init() {
+    TlsClientShared* s = &tlsClientShared;
+    if (s->seeded) return 0;
+    mbedtls_entropy_init(&s->entropy);
+    mbedtls_ctr_drbg_init(&s->drbg);
+    mbedtls_x509_crt_init(&s->roots);
+    int r = mbedtls_ctr_drbg_seed(&s->drbg, mbedtls_entropy_func, &s->entropy,
+                                  (const unsigned char*)"cc-tls", 6);
+    if (r == 0) s->seeded = true;
+    return r;
+}
+
+static inline int tlsclient_roots(const char* pem, mbedtls_x509_crt** out) {
+    TlsClientShared* s = &tlsClientShared;
+    if (s->rootsPem != pem) {
+        mbedtls_x509_crt_free(&s->roots);
+        mbedtls_x509_crt_init(&s->roots);
+        s->rootsPem = nullptr;
+        int r = mbedtls_x509_crt_parse(&s->roots, (const unsigned char*)pem, strlen(pem) + 1);
+        if (r < 0) return r;   // > 0: some certificates skipped, the rest are usable
+        s->rootsPem = pem;
+    }
+    *out = &s->roots;
+    return 0;
+}
+
+class CCTlsClient : public WiFiClient {
+public:
+    TlsClientStats stats;
+
+    CCTlsClient() : _mode(MODE_INSECURE), _rootsPem(nullptr), _pskIdentity(nullptr), _pskKeyHex(nullptr),
+                    _handshakeTimeoutS(15), _open(false), _closed(false), _peeked(-1), _lastErr(0) {
+        memset(&stats, 0, sizeof(stats));
+        mbedtls_net_init(&_net);
+        mbedtls_ssl_init(&_ssl);
+        mbedtls_ssl_config_init(&_conf);
+    }
+
+    ~CCTlsClient() {
+        stop();
+        mbedtls_ssl_free(&_ssl);
+        mbedtls_ssl_config_free(&_conf);
+    }
+
+    void setInsecure() { _mode = MODE_INSECURE; }
+    void setCACert(const char* pem) { _mode = MODE_ROOTS; _rootsPem = pem; }
+    void setPreSharedKey(const char* identity, const char* keyHex) {
+        _mode = MODE_PSK;
+        _pskIdentity = identity;
+        _pskKeyHex = keyHex;
+    }
+    void setHandshakeTimeout(unsigned long seconds) { _handshakeTimeoutS = seconds; }
+
+    int connect(IPAddress ip, uint16_t port) { return open(ip, nullptr, port, TLS_CLIENT_CONNECT_MS); }
+    int connect(IPAddress ip, uint16_t port, int32_t timeoutMs) { return open(ip, nullptr, port, timeoutMs); }
+    int connect(const char* host, uint16_t port) { return connect(host, port, TLS_CLIENT_CONNECT_MS); }
+    int connect(const char* host, uint16_t port, int32_t timeoutMs) {
+        IPAddress ip;
+        if (!WiFi.hostByName(host, ip)) {
+            _lastErr = MBEDTLS_ERR_NET_UNKNOWN_HOST;
+            return 0;
+        }
+        return open(ip, host, port, timeoutMs);
+    }
+
+    using Print::write;
+    size_t write(uint8_t b) { return write(&b, 1); }
+
+    size_t write(const uint8_t* buf, size_t size) {
+        if (!_open || _closed) return 0;
+        size_t done = 0;
+        unsigned long start = millis();
+        while (done < size) {
+            int r = mbedtls_ssl_write(&_ssl, buf + done, size - done);
+            if (r > 0) {
+                done += r;
+                start = millis();
+                continue;
+            }
+            if (r != MBEDTLS_ERR_SSL_WANT_READ && r != MBEDTLS_ERR_SSL_WANT_WRITE) {
+                fail(r);
+                break;
+            }
+            if (millis() - start > TLS_CLIENT_IO_MS) break;
+            waitSocket(r == MBEDTLS_ERR_SSL_WANT_READ, TLS_CLIENT_POLL_MS);
+        }
+        return done;
+    }
+
+    int available() {
+        if (!_open) return 0;
+        int n = (int)mbedtls_ssl_get_bytes_avail(&_ssl);
+        if (n == 0 && !_closed) {
+            // Process one record, if one has arrived
+            int r = mbedtls_ssl_read(&_ssl, nullptr, 0);
+            if (r < 0 && r != MBEDTLS_ERR_SSL_WANT_READ && r != MBEDTLS_ERR_SSL_WANT_WRITE) fail(r);
+            n = (int)mbedtls_ssl_get_bytes_avail(&_ssl);
+        }
+        return n + (_peeked >= 0 ? 1 : 0);
+    }
+
+    int read() {
+        uint8_t b;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+
+    // Non-blocking, like WiFiClientSecure: -1 when nothing is buffered
+    int read(uint8_t* buf, size_t size) {
+        if (size == 0 || available() <= 0) return -1;
+        size_t got = 0;
+        if (_peeked >= 0) {
+            buf[got++] = (uint8_t)_peeked;
+            _peeked = -1;
+        }
+        if (got < size && mbedtls_ssl_get_bytes_avail(&_ssl) > 0) {
+            int r = mbedtls_ssl_read(&_ssl, buf + got, size - got);
+            if (r > 0) got += r;
+        }
+        return (int)got;
+    }
+
+    // Bulk read with the Stream timeout (the default readBytes goes a byte at a time)
+    size_t readBytes(uint8_t* buf, size_t length) {
+        size_t done = 0;
+        unsigned long start = millis();
+        while (done < length) {
+            int n = read(buf + done, length - done);
+            if (n > 0) {
+                done += n;
+                start = millis();
+                continue;
+            }
+            if (!_open || _closed || millis() - start > getTimeout()) break;
+            waitSocket(true, TLS_CLIENT_POLL_MS);
+        }
+        return done;
+    }
+    size_t readBytes(char* buf, size_t length) { return readBytes((uint8_t*)buf, length); }
+
+    int peek() {
+        if (_peeked >= 0) return _peeked;
+        uint8_t b;
+        if (read(&b, 1) != 1) return -1;
+        _peeked = b;
+        return _peeked;
+    }
+
+    void flush() {}
+
+    void stop() {
+        if (_open) {
+            if (!_closed) mbedtls_ssl_close_notify(&_ssl);
+            mbedtls_net_free(&_net);
+            mbedtls_ssl_free(&_ssl);
+            mbedtls_ssl_config_free(&_conf);
+            mbedtls_net_init(&_net);
+            mbedtls_ssl_init(&_ssl);
+            mbedtls_ssl_config_init(&_conf);
+        }
+        _open = false;
+        _closed = false;
+        _peeked = -1;
+    }
+
+    uint8_t connected() {
+        if (!_open) return 0;
+        return !_closed || available() > 0;
+    }
+
+    operator bool() { return connected(); }
+
+    const mbedtls_x509_crt* getPeerCertificate() {
+        return _open ? mbedtls_ssl_get_peer_cert(&_ssl) : nullptr;
+    }
+
+    int lastError(char* buf, size_t size) {
+        if (_lastErr == 0) return 0;
+        mbedtls_strerror(_lastErr, buf, size);
+        return _lastErr;
+    }
+
+private:
+    enum Mode { MODE_INSECURE, MODE_ROOTS, MODE_PSK };
+
+    Mode _mode;
+    const char* _rootsPem;
+    const char* _pskIdentity;
+    const char* _pskKeyHex;
+    unsigned long _handshakeTimeoutS;
+    bool _open;
+    bool _closed;       // Peer closed or fatal error - buffered data is still readable
+    int _peeked;
+    int _lastErr;
+    mbedtls_net_context _net;
+    mbedtls_ssl_context _ssl;
+    mbedtls_ssl_config _conf;
+
+    void fail(int err) {
+        _lastErr = err;
+        _closed = true;
+    }
+
+    void waitSocket(bool forRead, uint32_t ms) {
+        if (_net.fd < 0) return;
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(_net.fd, &fds);
+        struct timeval tv = { 0, (long)ms * 1000 };
+        select(_net.fd + 1, forRead ? &fds : nullptr, forRead ? nullptr : &fds, nullptr, &tv);
+    }
+
+    static int hexNibble(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // Non-blocking TCP connect with a timeout; the socket stays non-blocking
+    bool openSocket(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+        int fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (fd < 0) return false;
+        _net.fd = fd;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = (uint32_t)ip;
+        if (lwip_connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) return false;
+
+        fd_set wfds;
+        FD_ZERO(&wfds);
+        FD_SET(fd, &wfds);
+        struct timeval tv = { timeoutMs / 1000, (long)(timeoutMs % 1000) * 1000 };
+        if (select(fd + 1, nullptr, &wfds, nullptr, &tv) <= 0) return false;
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) return false;
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return true;
+    }
+
+    int configure(const char* host) {
+        int r = mbedtls_ssl_config_defaults(&_conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                            MBEDTLS_SSL_PRESET_DEFAULT);
+        if (r) return r;
+        mbedtls_ssl_conf_min_version(&_conf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+        mbedtls_ssl_conf_max_version(&_conf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+        mbedtls_ssl_conf_rng(&_conf, mbedtls_ctr_drbg_random, &tlsClientShared.drbg);
+        mbedtls_ssl_conf_curves(&_conf, TLS_CLIENT_CURVES);
+        mbedtls_ssl_conf_sig_hashes(&_conf, TLS_CLIENT_SIG_HASHES);
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+        mbedtls_ssl_conf_max_frag_len(&_conf, TLS_CLIENT_MFL);
+#endif
+
+        if (_mode == MODE_PSK) {
+            uint8_t key[32];
+            size_t keyLen = strlen(_pskKeyHex) / 2;
+            if (keyLen == 0 || keyLen > sizeof(key)) return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+            for (size_t i = 0; i < keyLen; i++) {
+                int hi = hexNibble(_pskKeyHex[2 * i]), lo = hexNibble(_pskKeyHex[2 * i + 1]);
+                if (hi < 0 || lo < 0) return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+                key[i] = (uint8_t)(hi << 4 | lo);
+            }
+            mbedtls_ssl_conf_ciphersuites(&_conf, TLS_CLIENT_PSK_SUITES);
+            r = mbedtls_ssl_conf_psk(&_conf, key, keyLen, (const unsigned char*)_pskIdentity, strlen(_pskIdentity));
+            memset(key, 0, sizeof(key));
+            if (r) return r;
+            mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_NONE);
+        } else if (_mode == MODE_ROOTS) {
+            mbedtls_x509_crt* roots;
+            r = tlsclient_roots(_rootsPem, &roots);
+            if (r) return r;
+            mbedtls_ssl_conf_ciphersuites(&_conf, TLS_CLIENT_CERT_SUITES);
+            mbedtls_ssl_conf_ca_chain(&_conf, roots, nullptr);
+            mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        } else {
+            // Unauthenticated, or pinned: the caller checks the leaf afterwards
+            mbedtls_ssl_conf_ciphersuites(&_conf, TLS_CLIENT_CERT_SUITES);
+            mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_NONE);
+        }
+
+        r = mbedtls_ssl_setup(&_ssl, &_conf);
+        if (r) return r;
+        if (host && _mode != MODE_PSK) {
+            r = mbedtls_ssl_set_hostname(&_ssl, host);
+            if (r) return r;
+        }
+        mbedtls_ssl_set_bio(&_ssl, &_net, mbedtls_net_send, mbedtls_net_recv, nullptr);
+        return 0;
+    }
+
+    int open(IPAddress ip, const char* host, uint16_t port, int32_t timeoutMs) {
+        stop();
+        memset(&stats, 0, sizeof(stats));
+        _lastErr = 0;
+        int32_t heapBefore = (int32_t)ESP.getFreeHeap();
+        unsigned long t0 = millis();
+
+        int r = tlsclient_shared_init();
+        if (r) {
+            _lastErr = r;
+            return 0;
+        }
+        _open = true;   // From here stop() releases the socket and contexts
+        if (!openSocket(ip, port, timeoutMs)) {
+            _lastErr = MBEDTLS_ERR_NET_CONNECT_FAILED;
+            stop();
+            return 0;
+        }
+        stats.connectMs = millis() - t0;
+
+        unsigned long t1 = millis();
+        r = configure(host);
+        while (r == 0 && (r = mbedtls_ssl_handshake(&_ssl)) != 0) {
+            if (r != MBEDTLS_ERR_SSL_WANT_READ && r != MBEDTLS_ERR_SSL_WANT_WRITE) break;
+            if (millis() - t1 > _handshakeTimeoutS * 1000UL) {
+                r = MBEDTLS_ERR_SSL_TIMEOUT;
+                break;
+            }
+            waitSocket(r == MBEDTLS_ERR_SSL_WANT_READ, TLS_CLIENT_POLL_MS);
+            r = 0;
+        }
+        if (r != 0) {
+            _lastErr = r;
+            _closed = true;   // No close_notify on a failed handshake
+            stop();
+            return 0;
+        }
+
+        stats.handshakeMs = millis() - t1;
+        stats.heapHeld = heapBefore - (int32_t)ESP.getFreeHeap();
+        stats.suite = mbedtls_ssl_get_ciphersuite(&_ssl);
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+        stats.maxFragIn = (uint32_t)mbedtls_ssl_get_input_max_frag_len(&_ssl);
+#endif
+        return 1;
+    }
+};
+
+// ============================================================================
+// CRYPTO MICROBENCHMARKS ("bench crypto")
+// ============================================================================
+
+/** Microseconds to SHA-256 len bytes of buf, n times */
+static inline uint32_t tlsclient_bench_sha256(const uint8_t* buf, size_t len, int n) {
+    uint8_t out[32];
+    unsigned long t0 = micros();
+    for (int i = 0; i < n; i++) mbedtls_sha256(buf, len, out, 0);
+    return micros() - t0;
+}
+
+/** Microseconds to AES-128-GCM encrypt len bytes of buf in place, n times */
+static inline uint32_t tlsclient_bench_gcm(uint8_t* buf, size_t len, int n) {
+    static const uint8_t key[16] = { 0 };
+    uint8_t iv[12] = { 0 };
+    uint8_t tag[16];
+    mbedtls_gcm_context gcm;
+    mbedtls_gcm_init(&gcm);
+    mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 128);
+    unsigned long t0 = micros();
+    for (int i = 0; i < n; i++) {
+        iv[0] = (uint8_t)i;
+        mbedtls_gcm_crypt_and_tag(&gcm, MBEDTLS_GCM_ENCRYPT, len, iv, sizeof(iv), nullptr, 0,
+                                  buf, buf, sizeof(tag), tag);
+    }
+    uint32_t us = micros() - t0;
+    mbedtls_gcm_free(&gcm);
+    return us;
+}
+
+/** Microseconds for n P-256 key pairs (one ECDHE share each), or 0 on error */
+static inline uint32_t tlsclient_bench_p256(int n) {
+    if (tlsclient_shared_init() != 0) return 0;
+    mbedtls_ecp_group grp;
+    mbedtls_mpi d;
+    mbedtls_ecp_point q;
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_mpi_init(&d);
+    mbedtls_ecp_point_init(&q);
+    uint32_t us = 0;
+    if (mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1) == 0) {
+        unsigned long t0 = micros();
+        bool ok = true;
+        for (int i = 0; i < n && ok; i++) {
+            ok = mbedtls_ecp_gen_keypair(&grp, &d, &q, mbedtls_ctr_drbg_random, &tlsClientShared.drbg) == 0;
+        }
+        if (ok) us = micros() - t0;
+    }
+    mbedtls_ecp_point_free(&q);
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_group_free(&grp);
+    return us;
+}
+
+#endif // TLS_CLIENT_H
@@ -0,0 +1,91 @@
+/**
+ * TLS Pin - cached result of a verified certificate chain
+ * Part of the Commute Compute System™
+ *
+ * Full verification parses the root bundle (tls-roots.h) and checks the
+ * chain signatures on every handshake. Once a server's chain has verified,
+ * main.cpp keeps the SHA-256 of its leaf certificate and the leaf's expiry
+ * in NVS. Later handshakes to the same host skip chain verification and
+ * compare the leaf against the pin; a different leaf (renewal, another
+ * edge node) or a pin near expiry goes through full verification again and
+ * replaces the pin.
+ *
+ * The expiry check needs the SNTP clock. Before the first sync (clock
+ * reads 0) a matching pin is still accepted: it is the exact certificate
+ * that verified earlier.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef TLS_PIN_H
+#define TLS_PIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define TLS_PIN_MAGIC       0x4343504E  // "CCPN"
+#define TLS_PIN_RENEW_S     (3 * 86400) // Re-verify the chain this long before the leaf expires
+
+// Stored as one NVS blob
+struct TlsPin {
+    uint32_t magic;
+    uint32_t hostHash;      // FNV-1a of the host name
+    uint8_t sha256[32];     // Leaf certificate (DER) fingerprint
+    uint32_t notAfter;      // Leaf expiry, unix seconds
+    uint32_t verifiedAt;    // When the chain verified (0 if the clock was unset)
+};
+
+static inline uint32_t tlspin_host_hash(const char* host) {
+    uint32_t h = 2166136261u;
+    for (const char* p = host; *p; p++) {
+        h ^= (uint8_t)*p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static inline void tlspin_clear(TlsPin* pin) {
+    memset(pin, 0, sizeof(*pin));
+}
+
+/**
+ * true if the pin may stand in for chain verification of host
+ * @param now Unix seconds, or 0 if the clock is not set yet
+ */
+static inline bool tlspin_usable(const TlsPin* pin, const char* host, uint32_t now) {
+    if (pin->magic != TLS_PIN_MAGIC || pin->hostHash != tlspin_host_hash(host)) return false;
+    return now == 0 || (uint64_t)now + TLS_PIN_RENEW_S < pin->notAfter;
+}
+
+static inline bool tlspin_matches(const TlsPin* pin, const uint8_t sha256[32]) {
+    return memcmp(pin->sha256, sha256, 32) == 0;
+}
+
+static inline void tlspin_set(TlsPin* pin, const char* host, const uint8_t sha256[32], uint32_t notAfter, uint32_t now) {
+    pin->magic = TLS_PIN_MAGIC;
+    pin->hostHash = tlspin_host_hash(host);
+    memcpy(pin->sha256, sha256, 32);
+    pin->notAfter = notAfter;
+    pin->verifiedAt = now;
+}
+
+/**
+ * Unix seconds of a certificate date (mbedtls_x509_time fields, UTC).
+ * Dates past 2106 saturate.
+ */
+static inline uint32_t tlspin_unix_time(int year, int mon, int day, int hour, int min, int sec) {
+    if (year < 1970 || mon < 1 || mon > 12 || day < 1 || day > 31) return 0;
+    // Days from civil (proleptic Gregorian), March-based year
+    int y = year - (mon <= 2);
+    int era = y / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (mon + (mon > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = (int64_t)era * 146097 + doe - 719468;
+    int64_t t = days * 86400 + hour * 3600 + min * 60 + sec;
+    return t > 0xFFFFFFFFLL ? 0xFFFFFFFFu : (uint32_t)t;
+}
+
+#endif // TLS_PIN_H
@@ -0,0 +1,105 @@
+/**
+ * TLS PSK - per-device pre-shared key transport for dashboard fetches
+ * Part of the Commute Compute System™
+ *
+ * Pairing (/api/pair/{code}) hands the device a PSK identity, a 32-byte
+ * key (hex) and, when the server runs one, a PSK endpoint. main.cpp then
+ * fetches through the endpoint with WiFiClientSecure::setPreSharedKey():
+ * a plain PSK suite has no certificate chain and no ECDHE, which is most of
+ * the handshake time on an ESP32-C3. Server side: src/utils/device-psk.js
+ *
+ * A failed PSK connection falls back to certificate TLS for that fetch.
+ * After TLS_PSK_FAIL_LIMIT failures in a row PSK is skipped for
+ * TLS_PSK_RETRY_FETCHES fetches so a dead endpoint does not add a connect
+ * timeout to every cycle.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef TLS_PSK_H
+#define TLS_PSK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define TLS_PSK_IDENTITY_MAX    33      // "cc1-" + 16 hex + NUL, with room
+#define TLS_PSK_KEY_HEX_MAX     65      // 32-byte key as hex + NUL
+#define TLS_PSK_ENDPOINT_MAX    128
+#define TLS_PSK_FAIL_LIMIT      3
+#define TLS_PSK_RETRY_FETCHES   12
+
+// Handshake energy estimate for "bench tls": radio on + CPU at 160 MHz.
+// Use a supply meter for real numbers; this only makes runs comparable.
+#define TLS_BENCH_ACTIVE_MA     95
+#define TLS_BENCH_SUPPLY_MV     3300
+
+struct TlsPskState {
+    uint8_t failures;     // Consecutive failed PSK connections
+    uint8_t skip;         // Fetches left before PSK is tried again
+};
+
+/** Identity is printable and the key is an even number of hex digits (16-32 bytes) */
+static inline bool tlspsk_valid(const char* identity, const char* keyHex) {
+    size_t idLen = strlen(identity);
+    if (idLen == 0 || idLen >= TLS_PSK_IDENTITY_MAX) return false;
+    for (size_t i = 0; i < idLen; i++) {
+        if (identity[i] <= ' ' || identity[i] > '~') return false;
+    }
+    size_t keyLen = strlen(keyHex);
+    if (keyLen < 32 || keyLen >= TLS_PSK_KEY_HEX_MAX || (keyLen & 1)) return false;
+    for (size_t i = 0; i < keyLen; i++) {
+        char c = keyHex[i];
+        bool hex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        if (!hex) return false;
+    }
+    return true;
+}
+
+/**
+ * Dashboard URL on the PSK endpoint: scheme, host and port of url are
+ * replaced by endpoint ("https://host:port"), path and query are kept.
+ * @returns false if either URL is unusable or out is too small
+ */
+static inline bool tlspsk_url(const char* endpoint, const char* url, char* out, size_t outSize) {
+    if (strncmp(endpoint, "https://", 8) != 0 || endpoint[8] == '\0') return false;
+    const char* scheme = strstr(url, "://");
+    if (!scheme) return false;
+    const char* path = strchr(scheme + 3, '/');
+    if (!path) path = "/";
+
+    size_t baseLen = strlen(endpoint);
+    while (baseLen > 8 && endpoint[baseLen - 1] == '/') baseLen--;
+    size_t pathLen = strlen(path);
+    if (baseLen + pathLen + 1 > outSize) return false;
+    memcpy(out, endpoint, baseLen);
+    memcpy(out + baseLen, path, pathLen + 1);
+    return true;
+}
+
+/** true if this fetch should go through the PSK endpoint */
+static inline bool tlspsk_should_try(TlsPskState* s) {
+    if (s->skip == 0) return true;
+    s->skip--;
+    return false;
+}
+
+/** Record the outcome of a PSK connection attempt */
+static inline void tlspsk_record(TlsPskState* s, bool ok) {
+    if (ok) {
+        s->failures = 0;
+        return;
+    }
+    if (++s->failures >= TLS_PSK_FAIL_LIMIT) {
+        s->failures = 0;
+        s->skip = TLS_PSK_RETRY_FETCHES;
+    }
+}
+
+/** Estimated energy of an awake period in microjoules */
+static inline uint32_t tlspsk_energy_uj(uint32_t ms) {
+    return (uint32_t)((uint64_t)ms * TLS_BENCH_ACTIVE_MA * TLS_BENCH_SUPPLY_MV / 1000);
+}
+
+#endif // TLS_PSK_H
@@ -0,0 +1,228 @@
+/**
+ * Trace Ring - task-level execution trace for Perfetto / chrome://tracing
+ * Part of the Commute Compute System™
+ *
+ * The phase timers (device-metrics.h) say how long each phase takes on
+ * average; this records when it ran and on which task, so the network
+ * task, decode on the loop, the panel's SPI transfer and BUSY wait and BLE
+ * callbacks can be seen interleaved on one timeline:
+ *
+ *   CCTRACE_SCOPE(TRACE_TASK_NET, "http");            // Begin now, end at scope exit
+ *   CCTRACE_BEGIN(TRACE_TASK_PANEL, "refresh partial"); ... CCTRACE_END(...);
+ *   CCTRACE_INSTANT(TRACE_TASK_BLE, "write", len);
+ *   CCTRACE_COUNTER(TRACE_TASK_LOOP, "heap free", ESP.getFreeHeap());
+ *
+ * Tasks are tracks on the timeline: the FreeRTOS tasks that record (loop,
+ * the dual-core net task, BLE callbacks) plus "panel" for the display
+ * work the loop does (loadBMP, refresh and its BUSY wait).
+ *
+ * Each event takes one slot of a power-of-two ring (TRACE_EVENTS): a
+ * microsecond timestamp (wraps after ~71 minutes), type, task, a u32
+ * argument and the name, which must be a string literal - it is stored by
+ * address and only read when the ring is dumped. A slot is claimed with a
+ * single atomic add, so any task on either core records without a lock
+ * (the C3 has no atomic instructions; the IDF's __atomic helpers mask
+ * interrupts for the add). The oldest events are overwritten.
+ *
+ * trace_dump() prints the ring as hex plus task and name tables between
+ * CCTRACE-BEGIN and CCTRACE-END; tools/trace_export.py turns that into
+ * Chrome trace JSON.
+ *
+ * Without -D CC_TRACE the macros compile to nothing.
+ *
+ * Off the device (no ESP_PLATFORM) timestamps come from CLOCK_MONOTONIC,
+ * so env:native-bench can trace its two pipeline threads.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#else
+#include <time.h>
+#endif
+
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS      256     // Power of two; 20 B each on the device
+#endif
+#define TRACE_VERSION     1
+#define TRACE_MAX_NAMES   64      // Distinct names per dump, the rest print as "?"
+#define TRACE_DUMP_BYTES  12      // Per event in the hex dump
+
+static_assert((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of two");
+
+// Chrome trace phases
+enum TraceType : uint8_t {
+    TRACE_BEGIN   = 'B',
+    TRACE_END     = 'E',
+    TRACE_INSTANT = 'i',
+    TRACE_COUNTER = 'C'
+};
+
+enum TraceTask : uint8_t {
+    TRACE_TASK_LOOP  = 0,         // Arduino loop (core 1 on the S3)
+    TRACE_TASK_NET   = 1,         // CC_DUAL_CORE network task (core 0)
+    TRACE_TASK_PANEL = 2,         // loadBMP, refresh and BUSY wait
+    TRACE_TASK_BLE   = 3,         // BLE stack callbacks
+    TRACE_TASK_COUNT
+};
+
+static const char* const TRACE_TASK_NAMES[TRACE_TASK_COUNT] = { "loop", "net", "panel", "ble" };
+
+struct TraceEvent {
+    uint32_t us;
+    uint8_t type;
+    uint8_t task;
+    uint16_t reserved;
+    uint32_t arg;
+    uint32_t seq;                 // Claim index + 1, stored last (0 = never written)
+    const char* name;
+};
+
+struct TraceRing {
+    uint32_t head;                // Events claimed since boot
+    uint32_t start;               // trace_clear() point
+    TraceEvent ev[TRACE_EVENTS];
+};
+
+typedef void (*TraceOutFn)(const char* text, size_t len, void* ctx);
+
+// Shared by every source file of the firmware, like g_logRing (log-ring.h)
+#ifdef ESP_PLATFORM
+__attribute__((weak)) TraceRing g_traceRing;
+#else
+static TraceRing g_traceRing;
+#endif
+
+static inline uint32_t trace_now_us() {
+#ifdef ESP_PLATFORM
+    return (uint32_t)esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+#endif
+}
+
+static inline void trace_record(uint8_t type, uint8_t task, const char* name, uint32_t arg) {
+    uint32_t i = __atomic_fetch_add(&g_traceRing.head, 1, __ATOMIC_RELAXED);
+    TraceEvent* e = &g_traceRing.ev[i & (TRACE_EVENTS - 1)];
+    __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+    e->us = trace_now_us();
+    e->type = type;
+    e->task = task;
+    e->arg = arg;
+    e->name = name;
+    __atomic_store_n(&e->seq, i + 1, __ATOMIC_RELEASE);
+}
+
+// Ends the span when it goes out of scope (every return path)
+struct TraceScope {
+    uint8_t task;
+    const char* name;
+    TraceScope(uint8_t t, const char* n) : task(t), name(n) { trace_record(TRACE_BEGIN, t, n, 0); }
+    ~TraceScope() { trace_record(TRACE_END, task, name, 0); }
+};
+
+#define CCTRACE_CAT2(a, b) a##b
+#define CCTRACE_CAT(a, b) CCTRACE_CAT2(a, b)
+
+#ifdef CC_TRACE
+#define CCTRACE_BEGIN(task, name)        trace_record(TRACE_BEGIN, task, name, 0)
+#define CCTRACE_END(task, name)          trace_record(TRACE_END, task, name, 0)
+#define CCTRACE_INSTANT(task, name, arg) trace_record(TRACE_INSTANT, task, name, (uint32_t)(arg))
+#define CCTRACE_COUNTER(task, name, val) trace_record(TRACE_COUNTER, task, name, (uint32_t)(val))
+#define CCTRACE_SCOPE(task, name)        TraceScope CCTRACE_CAT(traceScope_, __LINE__)(task, name)
+#else
+#define CCTRACE_BEGIN(task, name)        ((void)0)
+#define CCTRACE_END(task, name)          ((void)0)
+#define CCTRACE_INSTANT(task, name, arg) ((void)0)
+#define CCTRACE_COUNTER(task, name, val) ((void)0)
+#define CCTRACE_SCOPE(task, name)        ((void)0)
+#endif
+
+/** Forget everything recorded so far (the next dump starts here) */
+static inline void trace_clear() {
+    g_traceRing.start = __atomic_load_n(&g_traceRing.head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Hex dump for tools/trace_export.py:
+ *   CCTRACE-BEGIN <version> <events> <dropped> <now us>
+ *   CCTRACE-TASK <id> <name>            (per task)
+ *   CCTRACE-NAME <index> <name>         (per distinct event name)
+ *   <hex, 5 events per line: u32le us, u8 type, u8 task, u8 name index, u8 0, u32le arg>
+ *   CCTRACE-END
+ * Events still being written when the dump reaches them are left out.
+ */
+static inline void trace_dump(TraceOutFn out, void* ctx) {
+    static TraceEvent snap[TRACE_EVENTS];
+    static const char* names[TRACE_MAX_NAMES];
+    TraceRing* r = &g_traceRing;
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    uint32_t first = head - r->start > TRACE_EVENTS ? head - TRACE_EVENTS : r->start;
+    uint32_t dropped = first - r->start;
+
+    uint32_t n = 0;
+    for (uint32_t i = first; i != head; i++) {
+        const TraceEvent* e = &r->ev[i & (TRACE_EVENTS - 1)];
+        if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) != i + 1) continue;
+        snap[n] = *e;
+        if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) == i + 1) n++;   // Not overwritten while copied
+    }
+
+    char line[160];
+    int len = snprintf(line, sizeof(line), "CCTRACE-BEGIN %d %u %u %lu\n", TRACE_VERSION,
+                       (unsigned)n, (unsigned)dropped, (unsigned long)trace_now_us());
+    out(line, len, ctx);
+    for (int t = 0; t < TRACE_TASK_COUNT; t++) {
+        len = snprintf(line, sizeof(line), "CCTRACE-TASK %d %s\n", t, TRACE_TASK_NAMES[t]);
+        out(line, len, ctx);
+    }
+
+    // Name table, then the events with names replaced by their index
+    uint8_t index[TRACE_EVENTS];
+    size_t nameCount = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        size_t k = 0;
+        while (k < nameCount && names[k] != snap[i].name) k++;
+        if (k == nameCount && nameCount < TRACE_MAX_NAMES) {
+            names[nameCount++] = snap[i].name;
+            len = snprintf(line, sizeof(line), "CCTRACE-NAME %u %s\n", (unsigned)k,
+                           snap[i].name ? snap[i].name : "?");
+            out(line, len, ctx);
+        }
+        index[i] = k < nameCount ? (uint8_t)k : 0xFF;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    for (uint32_t i = 0; i < n; i += 5) {
+        size_t m = 0;
+        for (uint32_t j = i; j < n && j < i + 5; j++) {
+            const TraceEvent* e = &snap[j];
+            uint8_t b[TRACE_DUMP_BYTES] = {
+                (uint8_t)e->us, (uint8_t)(e->us >> 8), (uint8_t)(e->us >> 16), (uint8_t)(e->us >> 24),
+                e->type, e->task, index[j], 0,
+                (uint8_t)e->arg, (uint8_t)(e->arg >> 8), (uint8_t)(e->arg >> 16), (uint8_t)(e->arg >> 24)
+            };
+            for (size_t k = 0; k < sizeof(b); k++) {
+                line[m++] = hex[b[k] >> 4];
+                line[m++] = hex[b[k] & 0x0F];
+            }
+        }
+        line[m++] = '\n';
+        out(line, m, ctx);
+    }
+    out("CCTRACE-END\n", 12, ctx);
+}
+
+#endif // TRACE_RING_H
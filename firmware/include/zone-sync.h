@@ -0,0 +1,148 @@
+/**
+ * Zone Sync - one-request conditional zone refresh (X-Zone-Hashes)
+ * Part of the Commute Compute System™
+ *
+ * The device keeps the content hash of every zone it is showing and sends
+ * them with the zone request; the server replies with only the zones that
+ * differ, as CCZF frames (frame-codec.h), and the full new hash vector in
+ * the response header. Protocol and server side: src/services/zone-sync.js
+ *
+ *   X-Zone-Hashes: base64( u8 version=1, u32le hash × n )
+ *
+ * An empty vector asks for every zone (first draw, full refresh, or after a
+ * failed decode). ZoneBmpSink turns each decoded zone into a small top-down
+ * BMP and hands it to a draw callback (bbep.loadBMP at the zone position),
+ * so firmware without a full-screen shadow buffer can use it.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef ZONE_SYNC_H
+#define ZONE_SYNC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "base64.hpp"
+#include "row-sink.h"
+#include "bmp-stream.h"
+
+#define ZONE_SYNC_HEADER      "X-Zone-Hashes"
+#define ZONE_SYNC_VERSION     1
+#define ZONE_SYNC_MAX         16
+#define ZONE_SYNC_BLOB_MAX    (1 + 4 * ZONE_SYNC_MAX)
+#define ZONE_SYNC_TEXT_MAX    (4 * ((ZONE_SYNC_BLOB_MAX + 2) / 3) + 1)   // Base64 + NUL
+#define ZONE_SYNC_ACCEPT      "application/x-cczf"
+
+struct ZoneHashes {
+    uint8_t count;
+    uint32_t hash[ZONE_SYNC_MAX];
+};
+
+static inline void zonesync_clear(ZoneHashes* z) {
+    z->count = 0;
+}
+
+/**
+ * Header value for z into out (NUL-terminated).
+ * @returns length, or 0 if out is too small
+ */
+static inline size_t zonesync_encode(const ZoneHashes* z, char* out, size_t outSize) {
+    uint8_t blob[ZONE_SYNC_BLOB_MAX];
+    size_t n = 0;
+    blob[n++] = ZONE_SYNC_VERSION;
+    for (uint8_t i = 0; i < z->count && i < ZONE_SYNC_MAX; i++) {
+        for (int b = 0; b < 4; b++) blob[n++] = (uint8_t)(z->hash[i] >> (8 * b));
+    }
+
+    size_t need = 4 * ((n + 2) / 3);
+    if (need + 1 > outSize) return 0;
+    size_t o = 0;
+    for (size_t i = 0; i < n; i += 3) {
+        uint32_t v = (uint32_t)blob[i] << 16;
+        if (i + 1 < n) v |= (uint32_t)blob[i + 1] << 8;
+        if (i + 2 < n) v |= blob[i + 2];
+        out[o++] = base64_chars[(v >> 18) & 0x3F];
+        out[o++] = base64_chars[(v >> 12) & 0x3F];
+        out[o++] = i + 1 < n ? base64_chars[(v >> 6) & 0x3F] : '=';
+        out[o++] = i + 2 < n ? base64_chars[v & 0x3F] : '=';
+    }
+    out[o] = '\0';
+    return o;
+}
+
+/** Parse the response header. Returns false (z untouched) if malformed. */
+static inline bool zonesync_decode(const char* text, size_t len, ZoneHashes* z) {
+    const unsigned char* in = (const unsigned char*)text;
+    if (decode_base64_length(in, len) > ZONE_SYNC_BLOB_MAX) return false;
+    uint8_t blob[ZONE_SYNC_BLOB_MAX];
+    size_t n = decode_base64(in, len, blob);
+    if (n < 1 || blob[0] != ZONE_SYNC_VERSION || (n - 1) % 4 != 0) return false;
+
+    z->count = (uint8_t)((n - 1) / 4);
+    for (uint8_t i = 0; i < z->count; i++) {
+        const uint8_t* p = blob + 1 + 4 * i;
+        z->hash[i] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    return true;
+}
+
+// ============================================================================
+// ZONE BMP SINK
+// ============================================================================
+
+typedef bool (*ZoneDrawFn)(void* ctx, const uint8_t* bmp, int x, int y, int w, int h);
+
+/**
+ * RowSink that assembles one zone at a time as a top-down BMP in buf and
+ * calls draw() when the zone is complete. buf must hold the largest zone
+ * (62 + h * ((w + 31) / 32) * 4 bytes).
+ */
+struct ZoneBmpSink {
+    uint8_t* buf;
+    size_t size;
+    ZoneDrawFn draw;
+    void* drawCtx;
+
+    FrameBuffer fb;
+    FrameBufferSink inner;
+    int x, y, w, h;
+    uint32_t zonesDrawn;
+    bool drawFailed;
+};
+
+static inline bool zonebmp_begin(void* ctx, int x, int y, int w, int h) {
+    ZoneBmpSink* s = (ZoneBmpSink*)ctx;
+    if (!bmp_shadow_init(s->buf, s->size, w, h, &s->fb)) return false;
+    fbsink_make(&s->inner, &s->fb);
+    s->x = x; s->y = y; s->w = w; s->h = h;
+    return fbsink_begin(&s->inner, 0, 0, w, h);
+}
+
+static inline bool zonebmp_row(void* ctx, int y, const uint8_t* bits, int w) {
+    ZoneBmpSink* s = (ZoneBmpSink*)ctx;
+    return fbsink_row(&s->inner, y - s->y, bits, w);
+}
+
+static inline void zonebmp_end(void* ctx, bool ok) {
+    ZoneBmpSink* s = (ZoneBmpSink*)ctx;
+    if (!ok) return;
+    if (s->draw(s->drawCtx, s->buf, s->x, s->y, s->w, s->h)) {
+        s->zonesDrawn++;
+    } else {
+        s->drawFailed = true;
+    }
+}
+
+static inline RowSink zonebmp_make(ZoneBmpSink* s, uint8_t* buf, size_t size, ZoneDrawFn draw, void* drawCtx) {
+    memset(s, 0, sizeof(*s));
+    s->buf = buf;
+    s->size = size;
+    s->draw = draw;
+    s->drawCtx = drawCtx;
+    RowSink sink = { s, zonebmp_begin, zonebmp_row, zonebmp_end };
+    return sink;
+}
+
+#endif // ZONE_SYNC_H
@@ -16,6 +16,8 @@
 # - Zone-based partial refresh
 # - Full/partial refresh management
 # - TRMNL BYOS API compatibility
+# - Native display client (ccdisplay): zone frames drawn straight into
+#   the framebuffer with region-limited e-ink updates
 #
 # Copyright (c) 2026 Angus Bergman
 # Licensed under CC BY-NC 4.0
@@ -32,6 +34,7 @@ PID_FILE="/var/tmp/commute-compute/daemon.pid"
 LOG_FILE="/var/tmp/commute-compute/commute-compute.log"
 IMAGE_FILE="/var/tmp/commute-compute/dashboard.png"
 ERROR_IMAGE="/var/tmp/commute-compute/error.png"
+NATIVE_BIN="$SCRIPT_DIR/ccdisplay"
 
 # ============================================================================
 # DEFAULT CONFIGURATION (matches TRMNL v6)
@@ -44,6 +47,7 @@ CC_FULL_REFRESH_INTERVAL="${CC_FULL_REFRESH_INTERVAL:-15}"  # Full refresh every
 CC_HTTP_TIMEOUT="${CC_HTTP_TIMEOUT:-30}"
 CC_MAX_BACKOFF_ERRORS="${CC_MAX_BACKOFF_ERRORS:-5}"
 CC_WIFI_RETRY_INTERVAL="${CC_WIFI_RETRY_INTERVAL:-30}"
+CC_NATIVE="${CC_NATIVE:-1}"  # Use ccdisplay when bundled (0 = eips PNG path)
 
 # State machine states (matching TRMNL v6)
 STATE_INIT="init"
@@ -350,6 +354,52 @@ fetch_dashboard() {
     fi
 }
 
+# ============================================================================
+# NATIVE DISPLAY CLIENT (ccdisplay)
+# ============================================================================
+
+native_available() {
+    [ "$CC_NATIVE" = "1" ] && [ -x "$NATIVE_BIN" ]
+}
+
+native_url() {
+    if [ -n "$CC_WEBHOOK_URL" ]; then
+        case "$CC_WEBHOOK_URL" in
+            *\?*) echo "${CC_WEBHOOK_URL}&format=cczf&device=$(get_model)" ;;
+            *) echo "${CC_WEBHOOK_URL}?format=cczf&device=$(get_model)" ;;
+        esac
+    else
+        echo "${CC_SERVER}/api/livedash?device=$(get_model)&format=cczf&mac=$(get_mac)"
+    fi
+}
+
+# Fetch zone frames and draw them in one pass; only changed regions are
+# refreshed on the panel. Returns 0 ok, 1 error, 2 setup required,
+# 3 e-ink driver rejected the update (caller falls back to eips).
+fetch_and_display_native() {
+    local full_refresh="${1:-0}"
+    local url=$(native_url)
+    local full_opt=""
+    [ "$full_refresh" = "1" ] && full_opt="--full-screen"
+
+    log_info "Native fetch: $url"
+    local summary
+    summary=$("$NATIVE_BIN" --driver "${DEVICE_EINK_DRIVER:-mxcfb}" \
+        --timeout "$CC_HTTP_TIMEOUT" \
+        --header "X-Device-Mac: $(get_mac)" \
+        --header "X-Device-Model: $(get_model)" \
+        --header "X-Firmware-Version: $VERSION" \
+        $full_opt "$url" 2>> "$LOG_FILE")
+    local result=$?
+    log_info "ccdisplay: $summary"
+
+    if [ $result -eq 3 ]; then
+        log_warn "E-ink driver rejected native update, using eips for this session"
+        CC_NATIVE=0
+    fi
+    return $result
+}
+
 # ============================================================================
 # STATE MACHINE LOOP (matches TRMNL v6 architecture)
 # ============================================================================
@@ -405,8 +455,19 @@ run_state_machine() {
             "$STATE_FETCH")
                 log_info "→ STATE: Fetch"
                 
-                fetch_dashboard
-                local fetch_result=$?
+                local fetch_result=3
+                native_rendered=0
+                if native_available; then
+                    local next_full=0
+                    [ $((refresh_count + 1)) -ge $CC_FULL_REFRESH_INTERVAL ] && next_full=1
+                    fetch_and_display_native "$next_full"
+                    fetch_result=$?
+                    [ $fetch_result -eq 0 ] && native_rendered=1
+                fi
+                if [ $fetch_result -eq 3 ]; then
+                    fetch_dashboard
+                    fetch_result=$?
+                fi
                 
                 if [ $fetch_result -eq 0 ]; then
                     # Success
@@ -436,7 +497,9 @@ run_state_machine() {
                     refresh_count=0
                 fi
                 
-                if display_image "$IMAGE_FILE" "$do_full"; then
+                if [ "$native_rendered" = "1" ]; then
+                    log_info "✓ Display updated (native)"
+                elif display_image "$IMAGE_FILE" "$do_full"; then
                     log_info "✓ Display updated"
                 else
                     log_error "Display update failed"
@@ -554,11 +617,18 @@ run_once() {
     done
     
     if wifi_is_connected; then
-        fetch_dashboard
-        local result=$?
+        local result=3
+        if native_available; then
+            fetch_and_display_native 1
+            result=$?
+        fi
+        if [ $result -eq 3 ]; then
+            fetch_dashboard
+            result=$?
+            [ $result -eq 0 ] && display_image "$IMAGE_FILE" 1  # Full refresh
+        fi
         
         if [ $result -eq 0 ]; then
-            display_image "$IMAGE_FILE" 1  # Full refresh
             echo "Success"
         elif [ $result -eq 2 ]; then
             show_setup_required
@@ -583,6 +653,11 @@ show_status() {
     echo "Device: $(get_model)"
     echo "Resolution: $(get_resolution)"
     echo "MAC: $(get_mac)"
+    if native_available; then
+        echo "Display: native (ccdisplay, driver ${DEVICE_EINK_DRIVER:-mxcfb})"
+    else
+        echo "Display: eips"
+    fi
     
     if [ -f "$PID_FILE" ]; then
         local PID=$(cat "$PID_FILE")
@@ -626,6 +701,7 @@ show_help() {
     echo "    CC_SERVER       - Server URL"
     echo "    CC_WEBHOOK_URL  - BYOS webhook URL (from setup wizard)"
     echo "    CC_REFRESH      - Refresh interval in seconds"
+    echo "    CC_NATIVE       - 1 = native display client, 0 = eips PNG path"
 }
 
 show_configure() {
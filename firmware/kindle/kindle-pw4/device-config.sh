@@ -18,4 +18,5 @@ export DEVICE_ORIENTATION="portrait"
 export DEVICE_API_PARAM="device=kindle-pw4"
 
 # Display settings
+export DEVICE_EINK_DRIVER="rex"  # ccdisplay e-ink update ioctl layout
 export CC_FULL_REFRESH_INTERVAL=15  # Full refresh every 15 updates
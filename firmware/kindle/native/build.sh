@@ -0,0 +1,46 @@
+#!/bin/bash
+# CommuteCompute™ - Smart Transit Display for Australian Public Transport
+# Copyright © 2025-2026 Angus Bergman
+# SPDX-License-Identifier: AGPL-3.0-or-later
+# Licensed under AGPL-3.0-or-later. See LICENCE file.
+
+#
+# Build ccdisplay, the native Kindle display client
+#
+# Usage: ./build.sh [kindle|host]
+#   kindle  Cross-compile for ARM Kindles (default). Set CROSS_COMPILE to
+#           your toolchain prefix, e.g. the koxtoolchain:
+#             CROSS_COMPILE=arm-kindlepw2-linux-gnueabi- ./build.sh
+#   host    Build for this machine (testing with --fb-file)
+#
+# Output: ./ccdisplay (package-firmware.sh bundles it when present)
+#
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+TARGET="${1:-kindle}"
+
+# Kindle panels are wider than the ESP32 default row limit
+CXXFLAGS="-std=c++11 -O2 -Wall -Wextra -Wno-unused-parameter -DROW_SINK_MAX_WIDTH=2048"
+CXXFLAGS="$CXXFLAGS -I$SCRIPT_DIR -I$SCRIPT_DIR/../../include"
+
+case "$TARGET" in
+    kindle)
+        CROSS_COMPILE="${CROSS_COMPILE:-arm-kindlepw2-linux-gnueabi-}"
+        CXX="${CROSS_COMPILE}g++"
+        LDFLAGS="-static-libstdc++ -static-libgcc -s"
+        ;;
+    host)
+        CXX="${CXX:-g++}"
+        LDFLAGS=""
+        ;;
+    *)
+        echo "Usage: $0 [kindle|host]"
+        exit 1
+        ;;
+esac
+
+echo "Building ccdisplay ($TARGET) with $CXX"
+$CXX $CXXFLAGS "$SCRIPT_DIR/ccdisplay.cpp" -o "$SCRIPT_DIR/ccdisplay" $LDFLAGS
+echo "  Created: $SCRIPT_DIR/ccdisplay ($(du -h "$SCRIPT_DIR/ccdisplay" | cut -f1))"
@@ -0,0 +1,391 @@
+/**
+ * ccdisplay - native dashboard client for jailbroken Kindles
+ * Part of the Commute Compute System™
+ *
+ * Replaces the launcher's curl + `eips -g` full-PNG path:
+ *   - fetches CCZF zone frames (or a 1-bit BMP) from the server
+ *   - decodes them with the same headers as CCFirm (frame-codec.h,
+ *     bmp-stream.h, row-sink.h) while the response is still arriving
+ *   - composites into /dev/fb0, writing only pixels that changed
+ *   - sends region-limited e-ink updates for the changed rectangles only
+ *
+ * Runs once per refresh (the launcher keeps the WiFi/backoff state
+ * machine) or resident with --interval. With --fb-file it draws into a
+ * plain file instead of a framebuffer so it can be tested on a PC.
+ *
+ * Exit codes: 0 ok, 1 fetch/decode error, 2 setup required,
+ *             3 e-ink update rejected by the driver (launcher falls back)
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include "frame-codec.h"
+#include "bmp-stream.h"
+#include "kindle-fb.h"
+
+#define CCD_VERSION         "1.0.0"
+#define CCD_CHUNK           4096
+#define CCD_JSON_MAX        2048
+#define CCD_MAX_HEADERS     8
+
+enum CcdExit {
+    CCD_EXIT_OK = 0,
+    CCD_EXIT_ERROR = 1,
+    CCD_EXIT_SETUP = 2,
+    CCD_EXIT_DRIVER = 3
+};
+
+struct CcdOptions {
+    const char* url;
+    const char* input;          // File or "-" instead of fetching
+    const char* fbPath;
+    const char* fileFb;         // WxH when fbPath is a plain file
+    const char* driver;
+    const char* headers[CCD_MAX_HEADERS];
+    int headerCount;
+    int timeout;
+    int interval;               // Seconds between fetches, 0 = once
+    bool full;                  // Flash the updated area
+    bool fullScreen;            // Flash the whole panel
+    bool quiet;
+};
+
+struct CcdStats {
+    uint32_t bytes;
+    uint32_t zones;
+    uint32_t regions;
+    uint32_t changedPixels;
+    double fetchMs;             // Request start -> last byte
+    double updateMs;            // Time spent in e-ink ioctls
+};
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void onSignal(int) {
+    g_stop = 1;
+}
+
+static double nowMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// ============================================================================
+// PAYLOAD SOURCE
+// ============================================================================
+
+/**
+ * Start curl writing the response body to a pipe. Arguments go straight to
+ * execvp, so URLs and headers never pass through a shell.
+ */
+static int openFetch(const CcdOptions& opt, pid_t* child) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+
+    char connectTimeout[16], maxTime[16];
+    snprintf(connectTimeout, sizeof(connectTimeout), "%d", opt.timeout);
+    snprintf(maxTime, sizeof(maxTime), "%d", opt.timeout * 2);
+
+    const char* argv[16 + CCD_MAX_HEADERS * 2];
+    int n = 0;
+    argv[n++] = "curl";
+    argv[n++] = "-sSL";
+    argv[n++] = "--connect-timeout";
+    argv[n++] = connectTimeout;
+    argv[n++] = "--max-time";
+    argv[n++] = maxTime;
+    argv[n++] = "-H";
+    argv[n++] = "User-Agent: CommuteCompute-Kindle-Native/" CCD_VERSION;
+    argv[n++] = "-H";
+    argv[n++] = "Accept: application/octet-stream,image/bmp,application/json";
+    for (int i = 0; i < opt.headerCount; i++) {
+        argv[n++] = "-H";
+        argv[n++] = opt.headers[i];
+    }
+    argv[n++] = opt.url;
+    argv[n] = NULL;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execvp("curl", (char* const*)argv);
+        _exit(127);
+    }
+    close(fds[1]);
+    *child = pid;
+    return fds[0];
+}
+
+static bool closeFetch(int fd, pid_t child) {
+    close(fd);
+    if (child <= 0) return true;
+    int status = 0;
+    if (waitpid(child, &status, 0) < 0) return false;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "[Fetch] curl exited with %d\n", WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// DECODE + COMPOSITE
+// ============================================================================
+
+struct CcdSession {
+    const CcdOptions* opt;
+    KfbSink fbSink;
+    RowSink sink;
+    CcdStats stats;
+    bool driverFailed;
+    bool screenFlashed;         // Whole-panel flash already sent
+};
+
+static void flushRegions(CcdSession* s, bool full) {
+    bool wholeScreen = full && s->opt->fullScreen && !s->screenFlashed;
+    if (s->fbSink.regionCount == 0 && !wholeScreen) return;
+    double t0 = nowMs();
+    int n = kfbsink_flush(&s->fbSink, full, wholeScreen);
+    if (wholeScreen) s->screenFlashed = true;
+    s->stats.updateMs += nowMs() - t0;
+    if (n < 0) {
+        s->driverFailed = true;
+        return;
+    }
+    s->stats.regions += (uint32_t)n;
+}
+
+static void onFrameZone(void* ctx, const FrameZone* zone) {
+    CcdSession* s = (CcdSession*)ctx;
+    if (zone->flags & FRAME_FLAG_REFRESH) {
+        flushRegions(s, (zone->flags & FRAME_FLAG_FULL) || s->opt->full);
+    }
+}
+
+/**
+ * Interpret a JSON reply (server error or setup-required)
+ */
+static int handleJson(const char* body) {
+    if (strstr(body, "\"setup_required\"") || strstr(body, "\"configured\":false")) {
+        fprintf(stderr, "[Fetch] setup required\n");
+        return CCD_EXIT_SETUP;
+    }
+    fprintf(stderr, "[Fetch] server replied: %.200s\n", body);
+    return CCD_EXIT_ERROR;
+}
+
+static int runOnce(const CcdOptions& opt, KindleFb* fb, CcdStats* out) {
+    CcdSession s;
+    memset(&s, 0, sizeof(s));
+    s.opt = &opt;
+    s.sink = kfbsink_make(&s.fbSink, fb);
+
+    FrameDecoder frames;
+    frame_decoder_init(&frames, &s.sink, fb->width, fb->height);
+    frames.onZone = onFrameZone;
+    frames.onZoneCtx = &s;
+
+    static BmpStream bmp;
+    bmp_stream_init(&bmp, &s.sink, 0, 0);
+
+    pid_t child = 0;
+    int fd;
+    if (opt.input) {
+        fd = strcmp(opt.input, "-") == 0 ? dup(STDIN_FILENO) : open(opt.input, O_RDONLY);
+    } else {
+        fd = openFetch(opt, &child);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "[Fetch] cannot open source: %s\n", strerror(errno));
+        return CCD_EXIT_ERROR;
+    }
+
+    enum { KIND_UNKNOWN, KIND_CCZF, KIND_BMP, KIND_JSON } kind = KIND_UNKNOWN;
+    static uint8_t chunk[CCD_CHUNK];
+    char json[CCD_JSON_MAX + 1];
+    size_t jsonLen = 0;
+    int result = CCD_EXIT_OK;
+    bool decodeError = false;
+    bool bmpDone = false;
+    double t0 = nowMs();
+
+    for (;;) {
+        ssize_t got = read(fd, chunk, sizeof(chunk));
+        if (got < 0) {
+            if (errno == EINTR && !g_stop) continue;
+            decodeError = true;
+            break;
+        }
+        if (got == 0) break;
+        s.stats.bytes += (uint32_t)got;
+
+        if (kind == KIND_UNKNOWN) {
+            if (chunk[0] == 'C') kind = KIND_CCZF;
+            else if (chunk[0] == 'B') kind = KIND_BMP;
+            else kind = KIND_JSON;
+        }
+
+        if (kind == KIND_CCZF) {
+            if (frame_decoder_feed(&frames, chunk, (size_t)got) != FRAME_OK) {
+                fprintf(stderr, "[Decode] frame error %d after %u bytes\n", frames.error, s.stats.bytes);
+                decodeError = true;
+                break;
+            }
+        } else if (kind == KIND_BMP) {
+            if (bmpDone) continue;
+            int r = bmp_stream_feed(&bmp, chunk, (size_t)got);
+            if (r < 0) {
+                fprintf(stderr, "[Decode] BMP error %d\n", r);
+                decodeError = true;
+                break;
+            }
+            if (r == BMP_STREAM_DONE) {
+                bmpDone = true;
+                flushRegions(&s, opt.full);
+            }
+        } else {
+            size_t take = (size_t)got;
+            if (take > CCD_JSON_MAX - jsonLen) take = CCD_JSON_MAX - jsonLen;
+            memcpy(json + jsonLen, chunk, take);
+            jsonLen += take;
+        }
+        if (s.driverFailed || g_stop) break;
+    }
+
+    bool fetched = closeFetch(fd, child);
+    s.stats.fetchMs = nowMs() - t0;
+
+    if (kind == KIND_JSON) {
+        json[jsonLen] = '\0';
+        result = handleJson(json);
+    } else if (!fetched || decodeError || kind == KIND_UNKNOWN) {
+        result = CCD_EXIT_ERROR;
+    } else if (kind == KIND_CCZF && frames.headerLen != 0) {
+        fprintf(stderr, "[Decode] truncated zone frame\n");
+        frame_decoder_reset(&frames);   // Closes the partial zone's region
+        result = CCD_EXIT_ERROR;
+    } else if (kind == KIND_BMP && !bmpDone) {
+        fprintf(stderr, "[Decode] truncated BMP\n");
+        if (bmp.state == 2) s.sink.end(s.sink.ctx, false);
+        result = CCD_EXIT_ERROR;
+    }
+
+    // Zones that arrived before a failure are already in the framebuffer -
+    // show them rather than leave the panel out of sync with its memory
+    if (!s.driverFailed) flushRegions(&s, opt.full);
+    kfb_wait(fb);
+
+    if (s.driverFailed) result = CCD_EXIT_DRIVER;
+    s.stats.zones = kind == KIND_CCZF ? frames.zonesDone : s.fbSink.zones;
+    s.stats.changedPixels = s.fbSink.changedPixels;
+    *out = s.stats;
+    return result;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "ccdisplay v" CCD_VERSION " - Commute Compute native Kindle display\n"
+        "\n"
+        "Usage: %s [options] <url>\n"
+        "       %s [options] --input <file|->\n"
+        "\n"
+        "Options:\n"
+        "  --fb PATH          Framebuffer device (default /dev/fb0)\n"
+        "  --fb-file WxH      Treat --fb as a plain 8bpp file of this size\n"
+        "  --driver NAME      E-ink ioctl layout: mxcfb, rex, mtk, none (default mxcfb)\n"
+        "  --header 'K: V'    Extra request header (repeatable)\n"
+        "  --timeout SEC      Connect timeout (default 30)\n"
+        "  --interval SEC     Keep running, fetching every SEC seconds\n"
+        "  --full             Flash the updated area (GC16 full update)\n"
+        "  --full-screen      With --full, flash the whole panel\n"
+        "  --quiet            No summary line\n",
+        argv0, argv0);
+}
+
+static bool parseArgs(int argc, char** argv, CcdOptions* opt) {
+    memset(opt, 0, sizeof(*opt));
+    opt->fbPath = "/dev/fb0";
+    opt->timeout = 30;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(a, "--fb") == 0 && hasValue) opt->fbPath = argv[++i];
+        else if (strcmp(a, "--fb-file") == 0 && hasValue) opt->fileFb = argv[++i];
+        else if (strcmp(a, "--driver") == 0 && hasValue) opt->driver = argv[++i];
+        else if (strcmp(a, "--input") == 0 && hasValue) opt->input = argv[++i];
+        else if (strcmp(a, "--timeout") == 0 && hasValue) opt->timeout = atoi(argv[++i]);
+        else if (strcmp(a, "--interval") == 0 && hasValue) opt->interval = atoi(argv[++i]);
+        else if (strcmp(a, "--header") == 0 && hasValue) {
+            if (opt->headerCount == CCD_MAX_HEADERS) return false;
+            opt->headers[opt->headerCount++] = argv[++i];
+        }
+        else if (strcmp(a, "--full") == 0) opt->full = true;
+        else if (strcmp(a, "--full-screen") == 0) opt->full = opt->fullScreen = true;
+        else if (strcmp(a, "--quiet") == 0) opt->quiet = true;
+        else if (a[0] != '-' && !opt->url) opt->url = a;
+        else return false;
+    }
+    if (opt->timeout <= 0) opt->timeout = 30;
+    return opt->url || opt->input;
+}
+
+int main(int argc, char** argv) {
+    CcdOptions opt;
+    if (!parseArgs(argc, argv, &opt)) {
+        usage(argv[0]);
+        return CCD_EXIT_ERROR;
+    }
+
+    int fileW = 0, fileH = 0;
+    if (opt.fileFb && sscanf(opt.fileFb, "%dx%d", &fileW, &fileH) != 2) {
+        fprintf(stderr, "[FB] bad --fb-file size '%s'\n", opt.fileFb);
+        return CCD_EXIT_ERROR;
+    }
+
+    KindleFb fb;
+    if (!kfb_open(&fb, opt.fbPath, kfb_parse_driver(opt.driver), fileW, fileH)) return CCD_EXIT_ERROR;
+
+    signal(SIGTERM, onSignal);
+    signal(SIGINT, onSignal);
+
+    int result;
+    do {
+        CcdStats stats;
+        memset(&stats, 0, sizeof(stats));
+        result = runOnce(opt, &fb, &stats);
+        if (!opt.quiet) {
+            printf("result=%d bytes=%u zones=%u regions=%u changed_px=%u fetch_ms=%.0f update_ms=%.0f\n",
+                   result, stats.bytes, stats.zones, stats.regions, stats.changedPixels,
+                   stats.fetchMs, stats.updateMs);
+            fflush(stdout);
+        }
+        if (result == CCD_EXIT_DRIVER) break;
+        for (int i = 0; i < opt.interval && !g_stop; i++) sleep(1);
+    } while (opt.interval > 0 && !g_stop);
+
+    kfb_close(&fb);
+    return result;
+}
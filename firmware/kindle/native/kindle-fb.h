@@ -0,0 +1,412 @@
+/**
+ * Kindle framebuffer + e-ink update layer for ccdisplay
+ * Part of the Commute Compute System™
+ *
+ * Maps /dev/fb0 (or a plain file standing in for it, for host tests),
+ * composites 1-bit rows from the shared firmware decoders into it and
+ * tracks which rectangles actually changed, so only those regions are
+ * sent to the EPDC instead of flashing the whole panel like `eips -g`.
+ *
+ * E-ink update ioctls differ between Kindle generations; the struct
+ * layouts below follow the Lab126 mxcfb headers:
+ *   mxcfb  - i.MX6 EPDC (PW3, Kindle 7/8)
+ *   rex    - i.MX7D EPDC with dither/quant fields (PW4, Basic 10)
+ *   mtk    - MediaTek hwtcon (PW5, Kindle 11), same ioctl number/layout as rex
+ *   none   - no ioctl, updates are only logged (file-backed framebuffers)
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef KINDLE_FB_H
+#define KINDLE_FB_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/fb.h>
+
+#include "row-sink.h"
+
+#define KFB_MAX_REGIONS       16
+
+// Waveforms shared by every Kindle EPDC driver
+#define KFB_WAVEFORM_DU       1      // Fast 1-bit, no flash (partial updates)
+#define KFB_WAVEFORM_GC16     2      // Full greyscale clear (full refresh)
+#define KFB_UPDATE_PARTIAL    0
+#define KFB_UPDATE_FULL       1
+#define KFB_TEMP_AMBIENT      0x1000
+
+enum KfbDriver {
+    KFB_DRIVER_NONE = 0,
+    KFB_DRIVER_MXCFB,
+    KFB_DRIVER_REX,
+    KFB_DRIVER_MTK
+};
+
+// ============================================================================
+// MXCFB IOCTL LAYOUTS
+// ============================================================================
+
+struct kfb_mxcfb_rect {
+    uint32_t top;
+    uint32_t left;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct kfb_mxcfb_alt_buffer {
+    uint32_t phys_addr;
+    uint32_t width;
+    uint32_t height;
+    kfb_mxcfb_rect alt_update_region;
+};
+
+struct kfb_update_mxcfb {
+    kfb_mxcfb_rect update_region;
+    uint32_t waveform_mode;
+    uint32_t update_mode;
+    uint32_t update_marker;
+    uint32_t hist_bw_waveform_mode;
+    uint32_t hist_gray_waveform_mode;
+    int32_t temp;
+    uint32_t flags;
+    kfb_mxcfb_alt_buffer alt_buffer_data;
+};
+
+struct kfb_update_rex {
+    kfb_mxcfb_rect update_region;
+    uint32_t waveform_mode;
+    uint32_t update_mode;
+    uint32_t update_marker;
+    int32_t temp;
+    uint32_t flags;
+    int32_t dither_mode;
+    int32_t quant_bit;
+    kfb_mxcfb_alt_buffer alt_buffer_data;
+    uint32_t hist_bw_waveform_mode;
+    uint32_t hist_gray_waveform_mode;
+    uint32_t ts_pxp;
+    uint32_t ts_epdc;
+};
+
+struct kfb_update_marker {
+    uint32_t update_marker;
+    uint32_t collision_test;
+};
+
+#define KFB_IOCTL_SEND_UPDATE_MXCFB   _IOW('F', 0x2E, kfb_update_mxcfb)
+#define KFB_IOCTL_SEND_UPDATE_REX     _IOW('F', 0x2E, kfb_update_rex)
+#define KFB_IOCTL_WAIT_UPDATE         _IOWR('F', 0x2F, kfb_update_marker)
+
+// ============================================================================
+// FRAMEBUFFER
+// ============================================================================
+
+struct KindleFb {
+    int fd;
+    uint8_t* map;
+    size_t mapSize;
+    uint8_t* base;          // First visible pixel (after yoffset)
+    int width, height;
+    int bpp;                // 8 or 32
+    int stride;             // Bytes per row
+    bool inverted;          // 0 = white (GRAYSCALE_8BIT_INVERTED)
+    KfbDriver driver;
+    uint32_t marker;
+};
+
+static inline KfbDriver kfb_parse_driver(const char* name) {
+    if (!name) return KFB_DRIVER_MXCFB;
+    if (strcmp(name, "none") == 0) return KFB_DRIVER_NONE;
+    if (strcmp(name, "rex") == 0) return KFB_DRIVER_REX;
+    if (strcmp(name, "mtk") == 0) return KFB_DRIVER_MTK;
+    return KFB_DRIVER_MXCFB;
+}
+
+/**
+ * Open a framebuffer. With fileW/fileH > 0 the path is a regular file used
+ * as an 8bpp framebuffer of that size (created/extended, white-filled when
+ * new) and no ioctls are issued. Returns false with errno-style logging.
+ */
+static inline bool kfb_open(KindleFb* fb, const char* path, KfbDriver driver, int fileW, int fileH) {
+    memset(fb, 0, sizeof(*fb));
+    fb->fd = -1;
+    fb->driver = driver;
+
+    if (fileW > 0 && fileH > 0) {
+        fb->fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fb->fd < 0) {
+            fprintf(stderr, "[FB] open %s: %s\n", path, strerror(errno));
+            return false;
+        }
+        fb->width = fileW;
+        fb->height = fileH;
+        fb->bpp = 8;
+        fb->stride = fileW;
+        fb->mapSize = (size_t)fileW * fileH;
+
+        struct stat st;
+        bool fresh = fstat(fb->fd, &st) == 0 && (size_t)st.st_size < fb->mapSize;
+        if (fresh && ftruncate(fb->fd, (off_t)fb->mapSize) != 0) {
+            fprintf(stderr, "[FB] resize %s: %s\n", path, strerror(errno));
+            close(fb->fd);
+            return false;
+        }
+        fb->map = (uint8_t*)mmap(NULL, fb->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fb->fd, 0);
+        if (fb->map == MAP_FAILED) {
+            fprintf(stderr, "[FB] mmap %s: %s\n", path, strerror(errno));
+            close(fb->fd);
+            return false;
+        }
+        if (fresh) memset(fb->map, 0xFF, fb->mapSize);
+        fb->base = fb->map;
+        fb->driver = KFB_DRIVER_NONE;
+        return true;
+    }
+
+    fb->fd = open(path, O_RDWR);
+    if (fb->fd < 0) {
+        fprintf(stderr, "[FB] open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct fb_var_screeninfo var;
+    struct fb_fix_screeninfo fix;
+    if (ioctl(fb->fd, FBIOGET_VSCREENINFO, &var) != 0 || ioctl(fb->fd, FBIOGET_FSCREENINFO, &fix) != 0) {
+        fprintf(stderr, "[FB] screeninfo: %s\n", strerror(errno));
+        close(fb->fd);
+        return false;
+    }
+    if (var.bits_per_pixel != 8 && var.bits_per_pixel != 32) {
+        fprintf(stderr, "[FB] unsupported depth %u bpp\n", var.bits_per_pixel);
+        close(fb->fd);
+        return false;
+    }
+
+    fb->width = (int)var.xres;
+    fb->height = (int)var.yres;
+    fb->bpp = (int)var.bits_per_pixel;
+    fb->stride = (int)fix.line_length;
+    fb->inverted = var.grayscale == 2;   // GRAYSCALE_8BIT_INVERTED
+    fb->mapSize = fix.smem_len;
+    fb->map = (uint8_t*)mmap(NULL, fb->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fb->fd, 0);
+    if (fb->map == MAP_FAILED) {
+        fprintf(stderr, "[FB] mmap: %s\n", strerror(errno));
+        close(fb->fd);
+        return false;
+    }
+    fb->base = fb->map + (size_t)var.yoffset * fb->stride + (size_t)var.xoffset * (fb->bpp / 8);
+    return true;
+}
+
+static inline void kfb_close(KindleFb* fb) {
+    if (fb->map && fb->map != MAP_FAILED) munmap(fb->map, fb->mapSize);
+    if (fb->fd >= 0) close(fb->fd);
+    fb->map = NULL;
+    fb->fd = -1;
+}
+
+/**
+ * Send one region to the EPDC. Returns true if the driver accepted it
+ * (always true for KFB_DRIVER_NONE).
+ */
+static inline bool kfb_update(KindleFb* fb, int x, int y, int w, int h, bool full) {
+    if (fb->driver == KFB_DRIVER_NONE) return true;
+
+    uint32_t waveform = full ? KFB_WAVEFORM_GC16 : KFB_WAVEFORM_DU;
+    uint32_t mode = full ? KFB_UPDATE_FULL : KFB_UPDATE_PARTIAL;
+    fb->marker++;
+    int rc;
+
+    if (fb->driver == KFB_DRIVER_MXCFB) {
+        kfb_update_mxcfb u;
+        memset(&u, 0, sizeof(u));
+        u.update_region.top = (uint32_t)y;
+        u.update_region.left = (uint32_t)x;
+        u.update_region.width = (uint32_t)w;
+        u.update_region.height = (uint32_t)h;
+        u.waveform_mode = waveform;
+        u.update_mode = mode;
+        u.update_marker = fb->marker;
+        u.hist_bw_waveform_mode = KFB_WAVEFORM_DU;
+        u.hist_gray_waveform_mode = KFB_WAVEFORM_GC16;
+        u.temp = KFB_TEMP_AMBIENT;
+        rc = ioctl(fb->fd, KFB_IOCTL_SEND_UPDATE_MXCFB, &u);
+    } else {
+        kfb_update_rex u;
+        memset(&u, 0, sizeof(u));
+        u.update_region.top = (uint32_t)y;
+        u.update_region.left = (uint32_t)x;
+        u.update_region.width = (uint32_t)w;
+        u.update_region.height = (uint32_t)h;
+        u.waveform_mode = waveform;
+        u.update_mode = mode;
+        u.update_marker = fb->marker;
+        u.temp = KFB_TEMP_AMBIENT;
+        u.hist_bw_waveform_mode = KFB_WAVEFORM_DU;
+        u.hist_gray_waveform_mode = KFB_WAVEFORM_GC16;
+        rc = ioctl(fb->fd, KFB_IOCTL_SEND_UPDATE_REX, &u);
+    }
+
+    if (rc != 0) {
+        fprintf(stderr, "[FB] send update %dx%d+%d+%d: %s\n", w, h, x, y, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Block until the last submitted update has been drawn (best effort)
+ */
+static inline void kfb_wait(KindleFb* fb) {
+    if (fb->driver == KFB_DRIVER_NONE || fb->marker == 0) return;
+    kfb_update_marker m = { fb->marker, 0 };
+    ioctl(fb->fd, KFB_IOCTL_WAIT_UPDATE, &m);
+}
+
+// ============================================================================
+// COMPOSITING SINK
+// ============================================================================
+
+struct KfbRect {
+    int x, y, w, h;
+};
+
+/**
+ * RowSink that expands 1-bit rows into the framebuffer, only touching
+ * pixels that differ, and records the changed bounding box of each
+ * image/zone as a pending region.
+ */
+struct KfbSink {
+    KindleFb* fb;
+    int x, y, w, h;
+    int dirtyX0, dirtyY0, dirtyX1, dirtyY1;   // Inclusive, -1 = clean
+    KfbRect regions[KFB_MAX_REGIONS];
+    int regionCount;
+    uint32_t zones;
+    uint32_t changedPixels;
+};
+
+static inline void kfbsink_add_region(KfbSink* s, int x0, int y0, int x1, int y1) {
+    if (s->regionCount < KFB_MAX_REGIONS) {
+        KfbRect r = { x0, y0, x1 - x0 + 1, y1 - y0 + 1 };
+        s->regions[s->regionCount++] = r;
+        return;
+    }
+    // Out of slots - grow the last region to cover this one too
+    KfbRect& r = s->regions[KFB_MAX_REGIONS - 1];
+    int rx1 = r.x + r.w - 1, ry1 = r.y + r.h - 1;
+    if (x0 < r.x) r.x = x0;
+    if (y0 < r.y) r.y = y0;
+    if (x1 > rx1) rx1 = x1;
+    if (y1 > ry1) ry1 = y1;
+    r.w = rx1 - r.x + 1;
+    r.h = ry1 - r.y + 1;
+}
+
+static inline bool kfbsink_begin(void* ctx, int x, int y, int w, int h) {
+    KfbSink* s = (KfbSink*)ctx;
+    if (x < 0 || y < 0 || w <= 0 || h <= 0) return false;
+    if (x + w > s->fb->width || y + h > s->fb->height) return false;
+    s->x = x; s->y = y; s->w = w; s->h = h;
+    s->dirtyX0 = s->dirtyY0 = s->dirtyX1 = s->dirtyY1 = -1;
+    return true;
+}
+
+static inline bool kfbsink_row(void* ctx, int y, const uint8_t* bits, int w) {
+    KfbSink* s = (KfbSink*)ctx;
+    if (y < s->y || y >= s->y + s->h || w != s->w) return false;
+
+    KindleFb* fb = s->fb;
+    uint8_t white = fb->inverted ? 0x00 : 0xFF;
+    uint8_t black = (uint8_t)~white;
+    uint8_t* line = fb->base + (size_t)y * fb->stride;
+    int first = -1, last = -1;
+
+    for (int i = 0; i < w; i++) {
+        uint8_t v = ((bits[i >> 3] >> (7 - (i & 7))) & 1) ? white : black;
+        int px = s->x + i;
+        if (fb->bpp == 8) {
+            if (line[px] == v) continue;
+            line[px] = v;
+        } else {
+            uint8_t* p = line + (size_t)px * 4;
+            if (p[0] == v && p[1] == v && p[2] == v) continue;
+            p[0] = p[1] = p[2] = v;
+            p[3] = 0xFF;
+        }
+        if (first < 0) first = px;
+        last = px;
+        s->changedPixels++;
+    }
+
+    if (first >= 0) {
+        if (s->dirtyX0 < 0 || first < s->dirtyX0) s->dirtyX0 = first;
+        if (last > s->dirtyX1) s->dirtyX1 = last;
+        if (s->dirtyY0 < 0 || y < s->dirtyY0) s->dirtyY0 = y;
+        if (y > s->dirtyY1) s->dirtyY1 = y;
+    }
+    return true;
+}
+
+static inline void kfbsink_end(void* ctx, bool ok) {
+    KfbSink* s = (KfbSink*)ctx;
+    // Pixels already written stay written even if the zone aborted,
+    // so a partial zone is still flushed to the panel
+    if (s->dirtyX0 >= 0) kfbsink_add_region(s, s->dirtyX0, s->dirtyY0, s->dirtyX1, s->dirtyY1);
+    s->dirtyX0 = -1;
+    if (ok) s->zones++;
+}
+
+static inline RowSink kfbsink_make(KfbSink* s, KindleFb* fb) {
+    memset(s, 0, sizeof(*s));
+    s->fb = fb;
+    s->dirtyX0 = -1;
+    RowSink sink = { s, kfbsink_begin, kfbsink_row, kfbsink_end };
+    return sink;
+}
+
+/**
+ * Push every pending region to the panel. A full refresh flashes the
+ * union of the regions (or the whole screen with wholeScreen).
+ * Returns the number of regions sent, or -1 if the driver refused them.
+ */
+static inline int kfbsink_flush(KfbSink* s, bool full, bool wholeScreen) {
+    KindleFb* fb = s->fb;
+    int sent = 0;
+
+    if (full) {
+        if (!wholeScreen && s->regionCount == 0) return 0;
+        int x0 = 0, y0 = 0, x1 = fb->width - 1, y1 = fb->height - 1;
+        if (!wholeScreen) {
+            x0 = s->regions[0].x; y0 = s->regions[0].y;
+            x1 = x0 + s->regions[0].w - 1; y1 = y0 + s->regions[0].h - 1;
+            for (int i = 1; i < s->regionCount; i++) {
+                const KfbRect& r = s->regions[i];
+                if (r.x < x0) x0 = r.x;
+                if (r.y < y0) y0 = r.y;
+                if (r.x + r.w - 1 > x1) x1 = r.x + r.w - 1;
+                if (r.y + r.h - 1 > y1) y1 = r.y + r.h - 1;
+            }
+        }
+        if (!kfb_update(fb, x0, y0, x1 - x0 + 1, y1 - y0 + 1, true)) return -1;
+        sent = 1;
+    } else {
+        for (int i = 0; i < s->regionCount; i++) {
+            const KfbRect& r = s->regions[i];
+            if (!kfb_update(fb, r.x, r.y, r.w, r.h, false)) return -1;
+            sent++;
+        }
+    }
+    s->regionCount = 0;
+    return sent;
+}
+
+#endif // KINDLE_FB_H
@@ -42,6 +42,14 @@ package_device() {
     # Copy device-specific config
     cp "$device_dir/device-config.sh" "$pkg_dir/"
     
+    # Native display client (build with native/build.sh); without it the
+    # launcher uses the eips PNG path
+    if [ -x "$SCRIPT_DIR/native/ccdisplay" ]; then
+        cp "$SCRIPT_DIR/native/ccdisplay" "$pkg_dir/"
+    else
+        echo "  Note: native/ccdisplay not built - package will use eips"
+    fi
+    
     # Ensure scripts are executable
     chmod +x "$pkg_dir/"*.sh
     
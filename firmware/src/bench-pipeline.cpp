@@ -0,0 +1,279 @@
+/**
+ * CCFirm™ — Fetch Pipeline Benchmark (host, env:native-bench)
+ * Part of the Commute Compute System™
+ *
+ * Runs the shared fetch path (chunk-pipe.h -> bmp-stream.h -> row-sink.h
+ * -> frame-cache.h) on the host, once single-core (read, decrypt, decode
+ * in turn - the ESP32-C3 build) and once pipelined across two threads
+ * (network/TLS stage + decode stage - the ESP32-S3 CC_DUAL_CORE build).
+ *
+ * Decode runs for real on a synthetic 800x480 dashboard BMP. Link time,
+ * TLS cost and device-side decode cost are simulated per KB so the
+ * overlap can be measured for the target's numbers; override them with
+ * --wire-us-kb, --tls-us-kb and --decode-us-kb (defaults approximate a
+ * ~100 KB/s link and an S3 at 240 MHz).
+ *
+ * Prints one JSON report to stdout. --trace <file> also writes the
+ * execution trace of the last runs (trace-ring.h, built with CC_TRACE) for
+ * tools/trace_export.py: wire, TLS and decode spans per thread.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "row-sink.h"
+#include "bmp-stream.h"
+#include "chunk-pipe.h"
+#include "frame-cache.h"
+
+#define TRACE_EVENTS      4096    // The last few serial + pipelined runs
+#include "trace-ring.h"
+
+#define BENCH_W           800
+#define BENCH_H           480
+#define BENCH_SLOT_BYTES  50000
+#define BENCH_CHUNK       4096
+#define BENCH_SLOTS       8
+
+typedef std::chrono::steady_clock Clock;
+
+struct BenchConfig {
+    int iterations = 20;
+    double wireUsPerKb = 10000;   // ~100 KB/s effective WiFi + server
+    double tlsUsPerKb = 300;      // AES-GCM record decrypt (CPU)
+    double decodeUsPerKb = 200;   // Row decode + PSRAM blit (CPU)
+};
+
+static double usSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+static void spinUs(double us) {
+    Clock::time_point end = Clock::now() + std::chrono::nanoseconds((long long)(us * 1000));
+    while (Clock::now() < end) {}
+}
+
+static void waitUs(double us) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds((long long)(us * 1000)));
+}
+
+/**
+ * Synthetic dashboard: bottom-up 1-bit BMP with text-like stripes
+ */
+static std::vector<uint8_t> makeDashboardBmp(uint32_t seed) {
+    FrameBuffer fb;
+    std::vector<uint8_t> out(BENCH_SLOT_BYTES);
+    bmp_shadow_init(out.data(), out.size(), BENCH_W, BENCH_H, &fb);
+    for (int y = 0; y < BENCH_H; y++) {
+        for (int x = 0; x < fb.stride; x++) {
+            bool ink = ((y / 12) % 3 == 0) && ((x * 7 + y + seed) % 5 < 2);
+            fb.pixels[y * fb.stride + x] = ink ? (uint8_t)(0x5A ^ (x + seed)) : 0xFF;
+        }
+    }
+    out.resize(BMP_SHADOW_HEADER + (size_t)fb.stride * BENCH_H);
+    return out;
+}
+
+struct RunResult {
+    double totalUs;
+    double decodeUs;              // Real host decode time
+    int cacheResult;
+};
+
+static int decodeChunk(BmpStream* s, const uint8_t* data, size_t len, const BenchConfig& cfg, double* decodeUs) {
+    CCTRACE_SCOPE(TRACE_TASK_LOOP, "decode");
+    Clock::time_point t0 = Clock::now();
+    int r = bmp_stream_feed(s, data, len);
+    *decodeUs += usSince(t0);
+    spinUs(cfg.decodeUsPerKb * len / 1024.0);
+    return r;
+}
+
+/**
+ * ESP32-C3 path: one core reads, decrypts and decodes each chunk in turn
+ */
+static RunResult runSerial(const std::vector<uint8_t>& bmp, FrameCache* cache, const BenchConfig& cfg) {
+    CCTRACE_SCOPE(TRACE_TASK_LOOP, "single-core fetch");
+    RunResult rr = {0, 0, 0};
+    Clock::time_point t0 = Clock::now();
+
+    FrameBuffer* back = framecache_begin(cache, false);
+    FrameBufferSink state;
+    RowSink sink = fbsink_make(&state, back);
+    BmpStream s;
+    bmp_stream_init(&s, &sink, 0, 0);
+
+    for (size_t off = 0; off < bmp.size(); off += BENCH_CHUNK) {
+        size_t n = std::min((size_t)BENCH_CHUNK, bmp.size() - off);
+        CCTRACE_BEGIN(TRACE_TASK_LOOP, "wire");
+        waitUs(cfg.wireUsPerKb * n / 1024.0);
+        CCTRACE_END(TRACE_TASK_LOOP, "wire");
+        CCTRACE_BEGIN(TRACE_TASK_LOOP, "tls");
+        spinUs(cfg.tlsUsPerKb * n / 1024.0);
+        CCTRACE_END(TRACE_TASK_LOOP, "tls");
+        decodeChunk(&s, bmp.data() + off, n, cfg, &rr.decodeUs);
+    }
+    rr.cacheResult = s.state == 3 ? framecache_commit(cache) : FRAMECACHE_ERR;
+    rr.totalUs = usSince(t0);
+    return rr;
+}
+
+/**
+ * ESP32-S3 path: network/TLS thread feeds the chunk pipe, this thread decodes
+ */
+static RunResult runPipelined(const std::vector<uint8_t>& bmp, FrameCache* cache, ChunkPipe* pipe,
+                              const BenchConfig& cfg) {
+    CCTRACE_SCOPE(TRACE_TASK_LOOP, "dual-core fetch");
+    RunResult rr = {0, 0, 0};
+    Clock::time_point t0 = Clock::now();
+    chunkpipe_reset(pipe);
+
+    std::thread net([&]() {
+        bool stalled = false;
+        for (size_t off = 0; off < bmp.size(); ) {
+            ChunkSlot* slot = chunkpipe_acquire(pipe);
+            if (!slot) {
+                if (!stalled) CCTRACE_INSTANT(TRACE_TASK_NET, "pipe full", 0);
+                stalled = true;
+                std::this_thread::yield();
+                continue;
+            }
+            stalled = false;
+            size_t n = std::min((size_t)BENCH_CHUNK, bmp.size() - off);
+            CCTRACE_BEGIN(TRACE_TASK_NET, "wire");
+            waitUs(cfg.wireUsPerKb * n / 1024.0);
+            CCTRACE_END(TRACE_TASK_NET, "wire");
+            CCTRACE_BEGIN(TRACE_TASK_NET, "tls");
+            spinUs(cfg.tlsUsPerKb * n / 1024.0);
+            CCTRACE_END(TRACE_TASK_NET, "tls");
+            memcpy(slot->data, bmp.data() + off, n);
+            slot->len = (uint32_t)n;
+            off += n;
+            chunkpipe_commit(pipe);
+            CCTRACE_INSTANT(TRACE_TASK_NET, "chunk", n);
+        }
+        ChunkSlot* slot;
+        while (!(slot = chunkpipe_acquire(pipe))) std::this_thread::yield();
+        slot->flags = CHUNK_FLAG_END;
+        chunkpipe_commit(pipe);
+    });
+
+    FrameBuffer* back = framecache_begin(cache, false);
+    FrameBufferSink state;
+    RowSink sink = fbsink_make(&state, back);
+    BmpStream s;
+    bmp_stream_init(&s, &sink, 0, 0);
+
+    for (;;) {
+        const ChunkSlot* c = chunkpipe_peek(pipe);
+        if (!c) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (c->len) decodeChunk(&s, c->data, c->len, cfg, &rr.decodeUs);
+        bool end = c->flags & CHUNK_FLAG_END;
+        chunkpipe_release(pipe);
+        if (end) break;
+    }
+    net.join();
+
+    rr.cacheResult = s.state == 3 ? framecache_commit(cache) : FRAMECACHE_ERR;
+    rr.totalUs = usSince(t0);
+    return rr;
+}
+
+static double percentile(std::vector<double> v, double p) {
+    std::sort(v.begin(), v.end());
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    return v[i];
+}
+
+static void fileOut(const char* text, size_t len, void* ctx) {
+    fwrite(text, 1, len, (FILE*)ctx);
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    const char* tracePath = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--iterations") == 0) cfg.iterations = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--wire-us-kb") == 0) cfg.wireUsPerKb = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--tls-us-kb") == 0) cfg.tlsUsPerKb = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--decode-us-kb") == 0) cfg.decodeUsPerKb = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
+    }
+    if (cfg.iterations < 1) cfg.iterations = 1;
+
+    static uint8_t cacheMem[4 * BENCH_SLOT_BYTES];
+    static uint8_t pipeMem[BENCH_SLOTS * BENCH_CHUNK];
+    FrameCache cache;
+    ChunkPipe pipe;
+    if (!framecache_init(&cache, cacheMem, 4, BENCH_SLOT_BYTES, BENCH_W, BENCH_H) ||
+        !chunkpipe_init(&pipe, pipeMem, BENCH_SLOTS, BENCH_CHUNK)) {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+
+    // Two alternating frames so the cache sees new, unchanged and hit results
+    std::vector<uint8_t> frames[2] = { makeDashboardBmp(1), makeDashboardBmp(2) };
+    std::vector<double> serialMs, pipedMs;
+    double hostDecodeUs = 0;
+    size_t hostDecodeBytes = 0;
+    int errors = 0;
+
+    for (int i = 0; i < cfg.iterations; i++) {
+        const std::vector<uint8_t>& f = frames[(i / 2) % 2];
+        RunResult a = runSerial(f, &cache, cfg);
+        RunResult b = runPipelined(f, &cache, &pipe, cfg);
+        if (a.cacheResult < 0 || b.cacheResult < 0) errors++;
+        serialMs.push_back(a.totalUs / 1000.0);
+        pipedMs.push_back(b.totalUs / 1000.0);
+        hostDecodeUs += a.decodeUs + b.decodeUs;
+        hostDecodeBytes += 2 * f.size();
+    }
+
+    // Hash cost per commit (runs on every fetch on the device)
+    Clock::time_point t0 = Clock::now();
+    uint32_t sink = 0;
+    for (int i = 0; i < 100; i++) sink ^= framecache_hash(&cache.slots[i % 4].fb);
+    double hashUs = usSince(t0) / 100;
+
+    if (tracePath) {
+        FILE* f = fopen(tracePath, "w");
+        if (!f) {
+            fprintf(stderr, "cannot write %s\n", tracePath);
+            return 1;
+        }
+        trace_dump(fileOut, f);
+        fclose(f);
+    }
+
+    double serialP50 = percentile(serialMs, 0.5);
+    double pipedP50 = percentile(pipedMs, 0.5);
+    printf("{\n");
+    printf("  \"frame_bytes\": %u,\n", (unsigned)frames[0].size());
+    printf("  \"iterations\": %d,\n", cfg.iterations);
+    printf("  \"model_us_per_kb\": { \"wire\": %.0f, \"tls\": %.0f, \"decode\": %.0f },\n",
+           cfg.wireUsPerKb, cfg.tlsUsPerKb, cfg.decodeUsPerKb);
+    printf("  \"single_core_ms\": { \"p50\": %.1f, \"p99\": %.1f },\n", serialP50, percentile(serialMs, 0.99));
+    printf("  \"dual_core_ms\": { \"p50\": %.1f, \"p99\": %.1f },\n", pipedP50, percentile(pipedMs, 0.99));
+    printf("  \"speedup\": %.2f,\n", serialP50 / pipedP50);
+    printf("  \"host_decode_MBps\": %.1f,\n", hostDecodeBytes / hostDecodeUs);
+    printf("  \"frame_hash_us\": %.1f,\n", hashUs);
+    printf("  \"cache\": { \"new\": %u, \"hit\": %u, \"unchanged\": %u },\n",
+           cache.misses, cache.hits, cache.unchanged);
+    printf("  \"pipe\": { \"producer_stalls\": %u, \"max_depth\": %u },\n", pipe.producerStalls, pipe.maxDepth);
+    printf("  \"errors\": %d,\n", errors);
+    printf("  \"checksum\": %u\n", sink);
+    printf("}\n");
+    return errors ? 1 : 0;
+}
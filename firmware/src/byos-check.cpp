@@ -0,0 +1,89 @@
+/**
+ * CCFirm™ — BYOS Client Host Check (host, env:native-byos)
+ * Part of the Commute Compute System™
+ *
+ * Runs the protocol state of the TRMNL BYOS client (byos-client.h) on
+ * replies and timings from tests/test-byos-client.js:
+ *
+ *   program --display '<json>' [--drawn '<json>']
+ *     byos_parse_display(), and whether byos_image_changed() would fetch
+ *     the image again after the --drawn reply's image was drawn
+ *   program --sleep <refresh_rate s> <awake ms>
+ *     byos_sleep_us()
+ *   program --retry <error streak> <refresh_rate s>
+ *     byos_retry_s()
+ *
+ * Prints one JSON line.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "byos-client.h"
+
+// Strings here are URLs and file names; only quotes and backslashes need escaping
+static void printString(const char* s) {
+    putchar('"');
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') putchar('\\');
+        putchar(*s);
+    }
+    putchar('"');
+}
+
+static int checkDisplay(const char* json, const char* drawn) {
+    ByosCache cache;
+    memset(&cache, 0xA5, sizeof(cache));
+    byos_cache_validate(&cache);
+
+    ByosDisplay d;
+    if (drawn) {
+        if (byos_parse_display(drawn, strlen(drawn), &d) != BYOS_OK) {
+            fprintf(stderr, "--drawn reply does not parse\n");
+            return 1;
+        }
+        byos_image_drawn(&cache, &d);
+    }
+
+    int rc = byos_parse_display(json, strlen(json), &d);
+    printf("{\"rc\":%d,\"status\":%ld,\"refreshRateS\":%lu,\"imageUrl\":", rc, d.status,
+           (unsigned long)d.refreshRateS);
+    printString(d.imageUrl);
+    printf(",\"filename\":");
+    printString(d.filename);
+    printf(",\"key\":");
+    printString(byos_image_key(&d));
+    printf(",\"updateFirmware\":%s,\"resetFirmware\":%s,\"changed\":%s}\n",
+           d.updateFirmware ? "true" : "false", d.resetFirmware ? "true" : "false",
+           rc == BYOS_OK && byos_image_changed(&cache, &d) ? "true" : "false");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* display = nullptr;
+    const char* drawn = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--display") == 0 && i + 1 < argc) display = argv[++i];
+        else if (strcmp(argv[i], "--drawn") == 0 && i + 1 < argc) drawn = argv[++i];
+        else if (strcmp(argv[i], "--sleep") == 0 && i + 2 < argc) {
+            uint64_t us = byos_sleep_us((uint32_t)strtoul(argv[i + 1], nullptr, 10),
+                                        (uint32_t)strtoul(argv[i + 2], nullptr, 10));
+            printf("{\"us\":%llu}\n", (unsigned long long)us);
+            return 0;
+        } else if (strcmp(argv[i], "--retry") == 0 && i + 2 < argc) {
+            uint32_t s = byos_retry_s((uint16_t)strtoul(argv[i + 1], nullptr, 10),
+                                      (uint32_t)strtoul(argv[i + 2], nullptr, 10));
+            printf("{\"s\":%lu}\n", (unsigned long)s);
+            return 0;
+        }
+    }
+    if (display) return checkDisplay(display, drawn);
+    fprintf(stderr, "usage: %s --display <json> [--drawn <json>] | --sleep <rate s> <awake ms> | "
+                    "--retry <streak> <rate s>\n", argv[0]);
+    return 2;
+}
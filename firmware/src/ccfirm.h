@@ -0,0 +1,273 @@
+/**
+ * CCFirm™ — Firmware Internals
+ * Part of the Commute Compute System™
+ *
+ * What the firmware's source files share: main.cpp (provisioning, fetch,
+ * display), shell.cpp (serial shell and benches) and diag-server.cpp
+ * (long-press diagnostic HTTP server). Includes and configuration for all
+ * three, the main.cpp state and functions the other two use, and the
+ * calls main.cpp makes into them.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef CCFIRM_H
+#define CCFIRM_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <Preferences.h>
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLEUtils.h>
+#include <BLE2902.h>
+#include <nvs_flash.h>
+#include <bb_epaper.h>
+#include <time.h>
+#include <esp_attr.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/md.h>
+#include "base64.hpp"
+#include "soc/soc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "../include/config.h"
+#include "../include/cc_logo_data.h"
+#include "../include/timetable-slice.h"
+#include "../include/row-sink.h"
+#include "../include/fb-rotate.h"
+#include "../include/sink-display.h"
+#include "../include/bmp-stream.h"
+#include "../include/frame-codec.h"
+#include "../include/fetch-policy.h"
+#include "../include/log-ring.h"
+#include "../include/device-metrics.h"
+#include "../include/trace-ring.h"
+#include "../include/serial-shell.h"
+#include "../include/json-scan.h"
+#include "../include/tls-psk.h"
+#include "../include/tls-pin.h"
+#include "../include/tls-roots.h"
+#include "../include/http-lite.h"
+#include "../include/zone-sync.h"
+#include "../include/fresh-check.h"
+#ifdef CC_TLS_PROFILE
+#include "../include/tls-client.h"
+typedef CCTlsClient TlsClient;          // Tuned profile (tls-client.h)
+#else
+typedef WiFiClientSecure TlsClient;
+#endif
+#ifdef CC_DUAL_CORE
+#include <esp_heap_caps.h>
+#include "../include/chunk-pipe.h"
+#include "../include/frame-cache.h"
+#endif
+#ifdef CC_PAGE_CACHE
+#include <esp_partition.h>
+#include <esp_spi_flash.h>
+#include "../include/page-cache.h"
+#endif
+#define DASH_BLACK BBEP_BLACK
+#define DASH_WHITE BBEP_WHITE
+#include "../include/dash-template.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define FIRMWARE_VERSION "7.3.0"
+
+// Screen dimensions
+#ifdef BOARD_TRMNL_MINI
+  #define SCREEN_W 600
+  #define SCREEN_H 448
+  #define LOGO_BOOT CC_LOGO_BOOT_MINI
+  #define LOGO_BOOT_W 192
+  #define LOGO_BOOT_H 280
+  #define LOGO_SMALL CC_LOGO_SMALL_MINI
+  #define LOGO_SMALL_W 128
+  #define LOGO_SMALL_H 130
+  #define PANEL_TYPE EP583R_600x448
+#else
+  #define SCREEN_W 800
+  #define SCREEN_H 480
+  #define LOGO_BOOT CC_LOGO_BOOT
+  #define LOGO_BOOT_W 256
+  #define LOGO_BOOT_H 380
+  #define LOGO_SMALL CC_LOGO_SMALL
+  #define LOGO_SMALL_W 128
+  #define LOGO_SMALL_H 130
+  #define PANEL_TYPE EP75_800x480
+#endif
+
+// Full-screen BMP: 800x480 1-bit = (800/8)*480 + 62 header = 48062 bytes
+#define ZONE_BMP_MAX_SIZE 50000
+// DEFAULT_SERVER removed - turnkey requirement (URL comes from pairing only)
+
+// BLE UUIDs (Hybrid: WiFi credentials ONLY - URL comes via pairing code)
+#define BLE_SERVICE_UUID        "CC000001-0000-1000-8000-00805F9B34FB"
+#define BLE_CHAR_SSID_UUID      "CC000002-0000-1000-8000-00805F9B34FB"
+#define BLE_CHAR_PASSWORD_UUID  "CC000003-0000-1000-8000-00805F9B34FB"
+#define BLE_CHAR_SERVER_UUID    "CC000004-0000-1000-8000-00805F9B34FB"  // Server URL (turnkey per Section 17.4)
+#define BLE_CHAR_STATUS_UUID    "CC000005-0000-1000-8000-00805F9B34FB"
+#define BLE_CHAR_WIFI_LIST_UUID "CC000006-0000-1000-8000-00805F9B34FB"
+
+#ifdef CC_BLE_FRAME_PUSH
+// Optional local display path: compressed zone frames (CCZF) pushed over BLE
+#define BLE_CHAR_FRAME_UUID        "CC000007-0000-1000-8000-00805F9B34FB"  // Write without response
+#define BLE_CHAR_FRAME_STATUS_UUID "CC000008-0000-1000-8000-00805F9B34FB"  // Notify: frame stats/errors
+#define BLE_FRAME_MTU          517      // Max ATT MTU - 512-byte writes
+#define BLE_FRAME_RING_SIZE    8192     // Power of two (index wrap)
+#define BLE_PUSH_WINDOW_MS     30000    // BLE window opened during WiFi outages
+#endif
+
+// Diagnostic HTTP server (long-press the button while online)
+#define DIAG_LONG_PRESS_MS     2000
+#define DIAG_WINDOW_MS         600000   // Server stops 10 minutes after the press
+#define DIAG_PORT              80
+#define DIAG_READ_TIMEOUT_MS   2000
+#define DIAG_POLL_MS           50
+
+#ifdef CC_DUAL_CORE
+// ESP32-S3 + PSRAM: HTTP/TLS reads run on core 0 next to the WiFi stack,
+// decode -> shadow framebuffer -> SPI stays on core 1 (loop)
+#define NET_TASK_CORE          0
+#define NET_TASK_STACK         10240
+#define NET_TASK_PRIORITY      3
+#define NET_CHUNK_SLOTS        8        // Power of two
+#define NET_CHUNK_SIZE         4096
+#define FRAME_CACHE_SLOTS      4        // ZONE_BMP_MAX_SIZE each, in PSRAM
+#endif
+
+#ifdef CC_PAGE_CACHE
+// Button pages (page-cache.h): a short press shows the next server page from
+// flash; the cache lives in the SPIFFS partition of min_spiffs.csv (unused)
+#define PAGE_HOLD_MS           120000   // Back to the dashboard after 2 minutes
+#define PAGE_PREFETCH_RETRY_MS 60000    // After a failed prefetch
+#define PAGE_READ_CHUNK        2048     // Flash -> decoder
+#endif
+
+// TLS (main.cpp): the chain is verified against the bundled roots once,
+// then the pinned leaf is compared instead; the PSK endpoint needs neither
+#define TLS_CONNECT_TIMEOUT_MS   5000
+#define TLS_HANDSHAKE_TIMEOUT_S  15
+
+enum TlsMode {
+    TLS_MODE_INSECURE,   // No server authentication (bench comparison only)
+    TLS_MODE_CHAIN,      // Chain verified against TLS_ROOT_CERTS
+    TLS_MODE_PINNED,     // Chain not checked - caller compares the leaf
+    TLS_MODE_PSK
+};
+
+// Dashboard responses go through http-lite.h (main.cpp)
+#define HTTP_IO_TIMEOUT_MS  20000
+#define DASH_SLICE_MAX      ((SLICE_MAX_BYTES + 2) / 3 * 4 + 1)   // X-Timetable-Slice, base64
+#define DASH_LINE_MAX       (DASH_SLICE_MAX + 32)
+
+// ============================================================================
+// MAIN.CPP STATE
+// ============================================================================
+
+extern BBEPAPER* bbep;
+extern char webhookUrl[1024];
+extern char pskIdentity[TLS_PSK_IDENTITY_MAX];
+extern char pskKey[TLS_PSK_KEY_HEX_MAX];
+extern char pskEndpoint[TLS_PSK_ENDPOINT_MAX];
+extern char freshEndpoint[FRESH_ENDPOINT_MAX];
+extern ZoneHashes shownZones;
+extern TlsPin tlsPin;
+
+extern unsigned long lastFullRefresh;
+extern int partialRefreshCount;
+extern int consecutiveErrors;
+extern DeviceMetrics metrics;
+
+// Shadow framebuffer (zoneBmpBuffer) and the sink every image source writes through
+extern uint8_t* zoneBmpBuffer;
+extern FrameBuffer shadowFb;
+extern FrameBufferSink shadowSinkState;
+extern RowSink shadowSink;
+extern uint8_t displayRotation;
+extern RotateSink shadowRotState;
+
+// One dashboard connection at a time
+extern HttpLiteConn dashConn;
+extern char dashLine[DASH_LINE_MAX];
+
+#ifdef CC_PAGE_CACHE
+extern PageList serverPages;
+extern PageCache pageCache;
+extern const esp_partition_t* pagePartition;
+extern bool pageCacheReady;
+extern volatile bool pagePressPending;    // Short press seen by pollDiagButton()
+extern int shownPage;
+#endif
+
+// ============================================================================
+// MAIN.CPP FUNCTIONS
+// ============================================================================
+
+void saveSettings();
+uint32_t currentUnixTime();
+void doFullRefresh();
+bool fetchZoneUpdates(bool forceAll);
+RowSink frameSink(FrameBufferSink* fbState, RotateSink* rotState, FrameBuffer* fb);
+void serialLogOut(const char* text, size_t len, void* ctx);   // LogOutFn / TraceOutFn to Serial
+
+bool serverHostPort(const char* url, char* host, size_t size, uint16_t* port);
+WiFiClient* dashboardConnect(TlsClient& client, const char* url, bool psk);
+void dashboardHeaders(char* out, size_t size);
+void dashboardEnd(TlsClient& client);
+int clientIoRead(void* ctx, uint8_t* buf, size_t len);          // HttpLiteIo over a WiFiClient
+bool clientIoWrite(void* ctx, const uint8_t* buf, size_t len);
+int freshCheck(FreshReply* reply);
+#ifdef CC_PAGE_CACHE
+bool decodeCachedPage(int slot);
+#endif
+
+// Templates so "bench tls" can run the stock client and the tuned profile
+template <typename C>
+bool tlsHandshake(C& client, const char* host, uint16_t port, TlsMode mode) {
+    if (mode == TLS_MODE_CHAIN) {
+        client.setCACert(TLS_ROOT_CERTS);
+    } else if (mode == TLS_MODE_PSK) {
+        client.setPreSharedKey(pskIdentity, pskKey);
+    } else {
+        client.setInsecure();
+    }
+    client.setHandshakeTimeout(TLS_HANDSHAKE_TIMEOUT_S);
+    return client.connect(host, port, TLS_CONNECT_TIMEOUT_MS);
+}
+
+// SHA-256 and expiry of the server's leaf certificate
+template <typename C>
+bool tlsPeerLeaf(C& client, uint8_t sha256[32], uint32_t* notAfter) {
+    const mbedtls_x509_crt* crt = client.getPeerCertificate();
+    if (!crt || !crt->raw.p) return false;
+    mbedtls_sha256(crt->raw.p, crt->raw.len, sha256, 0);
+    const mbedtls_x509_time& t = crt->valid_to;
+    *notAfter = tlspin_unix_time(t.year, t.mon, t.day, t.hour, t.min, t.sec);
+    return true;
+}
+
+// ============================================================================
+// DIAGNOSTIC SERVER (diag-server.cpp)
+// ============================================================================
+
+extern bool diagActive;
+
+void pollDiagButton(unsigned long now);   // Long-press starts the server
+void serviceDiagServer();                 // Answers one request, stops it when the window ends
+uint32_t currentFrameBytes();             // Size of the BMP in zoneBmpBuffer, 0 if none
+void sampleMetricsRuntime(MetricsRuntime* rt);
+
+// ============================================================================
+// SERIAL SHELL (shell.cpp)
+// ============================================================================
+
+void pollSerialShell();                   // Runs any complete command line
+
+#endif // CCFIRM_H
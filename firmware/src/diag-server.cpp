@@ -0,0 +1,146 @@
+/**
+ * CCFirm™ — Diagnostic HTTP Server
+ * Part of the Commute Compute System™
+ *
+ * Holding the button for 2 s while online starts a plain HTTP server for
+ * DIAG_WINDOW_MS:
+ *   /metrics    fetch/refresh timings, heap, RSSI (Prometheus text)
+ *   /frame.bmp  the frame the panel is showing
+ * Nothing is allocated for it: requests are parsed on the stack and the frame
+ * is written straight out of zoneBmpBuffer (the fetch/shadow buffer).
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include "ccfirm.h"
+
+// begin() only runs after a long-press
+static WiFiServer diagServer(DIAG_PORT);
+bool diagActive = false;
+static unsigned long diagUntil = 0;
+static unsigned long buttonDownAt = 0;
+static bool buttonLatched = false;   // Long-press handled, wait for release
+
+static bool diagPathIs(const char* path, const char* want) {
+    size_t n = strlen(want);
+    return strncmp(path, want, n) == 0 && (path[n] == ' ' || path[n] == '?' || path[n] == '\0');
+}
+
+static void diagRespond(WiFiClient& client, int code, const char* type, const uint8_t* body, size_t len) {
+    char head[160];
+    int n = snprintf(head, sizeof(head),
+                     "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n"
+                     "Cache-Control: no-store\r\nConnection: close\r\n\r\n",
+                     code, code == 200 ? "OK" : code == 404 ? "Not Found" : "Service Unavailable",
+                     type, (unsigned)len);
+    client.write((const uint8_t*)head, n);
+    // One TCP segment at a time keeps lwIP from buffering the whole frame
+    while (len > 0) {
+        size_t part = len > 1436 ? 1436 : len;
+        size_t sent = client.write(body, part);
+        if (sent == 0) break;
+        body += sent;
+        len -= sent;
+    }
+}
+
+// Size of the BMP in zoneBmpBuffer, 0 if there is no valid frame
+uint32_t currentFrameBytes() {
+    if (!zoneBmpBuffer || zoneBmpBuffer[0] != 'B' || zoneBmpBuffer[1] != 'M') return 0;
+    uint32_t len = bmp_u32(zoneBmpBuffer + 2);
+    return len <= ZONE_BMP_MAX_SIZE ? len : 0;
+}
+
+void sampleMetricsRuntime(MetricsRuntime* rt) {
+    rt->uptimeMs = millis();
+    rt->heapFree = ESP.getFreeHeap();
+    rt->heapMin = ESP.getMinFreeHeap();
+    rt->heapMaxBlock = ESP.getMaxAllocHeap();
+    rt->rssi = WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0;
+    rt->partialSinceFull = partialRefreshCount;
+    rt->consecutiveErrors = consecutiveErrors;
+    rt->logDropped = g_logRing.dropped;
+}
+
+static void startDiagServer(unsigned long now) {
+    if (WiFi.status() != WL_CONNECTED) return;
+    if (!diagActive) diagServer.begin();
+    diagActive = true;
+    diagUntil = now + DIAG_WINDOW_MS;
+    CCLOG_I("[Diag] http://%s/metrics for %lu s", WiFi.localIP().toString().c_str(),
+            (unsigned long)(DIAG_WINDOW_MS / 1000));
+}
+
+void pollDiagButton(unsigned long now) {
+    if (digitalRead(PIN_INTERRUPT) != LOW) {
+#ifdef CC_PAGE_CACHE
+        // Released before the long-press: next page
+        if (buttonDownAt && !buttonLatched) pagePressPending = true;
+#endif
+        buttonDownAt = 0;
+        buttonLatched = false;
+        return;
+    }
+    if (buttonLatched) return;
+    if (!buttonDownAt) {
+        buttonDownAt = now | 1;
+    } else if (now - buttonDownAt >= DIAG_LONG_PRESS_MS) {
+        buttonLatched = true;
+        startDiagServer(now);
+    }
+}
+
+void serviceDiagServer() {
+    if (!diagActive) return;
+    if ((long)(millis() - diagUntil) >= 0 || WiFi.status() != WL_CONNECTED) {
+        diagServer.end();
+        diagActive = false;
+        CCLOG_I("[Diag] Server stopped");
+        return;
+    }
+
+    WiFiClient client = diagServer.available();
+    if (!client) return;
+
+    // Keep the request line, drain headers up to the blank line
+    char line[96];
+    size_t n = 0;
+    bool inFirstLine = true;
+    int matched = 0;   // Chars of "\r\n\r\n" seen
+    unsigned long deadline = millis() + DIAG_READ_TIMEOUT_MS;
+    while (matched < 4 && client.connected() && (long)(millis() - deadline) < 0) {
+        int c = client.read();
+        if (c < 0) {
+            delay(1);
+            continue;
+        }
+        if (inFirstLine) {
+            if (c == '\r' || c == '\n') inFirstLine = false;
+            else if (n < sizeof(line) - 1) line[n++] = (char)c;
+        }
+        if (c == ((matched & 1) ? '\n' : '\r')) matched++;
+        else matched = (c == '\r') ? 1 : 0;
+    }
+    line[n] = '\0';
+
+    const char* path = strncmp(line, "GET ", 4) == 0 ? line + 4 : "";
+    if (diagPathIs(path, "/metrics")) {
+        MetricsRuntime rt;
+        sampleMetricsRuntime(&rt);
+        char body[2048];
+        size_t len = metrics_format(&metrics, &rt, body, sizeof(body));
+        diagRespond(client, 200, "text/plain; version=0.0.4", (const uint8_t*)body, len);
+    } else if (diagPathIs(path, "/frame.bmp")) {
+        uint32_t len = currentFrameBytes();
+        if (len == 0) {
+            diagRespond(client, 503, "text/plain", (const uint8_t*)"No frame\n", 9);
+        } else {
+            diagRespond(client, 200, "image/bmp", zoneBmpBuffer, len);
+        }
+    } else {
+        diagRespond(client, 404, "text/plain", (const uint8_t*)"Not found\n", 10);
+    }
+    client.stop();
+    CCLOG_D("[Diag] %s", line);
+}
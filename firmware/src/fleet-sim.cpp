@@ -0,0 +1,543 @@
+/**
+ * CCFirm™ — Fleet Load Simulator (host, env:native-fleet)
+ * Part of the Commute Compute System™
+ *
+ * Runs hundreds of devices' fetch logic (include/fetch-policy.h, the same
+ * schedule main.cpp / main-tiered.cpp follow) against a local server
+ * (`node server.js`), each with its own device token, on a simulated clock
+ * that runs --speed times faster than real time. Requests are real HTTP,
+ * so the numbers are what the server actually does under that pattern.
+ *
+ * Reports request rate (wall and fleet-equivalent), p50/p99 latency, error
+ * rate and bytes per device per hour, per firmware configuration:
+ *   --mode full|tiered        full-screen BMP vs tiered zone fetches
+ *   --transport poll|push     interval polling vs change notifications
+ *   --matrix                  run all four combinations
+ *
+ * Push is modelled with one notifier that checks the content once per
+ * --notify-interval and notifies every device whose content changed; each
+ * notification costs the device PUSH_NOTIFY_BYTES on its push channel.
+ *
+ * Devices listed by --unpaired poll /api/pair/<code> until --pair-after
+ * sim seconds have passed (the user finishing the setup wizard).
+ *
+ * Usage:
+ *   node server.js &
+ *   .pio/build/native-fleet/program --devices 500 --hours 2 --speed 120 --matrix
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fetch-policy.h"
+
+#define PUSH_NOTIFY_BYTES   48        // One small message on an open channel
+#define HTTP_TIMEOUT_SEC    30        // HTTP_TIMEOUT in config.h
+
+typedef std::chrono::steady_clock Clock;
+
+struct SimConfig {
+    std::string host = "127.0.0.1";
+    std::string port = "3000";
+    int devices = 100;
+    double hours = 1.0;               // Simulated
+    double speed = 60.0;              // Sim seconds per wall second
+    int concurrency = 64;
+    int unpaired = 0;
+    double pairAfterSec = 120;
+    double rampSec = 60;              // Boots spread over this window
+    double notifyIntervalSec = 60;
+    PolicyMode mode = POLICY_FULL_FRAME;
+    PolicyTransport transport = POLICY_POLL;
+    bool matrix = false;
+    std::string fullPath = "/api/device/{token}?format=bmp";
+    std::string tierPath = "/api/zones?tier={tier}";
+    std::string allPath = "/api/zones?force=true";
+    std::string pairPath = "/api/pair/{code}";
+};
+
+// ============================================================================
+// HTTP (plain sockets, one connection per request like HTTPClient::end())
+// ============================================================================
+
+struct HttpResult {
+    int status;                       // 0 on transport failure
+    size_t bytesOut, bytesIn;
+    uint32_t bodyHash;
+    double ms;
+};
+
+static HttpResult httpGet(const SimConfig& cfg, const std::string& path, const std::string& extraHeaders = "") {
+    HttpResult r = {0, 0, 0, 0x811C9DC5u, 0};
+    Clock::time_point t0 = Clock::now();
+
+    struct addrinfo hints, *ai = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(cfg.host.c_str(), cfg.port.c_str(), &hints, &ai) != 0 || !ai) return r;
+
+    int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(ai);
+        return r;
+    }
+    struct timeval tv = { HTTP_TIMEOUT_SEC, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    bool connected = connect(fd, ai->ai_addr, ai->ai_addrlen) == 0;
+    freeaddrinfo(ai);
+    if (!connected) {
+        close(fd);
+        r.ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        return r;
+    }
+
+    std::string req = "GET " + path + " HTTP/1.1\r\nHost: " + cfg.host + ":" + cfg.port +
+                      "\r\nUser-Agent: ESP32HTTPClient\r\nConnection: close\r\n" + extraHeaders + "\r\n";
+    if (send(fd, req.data(), req.size(), 0) == (ssize_t)req.size()) {
+        r.bytesOut = req.size();
+        char buf[8192];
+        std::string head;
+        bool inBody = false;
+        ssize_t n;
+        while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+            r.bytesIn += n;
+            size_t start = 0;
+            if (!inBody) {
+                head.append(buf, n);
+                size_t end = head.find("\r\n\r\n");
+                if (end == std::string::npos) continue;
+                inBody = true;
+                sscanf(head.c_str(), "HTTP/%*s %d", &r.status);
+                start = n - (head.size() - (end + 4));
+            }
+            for (ssize_t i = start; i < n; i++) {
+                r.bodyHash ^= (uint8_t)buf[i];
+                r.bodyHash *= 0x01000193u;
+            }
+        }
+        if (n < 0) r.status = 0;      // Timed out mid-response
+    }
+    close(fd);
+    r.ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    return r;
+}
+
+static std::string expand(std::string s, const char* key, const std::string& value) {
+    size_t at;
+    while ((at = s.find(key)) != std::string::npos) s.replace(at, strlen(key), value);
+    return s;
+}
+
+static std::string base64url(const std::string& in) {
+    static const char* tbl = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::string out;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (unsigned char c : in) {
+        acc = (acc << 8) | c;
+        bits += 8;
+        while (bits >= 6) {
+            bits -= 6;
+            out += tbl[(acc >> bits) & 0x3F];
+        }
+    }
+    if (bits) out += tbl[(acc << (6 - bits)) & 0x3F];
+    return out;
+}
+
+// ============================================================================
+// FLEET
+// ============================================================================
+
+struct Device {
+    FetchPolicy policy;
+    std::string token;
+    std::string pairCode;
+    uint32_t pairAt;                  // Sim ms the wizard completes
+    uint32_t gen;                     // Invalidates stale schedule entries
+    bool busy;
+    uint64_t bytes;
+    uint32_t requests, errors, notifications;
+};
+
+struct Wake {
+    uint32_t at;
+    int device;
+    uint32_t gen;
+    bool operator>(const Wake& o) const { return at > o.at; }
+};
+
+struct Job {
+    int device;
+    PolicyRequest req;
+};
+
+struct Stats {
+    std::vector<double> latency[4];   // Indexed by PolicyAction
+    uint32_t requests[4] = {0};
+    uint32_t errors[4] = {0};
+    uint32_t notifierRequests = 0;
+};
+
+class Fleet {
+public:
+    Fleet(const SimConfig& cfg) : cfg_(cfg) {}
+
+    void run();
+    void report(FILE* out, bool last);
+
+private:
+    uint32_t simNow() const {
+        double wall = std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+        return (uint32_t)(wall * cfg_.speed);
+    }
+    void schedule(int d, uint32_t at);
+    void dispatcher();
+    void worker();
+    void notifier();
+    std::string pathFor(const Device& dev, const PolicyRequest& req) const;
+
+    const SimConfig& cfg_;
+    std::vector<Device> devices_;
+    std::priority_queue<Wake, std::vector<Wake>, std::greater<Wake>> wakes_;
+    std::deque<Job> jobs_;
+    std::mutex mu_;
+    std::condition_variable jobCv_;
+    std::atomic<bool> stop_{false};
+    Clock::time_point start_;
+    uint32_t endMs_ = 0;
+    double wallSec_ = 0;
+    Stats stats_;
+};
+
+void Fleet::schedule(int d, uint32_t at) {
+    Device& dev = devices_[d];
+    dev.gen++;
+    wakes_.push({at, d, dev.gen});
+}
+
+std::string Fleet::pathFor(const Device& dev, const PolicyRequest& req) const {
+    switch (req.action) {
+        case POLICY_PAIR_POLL:
+            return expand(cfg_.pairPath, "{code}", dev.pairCode);
+        case POLICY_FETCH_TIER:
+            return expand(expand(cfg_.tierPath, "{tier}", std::to_string(req.tier)), "{token}", dev.token);
+        default:
+            return expand(cfg_.mode == POLICY_TIERED ? cfg_.allPath : cfg_.fullPath, "{token}", dev.token);
+    }
+}
+
+void Fleet::dispatcher() {
+    while (!stop_) {
+        uint32_t now = simNow();
+        if (now >= endMs_) break;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            while (!wakes_.empty() && wakes_.top().at <= now) {
+                Wake w = wakes_.top();
+                wakes_.pop();
+                Device& dev = devices_[w.device];
+                if (w.gen != dev.gen || dev.busy) continue;
+
+                if (!dev.policy.paired && now >= dev.pairAt) policy_paired(&dev.policy, now);
+
+                Job job = {w.device, {}};
+                if (policy_due(&dev.policy, now, &job.req)) {
+                    dev.busy = true;
+                    dev.gen++;
+                    jobs_.push_back(job);
+                    jobCv_.notify_one();
+                } else {
+                    uint32_t next = policy_next_wake(&dev.policy, now);
+                    if (!dev.policy.paired && dev.pairAt < next) next = dev.pairAt;
+                    schedule(w.device, next > now ? next : now + 1000);
+                }
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stop_ = true;
+    jobCv_.notify_all();
+}
+
+void Fleet::worker() {
+    for (;;) {
+        Job job;
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            jobCv_.wait(lock, [&] { return stop_ || !jobs_.empty(); });
+            if (stop_) return;
+            job = jobs_.front();
+            jobs_.pop_front();
+            path = pathFor(devices_[job.device], job.req);
+        }
+
+        // Full-frame fetches announce the next one like main.cpp does
+        std::string headers;
+        if (job.req.action == POLICY_FETCH_FULL && cfg_.mode == POLICY_FULL_FRAME) {
+            headers = std::string(NEXT_FETCH_HEADER) + ": " + std::to_string(FETCH_INTERVAL_MS / 1000) + "\r\n";
+        }
+        HttpResult r = httpGet(cfg_, path, headers);
+        // The firmware treats any non-200 pairing poll as "not yet"; only
+        // transport failures and 5xx count as errors there
+        bool ok = job.req.action == POLICY_PAIR_POLL ? (r.status > 0 && r.status < 500)
+                                                     : r.status == 200;
+
+        std::lock_guard<std::mutex> lock(mu_);
+        uint32_t now = simNow();
+        Device& dev = devices_[job.device];
+        dev.busy = false;
+        dev.bytes += r.bytesOut + r.bytesIn;
+        dev.requests++;
+        if (!ok) dev.errors++;
+        int a = job.req.action;
+        stats_.latency[a].push_back(r.ms);
+        stats_.requests[a]++;
+        if (!ok) stats_.errors[a]++;
+
+        policy_done(&dev.policy, &job.req, now, ok);
+        PolicyRequest more;
+        schedule(job.device, policy_due(&dev.policy, now, &more) ? now : policy_next_wake(&dev.policy, now));
+    }
+}
+
+void Fleet::notifier() {
+    uint32_t lastHash[4] = {0};
+    bool first = true;
+    uint32_t nextAt = 0;
+    std::string token = base64url("{\"a\":{\"home\":\"Notifier\"},\"s\":\"VIC\"}");
+
+    while (!stop_) {
+        uint32_t now = simNow();
+        if (now < nextAt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        nextAt = now + (uint32_t)(cfg_.notifyIntervalSec * 1000);
+
+        uint8_t mask = 0;
+        int first_t = cfg_.mode == POLICY_TIERED ? 1 : 0;
+        int last_t = cfg_.mode == POLICY_TIERED ? 3 : 0;
+        for (int t = first_t; t <= last_t; t++) {
+            std::string path = t == 0 ? expand(cfg_.fullPath, "{token}", token)
+                                      : expand(cfg_.tierPath, "{tier}", std::to_string(t));
+            HttpResult r = httpGet(cfg_, path);
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                stats_.notifierRequests++;
+            }
+            if (r.status == 200 && (first || r.bodyHash != lastHash[t])) mask |= (uint8_t)(1 << t);
+            lastHash[t] = r.bodyHash;
+        }
+        first = false;
+        if (!mask) continue;
+
+        std::lock_guard<std::mutex> lock(mu_);
+        now = simNow();
+        for (size_t d = 0; d < devices_.size(); d++) {
+            Device& dev = devices_[d];
+            if (!dev.policy.paired) continue;
+            policy_notify(&dev.policy, mask);
+            dev.notifications++;
+            dev.bytes += PUSH_NOTIFY_BYTES;
+            if (!dev.busy) schedule((int)d, now);
+        }
+    }
+}
+
+void Fleet::run() {
+    devices_.resize(cfg_.devices);
+    srand(12345);
+    for (int i = 0; i < cfg_.devices; i++) {
+        Device& dev = devices_[i];
+        bool paired = i >= cfg_.unpaired;
+        uint32_t boot = (uint32_t)(cfg_.rampSec * 1000 * (rand() / (double)RAND_MAX));
+        policy_init(&dev.policy, cfg_.mode, cfg_.transport, paired, boot);
+        char json[128];
+        snprintf(json, sizeof(json), "{\"a\":{\"home\":\"Sim Device %d\"},\"s\":\"VIC\"}", i);
+        dev.token = base64url(json);
+        char code[12];
+        snprintf(code, sizeof(code), "S%05d", i);
+        dev.pairCode = code;
+        dev.pairAt = paired ? 0 : boot + (uint32_t)(cfg_.pairAfterSec * 1000);
+        schedule(i, boot);
+    }
+
+    endMs_ = (uint32_t)(cfg_.hours * 3600000.0);
+    start_ = Clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < cfg_.concurrency; i++) threads.emplace_back(&Fleet::worker, this);
+    if (cfg_.transport == POLICY_PUSH) threads.emplace_back(&Fleet::notifier, this);
+    dispatcher();
+    for (std::thread& t : threads) t.join();
+    wallSec_ = std::chrono::duration<double>(Clock::now() - start_).count();
+}
+
+static double mean(const std::vector<double>& v) {
+    double sum = 0;
+    for (double x : v) sum += x;
+    return v.empty() ? 0 : sum / v.size();
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[(size_t)(p * (v.size() - 1) + 0.5)];
+}
+
+void Fleet::report(FILE* out, bool last) {
+    static const char* names[4] = { "none", "pair_poll", "fetch_full", "fetch_tier" };
+    double simHours = cfg_.hours;
+    uint32_t total = 0, errors = 0, full = 0, partial = 0;
+    std::vector<double> all, bph;
+    for (int a = 1; a < 4; a++) {
+        total += stats_.requests[a];
+        errors += stats_.errors[a];
+        all.insert(all.end(), stats_.latency[a].begin(), stats_.latency[a].end());
+    }
+    for (const Device& dev : devices_) {
+        bph.push_back(dev.bytes / simHours);
+        full += dev.policy.fullRefreshes;
+        partial += dev.policy.partialRefreshes;
+    }
+
+    // Wall latency becomes sim latency x speed; past ~1 sim s it starts to
+    // shift the schedule itself (pairing polls are 5 s apart)
+    double simP99 = percentile(all, 0.99) * cfg_.speed / 1000.0;
+    if (simP99 > 1.0) {
+        fprintf(stderr, "[Fleet] Warning: p99 latency is %.1f sim s at %.0fx - lower --speed\n",
+                simP99, cfg_.speed);
+    }
+
+    fprintf(out, "    {\n");
+    fprintf(out, "      \"mode\": \"%s\", \"transport\": \"%s\",\n",
+            cfg_.mode == POLICY_TIERED ? "tiered" : "full", cfg_.transport == POLICY_PUSH ? "push" : "poll");
+    fprintf(out, "      \"devices\": %d, \"unpaired\": %d, \"sim_hours\": %.2f, \"wall_sec\": %.1f,\n",
+            cfg_.devices, cfg_.unpaired, simHours, wallSec_);
+    fprintf(out, "      \"requests\": %u, \"errors\": %u, \"error_rate\": %.4f,\n",
+            total, errors, total ? (double)errors / total : 0.0);
+    fprintf(out, "      \"req_per_sec_wall\": %.1f, \"req_per_sec_fleet\": %.2f,\n",
+            total / wallSec_, total / (simHours * 3600));
+    fprintf(out, "      \"latency_ms\": { \"p50\": %.1f, \"p99\": %.1f },\n", percentile(all, 0.5), percentile(all, 0.99));
+    fprintf(out, "      \"by_action\": {");
+    bool firstAction = true;
+    for (int a = 1; a < 4; a++) {
+        if (!stats_.requests[a]) continue;
+        fprintf(out, "%s\n        \"%s\": { \"requests\": %u, \"errors\": %u, \"p50\": %.1f, \"p99\": %.1f }",
+                firstAction ? "" : ",", names[a], stats_.requests[a], stats_.errors[a],
+                percentile(stats_.latency[a], 0.5), percentile(stats_.latency[a], 0.99));
+        firstAction = false;
+    }
+    fprintf(out, "\n      },\n");
+    fprintf(out, "      \"bytes_per_device_hour\": { \"mean\": %.0f, \"p50\": %.0f, \"max\": %.0f },\n",
+            mean(bph), percentile(bph, 0.5), percentile(bph, 1.0));
+    fprintf(out, "      \"panel_refreshes_per_device_hour\": { \"full\": %.1f, \"partial\": %.1f },\n",
+            full / (cfg_.devices * simHours), partial / (cfg_.devices * simHours));
+    fprintf(out, "      \"notifier_requests\": %u\n", stats_.notifierRequests);
+    fprintf(out, "    }%s\n", last ? "" : ",");
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static void usage() {
+    fprintf(stderr,
+        "Usage: fleet-sim [--server host:port] [--devices N] [--hours H] [--speed X]\n"
+        "                 [--mode full|tiered] [--transport poll|push] [--matrix]\n"
+        "                 [--concurrency N] [--unpaired N] [--pair-after SEC] [--ramp SEC]\n"
+        "                 [--notify-interval SEC] [--full-path P] [--tier-path P]\n"
+        "                 [--all-path P] [--pair-path P]\n"
+        "Paths expand {token}, {tier} and {code}.\n");
+}
+
+int main(int argc, char** argv) {
+    SimConfig cfg;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(a, "--matrix") == 0) { cfg.matrix = true; continue; }
+        if (strcmp(a, "--help") == 0 || !v) { usage(); return strcmp(a, "--help") == 0 ? 0 : 1; }
+        i++;
+        if (strcmp(a, "--server") == 0) {
+            std::string s = v;
+            if (s.rfind("http://", 0) == 0) s = s.substr(7);
+            size_t colon = s.rfind(':');
+            cfg.host = s.substr(0, colon);
+            if (colon != std::string::npos) cfg.port = s.substr(colon + 1);
+        }
+        else if (strcmp(a, "--devices") == 0) cfg.devices = atoi(v);
+        else if (strcmp(a, "--hours") == 0) cfg.hours = atof(v);
+        else if (strcmp(a, "--speed") == 0) cfg.speed = atof(v);
+        else if (strcmp(a, "--concurrency") == 0) cfg.concurrency = atoi(v);
+        else if (strcmp(a, "--unpaired") == 0) cfg.unpaired = atoi(v);
+        else if (strcmp(a, "--pair-after") == 0) cfg.pairAfterSec = atof(v);
+        else if (strcmp(a, "--ramp") == 0) cfg.rampSec = atof(v);
+        else if (strcmp(a, "--notify-interval") == 0) cfg.notifyIntervalSec = atof(v);
+        else if (strcmp(a, "--mode") == 0) cfg.mode = strcmp(v, "tiered") == 0 ? POLICY_TIERED : POLICY_FULL_FRAME;
+        else if (strcmp(a, "--transport") == 0) cfg.transport = strcmp(v, "push") == 0 ? POLICY_PUSH : POLICY_POLL;
+        else if (strcmp(a, "--full-path") == 0) cfg.fullPath = v;
+        else if (strcmp(a, "--tier-path") == 0) cfg.tierPath = v;
+        else if (strcmp(a, "--all-path") == 0) cfg.allPath = v;
+        else if (strcmp(a, "--pair-path") == 0) cfg.pairPath = v;
+        else { usage(); return 1; }
+    }
+    if (cfg.devices < 1 || cfg.concurrency < 1 || cfg.speed <= 0 || cfg.hours <= 0) {
+        usage();
+        return 1;
+    }
+    if (cfg.hours * 3600000.0 >= 4294967295.0) {
+        fprintf(stderr, "--hours too large (sim clock is 32-bit ms)\n");
+        return 1;
+    }
+
+    std::vector<SimConfig> runs;
+    if (cfg.matrix) {
+        for (int m = 0; m < 2; m++) {
+            for (int t = 0; t < 2; t++) {
+                SimConfig c = cfg;
+                c.mode = (PolicyMode)m;
+                c.transport = (PolicyTransport)t;
+                runs.push_back(c);
+            }
+        }
+    } else {
+        runs.push_back(cfg);
+    }
+
+    printf("{\n  \"server\": \"%s:%s\",\n  \"speed\": %.0f,\n  \"runs\": [\n",
+           cfg.host.c_str(), cfg.port.c_str(), cfg.speed);
+    for (size_t i = 0; i < runs.size(); i++) {
+        fprintf(stderr, "[Fleet] %d devices, %s/%s, %.2f sim h at %.0fx...\n", runs[i].devices,
+                runs[i].mode == POLICY_TIERED ? "tiered" : "full",
+                runs[i].transport == POLICY_PUSH ? "push" : "poll", runs[i].hours, runs[i].speed);
+        Fleet fleet(runs[i]);
+        fleet.run();
+        fleet.report(stdout, i + 1 == runs.size());
+        fflush(stdout);
+    }
+    printf("  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * CCFirm™ — Base64 Decoder Fuzz Harness (host, env:native-fuzz-base64)
+ * Part of the Commute Compute System™
+ *
+ * Input: arbitrary bytes treated as base64 text (zone payloads, slices).
+ *
+ * decode_base64_length() must give the exact output size - callers use it
+ * to bound the destination buffer - and decode_base64() must produce the
+ * same bytes as the bit-at-a-time reference below. The output buffer is
+ * allocated at exactly that size so an overrun is caught by ASan.
+ *
+ * decode_base64_inplace() must accept exactly the inputs referenceStrict()
+ * accepts, decoding them to the reference bytes, and reject the rest. It
+ * runs on an exact-size copy of the input.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <vector>
+#include "fuzz-target.h"
+#include "base64.hpp"
+
+// Reference: accumulate one bit at a time, same skip/stop rules
+static size_t referenceDecode(const uint8_t* in, size_t len, std::vector<uint8_t>* out) {
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    uint8_t acc = 0;
+    int nbits = 0;
+    out->clear();
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == '=') break;
+        const char* hit = in[i] ? strchr(alphabet, in[i]) : nullptr;
+        if (!hit) continue;
+        int v = (int)(hit - alphabet);
+        for (int b = 5; b >= 0; b--) {
+            acc = (uint8_t)((acc << 1) | ((v >> b) & 1));
+            if (++nbits == 8) {
+                out->push_back(acc);
+                acc = 0;
+                nbits = 0;
+            }
+        }
+    }
+    return out->size();
+}
+
+// Strict acceptance: whitespace aside, only alphabet symbols then "=" or
+// "==" at the very end, total a multiple of 4
+static bool referenceStrict(const uint8_t* in, size_t len) {
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::vector<uint8_t> s;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == '\n' || in[i] == '\r' || in[i] == ' ' || in[i] == '\t') continue;
+        if (in[i] != '=' && !(in[i] && strchr(alphabet, in[i]))) return false;
+        s.push_back(in[i]);
+    }
+    if (s.size() % 4 != 0) return false;
+    size_t pads = 0;
+    while (pads < s.size() && s[s.size() - 1 - pads] == '=') pads++;
+    if (pads > 2) return false;
+    for (size_t i = 0; i + pads < s.size(); i++) {
+        if (s[i] == '=') return false;
+    }
+    return true;
+}
+
+CC_FUZZ_TARGET(base64) {
+    size_t expected = decode_base64_length(data, size);
+
+    // Exact-size heap buffer (at least 1 byte so data() is valid)
+    uint8_t* out = (uint8_t*)malloc(expected ? expected : 1);
+    CC_FUZZ_CHECK(out != nullptr);
+    size_t n = decode_base64(data, size, out);
+    CC_FUZZ_CHECK(n == expected);
+
+    std::vector<uint8_t> ref;
+    referenceDecode(data, size, &ref);
+    CC_FUZZ_CHECK(ref.size() == n);
+    CC_FUZZ_CHECK(n == 0 || memcmp(ref.data(), out, n) == 0);
+    free(out);
+
+    uint8_t* buf = (uint8_t*)malloc(size ? size : 1);
+    CC_FUZZ_CHECK(buf != nullptr);
+    if (size) memcpy(buf, data, size);
+    long m = decode_base64_inplace(buf, size);
+    if (referenceStrict(data, size)) {
+        CC_FUZZ_CHECK(m >= 0 && (size_t)m == ref.size());
+        CC_FUZZ_CHECK(m == 0 || memcmp(ref.data(), buf, (size_t)m) == 0);
+    } else {
+        CC_FUZZ_CHECK(m < 0);
+    }
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,205 @@
+/**
+ * CCFirm™ — Fuzz Corpus Replay & Parser Throughput (host, env:native-fuzz-bench)
+ * Part of the Commute Compute System™
+ *
+ * Links the fuzz harnesses (fuzz-bmp.cpp, fuzz-base64.cpp, fuzz-json.cpp,
+ * fuzz-http.cpp, fuzz-model.cpp, fuzz-pages.cpp, fuzz-zonesync.cpp) without libFuzzer and,
+ * for each target:
+ *   1. replays every file in <corpus>/<target>/ once (invariants checked),
+ *   2. optionally runs --mutate N cheap random mutations per file - a smoke
+ *      fuzz for hosts without clang; build with sanitizers to make it count,
+ *   3. times repeated passes over the corpus and prints MB/s + execs/s.
+ *
+ *   program [--corpus fuzz-corpus] [--target bmp|base64|json|http|model|pages|zonesync]
+ *           [--seconds 1] [--mutate 0] [--seed 1]
+ *
+ * One JSON line per target. Crashing mutated inputs are written to
+ * crash-<target>.bin before the check aborts.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <dirent.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fuzz-target.h"
+
+int cc_fuzz_bmp(const uint8_t* data, size_t size);
+int cc_fuzz_base64(const uint8_t* data, size_t size);
+int cc_fuzz_json(const uint8_t* data, size_t size);
+int cc_fuzz_http(const uint8_t* data, size_t size);
+int cc_fuzz_model(const uint8_t* data, size_t size);
+int cc_fuzz_pages(const uint8_t* data, size_t size);
+int cc_fuzz_zonesync(const uint8_t* data, size_t size);
+
+typedef std::chrono::steady_clock Clock;
+typedef int (*FuzzFn)(const uint8_t*, size_t);
+
+struct Target {
+    const char* name;
+    FuzzFn fn;
+};
+
+static const Target TARGETS[] = {
+    { "bmp", cc_fuzz_bmp },
+    { "base64", cc_fuzz_base64 },
+    { "json", cc_fuzz_json },
+    { "http", cc_fuzz_http },
+    { "model", cc_fuzz_model },
+    { "pages", cc_fuzz_pages },
+    { "zonesync", cc_fuzz_zonesync },
+};
+
+// Input being run, saved by the abort handler
+static const char* currentTarget = "";
+static const std::vector<uint8_t>* currentInput = nullptr;
+
+static void onAbort(int sig) {
+    if (currentInput) {
+        char path[64];
+        snprintf(path, sizeof(path), "crash-%s.bin", currentTarget);
+        FILE* f = fopen(path, "wb");
+        if (f) {
+            fwrite(currentInput->data(), 1, currentInput->size(), f);
+            fclose(f);
+            fprintf(stderr, "input written to %s\n", path);
+        }
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>* out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out->insert(out->end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+static std::vector<std::vector<uint8_t> > loadCorpus(const std::string& dir) {
+    std::vector<std::vector<uint8_t> > files;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return files;
+    while (struct dirent* e = readdir(d)) {
+        if (e->d_name[0] == '.') continue;
+        std::vector<uint8_t> data;
+        if (readFile(dir + "/" + e->d_name, &data)) files.push_back(data);
+    }
+    closedir(d);
+    return files;
+}
+
+static void mutate(std::vector<uint8_t>* v, std::mt19937* rng) {
+    int edits = 1 + (int)((*rng)() % 4);
+    for (int i = 0; i < edits; i++) {
+        size_t n = v->size();
+        switch ((*rng)() % 5) {
+            case 0:   // Flip a bit
+                if (n) (*v)[(*rng)() % n] ^= (uint8_t)(1u << ((*rng)() % 8));
+                break;
+            case 1:   // Interesting byte
+                if (n) {
+                    static const uint8_t special[] = { 0x00, 0xFF, 0x7F, 0x80, '"', '\\', '=', 'u' };
+                    (*v)[(*rng)() % n] = special[(*rng)() % sizeof(special)];
+                }
+                break;
+            case 2:   // Truncate
+                if (n) v->resize((*rng)() % n);
+                break;
+            case 3:   // Insert a random byte
+                v->insert(v->begin() + (n ? (*rng)() % (n + 1) : 0), (uint8_t)(*rng)());
+                break;
+            default:  // Overwrite a little-endian u32 (BMP header fields)
+                if (n >= 4) {
+                    size_t at = (*rng)() % (n - 3);
+                    uint32_t val = (*rng)() % 2 ? (uint32_t)(*rng)() : 0xFFFFFFFFu - (*rng)() % 64;
+                    for (int b = 0; b < 4; b++) (*v)[at + b] = (uint8_t)(val >> (8 * b));
+                }
+                break;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string corpus = "fuzz-corpus";
+    const char* only = nullptr;
+    double seconds = 1.0;
+    long mutations = 0;
+    unsigned seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--corpus") == 0) corpus = argv[i + 1];
+        else if (strcmp(argv[i], "--target") == 0) only = argv[i + 1];
+        else if (strcmp(argv[i], "--seconds") == 0) seconds = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--mutate") == 0) mutations = atol(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned)strtoul(argv[i + 1], nullptr, 10);
+    }
+    signal(SIGABRT, onAbort);
+    signal(SIGSEGV, onAbort);
+
+    int ran = 0;
+    for (size_t t = 0; t < sizeof(TARGETS) / sizeof(TARGETS[0]); t++) {
+        const Target& target = TARGETS[t];
+        if (only && strcmp(only, target.name) != 0) continue;
+        std::vector<std::vector<uint8_t> > files = loadCorpus(corpus + "/" + target.name);
+        if (files.empty()) {
+            fprintf(stderr, "%s: no corpus in %s/%s\n", target.name, corpus.c_str(), target.name);
+            return 1;
+        }
+        currentTarget = target.name;
+        ran++;
+
+        // 1. Replay
+        size_t corpusBytes = 0;
+        for (size_t f = 0; f < files.size(); f++) {
+            currentInput = &files[f];
+            target.fn(files[f].data(), files[f].size());
+            corpusBytes += files[f].size();
+        }
+
+        // 2. Mutation smoke fuzz
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> work;
+        for (long m = 0; m < mutations; m++) {
+            for (size_t f = 0; f < files.size(); f++) {
+                work = files[f];
+                mutate(&work, &rng);
+                currentInput = &work;
+                target.fn(work.data(), work.size());
+            }
+        }
+        currentInput = nullptr;
+
+        // 3. Throughput over the corpus
+        uint64_t passes = 0;
+        double elapsed = 0;
+        Clock::time_point t0 = Clock::now();
+        do {
+            for (size_t f = 0; f < files.size(); f++) target.fn(files[f].data(), files[f].size());
+            passes++;
+            elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+        } while (elapsed < seconds);
+
+        double mb = (double)corpusBytes * passes / (1024.0 * 1024.0);
+        printf("{\"target\":\"%s\",\"files\":%zu,\"bytes\":%zu,\"mutations\":%ld,\"passes\":%llu,"
+               "\"seconds\":%.3f,\"mbPerSec\":%.2f,\"execsPerSec\":%.0f}\n",
+               target.name, files.size(), corpusBytes, mutations * (long)files.size(),
+               (unsigned long long)passes, elapsed, mb / elapsed, files.size() * passes / elapsed);
+    }
+    if (ran == 0) {
+        fprintf(stderr, "unknown target: %s\n", only ? only : "");
+        return 2;
+    }
+    return 0;
+}
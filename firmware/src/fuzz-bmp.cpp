@@ -0,0 +1,78 @@
+/**
+ * CCFirm™ — BMP Parser/Blitter Fuzz Harness (host, env:native-fuzz-bmp)
+ * Part of the Commute Compute System™
+ *
+ * Input: byte 0 picks the chunk size, the rest is the BMP file.
+ *
+ * The file is decoded twice - streamed through bmp_stream_feed() in chunks
+ * (main.cpp's fetch path) and checked whole with bmp_image_check() then
+ * blitted row by row via bmp_image_row() (main-v7 / main-ble) - and the two
+ * must agree: same verdict, and the same pixels when both accept it.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include "fuzz-target.h"
+#include "bmp-stream.h"
+
+#define FUZZ_FB_WIDTH  ROW_SINK_MAX_WIDTH
+#define FUZZ_FB_HEIGHT 480
+#define FUZZ_FB_STRIDE (FUZZ_FB_WIDTH / 8)
+
+static uint8_t streamPixels[FUZZ_FB_STRIDE * FUZZ_FB_HEIGHT];
+static uint8_t blitPixels[FUZZ_FB_STRIDE * FUZZ_FB_HEIGHT];
+
+CC_FUZZ_TARGET(bmp) {
+    if (size < 1) return 0;
+    size_t chunk = (size_t)(data[0] % 64) + 1;
+    const uint8_t* bmp = data + 1;
+    size_t len = size - 1;
+
+    // Streamed decode
+    FrameBuffer fbStream = { streamPixels, FUZZ_FB_WIDTH, FUZZ_FB_HEIGHT, FUZZ_FB_STRIDE };
+    memset(streamPixels, 0xFF, sizeof(streamPixels));
+    FrameBufferSink fs;
+    RowSink sink = fbsink_make(&fs, &fbStream);
+    static BmpStream stream;
+    bmp_stream_init(&stream, &sink, 0, 0);
+    int streamed = BMP_STREAM_MORE;
+    for (size_t off = 0; off < len && streamed == BMP_STREAM_MORE; off += chunk) {
+        size_t n = len - off < chunk ? len - off : chunk;
+        streamed = bmp_stream_feed(&stream, bmp + off, n);
+    }
+
+    // Whole-buffer check
+    BmpInfo info;
+    int checked = bmp_image_check(bmp, len, &info);
+
+    if (streamed == BMP_STREAM_MORE) {
+        CC_FUZZ_CHECK(checked == BMP_STREAM_ERR_TRUNCATED);
+        return 0;
+    }
+    if (streamed == BMP_STREAM_ERR_SINK) {
+        // Larger than the framebuffer; the buffer may or may not hold it all
+        CC_FUZZ_CHECK(checked == BMP_STREAM_DONE || checked == BMP_STREAM_ERR_TRUNCATED);
+        return 0;
+    }
+    CC_FUZZ_CHECK(checked == streamed);
+    if (checked != BMP_STREAM_DONE) return 0;
+
+    CC_FUZZ_CHECK(bmp_stream_expected_size(&stream) <= len);
+    CC_FUZZ_CHECK(info.width == stream.width && info.height == stream.height);
+
+    // Row-by-row blit of the checked buffer must match the streamed pixels
+    memset(blitPixels, 0xFF, sizeof(blitPixels));
+    uint8_t row[ROW_SINK_MAX_WIDTH / 8 + 4];
+    uint32_t bytes = ((uint32_t)info.width + 7) / 8;
+    for (int32_t y = 0; y < info.height; y++) {
+        memcpy(row, bmp_image_row(bmp, &info, y), bytes);
+        if (info.invert) {
+            for (uint32_t b = 0; b < bytes; b++) row[b] = (uint8_t)~row[b];
+        }
+        fb_copy_bits(blitPixels + (size_t)y * FUZZ_FB_STRIDE, 0, row, info.width);
+    }
+    CC_FUZZ_CHECK(memcmp(streamPixels, blitPixels, sizeof(streamPixels)) == 0);
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * CCFirm™ — HTTP Response Parser Fuzz Harness (host, env:native-fuzz-http)
+ * Part of the Commute Compute System™
+ *
+ * Input: arbitrary bytes treated as what the server sends back on a
+ * keep-alive connection with up to four pipelined requests in flight.
+ *
+ * The responses are read through httplite_receive() twice: once with the
+ * whole input available per read, once a few bytes at a time (split size
+ * taken from the first byte). Every response must come out the same -
+ * status, error, framing and body bytes - whatever the read sizes, the
+ * body callback must see exactly bodyBytes, and headers handed to
+ * onHeader must be NUL-terminated inside the line buffer.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include "fuzz-target.h"
+#include "http-lite.h"
+
+#define FUZZ_HTTP_REQUESTS  4
+
+struct FuzzStream {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    size_t step;
+};
+
+struct FuzzResult {
+    int rc;
+    int64_t contentLength;
+    bool chunked;
+    bool keepAlive;
+    uint32_t bodyBytes;
+    uint16_t headersDropped;
+    std::string body;
+    std::string headers;
+};
+
+static int fuzzRead(void* ctx, uint8_t* buf, size_t len) {
+    FuzzStream* s = (FuzzStream*)ctx;
+    if (s->pos >= s->size) return -1;   // Server closed
+    size_t n = s->size - s->pos;
+    if (n > s->step) n = s->step;
+    if (n > len) n = len;
+    memcpy(buf, s->data + s->pos, n);
+    s->pos += n;
+    return (int)n;
+}
+
+static bool fuzzWrite(void*, const uint8_t*, size_t) {
+    return true;
+}
+
+static char lineBuf[96];
+
+static void fuzzHeader(void* ctx, const char* name, const char* value) {
+    CC_FUZZ_CHECK(name >= lineBuf && name < lineBuf + sizeof(lineBuf));
+    CC_FUZZ_CHECK(value >= lineBuf && value < lineBuf + sizeof(lineBuf));
+    CC_FUZZ_CHECK(strlen(value) < sizeof(lineBuf));
+    std::string& out = ((FuzzResult*)ctx)->headers;
+    out.append(name).append(1, '\0').append(value).append(1, '\n');
+}
+
+static bool fuzzBody(void* ctx, const uint8_t* data, size_t len) {
+    CC_FUZZ_CHECK(len > 0);
+    ((FuzzResult*)ctx)->body.append((const char*)data, len);
+    return true;
+}
+
+static std::vector<FuzzResult> runStream(const uint8_t* data, size_t size, size_t step) {
+    FuzzStream s = { data, size, 0, step };
+    HttpLiteIo io = { fuzzRead, fuzzWrite, &s };
+    HttpLiteConn conn;
+    httplite_conn_init(&conn, io);
+    for (int i = 0; i < FUZZ_HTTP_REQUESTS; i++) {
+        CC_FUZZ_CHECK(httplite_send(&conn, "GET", "example.com", 443, "/api/device/x?format=bmp", nullptr, true) == 0);
+    }
+
+    std::vector<FuzzResult> results;
+    while (conn.inFlight > 0) {
+        FuzzResult res;
+        HttpLiteResponse r;
+        httplite_response_init(&r, lineBuf, sizeof(lineBuf), fuzzHeader, nullptr, &res, false);
+        int rc = httplite_read_headers(&conn, &r);
+        if (rc >= 0) {
+            r.onBody = fuzzBody;
+            rc = httplite_read_body(&conn, &r);
+        }
+        CC_FUZZ_CHECK(s.pos <= size && conn.rxPos <= conn.rxLen && conn.rxLen <= sizeof(conn.rx));
+        CC_FUZZ_CHECK(res.body.size() == r.bodyBytes && r.bodyBytes <= size);
+        CC_FUZZ_CHECK(rc < 0 ? r.phase == HTTP_LITE_FAILED && rc == r.error
+                             : r.phase == HTTP_LITE_DONE && rc == r.status && rc >= 100 && rc <= 599);
+        res.rc = rc;
+        res.contentLength = r.contentLength;
+        res.chunked = r.chunked;
+        res.keepAlive = r.keepAlive;
+        res.bodyBytes = r.bodyBytes;
+        res.headersDropped = r.headersDropped;
+        results.push_back(res);
+        if (rc < 0 || !conn.usable) break;
+    }
+    return results;
+}
+
+CC_FUZZ_TARGET(http) {
+    std::vector<FuzzResult> whole = runStream(data, size, size ? size : 1);
+    std::vector<FuzzResult> split = runStream(data, size, size ? 1 + data[0] % 7 : 1);
+    CC_FUZZ_CHECK(whole.size() == split.size());
+    for (size_t i = 0; i < whole.size(); i++) {
+        const FuzzResult& a = whole[i];
+        const FuzzResult& b = split[i];
+        CC_FUZZ_CHECK(a.rc == b.rc && a.contentLength == b.contentLength && a.chunked == b.chunked);
+        CC_FUZZ_CHECK(a.keepAlive == b.keepAlive && a.bodyBytes == b.bodyBytes && a.body == b.body);
+        CC_FUZZ_CHECK(a.headers == b.headers && a.headersDropped == b.headersDropped);
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * CCFirm™ — JSON Scanner Fuzz Harness (host, env:native-fuzz-json)
+ * Part of the Commute Compute System™
+ *
+ * Input: arbitrary bytes treated as a server JSON reply (not NUL-terminated).
+ *
+ * Walks every token with json_next() - spans must stay inside the input and
+ * the scan must always make progress - then looks up the keys main.cpp
+ * reads with json_get_string() into a small buffer and checks the result
+ * is NUL-terminated at the returned length with no embedded NULs, plus
+ * the numeric/boolean lookups the BYOS client uses.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include "fuzz-target.h"
+#include "json-scan.h"
+
+CC_FUZZ_TARGET(json) {
+    const char* text = (const char*)data;
+
+    JsonScanner s;
+    JsonTok tok;
+    json_scan_init(&s, text, size);
+    size_t lastPos = 0;
+    int tokens = 0;
+    while (json_next(&s, &tok) != JSON_TOK_END) {
+        CC_FUZZ_CHECK(tok.start <= tok.end && tok.end <= size);
+        CC_FUZZ_CHECK(s.pos > lastPos || tok.type == JSON_TOK_ERROR);
+        lastPos = s.pos;
+        if (tok.type == JSON_TOK_ERROR) break;
+        if (tok.type == JSON_TOK_STRING) {
+            // \u0000 and lone surrogates are rejected here, not by json_next()
+            char buf[32];
+            int n = json_string_decode(text + tok.start, tok.end - tok.start, buf, sizeof(buf));
+            if (n >= 0) CC_FUZZ_CHECK(n < (int)sizeof(buf) && buf[n] == '\0');
+        }
+        CC_FUZZ_CHECK(++tokens <= (int)size);
+    }
+
+    static const char* keys[] = { "status", "webhookUrl", "a", "" };
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+        char out[48];
+        memset(out, 'x', sizeof(out));
+        int n = json_get_string(text, size, keys[k], out, sizeof(out));
+        CC_FUZZ_CHECK(n == JSON_GET_MISSING || n == JSON_GET_TOO_LONG || (n >= 0 && n < (int)sizeof(out)));
+        if (n >= 0) CC_FUZZ_CHECK(out[n] == '\0' && strlen(out) == (size_t)n);
+    }
+
+    // Numeric and boolean lookups (BYOS /api/display fields)
+    long rate = 0;
+    if (json_get_long(text, size, "refresh_rate", &rate)) CC_FUZZ_CHECK(rate > -1000000000L && rate < 1000000000L);
+    bool flag = false;
+    json_get_bool(text, size, "update_firmware", &flag);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * CCFirm™ — Data Model Patch Fuzz Harness (host, env:native-fuzz-model)
+ * Part of the Commute Compute System™
+ *
+ * Input: u16le n, then a first message of n bytes and a second message in
+ * the rest - a full model and a patch against it as served by
+ * ?format=model (src/services/model-patch.js).
+ *
+ * The first message is applied to an empty model, the second to the
+ * result. On success the model must hold NUL-terminated strings within
+ * their fields, at most DASHMODEL_MAX_LEGS legs and the version from the
+ * header, and its check must match the message trailer. Every accepted
+ * model is drawn with dash_render_model() on a display that asserts all
+ * drawing stays on the 800x480 screen. A failed apply may leave out
+ * half-written, but never outside the struct.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include "fuzz-target.h"
+#include "dash-template.h"
+
+// Display that only checks coordinates and text
+struct CheckDisplay {
+    int w, h, cx, cy;
+    void fillScreen(uint16_t) {}
+    void fillRect(int x, int y, int rw, int rh, uint16_t) { CC_FUZZ_CHECK(x >= 0 && y >= 0 && x + rw <= w && y + rh <= h); }
+    void drawRect(int x, int y, int rw, int rh, uint16_t c) { fillRect(x, y, rw, rh, c); }
+    void drawLine(int x0, int y0, int x1, int y1, uint16_t) {
+        CC_FUZZ_CHECK(x0 >= 0 && y0 >= 0 && x1 < w && y1 < h);
+    }
+    void setCursor(int x, int y) { cx = x; cy = y; }
+    void setTextColor(uint16_t, uint16_t) {}
+    void print(const char* s) {
+        size_t n = strlen(s);
+        CC_FUZZ_CHECK(cx >= 0 && cy >= 0 && cy + 8 <= h);
+        CC_FUZZ_CHECK(n < 100);
+    }
+};
+
+static void checkModel(const DashModel* m, const uint8_t* msg, size_t len) {
+    CC_FUZZ_CHECK(m->version == (uint16_t)(msg[4] | (msg[5] << 8)));
+    CC_FUZZ_CHECK(m->legCount <= DASHMODEL_MAX_LEGS);
+    DashModel* mm = const_cast<DashModel*>(m);
+    DashModelField f;
+    for (int id = 0; id < 256; id++) {
+        if (!dashmodel_field(mm, (uint8_t)id, &f) || !f.str) continue;
+        CC_FUZZ_CHECK(memchr(f.str, '\0', f.size) != nullptr);
+    }
+    const uint8_t* t = msg + len - 4;
+    uint32_t check = (uint32_t)t[0] | ((uint32_t)t[1] << 8) | ((uint32_t)t[2] << 16) | ((uint32_t)t[3] << 24);
+    CC_FUZZ_CHECK(dashmodel_check(m) == check);
+
+    CheckDisplay d = { 800, 480, 0, 0 };
+    dash_render_model(d, 800, 480, m, DASH_REGION_ALL);
+}
+
+CC_FUZZ_TARGET(model) {
+    if (size < 2) return 0;
+    size_t n = (size_t)(data[0] | (data[1] << 8));
+    if (n > size - 2) n = size - 2;
+    const uint8_t* first = data + 2;
+    const uint8_t* second = first + n;
+    size_t secondLen = size - 2 - n;
+
+    static DashModel empty, current, next;
+    dashmodel_clear(&empty);
+    uint32_t regions;
+    if (dashmodel_apply(&empty, &current, first, n, &regions) != DASHMODEL_OK) return 0;
+    checkModel(&current, first, n);
+
+    int rc = dashmodel_apply(&current, &next, second, secondLen, &regions);
+    if (rc != DASHMODEL_OK) return 0;
+    checkModel(&next, second, secondLen);
+    CC_FUZZ_CHECK((regions & ~DASH_REGION_ALL) == 0);
+    // Applying a message is deterministic and needs nothing but the base
+    DashModel again;
+    uint32_t regionsAgain;
+    CC_FUZZ_CHECK(dashmodel_apply(&current, &again, second, secondLen, &regionsAgain) == DASHMODEL_OK);
+    CC_FUZZ_CHECK(regionsAgain == regions && again.version == next.version &&
+                  dashmodel_check(&again) == dashmodel_check(&next));
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * CCFirm™ — Page Cache Fuzz Harness (host, env:native-fuzz-pages)
+ * Part of the Commute Compute System™
+ *
+ * Input: u8 n, then an X-Pages value of n bytes, then a flash image whose
+ * first half lands at the start of slot 0 and second half at slot 1 (the
+ * rest of the 2-slot region is erased flash).
+ *
+ * A parsed page list must hold 1..PAGE_MAX valid ids and parse the same
+ * again once re-encoded. pagecache_init() over any image may only accept
+ * slots whose frame fits and whose id is unique, and streaming a slot must
+ * succeed exactly when its hash matches. A page is then written over the
+ * image: the flash (NOR semantics - writes only clear bits) must only be
+ * written where it was erased, and after the write and after a re-init the
+ * page must be found once, with the hash of what was written.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "fuzz-target.h"
+#include "page-cache.h"
+
+#define FLASH_SECTOR 4096
+#define FLASH_BYTES  (2 * PAGECACHE_SLOT_BYTES)
+
+static uint8_t flash[FLASH_BYTES];
+
+static bool ramRead(void*, uint32_t addr, void* buf, size_t len) {
+    CC_FUZZ_CHECK(addr + len <= FLASH_BYTES);
+    memcpy(buf, flash + addr, len);
+    return true;
+}
+
+static bool ramWrite(void*, uint32_t addr, const void* buf, size_t len) {
+    CC_FUZZ_CHECK(addr + len <= FLASH_BYTES);
+    const uint8_t* src = (const uint8_t*)buf;
+    for (size_t i = 0; i < len; i++) {
+        CC_FUZZ_CHECK(flash[addr + i] == 0xFF);   // Erased before it is written
+        flash[addr + i] &= src[i];
+    }
+    return true;
+}
+
+static bool ramErase(void*, uint32_t addr, size_t len) {
+    CC_FUZZ_CHECK(addr % FLASH_SECTOR == 0 && len % FLASH_SECTOR == 0 && addr + len <= FLASH_BYTES);
+    memset(flash + addr, 0xFF, len);
+    return true;
+}
+
+static const PageFlash RAM_FLASH = { ramRead, ramWrite, ramErase, nullptr, FLASH_BYTES, FLASH_SECTOR };
+
+static void checkCache(PageCache* pc) {
+    CC_FUZZ_CHECK(pc->slots == 2);
+    for (int i = 0; i < pc->slots; i++) {
+        const PageSlot* s = &pc->slot[i];
+        if (!s->valid) continue;
+        size_t idLen = strlen(s->id);
+        CC_FUZZ_CHECK(idLen >= 1 && idLen <= PAGE_ID_MAX);
+        CC_FUZZ_CHECK(s->len >= 1 && s->len <= PAGECACHE_FRAME_MAX);
+        CC_FUZZ_CHECK(pagecache_find(pc, s->id) == i);   // First and only copy
+    }
+    static uint8_t chunk[1000];
+    for (int i = 0; i < pc->slots; i++) {
+        if (!pc->slot[i].valid) continue;
+        const uint8_t* frame = flash + pagecache_slot_addr(i) + PAGECACHE_HEADER_BYTES;
+        bool match = pagecache_fnv(0x811c9dc5u, frame, pc->slot[i].len) == pc->slot[i].hash;
+        bool ok = pagecache_stream(pc, i, chunk, sizeof(chunk), nullptr, nullptr);
+        CC_FUZZ_CHECK(ok == match && ok == pc->slot[i].valid);
+    }
+}
+
+CC_FUZZ_TARGET(pages) {
+    if (size < 1) return 0;
+    size_t n = data[0];
+    if (n > size - 1) n = size - 1;
+    char value[256];
+    memcpy(value, data + 1, n);
+    value[n] = '\0';
+    const uint8_t* image = data + 1 + n;
+    size_t imageLen = size - 1 - n;
+
+    // Page list
+    static PageList list, again;
+    if (page_list_parse(value, &list)) {
+        CC_FUZZ_CHECK(list.count >= 1 && list.count <= PAGE_MAX);
+        char encoded[PAGE_MAX * 24];
+        size_t o = 0;
+        for (int i = 0; i < list.count; i++) {
+            size_t idLen = strlen(list.page[i].id);
+            CC_FUZZ_CHECK(idLen >= 1 && idLen <= PAGE_ID_MAX);
+            CC_FUZZ_CHECK(page_list_find(&list, list.page[i].id) <= i);
+            o += (size_t)snprintf(encoded + o, sizeof(encoded) - o, "%s%s=%lu", i ? "," : "",
+                                  list.page[i].id, (unsigned long)list.page[i].maxAge);
+        }
+        CC_FUZZ_CHECK(page_list_parse(encoded, &again) && again.count == list.count);
+        for (int i = 0; i < list.count; i++) {
+            CC_FUZZ_CHECK(strcmp(again.page[i].id, list.page[i].id) == 0 &&
+                          again.page[i].maxAge == list.page[i].maxAge);
+        }
+    } else {
+        CC_FUZZ_CHECK(list.count == 0);
+    }
+
+    // Cache over the image
+    memset(flash, 0xFF, sizeof(flash));
+    size_t half = imageLen / 2;
+    size_t first = half < PAGECACHE_SLOT_BYTES ? half : PAGECACHE_SLOT_BYTES;
+    size_t second = imageLen - half < PAGECACHE_SLOT_BYTES ? imageLen - half : PAGECACHE_SLOT_BYTES;
+    memcpy(flash, image, first);
+    memcpy(flash + PAGECACHE_SLOT_BYTES, image + half, second);
+
+    static PageCache pc;
+    CC_FUZZ_CHECK(pagecache_init(&pc, &RAM_FLASH) == 2);
+    checkCache(&pc);
+
+    // Write a page over it: the image doubles as the frame
+    const char* id = list.count > 0 ? list.page[0].id : "p";
+    size_t frameLen = imageLen < 3000 ? imageLen : 3000;
+    if (frameLen == 0) return 0;
+    int slot = pagecache_slot_for(&pc, id);
+    CC_FUZZ_CHECK(slot >= 0 && slot < 2);
+    CC_FUZZ_CHECK(pagecache_write_begin(&pc, slot));
+    for (size_t off = 0; off < frameLen;) {
+        size_t part = 1 + (image[off] % 700);
+        if (part > frameLen - off) part = frameLen - off;
+        CC_FUZZ_CHECK(pagecache_write(&pc, image + off, part));
+        off += part;
+    }
+    CC_FUZZ_CHECK(pagecache_write_end(&pc, id, 1000) == slot);
+    uint32_t hash = pagecache_fnv(0x811c9dc5u, image, frameLen);
+    CC_FUZZ_CHECK(pagecache_find(&pc, id) == slot && pc.slot[slot].hash == hash && pc.slot[slot].len == frameLen);
+    checkCache(&pc);
+
+    // As the next boot sees it
+    CC_FUZZ_CHECK(pagecache_init(&pc, &RAM_FLASH) == 2);
+    CC_FUZZ_CHECK(pagecache_find(&pc, id) == slot && pc.slot[slot].hash == hash);
+    checkCache(&pc);
+    return 0;
+}
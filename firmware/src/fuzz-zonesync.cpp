@@ -0,0 +1,102 @@
+/**
+ * CCFirm™ — Zone Sync Fuzz Harness (host, env:native-fuzz-zonesync)
+ * Part of the Commute Compute System™
+ *
+ * Input: u8 n, then an X-Zone-Hashes value of n bytes, then a CCZF delta
+ * body as the zone endpoint sends it.
+ *
+ * zonesync_decode() must leave the vector untouched when it fails, and
+ * otherwise hold at most ZONE_SYNC_MAX hashes that decode the same again
+ * once re-encoded. The body is decoded twice onto a small screen: through
+ * ZoneBmpSink, with each zone BMP it hands to the draw callback copied
+ * into a framebuffer the way loadBMP() would place it, and straight into a
+ * second framebuffer. When the body decodes cleanly both must match, and
+ * every zone must have been drawn exactly once.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include "fuzz-target.h"
+#include "zone-sync.h"
+#include "frame-codec.h"
+
+#define SCREEN_W 256
+#define SCREEN_H 96
+#define SCREEN_STRIDE (SCREEN_W / 8)
+
+static uint8_t viaZones[SCREEN_STRIDE * SCREEN_H];
+static uint8_t direct[SCREEN_STRIDE * SCREEN_H];
+static uint8_t zoneBuf[BMP_SHADOW_HEADER + SCREEN_STRIDE * SCREEN_H];
+
+// ZoneDrawFn: check the BMP is what bmp_shadow_init() promised and blit it
+static bool placeZone(void* ctx, const uint8_t* bmp, int x, int y, int w, int h) {
+    FrameBuffer* screen = (FrameBuffer*)ctx;
+    BmpInfo info;
+    CC_FUZZ_CHECK(bmp_image_check(bmp, sizeof(zoneBuf), &info) == BMP_STREAM_DONE && !info.invert);
+    CC_FUZZ_CHECK(info.width == w && info.height == h && x + w <= SCREEN_W && y + h <= SCREEN_H);
+    FrameBufferSink fs;
+    RowSink sink = fbsink_make(&fs, screen);
+    CC_FUZZ_CHECK(sink.begin(sink.ctx, x, y, w, h));
+    for (int row = 0; row < h; row++) CC_FUZZ_CHECK(sink.row(sink.ctx, y + row, bmp_image_row(bmp, &info, row), w));
+    sink.end(sink.ctx, true);
+    return true;
+}
+
+static int decodeInto(const uint8_t* body, size_t len, const RowSink* sink, uint32_t* zones) {
+    FrameDecoder dec;
+    frame_decoder_init(&dec, sink, SCREEN_W, SCREEN_H);
+    // Split the body like a network read would
+    int rc = FRAME_OK;
+    for (size_t off = 0; off < len && rc == FRAME_OK;) {
+        size_t part = 1 + (body[off] % 97);
+        if (part > len - off) part = len - off;
+        rc = frame_decoder_feed(&dec, body + off, part);
+        off += part;
+    }
+    *zones = dec.zonesDone;
+    return rc == FRAME_OK && dec.headerLen == 0 ? FRAME_OK : (rc ? rc : FRAME_ERR_DATA);
+}
+
+CC_FUZZ_TARGET(zonesync) {
+    if (size < 1) return 0;
+    size_t n = data[0];
+    if (n > size - 1) n = size - 1;
+    const char* value = (const char*)data + 1;
+    const uint8_t* body = data + 1 + n;
+    size_t bodyLen = size - 1 - n;
+
+    // Hash vector
+    ZoneHashes z, again;
+    memset(&z, 0xA5, sizeof(z));
+    ZoneHashes before = z;
+    if (zonesync_decode(value, n, &z)) {
+        CC_FUZZ_CHECK(z.count <= ZONE_SYNC_MAX);
+        char encoded[ZONE_SYNC_TEXT_MAX];
+        size_t len = zonesync_encode(&z, encoded, sizeof(encoded));
+        CC_FUZZ_CHECK(len > 0 && zonesync_decode(encoded, len, &again) && again.count == z.count);
+        CC_FUZZ_CHECK(memcmp(again.hash, z.hash, z.count * sizeof(z.hash[0])) == 0);
+    } else {
+        CC_FUZZ_CHECK(memcmp(&before, &z, sizeof(z)) == 0);
+    }
+
+    // Delta body
+    FrameBuffer zonesFb = { viaZones, SCREEN_W, SCREEN_H, SCREEN_STRIDE };
+    FrameBuffer directFb = { direct, SCREEN_W, SCREEN_H, SCREEN_STRIDE };
+    memset(viaZones, 0x5A, sizeof(viaZones));
+    memset(direct, 0x5A, sizeof(direct));
+
+    ZoneBmpSink zs;
+    RowSink zoneSink = zonebmp_make(&zs, zoneBuf, sizeof(zoneBuf), placeZone, &zonesFb);
+    FrameBufferSink fs;
+    RowSink directSink = fbsink_make(&fs, &directFb);
+    uint32_t zonesA, zonesB;
+    int a = decodeInto(body, bodyLen, &zoneSink, &zonesA);
+    int b = decodeInto(body, bodyLen, &directSink, &zonesB);
+
+    CC_FUZZ_CHECK(zs.zonesDrawn == zonesA && !zs.drawFailed);
+    CC_FUZZ_CHECK(a == b && zonesA == zonesB);
+    if (a == FRAME_OK) CC_FUZZ_CHECK(memcmp(viaZones, direct, sizeof(direct)) == 0);
+    return 0;
+}
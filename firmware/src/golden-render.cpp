@@ -0,0 +1,122 @@
+/**
+ * CCFirm™ — Device Render for Golden Tests (host, env:native-golden)
+ * Part of the Commute Compute System™
+ *
+ * Renders the device-side dashboard (dash-template.h) into a FakeBBEPAPER
+ * and writes the 1-bit BMP, so tests/test-golden-render.js can compare it
+ * with the server's ccdash-renderer.js output for the same journey
+ * fixture. Either the offline dashboard from a timetable slice, or the
+ * live one CC_LOCAL_RENDER draws from a full data model (?format=model);
+ * both go through SinkDisplay into the frame as they do on the device:
+ *
+ *   program --slice slice.bin --now <unix> [--last-live <unix>]
+ *           [--out device.bmp] [--repeat N] [--width 800 --height 480]
+ *   program --model model.bin [--out device.bmp] [--repeat N] [...]
+ *
+ * Prints one JSON line: render timings (microseconds, host) and the plan.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "timetable-slice.h"
+#include "dash-template.h"
+#include "fake-bbepaper.h"
+#include "sink-display.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static bool readFile(const char* path, std::vector<uint8_t>* out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out->insert(out->end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* slicePath = nullptr;
+    const char* modelPath = nullptr;
+    const char* outPath = nullptr;
+    uint32_t nowUnix = 0, lastLiveUnix = 0;
+    int repeat = 20, width = 800, height = 480;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--slice") == 0) slicePath = argv[i + 1];
+        else if (strcmp(argv[i], "--model") == 0) modelPath = argv[i + 1];
+        else if (strcmp(argv[i], "--out") == 0) outPath = argv[i + 1];
+        else if (strcmp(argv[i], "--now") == 0) nowUnix = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--last-live") == 0) lastLiveUnix = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--repeat") == 0) repeat = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--width") == 0) width = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--height") == 0) height = atoi(argv[i + 1]);
+    }
+    if ((modelPath ? slicePath != nullptr : !slicePath || nowUnix == 0) || width <= 0 || height <= 0) {
+        fprintf(stderr, "usage: %s --slice slice.bin --now <unix> [--last-live <unix>] [--out device.bmp] [--repeat N]\n"
+                        "       %s --model model.bin [--out device.bmp] [--repeat N]\n", argv[0], argv[0]);
+        return 2;
+    }
+    if (repeat < 1) repeat = 1;
+
+    std::vector<uint8_t> raw;
+    TimetableSlice slice;
+    DashModel model;
+    if (modelPath) {
+        static const DashModel empty = {};
+        uint32_t regions;
+        if (!readFile(modelPath, &raw) || raw.size() > DASHMODEL_MAX_BYTES ||
+            dashmodel_apply(&empty, &model, raw.data(), raw.size(), &regions) != DASHMODEL_OK) {
+            fprintf(stderr, "invalid model: %s\n", modelPath);
+            return 1;
+        }
+    } else if (!readFile(slicePath, &raw) || raw.size() > SLICE_MAX_BYTES ||
+               !slice_parse(raw.data(), raw.size(), &slice)) {
+        fprintf(stderr, "invalid slice: %s\n", slicePath);
+        return 1;
+    }
+
+    FakeBBEPAPER display(width, height);
+    FrameBuffer frame = display.frame();
+    FrameBufferSink frameState;
+    RowSink frameSink = fbsink_make(&frameState, &frame);
+    SinkDisplay sinkDisplay(&frameSink, width, height);
+    std::vector<double> us;
+    SlicePlan plan = {};
+    for (int i = 0; i < repeat; i++) {
+        Clock::time_point t0 = Clock::now();
+        if (modelPath) {
+            // Same work as a full model in fetchModelUpdate(): every region
+            sinkDisplay.fillScreen(DASH_WHITE);
+            dash_render_model(sinkDisplay, width, height, &model, DASH_REGION_ALL);
+        } else {
+            // Same work as renderOfflineDashboard() in main.cpp: plan + draw
+            slice_plan(&slice, nowUnix, &plan);
+            dash_render_offline(sinkDisplay, width, height, &slice, &plan, nowUnix, lastLiveUnix);
+        }
+        us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+    }
+
+    if (outPath && !display.writeBMP(outPath)) {
+        fprintf(stderr, "cannot write %s\n", outPath);
+        return 1;
+    }
+
+    std::sort(us.begin(), us.end());
+    double sum = 0;
+    for (double v : us) sum += v;
+    printf("{\"width\":%d,\"height\":%d,\"renderer\":\"%s\",\"legs\":%d,\"planValid\":%s,\"leaveInMinutes\":%d,"
+           "\"repeat\":%d,\"renderUs\":{\"min\":%.1f,\"median\":%.1f,\"mean\":%.1f,\"max\":%.1f}}\n",
+           width, height, modelPath ? "model" : "offline", modelPath ? (int)model.legCount : slice.legCount,
+           plan.valid ? "true" : "false", plan.leaveInMinutes,
+           repeat, us.front(), us[us.size() / 2], sum / us.size(), us.back());
+    return 0;
+}
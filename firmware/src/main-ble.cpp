@@ -29,6 +29,7 @@
 #include "soc/rtc_cntl_reg.h"
 #include "../include/config.h"
 #include "../include/cc-logo-draw.h"
+#include "../include/bmp-stream.h"
 
 // ============================================================================
 // CONFIGURATION
@@ -783,19 +784,28 @@ bool fetchAndDrawZone(const ZoneDef& zone, bool flash) {
         return false;
     }
 
-    // Draw zone to display
-    // BMP data starts at offset 62 for 1-bit BMPs
-    int dataOffset = 62;
-    if (len > dataOffset) {
-        bbep.drawBitmap(
-            zone.x, zone.y,
-            zoneBuffer + dataOffset,
-            zone.w, zone.h,
-            0x00, 0xFF,
-            flash ? BB_FLIP_V : (BB_FLIP_V | BB_NO_FLASH)
-        );
+    // Validate before drawing: pixel offset from the header (not a fixed
+    // 62), zone-sized, and rows packed the way drawBitmap() reads them
+    BmpInfo bmp;
+    int check = bmp_image_check(zoneBuffer, bytesRead, &bmp);
+    if (check != BMP_STREAM_DONE || bmp.width != zone.w || bmp.height != zone.h ||
+        bmp.stride != (uint32_t)(zone.w + 7) / 8) {
+        Serial.printf("[Fetch] Zone %s: bad BMP (%d, %dx%d)\n", zone.id, check,
+                      check == BMP_STREAM_DONE ? (int)bmp.width : 0,
+                      check == BMP_STREAM_DONE ? (int)bmp.height : 0);
+        return false;
     }
 
+    int flags = bmp.topDown ? 0 : BB_FLIP_V;
+    if (!flash) flags |= BB_NO_FLASH;
+    bbep.drawBitmap(
+        zone.x, zone.y,
+        zoneBuffer + bmp.pixelOffset,
+        zone.w, zone.h,
+        bmp.invert ? 0xFF : 0x00, bmp.invert ? 0x00 : 0xFF,
+        flags
+    );
+
     Serial.printf("[Fetch] Zone %s OK (%d bytes)\n", zone.id, len);
     return true;
 }
@@ -0,0 +1,397 @@
+/**
+ * CCFirm™ — TRMNL BYOS Client (env:ccfirm-trmnl-byos)
+ * Part of the Commute Compute System™
+ *
+ * Runs a TRMNL against any server that speaks the TRMNL "bring your own
+ * server" protocol (including this one). Each wake-up:
+ *   1. GET /api/setup once to obtain an api_key (kept in NVS)
+ *   2. GET /api/display -> image_url, filename, refresh_rate
+ *   3. if the image key (filename, else image_url) differs from the one on
+ *      the panel, stream the BMP through bmp_stream_feed() into the shadow
+ *      framebuffer and draw it - otherwise skip the download entirely
+ *   4. deep sleep so the next wake-up is refresh_rate seconds after this one
+ *
+ * WiFi credentials and the server URL are the ones the main firmware
+ * provisions (NVS "cc-device"), or -D BYOS_WIFI_SSID / BYOS_WIFI_PASSWORD /
+ * BYOS_SERVER_URL for a bench device. Protocol state lives in
+ * include/byos-client.h.
+ *
+ * Replaces tools/setup-wizard/firmware/trmnl-byos.ino.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <Preferences.h>
+#include <nvs_flash.h>
+#include <bb_epaper.h>
+#include <esp_attr.h>
+#include <esp_sleep.h>
+#include "soc/soc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "../include/config.h"
+#include "../include/row-sink.h"
+#include "../include/bmp-stream.h"
+#include "../include/json-scan.h"
+#include "../include/byos-client.h"
+#include "../include/log-ring.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#ifdef BOARD_TRMNL_MINI
+  #define PANEL_TYPE EP583R_600x448
+#else
+  #define PANEL_TYPE EP75_800x480
+#endif
+
+#ifndef BYOS_WIFI_SSID
+#define BYOS_WIFI_SSID ""
+#endif
+#ifndef BYOS_WIFI_PASSWORD
+#define BYOS_WIFI_PASSWORD ""
+#endif
+#ifndef BYOS_SERVER_URL
+#define BYOS_SERVER_URL ""
+#endif
+
+#define FRAME_BMP_MAX_SIZE 50000      // Shadow BMP: 62 B header + 800x480 1-bit
+#define DISPLAY_JSON_MAX 4096         // /api/display reply; keys past this are ignored
+#define BYOS_HTTP_TIMEOUT_MS 20000
+#define BYOS_WIFI_TIMEOUT_MS 15000
+
+// ============================================================================
+// GLOBALS
+// ============================================================================
+
+BBEPAPER* bbep = nullptr;
+Preferences preferences;
+
+char wifiSSID[64] = "";
+char wifiPassword[64] = "";
+char serverUrl[256] = "";
+char apiKey[64] = "";
+char macAddress[18] = "";
+
+// Survives deep sleep: last drawn image, partial count, error streak
+RTC_NOINIT_ATTR ByosCache rtcByos;
+
+// Shadow framebuffer the image is streamed into before loadBMP() draws it
+uint8_t* frameBmp = nullptr;
+FrameBuffer shadowFb;
+FrameBufferSink shadowSinkState;
+RowSink shadowSink;
+
+char displayJson[DISPLAY_JSON_MAX];
+ByosDisplay display;
+
+// ============================================================================
+// SETTINGS
+// ============================================================================
+
+static void copySetting(char* dst, size_t size, const String& nvs, const char* buildFlag) {
+    const char* src = buildFlag[0] ? buildFlag : nvs.c_str();
+    strncpy(dst, src, size - 1);
+    dst[size - 1] = '\0';
+}
+
+void loadSettings() {
+    // Same namespace and keys as main.cpp, so a provisioned device can be
+    // reflashed with this build without setting it up again
+    preferences.begin("cc-device", true);
+    copySetting(wifiSSID, sizeof(wifiSSID), preferences.getString("wifi_ssid", ""), BYOS_WIFI_SSID);
+    copySetting(wifiPassword, sizeof(wifiPassword), preferences.getString("wifi_pass", ""), BYOS_WIFI_PASSWORD);
+    copySetting(serverUrl, sizeof(serverUrl), preferences.getString("serverUrl", ""), BYOS_SERVER_URL);
+    preferences.end();
+
+    preferences.begin("cc-byos", true);
+    copySetting(apiKey, sizeof(apiKey), preferences.getString("api_key", ""), "");
+    preferences.end();
+
+    // Strip a trailing slash so paths can be appended
+    size_t n = strlen(serverUrl);
+    if (n > 0 && serverUrl[n - 1] == '/') serverUrl[n - 1] = '\0';
+}
+
+void saveApiKey() {
+    preferences.begin("cc-byos", false);
+    preferences.putString("api_key", apiKey);
+    preferences.end();
+}
+
+// ============================================================================
+// DISPLAY
+// ============================================================================
+
+void initDisplay() {
+    bbep = new BBEPAPER(PANEL_TYPE);
+    bbep->initIO(EPD_DC_PIN, EPD_RST_PIN, EPD_BUSY_PIN, EPD_CS_PIN, EPD_MOSI_PIN, EPD_SCK_PIN, 0);
+    bbep->setPanelType(PANEL_TYPE);
+    bbep->setRotation(0);
+
+    // DO NOT call allocBuffer() - breaks ESP32-C3! (see DEVELOPMENT-RULES.md 5.4)
+    // The panel is not cleared: it keeps showing the last image across sleep
+}
+
+// ============================================================================
+// NETWORK
+// ============================================================================
+
+bool connectWiFi() {
+    if (strlen(wifiSSID) == 0) return false;
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(wifiSSID, wifiPassword);
+
+    unsigned long start = millis();
+    while (WiFi.status() != WL_CONNECTED && millis() - start < BYOS_WIFI_TIMEOUT_MS) {
+        delay(100);
+    }
+    return WiFi.status() == WL_CONNECTED;
+}
+
+// TRMNL OG: battery on a 1:2 divider
+static float batteryVolts() {
+    return analogReadMilliVolts(PIN_BATTERY) * 2 / 1000.0f;
+}
+
+static void addDeviceHeaders(HTTPClient& http, uint32_t refreshRateS) {
+    char value[16];
+    http.addHeader("ID", macAddress);
+    if (apiKey[0]) http.addHeader("Access-Token", apiKey);
+    snprintf(value, sizeof(value), "%u", (unsigned)refreshRateS);
+    http.addHeader("Refresh-Rate", value);
+    snprintf(value, sizeof(value), "%.2f", batteryVolts());
+    http.addHeader("Battery-Voltage", value);
+    http.addHeader("FW-Version", FIRMWARE_VERSION);
+    snprintf(value, sizeof(value), "%d", (int)WiFi.RSSI());
+    http.addHeader("RSSI", value);
+    snprintf(value, sizeof(value), "%d", SCREEN_W);
+    http.addHeader("Width", value);
+    snprintf(value, sizeof(value), "%d", SCREEN_H);
+    http.addHeader("Height", value);
+}
+
+/**
+ * GET serverUrl + path into displayJson (NUL-terminated, truncated at
+ * DISPLAY_JSON_MAX - 1). Returns the HTTP status, or < 0 on failure.
+ */
+int getJson(const char* path, size_t* outLen) {
+    char url[sizeof(serverUrl) + 32];
+    snprintf(url, sizeof(url), "%s%s", serverUrl, path);
+
+    WiFiClientSecure client;
+    client.setInsecure();
+    HTTPClient http;
+    http.setTimeout(BYOS_HTTP_TIMEOUT_MS);
+    http.useHTTP10(true);   // No chunked encoding, the body is read raw
+    if (!http.begin(client, url)) return -1;
+    addDeviceHeaders(http, rtcByos.refreshRateS);
+
+    int code = http.GET();
+    size_t n = 0;
+    if (code == 200) {
+        WiFiClient* stream = http.getStreamPtr();
+        int len = http.getSize();
+        size_t want = (len >= 0 && (size_t)len < sizeof(displayJson) - 1) ? (size_t)len : sizeof(displayJson) - 1;
+        while (n < want) {
+            size_t got = stream->readBytes((uint8_t*)displayJson + n, want - n);
+            if (got == 0) break;  // Timeout or connection closed
+            n += got;
+        }
+    }
+    displayJson[n] = '\0';
+    *outLen = n;
+    http.end();
+    return code;
+}
+
+/** One-time registration: /api/setup returns the api_key for this MAC */
+bool registerDevice() {
+    size_t len = 0;
+    int code = getJson("/api/setup", &len);
+    if (code != 200) {
+        CCLOG_E("[BYOS] setup HTTP %d", code);
+        return false;
+    }
+    if (json_get_string(displayJson, len, "api_key", apiKey, sizeof(apiKey)) <= 0) {
+        apiKey[0] = '\0';
+        CCLOG_E("[BYOS] setup: no api_key");
+        return false;
+    }
+    saveApiKey();
+    CCLOG_I("[BYOS] Registered %s", macAddress);
+    return true;
+}
+
+/**
+ * Stream image_url into the shadow framebuffer (rows are validated as they
+ * arrive) and draw it. Returns true once the panel shows the new image.
+ */
+bool drawImage(const char* url) {
+    WiFiClientSecure client;
+    client.setInsecure();
+    HTTPClient http;
+    http.setTimeout(BYOS_HTTP_TIMEOUT_MS);
+    http.useHTTP10(true);
+    if (!http.begin(client, url)) return false;
+
+    unsigned long start = millis();
+    int code = http.GET();
+    if (code != 200) {
+        CCLOG_E("[BYOS] image HTTP %d", code);
+        http.end();
+        return false;
+    }
+
+    // Length may be unknown (-1): read until the BMP is complete
+    WiFiClient* stream = http.getStreamPtr();
+    int remaining = http.getSize();
+    BmpStream bmp;
+    bmp_stream_init(&bmp, &shadowSink, 0, 0);
+    uint8_t chunk[512];
+    int result = BMP_STREAM_MORE;
+    size_t total = 0;
+    while (result == BMP_STREAM_MORE && remaining != 0) {
+        size_t want = (remaining > 0 && remaining < (int)sizeof(chunk)) ? (size_t)remaining : sizeof(chunk);
+        size_t got = stream->readBytes(chunk, want);
+        if (got == 0) break;  // Timeout
+        if (remaining > 0) remaining -= got;
+        total += got;
+        result = bmp_stream_feed(&bmp, chunk, got);
+    }
+    http.end();
+
+    if (result != BMP_STREAM_DONE) {
+        CCLOG_E("[BYOS] BMP stream failed: %d after %u B", result, (unsigned)total);
+        return false;
+    }
+    CCLOG_I("[BYOS] %u B in %lu ms", (unsigned)total, millis() - start);
+
+    if (bbep->loadBMP(frameBmp, 0, 0, BBEP_BLACK, BBEP_WHITE) != BBEP_SUCCESS) {
+        CCLOG_E("[BYOS] loadBMP failed");
+        return false;
+    }
+
+    bool full = rtcByos.imageKeyLen == 0 || rtcByos.partialCount >= MAX_PARTIAL_BEFORE_FULL;
+    bbep->refresh(full ? REFRESH_FULL : REFRESH_PARTIAL, true);
+    rtcByos.partialCount = full ? 0 : rtcByos.partialCount + 1;
+    return true;
+}
+
+// ============================================================================
+// CYCLE
+// ============================================================================
+
+/** One wake-up's work. Returns false if it should be retried early. */
+bool runCycle() {
+    if (strlen(serverUrl) == 0) {
+        CCLOG_E("[BYOS] No server URL");
+        return false;
+    }
+    if (!connectWiFi()) {
+        CCLOG_E("[BYOS] WiFi failed");
+        return false;
+    }
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(macAddress, sizeof(macAddress), "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+    if (!apiKey[0] && !registerDevice()) return false;
+
+    size_t len = 0;
+    int code = getJson("/api/display", &len);
+    if (code == 401 || code == 404) {
+        // Server no longer knows this key - register again next cycle
+        apiKey[0] = '\0';
+        saveApiKey();
+    }
+    if (code != 200) {
+        CCLOG_E("[BYOS] display HTTP %d", code);
+        return false;
+    }
+
+    int parsed = byos_parse_display(displayJson, len, &display);
+    rtcByos.refreshRateS = display.refreshRateS;
+    if (display.resetFirmware) {
+        CCLOG_W("[BYOS] reset_firmware - clearing api_key");
+        apiKey[0] = '\0';
+        saveApiKey();
+        byos_image_forget(&rtcByos);
+    }
+    if (display.updateFirmware) CCLOG_W("[BYOS] update_firmware ignored (no OTA in this build)");
+    if (parsed != BYOS_OK) {
+        CCLOG_E("[BYOS] display reply %d (status %ld)", parsed, display.status);
+        return false;
+    }
+
+    if (!byos_image_changed(&rtcByos, &display)) {
+        CCLOG_I("[BYOS] Unchanged (%s), next in %u s", byos_image_key(&display), (unsigned)display.refreshRateS);
+        return true;
+    }
+    if (!frameBmp || !drawImage(display.imageUrl)) return false;
+    byos_image_drawn(&rtcByos, &display);
+    return true;
+}
+
+void sleepUntilNext(bool ok) {
+    if (ok) {
+        rtcByos.errorStreak = 0;
+    } else if (rtcByos.errorStreak < 0xFFFF) {
+        rtcByos.errorStreak++;
+    }
+    uint64_t us = ok ? byos_sleep_us(rtcByos.refreshRateS, millis())
+                     : (uint64_t)byos_retry_s(rtcByos.errorStreak, rtcByos.refreshRateS) * 1000000ULL;
+
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    if (bbep) bbep->sleep(DEEP_SLEEP);
+    esp_sleep_enable_timer_wakeup(us);
+    esp_deep_sleep_start();
+}
+
+// ============================================================================
+// SETUP / LOOP
+// ============================================================================
+
+// Log dump / CC_LOG_ECHO sink
+static void serialLogOut(const char* text, size_t len, void* ctx) {
+    (void)ctx;
+    Serial.write((const uint8_t*)text, len);
+}
+
+void setup() {
+    WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
+
+    Serial.begin(115200);
+    logring_begin(serialLogOut);
+    byos_cache_validate(&rtcByos);
+
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        nvs_flash_init();
+    }
+    loadSettings();
+
+    frameBmp = (uint8_t*)malloc(FRAME_BMP_MAX_SIZE);
+    if (frameBmp && bmp_shadow_init(frameBmp, FRAME_BMP_MAX_SIZE, SCREEN_W, SCREEN_H, &shadowFb)) {
+        shadowSink = fbsink_make(&shadowSinkState, &shadowFb);
+    } else {
+        CCLOG_E("[BYOS] Frame buffer alloc failed");
+        free(frameBmp);
+        frameBmp = nullptr;
+    }
+    initDisplay();
+
+    sleepUntilNext(runCycle());
+}
+
+void loop() {
+    // Never reached: every wake-up ends in deep sleep
+}
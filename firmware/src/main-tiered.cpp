@@ -30,7 +30,6 @@
 #define SCREEN_W 800
 #define SCREEN_H 480
 #define MAX_ZONES 10
-#define ZONE_BMP_MAX_SIZE 20000
 #define ZONE_ID_MAX_LEN 32
 #define ZONE_DATA_MAX_LEN 8000
 // Override config.h version
@@ -85,12 +84,12 @@ struct Zone {
     int x, y, w, h;
     int tier;
     bool changed; 
-    char* data;
+    char* data;             // base64 text, then the BMP once decoded in place
     size_t dataLen;
+    bool decoded;
 };
 Zone zones[MAX_ZONES];
 int zoneCount = 0;
-uint8_t* zoneBmpBuffer = nullptr;
 char* zoneDataBuffers[MAX_ZONES] = {nullptr};
 
 // Function declarations
@@ -121,11 +120,6 @@ void setup() {
     
     loadSettings();
     
-    zoneBmpBuffer = (uint8_t*)malloc(ZONE_BMP_MAX_SIZE);
-    if (!zoneBmpBuffer) {
-        Serial.println("ERROR: Failed to allocate BMP buffer");
-    }
-    
     initZoneBuffers();
     initDisplay();
     
@@ -366,6 +360,7 @@ bool fetchZonesForTier(int tier, bool force) {
                 strcpy(zoneDataBuffers[zoneCount], data);
                 zone.data = zoneDataBuffers[zoneCount];
                 zone.dataLen = dataLen;
+                zone.decoded = false;
             } else {
                 zone.data = nullptr;
             }
@@ -441,6 +436,7 @@ bool fetchAllZones() {
                 strcpy(zoneDataBuffers[zoneCount], data);
                 zone.data = zoneDataBuffers[zoneCount];
                 zone.dataLen = dataLen;
+                zone.decoded = false;
             } else {
                 zone.data = nullptr;
             }
@@ -629,6 +625,7 @@ void initZoneBuffers() {
     for (int i = 0; i < MAX_ZONES; i++) {
         zoneDataBuffers[i] = (char*)malloc(ZONE_DATA_MAX_LEN);
         zones[i].data = nullptr;
+        zones[i].decoded = false;
         zones[i].id[0] = '\0';
     }
 }
@@ -639,18 +636,25 @@ unsigned long getBackoffDelay() {
 }
 
 bool decodeAndDrawZone(Zone& zone) {
-    if (!zone.data || !zoneBmpBuffer) return false;
-    
-    size_t len = strlen(zone.data);
-    size_t dec = decode_base64_length((unsigned char*)zone.data, len);
-    
-    if (dec > ZONE_BMP_MAX_SIZE) return false;
-    
-    decode_base64((unsigned char*)zone.data, len, zoneBmpBuffer);
+    if (!zone.data) return false;
+    
+    // Decode over the base64 text in zoneDataBuffers (the BMP is 3/4 its
+    // size), so no separate BMP buffer is needed
+    if (!zone.decoded) {
+        long dec = decode_base64_inplace((unsigned char*)zone.data, zone.dataLen);
+        if (dec < 0) {
+            Serial.printf("Zone %s: bad base64 (%ld)\n", zone.id, dec);
+            zone.data = nullptr;
+            return false;
+        }
+        zone.dataLen = (size_t)dec;
+        zone.decoded = true;
+    }
     
-    if (zoneBmpBuffer[0] != 'B' || zoneBmpBuffer[1] != 'M') return false;
+    uint8_t* bmp = (uint8_t*)zone.data;
+    if (zone.dataLen < 2 || bmp[0] != 'B' || bmp[1] != 'M') return false;
     
-    int result = bbep.loadBMP(zoneBmpBuffer, zone.x, zone.y, BBEP_BLACK, BBEP_WHITE);
+    int result = bbep.loadBMP(bmp, zone.x, zone.y, BBEP_BLACK, BBEP_WHITE);
     return result == BBEP_SUCCESS;
 }
 
@@ -25,6 +25,8 @@
 #include "esp_task_wdt.h"
 #include "../include/config.h"
 #include "../include/cc-logo-draw.h"
+#include "../include/frame-codec.h"
+#include "../include/zone-sync.h"
 // Note: prerendered-screens.h removed - too large, causes crash
 
 // ============================================================================
@@ -48,22 +50,10 @@
 #define DEFAULT_SERVER_URL "https://einkptdashboard.vercel.app"
 
 // ============================================================================
-// ZONE DEFINITIONS (V10 Dashboard Layout)
+// ZONES
 // ============================================================================
-
-struct ZoneDef {
-    const char* id;
-    int16_t x, y, w, h;
-};
-
-static const ZoneDef ZONES[] = {
-    {"header",  0,   0,   800, 94},
-    {"divider", 0,   94,  800, 2},
-    {"summary", 0,   96,  800, 28},
-    {"legs",    0,   132, 800, 316},
-    {"footer",  0,   448, 800, 32},
-};
-static const int ZONE_COUNT = sizeof(ZONES) / sizeof(ZONES[0]);
+// Zone ids and geometry come from the server with each CCZF frame; the
+// device only tracks the content hashes of what it shows (zone-sync.h)
 
 // ============================================================================
 // STATE MACHINE
@@ -116,7 +106,8 @@ const int MAX_BACKOFF_ERRORS = 5;
 
 // Zone data
 uint8_t* zoneBuffer = nullptr;
-bool zoneChanged[ZONE_COUNT] = {false};
+ZoneHashes shownZones = {};    // Sent as X-Zone-Hashes
+int zonesDrawn = 0;            // Zones drawn by the last fetch
 
 // WiFiManager
 WiFiManagerParameter customServerUrl("server", "Server URL", "", 120);
@@ -140,8 +131,7 @@ void loadSettings();
 void saveSettings();
 void feedWatchdog();
 unsigned long getBackoffDelay();
-bool fetchZoneList(bool forceAll);
-bool fetchAndDrawZone(const ZoneDef& zone, bool flash);
+bool fetchZoneDelta(bool forceAll);
 void doFullRefresh();
 void doPartialRefresh();
 String generatePairingCode();
@@ -418,7 +408,7 @@ void loop() {
             
             feedWatchdog();
             
-            if (fetchZoneList(needsFull)) {
+            if (fetchZoneDelta(needsFull)) {
                 consecutiveErrors = 0;
                 lastRefresh = now;
                 currentState = STATE_RENDER;
@@ -444,31 +434,17 @@ void loop() {
                             (now - lastFullRefresh >= FULL_REFRESH_INTERVAL_MS) ||
                             (partialRefreshCount >= MAX_PARTIAL_BEFORE_FULL);
             
-            int drawn = 0;
-            
-            for (int i = 0; i < ZONE_COUNT; i++) {
-                if (zoneChanged[i] || needsFull) {
-                    feedWatchdog();
-                    
-                    if (fetchAndDrawZone(ZONES[i], !needsFull)) {
-                        drawn++;
-                        
-                        if (!needsFull) {
-                            // Partial refresh per zone
-                            doPartialRefresh();
-                            delay(100);
-                        }
-                    }
-                    
-                    yield();
-                }
-            }
+            // Changed zones were drawn into the buffer by fetchZoneDelta()
+            int drawn = zonesDrawn;
             
             if (needsFull && drawn > 0) {
                 doFullRefresh();
                 lastFullRefresh = now;
                 partialRefreshCount = 0;
                 initialDrawDone = true;
+            } else if (drawn > 0) {
+                // One partial refresh covers every changed zone
+                doPartialRefresh();
             }
             
             Serial.printf("✓ Rendered %d zones\n", drawn);
@@ -1056,148 +1032,115 @@ void saveSettings() {
 // NETWORK - Memory-safe zone fetching
 // ============================================================================
 
-bool fetchZoneList(bool forceAll) {
-    if (strlen(serverUrl) == 0) return false;
-    
+static bool drawZoneBmp(void* ctx, const uint8_t* bmp, int x, int y, int w, int h) {
+    bool flash = *(bool*)ctx;
     feedWatchdog();
     
-    // Mark all zones for refresh (server decides what to render)
-    // Using lightweight metadata endpoint - server does the thinking
-    for (int i = 0; i < ZONE_COUNT; i++) {
-        zoneChanged[i] = true;  // Always fetch all zones - server renders only what changed
+    // Flash zone (black) before drawing new content
+    if (flash) {
+        bbep.fillRect(x, y, w, h, BBEP_BLACK);
+        bbep.refresh(REFRESH_PARTIAL, true);
+        delay(50);
     }
     
-    // Quick connectivity check via lightweight metadata endpoint
-    {
-        WiFiClientSecure* client = new WiFiClientSecure();
-        if (!client) {
-            Serial.println("✗ Failed to create client");
-            return false;
-        }
-        client->setInsecure();
-        
-        HTTPClient http;
-        
-        String url = String(serverUrl);
-        if (!url.endsWith("/")) url += "/";
-        url += "api/zones?metadata=1";  // Ultra-lightweight check
-        url.replace("//api", "/api");
-        
-        Serial.printf("→ Metadata check: %s\n", url.c_str());
-        
-        http.setTimeout(10000);  // 10s timeout for metadata
-        
-        if (!http.begin(*client, url)) {
-            delete client;
-            return false;
-        }
-        
-        http.addHeader("User-Agent", "PTV-TRMNL/" FIRMWARE_VERSION);
-        
-        feedWatchdog();
-        
-        int httpCode = http.GET();
-        
-        if (httpCode != 200) {
-            Serial.printf("✗ Metadata check failed: %d\n", httpCode);
-            http.end();
-            delete client;
-            return false;
-        }
-        
-        // Parse response to check for setup_required
-        String payload = http.getString();
-        http.end();
-        delete client;
-        
-        // Check for setup_required flag
-        if (payload.indexOf("setup_required") > 0 && payload.indexOf("true") > 0) {
-            Serial.println("! Setup required - user needs to configure at web dashboard");
-            setupRequired = true;
-            return false;
-        }
-        
-        setupRequired = false;
-        Serial.println("✓ Server reachable, setup complete");
+    int result = bbep.loadBMP((uint8_t*)bmp, x, y, BBEP_BLACK, BBEP_WHITE);
+    if (result != BBEP_SUCCESS) {
+        Serial.printf("✗ Zone at %d,%d loadBMP failed: %d\n", x, y, result);
+        return false;
     }
-    
-    delay(100);
-    yield();
-    
+    Serial.printf("✓ Zone at %d,%d (%dx%d)\n", x, y, w, h);
     return true;
 }
 
-bool fetchAndDrawZone(const ZoneDef& zone, bool flash) {
+/**
+ * One request per refresh: send the hashes of the zones on screen, draw
+ * the CCZF frames of the zones that changed, keep the new hash vector.
+ * Replaces the ?metadata=1 check plus one request per zone.
+ */
+bool fetchZoneDelta(bool forceAll) {
+    if (strlen(serverUrl) == 0) return false;
+    zonesDrawn = 0;
+    
+    // An empty vector asks for every zone
+    if (forceAll) zonesync_clear(&shownZones);
+    bool flash = !forceAll;
+    
     feedWatchdog();
     
     // Isolated scope for HTTP client
     {
         WiFiClientSecure* client = new WiFiClientSecure();
-        if (!client) return false;
+        if (!client) {
+            Serial.println("✗ Failed to create client");
+            return false;
+        }
         client->setInsecure();
         
         HTTPClient http;
         
-        // Build URL
         String url = String(serverUrl);
         if (!url.endsWith("/")) url += "/";
-        url += "api/zone/";
-        url += zone.id;
-        url += "?demo=normal";  // Demo mode for testing
+        url += "api/zones?format=cczf&demo=normal";  // Demo mode for testing
         url.replace("//api", "/api");
         
         http.setTimeout(HTTP_TIMEOUT_MS);
+        http.useHTTP10(true);
         
-        // Request zone headers
-        const char* headers[] = {"X-Zone-X", "X-Zone-Y", "X-Zone-Width", "X-Zone-Height"};
-        http.collectHeaders(headers, 4);
+        const char* headers[] = {ZONE_SYNC_HEADER, "Content-Type"};
+        http.collectHeaders(headers, 2);
         
         if (!http.begin(*client, url)) {
             delete client;
             return false;
         }
         
+        char hashes[ZONE_SYNC_TEXT_MAX];
+        zonesync_encode(&shownZones, hashes, sizeof(hashes));
         http.addHeader("User-Agent", "PTV-TRMNL/" FIRMWARE_VERSION);
-        http.addHeader("Accept", "application/octet-stream");
+        http.addHeader("Accept", ZONE_SYNC_ACCEPT);
+        http.addHeader(ZONE_SYNC_HEADER, hashes);
         
         feedWatchdog();
         
         int httpCode = http.GET();
         
         if (httpCode != 200) {
+            Serial.printf("✗ Zone fetch failed: %d\n", httpCode);
             http.end();
             delete client;
             return false;
         }
         
-        // Get zone position from headers (fallback to defaults)
-        int zX = http.hasHeader("X-Zone-X") ? http.header("X-Zone-X").toInt() : zone.x;
-        int zY = http.hasHeader("X-Zone-Y") ? http.header("X-Zone-Y").toInt() : zone.y;
-        int zW = http.hasHeader("X-Zone-Width") ? http.header("X-Zone-Width").toInt() : zone.w;
-        int zH = http.hasHeader("X-Zone-Height") ? http.header("X-Zone-Height").toInt() : zone.h;
-        
-        int contentLen = http.getSize();
-        
-        if (contentLen <= 0 || contentLen > ZONE_BUFFER_SIZE) {
-            Serial.printf("✗ Zone '%s' size invalid: %d\n", zone.id, contentLen);
+        // JSON instead of frames: setup not complete
+        if (http.header("Content-Type").indexOf(ZONE_SYNC_ACCEPT) < 0) {
+            String payload = http.getString();
             http.end();
             delete client;
+            setupRequired = payload.indexOf("\"setup_required\":true") >= 0;
+            if (setupRequired) {
+                Serial.println("! Setup required - user needs to configure at web dashboard");
+            }
             return false;
         }
+        setupRequired = false;
+        String newHashes = http.header(ZONE_SYNC_HEADER);
         
-        // Stream BMP data
-        WiFiClient* stream = http.getStreamPtr();
-        int bytesRead = 0;
-        unsigned long timeout = millis() + 15000;
+        // Decode zone by zone into zoneBuffer and draw each one
+        ZoneBmpSink zoneSink;
+        RowSink sink = zonebmp_make(&zoneSink, zoneBuffer, ZONE_BUFFER_SIZE, drawZoneBmp, &flash);
+        FrameDecoder decoder;
+        frame_decoder_init(&decoder, &sink, SCREEN_W, SCREEN_H);
         
-        while (bytesRead < contentLen && millis() < timeout) {
+        WiFiClient* stream = http.getStreamPtr();
+        int remaining = http.getSize();   // -1: read until the server closes
+        uint8_t chunk[512];
+        while (remaining != 0 && decoder.error == FRAME_OK) {
             feedWatchdog();
-            
-            if (stream->available()) {
-                int toRead = min((int)stream->available(), contentLen - bytesRead);
-                int r = stream->readBytes(zoneBuffer + bytesRead, toRead);
-                bytesRead += r;
-            }
+            size_t want = (remaining > 0 && remaining < (int)sizeof(chunk)) ? (size_t)remaining : sizeof(chunk);
+            size_t got = stream->readBytes(chunk, want);
+            if (got == 0) break;
+            if (remaining > 0) remaining -= got;
+            frame_decoder_feed(&decoder, chunk, got);
             yield();
         }
         
@@ -1205,28 +1148,18 @@ bool fetchAndDrawZone(const ZoneDef& zone, bool flash) {
         delete client;
         client = nullptr;
         
-        // Validate BMP header
-        if (bytesRead != contentLen || zoneBuffer[0] != 'B' || zoneBuffer[1] != 'M') {
-            Serial.printf("✗ Zone '%s' invalid BMP (got %d/%d bytes)\n", zone.id, bytesRead, contentLen);
-            return false;
-        }
-        
-        // Flash zone (black) before drawing new content
-        if (flash) {
-            bbep.fillRect(zX, zY, zW, zH, BBEP_BLACK);
-            bbep.refresh(REFRESH_PARTIAL, true);
-            delay(50);
-        }
-        
-        // Draw BMP
-        int result = bbep.loadBMP(zoneBuffer, zX, zY, BBEP_BLACK, BBEP_WHITE);
-        
-        if (result != BBEP_SUCCESS) {
-            Serial.printf("✗ Zone '%s' loadBMP failed: %d\n", zone.id, result);
+        zonesDrawn = (int)zoneSink.zonesDrawn;
+        bool ok = decoder.error == FRAME_OK && decoder.headerLen == 0 && remaining <= 0 &&
+                  !zoneSink.drawFailed &&
+                  zonesync_decode(newHashes.c_str(), newHashes.length(), &shownZones);
+        if (!ok) {
+            // Panel state unknown - ask for every zone next time
+            Serial.printf("✗ Zone delta failed (error %d, %d drawn)\n", decoder.error, zonesDrawn);
+            zonesync_clear(&shownZones);
             return false;
         }
         
-        Serial.printf("✓ Zone '%s' at %d,%d (%dx%d)\n", zone.id, zX, zY, zW, zH);
+        Serial.printf("✓ %d zones changed (%u bytes)\n", zonesDrawn, (unsigned)decoder.bytesIn);
     }
     
     // Heap stabilization
@@ -28,6 +28,7 @@
 #include <bb_epaper.h>
 #include <WiFiManager.h>
 #include "soc/rtc_cntl_reg.h"
+#include "../include/bmp-stream.h"
 
 // ============================================================================
 // VERSION & CONFIG
@@ -445,52 +446,27 @@ bool fetchAndDrawZone(const ZoneDef& zone, bool partial) {
     
     Serial.printf("  ✓ %s: %d bytes\n", zone.id, bytesRead);
     
-    // Parse BMP header and draw to display
-    // BMP header: 14 bytes file header + 40 bytes DIB header
-    if (bytesRead < 54) {
-        Serial.println("  ✗ BMP too small");
+    // Parse BMP header: fields read byte-wise, pixel offset bounded and
+    // every row checked to be inside the bytes actually received
+    BmpInfo bmp;
+    int check = bmp_image_check(zoneBuffer, bytesRead, &bmp);
+    if (check != BMP_STREAM_DONE) {
+        Serial.printf("  ✗ Bad BMP (%d)\n", check);
         return false;
     }
     
-    // Verify BMP magic
-    if (zoneBuffer[0] != 'B' || zoneBuffer[1] != 'M') {
-        Serial.println("  ✗ Not a BMP file");
-        return false;
-    }
-    
-    // Get pixel data offset
-    uint32_t pixelOffset = *(uint32_t*)(zoneBuffer + 10);
-    
-    // Get dimensions from DIB header
-    int32_t bmpWidth = *(int32_t*)(zoneBuffer + 18);
-    int32_t bmpHeight = *(int32_t*)(zoneBuffer + 22);
-    uint16_t bitsPerPixel = *(uint16_t*)(zoneBuffer + 28);
-    
-    // Height is positive for bottom-up (per Appendix D.2)
-    bool bottomUp = bmpHeight > 0;
-    if (bmpHeight < 0) bmpHeight = -bmpHeight;
-    
-    // Verify 1-bit
-    if (bitsPerPixel != 1) {
-        Serial.printf("  ✗ Not 1-bit BMP: %d bpp\n", bitsPerPixel);
-        return false;
-    }
-    
-    // Row stride (padded to 4 bytes)
-    int rowBytes = ((bmpWidth + 31) / 32) * 4;
+    int32_t bmpWidth = bmp.width;
+    int32_t bmpHeight = bmp.height;
     
     // Draw pixels to display
-    uint8_t* pixels = zoneBuffer + pixelOffset;
-    
     for (int row = 0; row < bmpHeight && row < zone.h; row++) {
         // Source row (bottom-up means row 0 is at bottom)
-        int srcRow = bottomUp ? (bmpHeight - 1 - row) : row;
-        uint8_t* rowData = pixels + (srcRow * rowBytes);
+        const uint8_t* rowData = bmp_image_row(zoneBuffer, &bmp, row);
         
         for (int col = 0; col < bmpWidth && col < zone.w; col++) {
             int byteIdx = col / 8;
             int bitIdx = 7 - (col % 8);
-            bool isBlack = !((rowData[byteIdx] >> bitIdx) & 1);
+            bool isBlack = ((rowData[byteIdx] >> bitIdx) & 1) == bmp.invert;
             
             // Draw pixel at zone offset
             bbep.drawPixel(zone.x + col, zone.y + row, 
@@ -8,67 +8,14 @@
  *
  * This avoids WiFiManager/captive portal which crashes ESP32-C3.
  *
+ * The serial shell (shell.cpp) and diagnostic server (diag-server.cpp)
+ * build alongside this file and share its state through ccfirm.h.
+ *
  * Copyright (c) 2026 Angus Bergman
  * SPDX-License-Identifier: AGPL-3.0-or-later
  */
 
-#include <Arduino.h>
-#include <WiFi.h>
-#include <HTTPClient.h>
-#include <WiFiClientSecure.h>
-#include <Preferences.h>
-#include <BLEDevice.h>
-#include <BLEServer.h>
-#include <BLEUtils.h>
-#include <BLE2902.h>
-#include <nvs_flash.h>
-#include <bb_epaper.h>
-#include "base64.hpp"
-#include "soc/soc.h"
-#include "soc/rtc_cntl_reg.h"
-#include "../include/config.h"
-#include "../include/cc_logo_data.h"
-
-// ============================================================================
-// CONFIGURATION
-// ============================================================================
-
-#define FIRMWARE_VERSION "7.3.0"
-
-// Screen dimensions
-#ifdef BOARD_TRMNL_MINI
-  #define SCREEN_W 600
-  #define SCREEN_H 448
-  #define LOGO_BOOT CC_LOGO_BOOT_MINI
-  #define LOGO_BOOT_W 192
-  #define LOGO_BOOT_H 280
-  #define LOGO_SMALL CC_LOGO_SMALL_MINI
-  #define LOGO_SMALL_W 128
-  #define LOGO_SMALL_H 130
-  #define PANEL_TYPE EP583R_600x448
-#else
-  #define SCREEN_W 800
-  #define SCREEN_H 480
-  #define LOGO_BOOT CC_LOGO_BOOT
-  #define LOGO_BOOT_W 256
-  #define LOGO_BOOT_H 380
-  #define LOGO_SMALL CC_LOGO_SMALL
-  #define LOGO_SMALL_W 128
-  #define LOGO_SMALL_H 130
-  #define PANEL_TYPE EP75_800x480
-#endif
-
-// Full-screen BMP: 800x480 1-bit = (800/8)*480 + 62 header = 48062 bytes
-#define ZONE_BMP_MAX_SIZE 50000
-// DEFAULT_SERVER removed - turnkey requirement (URL comes from pairing only)
-
-// BLE UUIDs (Hybrid: WiFi credentials ONLY - URL comes via pairing code)
-#define BLE_SERVICE_UUID        "CC000001-0000-1000-8000-00805F9B34FB"
-#define BLE_CHAR_SSID_UUID      "CC000002-0000-1000-8000-00805F9B34FB"
-#define BLE_CHAR_PASSWORD_UUID  "CC000003-0000-1000-8000-00805F9B34FB"
-#define BLE_CHAR_SERVER_UUID    "CC000004-0000-1000-8000-00805F9B34FB"  // Server URL (turnkey per Section 17.4)
-#define BLE_CHAR_STATUS_UUID    "CC000005-0000-1000-8000-00805F9B34FB"
-#define BLE_CHAR_WIFI_LIST_UUID "CC000006-0000-1000-8000-00805F9B34FB"
+#include "ccfirm.h"
 
 // ============================================================================
 // ZONE DEFINITIONS
@@ -119,6 +66,14 @@ char wifiPassword[64] = "";
 char webhookUrl[1024] = "";  // Large buffer for config tokens with full addresses
 char serverUrl[256] = "";    // User server URL (turnkey - no hardcoded default)
 char pairingCode[8] = "";
+char pskIdentity[TLS_PSK_IDENTITY_MAX] = "";   // TLS-PSK from pairing (tls-psk.h)
+char pskKey[TLS_PSK_KEY_HEX_MAX] = "";
+char pskEndpoint[TLS_PSK_ENDPOINT_MAX] = "";
+TlsPskState pskState = {};
+char freshEndpoint[FRESH_ENDPOINT_MAX] = "";    // UDP freshness responder (fresh-check.h)
+FreshState freshState = {};
+ZoneHashes shownZones = {};   // Freshness hashes of the frame on the panel (X-Fresh-Hashes)
+TlsPin tlsPin = {};           // Last verified server leaf (tls-pin.h), NVS "cc-tls"
 bool wifiConnected = false;
 bool devicePaired = false;
 bool initialDrawDone = false;
@@ -138,10 +93,94 @@ unsigned long pairingStartTime = 0;
 unsigned long lastPollTime = 0;
 int partialRefreshCount = 0;
 int consecutiveErrors = 0;
+bool frameUnchanged = false;   // Last fetch matched what the panel shows
+DeviceMetrics metrics = {};
 
 // Buffers
 uint8_t* zoneBmpBuffer = nullptr;
 
+// Shadow framebuffer: zoneBmpBuffer holds a top-down BMP that every image
+// source (HTTP, BLE push) writes rows into before loadBMP() draws it
+FrameBuffer shadowFb;
+FrameBufferSink shadowSinkState;
+RowSink shadowSink;
+
+// Panel mounting (FbRotation, "rotate" shell command). Frames arrive in the
+// mounted orientation and a RotateSink turns them as they decode.
+uint8_t displayRotation = FB_ROT_0;
+RotateSink shadowRotState;
+
+// Sink for an image source writing into fb at the mounted rotation
+RowSink frameSink(FrameBufferSink* fbState, RotateSink* rotState, FrameBuffer* fb) {
+    if (displayRotation == FB_ROT_0) return fbsink_make(fbState, fb);
+    return rotsink_make(rotState, fb, displayRotation);
+}
+
+// Device-side renderers (dash-template.h) draw into the shadow framebuffer
+// through shadowSink, at the mounted rotation; loadBMP() then shows it
+static SinkDisplay shadowDisplay() {
+    int w, h;
+    fb_rotated_size(&shadowFb, displayRotation, &w, &h);
+    return SinkDisplay(&shadowSink, w, h);
+}
+
+#ifdef CC_LOCAL_RENDER
+// Dashboard data model drawn on the device (dash-model.h); patched each poll
+DashModel dashModel = {};
+static DashModel dashModelNext;
+static uint8_t dashModelBuf[DASHMODEL_MAX_BYTES];
+#endif
+
+#ifdef CC_PAGE_CACHE
+// Pages from the last dashboard response (X-Pages); page 0 is the dashboard
+PageList serverPages = {};
+PageCache pageCache;
+const esp_partition_t* pagePartition = nullptr;
+bool pageCacheReady = false;
+volatile bool pagePressPending = false;   // Short press seen by pollDiagButton()
+int shownPage = 0;                        // Index into serverPages
+unsigned long pageShownAt = 0;
+unsigned long pagePrefetchAfter = 0;
+#endif
+
+#ifdef CC_DUAL_CORE
+// Network task -> loop hand-off; the frame cache's front slot is the shadow
+ChunkPipe netPipe;
+FrameCache frameCache;
+bool dualCoreReady = false;
+volatile bool netAbort = false;
+#endif
+
+#ifdef CC_BLE_FRAME_PUSH
+// Single-producer (BLE task) / single-consumer (loop) ring for frame bytes
+uint8_t* bleFrameRing = nullptr;
+volatile uint32_t bleRingHead = 0;
+volatile uint32_t bleRingTail = 0;
+volatile bool bleRingOverflow = false;
+BLECharacteristic* pCharFrameStatus = nullptr;
+FrameDecoder bleFrameDecoder;
+bool bleFrameRefreshPending = false;
+uint8_t bleFrameRefreshFlags = 0;
+uint32_t bleFrameBytes = 0;
+unsigned long bleFrameStartMs = 0;
+#endif
+
+// Offline timetable slice (RTC copy survives resets, NVS copy survives power loss)
+#define SLICE_RTC_MAGIC 0x43435453  // "CCTS"
+#define SLICE_NVS_INTERVAL_MS 900000  // Limit flash wear: persist at most every 15 min
+#define OFFLINE_RENDER_INTERVAL_MS 60000
+#define TIME_VALID_AFTER 1700000000UL  // SNTP has synced if clock is past Nov 2023
+RTC_NOINIT_ATTR uint32_t rtcSliceMagic;
+RTC_NOINIT_ATTR uint16_t rtcSliceLen;
+RTC_NOINIT_ATTR uint8_t rtcSliceData[SLICE_MAX_BYTES];
+TimetableSlice offlineSlice;
+bool offlineSliceValid = false;
+bool offlineShown = false;
+uint32_t lastLiveUnix = 0;
+unsigned long lastOfflineRender = 0;
+unsigned long lastSlicePersist = 0;
+bool slicePersisted = false;
+
 // ============================================================================
 
 // ============================================================================
@@ -231,21 +270,43 @@ bool connectWiFi();
 void generatePairingCode();
 bool pollPairingServer();
 bool fetchZoneUpdates(bool forceAll);
+int dashboardGet(TlsClient& client, const char* url);
+bool tlsConnect(TlsClient& client, const char* url, bool psk);
 int fetchAndRenderZone(const char* baseUrl, const ZoneDef& def, bool forceAll);
 void doFullRefresh();
+void initClock();
+uint32_t currentUnixTime();
+void storeTimetableSlice(const char* encoded);
+void loadTimetableSlice();
+bool renderOfflineDashboard();
+void maybeShowOfflineDashboard();
+void idleWait(unsigned long ms);
+#ifdef CC_BLE_FRAME_PUSH
+void serviceBleFramePush();
+void runBlePushWindow(unsigned long windowMs);
+#endif
+#ifdef CC_DUAL_CORE
+void initDualCore();
+bool fetchFullScreenBMPDualCore(bool forceDraw);
+#endif
+#ifdef CC_LOCAL_RENDER
+bool fetchModelUpdate(bool forceAll);
+#endif
+#ifdef CC_PAGE_CACHE
+void initPageCache();
+bool servicePages(unsigned long now, bool fetchDue);
+#endif
 
 // ============================================================================
 // JSON HELPERS
 // ============================================================================
 
+// Decoded string value of key, or "" if missing, malformed or longer than
+// webhookUrl (the largest field read this way)
 String jsonGetString(const String& json, const char* key) {
-    String search = String("\"") + key + "\":\"";
-    int start = json.indexOf(search);
-    if (start < 0) return "";
-    start += search.length();
-    int end = json.indexOf("\"", start);
-    if (end < 0) return "";
-    return json.substring(start, end);
+    char value[sizeof(webhookUrl)];
+    if (json_get_string(json.c_str(), json.length(), key, value, sizeof(value)) < 0) return "";
+    return String(value);
 }
 
 // ============================================================================
@@ -341,6 +402,42 @@ class CredentialCallbacks : public BLECharacteristicCallbacks {
     }
 };
 
+#ifdef CC_BLE_FRAME_PUSH
+class FrameCallbacks : public BLECharacteristicCallbacks {
+    // Runs in the BLE task: only copy into the ring, decode happens in loop()
+    void onWrite(BLECharacteristic* pChar) {
+        uint8_t* data = pChar->getData();
+        size_t len = pChar->getLength();
+        if (!bleFrameRing || len == 0) return;
+
+        uint32_t head = bleRingHead;
+        if ((head - bleRingTail) + len > BLE_FRAME_RING_SIZE) {
+            CCTRACE_INSTANT(TRACE_TASK_BLE, "ring overflow", len);
+            bleRingOverflow = true;
+            return;
+        }
+        CCTRACE_INSTANT(TRACE_TASK_BLE, "write", len);
+        for (size_t i = 0; i < len; i++) {
+            bleFrameRing[(head + i) & (BLE_FRAME_RING_SIZE - 1)] = data[i];
+        }
+        bleRingHead = head + len;
+    }
+};
+
+void onBleFrameZone(void* ctx, const FrameZone* zone) {
+    if (zone->flags & FRAME_FLAG_REFRESH) {
+        bleFrameRefreshPending = true;
+        bleFrameRefreshFlags = zone->flags;
+    }
+}
+#endif
+
+// Log dump / CC_LOG_ECHO sink
+void serialLogOut(const char* text, size_t len, void* ctx) {
+    (void)ctx;
+    Serial.write((const uint8_t*)text, len);
+}
+
 // ============================================================================
 // SETUP
 // ============================================================================
@@ -353,6 +450,15 @@ void setup() {
     Serial.println("\n=== Commute Compute v" FIRMWARE_VERSION " ===");
     Serial.println("BLE Provisioning Firmware");
 
+    // Binary log ring; after a crash, print what led up to it
+    bool logKept = logring_begin(serialLogOut);
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (logKept && (reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT ||
+                    reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT || reason == ESP_RST_BROWNOUT)) {
+        Serial.printf("[Log] Reset reason %d - log before reset:\n", (int)reason);
+        logring_dump_text(serialLogOut, nullptr);
+    }
+
     // Initialize NVS
     esp_err_t err = nvs_flash_init();
     if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -365,11 +471,30 @@ void setup() {
 
     // Load settings
     loadSettings();
+    loadTimetableSlice();
+
+#ifdef CC_TLS_PROFILE
+    // The profile's suites are chosen for the accelerators; say so if the SDK build lacks them
+    TlsHwInfo hw = tlsclient_hw();
+    if (!hw.aes || !hw.sha || !hw.mpi) {
+        CCLOG_W("[TLS] Software crypto in use: AES %d, SHA %d, MPI %d", hw.aes, hw.sha, hw.mpi);
+    }
+#endif
+
+#ifdef CC_DUAL_CORE
+    initDualCore();
+#endif
+#ifdef CC_PAGE_CACHE
+    initPageCache();
+#endif
 
-    // Allocate buffer
-    zoneBmpBuffer = (uint8_t*)malloc(ZONE_BMP_MAX_SIZE);
+    // Allocate buffer (dual-core builds use a PSRAM frame cache slot instead)
+    if (!zoneBmpBuffer) zoneBmpBuffer = (uint8_t*)malloc(ZONE_BMP_MAX_SIZE);
     if (!zoneBmpBuffer) {
         Serial.println("[ERROR] Buffer alloc failed");
+    } else {
+        bmp_shadow_init(zoneBmpBuffer, ZONE_BMP_MAX_SIZE, SCREEN_W, SCREEN_H, &shadowFb);
+        shadowSink = frameSink(&shadowSinkState, &shadowRotState, &shadowFb);
     }
 
     // Init display
@@ -447,9 +572,15 @@ void loop() {
                 bleInit = false;
                 screenShown = false;
                 currentState = STATE_WIFI_CONNECT;
+                break;
             }
 
+#ifdef CC_BLE_FRAME_PUSH
+            serviceBleFramePush();
+            delay(5);   // Keep draining the frame ring
+#else
             delay(100);
+#endif
             break;
         }
 
@@ -464,6 +595,7 @@ void loop() {
                 wifiConnected = true;
                 Serial.printf("[OK] Connected: %s\n", WiFi.localIP().toString().c_str());
                 consecutiveErrors = 0;
+                initClock();
 
                 // HYBRID FLOW: Check if we have a valid webhook URL
                 // If already paired with URL, go straight to dashboard
@@ -479,6 +611,7 @@ void loop() {
             } else {
                 Serial.println("[ERROR] WiFi failed");
                 consecutiveErrors++;
+                if (devicePaired) maybeShowOfflineDashboard();
 
                 if (consecutiveErrors >= 3) {
                     // Clear credentials and go back to BLE
@@ -522,14 +655,14 @@ void loop() {
         // ==== POLL PAIRING ====
         case STATE_POLL_PAIRING: {
             // Check timeout
-            if (now - pairingStartTime > 600000) {
+            if (now - pairingStartTime > PAIR_TIMEOUT_MS) {
                 Serial.println("[PAIR] Timeout - regenerating");
                 currentState = STATE_SHOW_PAIRING;
                 break;
             }
 
             // Poll every 5 seconds
-            if (now - lastPollTime >= 5000) {
+            if (now - lastPollTime >= PAIR_POLL_INTERVAL_MS) {
                 lastPollTime = now;
                 if (pollPairingServer()) {
                     devicePaired = true;
@@ -548,29 +681,46 @@ void loop() {
 
         // ==== FETCH DASHBOARD ====
         case STATE_FETCH_DASHBOARD: {
-            Serial.println("[STATE] Fetch Dashboard");
+            CCLOG_D("[STATE] Fetch Dashboard");
 
-            bool needsFull = !initialDrawDone ||
-                            (now - lastFullRefresh >= 300000) ||
+            // Offline view was drawn since the last live frame - clear its ghosting
+            bool needsFull = !initialDrawDone || offlineShown ||
+                            (now - lastFullRefresh >= FULL_REFRESH_MAX_AGE_MS) ||
                             (partialRefreshCount >= MAX_PARTIAL_BEFORE_FULL);
 
-            Serial.printf("[Fetch] needsFull=%d, initialDrawDone=%d\n", needsFull, initialDrawDone);
-            if (fetchZoneUpdates(needsFull)) {
-                if (needsFull) {
-                    Serial.println("[Display] Doing full refresh...");
+            bool forceDraw = needsFull;
+#ifdef CC_PAGE_CACHE
+            forceDraw = forceDraw || shownPage != 0;   // Back from a page: the panel shows something else
+#endif
+
+            CCLOG_I("[Fetch] needsFull=%d, initialDrawDone=%d", needsFull, initialDrawDone);
+            if (fetchZoneUpdates(forceDraw)) {
+                if (frameUnchanged) {
+                    metrics.framesUnchanged++;
+                    CCLOG_I("[Display] Frame unchanged - no refresh");
+                } else if (needsFull) {
+                    unsigned long t0 = millis();
                     doFullRefresh();
-                    Serial.println("[Display] Full refresh complete");
+                    metrics_phase(&metrics.refreshFull, millis() - t0);
+                    CCLOG_I("[Display] Full refresh %lu ms", metrics.refreshFull.lastMs);
                     lastFullRefresh = now;
                     partialRefreshCount = 0;
                 } else {
-                    Serial.println("[Display] Doing partial refresh...");
+                    unsigned long t0 = millis();
+                    CCTRACE_BEGIN(TRACE_TASK_PANEL, "refresh partial");
                     bbep->refresh(REFRESH_PARTIAL, true);
-                    Serial.println("[Display] Partial refresh complete");
+                    CCTRACE_END(TRACE_TASK_PANEL, "refresh partial");
+                    metrics_phase(&metrics.refreshPartial, millis() - t0);
+                    CCLOG_I("[Display] Partial refresh %lu ms", metrics.refreshPartial.lastMs);
                     partialRefreshCount++;
                 }
                 lastRefresh = now;
                 initialDrawDone = true;
+                offlineShown = false;
                 consecutiveErrors = 0;
+#ifdef CC_PAGE_CACHE
+                shownPage = 0;
+#endif
                 currentState = STATE_IDLE;
             } else {
                 // Check if pairing was cleared due to invalid token
@@ -580,10 +730,11 @@ void loop() {
                     consecutiveErrors = 0;
                 } else {
                     consecutiveErrors++;
-                    if (consecutiveErrors > 5) {
+                    maybeShowOfflineDashboard();
+                    if (consecutiveErrors > FETCH_MAX_RETRIES) {
                         currentState = STATE_ERROR;
                     } else {
-                        delay(5000);
+                        delay(FETCH_RETRY_DELAY_MS);
                     }
                 }
             }
@@ -592,7 +743,12 @@ void loop() {
 
         // ==== IDLE ====
         case STATE_IDLE: {
-            if (now - lastRefresh >= 60000) {
+            bool fetchDue = now - lastRefresh >= FETCH_INTERVAL_MS;
+#ifdef CC_PAGE_CACHE
+            // Button pages: may show a cached page, hold off or bring the dashboard back
+            fetchDue = servicePages(now, fetchDue);
+#endif
+            if (fetchDue) {
                 currentState = STATE_FETCH_DASHBOARD;
             }
 
@@ -601,15 +757,21 @@ void loop() {
                 currentState = STATE_WIFI_CONNECT;
             }
 
-            delay(1000);
+            idleWait(1000);
             break;
         }
 
         // ==== ERROR ====
         case STATE_ERROR: {
             // Skip showErrorScreen - crashes on ESP32-C3
-            Serial.println("[ERROR] Connection failed, retrying in 30s...");
-            delay(30000);
+            CCLOG_E("[ERROR] Connection failed, retrying in 30s...");
+            maybeShowOfflineDashboard();
+#ifdef CC_BLE_FRAME_PUSH
+            // WiFi outage: let a phone/laptop push frames locally meanwhile
+            runBlePushWindow(BLE_PUSH_WINDOW_MS);
+#else
+            delay(ERROR_HOLDOFF_MS);
+#endif
             consecutiveErrors = 0;
             currentState = STATE_WIFI_CONNECT;
             break;
@@ -652,6 +814,28 @@ void initBLE() {
     pCharWiFiList = pService->createCharacteristic(BLE_CHAR_WIFI_LIST_UUID, BLECharacteristic::PROPERTY_READ);
     pCharWiFiList->setValue("");
 
+#ifdef CC_BLE_FRAME_PUSH
+    BLEDevice::setMTU(BLE_FRAME_MTU);
+    if (!bleFrameRing) bleFrameRing = (uint8_t*)malloc(BLE_FRAME_RING_SIZE);
+    bleRingHead = bleRingTail = 0;
+    bleRingOverflow = false;
+    bleFrameBytes = 0;
+    bleFrameRefreshPending = false;
+    int frameW, frameH;
+    fb_rotated_size(&shadowFb, displayRotation, &frameW, &frameH);
+    frame_decoder_init(&bleFrameDecoder, &shadowSink, frameW, frameH);
+    bleFrameDecoder.onZone = onBleFrameZone;
+
+    BLECharacteristic* pCharFrame = pService->createCharacteristic(BLE_CHAR_FRAME_UUID,
+        BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR);
+    pCharFrame->setCallbacks(new FrameCallbacks());
+
+    pCharFrameStatus = pService->createCharacteristic(BLE_CHAR_FRAME_STATUS_UUID,
+        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY);
+    pCharFrameStatus->addDescriptor(new BLE2902());
+    pCharFrameStatus->setValue("ready");
+#endif
+
     pService->start();
 
     BLEAdvertising* pAdv = BLEDevice::getAdvertising();
@@ -668,7 +852,117 @@ void stopBLE() {
         BLEDevice::deinit(true);
         pServer = nullptr;
     }
+#ifdef CC_BLE_FRAME_PUSH
+    pCharFrameStatus = nullptr;
+    if (bleFrameRing) {
+        free(bleFrameRing);
+        bleFrameRing = nullptr;
+    }
+#endif
+}
+
+#ifdef CC_BLE_FRAME_PUSH
+void notifyFrameStatus(const char* msg) {
+    if (pCharFrameStatus && bleDeviceConnected) {
+        pCharFrameStatus->setValue(msg);
+        pCharFrameStatus->notify();
+    }
+}
+
+void serviceBleFramePush() {
+    if (!bleFrameRing || !zoneBmpBuffer) return;
+
+    if (bleRingOverflow) {
+        // Sender outran the decoder - drop the partial frame, sender retries
+        frame_decoder_reset(&bleFrameDecoder);
+        bleRingTail = bleRingHead;
+        bleRingOverflow = false;
+        bleFrameBytes = 0;
+        CCLOG_W("[BLE] Frame ring overflow - frame dropped");
+        notifyFrameStatus("err:overflow");
+        return;
+    }
+
+    uint32_t head = bleRingHead;
+    while (bleRingTail != head) {
+        uint32_t tail = bleRingTail;
+        uint32_t idx = tail & (BLE_FRAME_RING_SIZE - 1);
+        uint32_t n = head - tail;
+        if (idx + n > BLE_FRAME_RING_SIZE) n = BLE_FRAME_RING_SIZE - idx;
+
+        if (bleFrameBytes == 0) bleFrameStartMs = millis();
+        CCTRACE_BEGIN(TRACE_TASK_LOOP, "ble decode");
+        int r = frame_decoder_feed(&bleFrameDecoder, bleFrameRing + idx, n);
+        CCTRACE_END(TRACE_TASK_LOOP, "ble decode");
+        bleFrameBytes += n;
+        bleRingTail = tail + n;
+
+        if (r != FRAME_OK) {
+            char msg[24];
+            snprintf(msg, sizeof(msg), "err:%d", r);
+            CCLOG_E("[BLE] Frame decode error %d after %u bytes", r, (unsigned)bleFrameBytes);
+            notifyFrameStatus(msg);
+            frame_decoder_reset(&bleFrameDecoder);
+            bleRingTail = bleRingHead;
+            bleFrameBytes = 0;
+            return;
+        }
+    }
+
+    if (bleFrameRefreshPending) {
+        unsigned long decodeMs = millis() - bleFrameStartMs;
+        unsigned long t0 = millis();
+        bool full = bleFrameRefreshFlags & FRAME_FLAG_FULL;
+
+        CCTRACE_BEGIN(TRACE_TASK_PANEL, "loadBMP");
+        bbep->loadBMP(zoneBmpBuffer, 0, 0, BBEP_BLACK, BBEP_WHITE);
+        CCTRACE_END(TRACE_TASK_PANEL, "loadBMP");
+        CCTRACE_BEGIN(TRACE_TASK_PANEL, full ? "refresh full" : "refresh partial");
+        bbep->refresh(full ? REFRESH_FULL : REFRESH_PARTIAL, true);
+        CCTRACE_END(TRACE_TASK_PANEL, full ? "refresh full" : "refresh partial");
+#ifdef CC_DUAL_CORE
+        // Zones were decoded straight into the front slot - its hash is stale
+        if (dualCoreReady) framecache_dirty_front(&frameCache);
+#endif
+        zonesync_clear(&shownZones);   // Not a server frame - the next poll must fetch
+        if (full) {
+            partialRefreshCount = 0;
+        } else {
+            partialRefreshCount++;
+        }
+        unsigned long refreshMs = millis() - t0;
+
+        // frame:<bytes>:<receive+decode ms>:<panel ms>
+        char msg[48];
+        snprintf(msg, sizeof(msg), "frame:%u:%lu:%lu", (unsigned)bleFrameBytes, decodeMs, refreshMs);
+        notifyFrameStatus(msg);
+        CCLOG_I("[BLE] Frame %u bytes, %lu ms rx+decode (%lu B/s), panel %lu ms",
+                (unsigned)bleFrameBytes, decodeMs,
+                decodeMs > 0 ? (unsigned long)bleFrameBytes * 1000UL / decodeMs : 0UL, refreshMs);
+
+        bleFrameRefreshPending = false;
+        bleFrameBytes = 0;
+        initialDrawDone = true;
+    }
+}
+
+void runBlePushWindow(unsigned long windowMs) {
+    Serial.println("[BLE] Opening frame-push window");
+    bleCredentialsReceived = false;
+    initBLE();
+
+    unsigned long start = millis();
+    while (millis() - start < windowMs && !bleCredentialsReceived) {
+        serviceBleFramePush();
+        delay(5);
+    }
+
+    stopBLE();
+    delay(100);  // Let BLE fully deinitialize
+    initDisplay();  // BLE deinit corrupts display state (see BLE_SETUP)
+    bleCredentialsReceived = false;
 }
+#endif
 
 // ============================================================================
 // WIFI
@@ -704,8 +998,7 @@ void generatePairingCode() {
 }
 
 bool pollPairingServer() {
-    WiFiClientSecure client;
-    client.setInsecure();
+    TlsClient client;
     HTTPClient http;
 
     // Turnkey: Use user-provided server URL (Section 17.4)
@@ -716,6 +1009,8 @@ bool pollPairingServer() {
     String url = String(serverUrl) + "/api/pair/" + String(pairingCode);
     Serial.printf("[PAIR] Polling: %s\n", url.c_str());
 
+    // Verified: the reply carries the device's PSK
+    if (!tlsConnect(client, url.c_str(), false)) return false;
     http.setTimeout(10000);
     if (!http.begin(client, url)) return false;
 
@@ -734,6 +1029,24 @@ bool pollPairingServer() {
         if (webhook.length() > 0) {
             strncpy(webhookUrl, webhook.c_str(), sizeof(webhookUrl) - 1);
             Serial.printf("[PAIR] Success! URL: %s\n", webhookUrl);
+
+            // Per-device TLS-PSK (older servers send none)
+            String identity = jsonGetString(payload, "pskIdentity");
+            String key = jsonGetString(payload, "psk");
+            String endpoint = jsonGetString(payload, "pskEndpoint");
+            String fresh = jsonGetString(payload, "freshEndpoint");
+            pskIdentity[0] = pskKey[0] = pskEndpoint[0] = freshEndpoint[0] = '\0';
+            if (tlspsk_valid(identity.c_str(), key.c_str()) && endpoint.length() < sizeof(pskEndpoint)) {
+                strncpy(pskIdentity, identity.c_str(), sizeof(pskIdentity) - 1);
+                strncpy(pskKey, key.c_str(), sizeof(pskKey) - 1);
+                strncpy(pskEndpoint, endpoint.c_str(), sizeof(pskEndpoint) - 1);
+                Serial.printf("[PAIR] PSK identity %s, endpoint %s\n", pskIdentity,
+                              pskEndpoint[0] ? pskEndpoint : "(none)");
+                // The freshness check is tagged with the PSK - no PSK, no check
+                if (fresh.length() < sizeof(freshEndpoint)) {
+                    strncpy(freshEndpoint, fresh.c_str(), sizeof(freshEndpoint) - 1);
+                }
+            }
             return true;
         }
     }
@@ -941,15 +1254,30 @@ void loadSettings() {
     String pass = preferences.getString("wifi_pass", "");
     String url = preferences.getString("webhookUrl", "");
     String server = preferences.getString("serverUrl", "");
+    String identity = preferences.getString("psk_id", "");
+    String key = preferences.getString("psk_key", "");
+    String endpoint = preferences.getString("psk_url", "");
+    String fresh = preferences.getString("fresh_ep", "");
     devicePaired = preferences.getBool("paired", false);
+    displayRotation = preferences.getUChar("rotation", FB_ROT_0) & 3;
 
     strncpy(wifiSSID, ssid.c_str(), sizeof(wifiSSID) - 1);
     strncpy(wifiPassword, pass.c_str(), sizeof(wifiPassword) - 1);
     strncpy(webhookUrl, url.c_str(), sizeof(webhookUrl) - 1);
     strncpy(serverUrl, server.c_str(), sizeof(serverUrl) - 1);
+    if (tlspsk_valid(identity.c_str(), key.c_str())) {
+        strncpy(pskIdentity, identity.c_str(), sizeof(pskIdentity) - 1);
+        strncpy(pskKey, key.c_str(), sizeof(pskKey) - 1);
+        strncpy(pskEndpoint, endpoint.c_str(), sizeof(pskEndpoint) - 1);
+        strncpy(freshEndpoint, fresh.c_str(), sizeof(freshEndpoint) - 1);
+    }
 
     preferences.end();
 
+    preferences.begin("cc-tls", true);
+    if (preferences.getBytes("pin", &tlsPin, sizeof(tlsPin)) != sizeof(tlsPin)) tlspin_clear(&tlsPin);
+    preferences.end();
+
     Serial.printf("[Settings] SSID: %s, Paired: %s\n",
                   strlen(wifiSSID) > 0 ? wifiSSID : "(none)",
                   devicePaired ? "yes" : "no");
@@ -961,11 +1289,110 @@ void saveSettings() {
     preferences.putString("wifi_pass", wifiPassword);
     preferences.putString("webhookUrl", webhookUrl);
     preferences.putString("serverUrl", serverUrl);
+    preferences.putString("psk_id", pskIdentity);
+    preferences.putString("psk_key", pskKey);
+    preferences.putString("psk_url", pskEndpoint);
+    preferences.putString("fresh_ep", freshEndpoint);
     preferences.putBool("paired", devicePaired);
+    preferences.putUChar("rotation", displayRotation);
     preferences.end();
     Serial.println("[Settings] Saved");
 }
 
+// ============================================================================
+// TLS
+// ============================================================================
+// Server certificates are verified against the bundled roots (tls-roots.h)
+// once; the leaf is then pinned in NVS and later handshakes compare it
+// instead of checking the chain (tls-pin.h). The PSK endpoint needs no
+// certificate at all (tls-psk.h).
+
+// Host and port of a server URL (webhookUrl, serverUrl, pskEndpoint)
+bool serverHostPort(const char* url, char* host, size_t size, uint16_t* port) {
+    const char* p = url;
+    if (strncmp(p, "https://", 8) == 0) {
+        p += 8;
+        *port = 443;
+    } else if (strncmp(p, "http://", 7) == 0) {
+        p += 7;
+        *port = 80;
+    } else {
+        return false;
+    }
+    size_t n = 0;
+    while (p[n] && p[n] != '/' && p[n] != ':') {
+        if (n >= size - 1) return false;
+        host[n] = p[n];
+        n++;
+    }
+    host[n] = '\0';
+    if (p[n] == ':') *port = (uint16_t)atoi(p + n + 1);
+    return n > 0;
+}
+
+static void saveTlsPin() {
+    preferences.begin("cc-tls", false);
+    preferences.putBytes("pin", &tlsPin, sizeof(tlsPin));
+    preferences.end();
+}
+
+/**
+ * Open the TLS connection the request for url then runs over. https://
+ * servers are authenticated by the cached pin, else by full chain
+ * verification (which refreshes the pin), or by the PSK when psk is set.
+ * http:// URLs (local development servers) are left to the caller.
+ */
+bool tlsConnect(TlsClient& client, const char* url, bool psk) {
+    char host[96];
+    uint16_t port;
+    if (strncmp(url, "http://", 7) == 0) return true;
+    if (!serverHostPort(url, host, sizeof(host), &port)) return false;
+
+    unsigned long t0 = millis();
+    uint32_t now = currentUnixTime();
+    uint8_t leaf[32];
+    uint32_t notAfter = 0;
+
+    if (psk) {
+        bool ok = tlsHandshake(client, host, port, TLS_MODE_PSK);
+        metrics_phase(&metrics.tls, millis() - t0);
+        if (ok) metrics.tlsPsk++; else metrics.tlsFailed++;
+        return ok;
+    }
+
+    if (tlspin_usable(&tlsPin, host, now)) {
+        if (tlsHandshake(client, host, port, TLS_MODE_PINNED) &&
+            tlsPeerLeaf(client, leaf, &notAfter) && tlspin_matches(&tlsPin, leaf)) {
+            metrics_phase(&metrics.tls, millis() - t0);
+            metrics.tlsPinned++;
+            return true;
+        }
+        client.stop();
+        CCLOG_W("[TLS] %s leaf does not match pin - verifying chain", host);
+    }
+
+    bool ok = tlsHandshake(client, host, port, TLS_MODE_CHAIN) && tlsPeerLeaf(client, leaf, &notAfter);
+    // mbedTLS is built without date checks - expiry is enforced here
+    if (ok && now != 0 && notAfter <= now) {
+        CCLOG_E("[TLS] %s certificate expired", host);
+        ok = false;
+    }
+    metrics_phase(&metrics.tls, millis() - t0);
+    if (!ok) {
+        char err[96] = "";
+        client.lastError(err, sizeof(err));
+        CCLOG_E("[TLS] %s verification failed: %s", host, err);
+        client.stop();
+        metrics.tlsFailed++;
+        return false;
+    }
+    metrics.tlsVerified++;
+    tlspin_set(&tlsPin, host, leaf, notAfter, now);
+    saveTlsPin();
+    CCLOG_I("[TLS] %s verified in %lu ms, pinned until %lu", host, millis() - t0, (unsigned long)notAfter);
+    return true;
+}
+
 // ============================================================================
 // DASHBOARD FETCHING
 // ============================================================================
@@ -973,31 +1400,169 @@ void saveSettings() {
 // Full-screen BMP buffer (800x480 1-bit = ~48KB)
 #define FULLSCREEN_BMP_SIZE 50000
 
-bool fetchFullScreenBMP() {
-    if (strlen(webhookUrl) == 0) return false;
+// Dashboard responses go through http-lite.h: no Strings, headers
+// dispatched as they arrive. One fetch at a time (main loop or net task).
+HttpLiteConn dashConn;
+static HttpLiteResponse dashResp;
+char dashLine[DASH_LINE_MAX];
+static char dashSlice[DASH_SLICE_MAX];   // Valid after dashboardGet() until the next fetch
+static ZoneHashes dashZones;             // X-Fresh-Hashes of the same response (count 0 if none)
+static WiFiClient dashPlain;             // http:// development servers
+#ifdef CC_PAGE_CACHE
+static PageList dashPages;               // X-Pages of the same response (count 0 if none)
+static uint32_t dashPageHash;            // X-Page-Hash of a ?format=page response
+static bool dashPageHashSet;
+#endif
 
-    WiFiClientSecure client;
-    client.setInsecure();
-    HTTPClient http;
+// HttpLiteIo over an Arduino client
+int clientIoRead(void* ctx, uint8_t* buf, size_t len) {
+    WiFiClient* c = (WiFiClient*)ctx;
+    unsigned long start = millis();
+    for (;;) {
+        int n = c->available() > 0 ? c->read(buf, len) : 0;
+        if (n > 0) return n;
+        if (!c->connected()) return -1;
+        if (millis() - start > HTTP_IO_TIMEOUT_MS) return 0;
+        delay(1);
+    }
+}
 
-    // Fetch full-screen BMP from device endpoint
-    String url = String(webhookUrl) + "?format=bmp";
-    Serial.printf("[Fetch] Full screen: %s\n", url.c_str());
+bool clientIoWrite(void* ctx, const uint8_t* buf, size_t len) {
+    return ((WiFiClient*)ctx)->write(buf, len) == len;
+}
 
-    http.setTimeout(20000);
-    if (!http.begin(client, url)) {
-        Serial.println("[Fetch] Failed to begin HTTP");
-        return false;
+static void dashboardHeader(void* ctx, const char* name, const char* value) {
+    if (httplite_name_is(name, FRESH_HASH_HEADER)) {
+        if (!zonesync_decode(value, strlen(value), &dashZones)) zonesync_clear(&dashZones);
+        return;
+    }
+#ifdef CC_PAGE_CACHE
+    if (httplite_name_is(name, PAGES_HEADER)) {
+        if (!page_list_parse(value, &dashPages)) CCLOG_W("[Pages] Bad X-Pages: %s", value);
+        return;
+    }
+    if (httplite_name_is(name, PAGE_HASH_HEADER)) {
+        char* end;
+        dashPageHash = (uint32_t)strtoul(value, &end, 16);
+        dashPageHashSet = end != value && *end == '\0';
+        return;
+    }
+#endif
+    if (!httplite_name_is(name, "X-Timetable-Slice")) return;
+    size_t len = strlen(value);
+    if (len >= sizeof(dashSlice)) {
+        CCLOG_W("[Slice] Too large: %u chars", (unsigned)len);
+        return;
     }
+    memcpy(dashSlice, value, len + 1);
+}
 
-    int code = http.GET();
+// TLS connection from tlsConnect(), or a plain one for http:// URLs
+WiFiClient* dashboardConnect(TlsClient& client, const char* url, bool psk) {
+    if (strncmp(url, "http://", 7) != 0) return tlsConnect(client, url, psk) ? &client : nullptr;
+    char host[96];
+    uint16_t port;
+    if (!serverHostPort(url, host, sizeof(host), &port) || !dashPlain.connect(host, port)) return nullptr;
+    return &dashPlain;
+}
+
+// Request headers of every dashboard GET
+void dashboardHeaders(char* out, size_t size) {
+    snprintf(out, size, "User-Agent: CCFirm/%s ESP32\r\n%s: %lu\r\n", FIRMWARE_VERSION,
+             NEXT_FETCH_HEADER, (unsigned long)(FETCH_INTERVAL_MS / 1000));
+}
+
+static int dashboardRequest(WiFiClient* conn, const char* url) {
+    char host[96];
+    uint16_t port;
+    if (!serverHostPort(url, host, sizeof(host), &port)) return HTTP_LITE_ERR_REQUEST;
+    HttpLiteIo io = { clientIoRead, clientIoWrite, conn };
+    httplite_conn_init(&dashConn, io);
+    httplite_response_init(&dashResp, dashLine, sizeof(dashLine), dashboardHeader, nullptr, nullptr, false);
+    dashSlice[0] = '\0';
+    zonesync_clear(&dashZones);
+#ifdef CC_PAGE_CACHE
+    dashPages.count = 0;
+    dashPageHashSet = false;
+#endif
+
+    char headers[96];
+    dashboardHeaders(headers, sizeof(headers));
+    int rc = httplite_send(&dashConn, "GET", host, port, httplite_url_path(url), headers, false);
+    return rc < 0 ? rc : httplite_read_headers(&dashConn, &dashResp);
+}
+
+/**
+ * GET a dashboard URL, through the paired TLS-PSK endpoint when there is
+ * one. A connection or handshake failure there falls back to verified
+ * certificate TLS against url. Returns the HTTP code (< 0 on transport
+ * errors) once the headers are in (dashResp, dashSlice); the body is read
+ * with dashboardBody(), then the caller calls dashboardEnd().
+ */
+int dashboardGet(TlsClient& client, const char* url) {
+    if (pskEndpoint[0] && tlspsk_should_try(&pskState)) {
+        char pskUrl[sizeof(webhookUrl) + 32];
+        if (tlspsk_url(pskEndpoint, url, pskUrl, sizeof(pskUrl))) {
+            WiFiClient* conn = dashboardConnect(client, pskUrl, true);
+            int code = conn ? dashboardRequest(conn, pskUrl) : HTTPC_ERROR_CONNECTION_REFUSED;
+            tlspsk_record(&pskState, code > 0);
+            if (code > 0) return code;
+            client.stop();
+            CCLOG_W("[TLS] PSK endpoint failed (%d) - certificate fallback", code);
+        }
+    }
+    WiFiClient* conn = dashboardConnect(client, url, false);
+    if (!conn) return HTTPC_ERROR_CONNECTION_REFUSED;
+    return dashboardRequest(conn, url);
+}
+
+/** Stream the body to onBody. Returns the HTTP code, or < 0 if it did not arrive whole */
+static int dashboardBody(HttpLiteBodyFn onBody, void* ctx) {
+    dashResp.onBody = onBody;
+    dashResp.ctx = ctx;
+    return httplite_read_body(&dashConn, &dashResp);
+}
+
+void dashboardEnd(TlsClient& client) {
+    client.stop();
+    dashPlain.stop();
+}
+
+// Body sink: BMP rows straight into the shadow framebuffer
+struct BmpBodySink {
+    BmpStream bmp;
+    int result;
+};
+
+static bool bmpBodySink(void* ctx, const uint8_t* data, size_t len) {
+    BmpBodySink* s = (BmpBodySink*)ctx;
+    if (dashResp.bodyBytes + len > FULLSCREEN_BMP_SIZE) return false;
+    if (s->result == BMP_STREAM_MORE) s->result = bmp_stream_feed(&s->bmp, data, len);
+    return s->result >= 0;
+}
+
+bool fetchFullScreenBMP() {
+    if (strlen(webhookUrl) == 0 || !zoneBmpBuffer) return false;
+
+    TlsClient client;
+
+    // Fetch full-screen BMP from device endpoint
+    static char url[sizeof(webhookUrl) + 16];
+    snprintf(url, sizeof(url), "%s?format=bmp", webhookUrl);
+    unsigned long fetchStart = millis();
+
+    CCTRACE_BEGIN(TRACE_TASK_LOOP, "http");
+    int code = dashboardGet(client, url);
+    CCTRACE_END(TRACE_TASK_LOOP, "http");
+    metrics_phase(&metrics.http, millis() - fetchStart);
+    metrics.lastHttpStatus = code;
     if (code != 200) {
-        Serial.printf("[Fetch] HTTP %d\n", code);
-        http.end();
+        CCLOG_E("[Fetch] HTTP %d", code);
+        dashboardEnd(client);
 
         // If 400 Bad Request, token is invalid/truncated - clear pairing
         if (code == 400) {
-            Serial.println("[Fetch] Invalid token - clearing pairing");
+            CCLOG_W("[Fetch] Invalid token - clearing pairing");
             webhookUrl[0] = '\0';
             devicePaired = false;
             saveSettings();
@@ -1005,46 +1570,812 @@ bool fetchFullScreenBMP() {
         return false;
     }
 
-    int len = http.getSize();
-    Serial.printf("[Fetch] Size: %d bytes\n", len);
+    // No Content-Length (chunked) is fine: the sink enforces the size
+    int64_t len = dashResp.contentLength;
+    if (len == 0 || len > FULLSCREEN_BMP_SIZE) {
+        CCLOG_E("[Fetch] Bad size: %ld", (long)len);
+        dashboardEnd(client);
+        return false;
+    }
 
-    if (len <= 0 || len > FULLSCREEN_BMP_SIZE) {
-        Serial.printf("[Fetch] Bad size: %d\n", len);
-        http.end();
+    // Stream rows straight into the shadow framebuffer (validates as it goes)
+    BmpBodySink sink;
+    bmp_stream_init(&sink.bmp, &shadowSink, 0, 0);
+    sink.result = BMP_STREAM_MORE;
+    unsigned long bodyStart = millis();
+    CCTRACE_BEGIN(TRACE_TASK_LOOP, "body + decode");
+    int rc = dashboardBody(bmpBodySink, &sink);
+    dashboardEnd(client);
+    CCTRACE_END(TRACE_TASK_LOOP, "body + decode");
+
+    if (sink.result != BMP_STREAM_DONE) {
+        CCLOG_E("[Fetch] BMP stream failed: %d (body %d, %lu B)", sink.result, rc,
+                (unsigned long)dashResp.bodyBytes);
         return false;
     }
+    metrics_phase(&metrics.body, millis() - bodyStart);
+    metrics.lastFetchBytes = dashResp.bodyBytes;
+    CCLOG_I("[Fetch] %lu B in %lu ms", (unsigned long)dashResp.bodyBytes, millis() - fetchStart);
 
-    // Use existing buffer (it's big enough)
-    WiFiClient* stream = http.getStreamPtr();
-    int read = stream->readBytes(zoneBmpBuffer, len);
-    http.end();
+    unsigned long loadStart = millis();
+    CCTRACE_BEGIN(TRACE_TASK_PANEL, "loadBMP");
+    int result = bbep->loadBMP(zoneBmpBuffer, 0, 0, BBEP_BLACK, BBEP_WHITE);
+    CCTRACE_END(TRACE_TASK_PANEL, "loadBMP");
+    metrics_phase(&metrics.load, millis() - loadStart);
+
+    if (result == BBEP_SUCCESS) {
+        lastLiveUnix = currentUnixTime();
+        if (dashSlice[0]) storeTimetableSlice(dashSlice);
+        return true;
+    } else {
+        CCLOG_E("[Fetch] loadBMP failed: %d", result);
+        return false;
+    }
+}
+
+#ifdef CC_DUAL_CORE
+// ============================================================================
+// DUAL-CORE FETCH (ESP32-S3 + PSRAM)
+// ============================================================================
+
+void initDualCore() {
+    size_t cacheBytes = (size_t)FRAME_CACHE_SLOTS * ZONE_BMP_MAX_SIZE;
+    uint8_t* cacheMem = (uint8_t*)heap_caps_malloc(cacheBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    // Chunks stay in internal RAM - they are written by TLS and read once
+    uint8_t* pipeMem = (uint8_t*)heap_caps_malloc((size_t)NET_CHUNK_SLOTS * NET_CHUNK_SIZE,
+                                                  MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+    if (!cacheMem || !pipeMem ||
+        !framecache_init(&frameCache, cacheMem, FRAME_CACHE_SLOTS, ZONE_BMP_MAX_SIZE, SCREEN_W, SCREEN_H) ||
+        !chunkpipe_init(&netPipe, pipeMem, NET_CHUNK_SLOTS, NET_CHUNK_SIZE)) {
+        Serial.println("[PSRAM] Frame cache alloc failed - single-core fetch");
+        if (cacheMem) heap_caps_free(cacheMem);
+        if (pipeMem) heap_caps_free(pipeMem);
+        return;
+    }
+
+    zoneBmpBuffer = framecache_front(&frameCache)->bmp;
+    dualCoreReady = true;
+    Serial.printf("[PSRAM] Frame cache %u x %u B, free PSRAM %u B\n",
+                  (unsigned)FRAME_CACHE_SLOTS, (unsigned)ZONE_BMP_MAX_SIZE, (unsigned)ESP.getFreePsram());
+}
+
+/**
+ * Core 0: run the HTTP request and push the body into netPipe. Always ends
+ * with a CHUNK_FLAG_END slot (status 0 = ok, HTTP code or < 0 on failure)
+ * so the consumer knows the task is done with the pipe.
+ */
+// Body sink: fill pipe slots to NET_CHUNK_SIZE before handing them over
+struct NetBodySink {
+    ChunkSlot* slot;
+    bool stalled;
+};
+
+static bool netBodySink(void* ctx, const uint8_t* data, size_t len) {
+    NetBodySink* s = (NetBodySink*)ctx;
+    if (dashResp.bodyBytes + len > FULLSCREEN_BMP_SIZE) return false;
+    while (len > 0) {
+        if (netAbort) return false;
+        if (!s->slot) {
+            s->slot = chunkpipe_acquire(&netPipe);
+            if (!s->slot) {
+                if (!s->stalled) CCTRACE_INSTANT(TRACE_TASK_NET, "pipe full", 0);
+                s->stalled = true;
+                vTaskDelay(1);   // Decoder is behind
+                continue;
+            }
+            s->stalled = false;
+        }
+        size_t n = NET_CHUNK_SIZE - s->slot->len;
+        if (n > len) n = len;
+        memcpy(s->slot->data + s->slot->len, data, n);
+        s->slot->len += n;
+        data += n;
+        len -= n;
+        if (s->slot->len == NET_CHUNK_SIZE) {
+            chunkpipe_commit(&netPipe);
+            CCTRACE_INSTANT(TRACE_TASK_NET, "chunk", NET_CHUNK_SIZE);
+            s->slot = nullptr;
+        }
+    }
+    return true;
+}
+
+void netFetchTask(void* arg) {
+    const char* url = (const char*)arg;
+    int status = 0;
+    {
+        TlsClient client;
+
+        CCTRACE_BEGIN(TRACE_TASK_NET, "http");
+        int code = dashboardGet(client, url);
+        CCTRACE_END(TRACE_TASK_NET, "http");
+        int64_t len = dashResp.contentLength;
+        if (code != 200) {
+            status = code;
+        } else if (len == 0 || len > FULLSCREEN_BMP_SIZE) {
+            status = -2;
+        } else {
+            NetBodySink sink = { nullptr, false };
+            CCTRACE_BEGIN(TRACE_TASK_NET, "body");
+            int rc = dashboardBody(netBodySink, &sink);
+            CCTRACE_END(TRACE_TASK_NET, "body");
+            if (sink.slot) chunkpipe_commit(&netPipe);   // Last partial chunk
+            if (rc < 0 && !netAbort) status = rc;        // Aborted: the decoder has the reason
+        }
+        dashboardEnd(client);
+    }
+
+    ChunkSlot* slot;
+    while (!(slot = chunkpipe_acquire(&netPipe))) vTaskDelay(1);
+    slot->flags = CHUNK_FLAG_END | (status ? CHUNK_FLAG_ERROR : 0);
+    slot->status = status;
+    chunkpipe_commit(&netPipe);
+    vTaskDelete(nullptr);
+}
+
+/**
+ * Core 1: decode chunks into a back slot of the frame cache while core 0
+ * is still downloading, then draw it. A frame identical to the one on the
+ * panel is not drawn (frameUnchanged) unless forceDraw.
+ */
+bool fetchFullScreenBMPDualCore(bool forceDraw) {
+    if (strlen(webhookUrl) == 0) return false;
+
+    static char url[sizeof(webhookUrl) + 16];
+    snprintf(url, sizeof(url), "%s?format=bmp", webhookUrl);
 
-    if (read != len) {
-        Serial.printf("[Fetch] Read mismatch: %d vs %d\n", read, len);
+    chunkpipe_reset(&netPipe);
+    netAbort = false;
+    unsigned long startMs = millis();
+    if (xTaskCreatePinnedToCore(netFetchTask, "ccnet", NET_TASK_STACK, url,
+                                NET_TASK_PRIORITY, nullptr, NET_TASK_CORE) != pdPASS) {
+        CCLOG_E("[Fetch] Net task create failed");
         return false;
     }
 
-    if (zoneBmpBuffer[0] != 'B' || zoneBmpBuffer[1] != 'M') {
-        Serial.printf("[Fetch] Not BMP: 0x%02X 0x%02X\n", zoneBmpBuffer[0], zoneBmpBuffer[1]);
+    FrameBuffer* back = framecache_begin(&frameCache, false);
+    FrameBufferSink backState;
+    static RotateSink backRot;      // 1 KB strip, kept off the loop stack
+    RowSink backSink = frameSink(&backState, &backRot, back);
+    BmpStream bmp;
+    bmp_stream_init(&bmp, &backSink, 0, 0);
+
+    int result = BMP_STREAM_MORE;
+    int status = 0;
+    uint32_t bytes = 0;
+    unsigned long firstChunkMs = 0;
+    unsigned long decodeUs = 0;
+    for (;;) {
+        const ChunkSlot* c = chunkpipe_peek(&netPipe);
+        if (!c) {
+            vTaskDelay(1);
+            continue;
+        }
+        if (c->len > 0 && result == BMP_STREAM_MORE) {
+            if (!firstChunkMs) firstChunkMs = millis() - startMs;
+            unsigned long t0 = micros();
+            CCTRACE_BEGIN(TRACE_TASK_LOOP, "decode");
+            result = bmp_stream_feed(&bmp, c->data, c->len);
+            CCTRACE_END(TRACE_TASK_LOOP, "decode");
+            decodeUs += micros() - t0;
+            bytes += c->len;
+            if (result < 0) netAbort = true;   // Bad image - stop downloading
+        }
+        bool end = c->flags & CHUNK_FLAG_END;
+        status = c->status;
+        chunkpipe_release(&netPipe);
+        if (end) break;
+    }
+
+    CCLOG_I("[Fetch] %u B, first chunk %lu ms, done %lu ms, decode %lu us, net stalls %u, max depth %u",
+            bytes, firstChunkMs, millis() - startMs, decodeUs,
+            netPipe.producerStalls, netPipe.maxDepth);
+    // Download and decode overlap here: body is first chunk -> last chunk decoded
+    metrics_phase(&metrics.http, firstChunkMs);
+    metrics_phase(&metrics.body, millis() - startMs - firstChunkMs);
+    metrics.lastHttpStatus = status ? status : 200;
+    metrics.lastFetchBytes = bytes;
+
+    if (status != 0) {
+        framecache_abort(&frameCache);
+        CCLOG_E("[Fetch] HTTP %d", status);
+        if (status == 400) {
+            CCLOG_W("[Fetch] Invalid token - clearing pairing");
+            webhookUrl[0] = '\0';
+            devicePaired = false;
+            saveSettings();
+        }
+        return false;
+    }
+    if (result != BMP_STREAM_DONE) {
+        framecache_abort(&frameCache);
+        CCLOG_E("[Fetch] BMP stream failed: %d", result);
         return false;
     }
 
-    Serial.println("[Fetch] Loading BMP to display...");
-    int result = bbep->loadBMP(zoneBmpBuffer, 0, 0, BBEP_BLACK, BBEP_WHITE);
+    int cached = framecache_commit(&frameCache);
+    FrameCacheSlot* front = framecache_front(&frameCache);
+    zoneBmpBuffer = front->bmp;
+    shadowFb = front->fb;   // Shadow sink (BLE push, offline) follows the front slot
+    lastLiveUnix = currentUnixTime();
+    if (dashSlice[0]) storeTimetableSlice(dashSlice);
 
-    if (result == BBEP_SUCCESS) {
-        Serial.println("[Fetch] BMP loaded successfully");
+    if (cached == FRAMECACHE_UNCHANGED && !forceDraw) {
+        frameUnchanged = true;
         return true;
-    } else {
-        Serial.printf("[Fetch] loadBMP failed: %d\n", result);
+    }
+
+    unsigned long t0 = millis();
+    CCTRACE_BEGIN(TRACE_TASK_PANEL, "loadBMP");
+    int rc = bbep->loadBMP(zoneBmpBuffer, 0, 0, BBEP_BLACK, BBEP_WHITE);
+    CCTRACE_END(TRACE_TASK_PANEL, "loadBMP");
+    metrics_phase(&metrics.load, millis() - t0);
+    CCLOG_I("[Fetch] loadBMP %lu ms (cache %s, hits %u)", millis() - t0,
+            cached == FRAMECACHE_HIT ? "hit" : cached == FRAMECACHE_NEW ? "new" : "same",
+            frameCache.hits);
+    if (rc != BBEP_SUCCESS) {
+        CCLOG_E("[Fetch] loadBMP failed: %d", rc);
+        framecache_dirty_front(&frameCache);
+        return false;
+    }
+    return true;
+}
+#endif
+
+// ============================================================================
+// FRESHNESS CHECK (fresh-check.h)
+// ============================================================================
+// One UDP round trip to the paired responder before each poll: an
+// authenticated "unchanged" skips the TCP connect, TLS handshake and body.
+// No reply in FRESH_TIMEOUT_MS (UDP blocked, responder down) means a normal
+// fetch, so the check can only add that timeout to a poll, never lose one.
+
+static WiFiUDP freshUdp;
+
+struct FreshKeys {
+    uint8_t key[32];          // HMAC-SHA256(PSK, "cc-fresh-v1")
+    uint8_t deviceId[FRESH_DEVICE_ID_BYTES];
+};
+
+static void freshMac(void* ctx, const uint8_t* data, size_t len, uint8_t out[32]) {
+    const FreshKeys* k = (const FreshKeys*)ctx;
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), k->key, sizeof(k->key), data, len, out);
+}
+
+static bool freshKeys(FreshKeys* k) {
+    uint8_t psk[32];
+    size_t pskLen = strlen(pskKey) / 2;
+    if (pskLen == 0 || pskLen > sizeof(psk)) return false;
+    for (size_t i = 0; i < pskLen; i++) {
+        char hex[3] = { pskKey[2 * i], pskKey[2 * i + 1], '\0' };
+        psk[i] = (uint8_t)strtoul(hex, nullptr, 16);
+    }
+    static const char label[] = "cc-fresh-v1";
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), psk, pskLen,
+                    (const uint8_t*)label, sizeof(label) - 1, k->key);
+
+    const char* token;
+    size_t tokenLen = fresh_url_token(webhookUrl, &token);
+    if (tokenLen == 0) return false;
+    uint8_t digest[32];
+    mbedtls_sha256((const uint8_t*)token, tokenLen, digest, 0);
+    memcpy(k->deviceId, digest, FRESH_DEVICE_ID_BYTES);
+    return true;
+}
+
+/**
+ * Ask the responder whether the frame with shownZones is still current.
+ * Returns a FreshStatus; FRESH_NO_REPLY if nothing valid came back.
+ */
+int freshCheck(FreshReply* reply) {
+    char host[FRESH_ENDPOINT_MAX];
+    uint16_t port;
+    FreshKeys keys;
+    if (!fresh_endpoint(freshEndpoint, host, sizeof(host), &port) || !freshKeys(&keys)) return FRESH_NO_REPLY;
+
+    FreshQuery q;
+    q.identity = pskIdentity;
+    memcpy(q.deviceId, keys.deviceId, sizeof(q.deviceId));
+    q.nonce = esp_random();
+    q.count = shownZones.count;
+    q.hash = shownZones.hash;
+    uint8_t buf[FRESH_QUERY_MAX];
+    size_t len = fresh_encode_query(&q, buf, sizeof(buf), freshMac, &keys);
+    if (len == 0 || !freshUdp.begin(0)) return FRESH_NO_REPLY;
+
+    int status = FRESH_NO_REPLY;
+    unsigned long t0 = millis();
+    if (freshUdp.beginPacket(host, port) && freshUdp.write(buf, len) == len && freshUdp.endPacket()) {
+        while (millis() - t0 < FRESH_TIMEOUT_MS) {
+            int n = freshUdp.parsePacket();
+            if (n <= 0) {
+                delay(2);
+                continue;
+            }
+            n = freshUdp.read(buf, sizeof(buf));
+            // Anything else (stray or replayed datagram) is ignored
+            if (n > 0 && fresh_decode_reply(buf, (size_t)n, q.nonce, reply, freshMac, &keys)) {
+                status = reply->status;
+                break;
+            }
+        }
+    }
+    freshUdp.stop();
+    return status;
+}
+
+/** true if the responder vouched that the panel already shows the current frame */
+static bool freshUnchanged() {
+    if (!freshEndpoint[0] || shownZones.count == 0 || !fresh_should_try(&freshState)) return false;
+
+    FreshReply reply;
+    unsigned long t0 = millis();
+    CCTRACE_BEGIN(TRACE_TASK_LOOP, "fresh check");
+    int status = freshCheck(&reply);
+    CCTRACE_END(TRACE_TASK_LOOP, "fresh check");
+    metrics_phase(&metrics.fresh, millis() - t0);
+    fresh_record(&freshState, status);
+
+    switch (status) {
+        case FRESH_UNCHANGED:
+            metrics.freshUnchanged++;
+            CCLOG_I("[Fresh] Unchanged (%lu ms) - no fetch", (unsigned long)metrics.fresh.lastMs);
+            return true;
+        case FRESH_CHANGED:
+            metrics.freshChanged++;
+            CCLOG_I("[Fresh] Zones changed 0x%08lx of %u", (unsigned long)reply.changed, (unsigned)reply.zones);
+            return false;
+        case FRESH_UNKNOWN:
+            metrics.freshUnknown++;
+            CCLOG_I("[Fresh] Server does not know this device yet");
+            return false;
+        default:
+            metrics.freshNoReply++;
+            CCLOG_W("[Fresh] No reply from %s in %d ms", freshEndpoint, FRESH_TIMEOUT_MS);
+            return false;
+    }
+}
+
+#ifdef CC_LOCAL_RENDER
+// ============================================================================
+// LOCAL RENDER (data model patches)
+// ============================================================================
+
+static bool modelBodySink(void* ctx, const uint8_t* data, size_t len) {
+    (void)ctx;
+    if (dashResp.bodyBytes + len > sizeof(dashModelBuf)) return false;
+    memcpy(dashModelBuf + dashResp.bodyBytes, data, len);
+    return true;
+}
+
+/**
+ * Patch dashModel from ?format=model, draw the regions that changed (all
+ * of them if forceAll) into the shadow framebuffer and load it. A patch for a version we no longer hold, or
+ * one whose result fails the check, is retried once as a full model.
+ * Sets frameUnchanged if nothing needs drawing.
+ */
+bool fetchModelUpdate(bool forceAll) {
+    if (strlen(webhookUrl) == 0 || !zoneBmpBuffer) return false;
+
+    static char url[sizeof(webhookUrl) + 32];
+    uint32_t regions = 0;
+    size_t bodyLen = 0;
+    int rc = DASHMODEL_ERR_FORMAT;
+    unsigned long fetchStart = millis();
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        TlsClient client;
+        snprintf(url, sizeof(url), "%s?format=model&mv=%u", webhookUrl, (unsigned)dashModel.version);
+        unsigned long httpStart = millis();
+        CCTRACE_BEGIN(TRACE_TASK_LOOP, "http");
+        int code = dashboardGet(client, url);
+        CCTRACE_END(TRACE_TASK_LOOP, "http");
+        metrics_phase(&metrics.http, millis() - httpStart);
+        metrics.lastHttpStatus = code;
+        if (code != 200) {
+            CCLOG_E("[Model] HTTP %d", code);
+            dashboardEnd(client);
+            return false;
+        }
+        unsigned long bodyStart = millis();
+        CCTRACE_BEGIN(TRACE_TASK_LOOP, "body");
+        int body = dashboardBody(modelBodySink, nullptr);
+        bodyLen = dashResp.bodyBytes;
+        dashboardEnd(client);
+        CCTRACE_END(TRACE_TASK_LOOP, "body");
+        if (body < 0) {
+            CCLOG_E("[Model] Body failed: %d (%u B)", body, (unsigned)bodyLen);
+            return false;
+        }
+        metrics_phase(&metrics.body, millis() - bodyStart);
+
+        rc = dashmodel_apply(&dashModel, &dashModelNext, dashModelBuf, bodyLen, &regions);
+        if (rc == DASHMODEL_OK) break;
+        CCLOG_W("[Model] Patch rejected (%d) - asking for the full model", rc);
+        dashModel.version = 0;
+        if (rc != DASHMODEL_ERR_VERSION && rc != DASHMODEL_ERR_CHECK) return false;
+    }
+    if (rc != DASHMODEL_OK) return false;
+
+    dashModel = dashModelNext;
+    metrics.lastFetchBytes = bodyLen;
+    lastLiveUnix = currentUnixTime();
+    if (dashSlice[0]) storeTimetableSlice(dashSlice);
+    CCLOG_I("[Model] v%u, %u B, regions 0x%04x in %lu ms", (unsigned)dashModel.version,
+            (unsigned)bodyLen, (unsigned)regions, millis() - fetchStart);
+
+    if (forceAll) regions = DASH_REGION_ALL;
+    if (regions == 0) {
+        frameUnchanged = true;
+        return true;
+    }
+    unsigned long loadStart = millis();
+    CCTRACE_SCOPE(TRACE_TASK_PANEL, "render model");
+    SinkDisplay display = shadowDisplay();
+    if (regions == DASH_REGION_ALL) display.fillScreen(DASH_WHITE);
+    dash_render_model(display, display.width(), display.height(), &dashModel, regions);
+#ifdef CC_DUAL_CORE
+    if (dualCoreReady) framecache_dirty_front(&frameCache);   // Drawn over the front slot
+#endif
+    int result = bbep->loadBMP(zoneBmpBuffer, 0, 0, BBEP_BLACK, BBEP_WHITE);
+    metrics_phase(&metrics.load, millis() - loadStart);
+    if (result != BBEP_SUCCESS) {
+        CCLOG_E("[Model] loadBMP failed: %d", result);
+        dashModel.version = 0;   // The shadow is ahead of the panel - redraw it all next time
         return false;
     }
+    return true;
 }
+#endif
 
 bool fetchZoneUpdates(bool forceAll) {
-    return fetchFullScreenBMP();
+    CCTRACE_SCOPE(TRACE_TASK_LOOP, "fetch");
+    frameUnchanged = false;
+    if (!forceAll && freshUnchanged()) {
+        frameUnchanged = true;
+        lastLiveUnix = currentUnixTime();   // Confirmed current, as good as a fetch
+        return true;
+    }
+#if defined(CC_LOCAL_RENDER)
+    bool ok = fetchModelUpdate(forceAll);
+#elif defined(CC_DUAL_CORE)
+    bool ok = dualCoreReady ? fetchFullScreenBMPDualCore(forceAll) : fetchFullScreenBMP();
+#else
+    bool ok = fetchFullScreenBMP();
+#endif
+    // Zones the panel now shows, for the next freshness check
+    if (ok) shownZones = dashZones; else zonesync_clear(&shownZones);
+#ifdef CC_PAGE_CACHE
+    if (ok && dashPages.count > 0) serverPages = dashPages;
+#endif
+    metrics_fetch_done(&metrics, ok);
+    CCTRACE_COUNTER(TRACE_TASK_LOOP, "free heap", ESP.getFreeHeap());
+    return ok;
 }
 
 void doFullRefresh() {
+    CCTRACE_SCOPE(TRACE_TASK_PANEL, "refresh full");   // Includes the BUSY wait
     bbep->refresh(REFRESH_FULL, true);
 }
+
+#ifdef CC_PAGE_CACHE
+// ============================================================================
+// BUTTON PAGES (flash page cache)
+// ============================================================================
+
+static bool pageFlashRead(void* ctx, uint32_t addr, void* buf, size_t len) {
+    return esp_partition_read((const esp_partition_t*)ctx, addr, buf, len) == ESP_OK;
+}
+
+static bool pageFlashWrite(void* ctx, uint32_t addr, const void* buf, size_t len) {
+    return esp_partition_write((const esp_partition_t*)ctx, addr, buf, len) == ESP_OK;
+}
+
+static bool pageFlashErase(void* ctx, uint32_t addr, size_t len) {
+    return esp_partition_erase_range((const esp_partition_t*)ctx, addr, len) == ESP_OK;
+}
+
+void initPageCache() {
+    pagePartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, nullptr);
+    if (!pagePartition) {
+        Serial.println("[Pages] No SPIFFS partition - page cache off");
+        return;
+    }
+    PageFlash flash = { pageFlashRead, pageFlashWrite, pageFlashErase, (void*)pagePartition,
+                        (uint32_t)pagePartition->size, SPI_FLASH_SEC_SIZE };
+    pageCacheReady = pagecache_init(&pageCache, &flash) > 0;
+    int cached = 0;
+    for (int i = 0; i < pageCache.slots; i++) cached += pageCache.slot[i].valid;
+    Serial.printf("[Pages] %u slots of %u B, %d pages cached\n", (unsigned)pageCache.slots,
+                  (unsigned)PAGECACHE_SLOT_BYTES, cached);
+}
+
+static bool pageBodySink(void* ctx, const uint8_t* data, size_t len) {
+    (void)ctx;
+    return pagecache_write(&pageCache, data, len);
+}
+
+/**
+ * Fetch serverPages[index] into the page cache (?format=page). The hash of
+ * a cached copy goes along so an unchanged page is a 304 and no flash
+ * write. Returns the page's slot, -1 on failure.
+ */
+static int fetchPage(int index) {
+    if (WiFi.status() != WL_CONNECTED || strlen(webhookUrl) == 0) return -1;
+    const PageDef* page = &serverPages.page[index];
+    int cached = pagecache_find(&pageCache, page->id);
+    static char url[sizeof(webhookUrl) + 48];
+    if (cached >= 0) {
+        snprintf(url, sizeof(url), "%s?format=page&page=%s&ph=%08lx", webhookUrl, page->id,
+                 (unsigned long)pageCache.slot[cached].hash);
+    } else {
+        snprintf(url, sizeof(url), "%s?format=page&page=%s", webhookUrl, page->id);
+    }
+
+    CCTRACE_SCOPE(TRACE_TASK_LOOP, "page fetch");
+    TlsClient client;
+    unsigned long t0 = millis();
+    int code = dashboardGet(client, url);
+    if (code == 304 && cached >= 0) {
+        dashboardEnd(client);
+        pageCache.slot[cached].checkedUnix = currentUnixTime();
+        CCLOG_I("[Pages] %s unchanged (%lu ms)", page->id, millis() - t0);
+        return cached;
+    }
+    if (code != 200 || dashResp.contentLength > PAGECACHE_FRAME_MAX) {
+        CCLOG_E("[Pages] %s: HTTP %d, %ld B", page->id, code, (long)dashResp.contentLength);
+        dashboardEnd(client);
+        return -1;
+    }
+
+    int slot = pagecache_slot_for(&pageCache, page->id);
+    bool ok = pagecache_write_begin(&pageCache, slot) && dashboardBody(pageBodySink, nullptr) == 200;
+    dashboardEnd(client);
+    if (ok && dashPageHashSet && pageCache.writeHash != dashPageHash) {
+        CCLOG_E("[Pages] %s: hash %08lx, server sent %08lx", page->id,
+                (unsigned long)pageCache.writeHash, (unsigned long)dashPageHash);
+        ok = false;
+    }
+    if (!ok || pagecache_write_end(&pageCache, page->id, currentUnixTime()) < 0) {
+        pagecache_write_abort(&pageCache);
+        CCLOG_E("[Pages] %s: body or flash write failed (%lu B)", page->id, (unsigned long)dashResp.bodyBytes);
+        return -1;
+    }
+    CCLOG_I("[Pages] %s cached in slot %d: %lu B in %lu ms", page->id, slot,
+            (unsigned long)pageCache.slot[slot].len, millis() - t0);
+    return slot;
+}
+
+static bool pageDecodeSink(void* ctx, const uint8_t* data, size_t len) {
+    return frame_decoder_feed((FrameDecoder*)ctx, data, len) == FRAME_OK;
+}
+
+/**
+ * Read a cached page from flash into the shadow framebuffer, checking its
+ * hash. The shadow no longer holds the dashboard either way.
+ */
+bool decodeCachedPage(int slot) {
+    CCTRACE_SCOPE(TRACE_TASK_LOOP, "page read + decode");
+    static FrameDecoder dec;
+    static uint8_t chunk[PAGE_READ_CHUNK];
+    if (!zoneBmpBuffer) return false;
+    int w, h;
+    fb_rotated_size(&shadowFb, displayRotation, &w, &h);
+    frame_decoder_init(&dec, &shadowSink, w, h);
+    bool ok = pagecache_stream(&pageCache, slot, chunk, sizeof(chunk), pageDecodeSink, &dec) &&
+              dec.zonesDone > 0 && dec.headerLen == 0;
+    if (!ok) frame_decoder_reset(&dec);
+#ifdef CC_DUAL_CORE
+    // Decoded straight into the front slot - its hash is stale
+    if (dualCoreReady) framecache_dirty_front(&frameCache);
+#endif
+    zonesync_clear(&shownZones);   // Not a server frame - the next poll must fetch
+    return ok;
+}
+
+static bool drawCachedPage(int slot) {
+    unsigned long t0 = millis();
+    if (!decodeCachedPage(slot)) {
+        // A hash mismatch already dropped it; a frame that hashes fine but
+        // does not decode would fail on every press
+        if (pageCache.slot[slot].valid) pagecache_drop(&pageCache, slot);
+        CCLOG_E("[Pages] Slot %d failed to decode - dropped", slot);
+        return false;
+    }
+    unsigned long decodeMs = millis() - t0;
+    t0 = millis();
+    CCTRACE_BEGIN(TRACE_TASK_PANEL, "loadBMP");
+    bbep->loadBMP(zoneBmpBuffer, 0, 0, BBEP_BLACK, BBEP_WHITE);
+    CCTRACE_END(TRACE_TASK_PANEL, "loadBMP");
+    CCTRACE_BEGIN(TRACE_TASK_PANEL, "refresh partial");
+    bbep->refresh(REFRESH_PARTIAL, true);
+    CCTRACE_END(TRACE_TASK_PANEL, "refresh partial");
+    partialRefreshCount++;
+    CCLOG_I("[Pages] %s from flash: %lu B, read+decode %lu ms, panel %lu ms", pageCache.slot[slot].id,
+            (unsigned long)pageCache.slot[slot].len, decodeMs, millis() - t0);
+    return true;
+}
+
+/**
+ * Show serverPages[index]: from flash when cached, then refreshed behind
+ * it if stale (redrawn only if it changed); fetched first otherwise.
+ */
+static void showPage(int index) {
+    const PageDef* page = &serverPages.page[index];
+    int slot = pagecache_find(&pageCache, page->id);
+    bool fetched = slot < 0;
+    if (fetched) slot = fetchPage(index);
+    if (slot < 0 || !drawCachedPage(slot)) {
+        CCLOG_W("[Pages] %s unavailable", page->id);
+        return;
+    }
+    shownPage = index;
+    pageShownAt = millis();
+    if (fetched || !pagecache_stale(&pageCache.slot[slot], page->maxAge, currentUnixTime())) return;
+
+    uint32_t shownHash = pageCache.slot[slot].hash;
+    int fresh = fetchPage(index);
+    if (fresh >= 0 && pageCache.slot[fresh].hash != shownHash) drawCachedPage(fresh);
+}
+
+// Between polls: bring one stale page up to date, so presses find it in flash
+static void prefetchStalePage(unsigned long now) {
+    uint32_t nowUnix = currentUnixTime();
+    if (nowUnix == 0 || (long)(now - pagePrefetchAfter) < 0) return;
+    for (int i = 1; i < serverPages.count; i++) {
+        const PageDef* page = &serverPages.page[i];
+        int slot = pagecache_find(&pageCache, page->id);
+        if (slot >= 0 && !pagecache_stale(&pageCache.slot[slot], page->maxAge, nowUnix)) continue;
+        if (fetchPage(i) < 0) pagePrefetchAfter = now + PAGE_PREFETCH_RETRY_MS;
+        return;   // One per pass - the next poll is not held up
+    }
+}
+
+/**
+ * From STATE_IDLE. A short press shows the next page; pressing past the
+ * last one brings the dashboard back. A page stays up for PAGE_HOLD_MS
+ * with no dashboard polls behind it. Returns whether the dashboard fetch
+ * should run now.
+ */
+bool servicePages(unsigned long now, bool fetchDue) {
+    bool pressed = pagePressPending;
+    pagePressPending = false;
+    if (!pageCacheReady || serverPages.count < 2) return fetchDue;
+
+    if (pressed) {
+        int next = (shownPage + 1) % serverPages.count;
+        if (next == 0) return true;
+        showPage(next);
+        return false;
+    }
+    if (shownPage != 0) return now - pageShownAt >= PAGE_HOLD_MS;
+    if (!fetchDue) prefetchStalePage(now);
+    return fetchDue;
+}
+#endif
+
+// ============================================================================
+// OFFLINE TIMETABLE
+// ============================================================================
+
+void initClock() {
+    // Non-blocking: SNTP syncs in the background, the clock keeps running
+    // if WiFi drops later. All slice maths is in UTC.
+    configTime(0, 0, "pool.ntp.org", "time.google.com");
+}
+
+uint32_t currentUnixTime() {
+    time_t t = time(nullptr);
+    return (uint32_t)t >= TIME_VALID_AFTER ? (uint32_t)t : 0;
+}
+
+void storeTimetableSlice(const char* encoded) {
+    size_t encodedLen = strlen(encoded);
+    if (decode_base64_length((const unsigned char*)encoded, encodedLen) > SLICE_MAX_BYTES) {
+        CCLOG_W("[Slice] Too large: %u chars", (unsigned)encodedLen);
+        return;
+    }
+
+    uint8_t raw[SLICE_MAX_BYTES];
+    size_t len = decode_base64((const unsigned char*)encoded, encodedLen, raw);
+    if (!slice_parse(raw, len, &offlineSlice)) {
+        CCLOG_W("[Slice] Invalid slice - ignored");
+        return;
+    }
+
+    memcpy(rtcSliceData, raw, len);
+    rtcSliceLen = len;
+    rtcSliceMagic = SLICE_RTC_MAGIC;
+    offlineSliceValid = true;
+
+    unsigned long now = millis();
+    if (!slicePersisted || now - lastSlicePersist >= SLICE_NVS_INTERVAL_MS) {
+        preferences.begin("cc-device", false);
+        preferences.putBytes("tt_slice", raw, len);
+        preferences.end();
+        slicePersisted = true;
+        lastSlicePersist = now;
+    }
+    CCLOG_I("[Slice] Stored %u bytes, %d legs, %d min horizon",
+            (unsigned)len, offlineSlice.legCount, offlineSlice.horizonMinutes);
+}
+
+void loadTimetableSlice() {
+    if (rtcSliceMagic == SLICE_RTC_MAGIC && rtcSliceLen <= SLICE_MAX_BYTES &&
+        slice_parse(rtcSliceData, rtcSliceLen, &offlineSlice)) {
+        offlineSliceValid = true;
+        CCLOG_I("[Slice] Restored from RTC memory");
+        return;
+    }
+
+    uint8_t raw[SLICE_MAX_BYTES];
+    preferences.begin("cc-device", true);
+    size_t len = preferences.getBytesLength("tt_slice");
+    if (len > 0 && len <= SLICE_MAX_BYTES) {
+        len = preferences.getBytes("tt_slice", raw, len);
+    } else {
+        len = 0;
+    }
+    preferences.end();
+
+    if (len > 0 && slice_parse(raw, len, &offlineSlice)) {
+        memcpy(rtcSliceData, raw, len);
+        rtcSliceLen = len;
+        rtcSliceMagic = SLICE_RTC_MAGIC;
+        offlineSliceValid = true;
+        slicePersisted = true;
+        CCLOG_I("[Slice] Restored from NVS");
+    }
+}
+
+bool renderOfflineDashboard() {
+    uint32_t nowUnix = currentUnixTime();
+    if (!offlineSliceValid || nowUnix == 0 || !zoneBmpBuffer) return false;
+    if (slice_expired(&offlineSlice, nowUnix)) {
+        CCLOG_W("[Offline] Stored timetable expired");
+        return false;
+    }
+
+    SlicePlan plan;
+    slice_plan(&offlineSlice, nowUnix, &plan);
+
+    CCLOG_I("[Offline] Rendering scheduled view (leave in %d min)", plan.leaveInMinutes);
+    SinkDisplay display = shadowDisplay();
+    dash_render_offline(display, display.width(), display.height(), &offlineSlice, &plan, nowUnix, lastLiveUnix);
+#ifdef CC_DUAL_CORE
+    if (dualCoreReady) framecache_dirty_front(&frameCache);   // Drawn over the front slot
+#endif
+    zonesync_clear(&shownZones);   // Not a server frame - the next poll must fetch
+    int result = bbep->loadBMP(zoneBmpBuffer, 0, 0, BBEP_BLACK, BBEP_WHITE);
+    if (result != BBEP_SUCCESS) {
+        CCLOG_E("[Offline] loadBMP failed: %d", result);
+        return false;
+    }
+
+    // First offline frame replaces a live one - do a full refresh
+    bbep->refresh(offlineShown ? REFRESH_PARTIAL : REFRESH_FULL, true);
+    offlineShown = true;
+    return true;
+}
+
+void maybeShowOfflineDashboard() {
+    unsigned long now = millis();
+    if (offlineShown && now - lastOfflineRender < OFFLINE_RENDER_INTERVAL_MS) return;
+    if (renderOfflineDashboard()) lastOfflineRender = now;
+}
+
+// Idle delay that still answers the serial shell, notices a long-press and
+// serves diagnostic requests. Returns early on a page button press.
+void idleWait(unsigned long ms) {
+    unsigned long start = millis();
+    while (millis() - start < ms) {
+        pollSerialShell();
+        pollDiagButton(millis());
+        serviceDiagServer();
+#ifdef CC_PAGE_CACHE
+        if (pagePressPending) return;
+#endif
+        delay(diagActive ? 5 : DIAG_POLL_MS);
+    }
+}
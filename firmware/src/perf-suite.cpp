@@ -0,0 +1,724 @@
+/**
+ * CCFirm™ — Performance Regression Suite (host, env:native-perf)
+ * Part of the Commute Compute System™
+ *
+ * One run covers:
+ *   - microbenchmarks of the shared device code on the host: BMP stream
+ *     decode, zone blit, frame hash, base64 decode (table-driven, in-place
+ *     and the old compare chain), JSON lookup, PackBits encode + CCZF
+ *     decode, 90°/180° frame rotation and per-pixel 90° for the ratio
+ *     (best of several runs of several batches, so they are stable enough
+ *     to compare on one machine)
+ *   - a simulated day per firmware env in platformio.ini: the env's fetch
+ *     schedule (include/fetch-policy.h, or byos-client.h for the BYOS
+ *     client) on a simulated 24 h clock with a seeded failure rate, giving
+ *     requests, bytes, full/partial refreshes and radio-on time per day.
+ *     Radio time comes from a per-env link and CPU model (see PROFILES)
+ *     and is deterministic for a given seed.
+ *
+ * micro.* values are in calibration units - time per call divided by a
+ * fixed FNV-1a pass timed alongside each batch - so a busy host or a
+ * different machine of the same kind does not read as a regression. Raw
+ * host microseconds are reported under "hostUs" for reference.
+ *
+ * Each env's metrics are compared with its committed baseline in
+ * perf/<env>.json. Every metric is "lower is better"; one that grew by more
+ * than the threshold (--threshold for micro.*, --day-threshold for day.*)
+ * is a regression and the exit status is 1. The old implementations kept
+ * for a ratio (REFERENCE_METRICS) are reported but never gate.
+ *
+ *   program [--env all|<env>] [--threshold 30] [--day-threshold 1]
+ *           [--baseline-dir perf] [--ini platformio.ini]
+ *           [--write-baseline] [--out report.json]
+ *           [--fail-rate 0.02] [--seed 1] [--batches 15] [--runs 3]
+ *
+ * Prints one JSON report per env. After an intended change (or on a new
+ * kind of machine) refresh the baselines with --write-baseline.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "row-sink.h"
+#include "bmp-stream.h"
+#include "frame-cache.h"
+#include "frame-codec.h"
+#include "fetch-policy.h"
+#include "json-scan.h"
+#include "base64.hpp"
+#include "fb-rotate.h"
+#include "byos-client.h"
+
+#define PERF_W            800
+#define PERF_H            480
+#define PERF_CHUNK        4096
+#define DAY_MS            (24UL * 3600UL * 1000UL)
+#define PAGE_RETRY_MS     60000         // PAGE_PREFETCH_RETRY_MS in main.cpp
+
+typedef std::chrono::steady_clock Clock;
+typedef std::vector<std::pair<std::string, double> > Metrics;
+
+// ============================================================================
+// ENV PROFILES
+// ============================================================================
+
+/**
+ * What one firmware env does over a day. Keep in step with platformio.ini
+ * and the env's build flags; main() refuses to run if a ccfirm-* env there
+ * has no profile here. Costs are estimates of the device, not host
+ * measurements (bench-pipeline.cpp measures the overlap for a given set).
+ */
+enum EnvSchedule {
+    SCHEDULE_POLICY = 0,          // main.cpp: fetch-policy.h, always connected
+    SCHEDULE_BYOS = 1             // main-byos.cpp: deep sleep, wake every refresh_rate
+};
+
+struct EnvProfile {
+    const char* env;
+    EnvSchedule schedule;
+    PolicyMode mode;
+    PolicyTransport transport;
+    uint32_t bodyBytes;           // Full-screen fetch response body (BYOS: the image)
+    uint32_t tierBytes[4];        // Tiered: body per tier fetch
+    uint32_t requestBytes;        // Request line + headers sent
+    uint32_t responseHeaderBytes;
+    double connectMs;             // DNS + TCP + TLS handshake (new client per fetch)
+    double wireUsPerKb;           // Effective WiFi + server rate
+    double tlsUsPerKb;            // Record decrypt (CPU)
+    double decodeUsPerKb;         // Row decode + blit (CPU)
+    bool pipelined;               // CC_DUAL_CORE: network and decode overlap
+    uint32_t pageBytes;           // CC_PAGE_CACHE: one button page as CCZF
+    uint32_t pageMaxAgeS[3];      // CC_PAGE_CACHE: refetched once older (device-pages.js)
+    uint32_t displayBytes;        // BYOS: /api/display reply
+    double wakeMs;                // BYOS: WiFi association after each deep sleep
+};
+
+static const EnvProfile PROFILES[] = {
+    // ESP32-C3 production firmware: full-screen BMP every minute, one core
+    { "ccfirm-trmnl-7.1.0", SCHEDULE_POLICY, POLICY_FULL_FRAME, POLICY_POLL, 48062, { 0, 0, 0, 0 }, 420, 260,
+      450, 10000, 450, 300, false, 0, { 0, 0, 0 }, 0, 0 },
+    // Same schedule; BLE push only adds an optional local path
+    { "ccfirm-trmnl-blepush", SCHEDULE_POLICY, POLICY_FULL_FRAME, POLICY_POLL, 48062, { 0, 0, 0, 0 }, 420, 260,
+      450, 10000, 450, 300, false, 0, { 0, 0, 0 }, 0, 0 },
+    // CC_TLS_PROFILE: P-256 only and roots parsed once per boot shorten the
+    // handshake; AES-128-GCM runs on the accelerator
+    { "ccfirm-trmnl-tls", SCHEDULE_POLICY, POLICY_FULL_FRAME, POLICY_POLL, 48062, { 0, 0, 0, 0 }, 420, 260,
+      330, 10000, 250, 300, false, 0, { 0, 0, 0 }, 0, 0 },
+    // CC_LOCAL_RENDER: a data-model patch (~150 B) each minute instead of the
+    // BMP; drawing happens after the connection has closed
+    { "ccfirm-trmnl-localrender", SCHEDULE_POLICY, POLICY_FULL_FRAME, POLICY_POLL, 150, { 0, 0, 0, 0 }, 440, 260,
+      450, 10000, 450, 100, false, 0, { 0, 0, 0 }, 0, 0 },
+    // CC_PAGE_CACHE: the production schedule plus the return, weather and
+    // alerts pages prefetched to flash as they go stale
+    { "ccfirm-trmnl-pages", SCHEDULE_POLICY, POLICY_FULL_FRAME, POLICY_POLL, 48062, { 0, 0, 0, 0 }, 420, 300,
+      450, 10000, 450, 300, false, 11000, { 900, 1800, 600 }, 0, 0 },
+    // ESP32-S3: same schedule, TLS on core 0 overlapped with decode on core 1
+    { "ccfirm-s3-psram", SCHEDULE_POLICY, POLICY_FULL_FRAME, POLICY_POLL, 48062, { 0, 0, 0, 0 }, 420, 260,
+      300, 10000, 300, 200, true, 0, { 0, 0, 0 }, 0, 0 },
+    // CC_TRACE builds: a ring slot per event is noise next to the network
+    { "ccfirm-trmnl-trace", SCHEDULE_POLICY, POLICY_FULL_FRAME, POLICY_POLL, 48062, { 0, 0, 0, 0 }, 420, 260,
+      450, 10000, 450, 300, false, 0, { 0, 0, 0 }, 0, 0 },
+    { "ccfirm-s3-trace", SCHEDULE_POLICY, POLICY_FULL_FRAME, POLICY_POLL, 48062, { 0, 0, 0, 0 }, 420, 260,
+      300, 10000, 300, 200, true, 0, { 0, 0, 0 }, 0, 0 },
+    // TRMNL BYOS client: /api/display then the image every 900 s (the
+    // filename carries the minute, so it always changes), deep sleep between
+    { "ccfirm-trmnl-byos", SCHEDULE_BYOS, POLICY_FULL_FRAME, POLICY_POLL, 48062, { 0, 0, 0, 0 }, 380, 260,
+      450, 10000, 450, 300, false, 0, { 0, 0, 0 }, 900, 1500 },
+};
+
+/**
+ * Reported for the ratio against the code that replaced them, but not
+ * gated: nothing ships them, so their timing drifting is not a regression.
+ */
+static const char* const REFERENCE_METRICS[] = {
+    "micro.base64_decode_branchy",
+    "micro.rotate_90_pixelwise",
+};
+
+// ccfirm-* envs in platformio.ini that are not simulated, and why
+static const char* const UNPROFILED_ENVS[] = {
+    "ccfirm-trmnl-mini-7.1.0",    // Extends env:trmnl, which platformio.ini no longer defines
+};
+
+static bool isReferenceMetric(const std::string& name) {
+    for (size_t i = 0; i < sizeof(REFERENCE_METRICS) / sizeof(REFERENCE_METRICS[0]); i++) {
+        if (name == REFERENCE_METRICS[i]) return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// MICROBENCHMARKS
+// ============================================================================
+
+static volatile uint32_t perfSink;
+static uint8_t calibData[16384];
+
+/**
+ * Fixed reference work (FNV-1a over 16 KB). Every benchmark batch is timed
+ * next to a calibration batch, so a slower or busier host scales both.
+ */
+static void calibrationPass() {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < sizeof(calibData); i++) h = (h ^ calibData[i]) * 16777619u;
+    perfSink += h;
+}
+
+struct Timing {
+    double us;                    // Best time per call
+    double cal;                   // Best time per call / best calibration pass
+};
+
+/**
+ * Min time per call over `batches` batches of `reps` calls, each batch
+ * preceded by a calibration batch
+ */
+template <typename F>
+static Timing timeMin(int batches, int reps, F fn) {
+    Timing t = { 1e30, 0 };
+    double bestCal = 1e30;
+    for (int b = 0; b < batches; b++) {
+        Clock::time_point t0 = Clock::now();
+        for (int r = 0; r < 20; r++) calibrationPass();
+        Clock::time_point t1 = Clock::now();
+        for (int r = 0; r < reps; r++) fn();
+        Clock::time_point t2 = Clock::now();
+        bestCal = std::min(bestCal, std::chrono::duration<double, std::micro>(t1 - t0).count() / 20);
+        t.us = std::min(t.us, std::chrono::duration<double, std::micro>(t2 - t1).count() / reps);
+    }
+    t.cal = t.us / bestCal;
+    return t;
+}
+
+/**
+ * Synthetic dashboard, same pattern as bench-pipeline.cpp
+ */
+static std::vector<uint8_t> makeDashboardBmp() {
+    FrameBuffer fb = { nullptr, 0, 0, 0 };
+    std::vector<uint8_t> out(BMP_SHADOW_HEADER + (PERF_W / 8) * PERF_H);
+    bmp_shadow_init(out.data(), out.size(), PERF_W, PERF_H, &fb);
+    for (int y = 0; y < PERF_H; y++) {
+        for (int x = 0; x < fb.stride; x++) {
+            bool ink = ((y / 12) % 3 == 0) && ((x * 7 + y + 1) % 5 < 2);
+            fb.pixels[y * fb.stride + x] = ink ? (uint8_t)(0x5A ^ (x + 1)) : 0xFF;
+        }
+    }
+    return out;
+}
+
+/**
+ * decode_base64() as it was before base64_lut[]: five range compares per
+ * character. Kept here only as the comparison point.
+ */
+static size_t branchyDecodeBase64(const unsigned char* in, size_t len, unsigned char* out) {
+    size_t n = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = in[i];
+        if (c == '\n' || c == '\r' || c == ' ' || c == '\t') continue;
+        if (c == '=') break;
+        int v;
+        if (c >= 'A' && c <= 'Z') v = c - 'A';
+        else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') v = c - '0' + 52;
+        else if (c == '+') v = 62;
+        else if (c == '/') v = 63;
+        else continue;
+        acc = (acc << 6) | v;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out[n++] = (acc >> bits) & 0xFF;
+        }
+    }
+    return n;
+}
+
+static void record(Metrics* m, Metrics* raw, const char* name, const Timing& t) {
+    m->push_back(std::make_pair(std::string("micro.") + name, t.cal));
+    raw->push_back(std::make_pair(std::string(name) + "_us", t.us));
+}
+
+/**
+ * m: compared metrics (calibration units), raw: host microseconds (reported only)
+ */
+static void runMicro(int batches, Metrics* m, Metrics* raw) {
+    for (int i = 0; i < 500; i++) calibrationPass();   // Warm up clocks and caches
+
+    std::vector<uint8_t> bmp = makeDashboardBmp();
+    std::vector<uint8_t> pixels((PERF_W / 8) * PERF_H);
+    FrameBuffer fb = { pixels.data(), PERF_W, PERF_H, PERF_W / 8 };
+
+    // BMP stream decode, network-sized chunks
+    record(m, raw, "bmp_decode", timeMin(batches, 50, [&]() {
+        FrameBufferSink state;
+        RowSink sink = fbsink_make(&state, &fb);
+        BmpStream s;
+        bmp_stream_init(&s, &sink, 0, 0);
+        for (size_t off = 0; off < bmp.size(); off += PERF_CHUNK) {
+            bmp_stream_feed(&s, bmp.data() + off, std::min((size_t)PERF_CHUNK, bmp.size() - off));
+        }
+        perfSink += (uint32_t)s.state;
+    }));
+
+    // Legs zone blit at an unaligned x (797 x 316)
+    std::vector<uint8_t> zoneRow(100, 0xA5);
+    record(m, raw, "blit_zone", timeMin(batches, 200, [&]() {
+        for (int y = 132; y < 132 + 316; y++) fb_copy_bits(fb.pixels + y * fb.stride, 3, zoneRow.data(), 797);
+        perfSink += fb.pixels[200 * fb.stride];
+    }));
+
+    record(m, raw, "frame_hash", timeMin(batches, 200, [&]() {
+        perfSink += framecache_hash(&fb);
+    }));
+
+    // Tiered zone payload: 6 KB of BMP as base64
+    std::string b64;
+    {
+        static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (size_t i = 0; i < 8000; i++) b64 += alphabet[(bmp[i % bmp.size()] + i) & 63];
+    }
+    std::vector<uint8_t> decoded(decode_base64_length((const unsigned char*)b64.data(), b64.size()));
+    record(m, raw, "base64_decode", timeMin(batches, 200, [&]() {
+        perfSink += (uint32_t)decode_base64((const unsigned char*)b64.data(), b64.size(), decoded.data());
+    }));
+    // The compare-chain decoder the table replaced, for the ratio
+    record(m, raw, "base64_decode_branchy", timeMin(batches, 200, [&]() {
+        perfSink += (uint32_t)branchyDecodeBase64((const unsigned char*)b64.data(), b64.size(), decoded.data());
+    }));
+    // main-tiered.cpp decodes over the received text; the copy back of the
+    // 8 KB payload each call is part of the figure
+    std::vector<uint8_t> work(b64.size());
+    record(m, raw, "base64_decode_inplace", timeMin(batches, 200, [&]() {
+        memcpy(work.data(), b64.data(), b64.size());
+        perfSink += (uint32_t)decode_base64_inplace(work.data(), work.size());
+    }));
+
+    // Pairing reply lookup (main.cpp jsonGetString)
+    const char* reply = "{\"success\":true,\"status\":\"paired\",\"deviceId\":\"cc-7f3a\","
+                        "\"webhookUrl\":\"https://commute.example.app/api/device/eyJhIjp7ImhvbWUiOiIxIEV4YW1wbGUg"
+                        "U3QsIE1lbGJvdXJuZSJ9LCJzIjoiVklDIn0\\/frame?v=2\",\"expiresIn\":600}";
+    size_t replyLen = strlen(reply);
+    char url[256];
+    record(m, raw, "json_pair", timeMin(batches, 20000, [&]() {
+        perfSink += (uint32_t)json_get_string(reply, replyLen, "webhookUrl", url, sizeof(url));
+    }));
+
+    // PackBits encode of the full frame, then CCZF decode back into fb
+    std::vector<uint8_t> packed(pixels.size() + pixels.size() / 128 + 64);
+    std::vector<uint8_t> frame(FRAME_HEADER_SIZE + packed.size());
+    const uint8_t* src = bmp.data() + BMP_SHADOW_HEADER;
+    size_t packedLen = 0;
+    record(m, raw, "packbits_encode", timeMin(batches, 50, [&]() {
+        packedLen = frame_packbits(src, pixels.size(), packed.data(), packed.size());
+        perfSink += (uint32_t)packedLen;
+    }));
+    uint8_t* h = frame.data();
+    memcpy(h, "CCZF", 4);
+    h[4] = FRAME_VERSION;
+    h[5] = 0;
+    bmp_put_u16(h + 6, 0);
+    bmp_put_u16(h + 8, 0);
+    bmp_put_u16(h + 10, PERF_W);
+    bmp_put_u16(h + 12, PERF_H);
+    bmp_put_u32(h + 14, (uint32_t)packedLen);
+    memcpy(h + FRAME_HEADER_SIZE, packed.data(), packedLen);
+    size_t frameLen = FRAME_HEADER_SIZE + packedLen;
+    record(m, raw, "cczf_decode", timeMin(batches, 50, [&]() {
+        FrameBufferSink state;
+        RowSink sink = fbsink_make(&state, &fb);
+        FrameDecoder d;
+        frame_decoder_init(&d, &sink, PERF_W, PERF_H);
+        perfSink += (uint32_t)frame_decoder_feed(&d, frame.data(), frameLen);
+    }));
+    m->push_back(std::make_pair("micro.packbits_ratio_pct", 100.0 * packedLen / pixels.size()));
+
+    // Portrait frame (480 x 800, the dashboard pixels re-read as 60-byte
+    // rows) rotated onto the panel through RotateSink, bottom-up like a BMP
+    const int portraitStride = PERF_H / 8;
+    RotateSink rot;
+    record(m, raw, "rotate_90", timeMin(batches, 50, [&]() {
+        RowSink sink = rotsink_make(&rot, &fb, FB_ROT_90);
+        sink.begin(sink.ctx, 0, 0, PERF_H, PERF_W);
+        for (int y = PERF_W - 1; y >= 0; y--) sink.row(sink.ctx, y, src + y * portraitStride, PERF_H);
+        perfSink += fb.pixels[100];
+    }));
+    record(m, raw, "rotate_90_pixelwise", timeMin(batches, 50, [&]() {
+        fb_rotate90_pixelwise(src, portraitStride, PERF_H, PERF_W, &fb);
+        perfSink += fb.pixels[100];
+    }));
+    record(m, raw, "rotate_180", timeMin(batches, 50, [&]() {
+        RowSink sink = rotsink_make(&rot, &fb, FB_ROT_180);
+        sink.begin(sink.ctx, 0, 0, PERF_W, PERF_H);
+        for (int y = PERF_H - 1; y >= 0; y--) sink.row(sink.ctx, y, src + y * fb.stride, PERF_W);
+        perfSink += fb.pixels[100];
+    }));
+}
+
+// ============================================================================
+// SIMULATED DAY
+// ============================================================================
+
+struct DayResult {
+    uint32_t requests;
+    uint32_t failed;
+    uint64_t bytes;
+    uint32_t fullRefreshes;
+    uint32_t partialRefreshes;
+    double radioOnMs;
+};
+
+/**
+ * Radio-active time for one fetch of `body` bytes: connect, then the
+ * transfer. Single core the radio stays up while each chunk is decrypted
+ * and decoded; pipelined it only waits for the slower of the two stages.
+ */
+static double fetchRadioMs(const EnvProfile& p, uint32_t body) {
+    double kb = body / 1024.0;
+    double perKb = p.pipelined ? std::max(p.wireUsPerKb, p.tlsUsPerKb + p.decodeUsPerKb)
+                               : p.wireUsPerKb + p.tlsUsPerKb + p.decodeUsPerKb;
+    return p.connectMs + kb * perKb / 1000.0;
+}
+
+/**
+ * One request on the simulated clock: radio time and bytes, and whether it
+ * succeeded (seeded, so every run of an env sees the same failures)
+ */
+static bool simulateFetch(const EnvProfile& p, uint32_t body, double failRate, std::mt19937* rng,
+                          DayResult* r, double* ms) {
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    bool ok = uni(*rng) >= failRate;
+    r->requests++;
+    r->bytes += p.requestBytes;
+    if (ok) {
+        r->bytes += p.responseHeaderBytes + body;
+        *ms = fetchRadioMs(p, body);
+    } else {
+        // Failed connect or timeout: radio up for the handshake attempt
+        r->failed++;
+        *ms = p.connectMs;
+    }
+    r->radioOnMs += *ms;
+    return ok;
+}
+
+static DayResult simulatePolicyDay(const EnvProfile& p, double failRate, uint32_t seed) {
+    DayResult r;
+    memset(&r, 0, sizeof(r));
+    std::mt19937 rng(seed);
+
+    FetchPolicy policy;
+    policy_init(&policy, p.mode, p.transport, true, 0);
+    // CC_PAGE_CACHE: every page is fetched on the first idle pass, then
+    // again once stale (main.cpp prefetchStalePage, one per pass)
+    uint32_t pageDue[3] = { 0, 0, 0 };
+    int pages = 0;
+    while (pages < 3 && p.pageMaxAgeS[pages]) pages++;
+
+    uint32_t now = 0;
+    while (now < DAY_MS) {
+        PolicyRequest req;
+        if (!policy_due(&policy, now, &req)) {
+            int page = -1;
+            for (int i = 0; i < pages; i++) {
+                if (pageDue[i] <= now && (page < 0 || pageDue[i] < pageDue[page])) page = i;
+            }
+            double ms;
+            if (page >= 0) {
+                bool ok = simulateFetch(p, p.pageBytes, failRate, &rng, &r, &ms);
+                now += (uint32_t)ms;
+                pageDue[page] = now + (ok ? p.pageMaxAgeS[page] * 1000 : PAGE_RETRY_MS);
+                continue;
+            }
+            uint32_t wake = policy_next_wake(&policy, now);
+            for (int i = 0; i < pages; i++) wake = std::min(wake, pageDue[i]);
+            now = wake > now ? wake : now + 1000;
+            continue;
+        }
+        uint32_t body = req.action == POLICY_FETCH_TIER ? p.tierBytes[req.tier] : p.bodyBytes;
+        double ms;
+        bool ok = simulateFetch(p, body, failRate, &rng, &r, &ms);
+        now += (uint32_t)ms;
+        policy_done(&policy, &req, now, ok);
+    }
+    r.fullRefreshes = policy.fullRefreshes;
+    r.partialRefreshes = policy.partialRefreshes;
+    return r;
+}
+
+/**
+ * main-byos.cpp: wake, associate, GET /api/display, then the image when
+ * byos_image_changed(), refresh and deep-sleep for byos_sleep_us(); a
+ * failed cycle sleeps byos_retry_s() instead.
+ */
+static DayResult simulateByosDay(const EnvProfile& p, double failRate, uint32_t seed) {
+    DayResult r;
+    memset(&r, 0, sizeof(r));
+    std::mt19937 rng(seed);
+
+    ByosCache cache;
+    memset(&cache, 0, sizeof(cache));
+    byos_cache_validate(&cache);
+    uint64_t now = 0;
+    for (uint32_t cycle = 0; now < DAY_MS; cycle++) {
+        double awakeMs = p.wakeMs, ms;
+        r.radioOnMs += p.wakeMs;
+        bool ok = simulateFetch(p, p.displayBytes, failRate, &rng, &r, &ms);
+        awakeMs += ms;
+        if (ok) {
+            // A new filename every wake: the server's changes each minute
+            ByosDisplay d;
+            memset(&d, 0, sizeof(d));
+            snprintf(d.filename, sizeof(d.filename), "cc-%08lx", (unsigned long)cycle);
+            if (byos_image_changed(&cache, &d)) {
+                ok = simulateFetch(p, p.bodyBytes, failRate, &rng, &r, &ms);
+                awakeMs += ms;
+                if (ok) {
+                    bool full = cache.imageKeyLen == 0 || cache.partialCount >= POLICY_MAX_PARTIALS;
+                    if (full) r.fullRefreshes++;
+                    else r.partialRefreshes++;
+                    cache.partialCount = full ? 0 : cache.partialCount + 1;
+                    byos_image_drawn(&cache, &d);
+                }
+            }
+        }
+        if (ok) cache.errorStreak = 0;
+        else if (cache.errorStreak < 0xFFFF) cache.errorStreak++;
+        uint64_t sleepUs = ok ? byos_sleep_us(cache.refreshRateS, (uint32_t)awakeMs)
+                              : (uint64_t)byos_retry_s(cache.errorStreak, cache.refreshRateS) * 1000000ULL;
+        now += (uint64_t)awakeMs + sleepUs / 1000;
+    }
+    return r;
+}
+
+static DayResult simulateDay(const EnvProfile& p, double failRate, uint32_t seed) {
+    return p.schedule == SCHEDULE_BYOS ? simulateByosDay(p, failRate, seed)
+                                       : simulatePolicyDay(p, failRate, seed);
+}
+
+// ============================================================================
+// BASELINES
+// ============================================================================
+
+static bool readText(const std::string& path, std::string* out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out->append(buf, n);
+    fclose(f);
+    return true;
+}
+
+/**
+ * Every "name": number pair in the file (the baseline's metrics object)
+ */
+static Metrics parseMetrics(const std::string& text) {
+    Metrics m;
+    JsonScanner s;
+    JsonTok prev = { JSON_TOK_END, 0, 0, 0 };
+    JsonTok tok;
+    json_scan_init(&s, text.data(), text.size());
+    while (json_next(&s, &tok) != JSON_TOK_END && tok.type != JSON_TOK_ERROR) {
+        if (tok.type == JSON_TOK_PUNCT && tok.punct == ':' && prev.type == JSON_TOK_STRING) {
+            JsonTok value;
+            if (json_next(&s, &value) == JSON_TOK_NUMBER) {
+                std::string name(text.data() + prev.start, prev.end - prev.start);
+                std::string num(text.data() + value.start, value.end - value.start);
+                m.push_back(std::make_pair(name, strtod(num.c_str(), nullptr)));
+            }
+            tok = value;
+        }
+        prev = tok;
+    }
+    return m;
+}
+
+/**
+ * {"name":value,...}; one metric per line when pretty (baseline files,
+ * so a refresh diffs cleanly)
+ */
+static std::string metricsJson(const Metrics& m, bool pretty = false) {
+    std::string out = "{";
+    char buf[160];
+    for (size_t i = 0; i < m.size(); i++) {
+        snprintf(buf, sizeof(buf), "%s%s\"%s\":%s%.10g", i ? "," : "", pretty ? "\n    " : "",
+                 m[i].first.c_str(), pretty ? " " : "", m[i].second);
+        out += buf;
+    }
+    return out + (pretty ? "\n  }" : "}");
+}
+
+/**
+ * ccfirm-* envs in platformio.ini with neither a profile nor an entry in
+ * UNPROFILED_ENVS. An unreadable file is skipped with a warning.
+ */
+static int missingProfiles(const std::string& iniPath) {
+    std::string ini;
+    if (!readText(iniPath, &ini)) {
+        fprintf(stderr, "cannot read %s: env coverage not checked\n", iniPath.c_str());
+        return 0;
+    }
+    static const char prefix[] = "[env:ccfirm-";
+    int missing = 0;
+    for (size_t at = ini.find(prefix); at != std::string::npos; at = ini.find(prefix, at + 1)) {
+        if (at > 0 && ini[at - 1] != '\n') continue;
+        size_t close = ini.find(']', at);
+        if (close == std::string::npos) break;
+        std::string env = ini.substr(at + 5, close - at - 5);
+        bool known = false;
+        for (size_t e = 0; e < sizeof(PROFILES) / sizeof(PROFILES[0]); e++) known |= env == PROFILES[e].env;
+        for (size_t e = 0; e < sizeof(UNPROFILED_ENVS) / sizeof(UNPROFILED_ENVS[0]); e++) {
+            known |= env == UNPROFILED_ENVS[e];
+        }
+        if (!known) {
+            fprintf(stderr, "%s: env:%s has no entry in PROFILES\n", iniPath.c_str(), env.c_str());
+            missing++;
+        }
+    }
+    return missing;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--env all|<env>] [--threshold pct] [--day-threshold pct]\n"
+                    "          [--baseline-dir perf] [--ini platformio.ini] [--write-baseline] [--out report.json]\n"
+                    "          [--fail-rate 0.02] [--seed 1] [--batches 15] [--runs 3]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* envName = "all";
+    std::string baselineDir = "perf";
+    std::string iniPath = "platformio.ini";
+    const char* outPath = nullptr;
+    double threshold = 30, dayThreshold = 1, failRate = 0.02;
+    uint32_t seed = 1;
+    int batches = 15, runs = 3;
+    bool writeBaseline = false;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--write-baseline") == 0) writeBaseline = true;
+        else if (strcmp(argv[i], "--env") == 0 && hasValue) envName = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && hasValue) threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--day-threshold") == 0 && hasValue) dayThreshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--baseline-dir") == 0 && hasValue) baselineDir = argv[++i];
+        else if (strcmp(argv[i], "--ini") == 0 && hasValue) iniPath = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && hasValue) outPath = argv[++i];
+        else if (strcmp(argv[i], "--fail-rate") == 0 && hasValue) failRate = atof(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--batches") == 0 && hasValue) batches = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--runs") == 0 && hasValue) runs = atoi(argv[++i]);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (batches < 1) batches = 1;
+    if (runs < 1) runs = 1;
+    if (missingProfiles(iniPath)) return 2;
+
+    // Host microbenchmarks are shared by every env's report. Best of several
+    // runs: scheduler noise only ever makes a run slower.
+    Metrics micro, hostUs;
+    for (int r = 0; r < runs; r++) {
+        Metrics one, oneUs;
+        runMicro(batches, &one, &oneUs);
+        if (micro.empty()) {
+            micro = one;
+            hostUs = oneUs;
+        }
+        for (size_t i = 0; i < micro.size(); i++) micro[i].second = std::min(micro[i].second, one[i].second);
+        for (size_t i = 0; i < hostUs.size(); i++) hostUs[i].second = std::min(hostUs[i].second, oneUs[i].second);
+    }
+
+    std::string report;
+    int regressions = 0, ran = 0;
+    for (size_t e = 0; e < sizeof(PROFILES) / sizeof(PROFILES[0]); e++) {
+        const EnvProfile& p = PROFILES[e];
+        if (strcmp(envName, "all") != 0 && strcmp(envName, p.env) != 0) continue;
+        ran++;
+
+        Metrics m = micro;
+        DayResult day = simulateDay(p, failRate, seed);
+        m.push_back(std::make_pair("day.requests", (double)day.requests));
+        m.push_back(std::make_pair("day.failed_requests", (double)day.failed));
+        m.push_back(std::make_pair("day.bytes", (double)day.bytes));
+        m.push_back(std::make_pair("day.refresh_full", (double)day.fullRefreshes));
+        m.push_back(std::make_pair("day.refresh_partial", (double)day.partialRefreshes));
+        m.push_back(std::make_pair("day.radio_on_s", day.radioOnMs / 1000.0));
+
+        std::string path = baselineDir + "/" + p.env + ".json";
+        if (writeBaseline) {
+            FILE* f = fopen(path.c_str(), "wb");
+            if (!f) {
+                fprintf(stderr, "cannot write %s\n", path.c_str());
+                return 1;
+            }
+            fprintf(f, "{\n  \"env\": \"%s\",\n  \"metrics\": %s\n}\n", p.env, metricsJson(m, true).c_str());
+            fclose(f);
+        }
+
+        // Compare with the committed baseline
+        std::string text, regressed;
+        bool haveBaseline = readText(path, &text);
+        Metrics base = haveBaseline ? parseMetrics(text) : Metrics();
+        for (size_t i = 0; i < m.size(); i++) {
+            if (isReferenceMetric(m[i].first)) continue;
+            for (size_t j = 0; j < base.size(); j++) {
+                if (base[j].first != m[i].first) continue;
+                double limit = m[i].first.compare(0, 4, "day.") == 0 ? dayThreshold : threshold;
+                double was = base[j].second, now = m[i].second;
+                double deltaPct = was > 0 ? 100.0 * (now - was) / was : (now > 0 ? 100.0 : 0.0);
+                if (deltaPct > limit) {
+                    char buf[200];
+                    snprintf(buf, sizeof(buf), "%s{\"metric\":\"%s\",\"baseline\":%.3f,\"current\":%.3f,\"deltaPct\":%.1f}",
+                             regressed.empty() ? "" : ",", m[i].first.c_str(), was, now, deltaPct);
+                    regressed += buf;
+                    regressions++;
+                    fprintf(stderr, "REGRESSION %s %s: %.3f -> %.3f (+%.1f%% > %.0f%%)\n",
+                            p.env, m[i].first.c_str(), was, now, deltaPct, limit);
+                }
+            }
+        }
+        if (!haveBaseline && !writeBaseline) fprintf(stderr, "%s: no baseline at %s\n", p.env, path.c_str());
+
+        char head[320];
+        snprintf(head, sizeof(head), "{\"env\":\"%s\",\"baseline\":%s,\"thresholdPct\":{\"micro\":%.1f,\"day\":%.1f},"
+                 "\"failRate\":%.3f,\"seed\":%u,\"metrics\":",
+                 p.env, haveBaseline ? ("\"" + path + "\"").c_str() : "null", threshold, dayThreshold,
+                 failRate, seed);
+        std::string line = std::string(head) + metricsJson(m) + ",\"hostUs\":" + metricsJson(hostUs) +
+                           ",\"regressions\":[" + regressed + "]}\n";
+        printf("%s", line.c_str());
+        report += line;
+    }
+    if (ran == 0) {
+        fprintf(stderr, "unknown env: %s\n", envName);
+        return 2;
+    }
+    if (outPath) {
+        FILE* f = fopen(outPath, "wb");
+        if (!f) {
+            fprintf(stderr, "cannot write %s\n", outPath);
+            return 1;
+        }
+        fputs(report.c_str(), f);
+        fclose(f);
+    }
+    return regressions ? 1 : 0;
+}
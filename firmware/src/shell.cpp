@@ -0,0 +1,776 @@
+/**
+ * CCFirm™ — Serial Shell
+ * Part of the Commute Compute System™
+ *
+ * Field profiling without reflashing: line commands on the USB serial port
+ * (115200 baud), read while the device is idle. Each bench runs the real
+ * pipeline stage on its own and prints min/avg/max timings.
+ *   bench fetch [N]                 N full fetches (HTTP, body, loadBMP)
+ *   bench blit [N]                  loadBMP of the current frame into the panel
+ *   bench refresh partial|full [N]  panel refreshes
+ *   bench tls [N]                   insecure / verified / pinned / PSK handshakes
+ *   bench http [N]                  HTTPClient vs http-lite, keep-alive, pipelined
+ *   bench tput [N]                  TLS body throughput (stock vs tuned profile)
+ *   bench fresh [N]                 UDP freshness check round trips vs an HTTPS poll
+ *   bench crypto [N]                accelerator flags and SHA/GCM/P-256 speed (CC_TLS_PROFILE)
+ *   bench rotate [N]                90/180° frame rotation: 8x8 transpose vs per pixel
+ *   rotate [0|90|180|270]           show or set the panel mounting
+ *   pages | bench page [N]          button pages: cache state, flash read + decode time (CC_PAGE_CACHE)
+ *   heap | net | metrics
+ *   trace dump | trace clear        execution trace for tools/trace_export.py (CC_TRACE)
+ *   log dump | log bin | log clear
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include "ccfirm.h"
+
+static ShellLine shellLine = {};     // Serial console input
+
+static const char SHELL_HELP[] =
+    "Commands:\n"
+    "  bench fetch [N]                 fetch N frames (1-20, default 3)\n"
+    "  bench blit [N]                  loadBMP current frame N times (1-50, default 5)\n"
+    "  bench refresh partial|full [N]  refresh the panel N times (1-10, default 1)\n"
+    "  bench tls [N]                   N handshakes per mode: insecure, verified, pinned, PSK (1-20, default 5)\n"
+    "  bench http [N]                  N GETs: HTTPClient, http-lite, keep-alive, pipelined (1-10, default 3)\n"
+    "  bench tput [N]                  N verified BMP downloads, body KB/s (1-10, default 3)\n"
+    "  bench fresh [N]                 N UDP freshness checks, radio-on ms vs HTTPS (1-50, default 10)\n"
+#ifdef CC_TLS_PROFILE
+    "  bench crypto [N]                hardware flags, SHA-256/AES-GCM/P-256 speed (1-50, default 5)\n"
+#endif
+    "  bench rotate [N]                rotate the current frame N times, tiles vs per pixel (1-20, default 3)\n"
+    "  rotate [0|90|180|270]           show or set the panel mounting (frames arrive rotated to match)\n"
+#ifdef CC_PAGE_CACHE
+    "  pages                           button pages, their flash slots and age\n"
+    "  bench page [N]                  read + verify + decode each cached page N times (1-20, default 3)\n"
+#endif
+    "  heap                            heap usage\n"
+    "  net                             WiFi link, DNS + TCP connect to the server\n"
+    "  metrics                         counters and phase timings\n"
+#ifdef CC_TRACE
+    "  trace dump|clear                print the execution trace (tools/trace_export.py), or clear it\n"
+#endif
+    "  log dump|bin|clear              print the log ring (text or binary), or clear it\n";
+
+static void shellPrintStats(const BenchStats* s, const char* name, const char* unit) {
+    char text[96];
+    bench_format(s, name, unit, text, sizeof(text));
+    Serial.printf("  %s\n", text);
+}
+
+static void shellBenchFetch(int n) {
+    if (WiFi.status() != WL_CONNECTED || strlen(webhookUrl) == 0) {
+        Serial.println("  Not online/paired");
+        return;
+    }
+    BenchStats total, http, body, load;
+    bench_reset(&total);
+    bench_reset(&http);
+    bench_reset(&body);
+    bench_reset(&load);
+    uint64_t bytes = 0, bodyMs = 0;
+    int failed = 0;
+
+    for (int i = 0; i < n; i++) {
+        uint32_t loads = metrics.load.count;
+        unsigned long t0 = millis();
+        bool ok = fetchZoneUpdates(true);
+        uint32_t elapsed = millis() - t0;
+        if (!ok) {
+            failed++;
+            Serial.printf("  #%d failed (HTTP %ld)\n", i + 1, (long)metrics.lastHttpStatus);
+            continue;
+        }
+        bench_add(&total, elapsed);
+        bench_add(&http, metrics.http.lastMs);
+        bench_add(&body, metrics.body.lastMs);
+        if (metrics.load.count != loads) bench_add(&load, metrics.load.lastMs);
+        bytes += metrics.lastFetchBytes;
+        bodyMs += metrics.body.lastMs;
+        Serial.printf("  #%d %lu ms, %lu B\n", i + 1, (unsigned long)elapsed, (unsigned long)metrics.lastFetchBytes);
+    }
+
+    shellPrintStats(&total, "total", "ms");
+    shellPrintStats(&http, "http", "ms");
+    shellPrintStats(&body, "body", "ms");
+    shellPrintStats(&load, "loadBMP", "ms");
+    uint32_t kbps = bench_kbps10(bytes, bodyMs);
+    Serial.printf("  body throughput %lu.%lu KB/s, %d failed, min free heap %lu\n",
+                  (unsigned long)(kbps / 10), (unsigned long)(kbps % 10), failed,
+                  (unsigned long)ESP.getMinFreeHeap());
+}
+
+static void shellBenchBlit(int n) {
+    uint32_t len = currentFrameBytes();
+    if (len == 0) {
+        Serial.println("  No frame in the buffer - fetch one first");
+        return;
+    }
+    BenchStats us;
+    bench_reset(&us);
+    for (int i = 0; i < n; i++) {
+        unsigned long t0 = micros();
+        int rc = bbep->loadBMP(zoneBmpBuffer, 0, 0, BBEP_BLACK, BBEP_WHITE);
+        bench_add(&us, micros() - t0);
+        if (rc != BBEP_SUCCESS) {
+            Serial.printf("  loadBMP failed: %d\n", rc);
+            return;
+        }
+    }
+    shellPrintStats(&us, "loadBMP", "us");
+    // bytes * 1000 / us == bytes / ms
+    uint32_t kbps = bench_kbps10((uint64_t)len * us.count * 1000ULL, us.sum);
+    Serial.printf("  %lu B per frame, %lu.%lu KB/s\n", (unsigned long)len,
+                  (unsigned long)(kbps / 10), (unsigned long)(kbps % 10));
+}
+
+static void shellBenchRefresh(bool full, int n) {
+    BenchStats ms;
+    bench_reset(&ms);
+    for (int i = 0; i < n; i++) {
+        unsigned long t0 = millis();
+        if (full) {
+            doFullRefresh();
+            metrics_phase(&metrics.refreshFull, millis() - t0);
+        } else {
+            bbep->refresh(REFRESH_PARTIAL, true);
+            metrics_phase(&metrics.refreshPartial, millis() - t0);
+        }
+        bench_add(&ms, millis() - t0);
+    }
+    // Keep the ghosting bookkeeping honest
+    if (full) {
+        lastFullRefresh = millis();
+        partialRefreshCount = 0;
+    } else {
+        partialRefreshCount += n;
+    }
+    shellPrintStats(&ms, full ? "full refresh" : "partial refresh", "ms");
+}
+
+// The current frame's pixels re-read as a portrait (SCREEN_H x SCREEN_W)
+// image and rotated into a scratch framebuffer: RotateSink (8x8 transposes,
+// rows fed bottom-up as from a BMP) against one pixel at a time.
+static void shellBenchRotate(int n) {
+    if (currentFrameBytes() == 0) {
+        Serial.println("  No frame in the buffer - fetch one first");
+        return;
+    }
+    size_t size = (size_t)shadowFb.stride * SCREEN_H;
+    uint8_t* scratch = (uint8_t*)malloc(size);
+    if (!scratch) {
+        Serial.printf("  No heap for a %u B scratch frame\n", (unsigned)size);
+        return;
+    }
+    FrameBuffer out = { scratch, SCREEN_W, SCREEN_H, shadowFb.stride };
+    const uint8_t* src = shadowFb.pixels;
+    int srcStride = SCREEN_H / 8;
+    static RotateSink rot;
+    BenchStats tile90, tile180, pixel90;
+    bench_reset(&tile90);
+    bench_reset(&tile180);
+    bench_reset(&pixel90);
+    for (int i = 0; i < n; i++) {
+        unsigned long t0 = micros();
+        RowSink sink = rotsink_make(&rot, &out, FB_ROT_90);
+        sink.begin(sink.ctx, 0, 0, SCREEN_H, SCREEN_W);
+        for (int y = SCREEN_W - 1; y >= 0; y--) sink.row(sink.ctx, y, src + y * srcStride, SCREEN_H);
+        bench_add(&tile90, micros() - t0);
+
+        t0 = micros();
+        sink = rotsink_make(&rot, &out, FB_ROT_180);
+        sink.begin(sink.ctx, 0, 0, SCREEN_W, SCREEN_H);
+        for (int y = SCREEN_H - 1; y >= 0; y--) sink.row(sink.ctx, y, src + y * shadowFb.stride, SCREEN_W);
+        bench_add(&tile180, micros() - t0);
+
+        t0 = micros();
+        fb_rotate90_pixelwise(src, srcStride, SCREEN_H, SCREEN_W, &out);
+        bench_add(&pixel90, micros() - t0);
+        yield();
+    }
+    free(scratch);
+    shellPrintStats(&tile90, "90 tiles", "us");
+    shellPrintStats(&pixel90, "90 per pixel", "us");
+    shellPrintStats(&tile180, "180 rows", "us");
+    if (tile90.sum > 0) {
+        Serial.printf("  8x8 transpose %lu.%lux faster than per pixel\n",
+                      (unsigned long)(pixel90.sum / tile90.sum),
+                      (unsigned long)(pixel90.sum * 10 / tile90.sum % 10));
+    }
+}
+
+static void shellRotate(int argc, char** argv) {
+    if (argc > 1) {
+        int rot = fb_rotation_from_degrees(strtol(argv[1], nullptr, 10));
+        if (rot < 0) {
+            Serial.println("  Rotation must be 0, 90, 180 or 270");
+            return;
+        }
+        displayRotation = (uint8_t)rot;
+        shadowSink = frameSink(&shadowSinkState, &shadowRotState, &shadowFb);
+        saveSettings();
+    }
+    int w, h;
+    fb_rotated_size(&shadowFb, displayRotation, &w, &h);
+    Serial.printf("  Rotation %d, frames %dx%d (from the next fetch; BLE push after restart)\n",
+                  displayRotation * 90, w, h);
+}
+
+static void shellHeap() {
+    Serial.printf("  free %lu, min free %lu, largest block %lu\n",
+                  (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMinFreeHeap(),
+                  (unsigned long)ESP.getMaxAllocHeap());
+    if (ESP.getPsramSize() > 0) {
+        Serial.printf("  PSRAM free %lu of %lu\n",
+                      (unsigned long)ESP.getFreePsram(), (unsigned long)ESP.getPsramSize());
+    }
+}
+
+static void shellNet() {
+    if (WiFi.status() != WL_CONNECTED) {
+        Serial.println("  WiFi not connected");
+        return;
+    }
+    Serial.printf("  SSID %s, RSSI %d dBm, channel %u\n",
+                  WiFi.SSID().c_str(), (int)WiFi.RSSI(), (unsigned)WiFi.channel());
+    Serial.printf("  IP %s", WiFi.localIP().toString().c_str());
+    Serial.printf(", gateway %s\n", WiFi.gatewayIP().toString().c_str());
+
+    char host[96];
+    uint16_t port;
+    if (!serverHostPort(webhookUrl, host, sizeof(host), &port)) {
+        Serial.println("  Not paired - no server to test");
+        return;
+    }
+    IPAddress ip;
+    unsigned long t0 = millis();
+    if (!WiFi.hostByName(host, ip)) {
+        Serial.printf("  DNS %s failed after %lu ms\n", host, millis() - t0);
+        return;
+    }
+    unsigned long dnsMs = millis() - t0;
+    WiFiClient tcp;
+    t0 = millis();
+    bool connected = tcp.connect(ip, port);
+    unsigned long connectMs = millis() - t0;
+    tcp.stop();
+    Serial.printf("  DNS %s -> %s in %lu ms, TCP :%u %s in %lu ms\n", host, ip.toString().c_str(),
+                  dnsMs, (unsigned)port, connected ? "connected" : "failed", connectMs);
+}
+
+// Profile details of the last handshake: only the tuned client records them
+static void shellTlsDetail(WiFiClientSecure&) {}
+#ifdef CC_TLS_PROFILE
+static void shellTlsDetail(CCTlsClient& client) {
+    Serial.printf("    %s, max fragment %lu, TCP %lu ms + handshake %lu ms, %ld B heap held\n",
+                  client.stats.suite ? client.stats.suite : "?", (unsigned long)client.stats.maxFragIn,
+                  (unsigned long)client.stats.connectMs, (unsigned long)client.stats.handshakeMs,
+                  (long)client.stats.heapHeld);
+}
+#endif
+
+// n connects (DNS, TCP, TLS handshake) in one mode; the server's cipher
+// and certificate choice is part of what is measured. Pinned includes
+// hashing the leaf and comparing it, as tlsConnect() does.
+template <typename C>
+static void shellBenchTlsMode(const char* name, const char* host, uint16_t port, TlsMode mode, int n) {
+    BenchStats ms;
+    bench_reset(&ms);
+    int failed = 0;
+    for (int i = 0; i < n; i++) {
+        C client;
+        unsigned long t0 = millis();
+        bool ok = tlsHandshake(client, host, port, mode);
+        if (ok && mode == TLS_MODE_PINNED) {
+            uint8_t leaf[32];
+            uint32_t notAfter;
+            ok = tlsPeerLeaf(client, leaf, &notAfter) && tlspin_matches(&tlsPin, leaf);
+        }
+        uint32_t elapsed = millis() - t0;
+        if (ok && i == n - 1) shellTlsDetail(client);
+        client.stop();
+        if (!ok) {
+            failed++;
+            continue;
+        }
+        bench_add(&ms, elapsed);
+    }
+    shellPrintStats(&ms, name, "ms");
+    if (ms.count > 0) {
+        uint32_t uj = tlspsk_energy_uj((uint32_t)(ms.sum / ms.count));
+        Serial.printf("  ~%lu.%lu mJ per handshake, %d failed\n",
+                      (unsigned long)(uj / 1000), (unsigned long)(uj % 1000 / 100), failed);
+    }
+}
+
+template <typename C>
+static void shellBenchTlsClient(const char* host, uint16_t port, int n) {
+    shellBenchTlsMode<C>("insecure", host, port, TLS_MODE_INSECURE, n);
+    shellBenchTlsMode<C>("verified chain", host, port, TLS_MODE_CHAIN, n);
+    if (tlspin_usable(&tlsPin, host, currentUnixTime())) {
+        shellBenchTlsMode<C>("pinned", host, port, TLS_MODE_PINNED, n);
+    } else {
+        Serial.println("  No pin for this host yet - run a fetch first");
+    }
+
+    char pskHost[96];
+    uint16_t pskPort;
+    if (!pskEndpoint[0] || !serverHostPort(pskEndpoint, pskHost, sizeof(pskHost), &pskPort)) {
+        Serial.println("  No PSK endpoint from pairing");
+    } else {
+        Serial.printf("  %s:%u as %s\n", pskHost, (unsigned)pskPort, pskIdentity);
+        shellBenchTlsMode<C>("psk", pskHost, pskPort, TLS_MODE_PSK, n);
+    }
+}
+
+static void shellBenchTls(int n) {
+    char host[96];
+    uint16_t port;
+    if (WiFi.status() != WL_CONNECTED || !serverHostPort(webhookUrl, host, sizeof(host), &port)) {
+        Serial.println("  Not online/paired");
+        return;
+    }
+    Serial.printf("  %s:%u, min free heap %lu\n", host, (unsigned)port, (unsigned long)ESP.getMinFreeHeap());
+#ifdef CC_TLS_PROFILE
+    Serial.println("  stock WiFiClientSecure:");
+    shellBenchTlsClient<WiFiClientSecure>(host, port, n);
+    Serial.println("  tuned profile (tls-client.h):");
+    shellBenchTlsClient<CCTlsClient>(host, port, n);
+#else
+    shellBenchTlsClient<WiFiClientSecure>(host, port, n);
+#endif
+    Serial.printf("  min free heap %lu (energy at %u mA, %u mV)\n", (unsigned long)ESP.getMinFreeHeap(),
+                  (unsigned)TLS_BENCH_ACTIVE_MA, (unsigned)TLS_BENCH_SUPPLY_MV);
+}
+
+// n verified-chain GETs of the full-screen BMP; times the body only, so
+// the figure is record-layer throughput (decrypt + copy) on this link.
+// Heap held is free heap before the handshake minus after the headers.
+template <typename C>
+static void shellBenchTputClient(const char* name, const char* host, uint16_t port, const char* url, int n) {
+    BenchStats ms;
+    bench_reset(&ms);
+    uint64_t bytes = 0, bodyMs = 0;
+    int32_t held = 0;
+    int failed = 0;
+    uint8_t chunk[512];
+    for (int i = 0; i < n; i++) {
+        C client;
+        HTTPClient http;
+        uint32_t heapBefore = ESP.getFreeHeap();
+        int code = HTTPC_ERROR_CONNECTION_REFUSED;
+        if (tlsHandshake(client, host, port, TLS_MODE_CHAIN)) {
+            http.setTimeout(20000);
+            code = http.begin(client, url) ? http.GET() : HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+        int len = http.getSize();
+        if (code != 200 || len <= 0) {
+            Serial.printf("  #%d failed (HTTP %d)\n", i + 1, code);
+            http.end();
+            client.stop();
+            failed++;
+            continue;
+        }
+        int32_t h = (int32_t)heapBefore - (int32_t)ESP.getFreeHeap();
+        if (h > held) held = h;
+
+        int remaining = len;
+        unsigned long t0 = millis();
+        while (remaining > 0) {
+            size_t want = remaining < (int)sizeof(chunk) ? remaining : sizeof(chunk);
+            size_t got = client.readBytes(chunk, want);
+            if (got == 0) break;  // Timeout
+            remaining -= got;
+        }
+        uint32_t elapsed = millis() - t0;
+        http.end();
+        client.stop();
+        if (remaining > 0) {
+            failed++;
+            continue;
+        }
+        bench_add(&ms, elapsed);
+        bytes += len;
+        bodyMs += elapsed;
+    }
+    shellPrintStats(&ms, name, "ms");
+    uint32_t kbps = bench_kbps10(bytes, bodyMs);
+    Serial.printf("  %lu.%lu KB/s, %ld B heap held, %d failed\n",
+                  (unsigned long)(kbps / 10), (unsigned long)(kbps % 10), (long)held, failed);
+}
+
+static void shellBenchTput(int n) {
+    char host[96];
+    uint16_t port;
+    if (WiFi.status() != WL_CONNECTED || strncmp(webhookUrl, "https://", 8) != 0 ||
+        !serverHostPort(webhookUrl, host, sizeof(host), &port)) {
+        Serial.println("  Not online/paired over https");
+        return;
+    }
+    String url = String(webhookUrl) + "?format=bmp";
+    shellBenchTputClient<WiFiClientSecure>("stock body", host, port, url.c_str(), n);
+#ifdef CC_TLS_PROFILE
+    shellBenchTputClient<CCTlsClient>("tuned body", host, port, url.c_str(), n);
+#endif
+    Serial.printf("  min free heap %lu\n", (unsigned long)ESP.getMinFreeHeap());
+}
+
+// Free heap low-water during a bench request, sampled from the HTTP layer
+// (headers, body reads). Starts once the connection is up, so the TLS
+// session itself is not counted.
+struct HeapProbe {
+    uint32_t before;
+    uint32_t low;
+};
+static HeapProbe benchHeap;
+
+static void heapProbeStart() {
+    benchHeap.before = benchHeap.low = ESP.getFreeHeap();
+}
+
+static void heapProbeSample() {
+    uint32_t free = ESP.getFreeHeap();
+    if (free < benchHeap.low) benchHeap.low = free;
+}
+
+static void benchHttpHeader(void*, const char*, const char*) {
+    heapProbeSample();
+}
+
+static bool benchHttpBody(void*, const uint8_t*, size_t) {
+    heapProbeSample();
+    return true;
+}
+
+// The fetch as it was before http-lite.h: Strings for URL and headers
+static int benchHttpClientGet(WiFiClient* conn, const char* url) {
+    HTTPClient http;
+    http.setTimeout(HTTP_IO_TIMEOUT_MS);
+    if (!http.begin(*conn, url)) return HTTPC_ERROR_CONNECTION_REFUSED;
+    const char* headerKeys[] = {"X-Timetable-Slice"};
+    http.collectHeaders(headerKeys, 1);
+    http.addHeader(NEXT_FETCH_HEADER, String(FETCH_INTERVAL_MS / 1000));
+    int code = http.GET();
+    heapProbeSample();
+    if (code == 200) {
+        String slice = http.header("X-Timetable-Slice");
+        WiFiClient* stream = http.getStreamPtr();
+        int remaining = http.getSize();
+        uint8_t chunk[512];
+        while (remaining > 0) {
+            size_t want = remaining < (int)sizeof(chunk) ? remaining : sizeof(chunk);
+            size_t got = stream->readBytes(chunk, want);
+            heapProbeSample();
+            if (got == 0) {
+                code = HTTPC_ERROR_READ_TIMEOUT;
+                break;
+            }
+            remaining -= got;
+        }
+    }
+    http.end();
+    return code;
+}
+
+enum BenchHttpMode {
+    BENCH_HTTP_CLIENT,      // HTTPClient, new connection per request
+    BENCH_HTTP_LITE,        // http-lite, new connection per request
+    BENCH_HTTP_KEEPALIVE,   // http-lite, one connection, requests in turn
+    BENCH_HTTP_PIPELINED    // http-lite, one connection, all requests written first
+};
+
+/**
+ * n GETs of url in one mode. Each time includes the connection setup
+ * where one happens, so keep-alive shows what it saves.
+ */
+static void shellBenchHttpMode(const char* name, const char* url, int n, BenchHttpMode mode) {
+    char host[96];
+    uint16_t port;
+    serverHostPort(url, host, sizeof(host), &port);
+    const char* path = httplite_url_path(url);
+    char headers[96];
+    dashboardHeaders(headers, sizeof(headers));
+
+    BenchStats ms;
+    bench_reset(&ms);
+    uint32_t held = 0;
+    uint32_t largestBefore = ESP.getMaxAllocHeap();
+    bool shared = mode == BENCH_HTTP_KEEPALIVE || mode == BENCH_HTTP_PIPELINED;
+    TlsClient client;
+    WiFiClient* conn = nullptr;
+    unsigned long start = millis();
+
+    for (int i = 0; i < n; i++) {
+        unsigned long t0 = millis();
+        if (!conn) {
+            conn = dashboardConnect(client, url, false);
+            if (!conn) {
+                Serial.printf("  #%d connect failed\n", i + 1);
+                break;
+            }
+            HttpLiteIo io = { clientIoRead, clientIoWrite, conn };
+            httplite_conn_init(&dashConn, io);
+            // Pipelined: every request goes out before the first response is read
+            for (int j = i; mode == BENCH_HTTP_PIPELINED && j < n; j++) {
+                if (httplite_send(&dashConn, "GET", host, port, path, headers, j < n - 1) < 0) break;
+            }
+        }
+
+        heapProbeStart();
+        int code;
+        if (mode == BENCH_HTTP_CLIENT) {
+            code = benchHttpClientGet(conn, url);
+        } else {
+            code = 0;
+            if (mode != BENCH_HTTP_PIPELINED) {
+                code = httplite_send(&dashConn, "GET", host, port, path, headers, shared && i < n - 1);
+            }
+            if (code == 0) {
+                HttpLiteResponse r;
+                httplite_response_init(&r, dashLine, sizeof(dashLine), benchHttpHeader, benchHttpBody,
+                                       nullptr, false);
+                code = httplite_receive(&dashConn, &r);
+            }
+        }
+        uint32_t elapsed = millis() - t0;
+        if (benchHeap.before - benchHeap.low > held) held = benchHeap.before - benchHeap.low;
+        if (code != 200) {
+            Serial.printf("  #%d HTTP %d\n", i + 1, code);
+            break;
+        }
+        bench_add(&ms, elapsed);
+        if (!shared || !dashConn.usable) {
+            if (shared && i < n - 1) Serial.printf("  Server closed the connection after #%d\n", i + 1);
+            dashboardEnd(client);
+            conn = nullptr;
+            if (shared) break;
+        }
+    }
+    dashboardEnd(client);
+
+    shellPrintStats(&ms, name, "ms");
+    Serial.printf("  %lu ms for %lu, HTTP layer peak heap %lu B, largest block %+ld B\n",
+                  millis() - start, (unsigned long)ms.count, (unsigned long)held,
+                  (long)ESP.getMaxAllocHeap() - (long)largestBefore);
+}
+
+static void shellBenchHttp(int n) {
+    if (WiFi.status() != WL_CONNECTED || strlen(webhookUrl) == 0) {
+        Serial.println("  Not online/paired");
+        return;
+    }
+    static char url[sizeof(webhookUrl) + 16];
+    snprintf(url, sizeof(url), "%s?format=bmp", webhookUrl);
+    shellBenchHttpMode("HTTPClient", url, n, BENCH_HTTP_CLIENT);
+    shellBenchHttpMode("http-lite", url, n, BENCH_HTTP_LITE);
+    shellBenchHttpMode("keep-alive", url, n, BENCH_HTTP_KEEPALIVE);
+    shellBenchHttpMode("pipelined", url, n, BENCH_HTTP_PIPELINED);
+    Serial.printf("  min free heap %lu\n", (unsigned long)ESP.getMinFreeHeap());
+}
+
+// Radio-on time of the UDP freshness check next to the HTTPS poll it
+// replaces (this boot's tls + http + body averages, from "metrics")
+static void shellBenchFresh(int n) {
+    if (WiFi.status() != WL_CONNECTED || !freshEndpoint[0]) {
+        Serial.println("  Not online, or no freshness endpoint from pairing");
+        return;
+    }
+    if (shownZones.count == 0) Serial.println("  No server frame shown yet - every answer will be \"changed\"");
+    BenchStats ms;
+    bench_reset(&ms);
+    int answers[FRESH_UNKNOWN + 1] = { 0 };
+    int noReply = 0;
+    for (int i = 0; i < n; i++) {
+        FreshReply reply;
+        unsigned long t0 = millis();
+        int status = freshCheck(&reply);
+        uint32_t elapsed = millis() - t0;
+        if (status == FRESH_NO_REPLY) {
+            noReply++;
+            continue;
+        }
+        answers[status]++;
+        bench_add(&ms, elapsed);
+    }
+    shellPrintStats(&ms, "udp check", "ms");
+    Serial.printf("  %d unchanged, %d changed, %d unknown, %d no reply (%d ms timeout each)\n",
+                  answers[FRESH_UNCHANGED], answers[FRESH_CHANGED], answers[FRESH_UNKNOWN], noReply,
+                  FRESH_TIMEOUT_MS);
+    if (ms.count > 0) {
+        uint32_t uj = tlspsk_energy_uj((uint32_t)(ms.sum / ms.count));
+        Serial.printf("  ~%lu.%lu mJ radio-on per check\n", (unsigned long)(uj / 1000), (unsigned long)(uj % 1000 / 100));
+    }
+
+    const MetricsPhase* phases[] = { &metrics.tls, &metrics.http, &metrics.body };
+    uint32_t httpsMs = 0;
+    for (const MetricsPhase* p : phases) {
+        if (p->count == 0) {
+            Serial.println("  No HTTPS fetch yet this boot to compare with");
+            return;
+        }
+        httpsMs += p->totalMs / p->count;
+    }
+    uint32_t uj = tlspsk_energy_uj(httpsMs);
+    Serial.printf("  HTTPS poll ~%lu ms, ~%lu.%lu mJ\n", (unsigned long)httpsMs,
+                  (unsigned long)(uj / 1000), (unsigned long)(uj % 1000 / 100));
+}
+
+#ifdef CC_TLS_PROFILE
+// Accelerator flags from the SDK build, then the primitives the profile's
+// suites use: SHA-256, AES-128-GCM over 4 KB records, P-256 key generation
+static void shellBenchCrypto(int n) {
+    TlsHwInfo hw = tlsclient_hw();
+    Serial.printf("  hardware AES %s, SHA %s, MPI %s\n",
+                  hw.aes ? "on" : "OFF", hw.sha ? "on" : "OFF", hw.mpi ? "on" : "OFF");
+    static uint8_t buf[4096];
+    uint64_t bytes = (uint64_t)sizeof(buf) * n * 20;
+    uint32_t us = tlsclient_bench_sha256(buf, sizeof(buf), n * 20);
+    uint32_t kbps = bench_kbps10(bytes * 1000ULL, us);
+    Serial.printf("  SHA-256      %lu.%lu KB/s\n", (unsigned long)(kbps / 10), (unsigned long)(kbps % 10));
+    us = tlsclient_bench_gcm(buf, sizeof(buf), n * 20);
+    kbps = bench_kbps10(bytes * 1000ULL, us);
+    Serial.printf("  AES-128-GCM  %lu.%lu KB/s\n", (unsigned long)(kbps / 10), (unsigned long)(kbps % 10));
+    us = tlsclient_bench_p256(n);
+    if (us == 0) {
+        Serial.println("  P-256 keygen failed");
+    } else {
+        Serial.printf("  P-256 keygen %lu.%lu ms each\n", (unsigned long)(us / n / 1000),
+                      (unsigned long)(us / n % 1000 / 100));
+    }
+}
+#endif
+
+#ifdef CC_PAGE_CACHE
+static void shellPages() {
+    if (!pageCacheReady) {
+        Serial.println("  No page cache (no SPIFFS partition)");
+        return;
+    }
+    uint32_t nowUnix = currentUnixTime();
+    Serial.printf("  %u slots of %u B at 0x%06lx, showing page %d\n", (unsigned)pageCache.slots,
+                  (unsigned)PAGECACHE_SLOT_BYTES, (unsigned long)pagePartition->address, shownPage);
+    for (int i = 0; i < serverPages.count; i++) {
+        const PageDef* page = &serverPages.page[i];
+        int slot = pagecache_find(&pageCache, page->id);
+        if (i == 0) {
+            Serial.printf("  0 %-15s live dashboard\n", page->id);
+        } else if (slot < 0) {
+            Serial.printf("  %d %-15s not cached, max age %lu s\n", i, page->id, (unsigned long)page->maxAge);
+        } else {
+            const PageSlot* s = &pageCache.slot[slot];
+            Serial.printf("  %d %-15s slot %d, %lu B, %08lx, checked %ld s ago, max age %lu s%s\n", i, page->id,
+                          slot, (unsigned long)s->len, (unsigned long)s->hash,
+                          nowUnix ? (long)(nowUnix - s->checkedUnix) : -1L, (unsigned long)page->maxAge,
+                          pagecache_stale(s, page->maxAge, nowUnix) ? " (stale)" : "");
+        }
+    }
+}
+
+// Page switch cost without the panel: flash read + hash, then read + decode
+// into the shadow (loadBMP is "bench blit", the refresh "bench refresh")
+static void shellBenchPage(int n) {
+    static uint8_t chunk[PAGE_READ_CHUNK];
+    bool any = false;
+    for (int slot = 0; pageCacheReady && slot < pageCache.slots; slot++) {
+        if (!pageCache.slot[slot].valid) continue;
+        any = true;
+        BenchStats read, decode;
+        bench_reset(&read);
+        bench_reset(&decode);
+        for (int i = 0; i < n; i++) {
+            unsigned long t0 = micros();
+            bool ok = pagecache_stream(&pageCache, slot, chunk, sizeof(chunk), nullptr, nullptr);
+            bench_add(&read, micros() - t0);
+            t0 = micros();
+            ok = ok && decodeCachedPage(slot);
+            bench_add(&decode, micros() - t0);
+            if (!ok) {
+                Serial.printf("  slot %d failed its check\n", slot);
+                break;
+            }
+        }
+        Serial.printf("  %s: %lu B\n", pageCache.slot[slot].id, (unsigned long)pageCache.slot[slot].len);
+        shellPrintStats(&read, "flash read", "us");
+        shellPrintStats(&decode, "read+decode", "us");
+    }
+    if (!any) Serial.println("  No cached pages - press the button or wait for a prefetch");
+}
+#endif
+
+static void shellMetrics() {
+    MetricsRuntime rt;
+    sampleMetricsRuntime(&rt);
+    char text[2048];
+    size_t len = metrics_format(&metrics, &rt, text, sizeof(text));
+    Serial.write((const uint8_t*)text, len);
+}
+
+static void runShellCommand(char* text) {
+    char* argv[SHELL_MAX_ARGS];
+    int argc = shell_split(text, argv, SHELL_MAX_ARGS);
+    if (argc == 0) return;
+    const char* cmd = argv[0];
+    const char* sub = argc > 1 ? argv[1] : "";
+
+    if (strcmp(cmd, "bench") == 0 && strcmp(sub, "fetch") == 0) {
+        shellBenchFetch((int)shell_arg_long(argc, argv, 2, 3, 1, 20));
+    } else if (strcmp(cmd, "bench") == 0 && strcmp(sub, "blit") == 0) {
+        shellBenchBlit((int)shell_arg_long(argc, argv, 2, 5, 1, 50));
+    } else if (strcmp(cmd, "bench") == 0 && strcmp(sub, "refresh") == 0 && argc > 2 &&
+               (strcmp(argv[2], "partial") == 0 || strcmp(argv[2], "full") == 0)) {
+        shellBenchRefresh(strcmp(argv[2], "full") == 0, (int)shell_arg_long(argc, argv, 3, 1, 1, 10));
+    } else if (strcmp(cmd, "bench") == 0 && strcmp(sub, "tls") == 0) {
+        shellBenchTls((int)shell_arg_long(argc, argv, 2, 5, 1, 20));
+    } else if (strcmp(cmd, "bench") == 0 && strcmp(sub, "http") == 0) {
+        shellBenchHttp((int)shell_arg_long(argc, argv, 2, 3, 1, 10));
+    } else if (strcmp(cmd, "bench") == 0 && strcmp(sub, "tput") == 0) {
+        shellBenchTput((int)shell_arg_long(argc, argv, 2, 3, 1, 10));
+    } else if (strcmp(cmd, "bench") == 0 && strcmp(sub, "fresh") == 0) {
+        shellBenchFresh((int)shell_arg_long(argc, argv, 2, 10, 1, 50));
+#ifdef CC_TLS_PROFILE
+    } else if (strcmp(cmd, "bench") == 0 && strcmp(sub, "crypto") == 0) {
+        shellBenchCrypto((int)shell_arg_long(argc, argv, 2, 5, 1, 50));
+#endif
+    } else if (strcmp(cmd, "bench") == 0 && strcmp(sub, "rotate") == 0) {
+        shellBenchRotate((int)shell_arg_long(argc, argv, 2, 3, 1, 20));
+    } else if (strcmp(cmd, "rotate") == 0) {
+        shellRotate(argc, argv);
+#ifdef CC_PAGE_CACHE
+    } else if (strcmp(cmd, "pages") == 0) {
+        shellPages();
+    } else if (strcmp(cmd, "bench") == 0 && strcmp(sub, "page") == 0) {
+        shellBenchPage((int)shell_arg_long(argc, argv, 2, 3, 1, 20));
+#endif
+    } else if (strcmp(cmd, "heap") == 0) {
+        shellHeap();
+    } else if (strcmp(cmd, "net") == 0) {
+        shellNet();
+    } else if (strcmp(cmd, "metrics") == 0) {
+        shellMetrics();
+#ifdef CC_TRACE
+    } else if (strcmp(cmd, "trace") == 0 && strcmp(sub, "dump") == 0) {
+        trace_dump(serialLogOut, nullptr);
+    } else if (strcmp(cmd, "trace") == 0 && strcmp(sub, "clear") == 0) {
+        trace_clear();
+#endif
+    } else if (strcmp(cmd, "log") == 0 && strcmp(sub, "dump") == 0) {
+        logring_dump_text(serialLogOut, nullptr);
+    } else if (strcmp(cmd, "log") == 0 && strcmp(sub, "bin") == 0) {
+        logring_dump_binary(serialLogOut, nullptr);
+    } else if (strcmp(cmd, "log") == 0 && strcmp(sub, "clear") == 0) {
+        logring_clear();
+    } else {
+        Serial.print(SHELL_HELP);
+    }
+}
+
+void pollSerialShell() {
+    while (Serial.available() > 0) {
+        if (!shell_feed(&shellLine, (char)Serial.read())) continue;
+        runShellCommand(shellLine.buf);
+        shell_reset(&shellLine);
+        Serial.print("cc> ");
+    }
+}
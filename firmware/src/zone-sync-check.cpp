@@ -0,0 +1,120 @@
+/**
+ * CCFirm™ — Zone Sync Host Check (host, env:native-zonesync)
+ * Part of the Commute Compute System™
+ *
+ * Runs the device side of X-Zone-Hashes (zone-sync.h) on input produced by
+ * the server's encoder, so tests/test-zone-sync.js can check both ends
+ * agree:
+ *
+ *   program --hashes <X-Zone-Hashes value>
+ *     zonesync_decode(), then zonesync_encode() of the result
+ *   program --delta body.cczf --out-dir dir [--width 800 --height 480]
+ *     frame decoder -> ZoneBmpSink, each zone BMP written to
+ *     dir/zone-<n>.bmp as the draw callback receives it
+ *
+ * Prints one JSON line.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "zone-sync.h"
+#include "frame-codec.h"
+
+struct ZoneLog {
+    const char* outDir;
+    std::string json;
+    int count;
+};
+
+static bool readFile(const char* path, std::vector<uint8_t>* out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out->insert(out->end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+// ZoneDrawFn: what bbep.loadBMP() would get, to a file
+static bool writeZone(void* ctx, const uint8_t* bmp, int x, int y, int w, int h) {
+    ZoneLog* log = (ZoneLog*)ctx;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/zone-%d.bmp", log->outDir, log->count);
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    size_t size = bmp_u32(bmp + 2);
+    bool ok = fwrite(bmp, 1, size, f) == size;
+    fclose(f);
+
+    char entry[128];
+    snprintf(entry, sizeof(entry), "%s{\"x\":%d,\"y\":%d,\"w\":%d,\"h\":%d,\"bytes\":%u}",
+             log->count ? "," : "", x, y, w, h, (unsigned)size);
+    log->json += entry;
+    log->count++;
+    return ok;
+}
+
+static int checkHashes(const char* value) {
+    ZoneHashes z;
+    z.count = 0xFF;
+    if (!zonesync_decode(value, strlen(value), &z)) {
+        printf("{\"ok\":false,\"untouched\":%s}\n", z.count == 0xFF ? "true" : "false");
+        return 0;
+    }
+    char encoded[ZONE_SYNC_TEXT_MAX];
+    zonesync_encode(&z, encoded, sizeof(encoded));
+    printf("{\"ok\":true,\"hashes\":[");
+    for (uint8_t i = 0; i < z.count; i++) printf("%s%lu", i ? "," : "", (unsigned long)z.hash[i]);
+    printf("],\"encoded\":\"%s\"}\n", encoded);
+    return 0;
+}
+
+static int checkDelta(const char* path, const char* outDir, int width, int height) {
+    std::vector<uint8_t> body;
+    if (!readFile(path, &body)) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+
+    // Room for the largest zone there can be: the whole screen
+    std::vector<uint8_t> zoneBuf(BMP_SHADOW_HEADER + (size_t)((width + 31) / 32) * 4 * height);
+    ZoneLog log = { outDir, "", 0 };
+    ZoneBmpSink zs;
+    RowSink sink = zonebmp_make(&zs, zoneBuf.data(), zoneBuf.size(), writeZone, &log);
+    FrameDecoder dec;
+    frame_decoder_init(&dec, &sink, width, height);
+    int rc = body.empty() ? FRAME_OK : frame_decoder_feed(&dec, body.data(), body.size());
+    bool complete = rc == FRAME_OK && dec.headerLen == 0;
+
+    printf("{\"ok\":%s,\"error\":%d,\"zonesDecoded\":%lu,\"zonesDrawn\":%lu,\"drawFailed\":%s,\"zones\":[%s]}\n",
+           complete && !zs.drawFailed ? "true" : "false", rc, (unsigned long)dec.zonesDone,
+           (unsigned long)zs.zonesDrawn, zs.drawFailed ? "true" : "false", log.json.c_str());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* hashes = nullptr;
+    const char* delta = nullptr;
+    const char* outDir = ".";
+    int width = 800, height = 480;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--hashes") == 0) hashes = argv[i + 1];
+        else if (strcmp(argv[i], "--delta") == 0) delta = argv[i + 1];
+        else if (strcmp(argv[i], "--out-dir") == 0) outDir = argv[i + 1];
+        else if (strcmp(argv[i], "--width") == 0) width = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--height") == 0) height = atoi(argv[i + 1]);
+    }
+    if (hashes) return checkHashes(hashes);
+    if (delta && width > 0 && height > 0) return checkDelta(delta, outDir, width, height);
+    fprintf(stderr, "usage: %s --hashes <value> | --delta body.cczf [--out-dir dir] [--width W --height H]\n", argv[0]);
+    return 2;
+}
@@ -1,10 +1,10 @@
 /**
  * PTV-TRMNL v5.31 - Inline Zone Processing (Memory-Efficient)
  * 
- * KEY OPTIMIZATION: Fixed zone definitions + streaming zone fetch
- * - Zones defined in firmware (from dashboard design)
- * - Fetch ONE zone at a time, decode, draw, discard
- * - Never hold full payload in memory
+ * KEY OPTIMIZATION: one conditional request per refresh (zone-sync.h)
+ * - Sends the content hashes of the zones on screen (X-Zone-Hashes)
+ * - Server replies with only the changed zones as CCZF frames
+ * - Decode ONE zone at a time into zoneBuffer, draw, discard
  *
  * Copyright (c) 2026 Angus Bergman
  * SPDX-License-Identifier: AGPL-3.0-or-later
@@ -23,6 +23,9 @@
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
 #include "../include/config.h"
+#include "../include/log-ring.h"
+#include "../include/frame-codec.h"
+#include "../include/zone-sync.h"
 
 #define SCREEN_W 800
 #define SCREEN_H 480
@@ -42,31 +45,23 @@ const unsigned long FULL_REFRESH_INTERVAL = 300000;
 int partialCount = 0;
 WiFiManagerParameter customServerUrl("server", "Server URL", "", 120);
 
-struct ZoneDef { const char* id; int16_t x, y, w, h; uint8_t refreshPriority; };
-
-static const ZoneDef ZONES[] = {
-    {"time", 20, 45, 180, 70, 1},
-    {"weather", 620, 10, 160, 95, 2},
-    {"trains", 20, 155, 370, 150, 1},
-    {"trams", 410, 155, 370, 150, 1},
-    {"coffee", 20, 315, 760, 65, 2},
-    {"footer", 0, 445, 800, 35, 3},
-};
-static const int ZONE_COUNT = sizeof(ZONES) / sizeof(ZONES[0]);
+// Content hashes of the zones on the panel (sent as X-Zone-Hashes); the
+// server picks zone ids and geometry, so none are hard-coded here
+ZoneHashes shownZones = {};
 
 void initDisplay();
 void showWelcomeScreen();
 void connectWiFi();
 void loadSettings();
 void saveSettings();
-bool fetchChangedZoneList(bool forceAll, bool* changedFlags);
-bool fetchAndDrawZone(const ZoneDef& zone, bool doFlash);
+bool fetchZoneDelta(bool forceAll, bool doFlash, int* drawn);
 void doFullRefresh();
 
 void setup() {
     WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
     Serial.begin(115200); delay(500);
     Serial.printf("\nPTV-TRMNL v%s\n", FIRMWARE_VERSION);
+    logring_begin();
     loadSettings();
     zoneBuffer = (uint8_t*)malloc(ZONE_BUFFER_SIZE);
     if (!zoneBuffer) { Serial.println("FATAL: No memory"); while(1) delay(1000); }
@@ -82,88 +77,76 @@ void loop() {
     bool needsFull = !initialDrawDone || (now - lastFullRefresh >= FULL_REFRESH_INTERVAL) || (partialCount >= 30);
     if (now - lastRefresh >= REFRESH_INTERVAL || !initialDrawDone) {
         lastRefresh = now;
-        bool changedFlags[ZONE_COUNT] = {false};
-        if (!fetchChangedZoneList(needsFull, changedFlags)) { delay(5000); return; }
+        // An empty hash vector asks for every zone
+        if (needsFull) zonesync_clear(&shownZones);
         int drawn = 0;
-        for (int i = 0; i < ZONE_COUNT; i++) {
-            if (changedFlags[i] || needsFull) {
-                if (fetchAndDrawZone(ZONES[i], !needsFull)) {
-                    drawn++;
-                    if (!needsFull) { bbep.refresh(REFRESH_PARTIAL, true); partialCount++; delay(50); }
-                }
-                yield();
-            }
-        }
-        if (needsFull && drawn > 0) { doFullRefresh(); lastFullRefresh = now; partialCount = 0; initialDrawDone = true; }
+        bool ok = fetchZoneDelta(needsFull, !needsFull, &drawn);
+        if (needsFull && drawn > 0 && ok) { doFullRefresh(); lastFullRefresh = now; partialCount = 0; initialDrawDone = true; }
+        else if (!needsFull && drawn > 0) { bbep.refresh(REFRESH_PARTIAL, true); partialCount++; }
+        if (!ok) { delay(5000); return; }
     }
     delay(1000);
 }
 
-bool fetchChangedZoneList(bool forceAll, bool* changedFlags) {
-    WiFiClientSecure* client = new WiFiClientSecure(); if (!client) return false;
-    client->setInsecure();
-    HTTPClient http;
-    String url = String(serverUrl) + "/api/zones?batch=0"; if (forceAll) url += "&force=true";
-    url.replace("//api", "/api");
-    http.setTimeout(10000); if (!http.begin(*client, url)) { delete client; return false; }
-    http.addHeader("User-Agent", "PTV-TRMNL/" FIRMWARE_VERSION);
-    int httpCode = http.GET();
-    if (httpCode != 200) { http.end(); delete client; return false; }
-    String payload = http.getString(); Serial.printf("Got payload: %d bytes\n", payload.length()); http.end(); Serial.println("HTTP end"); delete client; Serial.println("Client deleted");
-    // Manual JSON parsing (ArduinoJson crashes on ESP32-C3)
-    Serial.println("Parsing changed zones...");
-    int start = payload.indexOf("\"changed\":");
-    if (start < 0) { Serial.println("No changed field"); return false; }
-    int arrStart = payload.indexOf('[', start);
-    int arrEnd = payload.indexOf(']', arrStart);
-    if (arrStart < 0 || arrEnd < 0) { Serial.println("No array"); return false; }
-    String arr = payload.substring(arrStart + 1, arrEnd);
-    int pos = 0;
-    while (pos < (int)arr.length()) {
-        int q1 = arr.indexOf('"', pos);
-        if (q1 < 0) break;
-        int q2 = arr.indexOf('"', q1 + 1);
-        if (q2 < 0) break;
-        String zid = arr.substring(q1 + 1, q2);
-        for (int i = 0; i < ZONE_COUNT; i++) {
-            if (zid.equals(ZONES[i].id)) { changedFlags[i] = true; Serial.printf("Zone %s changed\n", ZONES[i].id); break; }
-        }
-        pos = q2 + 1;
-    }
-    Serial.println("Parsing done");
-    return true;
+static bool drawZoneBmp(void* ctx, const uint8_t* bmp, int x, int y, int w, int h) {
+    bool doFlash = *(bool*)ctx;
+    if (doFlash) { bbep.fillRect(x, y, w, h, BBEP_BLACK); bbep.refresh(REFRESH_PARTIAL, true); delay(30); }
+    CCLOG_D("Drawing zone at %d,%d (%dx%d)", x, y, w, h);
+    bool ok = bbep.loadBMP((uint8_t*)bmp, x, y, BBEP_BLACK, BBEP_WHITE) == BBEP_SUCCESS;
+    if (!ok) CCLOG_E("loadBMP failed for zone at %d,%d", x, y);
+    return ok;
 }
 
-bool fetchAndDrawZone(const ZoneDef& zone, bool doFlash) {
+// One request: send the hashes of what is on screen, draw the CCZF frames
+// of the zones that differ, keep the server's new hash vector
+bool fetchZoneDelta(bool forceAll, bool doFlash, int* drawn) {
+    *drawn = 0;
     WiFiClientSecure* client = new WiFiClientSecure(); if (!client) return false;
     client->setInsecure();
     HTTPClient http;
-    String url = String(serverUrl) + "/api/zonedata?id=" + zone.id; url.replace("//api", "/api");
-    http.setTimeout(15000);
-    const char* hk[] = {"X-Zone-X", "X-Zone-Y", "X-Zone-Width", "X-Zone-Height"};
-    http.collectHeaders(hk, 4);
+    String url = String(serverUrl) + "/api/zones?format=cczf"; if (forceAll) url += "&force=true";
+    url.replace("//api", "/api");
+    http.setTimeout(15000); http.useHTTP10(true);
+    const char* hk[] = {ZONE_SYNC_HEADER};
+    http.collectHeaders(hk, 1);
     if (!http.begin(*client, url)) { delete client; return false; }
+    char hashes[ZONE_SYNC_TEXT_MAX];
+    zonesync_encode(&shownZones, hashes, sizeof(hashes));
     http.addHeader("User-Agent", "PTV-TRMNL/" FIRMWARE_VERSION);
-    http.addHeader("Accept", "application/octet-stream");
+    http.addHeader("Accept", ZONE_SYNC_ACCEPT);
+    http.addHeader(ZONE_SYNC_HEADER, hashes);
     int httpCode = http.GET();
-    if (httpCode != 200) { http.end(); delete client; return false; }
-    int zX = zone.x, zY = zone.y, zW = zone.w, zH = zone.h;
-    if (http.hasHeader("X-Zone-X")) zX = http.header("X-Zone-X").toInt();
-    if (http.hasHeader("X-Zone-Y")) zY = http.header("X-Zone-Y").toInt();
-    if (http.hasHeader("X-Zone-Width")) zW = http.header("X-Zone-Width").toInt();
-    if (http.hasHeader("X-Zone-Height")) zH = http.header("X-Zone-Height").toInt();
-    int len = http.getSize();
-    if (len <= 0 || len > ZONE_BUFFER_SIZE) { http.end(); delete client; return false; }
+    if (httpCode != 200) { CCLOG_W("Zone delta HTTP %d", httpCode); http.end(); delete client; return false; }
+    String newHashes = http.header(ZONE_SYNC_HEADER);
+
+    ZoneBmpSink zoneSink;
+    RowSink sink = zonebmp_make(&zoneSink, zoneBuffer, ZONE_BUFFER_SIZE, drawZoneBmp, &doFlash);
+    FrameDecoder decoder;
+    frame_decoder_init(&decoder, &sink, SCREEN_W, SCREEN_H);
     WiFiClient* stream = http.getStreamPtr();
-    int read = 0; unsigned long timeout = millis() + 10000;
-    while (read < len && millis() < timeout) {
-        if (stream->available()) { int r = stream->readBytes(zoneBuffer + read, min((int)stream->available(), len - read)); read += r; }
+    int remaining = http.getSize();   // -1: read until the server closes
+    uint8_t chunk[512];
+    while (remaining != 0 && decoder.error == FRAME_OK) {
+        size_t want = (remaining > 0 && remaining < (int)sizeof(chunk)) ? (size_t)remaining : sizeof(chunk);
+        size_t got = stream->readBytes(chunk, want);
+        if (got == 0) break;
+        if (remaining > 0) remaining -= got;
+        frame_decoder_feed(&decoder, chunk, got);
         yield();
     }
     http.end(); delete client;
-    if (read != len || zoneBuffer[0] != 'B' || zoneBuffer[1] != 'M') return false;
-    if (doFlash) { bbep.fillRect(zX, zY, zW, zH, BBEP_BLACK); bbep.refresh(REFRESH_PARTIAL, true); delay(30); }
-    Serial.printf("Drawing zone at %d,%d (%dx%d)\n", zX, zY, zW, zH); bool ok = bbep.loadBMP(zoneBuffer, zX, zY, BBEP_BLACK, BBEP_WHITE) == BBEP_SUCCESS; Serial.printf("loadBMP result: %s\n", ok ? "OK" : "FAIL"); return ok;
+
+    *drawn = (int)zoneSink.zonesDrawn;
+    bool ok = decoder.error == FRAME_OK && decoder.headerLen == 0 && remaining <= 0 && !zoneSink.drawFailed &&
+              zonesync_decode(newHashes.c_str(), newHashes.length(), &shownZones);
+    if (!ok) {
+        // Panel state unknown - ask for every zone next time
+        CCLOG_W("Zone delta failed: err %d, %d drawn", decoder.error, *drawn);
+        zonesync_clear(&shownZones);
+        return false;
+    }
+    CCLOG_I("Zone delta: %d changed, %u B", *drawn, (unsigned)decoder.bytesIn);
+    return true;
 }
 
 void initDisplay() {
@@ -0,0 +1,16 @@
+# PlatformIO post-script for the native fuzz envs (platformio.ini).
+#
+# custom_sanitize = fuzzer,address,undefined -> clang + libFuzzer
+# custom_sanitize = address,undefined        -> host compiler, sanitizers only
+#
+# The -fsanitize flag is added to both compile and link lines, which
+# build_flags alone does not guarantee on the native platform.
+
+Import("env")
+
+sanitize = env.GetProjectOption("custom_sanitize", "").strip()
+if sanitize:
+    if "fuzzer" in sanitize.split(","):
+        env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+    flags = ["-fsanitize=" + sanitize, "-fno-omit-frame-pointer", "-g"]
+    env.Append(CCFLAGS=flags, LINKFLAGS=flags)
@@ -65,6 +65,16 @@ function createRestClient(baseUrl, token) {
       });
       const data = await response.json();
       return data.result === 'OK';
+    },
+    // Command in the POST body - values too large for a URL path (frames)
+    async setex(key, value, ttlSeconds) {
+      const response = await fetch(baseUrl, {
+        method: 'POST',
+        headers: { Authorization: `Bearer ${token}`, 'Content-Type': 'application/json' },
+        body: JSON.stringify(['SET', key, JSON.stringify(value), 'EX', String(ttlSeconds)])
+      });
+      const data = await response.json();
+      return data.result === 'OK';
     }
   };
 }
@@ -128,6 +138,11 @@ async function getUpstashClient() {
           await client.connect().catch(() => {});
           await client.set(key, JSON.stringify(value));
           return true;
+        },
+        async setex(key, value, ttlSeconds) {
+          await client.connect().catch(() => {});
+          await client.set(key, JSON.stringify(value), 'EX', ttlSeconds);
+          return true;
         }
       };
 
@@ -266,6 +281,45 @@ async function set(key, value) {
   }
 }
 
+/**
+ * Get a short-lived cached value (frames, device activity) from KV.
+ * Unlike get(), there is no memory fallback - callers keep their own
+ * per-instance cache and only use this to share across instances.
+ * @param {string} key - Storage key
+ * @returns {Promise<any>} - Stored value or null
+ */
+export async function getCachedValue(key) {
+  if (!isKvAvailable()) return null;
+  try {
+    const client = await getClient();
+    if (!client) return null;
+    const value = await withTimeout(client.get(key), 2000, null);
+    return typeof value === 'string' ? JSON.parse(value) : value;
+  } catch (error) {
+    console.error(`[kv-preferences] Error getting cached ${key}:`, error.message);
+    return null;
+  }
+}
+
+/**
+ * Store a short-lived cached value in KV with an expiry
+ * @param {string} key - Storage key
+ * @param {any} value - JSON-serialisable value
+ * @param {number} ttlSeconds - Expiry
+ * @returns {Promise<boolean>} - false if KV is unavailable or the write failed
+ */
+export async function setCachedValue(key, value, ttlSeconds) {
+  if (!isKvAvailable()) return false;
+  try {
+    const client = await getClient();
+    if (!client?.setex) return false;
+    return await withTimeout(client.setex(key, value, ttlSeconds), 3000, false);
+  } catch (error) {
+    console.error(`[kv-preferences] Error setting cached ${key}:`, error.message);
+    return false;
+  }
+}
+
 /**
  * Get Transport Victoria OpenData API key
  * Per Section 11.8: Zero-Config compliant API key retrieval
@@ -353,6 +407,8 @@ export async function getStorageStatus() {
 }
 
 export default {
+  getCachedValue,
+  setCachedValue,
   getTransitApiKey,
   setTransitApiKey,
   getGoogleApiKey,
@@ -19,6 +19,7 @@ import { fileURLToPath } from 'url';
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
 import { execSync } from 'child_process';
+import crypto from 'crypto';
 import config from './utils/config.js';
 import { getSnapshot } from './data/data-scraper.js';
 import CoffeeDecision from './core/coffee-decision.js';
@@ -36,8 +37,12 @@ import { readFileSync } from 'fs';
 import nodemailer from 'nodemailer';
 import safeguards from './utils/deployment-safeguards.js';
 import { decodeConfigToken, encodeConfigToken, generateWebhookUrl } from './utils/config-token.js';
+import { provisionDevicePsk, createPskServer, isPskEnabled } from './utils/device-psk.js';
+import { provisionFreshEndpoint, createFreshResponder } from './services/fresh-check.js';
+import { currentZoneHashes } from './services/frame-prerender.js';
 // image-renderer merged into ccdash-renderer
-import { renderZones, clearCache as clearZoneCache, ZONES, renderFullScreen as renderDashboard, renderTestPattern } from "./services/ccdash-renderer.js";
+import { renderZones, renderZoneDelta, clearCache as clearZoneCache, ZONES, renderFullScreen as renderDashboard, renderTestPattern } from "./services/ccdash-renderer.js";
+import { ZONE_HASH_HEADER, parseZoneHashes, wantsZoneDelta, sendZoneDelta } from "./services/zone-sync.js";
 import { getChangedZones as getChangedZonesV12, renderSingleZone as renderSingleZoneV12, getZoneDefinition as getZoneDefV12, ZONES as ZONES_V12, clearCache as clearZoneCacheV12 } from "./services/ccdash-renderer.js";
 import { getChangedZones as getChangedZonesCCDash, renderSingleZone as renderSingleZoneCCDash, getZoneDefinition as getZoneDefCCDash, getActiveZones as getActiveZonesCCDash, ZONES as ZONES_CCDASH, clearCache as clearZoneCacheCCDash, renderFullScreen as renderFullScreenCCDash } from "./services/ccdash-renderer.js";
 import SmartCommute from "./engines/smart-commute.js";
@@ -2034,10 +2039,10 @@ app.get('/api/display', async (req, res) => {
   // Log device status
   console.log(`📊 Device ${friendlyID}: Battery ${batteryVoltage}V, RSSI ${rssi}dBm, FW ${fwVersion}`);
 
-  // Verify device exists
+  // Verify device exists (BYOS firmware sends its MAC as ID, older builds the friendly ID)
   let deviceFound = false;
   for (const [mac, device] of devices.entries()) {
-    if (device.friendlyID === friendlyID && device.apiKey === accessToken) {
+    if ((device.friendlyID === friendlyID || mac === friendlyID) && device.apiKey === accessToken) {
       deviceFound = true;
       device.lastSeen = new Date().toISOString();
       device.batteryVoltage = batteryVoltage;
@@ -2149,9 +2154,17 @@ app.get('/api/display', async (req, res) => {
   // Coffee decision
   const coffeeDecision = transitData.coffee?.canGet ? 'STOP FOR COFFEE' : 'GO DIRECT';
 
+  // BYOS clients skip the download while filename is unchanged, so derive
+  // it from everything the /api/image render shows
+  const filename = 'cc-' + crypto.createHash('sha1')
+    .update(JSON.stringify([currentTime, weatherText, trams, trains, coffeeDecision]))
+    .digest('hex').substring(0, 16);
+
   // Return display content with firmware-compatible fields
   const response = {
     status: 0,
+    image_url: `https://${req.get('host')}/api/image`,
+    filename: filename,
     screen_url: `https://${req.get('host')}/api/screen`,
     dashboard_url: `https://${req.get('host')}/api/dashboard`,
     refresh_rate: refreshRate,
@@ -2253,6 +2266,10 @@ app.get('/api/zones', async (req, res) => {
       weather: data.weather,
       coffee: data.coffee
     };
+    if (wantsZoneDelta(req)) {
+      const deviceHashes = parseZoneHashes(req.headers[ZONE_HASH_HEADER.toLowerCase()]);
+      return sendZoneDelta(res, renderZoneDelta(dashData, deviceHashes, forceAll));
+    }
     const result = renderZones(dashData, forceAll);
     const changed = result.zones.filter(z => z.changed).length;
     res.setHeader('X-Zones-Changed', changed.toString());
@@ -7178,6 +7195,26 @@ const server = app.listen(PORT, async () => {
     });
   }, config.refreshSeconds * 1000);
 
+  // TLS-PSK listener for paired devices (cheap handshakes, same routes)
+  if (process.env.PSK_PORT && !isPskEnabled()) {
+    console.warn('⚠️  PSK_PORT set without PSK_SECRET or WEBHOOK_SECRET - TLS-PSK endpoint disabled');
+  } else if (process.env.PSK_PORT) {
+    createPskServer(app)
+      .on('error', err => console.warn('⚠️  PSK listener failed:', err.message))
+      .listen(parseInt(process.env.PSK_PORT, 10), () => {
+        console.log(`🔑 TLS-PSK endpoint on port ${process.env.PSK_PORT}`);
+      });
+  }
+
+  // UDP freshness check: devices ask before opening HTTPS (fresh-check.js)
+  if (process.env.FRESH_PORT) {
+    createFreshResponder({ lookup: currentZoneHashes })
+      .on('error', err => console.warn('⚠️  Freshness responder failed:', err.message))
+      .bind(parseInt(process.env.FRESH_PORT, 10), () => {
+        console.log(`📡 Freshness check on UDP port ${process.env.FRESH_PORT}`);
+      });
+  }
+
   safeguards.log(safeguards.LOG_LEVELS.INFO, 'Server started successfully', {
     port: PORT,
     host: HOST,
@@ -7260,13 +7297,16 @@ app.get('/api/pair/:code', (req, res) => {
   
   if (entry.status === 'paired' && entry.webhookUrl) {
     // Device is paired - return webhook URL
-    pairingCodes.delete(code); // One-time use
-    return res.json({
+    const paired = {
       success: true,
       status: 'paired',
       webhookUrl: entry.webhookUrl,
+      ...provisionDevicePsk(req, entry.webhookUrl),
+      ...provisionFreshEndpoint(req, entry.webhookUrl),
       message: 'Device paired successfully!'
-    });
+    };
+    pairingCodes.delete(code); // One-time use
+    return res.json(paired);
   }
   
   // Still waiting
@@ -82,6 +82,15 @@ import { createCanvas, GlobalFonts, loadImage } from '@napi-rs/canvas';
 import path from 'path';
 import { fileURLToPath } from 'url';
 import fs from 'fs';
+import {
+  zoneRenderKey,
+  memoiseZone,
+  getZonePayload,
+  warmZoneCache,
+  flushZoneCache,
+  getZoneCacheStats
+} from './zone-render-cache.js';
+import { zoneContentHash, selectChangedZones } from './zone-sync.js';
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
@@ -291,9 +300,11 @@ export const ZONES = {
   'footer': { id: 'footer', x: 0, y: 448, w: 800, h: 32 }
 };
 
-// Cache for change detection and BMP data
+// Part of every zone render cache key - bump when zone drawing changes
+export const RENDERER_VERSION = '1.40';
+
+// Last render key per zone, for change detection
 let previousDataHash = {};
-let cachedBMPs = {};
 
 // =============================================================================
 // MODE ICON DRAWING FUNCTIONS (V12 Spec Section 5.3)
@@ -811,7 +822,7 @@ function drawLegNumber(ctx, number, x, y, status = 'normal', sizeParam = 24) {
 /**
  * Convert canvas to 1-bit BMP for e-ink display
  */
-function canvasToBMP(canvas) {
+export function canvasToBMP(canvas) {
   const ctx = canvas.getContext('2d');
   const w = canvas.width;
   const h = canvas.height;
@@ -1127,6 +1138,19 @@ function getLegTitle(leg) {
   }
 }
 
+/**
+ * Upcoming departures in minutes - live countdown from absolute times
+ * when the leg has them, otherwise the precomputed list
+ */
+function getNextDepartures(leg, nowMs = Date.now()) {
+  if (leg.nextDepartureTimesMs && leg.nextDepartureTimesMs.length > 0) {
+    return leg.nextDepartureTimesMs
+      .map(depMs => Math.max(0, Math.round((depMs - nowMs) / 60000)))
+      .filter(mins => mins >= 0 && mins <= 60);
+  }
+  return leg.nextDepartures || leg.upcoming || [];
+}
+
 /**
  * Generate leg subtitle from leg data (V12 Spec Section 5.5)
  */
@@ -1181,13 +1205,7 @@ function getLegSubtitle(leg) {
       const lineName = leg.lineName || leg.routeName || '';
       
       // v1.40: Calculate live countdown from absolute times if available
-      let nextDepartures = leg.nextDepartures || leg.upcoming || [];
-      if (leg.nextDepartureTimesMs && leg.nextDepartureTimesMs.length > 0) {
-        const nowMs = Date.now();
-        nextDepartures = leg.nextDepartureTimesMs
-          .map(depMs => Math.max(0, Math.round((depMs - nowMs) / 60000)))
-          .filter(mins => mins >= 0 && mins <= 60);
-      }
+      const nextDepartures = getNextDepartures(leg);
       
       let parts = [];
       if (lineName) parts.push(lineName);
@@ -1488,9 +1506,92 @@ function renderFooter(data, prefs) {
 }
 
 /**
- * Main render function for a single zone
+ * Everything a zone's renderer reads from the data model. Two devices with
+ * equal inputs get the same pixels, so this is what the render cache keys on.
+ * Keep in sync with the render functions above.
+ *
+ * With clock false, what only moves because a minute passed is left out:
+ * the clock zone (null) and the leg countdowns, which follow from the
+ * absolute departure times still in the leg. getFreshHashes() uses this.
+ */
+function getZoneInputs(zoneId, data, { clock = true } = {}) {
+  switch (zoneId) {
+    case 'header.location':
+      return [data.location || data.origin];
+    case 'header.time':
+      return clock ? [data.current_time || data.time] : null;
+    case 'header.dayDate':
+      return [data.day, data.date];
+    case 'header.weather':
+      return [data.temp ?? data.temperature, data.condition, data.weather, data.rain_expected, data.precipitation];
+    case 'status':
+      return [
+        data.arrive_by || data.arrivalTime, data.status_type, data.disruption, data.isDelayed,
+        data.isDiverted, data.delay_minutes || data.delayMinutes,
+        data.total_minutes || data.totalMinutes || data.journeyDuration
+      ];
+    case 'footer':
+      return [data.destination || data.work, data.arrive_by || data.arrivalTime];
+    default: {
+      if (!zoneId.startsWith('leg')) return null;
+      const legIndex = parseInt(zoneId.replace('leg', ''), 10);
+      const leg = (data.journey_legs || data.legs || [])[legIndex - 1];
+      if (!leg) return null;
+      // renderLeg() marks the first leg; the countdown depends on the clock
+      const inputs = [legIndex === 1 ? { ...leg, isFirst: true } : leg, legIndex === 1 && !!data.highlight_first];
+      return clock ? [...inputs, getNextDepartures(leg)] : inputs;
+    }
+  }
+}
+
+/**
+ * Render cache key for a zone (zone id, geometry, inputs, renderer version)
+ */
+export function getZoneRenderKey(zoneId, data) {
+  return zoneRenderKey(zoneId, getZoneDefinition(zoneId, data), getZoneInputs(zoneId, data), RENDERER_VERSION);
+}
+
+/**
+ * Render a single zone to BMP, reusing the cached render when any device
+ * has already drawn the same zone content
  */
 export function renderSingleZone(zoneId, data, prefs = {}) {
+  const entry = renderZoneEntry(zoneId, data, prefs);
+  return entry ? entry.bmp : null;
+}
+
+function renderZoneEntry(zoneId, data, prefs = {}) {
+  return memoiseZone(
+    getZoneRenderKey(zoneId, data),
+    zoneId,
+    getZoneDefinition(zoneId, data),
+    () => drawZone(zoneId, data, prefs)
+  );
+}
+
+/**
+ * Load zones rendered by other instances (KV) before a render pass
+ * @param {string[]} [zoneIds] - Default: all active zones
+ */
+export async function warmZoneRenders(data, zoneIds = getActiveZones(data)) {
+  return warmZoneCache(zoneIds.map(zoneId => ({
+    key: getZoneRenderKey(zoneId, data),
+    zoneId,
+    geometry: getZoneDefinition(zoneId, data)
+  })));
+}
+
+/**
+ * Share zones rendered on this instance (KV) after a render pass
+ */
+export async function shareZoneRenders() {
+  return flushZoneCache();
+}
+
+/**
+ * Draw a zone (uncached)
+ */
+function drawZone(zoneId, data, prefs) {
   try {
     switch (zoneId) {
       case 'header.location':
@@ -1548,26 +1649,8 @@ export function getChangedZones(data, forceAll = false) {
   const changedZones = [];
   
   for (const zoneId of activeZones) {
-    // Create a hash of the relevant data for this zone
-    let hash;
-    
-    if (zoneId === 'header.time') {
-      hash = data.current_time || data.time;
-    } else if (zoneId === 'header.weather') {
-      hash = JSON.stringify({ temp: data.temp, condition: data.condition });
-    } else if (zoneId === 'status') {
-      hash = JSON.stringify({ 
-        coffee: data.coffee_decision, 
-        disruption: data.disruption,
-        arrive: data.arrive_by 
-      });
-    } else if (zoneId.startsWith('leg')) {
-      const legIndex = parseInt(zoneId.replace('leg', ''), 10) - 1;
-      const leg = (data.journey_legs || data.legs || [])[legIndex];
-      hash = leg ? JSON.stringify({ m: leg.minutes, t: leg.title }) : null;
-    } else {
-      hash = JSON.stringify(data[zoneId] || zoneId);
-    }
+    // The render key already hashes everything the zone draws from
+    const hash = getZoneRenderKey(zoneId, data);
     
     if (hash !== previousDataHash[zoneId]) {
       previousDataHash[zoneId] = hash;
@@ -1578,6 +1661,59 @@ export function getChangedZones(data, forceAll = false) {
   return changedZones;
 }
 
+/**
+ * Content hash of every active zone, in getActiveZones() order
+ * @returns {Array<{id: string, hash: number}>}
+ */
+export function getZoneHashes(data) {
+  return getActiveZones(data).map(id => ({ id, hash: zoneContentHash(getZoneRenderKey(id, data)) }));
+}
+
+/**
+ * Clock-independent content hash of every active zone that has one, in
+ * getActiveZones() order without the clock zone. The UDP freshness check
+ * (fresh-check.js) compares these: consecutive minutes with the same
+ * departures hash the same, where getZoneHashes() would differ in the
+ * clock and every countdown.
+ * @returns {number[]}
+ */
+export function getFreshHashes(data) {
+  const hashes = [];
+  for (const id of getActiveZones(data)) {
+    const inputs = getZoneInputs(id, data, { clock: false });
+    if (inputs) hashes.push(zoneContentHash(zoneRenderKey(id, getZoneDefinition(id, data), inputs, RENDERER_VERSION)));
+  }
+  return hashes;
+}
+
+/**
+ * Zones the device does not already show, as CCZF frames (see zone-sync.js).
+ * Unlike getChangedZones() this keeps no server state: the comparison is
+ * against the hashes the device sent.
+ * @param {Set<number>} deviceHashes - From parseZoneHashes()
+ * @returns {{frames: Buffer[], changed: string[], hashes: number[]}}
+ */
+export function renderZoneDelta(data, deviceHashes, forceAll = false, prefs = {}) {
+  const zones = getZoneHashes(data);
+  const changed = new Set(selectChangedZones(zones, deviceHashes, forceAll));
+
+  const frames = [];
+  const sent = [];
+  const hashes = [];
+  for (const zone of zones) {
+    if (!changed.has(zone.id)) {
+      hashes.push(zone.hash);
+      continue;
+    }
+    const entry = renderZoneEntry(zone.id, data, prefs);
+    if (!entry) continue;           // Left out of hashes so the device asks again
+    frames.push(getZonePayload(entry, 'cczf'));
+    sent.push(zone.id);
+    hashes.push(zone.hash);
+  }
+  return { frames, changed: sent, hashes };
+}
+
 /**
  * Get zone definition (for coordinates)
  */
@@ -1591,11 +1727,12 @@ export function getZoneDefinition(zoneId, data = null) {
 }
 
 /**
- * Clear all caches
+ * Reset change detection so the next getChangedZones() returns every zone.
+ * Cached renders are kept - they are keyed by content, so a forced refresh
+ * still reuses them.
  */
 export function clearCache() {
   previousDataHash = {};
-  cachedBMPs = {};
 }
 
 /**
@@ -2475,6 +2612,77 @@ export function renderFullScreenBMP(data, prefs = {}) {
   return canvasToBMP(canvas);
 }
 
+/**
+ * Render a text page (device pages: weather, alerts) as a 1-bit BMP.
+ * Same frame as the dashboard: black header with the title, sections of
+ * a bold heading and wrapped lines, black footer.
+ *
+ * @param {{title: string, sections: Array<{heading: string, lines: string[]}>, footer?: string}} page
+ */
+export function renderInfoPageBMP(page, { width = 800, height = 480 } = {}) {
+  const canvas = createCanvas(width, height);
+  const ctx = canvas.getContext('2d');
+  ctx.fillStyle = '#FFF';
+  ctx.fillRect(0, 0, width, height);
+
+  ctx.fillStyle = '#000';
+  ctx.fillRect(0, 0, width, 72);
+  ctx.fillStyle = '#FFF';
+  ctx.textAlign = 'left';
+  ctx.textBaseline = 'middle';
+  ctx.font = 'bold 36px Inter, sans-serif';
+  ctx.fillText(page.title, 16, 38);
+
+  // Word-wrap to the page width
+  const wrap = (text, font, maxWidth) => {
+    ctx.font = font;
+    const out = [];
+    let line = '';
+    for (const word of String(text).split(/\s+/)) {
+      const next = line ? `${line} ${word}` : word;
+      if (line && ctx.measureText(next).width > maxWidth) {
+        out.push(line);
+        line = word;
+      } else {
+        line = next;
+      }
+    }
+    if (line) out.push(line);
+    return out;
+  };
+
+  const bottom = height - 40;
+  let y = 96;
+  ctx.fillStyle = '#000';
+  ctx.textBaseline = 'top';
+  for (const section of page.sections || []) {
+    for (const text of wrap(section.heading, 'bold 22px Inter, sans-serif', width - 32)) {
+      if (y + 26 > bottom) break;
+      ctx.fillText(text, 16, y);
+      y += 28;
+    }
+    for (const line of section.lines || []) {
+      for (const text of wrap(line, '18px Inter, sans-serif', width - 48)) {
+        if (y + 22 > bottom) break;
+        ctx.fillText(text, 32, y);
+        y += 24;
+      }
+    }
+    y += 14;
+    if (y > bottom) break;
+  }
+
+  ctx.fillRect(0, height - 32, width, 32);
+  if (page.footer) {
+    ctx.fillStyle = '#FFF';
+    ctx.textBaseline = 'middle';
+    ctx.font = 'bold 16px Inter, sans-serif';
+    ctx.fillText(page.footer, 16, height - 16);
+  }
+
+  return canvasToBMP(canvas);
+}
+
 // =============================================================================
 // UTILITY FUNCTIONS (merged from image-renderer.js)
 // =============================================================================
@@ -2539,6 +2747,7 @@ export function renderFullDashboard(data) {
   return renderFullScreen(data);
 }
 
+export { getZoneCacheStats };
 export { ZONES as ZONES_V12 };
 export { ZONES as ZONES_V10 }; // Backward compatibility alias
 
@@ -2584,6 +2793,7 @@ export default {
   render,
   renderSingleZone,
   renderFullScreen,
+  renderInfoPageBMP,
   renderZones,
   renderFullDashboard,
   renderTestPattern,
@@ -2593,7 +2803,13 @@ export default {
   getChangedZones,
   getZoneDefinition,
   getZonesForTier,
+  getZoneRenderKey,
+  getZoneHashes,
+  getFreshHashes,
   clearCache,
+  warmZoneRenders,
+  shareZoneRenders,
+  getZoneCacheStats,
   
   // Low-level utilities
   canvasToBMP
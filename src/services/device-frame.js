@@ -0,0 +1,289 @@
+/**
+ * Device Frame Builder
+ * Part of the Commute Compute System™
+ *
+ * Turns a device config token into the full-screen 1-bit BMP (plus the
+ * offline timetable slice) served by /api/device/[token]?format=bmp, and
+ * the extra device pages (?format=page, device-pages.js).
+ * Shared by the live request path and the speculative pre-renderer
+ * (frame-prerender.js), which renders the same frame for a future minute.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+import LiveDash from './livedash.js';
+import { getPreferences } from '../data/kv-preferences.js';
+import { renderFullScreenBMP, renderInfoPageBMP, getZoneHashes, getFreshHashes } from './ccdash-renderer.js';
+import { buildTimetableSlice } from './timetable-slice.js';
+import { getWeather, getDisruptions } from './opendata-client.js';
+import {
+  findPage,
+  returnJourneyConfig,
+  weatherPageContent,
+  alertsPageContent,
+  pageFrameFromBMP
+} from './device-pages.js';
+
+const DAYS = ['Sunday', 'Monday', 'Tuesday', 'Wednesday', 'Thursday', 'Friday', 'Saturday'];
+const MONTHS = ['January', 'February', 'March', 'April', 'May', 'June', 'July', 'August', 'September', 'October', 'November', 'December'];
+
+// Fallback demo legs if the engine returns none
+const FALLBACK_LEGS = [
+  { number: 1, type: 'walk', title: 'Walk to tram stop', subtitle: 'South Yarra Station', minutes: 5 },
+  { number: 2, type: 'tram', title: 'Tram 8 to Collins St', subtitle: 'Departs 8:15am', minutes: 12 },
+  { number: 3, type: 'coffee', title: 'Coffee at Norman', subtitle: 'Order ahead via app', minutes: 5, canGet: true },
+  { number: 4, type: 'walk', title: 'Walk to office', subtitle: '123 Example Street', minutes: 8 }
+];
+
+/**
+ * Decode config token back to config object
+ */
+export function decodeConfigToken(token) {
+  try {
+    const json = Buffer.from(token, 'base64url').toString('utf8');
+    const minified = JSON.parse(json);
+
+    return {
+      addresses: minified.a || {},
+      journey: {
+        transitRoute: minified.j || {},
+        arrivalTime: minified.t || '09:00',
+        coffeeEnabled: minified.c !== false
+      },
+      locations: minified.l || {},
+      state: minified.s || 'VIC',
+      api: {
+        key: minified.k || ''
+      },
+      cafe: minified.cf || null,
+      apiMode: minified.m || 'cached'
+    };
+  } catch (error) {
+    console.error('Error decoding config token:', error);
+    return null;
+  }
+}
+
+/**
+ * SmartCommute settings saved by the admin panel (KV), or {} if unavailable
+ */
+export async function loadSmartCommuteSettings() {
+  try {
+    const kvPrefs = await getPreferences();
+    return kvPrefs?.smartcommute || {};
+  } catch (e) {
+    console.log('[device] KV preferences not available, using defaults');
+    return {};
+  }
+}
+
+/**
+ * Transform a decoded config token into SmartCommute preferences
+ */
+export function buildDevicePreferences(config, scSettings = {}) {
+  const apiKey = config.api?.key;
+  return {
+    homeAddress: config.addresses?.home,
+    homeLocation: config.locations?.home,
+    workAddress: config.addresses?.work,
+    workLocation: config.locations?.work,
+    cafeLocation: config.cafe || config.locations?.cafe,
+    coffeeAddress: config.addresses?.cafe,
+    targetArrival: config.journey?.arrivalTime,
+    arrivalTime: config.journey?.arrivalTime,
+    coffeeEnabled: config.journey?.coffeeEnabled,
+    preferCoffee: config.journey?.coffeeEnabled,
+    preferredRoute: config.journey?.transitRoute,
+    apiMode: config.apiMode,
+    state: config.state || 'VIC',
+    // SmartCommute settings from KV (or defaults)
+    homeToStop: scSettings.homeToStop || 5,
+    homeToCafe: scSettings.homeToCafe || 5,
+    cafeToTransit: scSettings.cafeToStop || 2,
+    walkToWork: scSettings.stopToWork || 5,
+    cafeDuration: scSettings.coffeeDuration || 5,
+    coffeeBuffer: scSettings.bufferTime || 3,
+    coffeePosition: scSettings.coffeePosition || 'auto',
+    preferTrain: scSettings.preferTrain !== false,
+    preferTram: scSettings.preferTram !== false,
+    preferBus: scSettings.preferBus || false,
+    minimizeWalking: scSettings.minimizeWalking !== false,
+    walkingSpeed: scSettings.walkingSpeed || 80,
+    maxWalkingDistance: scSettings.maxWalk || 600,
+    // API keys in format expected by SmartCommute engine
+    api: {
+      key: apiKey
+    },
+    transitApiKey: apiKey
+  };
+}
+
+/**
+ * Build the ccdash-renderer data model from a journey recommendation
+ * @param {Date} localTime - Local wall-clock time shown in the header
+ */
+export function buildDashboardData(preferences, journeyData, localTime) {
+  const hours12 = localTime.getHours() % 12 || 12;
+  const minutes = localTime.getMinutes().toString().padStart(2, '0');
+
+  let journeyLegs = (journeyData?.legs || []).map((leg, idx) => ({
+    number: idx + 1,
+    type: leg.type || 'walk',
+    title: leg.title || leg.description || '',
+    subtitle: leg.subtitle || '',
+    minutes: leg.duration || leg.minutes || 0,
+    state: leg.status === 'delayed' ? 'delayed' :
+           leg.status === 'skipped' ? 'skip' : 'normal',
+    canGet: leg.type === 'coffee' ? leg.canGet !== false : undefined
+  }));
+
+  if (journeyLegs.length === 0) {
+    console.log('[device] No legs from engine, using fallback demo data');
+    journeyLegs = FALLBACK_LEGS;
+  }
+
+  return {
+    location: preferences.homeAddress || 'Home',
+    current_time: `${hours12}:${minutes}`,
+    day: DAYS[localTime.getDay()],
+    date: `${localTime.getDate()} ${MONTHS[localTime.getMonth()]}`,
+    temp: journeyData?.weather?.temp ?? '--',
+    condition: journeyData?.weather?.condition || 'N/A',
+    umbrella: journeyData?.weather?.umbrella || false,
+    status_type: journeyData?.status || 'normal',
+    arrive_by: preferences.arrivalTime || '09:00',
+    total_minutes: journeyData?.totalDuration || 30,
+    leave_in_minutes: journeyData?.leaveIn || null,
+    journey_legs: journeyLegs,
+    destination: preferences.workAddress || 'Work'
+  };
+}
+
+/**
+ * Data model for a device frame (everything but the raster)
+ *
+ * @param {object} config - Decoded config token
+ * @param {object} [options]
+ * @param {string} [options.device] - LiveDash device id
+ * @param {object} [options.scSettings] - SmartCommute settings (loaded if omitted)
+ * @param {number} [options.at] - Epoch ms the frame is for (default now);
+ *   only the displayed clock moves, journey data is fetched now
+ * @returns {Promise<{dashboardData: object, journeyData: object}>}
+ */
+export async function buildDeviceFrameData(config, { device = 'trmnl-og', scSettings, at } = {}) {
+  const preferences = buildDevicePreferences(config, scSettings ?? await loadSmartCommuteSettings());
+
+  const liveDash = new LiveDash();
+  await liveDash.initialize(preferences);
+  liveDash.setDevice(device);
+
+  const journeyData = await liveDash.smartCommute.getJourneyRecommendation({});
+  console.log('[device] journeyData legs count:', journeyData?.legs?.length || 0);
+  console.log('[device] journeyData status:', journeyData?.status);
+
+  const shiftMs = at ? at - Date.now() : 0;
+  const localTime = new Date(liveDash.smartCommute.getLocalTime().getTime() + shiftMs);
+  return { dashboardData: buildDashboardData(preferences, journeyData, localTime), journeyData };
+}
+
+/**
+ * Freshness hashes of the frame a device would get now, without rendering
+ * it (fresh-check.js compares them with what the device shows)
+ * @returns {Promise<number[]>}
+ */
+export async function deviceFreshHashes(config, options = {}) {
+  const { dashboardData } = await buildDeviceFrameData(config, options);
+  return getFreshHashes(dashboardData);
+}
+
+/**
+ * Offline timetable slice for a frame's data - lets CCFirm keep advancing
+ * the journey from scheduled departures if later fetches fail
+ * @returns {string|null} base64, null if it could not be built
+ */
+export function deviceTimetableSlice(dashboardData, journeyData) {
+  try {
+    return buildTimetableSlice({
+      legs: dashboardData.journey_legs,
+      transitData: journeyData?.transit,
+      timeZone: journeyData?.stateConfig?.timezone,
+      arriveBy: dashboardData.arrive_by,
+      live: !journeyData?.fallbackMode
+    }).toString('base64');
+  } catch (error) {
+    console.log(`[timetable-slice] Skipped: ${error.message}`);
+    return null;
+  }
+}
+
+/**
+ * Render the full-screen BMP for a device
+ *
+ * @param {object} config - Decoded config token
+ * @param {object} [options] - As buildDeviceFrameData()
+ * @returns {Promise<{bmp: Buffer, slice: string|null, zoneHashes: number[], freshHashes: number[], renderMs: number}>}
+ */
+export async function renderDeviceBMP(config, options = {}) {
+  const started = Date.now();
+  const { dashboardData, journeyData } = await buildDeviceFrameData(config, options);
+  const bmp = renderFullScreenBMP(dashboardData);
+  const zoneHashes = getZoneHashes(dashboardData).map(z => z.hash);
+  const freshHashes = getFreshHashes(dashboardData);
+  const slice = deviceTimetableSlice(dashboardData, journeyData);
+
+  return { bmp, slice, zoneHashes, freshHashes, renderMs: Date.now() - started };
+}
+
+// GTFS-RT route types with service alerts, by leg type
+const ALERT_ROUTE_TYPES = { train: 0, tram: 1, bus: 2 };
+
+/**
+ * Render one of the device pages (device-pages.js) as a full-screen CCZF
+ * frame for the device's flash page cache
+ *
+ * @param {object} config - Decoded config token
+ * @param {string} pageId
+ * @param {object} [options] - As buildDeviceFrameData()
+ * @returns {Promise<{frame: Buffer, hash: string, maxAge: number, renderMs: number}|null>}
+ *   null for an unknown page
+ */
+export async function renderDevicePage(config, pageId, options = {}) {
+  const page = findPage(pageId);
+  if (!page) return null;
+  const started = Date.now();
+
+  let bmp;
+  if (page.id === 'outbound' || page.id === 'return') {
+    const pageConfig = page.id === 'return' ? returnJourneyConfig(config) : config;
+    ({ bmp } = await renderDeviceBMP(pageConfig, options));
+  } else if (page.id === 'weather') {
+    const home = config.locations?.home;
+    const weather = await getWeather(home?.lat, home?.lon);
+    bmp = renderInfoPageBMP(weatherPageContent(weather, config.addresses?.home));
+  } else {
+    const { dashboardData } = await buildDeviceFrameData(config, options);
+    const routeTypes = [...new Set(dashboardData.journey_legs
+      .map(leg => ALERT_ROUTE_TYPES[leg.type])
+      .filter(t => t !== undefined))];
+    const disruptions = (await Promise.all(routeTypes.map(t =>
+      getDisruptions(t, { apiKey: config.api?.key })))).flat();
+    bmp = renderInfoPageBMP(alertsPageContent(dashboardData, disruptions));
+  }
+
+  const { frame, hash } = pageFrameFromBMP(bmp);
+  return { frame, hash, maxAge: page.maxAge, renderMs: Date.now() - started };
+}
+
+export default {
+  decodeConfigToken,
+  loadSmartCommuteSettings,
+  buildDevicePreferences,
+  buildDashboardData,
+  buildDeviceFrameData,
+  deviceFreshHashes,
+  deviceTimetableSlice,
+  renderDeviceBMP,
+  renderDevicePage
+};
@@ -0,0 +1,150 @@
+/**
+ * Device Pages
+ * Part of the Commute Compute System™
+ *
+ * Besides the live dashboard a device can flip through a few more
+ * server-defined pages with its button: the return journey, a weather
+ * detail page and service alerts. Every dashboard response lists them
+ * (X-Pages: id=maxAgeSeconds,...); CCFirm (CC_PAGE_CACHE) prefetches the
+ * stale ones into its flash page cache (firmware/include/page-cache.h)
+ * between polls and shows them from flash when the button is pressed.
+ *
+ * The first page is the dashboard itself and is never cached. The others
+ * are served by /api/device/<token>?format=page&page=<id> as one
+ * full-screen CCZF frame (frame-codec.js). A device that sends the hash of
+ * its cached copy (&ph=) gets 304 when the page has not changed, so the
+ * flash slot is not rewritten.
+ *
+ * Rendering lives in device-frame.js; this module only holds the page
+ * table and what goes on each page.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+import { bmpToZoneFrames, FRAME_FLAG_REFRESH } from './frame-codec.js';
+import { fnv1a32 } from './timetable-slice.js';
+
+export const PAGES_HEADER = 'X-Pages';
+export const PAGE_HASH_HEADER = 'X-Page-Hash';
+
+/**
+ * Pages in button order. maxAge is how long a cached copy may be shown
+ * without a background refresh; it also bounds flash rewrites per page.
+ */
+export const DEVICE_PAGES = [
+  { id: 'outbound', title: 'Journey', maxAge: 60 },
+  { id: 'return', title: 'Return journey', maxAge: 900 },
+  { id: 'weather', title: 'Weather', maxAge: 1800 },
+  { id: 'alerts', title: 'Service alerts', maxAge: 600 }
+];
+
+const MAX_PAGES = 6;          // PAGE_MAX in page-cache.h
+const MAX_ID_LENGTH = 15;
+
+/** "outbound=60,return=900,..." */
+export function encodePageList(pages = DEVICE_PAGES) {
+  return pages.slice(0, MAX_PAGES).map(p => `${p.id}=${p.maxAge}`).join(',');
+}
+
+/**
+ * Parse an X-Pages value (tests, tools; the device uses page_list_parse())
+ * @returns {Array<{id: string, maxAge: number}>|null}
+ */
+export function parsePageList(value) {
+  const pages = [];
+  for (const item of String(value || '').split(',')) {
+    const match = /^([a-z0-9_-]{1,15})=(\d{1,7})$/.exec(item.trim());
+    if (!match || pages.length >= MAX_PAGES) return null;
+    pages.push({ id: match[1], maxAge: Number(match[2]) });
+  }
+  return pages.length ? pages : null;
+}
+
+export function findPage(id) {
+  const index = DEVICE_PAGES.findIndex(p => p.id === id && id.length <= MAX_ID_LENGTH);
+  return index < 0 ? null : { ...DEVICE_PAGES[index], index };
+}
+
+/** Config token contents for the journey home: addresses and locations swapped */
+export function returnJourneyConfig(config) {
+  const swap = (o = {}) => ({ ...o, home: o.work, work: o.home });
+  return {
+    ...config,
+    addresses: swap(config.addresses),
+    locations: swap(config.locations),
+    journey: { ...config.journey, coffeeEnabled: false }
+  };
+}
+
+/**
+ * Weather page content from getWeather() (opendata-client.js)
+ * @returns {{title: string, sections: Array<{heading: string, lines: string[]}>, footer: string}}
+ */
+export function weatherPageContent(weather, place) {
+  const lines = [
+    `${weather?.temp ?? '--'}°C  ${weather?.condition || 'Unknown'}`,
+    weather?.precipitation > 0 ? `${weather.precipitation} mm rain in the last hour` : 'No rain in the last hour'
+  ];
+  return {
+    title: 'WEATHER',
+    sections: [
+      { heading: place || 'Home', lines },
+      { heading: 'Take', lines: [weather?.umbrella ? 'Umbrella - rain about' : 'No umbrella needed'] }
+    ],
+    footer: weather?.source === 'fallback' || weather?.error ? 'WEATHER UNAVAILABLE - LAST KNOWN' : 'OPEN-METEO'
+  };
+}
+
+/**
+ * Alerts page content: delayed or suspended legs of the journey first,
+ * then network alerts for the modes it uses (getDisruptions())
+ */
+export function alertsPageContent(dashboardData, disruptions = []) {
+  const legAlerts = (dashboardData?.journey_legs || [])
+    .filter(leg => leg.state && leg.state !== 'normal' && leg.state !== 'skip')
+    .map(leg => ({ heading: `${leg.state.toUpperCase()}: ${leg.title}`, lines: [leg.subtitle].filter(Boolean) }));
+  const network = disruptions.slice(0, 4).map(d => ({
+    heading: d.title || 'Alert',
+    lines: d.description ? [d.description] : []
+  }));
+  const sections = [...legAlerts, ...network];
+  return {
+    title: 'SERVICE ALERTS',
+    sections: sections.length ? sections : [{ heading: 'Good service', lines: ['No alerts for your journey'] }],
+    footer: `${sections.length} ALERT${sections.length === 1 ? '' : 'S'}`
+  };
+}
+
+/**
+ * One full-screen CCZF frame (refresh flag set) and its hash
+ * @returns {{frame: Buffer, hash: string}}
+ */
+export function pageFrameFromBMP(bmp) {
+  const width = bmp.readInt32LE(18);
+  const height = Math.abs(bmp.readInt32LE(22));
+  const { frames } = bmpToZoneFrames(bmp, { zones: [{ id: 'page', x: 0, y: 0, w: width, h: height }] });
+  const frame = frames[0];
+  frame[5] |= FRAME_FLAG_REFRESH;
+  return { frame, hash: pageHash(frame) };
+}
+
+/** FNV-1a of a page frame, 8 hex digits (page_hash() on the device) */
+export function pageHash(frame) {
+  return fnv1a32(frame).toString(16).padStart(8, '0');
+}
+
+export default {
+  PAGES_HEADER,
+  PAGE_HASH_HEADER,
+  DEVICE_PAGES,
+  encodePageList,
+  parsePageList,
+  findPage,
+  returnJourneyConfig,
+  weatherPageContent,
+  alertsPageContent,
+  pageFrameFromBMP,
+  pageHash
+};
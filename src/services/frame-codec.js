@@ -0,0 +1,169 @@
+/**
+ * Compressed Zone Frame Encoder (CCZF)
+ * Part of the Commute Compute System™
+ *
+ * Turns 1-bit dashboard BMPs into PackBits-compressed zone frames that can
+ * be pushed straight to CCFirm over BLE (or any byte stream) and decoded
+ * into the same row-sink pipeline as HTTP fetches.
+ * Wire format and decoder: firmware/include/frame-codec.h
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+export const FRAME_MAGIC = 'CCZF';
+export const FRAME_VERSION = 1;
+export const FRAME_HEADER_SIZE = 18;
+export const FRAME_FLAG_REFRESH = 0x01;
+export const FRAME_FLAG_FULL = 0x02;
+
+/**
+ * Full-width push bands following the V12 layout
+ * (header, status bar, journey legs, footer)
+ */
+export function getPushBands(width, height) {
+  return [
+    { id: 'header', x: 0, y: 0, w: width, h: 96 },
+    { id: 'status', x: 0, y: 96, w: width, h: 32 },
+    { id: 'legs', x: 0, y: 128, w: width, h: height - 160 },
+    { id: 'footer', x: 0, y: height - 32, w: width, h: 32 }
+  ];
+}
+
+/**
+ * PackBits compression (matches frame_packbits() in firmware)
+ */
+export function packBits(src) {
+  const out = [];
+  let i = 0;
+  while (i < src.length) {
+    let run = 1;
+    while (i + run < src.length && run < 128 && src[i + run] === src[i]) run++;
+    if (run >= 3 || (run === 2 && i + run === src.length)) {
+      out.push((257 - run) & 0xFF, src[i]);
+      i += run;
+      continue;
+    }
+    const start = i;
+    let lit = 0;
+    while (i < src.length && lit < 128) {
+      if (i + 2 < src.length && src[i] === src[i + 1] && src[i] === src[i + 2]) break;
+      i++;
+      lit++;
+    }
+    out.push(lit - 1);
+    for (let k = start; k < start + lit; k++) out.push(src[k]);
+  }
+  return Buffer.from(out);
+}
+
+/**
+ * Decode a 1-bit BMP into packed top-down rows (bit = 1 white)
+ */
+export function parseBMP1(bmp) {
+  if (bmp.length < 62 || bmp.toString('ascii', 0, 2) !== 'BM') {
+    throw new Error('Not a BMP');
+  }
+  const pixelOffset = bmp.readUInt32LE(10);
+  const dibSize = bmp.readUInt32LE(14);
+  const width = bmp.readInt32LE(18);
+  const rawHeight = bmp.readInt32LE(22);
+  const bpp = bmp.readUInt16LE(28);
+  if (bpp !== 1 || bmp.readUInt32LE(30) !== 0) throw new Error('Only uncompressed 1-bit BMPs are supported');
+
+  const height = Math.abs(rawHeight);
+  const stride = Math.ceil(width / 32) * 4;
+  const rowBytes = Math.ceil(width / 8);
+  if (pixelOffset + stride * height > bmp.length) throw new Error('Truncated BMP');
+
+  const pal = 14 + dibSize;
+  const invert = (bmp[pal] + bmp[pal + 1] + bmp[pal + 2]) > (bmp[pal + 4] + bmp[pal + 5] + bmp[pal + 6]);
+  const pixels = Buffer.alloc(rowBytes * height);
+  for (let y = 0; y < height; y++) {
+    const fileRow = rawHeight < 0 ? y : height - 1 - y;
+    bmp.copy(pixels, y * rowBytes, pixelOffset + fileRow * stride, pixelOffset + fileRow * stride + rowBytes);
+    if (invert) {
+      for (let b = 0; b < rowBytes; b++) pixels[y * rowBytes + b] ^= 0xFF;
+    }
+  }
+  return { width, height, rowBytes, pixels };
+}
+
+/**
+ * Extract a rectangle of packed rows, re-aligned so the zone starts at bit 0
+ */
+function extractZone(image, zone) {
+  const zoneBytes = Math.ceil(zone.w / 8);
+  const out = Buffer.alloc(zoneBytes * zone.h, 0xFF);
+  for (let row = 0; row < zone.h; row++) {
+    const src = (zone.y + row) * image.rowBytes;
+    for (let px = 0; px < zone.w; px++) {
+      const sx = zone.x + px;
+      const white = (image.pixels[src + (sx >> 3)] >> (7 - (sx & 7))) & 1;
+      if (!white) out[row * zoneBytes + (px >> 3)] &= ~(0x80 >> (px & 7));
+    }
+  }
+  return out;
+}
+
+/**
+ * Encode one zone frame
+ */
+export function encodeZoneFrame(zone, rows, flags = 0) {
+  const payload = packBits(rows);
+  const header = Buffer.alloc(FRAME_HEADER_SIZE);
+  header.write(FRAME_MAGIC, 0, 'ascii');
+  header.writeUInt8(FRAME_VERSION, 4);
+  header.writeUInt8(flags, 5);
+  header.writeUInt16LE(zone.x, 6);
+  header.writeUInt16LE(zone.y, 8);
+  header.writeUInt16LE(zone.w, 10);
+  header.writeUInt16LE(zone.h, 12);
+  header.writeUInt32LE(payload.length, 14);
+  return Buffer.concat([header, payload]);
+}
+
+/**
+ * Encode a full-screen BMP as a sequence of zone frames.
+ * With `previous` (the BMP last pushed), unchanged bands are skipped.
+ * The last frame carries the refresh flag.
+ *
+ * @returns {{ frames: Buffer[], zones: string[], rawBytes: number, encodedBytes: number }}
+ */
+export function bmpToZoneFrames(bmp, { previous = null, fullRefresh = false, zones = null } = {}) {
+  const image = parseBMP1(bmp);
+  const prevImage = previous ? parseBMP1(previous) : null;
+  const bands = zones || getPushBands(image.width, image.height);
+
+  const changed = [];
+  for (const zone of bands) {
+    const rows = extractZone(image, zone);
+    if (prevImage && prevImage.width === image.width && prevImage.height === image.height &&
+        rows.equals(extractZone(prevImage, zone))) {
+      continue;
+    }
+    changed.push({ zone, rows });
+  }
+
+  const frames = changed.map(({ zone, rows }, idx) => {
+    const last = idx === changed.length - 1;
+    const flags = last ? (FRAME_FLAG_REFRESH | (fullRefresh ? FRAME_FLAG_FULL : 0)) : 0;
+    return encodeZoneFrame(zone, rows, flags);
+  });
+
+  return {
+    frames,
+    zones: changed.map(c => c.zone.id),
+    rawBytes: changed.reduce((n, c) => n + c.rows.length, 0),
+    encodedBytes: frames.reduce((n, f) => n + f.length, 0)
+  };
+}
+
+export default {
+  packBits,
+  parseBMP1,
+  encodeZoneFrame,
+  bmpToZoneFrames,
+  getPushBands
+};
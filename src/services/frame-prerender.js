@@ -0,0 +1,411 @@
+/**
+ * Speculative Frame Pre-render
+ * Part of the Commute Compute System™
+ *
+ * A device fetching /api/device/[token]?format=bmp normally waits for
+ * LiveDash + the full canvas render on every request. Devices fetch on a
+ * fixed cadence, so the frame they will ask for next is predictable: a few
+ * seconds before each minute boundary this renders the next minute's frame
+ * for every recently active device whose expected fetch falls in that
+ * minute, and stores it keyed by device and minute. The request path then
+ * serves it straight from memory (same instance) or KV (any instance).
+ *
+ * Devices announce their next fetch with the X-Next-Fetch header (seconds
+ * from now); without it a 60 s cadence is assumed.
+ *
+ * Active devices are shared with other instances through KV, one key per
+ * device (cc:prerender:active:<id>) plus an index of ids that is only
+ * re-checked every few minutes, so a fetch costs one small write and
+ * concurrent instances never overwrite each other's devices. Config tokens
+ * embed the user's transit API key, so KV only holds them sealed
+ * (AES-256-GCM under a key from WEBHOOK_SECRET); without WEBHOOK_SECRET
+ * each instance pre-renders only the devices it has seen itself.
+ *
+ * Scheduling:
+ *   - Vercel: api/prerender.js runs from a per-minute cron (opt-in, Pro
+ *     plans - see INSTALL.md) and calls prerenderBeforeBoundary()
+ *   - Long-running servers: startPrerenderLoop()
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+import crypto from 'crypto';
+import { getCachedValue, setCachedValue } from '../data/kv-preferences.js';
+import {
+  decodeConfigToken,
+  loadSmartCommuteSettings,
+  renderDeviceBMP,
+  deviceFreshHashes
+} from './device-frame.js';
+
+export const NEXT_FETCH_HEADER = 'x-next-fetch';
+export const PRERENDER_LEAD_MS = 5000;          // Render this long before the boundary
+export const DEFAULT_FETCH_INTERVAL_MS = 60000;
+
+const ACTIVE_WINDOW_MS = 10 * 60 * 1000;        // Devices seen within this are pre-rendered
+const MAX_ACTIVE_DEVICES = 500;
+const MAX_MEMORY_FRAMES = 256;
+const FRAME_TTL_SECONDS = 180;
+const ACTIVE_TTL_SECONDS = 900;
+const INDEX_REFRESH_MS = 5 * 60 * 1000;         // Re-check our devices are indexed
+const KV_ACTIVE_PREFIX = 'cc:prerender:active:';
+const KV_INDEX_KEY = 'cc:prerender:index';
+
+// Per-instance state (survives between invocations on a warm instance):
+//   memoryFrames   frameKey -> { bmp, slice, zoneHashes, freshHashes, renderedAt }
+//   activeDevices  deviceId -> { token, device, nextFetchAt, seenAt }
+//   indexedAt      deviceId -> when this instance last saw it in the index
+const memoryFrames = new Map();
+const activeDevices = new Map();
+const indexedAt = new Map();
+
+const stats = {
+  hits: 0,
+  kvHits: 0,
+  misses: 0,
+  rendered: 0,
+  renderErrors: 0,
+  renderMsTotal: 0,
+  lastRun: null
+};
+
+/**
+ * Short stable id for a token (tokens embed API keys - keep them out of key names)
+ */
+export function deviceIdForToken(token) {
+  return crypto.createHash('sha256').update(token).digest('hex').slice(0, 16);
+}
+
+function tokenKey() {
+  const secret = process.env.WEBHOOK_SECRET;
+  return secret ? crypto.createHmac('sha256', secret).update('cc-prerender-token').digest() : null;
+}
+
+/**
+ * Config token sealed for KV (base64url iv.tag.ciphertext), or null
+ * without WEBHOOK_SECRET
+ */
+export function sealToken(token) {
+  const key = tokenKey();
+  if (!key) return null;
+  const iv = crypto.randomBytes(12);
+  const cipher = crypto.createCipheriv('aes-256-gcm', key, iv);
+  const sealed = Buffer.concat([cipher.update(token, 'utf8'), cipher.final()]);
+  return [iv, cipher.getAuthTag(), sealed].map(b => b.toString('base64url')).join('.');
+}
+
+/**
+ * Token from sealToken(), or null if it does not open under this key
+ */
+export function openToken(sealed) {
+  const key = tokenKey();
+  const parts = typeof sealed === 'string' ? sealed.split('.') : [];
+  if (!key || parts.length !== 3) return null;
+  try {
+    const [iv, tag, data] = parts.map(p => Buffer.from(p, 'base64url'));
+    const decipher = crypto.createDecipheriv('aes-256-gcm', key, iv);
+    decipher.setAuthTag(tag);
+    return Buffer.concat([decipher.update(data), decipher.final()]).toString('utf8');
+  } catch {
+    return null;
+  }
+}
+
+function activeKey(id) {
+  return KV_ACTIVE_PREFIX + id;
+}
+
+export function minuteOf(ms) {
+  return Math.floor(ms / 60000);
+}
+
+function frameKey(id, device, minute) {
+  return `cc:frame:${id}:${device}:${minute}`;
+}
+
+/**
+ * Expected next fetch time from the device's X-Next-Fetch header
+ * (seconds from now) or ?next= query, else one interval from now
+ */
+export function expectedNextFetch(req, now = Date.now()) {
+  const raw = req.headers?.[NEXT_FETCH_HEADER] ?? req.query?.next;
+  const seconds = Number.parseInt(raw, 10);
+  if (Number.isFinite(seconds) && seconds > 0 && seconds <= 24 * 3600) {
+    return now + seconds * 1000;
+  }
+  return now + DEFAULT_FETCH_INTERVAL_MS;
+}
+
+/**
+ * Record a device fetch so its next frame gets pre-rendered. This instance
+ * knows about it on return; the promise settles once it is shared through
+ * KV. Serverless callers must wait for it before responding, or the write
+ * can be lost when the function is frozen.
+ */
+export function noteDeviceFetch(token, {
+  device = 'trmnl-og',
+  nextFetchAt,
+  now = Date.now()
+} = {}) {
+  const id = deviceIdForToken(token);
+  const entry = { token, device, nextFetchAt, seenAt: now };
+  activeDevices.set(id, entry);
+  pruneActive(activeDevices, now);
+  for (const known of indexedAt.keys()) {
+    if (!activeDevices.has(known)) indexedAt.delete(known);
+  }
+  return shareActiveDevice(id, entry, now);
+}
+
+async function shareActiveDevice(id, { token, device, nextFetchAt, seenAt }, now) {
+  const sealed = sealToken(token);
+  if (!sealed) return;
+  await setCachedValue(activeKey(id), { sealed, device, nextFetchAt, seenAt }, ACTIVE_TTL_SECONDS);
+
+  // The index is one shared key: a concurrent add can be lost, so it is
+  // re-checked every INDEX_REFRESH_MS rather than trusted once
+  if (now - (indexedAt.get(id) || 0) < INDEX_REFRESH_MS) return;
+  indexedAt.set(id, now);
+  const index = (await getCachedValue(KV_INDEX_KEY)) || [];
+  if (index.includes(id)) return;
+  const updated = [...index, id].slice(-MAX_ACTIVE_DEVICES);
+  await setCachedValue(KV_INDEX_KEY, updated, ACTIVE_TTL_SECONDS);
+}
+
+async function loadSharedDevice(id) {
+  const shared = await getCachedValue(activeKey(id));
+  const token = shared && openToken(shared.sealed);
+  if (!token) return null;
+  return { token, device: shared.device, nextFetchAt: shared.nextFetchAt, seenAt: shared.seenAt };
+}
+
+/**
+ * Token and device of a recently active device, or null
+ * @param {string} id - deviceIdForToken() of its token
+ * @returns {Promise<{token: string, device: string, nextFetchAt: number, seenAt: number}|null>}
+ */
+export async function getActiveDevice(id, now = Date.now()) {
+  const entry = activeDevices.get(id) || await loadSharedDevice(id);
+  return entry && now - entry.seenAt <= ACTIVE_WINDOW_MS ? entry : null;
+}
+
+function pruneActive(map, now) {
+  for (const [id, entry] of map) {
+    if (now - entry.seenAt > ACTIVE_WINDOW_MS) map.delete(id);
+  }
+  if (map.size > MAX_ACTIVE_DEVICES) {
+    const oldest = [...map.entries()].sort((a, b) => a[1].seenAt - b[1].seenAt);
+    for (const [id] of oldest.slice(0, map.size - MAX_ACTIVE_DEVICES)) map.delete(id);
+  }
+}
+
+async function loadActiveDevices(now) {
+  const merged = new Map(activeDevices);
+  if (!tokenKey()) return merged;
+  const index = (await getCachedValue(KV_INDEX_KEY)) || [];
+  const shared = await Promise.all(index.map(id =>
+    (merged.has(id) ? null : loadSharedDevice(id))));
+  index.forEach((id, i) => {
+    if (shared[i]) merged.set(id, shared[i]);
+  });
+  pruneActive(merged, now);
+  return merged;
+}
+
+/**
+ * Pre-rendered frame for this device and minute, or null
+ * @returns {Promise<{bmp: Buffer, slice: string|null, zoneHashes: number[]|null,
+ *                    freshHashes: number[]|null, source: string}|null>}
+ */
+export async function getPrerenderedFrame(token, device, minute) {
+  const key = frameKey(deviceIdForToken(token), device, minute);
+  const local = memoryFrames.get(key);
+  if (local) {
+    stats.hits++;
+    return { ...local, source: 'memory' };
+  }
+  const shared = await getCachedValue(key);
+  if (shared?.bmp) {
+    stats.kvHits++;
+    return {
+      bmp: Buffer.from(shared.bmp, 'base64'),
+      slice: shared.slice || null,
+      zoneHashes: shared.zoneHashes || null,
+      freshHashes: shared.freshHashes || null,
+      source: 'kv'
+    };
+  }
+  stats.misses++;
+  return null;
+}
+
+async function storeFrame(key, frame) {
+  memoryFrames.set(key, frame);
+  while (memoryFrames.size > MAX_MEMORY_FRAMES) {
+    memoryFrames.delete(memoryFrames.keys().next().value);
+  }
+  await setCachedValue(key, {
+    bmp: frame.bmp.toString('base64'),
+    slice: frame.slice,
+    zoneHashes: frame.zoneHashes,
+    freshHashes: frame.freshHashes,
+    renderedAt: frame.renderedAt
+  }, FRAME_TTL_SECONDS);
+}
+
+/**
+ * Render and store the frame for `minute` for every active device whose
+ * expected fetch falls in that minute
+ *
+ * @param {object} [options]
+ * @param {number} [options.minute] - Target minute (default: the next one)
+ * @param {number} [options.now]
+ * @returns {Promise<object>} Summary of the run
+ */
+export async function prerenderMinute({ now = Date.now(), minute = minuteOf(now) + 1 } = {}) {
+  const started = Date.now();
+  const devices = await loadActiveDevices(now);
+  const targetAt = minute * 60000;
+  let rendered = 0, skipped = 0, errors = 0;
+
+  // One settings lookup per run, not per device
+  const scSettings = await loadSmartCommuteSettings();
+
+  for (const [id, entry] of devices) {
+    if (minuteOf(entry.nextFetchAt) !== minute) {
+      skipped++;
+      continue;
+    }
+    const key = frameKey(id, entry.device, minute);
+    if (memoryFrames.has(key)) continue;
+
+    const config = decodeConfigToken(entry.token);
+    if (!config) {
+      errors++;
+      continue;
+    }
+    try {
+      // Show the clock as it will read during the fetch minute
+      const { bmp, slice, zoneHashes, freshHashes, renderMs } = await renderDeviceBMP(config, {
+        device: entry.device,
+        scSettings,
+        at: targetAt
+      });
+      await storeFrame(key, { bmp, slice, zoneHashes, freshHashes, renderedAt: Date.now() });
+      stats.rendered++;
+      stats.renderMsTotal += renderMs;
+      rendered++;
+    } catch (error) {
+      console.error(`[prerender] ${id} failed: ${error.message}`);
+      stats.renderErrors++;
+      errors++;
+    }
+  }
+
+  const summary = {
+    minute,
+    devices: devices.size,
+    rendered,
+    skipped,
+    errors,
+    elapsedMs: Date.now() - started
+  };
+  stats.lastRun = { ...summary, at: new Date(started).toISOString() };
+  console.log(`[prerender] minute ${minute}: ${rendered} rendered, ${skipped} not due, ` +
+    `${errors} errors in ${summary.elapsedMs}ms`);
+  return summary;
+}
+
+/**
+ * Wait until PRERENDER_LEAD_MS before the next minute boundary, then
+ * pre-render that minute. For a per-minute cron (fires near :00).
+ */
+export async function prerenderBeforeBoundary({
+  leadMs = PRERENDER_LEAD_MS,
+  maxWaitMs = 55000
+} = {}) {
+  const now = Date.now();
+  const nextBoundary = (minuteOf(now) + 1) * 60000;
+  const waitMs = Math.max(0, nextBoundary - leadMs - now);
+  if (waitMs > maxWaitMs) {
+    return { skipped: true, reason: `boundary ${Math.round(waitMs / 1000)}s away` };
+  }
+  await new Promise(resolve => setTimeout(resolve, waitMs));
+  return prerenderMinute({ minute: minuteOf(nextBoundary) });
+}
+
+/**
+ * Pre-render loop for long-running servers (not needed on Vercel)
+ * @returns {function} stop
+ */
+export function startPrerenderLoop({ leadMs = PRERENDER_LEAD_MS } = {}) {
+  let timer = null;
+  let stopped = false;
+  const schedule = () => {
+    if (stopped) return;
+    const now = Date.now();
+    let at = (minuteOf(now) + 1) * 60000 - leadMs;
+    if (at <= now) at += 60000;
+    timer = setTimeout(async () => {
+      try {
+        await prerenderMinute({ minute: minuteOf(at + leadMs) });
+      } catch (error) {
+        console.error(`[prerender] Run failed: ${error.message}`);
+      }
+      schedule();
+    }, at - now);
+    timer.unref?.();
+  };
+  schedule();
+  return () => {
+    stopped = true;
+    clearTimeout(timer);
+  };
+}
+
+/**
+ * Freshness hashes (getFreshHashes()) of the frame a device would be
+ * served now, or null if it has not fetched recently. Lookup for the UDP
+ * freshness responder (fresh-check.js): this minute's pre-rendered frame
+ * if there is one, else the data model without rendering.
+ * @param {string} id - deviceIdForToken() of its token
+ * @returns {Promise<number[]|null>}
+ */
+export async function currentZoneHashes(id, now = Date.now()) {
+  const entry = await getActiveDevice(id, now);
+  if (!entry) return null;
+  const prerendered = await getPrerenderedFrame(entry.token, entry.device, minuteOf(now));
+  if (prerendered?.freshHashes) return prerendered.freshHashes;
+  const config = decodeConfigToken(entry.token);
+  return config ? deviceFreshHashes(config, { device: entry.device }) : null;
+}
+
+export function getPrerenderStats() {
+  const served = stats.hits + stats.kvHits;
+  return {
+    ...stats,
+    hitRate: served + stats.misses ? +(served / (served + stats.misses)).toFixed(3) : 0,
+    avgRenderMs: stats.rendered ? Math.round(stats.renderMsTotal / stats.rendered) : 0,
+    activeDevices: activeDevices.size,
+    memoryFrames: memoryFrames.size
+  };
+}
+
+export default {
+  NEXT_FETCH_HEADER,
+  expectedNextFetch,
+  noteDeviceFetch,
+  getActiveDevice,
+  getPrerenderedFrame,
+  currentZoneHashes,
+  prerenderMinute,
+  prerenderBeforeBoundary,
+  startPrerenderLoop,
+  getPrerenderStats,
+  deviceIdForToken,
+  sealToken,
+  openToken,
+  minuteOf
+};
@@ -0,0 +1,314 @@
+/**
+ * UDP Freshness Check
+ * Part of the Commute Compute System™
+ *
+ * Most 60 s device polls find the frame unchanged, yet each one costs a TCP
+ * connect and a TLS handshake before the server can say so. CCFirm first
+ * sends one authenticated datagram with the freshness hashes of the frame
+ * it is showing (the X-Fresh-Hashes vector served with the BMP); the
+ * responder answers "unchanged", or which zones changed, and only then
+ * does the device open the HTTPS connection. No reply (UDP blocked,
+ * responder down) just means a normal fetch.
+ *
+ * Freshness hashes (getFreshHashes() in ccdash-renderer.js) leave out
+ * what only moves with the clock - the clock zone and the leg countdowns -
+ * since a poll a minute after the frame would otherwise never match. An
+ * "unchanged" therefore means only the clock moved; CCFirm bounds how
+ * many polls in a row it skips that way (FRESH_MAX_SKIPS in
+ * fresh-check.h) so the clock and countdowns never lag by more.
+ *
+ *   Query  u8 version=1, u8 type=1, u8 idLen, identity[idLen],
+ *          u8 deviceId[8], u32le nonce, u8 count, u32le hash × count,
+ *          u8 tag[16]
+ *   Reply  u8 version=1, u8 type=2, u8 status, u8 zones, u32le nonce,
+ *          u32le changed, u8 tag[16]
+ *
+ * identity is the device's TLS-PSK identity (device-psk.js); both tags are
+ * HMAC-SHA256 truncated to 16 bytes under HMAC-SHA256(PSK, "cc-fresh-v1"),
+ * so only the paired device can ask and only the server can answer. The
+ * reply echoes the query's random nonce, so an old "unchanged" cannot be
+ * replayed to hold a device on a stale frame. Queries with a bad tag get
+ * no reply at all.
+ *
+ * deviceId is the first 8 bytes of SHA-256(config token) - the
+ * deviceIdForToken() key the pre-renderer already tracks devices under
+ * (frame-prerender.js), which is how the responder finds the token without
+ * the device sending it. The identity is the same id behind the cc1-
+ * prefix (pskIdentityForUrl()), so a query whose deviceId is not its own
+ * identity's is dropped: a paired device cannot probe another's state.
+ *
+ * The server answers with currentZoneHashes() (frame-prerender.js), which
+ * takes this minute's pre-rendered frame when there is one, else the data
+ * model without rendering. This module only needs a lookup, so
+ * tools/fresh-responder.mjs can stand in for the server with scripted
+ * answers.
+ *
+ * changed has bit i set when freshness hash i (getActiveZones() order,
+ * clock zone left out) is not among the device's hashes.
+ *
+ * Vercel functions cannot receive UDP: the responder runs in server.js
+ * when FRESH_PORT is set (sharing pre-render state through KV), and
+ * FRESH_ENDPOINT ("host:port") tells devices where it is. With neither
+ * set, pairing hands out no endpoint and devices always fetch.
+ * Device side: firmware/include/fresh-check.h
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+import dgram from 'dgram';
+import { createHmac, timingSafeEqual } from 'crypto';
+import {
+  derivePsk,
+  isPskEnabled,
+  pskIdentityForUrl,
+  PSK_IDENTITY_PREFIX
+} from '../utils/device-psk.js';
+
+export const FRESH_HASH_HEADER = 'X-Fresh-Hashes';
+export const FRESH_VERSION = 1;
+export const FRESH_QUERY = 1;
+export const FRESH_REPLY = 2;
+export const FRESH_TAG_BYTES = 16;
+export const FRESH_DEVICE_ID_BYTES = 8;
+export const FRESH_HASH_MAX = 16;
+export const FRESH_REPLY_BYTES = 12 + FRESH_TAG_BYTES;
+
+export const FRESH_STATUS = {
+  UNCHANGED: 0,
+  CHANGED: 1,
+  UNKNOWN: 2          // Device not seen recently - fetch normally (re-registers it)
+};
+
+const stats = {
+  queries: 0,
+  unchanged: 0,
+  changed: 0,
+  unknown: 0,
+  rejected: 0,
+  errors: 0,
+  lookupMsTotal: 0
+};
+
+/**
+ * Key for the datagram tags, kept apart from the TLS use of the PSK
+ * @param {Buffer} psk
+ */
+export function freshKey(psk) {
+  return createHmac('sha256', psk).update('cc-fresh-v1').digest();
+}
+
+function tag(key, body) {
+  return createHmac('sha256', key).update(body).digest().subarray(0, FRESH_TAG_BYTES);
+}
+
+function tagMatches(key, body, provided) {
+  return timingSafeEqual(tag(key, body), provided);
+}
+
+/**
+ * Build a query datagram (devices, tools/fresh-responder.mjs, tests)
+ * @param {{identity: string, deviceId: string, nonce: number, hashes: number[]}} query
+ * @param {Buffer} key - freshKey() of the device's PSK
+ */
+export function encodeFreshQuery({ identity, deviceId, nonce, hashes }, key) {
+  const id = Buffer.from(identity, 'latin1');
+  const list = hashes.slice(0, FRESH_HASH_MAX);
+  const body = Buffer.alloc(3 + id.length + FRESH_DEVICE_ID_BYTES + 5 + 4 * list.length);
+  let o = body.writeUInt8(FRESH_VERSION, 0);
+  o = body.writeUInt8(FRESH_QUERY, o);
+  o = body.writeUInt8(id.length, o);
+  o += id.copy(body, o);
+  o += Buffer.from(deviceId, 'hex').copy(body, o, 0, FRESH_DEVICE_ID_BYTES);
+  o = body.writeUInt32LE(nonce >>> 0, o);
+  o = body.writeUInt8(list.length, o);
+  for (const h of list) o = body.writeUInt32LE(h >>> 0, o);
+  return Buffer.concat([body, tag(key, body)]);
+}
+
+/**
+ * Parse a query datagram (tag not checked yet)
+ * @param {Buffer} buf
+ * @returns {{identity: string, deviceId: string, nonce: number, hashes: number[],
+ *            body: Buffer, tag: Buffer}|null}
+ */
+export function decodeFreshQuery(buf) {
+  if (buf.length < 3 + FRESH_DEVICE_ID_BYTES + 5 + FRESH_TAG_BYTES) return null;
+  if (buf[0] !== FRESH_VERSION || buf[1] !== FRESH_QUERY) return null;
+  const idLen = buf[2];
+  let o = 3 + idLen;
+  if (idLen === 0 || buf.length < o + FRESH_DEVICE_ID_BYTES + 5 + FRESH_TAG_BYTES) return null;
+  const identity = buf.toString('latin1', 3, o);
+  const deviceId = buf.toString('hex', o, o + FRESH_DEVICE_ID_BYTES);
+  o += FRESH_DEVICE_ID_BYTES;
+  const nonce = buf.readUInt32LE(o);
+  const count = buf[o + 4];
+  o += 5;
+  if (count > FRESH_HASH_MAX || buf.length !== o + 4 * count + FRESH_TAG_BYTES) return null;
+  const hashes = [];
+  for (let i = 0; i < count; i++) hashes.push(buf.readUInt32LE(o + 4 * i));
+  o += 4 * count;
+  return { identity, deviceId, nonce, hashes, body: buf.subarray(0, o), tag: buf.subarray(o) };
+}
+
+/**
+ * Tag key for a parsed query, or null if its identity is not ours, asks
+ * about another device, or the tag does not verify
+ */
+export function verifyFreshQuery(query) {
+  if (query.identity !== PSK_IDENTITY_PREFIX + query.deviceId) return null;
+  const psk = derivePsk(query.identity);
+  if (!psk) return null;
+  const key = freshKey(psk);
+  return tagMatches(key, query.body, query.tag) ? key : null;
+}
+
+/**
+ * @param {{status: number, zones: number, nonce: number, changed: number}} reply
+ * @param {Buffer} key
+ */
+export function encodeFreshReply({ status, zones = 0, nonce, changed = 0 }, key) {
+  const body = Buffer.alloc(12);
+  body.writeUInt8(FRESH_VERSION, 0);
+  body.writeUInt8(FRESH_REPLY, 1);
+  body.writeUInt8(status, 2);
+  body.writeUInt8(Math.min(zones, 32), 3);
+  body.writeUInt32LE(nonce >>> 0, 4);
+  body.writeUInt32LE(changed >>> 0, 8);
+  return Buffer.concat([body, tag(key, body)]);
+}
+
+/**
+ * Parse and authenticate a reply to the query sent with nonce
+ * @returns {{status: number, zones: number, changed: number}|null}
+ */
+export function decodeFreshReply(buf, key, nonce) {
+  if (buf.length !== FRESH_REPLY_BYTES) return null;
+  if (buf[0] !== FRESH_VERSION || buf[1] !== FRESH_REPLY) return null;
+  if (!tagMatches(key, buf.subarray(0, 12), buf.subarray(12))) return null;
+  if (buf.readUInt32LE(4) !== nonce >>> 0) return null;
+  return { status: buf[2], zones: buf[3], changed: buf.readUInt32LE(8) };
+}
+
+/**
+ * Compare what the device shows with the current zone hashes
+ * @param {number[]} deviceHashes - From the query (empty = shows nothing)
+ * @param {number[]} current - Active zone hashes, getActiveZones() order
+ * @returns {{status: number, zones: number, changed: number}}
+ */
+export function compareZoneHashes(deviceHashes, current) {
+  const shown = new Set(deviceHashes);
+  let changed = 0;
+  current.slice(0, 32).forEach((hash, i) => {
+    if (!shown.has(hash)) changed |= 1 << i;
+  });
+  changed >>>= 0;
+  // A zone that went away (fewer legs) changes the frame too
+  const same = changed === 0 && shown.size === new Set(current).size;
+  return {
+    status: same ? FRESH_STATUS.UNCHANGED : FRESH_STATUS.CHANGED,
+    zones: current.length,
+    changed
+  };
+}
+
+/**
+ * Answer one query datagram
+ * @param {Buffer} msg
+ * @param {function(string): Promise<number[]|null>} lookup - Current hashes
+ *   by device id, null if unknown (currentZoneHashes() in frame-prerender.js)
+ * @returns {Promise<Buffer|null>} Reply, or null to stay silent
+ */
+export async function answerFreshQuery(msg, lookup) {
+  const query = decodeFreshQuery(msg);
+  const key = query && verifyFreshQuery(query);
+  if (!key) {
+    stats.rejected++;
+    return null;
+  }
+  stats.queries++;
+  const started = Date.now();
+  const current = await lookup(query.deviceId);
+  stats.lookupMsTotal += Date.now() - started;
+  if (!current) {
+    stats.unknown++;
+    return encodeFreshReply({ status: FRESH_STATUS.UNKNOWN, nonce: query.nonce }, key);
+  }
+  const result = compareZoneHashes(query.hashes, current);
+  if (result.status === FRESH_STATUS.UNCHANGED) stats.unchanged++; else stats.changed++;
+  return encodeFreshReply({ ...result, nonce: query.nonce }, key);
+}
+
+/**
+ * UDP responder (call .bind(port) on the result)
+ * @param {object} options
+ * @param {function(string): Promise<number[]|null>} options.lookup - As answerFreshQuery()
+ * @param {function(object): void} [options.onAnswer] - Called with {query, reply, from}
+ */
+export function createFreshResponder({ lookup, onAnswer }) {
+  const socket = dgram.createSocket('udp4');
+  socket.on('message', async (msg, from) => {
+    try {
+      const reply = await answerFreshQuery(msg, lookup);
+      if (reply) socket.send(reply, from.port, from.address);
+      onAnswer?.({ query: decodeFreshQuery(msg), reply, from });
+    } catch (error) {
+      stats.errors++;
+      console.error(`[fresh] ${from.address}: ${error.message}`);
+    }
+  });
+  return socket;
+}
+
+/**
+ * Responder address devices should use ("host:port"), or null if none
+ * @param {object} [req] - Pairing request (host is reused with FRESH_PORT)
+ */
+export function getFreshEndpoint(req) {
+  if (process.env.FRESH_ENDPOINT) return process.env.FRESH_ENDPOINT;
+  const port = parseInt(process.env.FRESH_PORT, 10);
+  const host = (req?.headers?.['x-forwarded-host'] || req?.headers?.host || '').split(':')[0];
+  if (!port || !host) return null;
+  return `${host}:${port}`;
+}
+
+/**
+ * Field added to the paired response of /api/pair/{code} (queries are
+ * signed with the PSK, so none without one or for a revoked identity)
+ * @param {object} [req]
+ * @param {string} [webhookUrl] - The URL being paired (pskIdentityForUrl())
+ * @returns {{freshEndpoint?: string}}
+ */
+export function provisionFreshEndpoint(req, webhookUrl) {
+  if (!isPskEnabled() || !derivePsk(pskIdentityForUrl(webhookUrl))) return {};
+  const endpoint = getFreshEndpoint(req);
+  return endpoint ? { freshEndpoint: endpoint } : {};
+}
+
+export function getFreshStats() {
+  const answered = stats.unchanged + stats.changed + stats.unknown;
+  return {
+    ...stats,
+    avgLookupMs: stats.queries ? Math.round(stats.lookupMsTotal / stats.queries) : 0,
+    unchangedRate: answered ? +(stats.unchanged / answered).toFixed(3) : 0
+  };
+}
+
+export default {
+  FRESH_HASH_HEADER,
+  FRESH_VERSION,
+  FRESH_STATUS,
+  freshKey,
+  encodeFreshQuery,
+  decodeFreshQuery,
+  verifyFreshQuery,
+  encodeFreshReply,
+  decodeFreshReply,
+  compareZoneHashes,
+  answerFreshQuery,
+  createFreshResponder,
+  getFreshEndpoint,
+  provisionFreshEndpoint,
+  getFreshStats
+};
@@ -21,6 +21,8 @@
 
 import { createCanvas } from '@napi-rs/canvas';
 import SmartCommute from '../engines/smart-commute.js';
+import { canvasToBMP } from './ccdash-renderer.js';
+import { bmpToZoneFrames } from './frame-codec.js';
 
 // =============================================================================
 // DEVICE CONFIGURATIONS
@@ -130,6 +132,8 @@ export const DEVICE_CONFIGS = {
   'kindle-voyage': { alias: 'kindle-pw3' },  // Voyage same res as PW3/4
   'kindle-touch': { alias: 'kindle-k4' },  // Touch same as K4
   'kindle-basic': { alias: 'kindle-k4' },  // Basic same as K4
+  'kindle-basic-10': { alias: 'kindle-k4' },  // Basic 10th gen same as K4
+  'kindle-11': { alias: 'kindle-pw3' },  // Kindle 11th gen same res as PW3/4
   'inkplate-6': {
     name: 'Inkplate 6',
     width: 800,
@@ -237,6 +241,46 @@ export class LiveDash {
    * Render dashboard optimized for the selected device
    */
   renderForDevice(data) {
+    return this.renderCanvasForDevice(data).toBuffer('image/png');
+  }
+
+  /**
+   * Render the dashboard as 1-bit CCZF zone frames, one per layout band,
+   * for the native Kindle display client (firmware/kindle/native)
+   *
+   * @returns {{ frames: Buffer[], zones: string[], rawBytes: number, encodedBytes: number }}
+   */
+  async renderFrames(options = {}) {
+    const journeyData = await this.smartCommute.getJourneyRecommendation({
+      forceRefresh: options.forceRefresh || false
+    });
+    const bmp = canvasToBMP(this.renderCanvasForDevice(journeyData));
+    return bmpToZoneFrames(bmp, {
+      fullRefresh: options.fullRefresh || false,
+      zones: this.getFrameBands()
+    });
+  }
+
+  /**
+   * Full-width bands matching renderCanvasForDevice()'s layout
+   */
+  getFrameBands() {
+    const { width, height, scale } = this.deviceConfig;
+    const summaryY = scale.header.height + 2;
+    const legsY = summaryY + scale.summary.height + 6;
+    const footerY = height - scale.footer.height;
+    return [
+      { id: 'header', x: 0, y: 0, w: width, h: summaryY },
+      { id: 'summary', x: 0, y: summaryY, w: width, h: legsY - summaryY },
+      { id: 'legs', x: 0, y: legsY, w: width, h: footerY - legsY },
+      { id: 'footer', x: 0, y: footerY, w: width, h: scale.footer.height }
+    ];
+  }
+
+  /**
+   * Draw the dashboard onto a device-sized canvas
+   */
+  renderCanvasForDevice(data) {
     const { width, height, scale } = this.deviceConfig;
     
     const canvas = createCanvas(width, height);
@@ -268,7 +312,7 @@ export class LiveDash {
     // Footer (at bottom)
     this.renderFooter(ctx, data, height - scale.footer.height, scale.footer);
     
-    return canvas.toBuffer('image/png');
+    return canvas;
   }
 
   /**
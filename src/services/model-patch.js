@@ -0,0 +1,341 @@
+/**
+ * Data-Model Delta Patches
+ * Part of the Commute Compute System™
+ *
+ * For devices that draw the dashboard themselves (CCFirm built with
+ * CC_LOCAL_RENDER, include/dash-model.h) instead of loading a BMP. Most
+ * minutes only the clock, one departure or the coffee decision changes, so
+ * rather than the whole data model the server sends field ops against the
+ * model the device last acknowledged:
+ *
+ *   u8 version=1, u8 kind (0 full, 1 patch), u16le base, u16le version,
+ *   u8 opCount, u8 flags=0,
+ *   ops: u8 op, u8 field, value
+ *        1 SET_STR  u8 len, bytes (printable ASCII)
+ *        2 SET_U16  u16le
+ *        3 CLEAR    -            (back to "" / 0)
+ *   u32le check - FNV-1a of the whole resulting model (modelCheck())
+ *
+ * A full model is the same ops applied to an empty model. The device
+ * applies a patch only if it holds exactly `base`, and keeps the result
+ * only if the check matches; otherwise it asks again with version 0 and
+ * gets a full model.
+ *
+ * Acknowledgement is implicit: each request carries the version the device
+ * holds (?mv=). Per device the server keeps the acknowledged model and the
+ * one last sent (pending); a request naming the pending version promotes
+ * it. A lost response therefore costs nothing - the device still names
+ * the acknowledged version and gets a patch from it again.
+ *
+ * Fields mirror buildDashboardData() in device-frame.js; each belongs to
+ * one screen region so the device only redraws what changed. Keep
+ * MODEL_FIELDS in step with DASHMODEL_FIELDS in the firmware.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+import { fnv1a32 } from './timetable-slice.js';
+import { getCachedValue, setCachedValue } from '../data/kv-preferences.js';
+
+export const MODEL_FORMAT_VERSION = 1;
+export const MODEL_KIND = { FULL: 0, PATCH: 1 };
+export const MODEL_OP = { SET_STR: 1, SET_U16: 2, CLEAR: 3 };
+export const MODEL_HEADER_BYTES = 8;
+export const MODEL_MAX_LEGS = 6;
+export const MODEL_VERSION_HEADER = 'X-Model-Version';
+export const MODEL_NO_LEAVE_IN = 0xFFFF;
+
+const STATE_TTL_SECONDS = 24 * 3600;
+const MAX_MEMORY_STATES = 500;
+
+/**
+ * Field table: id, key, type, max bytes (strings). Leg fields are
+ * 0x20 + 8 * leg + offset.
+ */
+const SCALAR_FIELDS = [
+  { id: 1, key: 'location', type: 'str', max: 40 },
+  { id: 2, key: 'current_time', type: 'str', max: 7 },
+  { id: 3, key: 'day', type: 'str', max: 11 },
+  { id: 4, key: 'date', type: 'str', max: 11 },
+  { id: 5, key: 'temp', type: 'str', max: 7 },
+  { id: 6, key: 'condition', type: 'str', max: 23 },
+  { id: 7, key: 'umbrella', type: 'u16' },
+  { id: 8, key: 'status_type', type: 'str', max: 15 },
+  { id: 9, key: 'arrive_by', type: 'str', max: 7 },
+  { id: 10, key: 'total_minutes', type: 'u16' },
+  { id: 11, key: 'leave_in_minutes', type: 'u16' },
+  { id: 12, key: 'destination', type: 'str', max: 40 },
+  { id: 13, key: 'leg_count', type: 'u16' }
+];
+
+const LEG_FIELDS = [
+  { offset: 0, key: 'type', type: 'str', max: 11 },
+  { offset: 1, key: 'title', type: 'str', max: 40 },
+  { offset: 2, key: 'subtitle', type: 'str', max: 40 },
+  { offset: 3, key: 'minutes', type: 'u16' },
+  { offset: 4, key: 'state', type: 'str', max: 11 },
+  { offset: 5, key: 'can_get', type: 'u16' }         // 0 no, 1 yes, 2 not a coffee leg
+];
+
+export const MODEL_FIELDS = [
+  ...SCALAR_FIELDS,
+  ...Array.from({ length: MODEL_MAX_LEGS }, (_, leg) => LEG_FIELDS.map(f => ({
+    id: 0x20 + 8 * leg + f.offset,
+    key: `leg${leg}.${f.key}`,
+    type: f.type,
+    max: f.max
+  }))).flat()
+];
+
+const FIELD_BY_ID = new Map(MODEL_FIELDS.map(f => [f.id, f]));
+
+// Per-instance state (survives between invocations on a warm instance)
+const memoryStates = new Map();       // deviceId -> { acked, pending }
+
+const stats = {
+  requests: 0,
+  full: 0,
+  patches: 0,
+  unchanged: 0,
+  bytesSent: 0,
+  fullBytesAvoided: 0
+};
+
+function cleanString(value, max) {
+  const text = String(value ?? '').replace(/[^\x20-\x7e]/g, '?');
+  return Buffer.from(text, 'latin1').subarray(0, max).toString('latin1');
+}
+
+function clampU16(value) {
+  const n = Math.round(Number(value));
+  return Number.isFinite(n) ? Math.min(Math.max(n, 0), 0xFFFF) : 0;
+}
+
+/**
+ * Device data model (field key -> value) from buildDashboardData() output
+ * @returns {object}
+ */
+export function modelFromDashboard(data) {
+  const legs = (data.journey_legs || data.legs || []).slice(0, MODEL_MAX_LEGS);
+  const source = {
+    ...data,
+    temp: data.temp ?? '--',
+    umbrella: data.umbrella ? 1 : 0,
+    leave_in_minutes: data.leave_in_minutes == null ? MODEL_NO_LEAVE_IN : data.leave_in_minutes,
+    leg_count: legs.length
+  };
+  legs.forEach((leg, i) => {
+    source[`leg${i}.type`] = leg.type;
+    source[`leg${i}.title`] = leg.title;
+    source[`leg${i}.subtitle`] = leg.subtitle;
+    source[`leg${i}.minutes`] = leg.minutes;
+    source[`leg${i}.state`] = leg.state || 'normal';
+    source[`leg${i}.can_get`] = leg.canGet === undefined ? 2 : (leg.canGet ? 1 : 0);
+  });
+
+  const model = {};
+  for (const field of MODEL_FIELDS) {
+    const value = source[field.key];
+    model[field.key] = field.type === 'str' ? cleanString(value, field.max) : clampU16(value ?? 0);
+  }
+  return model;
+}
+
+export function emptyModel() {
+  const model = {};
+  for (const field of MODEL_FIELDS) model[field.key] = field.type === 'str' ? '' : 0;
+  return model;
+}
+
+/**
+ * FNV-1a over every field in table order: id, then u8 length + bytes for
+ * strings or u16le for numbers (dashmodel_check() in the firmware)
+ */
+export function modelCheck(model) {
+  const parts = [];
+  for (const field of MODEL_FIELDS) {
+    if (field.type === 'str') {
+      const bytes = Buffer.from(model[field.key] || '', 'latin1');
+      parts.push(Buffer.from([field.id, bytes.length]), bytes);
+    } else {
+      const v = model[field.key] || 0;
+      parts.push(Buffer.from([field.id, v & 0xFF, v >> 8]));
+    }
+  }
+  return fnv1a32(Buffer.concat(parts));
+}
+
+/**
+ * Ops turning `from` into `to`, one Buffer each
+ * @returns {Buffer[]}
+ */
+function diffOps(from, to) {
+  const ops = [];
+  for (const field of MODEL_FIELDS) {
+    const value = to[field.key];
+    if (value === from[field.key]) continue;
+    if (value === '' || value === 0) {
+      ops.push(Buffer.from([MODEL_OP.CLEAR, field.id]));
+    } else if (field.type === 'str') {
+      const bytes = Buffer.from(value, 'latin1');
+      ops.push(Buffer.concat([Buffer.from([MODEL_OP.SET_STR, field.id, bytes.length]), bytes]));
+    } else {
+      ops.push(Buffer.from([MODEL_OP.SET_U16, field.id, value & 0xFF, value >> 8]));
+    }
+  }
+  return ops;
+}
+
+/**
+ * Encode a full model (base null) or a patch from base
+ * @param {object|null} base - Model the device holds
+ * @param {object} model - Model to send
+ * @param {{base: number, version: number}} versions
+ * @returns {Buffer}
+ */
+export function encodeModelPatch(base, model, { base: baseVersion = 0, version }) {
+  const ops = diffOps(base || emptyModel(), model);
+  const header = Buffer.alloc(MODEL_HEADER_BYTES);
+  header.writeUInt8(MODEL_FORMAT_VERSION, 0);
+  header.writeUInt8(base ? MODEL_KIND.PATCH : MODEL_KIND.FULL, 1);
+  header.writeUInt16LE(base ? baseVersion : 0, 2);
+  header.writeUInt16LE(version, 4);
+  header.writeUInt8(ops.length, 6);
+  const check = Buffer.alloc(4);
+  check.writeUInt32LE(modelCheck(model), 0);
+  return Buffer.concat([header, ...ops, check]);
+}
+
+/**
+ * Apply an encoded full model or patch (tests, tools; the device uses
+ * dashmodel_apply())
+ * @param {object|null} current - Model held, with its version
+ * @param {number} currentVersion
+ * @returns {{model: object, version: number, changed: string[]}|null} null if
+ *   the base does not match or the result fails its check
+ */
+export function applyModelPatch(current, currentVersion, buf) {
+  if (buf.length < MODEL_HEADER_BYTES + 4 || buf[0] !== MODEL_FORMAT_VERSION) return null;
+  const kind = buf[1];
+  if (kind === MODEL_KIND.PATCH && (!current || buf.readUInt16LE(2) !== currentVersion)) return null;
+  const model = kind === MODEL_KIND.FULL ? emptyModel() : { ...current };
+  const changed = [];
+  let o = MODEL_HEADER_BYTES;
+  const end = buf.length - 4;
+  for (let i = 0; i < buf[6]; i++) {
+    if (o + 2 > end) return null;
+    const op = buf[o];
+    const field = FIELD_BY_ID.get(buf[o + 1]);
+    o += 2;
+    if (!field) return null;
+    let value;
+    if (op === MODEL_OP.SET_STR && field.type === 'str') {
+      const len = buf[o];
+      if (o + 1 + len > end || len > field.max) return null;
+      value = buf.toString('latin1', o + 1, o + 1 + len);
+      o += 1 + len;
+    } else if (op === MODEL_OP.SET_U16 && field.type === 'u16') {
+      if (o + 2 > end) return null;
+      value = buf.readUInt16LE(o);
+      o += 2;
+    } else if (op === MODEL_OP.CLEAR) {
+      value = field.type === 'str' ? '' : 0;
+    } else {
+      return null;
+    }
+    model[field.key] = value;
+    changed.push(field.key);
+  }
+  if (o !== end || buf.readUInt32LE(end) !== modelCheck(model)) return null;
+  return { model, version: buf.readUInt16LE(4), changed };
+}
+
+/** Next version after v (never 0 - that means "holds nothing") */
+export function nextModelVersion(v) {
+  return (v % 0xFFFF) + 1;
+}
+
+function sameModel(a, b) {
+  return MODEL_FIELDS.every(f => a[f.key] === b[f.key]);
+}
+
+function stateKey(deviceId) {
+  return `cc:model:${deviceId}`;
+}
+
+async function loadState(deviceId) {
+  return memoryStates.get(deviceId) || (await getCachedValue(stateKey(deviceId))) || { acked: null, pending: null };
+}
+
+/**
+ * This instance holds the state on return; the promise settles once it is
+ * shared through KV, which the response need not wait for.
+ */
+function storeState(deviceId, state) {
+  memoryStates.delete(deviceId);
+  memoryStates.set(deviceId, state);
+  while (memoryStates.size > MAX_MEMORY_STATES) {
+    memoryStates.delete(memoryStates.keys().next().value);
+  }
+  return setCachedValue(stateKey(deviceId), state, STATE_TTL_SECONDS);
+}
+
+/**
+ * Body for one ?format=model request
+ * @param {string} deviceId - deviceIdForToken() of the config token
+ * @param {number} have - Model version the device holds (0 = none)
+ * @param {object} data - buildDashboardData() output for now
+ * @returns {Promise<{body: Buffer, version: number, kind: number, ops: number}>}
+ */
+export async function answerModelRequest(deviceId, have, data) {
+  stats.requests++;
+  const state = await loadState(deviceId);
+  if (state.pending && have === state.pending.version) {
+    state.acked = state.pending;
+    state.pending = null;
+  }
+  const base = have && state.acked && have === state.acked.version ? state.acked : null;
+  const model = modelFromDashboard(data);
+
+  let body;
+  let version;
+  if (base && sameModel(base.model, model)) {
+    // Nothing to draw: an empty patch that keeps the version
+    version = base.version;
+    body = encodeModelPatch(base.model, model, { base: base.version, version });
+    stats.unchanged++;
+  } else {
+    version = nextModelVersion(Math.max(state.acked?.version || 0, state.pending?.version || 0));
+    body = encodeModelPatch(base?.model || null, model, { base: base?.version || 0, version });
+    state.pending = { version, model };
+    if (base) stats.patches++; else stats.full++;
+  }
+  storeState(deviceId, state)
+    .catch(error => console.error(`[model] Could not share state: ${error.message}`));
+
+  stats.bytesSent += body.length;
+  if (base) stats.fullBytesAvoided += encodeModelPatch(null, model, { version }).length - body.length;
+  return { body, version, kind: body[1], ops: body[6] };
+}
+
+export function getModelPatchStats() {
+  return { ...stats, devices: memoryStates.size };
+}
+
+export default {
+  MODEL_FORMAT_VERSION,
+  MODEL_KIND,
+  MODEL_OP,
+  MODEL_FIELDS,
+  MODEL_MAX_LEGS,
+  modelFromDashboard,
+  emptyModel,
+  modelCheck,
+  encodeModelPatch,
+  applyModelPatch,
+  nextModelVersion,
+  answerModelRequest,
+  getModelPatchStats
+};
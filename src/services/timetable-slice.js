@@ -0,0 +1,278 @@
+/**
+ * Offline Timetable Slice Encoder
+ * Part of the Commute Compute System™
+ *
+ * Packs the next few hours of scheduled departures for each journey leg into
+ * a compact binary blob that is sent alongside every full-screen BMP in the
+ * X-Timetable-Slice header. CCFirm keeps the latest slice in RTC memory and
+ * flash, and when fetches fail it advances the journey locally from its SNTP
+ * clock, rendering the result as SCHEDULED (not live) data.
+ *
+ * Binary layout (little-endian, see firmware/include/timetable-slice.h):
+ *
+ *   off  size  field
+ *   0    4     magic "CCTS"
+ *   4    1     version (1)
+ *   5    1     flags (bit0 = built from live data, bit1 = projected entries)
+ *   6    1     leg count
+ *   7    1     reserved (0)
+ *   8    4     generatedAt (unix seconds, UTC)
+ *   12   2     horizon (minutes)
+ *   14   2     UTC offset of the user's timezone (signed minutes)
+ *   16   2     arrive-by target (minutes after local midnight, 0xFFFF = none)
+ *   18   2     reserved (0)
+ *   20   ...   legs: type u8, minutes u8, depCount u8, labelLen u8,
+ *              label bytes, then depCount × u16 departure offsets
+ *              (minutes after generatedAt)
+ *   n-4  4     FNV-1a 32-bit checksum of every preceding byte
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+export const SLICE_MAGIC = 'CCTS';
+export const SLICE_VERSION = 1;
+export const SLICE_HEADER = 'X-Timetable-Slice';
+
+export const SLICE_FLAG_LIVE = 0x01;
+export const SLICE_FLAG_PROJECTED = 0x02;
+
+// Limits mirror the firmware decoder (timetable-slice.h)
+export const SLICE_MAX_LEGS = 6;
+export const SLICE_MAX_DEPARTURES = 32;
+export const SLICE_MAX_LABEL = 20;
+export const SLICE_DEFAULT_HORIZON = 180;   // 3 hours
+export const SLICE_MAX_HORIZON = 240;       // 4 hours
+
+const HEADER_SIZE = 20;
+const NO_ARRIVE_BY = 0xFFFF;
+
+// Leg type codes shared with firmware
+export const SLICE_LEG_TYPES = {
+  walk: 0,
+  train: 1,
+  tram: 2,
+  bus: 3,
+  coffee: 4,
+  ferry: 5,
+  vline: 6
+};
+
+// Default headways (minutes) when live data has too few departures to infer one
+const DEFAULT_HEADWAY = {
+  train: 10,
+  tram: 8,
+  bus: 15,
+  ferry: 20,
+  vline: 30
+};
+
+/**
+ * FNV-1a 32-bit hash (matches slice_fnv1a() in firmware)
+ */
+export function fnv1a32(bytes, length = bytes.length) {
+  let hash = 0x811c9dc5;
+  for (let i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash = Math.imul(hash, 0x01000193) >>> 0;
+  }
+  return hash >>> 0;
+}
+
+/**
+ * Offset (minutes) of a timezone from UTC at a given instant
+ */
+export function getUtcOffsetMinutes(timeZone = 'Australia/Melbourne', date = new Date()) {
+  const parts = new Intl.DateTimeFormat('en-US', {
+    timeZone,
+    hourCycle: 'h23',
+    year: 'numeric', month: '2-digit', day: '2-digit',
+    hour: '2-digit', minute: '2-digit', second: '2-digit'
+  }).formatToParts(date);
+  const get = (type) => Number(parts.find(p => p.type === type)?.value || 0);
+  const asUtc = Date.UTC(get('year'), get('month') - 1, get('day'), get('hour'), get('minute'), get('second'));
+  return Math.round((asUtc - date.getTime()) / 60000);
+}
+
+/**
+ * Departures for a leg's mode from transit data
+ */
+function departuresForLeg(leg, transitData) {
+  switch (leg.type) {
+    case 'train':
+    case 'vline':
+      return transitData?.trains || [];
+    case 'tram':
+      return transitData?.trams || [];
+    case 'bus':
+      return transitData?.buses || [];
+    default:
+      return [];
+  }
+}
+
+/**
+ * Minutes after generation for each known departure, sorted and de-duplicated
+ */
+function knownOffsets(departures, generatedAtMs) {
+  const offsets = [];
+  for (const dep of departures) {
+    let mins = null;
+    if (Number.isFinite(dep?.departureTimeMs)) {
+      mins = Math.round((dep.departureTimeMs - generatedAtMs) / 60000);
+    } else if (Number.isFinite(dep?.minutes)) {
+      mins = Math.round(dep.minutes);
+    }
+    if (mins !== null && mins >= 0) offsets.push(mins);
+  }
+  return [...new Set(offsets)].sort((a, b) => a - b);
+}
+
+/**
+ * Extend known departures to the horizon using the observed (median) headway.
+ * Live feeds only carry the next few services; beyond that the timetable is
+ * regular enough that a projected headway is what the device would show anyway.
+ */
+function projectDepartures(leg, offsets, horizon) {
+  const gaps = [];
+  for (let i = 1; i < offsets.length; i++) {
+    const gap = offsets[i] - offsets[i - 1];
+    if (gap > 0) gaps.push(gap);
+  }
+  gaps.sort((a, b) => a - b);
+  const headway = gaps.length > 0
+    ? Math.max(2, gaps[Math.floor(gaps.length / 2)])
+    : (DEFAULT_HEADWAY[leg.type] || 15);
+
+  const result = offsets.filter(m => m <= horizon);
+  let projected = false;
+  let next = result.length > 0 ? result[result.length - 1] + headway : (offsets[0] ?? headway);
+  while (next <= horizon && result.length < SLICE_MAX_DEPARTURES) {
+    result.push(next);
+    next += headway;
+    projected = true;
+  }
+  return { departures: result.slice(0, SLICE_MAX_DEPARTURES), projected };
+}
+
+/**
+ * Short ASCII label for the e-ink FONT_8x8 renderer
+ */
+function legLabel(leg) {
+  const text = String(leg.title || leg.type || '')
+    .normalize('NFKD')
+    .replace(/[^\x20-\x7E]/g, '')
+    .trim();
+  return text.slice(0, SLICE_MAX_LABEL);
+}
+
+/**
+ * Parse "HH:MM" into minutes after midnight
+ */
+function parseArriveBy(value) {
+  if (typeof value !== 'string') return NO_ARRIVE_BY;
+  const match = value.match(/^(\d{1,2}):(\d{2})/);
+  if (!match) return NO_ARRIVE_BY;
+  const mins = Number(match[1]) * 60 + Number(match[2]);
+  return mins < 24 * 60 ? mins : NO_ARRIVE_BY;
+}
+
+/**
+ * Build the binary timetable slice
+ *
+ * @param {object} options
+ * @param {Array} options.legs - Journey legs (dashboard data model journey_legs)
+ * @param {object} options.transitData - { trains, trams, buses } departures
+ * @param {Date} [options.generatedAt] - Instant the slice is valid from
+ * @param {string} [options.timeZone] - IANA timezone of the user
+ * @param {string} [options.arriveBy] - Target arrival "HH:MM"
+ * @param {boolean} [options.live] - Whether transitData came from a live feed
+ * @param {number} [options.horizonMinutes] - How far ahead to cover (max 4h)
+ * @returns {Buffer}
+ */
+export function buildTimetableSlice({
+  legs = [],
+  transitData = {},
+  generatedAt = new Date(),
+  timeZone = 'Australia/Melbourne',
+  arriveBy = null,
+  live = false,
+  horizonMinutes = SLICE_DEFAULT_HORIZON
+} = {}) {
+  const horizon = Math.max(1, Math.min(SLICE_MAX_HORIZON, Math.round(horizonMinutes)));
+  const generatedAtMs = generatedAt.getTime();
+  const activeLegs = legs.filter(l => l && l.state !== 'skip').slice(0, SLICE_MAX_LEGS);
+
+  let flags = live ? SLICE_FLAG_LIVE : 0;
+  const encodedLegs = activeLegs.map(leg => {
+    const isTransit = ['train', 'tram', 'bus', 'ferry', 'vline'].includes(leg.type);
+    let departures = [];
+    if (isTransit) {
+      const offsets = knownOffsets(departuresForLeg(leg, transitData), generatedAtMs);
+      const result = projectDepartures(leg, offsets, horizon);
+      departures = result.departures;
+      if (result.projected) flags |= SLICE_FLAG_PROJECTED;
+    }
+    return {
+      type: SLICE_LEG_TYPES[leg.type] ?? SLICE_LEG_TYPES.walk,
+      minutes: Math.max(0, Math.min(255, Math.round(leg.minutes || 0))),
+      label: Buffer.from(legLabel(leg), 'ascii'),
+      departures
+    };
+  });
+
+  const size = HEADER_SIZE + 4 + encodedLegs.reduce(
+    (total, l) => total + 4 + l.label.length + l.departures.length * 2, 0);
+  const buffer = Buffer.alloc(size);
+
+  buffer.write(SLICE_MAGIC, 0, 'ascii');
+  buffer.writeUInt8(SLICE_VERSION, 4);
+  buffer.writeUInt8(flags, 5);
+  buffer.writeUInt8(encodedLegs.length, 6);
+  buffer.writeUInt32LE(Math.floor(generatedAtMs / 1000), 8);
+  buffer.writeUInt16LE(horizon, 12);
+  buffer.writeInt16LE(getUtcOffsetMinutes(timeZone, generatedAt), 14);
+  buffer.writeUInt16LE(parseArriveBy(arriveBy), 16);
+
+  let offset = HEADER_SIZE;
+  for (const leg of encodedLegs) {
+    buffer.writeUInt8(leg.type, offset++);
+    buffer.writeUInt8(leg.minutes, offset++);
+    buffer.writeUInt8(leg.departures.length, offset++);
+    buffer.writeUInt8(leg.label.length, offset++);
+    leg.label.copy(buffer, offset);
+    offset += leg.label.length;
+    for (const dep of leg.departures) {
+      buffer.writeUInt16LE(dep, offset);
+      offset += 2;
+    }
+  }
+
+  buffer.writeUInt32LE(fnv1a32(buffer, offset), offset);
+  return buffer;
+}
+
+/**
+ * Build the slice and attach it to a response as a base64 header.
+ * Never throws - a missing slice only disables offline mode on the device.
+ */
+export function attachTimetableSlice(res, options) {
+  try {
+    const slice = buildTimetableSlice(options);
+    res.setHeader(SLICE_HEADER, slice.toString('base64'));
+    return slice.length;
+  } catch (error) {
+    console.log(`[timetable-slice] Skipped: ${error.message}`);
+    return 0;
+  }
+}
+
+export default {
+  SLICE_HEADER,
+  SLICE_LEG_TYPES,
+  buildTimetableSlice,
+  attachTimetableSlice,
+  getUtcOffsetMinutes,
+  fnv1a32
+};
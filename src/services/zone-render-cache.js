@@ -0,0 +1,206 @@
+/**
+ * Zone Render Cache
+ * Part of the Commute Compute System™
+ *
+ * Most zone content is identical across devices: the same clock minute,
+ * the same weather, the same tram legs. ccdash-renderer.js keys each zone
+ * render by (zone id, geometry, hash of the inputs the zone reads, renderer
+ * version) and memoises the result here, so any device asking for the same
+ * zone content reuses the encoded payload instead of drawing a canvas.
+ *
+ * Tiers:
+ *   - Memory LRU, shared by every request on the instance (synchronous)
+ *   - KV, shared across instances: warmZoneCache() pulls entries in before
+ *     a render pass, flushZoneCache() publishes the ones rendered locally
+ *
+ * Each entry holds the zone in every device format; formats other than the
+ * raw BMP are encoded on first use and kept with the entry.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+import crypto from 'crypto';
+import { getCachedValue, setCachedValue } from '../data/kv-preferences.js';
+import { parseBMP1, encodeZoneFrame } from './frame-codec.js';
+
+export const ZONE_FORMATS = ['bmp', 'base64', 'cczf'];
+
+const MAX_MEMORY_ENTRIES = 512;
+const ZONE_TTL_SECONDS = 600;
+
+// Per-instance state (survives between invocations on a warm instance)
+const entries = new Map();                      // key -> { zoneId, geometry, bmp, base64?, cczf?, fromKv? }
+const pendingShare = new Set();                 // keys rendered here, not yet in KV
+
+const stats = {
+  hits: 0,
+  kvHits: 0,
+  misses: 0,
+  renderMsTotal: 0,
+  evictions: 0,
+  byZone: {}                                    // zoneId -> { hits, misses }
+};
+
+/**
+ * Cache key for one zone render
+ * @param {string} zoneId
+ * @param {{x: number, y: number, w: number, h: number}} geometry
+ * @param {any} inputs - Everything the zone renderer reads (JSON-serialisable)
+ * @param {string} version - Renderer version; bump it when drawing code changes
+ */
+export function zoneRenderKey(zoneId, geometry, inputs, version) {
+  const hash = crypto.createHash('sha1').update(JSON.stringify(inputs ?? null)).digest('hex').slice(0, 20);
+  const { x = 0, y = 0, w = 0, h = 0 } = geometry || {};
+  return `cc:zone:${version}:${zoneId}:${x},${y},${w}x${h}:${hash}`;
+}
+
+function count(zoneId, field) {
+  const zone = stats.byZone[zoneId] || (stats.byZone[zoneId] = { hits: 0, misses: 0 });
+  zone[field]++;
+}
+
+function remember(key, entry) {
+  entries.delete(key);
+  entries.set(key, entry);
+  while (entries.size > MAX_MEMORY_ENTRIES) {
+    const oldest = entries.keys().next().value;
+    entries.delete(oldest);
+    pendingShare.delete(oldest);
+    stats.evictions++;
+  }
+}
+
+/**
+ * Memoised zone render
+ * @param {string} key - From zoneRenderKey()
+ * @param {string} zoneId
+ * @param {object} geometry - Zone placement (used for CCZF headers)
+ * @param {function(): Buffer|null} render - Draws the zone; null results are not cached
+ * @returns {object|null} Cache entry ({ bmp, ... }) or null if the render failed
+ */
+export function memoiseZone(key, zoneId, geometry, render) {
+  const cached = entries.get(key);
+  if (cached) {
+    // Refresh LRU position
+    entries.delete(key);
+    entries.set(key, cached);
+    if (cached.fromKv) {
+      // First use of an entry another instance rendered
+      cached.fromKv = false;
+      stats.kvHits++;
+    } else {
+      stats.hits++;
+    }
+    count(zoneId, 'hits');
+    return cached;
+  }
+
+  stats.misses++;
+  count(zoneId, 'misses');
+  const started = Date.now();
+  const bmp = render();
+  stats.renderMsTotal += Date.now() - started;
+  if (!bmp) return null;
+
+  const entry = { zoneId, geometry, bmp };
+  remember(key, entry);
+  pendingShare.add(key);
+  return entry;
+}
+
+/**
+ * Zone payload in the requested device format, encoded once per entry
+ * @param {object} entry - From memoiseZone()
+ * @param {'bmp'|'base64'|'cczf'} format
+ */
+export function getZonePayload(entry, format = 'bmp') {
+  if (!entry) return null;
+  switch (format) {
+    case 'bmp':
+      return entry.bmp;
+    case 'base64':
+      return entry.base64 ??= entry.bmp.toString('base64');
+    case 'cczf':
+      return entry.cczf ??= encodeZoneFrame(entry.geometry, parseBMP1(entry.bmp).pixels);
+    default:
+      throw new Error(`Unknown zone format: ${format}`);
+  }
+}
+
+/**
+ * Load the wanted entries that are not in memory from KV
+ * @param {Array<{key: string, zoneId: string, geometry: object}>} wanted
+ * @returns {Promise<number>} Entries loaded
+ */
+export async function warmZoneCache(wanted) {
+  const missing = wanted.filter(({ key }) => !entries.has(key));
+  if (missing.length === 0) return 0;
+
+  const loaded = await Promise.all(missing.map(async ({ key, zoneId, geometry }) => {
+    const shared = await getCachedValue(key);
+    if (!shared?.bmp) return 0;
+    remember(key, { zoneId, geometry, bmp: Buffer.from(shared.bmp, 'base64'), base64: shared.bmp, fromKv: true });
+    return 1;
+  }));
+  return loaded.reduce((a, b) => a + b, 0);
+}
+
+/**
+ * Publish zones rendered on this instance to KV
+ * @returns {Promise<number>} Entries written
+ */
+export async function flushZoneCache() {
+  const keys = [...pendingShare];
+  pendingShare.clear();
+  const written = await Promise.all(keys.map(async key => {
+    const entry = entries.get(key);
+    if (!entry) return 0;
+    return (await setCachedValue(key, { bmp: getZonePayload(entry, 'base64') }, ZONE_TTL_SECONDS)) ? 1 : 0;
+  }));
+  return written.reduce((a, b) => a + b, 0);
+}
+
+/**
+ * Drop every memoised render (keys already include the renderer version,
+ * so this is only needed to reclaim memory)
+ */
+export function purgeZoneCache() {
+  entries.clear();
+  pendingShare.clear();
+}
+
+export function getZoneCacheStats() {
+  const lookups = stats.hits + stats.kvHits + stats.misses;
+  let bytes = 0;
+  for (const entry of entries.values()) bytes += entry.bmp.length;
+
+  const byZone = {};
+  for (const [zoneId, { hits, misses }] of Object.entries(stats.byZone)) {
+    byZone[zoneId] = { hits, misses, hitRate: hits + misses ? +(hits / (hits + misses)).toFixed(3) : 0 };
+  }
+
+  return {
+    hits: stats.hits,
+    kvHits: stats.kvHits,
+    misses: stats.misses,
+    hitRate: lookups ? +((stats.hits + stats.kvHits) / lookups).toFixed(3) : 0,
+    avgRenderMs: stats.misses ? +(stats.renderMsTotal / stats.misses).toFixed(1) : 0,
+    evictions: stats.evictions,
+    entries: entries.size,
+    bytes,
+    byZone
+  };
+}
+
+export default {
+  ZONE_FORMATS,
+  zoneRenderKey,
+  memoiseZone,
+  getZonePayload,
+  warmZoneCache,
+  flushZoneCache,
+  purgeZoneCache,
+  getZoneCacheStats
+};
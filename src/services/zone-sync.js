@@ -0,0 +1,114 @@
+/**
+ * Conditional Zone Sync (X-Zone-Hashes)
+ * Part of the Commute Compute System™
+ *
+ * One round trip per refresh for zone firmware. The device sends the
+ * content hashes of the zones it is showing; the reply carries only the
+ * zones whose hash it does not have, as CCZF frames (frame-codec.js), plus
+ * the full new hash vector to remember for next time.
+ *
+ *   Request   X-Zone-Hashes: base64( u8 version=1, u32le hash × n )
+ *             (absent or empty = the device shows nothing: send every zone)
+ *   Response  200 application/x-cczf, body = changed zone frames (may be
+ *             empty), X-Zone-Hashes = hashes of every active zone,
+ *             X-Zones-Changed = frame count
+ *
+ * A zone's hash is the first 32 bits of SHA-1 over its render key, which
+ * already covers zone id, geometry, drawn inputs and renderer version, so
+ * the server keeps no per-device state. Decoder: firmware/include/zone-sync.h
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * Commercial licensing: commutecompute.licensing@gmail.com
+ */
+
+import crypto from 'crypto';
+
+export const ZONE_HASH_HEADER = 'X-Zone-Hashes';
+export const ZONE_HASH_VERSION = 1;
+export const ZONE_HASH_MAX = 16;
+export const ZONE_DELTA_TYPE = 'application/x-cczf';
+
+/**
+ * 32-bit content hash of a zone render key
+ * @param {string} renderKey - From getZoneRenderKey()
+ */
+export function zoneContentHash(renderKey) {
+  return crypto.createHash('sha1').update(renderKey).digest().readUInt32LE(0);
+}
+
+/**
+ * Encode a hash vector for the X-Zone-Hashes header
+ * @param {number[]} hashes
+ */
+export function encodeZoneHashes(hashes) {
+  const list = hashes.slice(0, ZONE_HASH_MAX);
+  const buf = Buffer.alloc(1 + 4 * list.length);
+  buf.writeUInt8(ZONE_HASH_VERSION, 0);
+  list.forEach((h, i) => buf.writeUInt32LE(h >>> 0, 1 + 4 * i));
+  return buf.toString('base64');
+}
+
+/**
+ * Parse an X-Zone-Hashes header. Anything malformed counts as "no zones
+ * shown" so the device gets a full set rather than an error.
+ * @param {string|undefined} value
+ * @returns {Set<number>}
+ */
+export function parseZoneHashes(value) {
+  const hashes = new Set();
+  if (typeof value !== 'string' || value.length === 0) return hashes;
+  const buf = Buffer.from(value, 'base64');
+  if (buf.length < 1 || buf[0] !== ZONE_HASH_VERSION || (buf.length - 1) % 4 !== 0) return hashes;
+  const count = Math.min((buf.length - 1) / 4, ZONE_HASH_MAX);
+  for (let i = 0; i < count; i++) hashes.add(buf.readUInt32LE(1 + 4 * i));
+  return hashes;
+}
+
+/**
+ * True if the request negotiated the delta format
+ */
+export function wantsZoneDelta(req) {
+  const accept = req.headers?.accept || '';
+  return req.query?.format === 'cczf' || accept.includes(ZONE_DELTA_TYPE) ||
+    req.headers?.[ZONE_HASH_HEADER.toLowerCase()] !== undefined;
+}
+
+/**
+ * Pick the zones the device is missing
+ * @param {Array<{id: string, hash: number}>} zones - Active zones with content hashes
+ * @param {Set<number>} deviceHashes - From parseZoneHashes()
+ * @param {boolean} [forceAll]
+ * @returns {string[]} Zone ids to send
+ */
+export function selectChangedZones(zones, deviceHashes, forceAll = false) {
+  return zones.filter(z => forceAll || !deviceHashes.has(z.hash)).map(z => z.id);
+}
+
+/**
+ * Write a delta from renderZoneDelta() (ccdash-renderer.js)
+ * @param {object} res
+ * @param {{frames: Buffer[], hashes: number[], changed: string[]}} delta
+ */
+export function sendZoneDelta(res, delta) {
+  const body = Buffer.concat(delta.frames);
+  res.setHeader('Content-Type', ZONE_DELTA_TYPE);
+  res.setHeader('Content-Length', body.length);
+  res.setHeader('Cache-Control', 'no-cache, no-store, must-revalidate');
+  res.setHeader(ZONE_HASH_HEADER, encodeZoneHashes(delta.hashes));
+  res.setHeader('X-Zones-Changed', String(delta.changed.length));
+  return res.status(200).send(body);
+}
+
+export default {
+  ZONE_HASH_HEADER,
+  ZONE_HASH_VERSION,
+  ZONE_HASH_MAX,
+  ZONE_DELTA_TYPE,
+  zoneContentHash,
+  encodeZoneHashes,
+  parseZoneHashes,
+  wantsZoneDelta,
+  selectChangedZones,
+  sendZoneDelta
+};
@@ -0,0 +1,155 @@
+/**
+ * Device TLS Pre-Shared Keys
+ * Per-device TLS-PSK provisioning and a PSK-only HTTPS listener
+ *
+ * A full ECDHE + certificate handshake costs an ESP32-C3 seconds of CPU
+ * and radio on every fetch. Pairing already gives each device a private
+ * channel, so it also hands out a PSK identity and key; firmware that has
+ * them connects to a PSK endpoint with a plain PSK suite (no public-key
+ * operations on either side) and falls back to certificate TLS if that
+ * fails.
+ *
+ * Keys are derived, not stored: key = HMAC-SHA256(secret, identity), so
+ * any instance sharing the secret can answer a handshake without
+ * per-device state (pskCallback is synchronous, so a KV lookup would not
+ * fit anyway). The secret is PSK_SECRET, else WEBHOOK_SECRET. With neither
+ * set there is no PSK at all - pairing hands out no key and devices stay
+ * on verified TLS - because the fallback signing key in token-signing.js
+ * can be computed by anyone.
+ *
+ * Revoking: list identities in PSK_REVOKED (comma-separated); their
+ * handshakes and freshness queries are refused. An identity follows the
+ * config token (pskIdentityForUrl()), so re-pairing the same token does
+ * not lift it. Changing PSK_SECRET revokes every key at once (devices fall
+ * back to verified TLS until they are paired again).
+ *
+ * Endpoint:
+ *   PSK_PORT      - server.js also listens for TLS-PSK on this port and
+ *                   serves the same routes (local / Render deployments)
+ *   PSK_ENDPOINT  - base URL given to devices (required on Vercel, which
+ *                   cannot terminate TLS-PSK itself)
+ * With neither set, pairing hands out no endpoint and devices keep using
+ * certificate TLS.
+ *
+ * Copyright (c) 2026 Angus Bergman
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+import https from 'https';
+import { createHash, createHmac, randomBytes } from 'crypto';
+
+export const PSK_IDENTITY_PREFIX = 'cc1-';
+
+// mbedTLS on the ESP32 supports both; GCM first (one pass, no HMAC)
+export const PSK_CIPHERS = 'PSK-AES128-GCM-SHA256:PSK-AES128-CBC-SHA256';
+
+const IDENTITY_PATTERN = /^cc1-[0-9a-f]{16}$/;
+
+/**
+ * Secret PSKs are derived from, or null when none is configured
+ * @returns {string|null}
+ */
+export function getPskSecret() {
+  return process.env.PSK_SECRET || process.env.WEBHOOK_SECRET || null;
+}
+
+export function isPskEnabled() {
+  return getPskSecret() !== null;
+}
+
+function isRevoked(identity) {
+  return (process.env.PSK_REVOKED || '').split(',').some(id => id.trim() === identity);
+}
+
+/**
+ * New random PSK identity (sent in clear during the handshake)
+ * @returns {string}
+ */
+export function createPskIdentity() {
+  return PSK_IDENTITY_PREFIX + randomBytes(8).toString('hex');
+}
+
+/**
+ * PSK identity of a webhook URL's device: the prefix plus the device id
+ * the pre-renderer tracks it under (deviceIdForToken() in
+ * frame-prerender.js - first 8 bytes of SHA-256 of the config token), so
+ * a freshness query can only ask about the device its key belongs to.
+ * Random if the URL carries no token.
+ * @param {string} [webhookUrl]
+ * @returns {string}
+ */
+export function pskIdentityForUrl(webhookUrl) {
+  const token = /\/api\/device\/([^/?#]+)/.exec(webhookUrl || '')?.[1];
+  if (!token) return createPskIdentity();
+  return PSK_IDENTITY_PREFIX + createHash('sha256').update(token).digest('hex').slice(0, 16);
+}
+
+/**
+ * 32-byte PSK for an identity, or null if the identity is not one of ours,
+ * is revoked, or PSK is not configured
+ * @param {string} identity
+ * @returns {Buffer|null}
+ */
+export function derivePsk(identity) {
+  if (typeof identity !== 'string' || !IDENTITY_PATTERN.test(identity)) return null;
+  const secret = getPskSecret();
+  if (!secret || isRevoked(identity)) return null;
+  return createHmac('sha256', secret).update(`cc-psk:${identity}`).digest();
+}
+
+/**
+ * Base URL of the PSK endpoint devices should use, or null if none
+ * @param {object} [req] - Pairing request (host is reused with PSK_PORT)
+ */
+export function getPskEndpoint(req) {
+  if (process.env.PSK_ENDPOINT) return process.env.PSK_ENDPOINT.replace(/\/+$/, '');
+  const port = parseInt(process.env.PSK_PORT, 10);
+  const host = (req?.headers?.['x-forwarded-host'] || req?.headers?.host || '').split(':')[0];
+  if (!port || !host) return null;
+  return `https://${host}:${port}`;
+}
+
+/**
+ * Fields added to the paired response of /api/pair/{code} (none without a
+ * PSK secret, or when the device's identity is revoked - it pairs and
+ * stays on verified TLS)
+ * @param {object} [req]
+ * @param {string} [webhookUrl] - The URL being paired (pskIdentityForUrl())
+ * @returns {{pskIdentity?: string, psk?: string, pskEndpoint?: string}}
+ */
+export function provisionDevicePsk(req, webhookUrl) {
+  if (!isPskEnabled()) return {};
+  const pskIdentity = pskIdentityForUrl(webhookUrl);
+  const psk = derivePsk(pskIdentity);
+  if (!psk) return {};
+  const fields = { pskIdentity, psk: psk.toString('hex') };
+  const endpoint = getPskEndpoint(req);
+  if (endpoint) fields.pskEndpoint = endpoint;
+  return fields;
+}
+
+/**
+ * HTTPS server that only negotiates TLS 1.2 PSK suites
+ * @param {Function} handler - Request handler (e.g. the Express app)
+ */
+export function createPskServer(handler) {
+  return https.createServer({
+    pskCallback: (socket, identity) => derivePsk(identity),
+    ciphers: PSK_CIPHERS,
+    minVersion: 'TLSv1.2',
+    maxVersion: 'TLSv1.2'
+  }, handler);
+}
+
+export default {
+  PSK_IDENTITY_PREFIX,
+  PSK_CIPHERS,
+  getPskSecret,
+  isPskEnabled,
+  createPskIdentity,
+  pskIdentityForUrl,
+  derivePsk,
+  getPskEndpoint,
+  provisionDevicePsk,
+  createPskServer
+};
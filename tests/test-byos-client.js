@@ -0,0 +1,158 @@
+/**
+ * CommuteCompute System™
+ * Smart Transit Display for Australian Public Transport
+ *
+ * Copyright © 2025-2026 Angus Bergman
+ *
+ * This file is part of CommuteCompute.
+ *
+ * CommuteCompute is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CommuteCompute is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with CommuteCompute. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+/**
+ * TRMNL BYOS Client Protocol State
+ *
+ * The device side of /api/display (firmware/include/byos-client.h, via
+ * env:native-byos): reply parsing, when the image is fetched again, and
+ * how long the device sleeps after a good or a failed cycle.
+ *
+ * Usage:
+ *   node tests/test-byos-client.js
+ *
+ * The check is built from the current tree with $CXX/c++ for every run, or
+ * taken from $CC_BYOS_CHECK.
+ */
+
+import { execFileSync } from 'child_process';
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const ROOT = path.resolve(__dirname, '..');
+
+// byos-client.h
+const BYOS_OK = 0;
+const BYOS_ERR_JSON = -1;
+const BYOS_ERR_STATUS = -2;
+const BYOS_ERR_NO_IMAGE = -3;
+const BYOS_DEFAULT_REFRESH_S = 900;
+const BYOS_MIN_REFRESH_S = 5;
+const BYOS_MAX_REFRESH_S = 86400;
+const BYOS_MIN_SLEEP_S = 5;
+const BYOS_RETRY_BASE_S = 30;
+
+console.log('📟 Testing the TRMNL BYOS client\n');
+
+let failures = 0;
+function check(name, ok, detail = '') {
+  console.log(`   ${ok ? '✅' : '❌'} ${name}${detail ? ` (${detail})` : ''}`);
+  if (!ok) failures++;
+}
+
+function buildCheck() {
+  if (process.env.CC_BYOS_CHECK) return process.env.CC_BYOS_CHECK;
+  const out = path.join(os.tmpdir(), `cc-byos-check-${process.pid}${process.platform === 'win32' ? '.exe' : ''}`);
+  execFileSync(process.env.CXX || 'c++', [
+    '-std=gnu++17', '-O2',
+    '-I', path.join(ROOT, 'firmware/include'),
+    path.join(ROOT, 'firmware/src/byos-check.cpp'),
+    '-o', out
+  ], { stdio: 'inherit' });
+  return out;
+}
+
+const device = buildCheck();
+const run = (...args) => JSON.parse(execFileSync(device, args.map(String), { encoding: 'utf8' }).trim());
+const display = (reply, drawn) =>
+  run('--display', JSON.stringify(reply), ...(drawn ? ['--drawn', JSON.stringify(drawn)] : []));
+
+// =============================================================================
+// /api/display REPLY
+// =============================================================================
+
+console.log('byos_parse_display()');
+const reply = {
+  status: 0,
+  image_url: 'https://cc.example/api/device/abc/image.bmp',
+  filename: 'dash-1741',
+  refresh_rate: 600,
+  update_firmware: false,
+  reset_firmware: false
+};
+
+let res = display(reply);
+check('good reply parses', res.rc === BYOS_OK && res.imageUrl === reply.image_url &&
+  res.filename === reply.filename && res.refreshRateS === 600);
+check('refresh_rate as a string', display({ ...reply, refresh_rate: '900' }).refreshRateS === 900);
+check('refresh_rate as a number', display({ ...reply, refresh_rate: 1800 }).refreshRateS === 1800);
+check('no refresh_rate: default', display({ ...reply, refresh_rate: undefined }).refreshRateS === BYOS_DEFAULT_REFRESH_S);
+check('refresh_rate 0 clamped up', display({ ...reply, refresh_rate: 0 }).refreshRateS === BYOS_MIN_REFRESH_S);
+check('refresh_rate a week clamped down', display({ ...reply, refresh_rate: 604800 }).refreshRateS === BYOS_MAX_REFRESH_S);
+
+res = display({ status: 500, refresh_rate: '120' });
+check('status != 0 is an error', res.rc === BYOS_ERR_STATUS && res.status === 500);
+check('error reply still sets refresh_rate', res.refreshRateS === 120);
+check('status 202 (not set up yet) is an error', display({ ...reply, status: 202 }).rc === BYOS_ERR_STATUS);
+
+check('missing image_url', display({ ...reply, image_url: undefined }).rc === BYOS_ERR_NO_IMAGE);
+check('empty image_url', display({ ...reply, image_url: '' }).rc === BYOS_ERR_NO_IMAGE);
+check('missing status', display({ ...reply, status: undefined }).rc === BYOS_ERR_JSON);
+check('not JSON', run('--display', '<html>502 Bad Gateway</html>').rc === BYOS_ERR_JSON);
+const flags = display({ ...reply, update_firmware: true, reset_firmware: true });
+check('update_firmware / reset_firmware read', flags.updateFirmware && flags.resetFirmware);
+check('no filename: key is image_url', display({ ...reply, filename: undefined }).key === reply.image_url);
+
+// =============================================================================
+// IMAGE CHANGE
+// =============================================================================
+
+console.log('\nbyos_image_changed()');
+const signed = sig => `https://usetrmnl.example/plugin-123.bmp?X-Amz-Signature=${sig}`;
+const hosted = { ...reply, image_url: signed('aaaa'), filename: 'plugin-123-1741' };
+
+check('nothing drawn: fetch', display(hosted).changed);
+check('same filename, re-signed image_url: keep', !display({ ...hosted, image_url: signed('bbbb') }, hosted).changed);
+check('new filename: fetch', display({ ...hosted, filename: 'plugin-123-1742' }, hosted).changed);
+const unnamed = { ...reply, filename: undefined };
+check('no filename, same image_url: keep', !display(unnamed, unnamed).changed);
+check('no filename, new image_url: fetch', display({ ...unnamed, image_url: signed('cccc') }, unnamed).changed);
+
+// =============================================================================
+// SLEEP AND RETRY
+// =============================================================================
+
+console.log('\nbyos_sleep_us()');
+check('awake time taken off the period', run('--sleep', 900, 4200).us === (900000 - 4200) * 1000);
+check('overrun sleeps the floor', run('--sleep', 30, 31000).us === BYOS_MIN_SLEEP_S * 1e6);
+check('inside the floor sleeps the floor', run('--sleep', 10, 6000).us === BYOS_MIN_SLEEP_S * 1e6);
+check('a 24 h refresh_rate does not overflow', run('--sleep', BYOS_MAX_REFRESH_S, 0).us === BYOS_MAX_REFRESH_S * 1e6);
+
+console.log('\nbyos_retry_s()');
+const retries = [1, 2, 3, 4, 5].map(streak => run('--retry', streak, 900).s);
+check('doubles from the base', retries.join() === [1, 2, 4, 8, 16].map(k => BYOS_RETRY_BASE_S * k).join(),
+  retries.join(', '));
+check('capped at refresh_rate', run('--retry', 6, 900).s === 900 && run('--retry', 60000, 900).s === 900);
+check('short refresh_rate caps the first retry', run('--retry', 1, 10).s === 10);
+
+if (!process.env.CC_BYOS_CHECK) fs.rmSync(device, { force: true });
+
+if (failures > 0) {
+  console.log(`\n❌ ${failures} checks failed`);
+  process.exit(1);
+}
+console.log('\n✅ All BYOS client checks passed');
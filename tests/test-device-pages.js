@@ -0,0 +1,177 @@
+/**
+ * CommuteCompute System™
+ * Smart Transit Display for Australian Public Transport
+ *
+ * Copyright © 2025-2026 Angus Bergman
+ *
+ * This file is part of CommuteCompute.
+ *
+ * CommuteCompute is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CommuteCompute is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with CommuteCompute. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+/**
+ * Device Pages: page table, page content and page frames
+ *
+ * Checks the X-Pages list the device parses, the return-journey config and
+ * the weather/alerts content, and that a page BMP becomes one full-screen
+ * CCZF frame that unpacks to the same pixels, with a hash that only moves
+ * when the pixels do (the device's 304 check). Prints frame sizes against
+ * the 48 KB BMP - what one page costs in the flash cache.
+ * Rendering itself needs canvas and is covered by the server's own runs.
+ *
+ * Usage:
+ *   node tests/test-device-pages.js
+ */
+
+import {
+  DEVICE_PAGES,
+  encodePageList,
+  parsePageList,
+  findPage,
+  returnJourneyConfig,
+  weatherPageContent,
+  alertsPageContent,
+  pageFrameFromBMP
+} from '../src/services/device-pages.js';
+import { parseBMP1, FRAME_HEADER_SIZE, FRAME_FLAG_REFRESH } from '../src/services/frame-codec.js';
+
+console.log('📄 Testing device pages\n');
+
+let failures = 0;
+function check(name, ok, detail = '') {
+  console.log(`   ${ok ? '✅' : '❌'} ${name}${detail ? ` (${detail})` : ''}`);
+  if (!ok) failures++;
+}
+
+// 1-bit BMP (bottom-up, palette 0 black / 1 white) with draw(x, y) -> black
+function makeBMP(width, height, draw) {
+  const stride = Math.ceil(width / 32) * 4;
+  const bmp = Buffer.alloc(62 + stride * height);
+  bmp.write('BM', 0, 'ascii');
+  bmp.writeUInt32LE(bmp.length, 2);
+  bmp.writeUInt32LE(62, 10);
+  bmp.writeUInt32LE(40, 14);
+  bmp.writeInt32LE(width, 18);
+  bmp.writeInt32LE(height, 22);
+  bmp.writeUInt16LE(1, 26);
+  bmp.writeUInt16LE(1, 28);
+  bmp.writeUInt32LE(stride * height, 34);
+  bmp.writeUInt32LE(0xFFFFFF, 58);
+  for (let y = 0; y < height; y++) {
+    const row = 62 + (height - 1 - y) * stride;
+    for (let x = 0; x < width; x++) {
+      if (!draw(x, y)) bmp[row + (x >> 3)] |= 0x80 >> (x & 7);
+    }
+  }
+  return bmp;
+}
+
+function unpackBits(src) {
+  const out = [];
+  for (let i = 0; i < src.length;) {
+    const n = src[i++];
+    if (n < 128) {
+      for (let k = 0; k <= n; k++) out.push(src[i++]);
+    } else {
+      for (let k = 0; k < 257 - n; k++) out.push(src[i]);
+      i++;
+    }
+  }
+  return Buffer.from(out);
+}
+
+// =============================================================================
+// PAGE TABLE
+// =============================================================================
+
+console.log('Page table');
+{
+  const header = encodePageList();
+  const parsed = parsePageList(header);
+  check('X-Pages round trip', parsed?.length === DEVICE_PAGES.length &&
+    parsed.every((p, i) => p.id === DEVICE_PAGES[i].id && p.maxAge === DEVICE_PAGES[i].maxAge), header);
+  check('dashboard is the first page', DEVICE_PAGES[0].id === 'outbound' && findPage('outbound').index === 0);
+  check('unknown page', findPage('nope') === null);
+  check('malformed lists rejected', parsePageList('a=1,,b=2') === null && parsePageList('UPPER=1') === null &&
+    parsePageList('') === null && parsePageList('a=1,b=2,c=3,d=4,e=5,f=6,g=7') === null);
+
+  const config = {
+    addresses: { home: '1 Clara St', work: '80 Collins St', cafe: 'Norma' },
+    locations: { home: { lat: 1 }, work: { lat: 2 } },
+    journey: { arrivalTime: '09:00', coffeeEnabled: true }
+  };
+  const back = returnJourneyConfig(config);
+  check('return journey swaps home and work', back.addresses.home === '80 Collins St' &&
+    back.addresses.work === '1 Clara St' && back.locations.home.lat === 2 && back.addresses.cafe === 'Norma' &&
+    !back.journey.coffeeEnabled && config.addresses.home === '1 Clara St');
+}
+
+// =============================================================================
+// PAGE CONTENT
+// =============================================================================
+
+console.log('\nPage content');
+{
+  const wet = weatherPageContent({ temp: 14, condition: 'Showers', umbrella: true, precipitation: 1.2 }, 'Home');
+  check('weather page', wet.sections[0].lines[0].startsWith('14°C  Showers') &&
+    wet.sections[1].lines[0].startsWith('Umbrella'));
+  const fallback = weatherPageContent({ temp: 20, condition: 'Unknown', source: 'fallback', error: true });
+  check('weather fallback flagged', fallback.footer.includes('UNAVAILABLE'));
+
+  const data = {
+    journey_legs: [
+      { title: 'Walk', state: 'normal' },
+      { title: 'Sandringham line', subtitle: 'Next: 7:55 (+3 min)', state: 'delayed' },
+      { title: 'Coffee', state: 'skip' }
+    ]
+  };
+  const alerts = alertsPageContent(data, [{ title: 'Buses replace trains', description: 'Frankston line, weekend' }]);
+  check('journey alerts before network alerts', alerts.sections.length === 2 &&
+    alerts.sections[0].heading === 'DELAYED: Sandringham line' && alerts.footer === '2 ALERTS');
+  const calm = alertsPageContent({ journey_legs: [{ title: 'Walk', state: 'normal' }] }, []);
+  check('no alerts page', calm.sections[0].heading === 'Good service' && calm.footer === '0 ALERTS');
+}
+
+// =============================================================================
+// PAGE FRAMES
+// =============================================================================
+
+console.log('\nPage frames');
+{
+  // Text-like page: header and footer bars, a few lines of "text"
+  const text = (x, y) => y < 72 || y >= 448 || (y >= 100 && y < 300 && y % 28 < 18 && x % 11 < 6 && x < 600);
+  const bmp = makeBMP(800, 480, text);
+  const { frame, hash } = pageFrameFromBMP(bmp);
+  check('one full-screen frame', frame.toString('ascii', 0, 4) === 'CCZF' && frame.readUInt16LE(6) === 0 &&
+    frame.readUInt16LE(8) === 0 && frame.readUInt16LE(10) === 800 && frame.readUInt16LE(12) === 480 &&
+    (frame[5] & FRAME_FLAG_REFRESH) !== 0);
+  const pixels = unpackBits(frame.subarray(FRAME_HEADER_SIZE));
+  check('unpacks to the BMP pixels', pixels.equals(parseBMP1(bmp).pixels),
+    `${frame.length} B vs ${bmp.length} B BMP`);
+
+  check('hash stable for the same pixels', pageFrameFromBMP(makeBMP(800, 480, text)).hash === hash, hash);
+  const moved = pageFrameFromBMP(makeBMP(800, 480, (x, y) => text(x, y) || (x === 400 && y === 400)));
+  check('hash changes with one pixel', moved.hash !== hash);
+
+  const busy = pageFrameFromBMP(makeBMP(800, 480, (x, y) => ((x * 7 + y * 13) % 5) < 2));
+  console.log(`   ℹ️  dense pattern page ${busy.frame.length} B (pages over a flash slot are not cached)`);
+}
+
+if (failures > 0) {
+  console.log(`\n❌ ${failures} checks failed`);
+  process.exit(1);
+}
+console.log('\n✅ All device page checks passed');
@@ -0,0 +1,276 @@
+/**
+ * CommuteCompute System™
+ * Smart Transit Display for Australian Public Transport
+ *
+ * Copyright © 2025-2026 Angus Bergman
+ *
+ * This file is part of CommuteCompute.
+ *
+ * CommuteCompute is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CommuteCompute is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with CommuteCompute. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+/**
+ * UDP Freshness Check: protocol and responder round trips
+ *
+ * Talks to the stand-in responder (tools/fresh-responder.mjs) over
+ * loopback the way CCFirm does: unchanged / changed / unknown answers,
+ * silence on a bad tag, replies bound to the query nonce. Also prints the
+ * query round trip, the server-side share of a device's radio-on time per
+ * poll (a full HTTPS fetch is a TCP connect, a handshake and ~48 KB).
+ *
+ * Usage:
+ *   node tests/test-fresh-check.js
+ */
+
+import dgram from 'dgram';
+import { randomBytes } from 'crypto';
+
+process.env.WEBHOOK_SECRET = process.env.WEBHOOK_SECRET || 'fresh-check-test-secret';
+
+const { derivePsk, createPskIdentity, pskIdentityForUrl, provisionDevicePsk } = await import('../src/utils/device-psk.js');
+const {
+  FRESH_STATUS,
+  freshKey,
+  encodeFreshQuery,
+  decodeFreshQuery,
+  verifyFreshQuery,
+  decodeFreshReply,
+  compareZoneHashes,
+  answerFreshQuery,
+  provisionFreshEndpoint
+} = await import('../src/services/fresh-check.js');
+const { getFreshHashes, getZoneHashes } = await import('../src/services/ccdash-renderer.js');
+const { deviceIdForToken } = await import('../src/services/frame-prerender.js');
+const { startStandInResponder } = await import('../tools/fresh-responder.mjs');
+
+console.log('📡 Testing UDP freshness check\n');
+
+let failures = 0;
+function check(name, ok, detail = '') {
+  console.log(`   ${ok ? '✅' : '❌'} ${name}${detail ? ` (${detail})` : ''}`);
+  if (!ok) failures++;
+}
+
+const token = randomBytes(24).toString('base64url');
+const identity = pskIdentityForUrl(`https://cc.example/api/device/${token}?format=bmp`);
+const key = freshKey(derivePsk(identity));
+const deviceId = identity.slice(4);
+const shown = [0x11111111, 0x22222222, 0x33333333, 0x44444444];
+
+// =============================================================================
+// CODEC
+// =============================================================================
+
+console.log('Codec');
+{
+  const msg = encodeFreshQuery({ identity, deviceId, nonce: 0xDEADBEEF, hashes: shown }, key);
+  const query = decodeFreshQuery(msg);
+  check('query round trip', query && query.identity === identity && query.deviceId === deviceId &&
+    query.nonce === 0xDEADBEEF && query.hashes.join() === shown.join(), `${msg.length} B`);
+  check('tag verifies', query && verifyFreshQuery(query)?.equals(key));
+
+  const tampered = Buffer.from(msg);
+  tampered[tampered.length - 20] ^= 1;
+  const bad = decodeFreshQuery(tampered);
+  check('tampered hash rejected', bad && verifyFreshQuery(bad) === null);
+
+  const other = freshKey(derivePsk(createPskIdentity()));
+  const forged = decodeFreshQuery(encodeFreshQuery({ identity, deviceId, nonce: 1, hashes: shown }, other));
+  check('wrong key rejected', forged && verifyFreshQuery(forged) === null);
+  check('truncated query rejected', decodeFreshQuery(msg.subarray(0, msg.length - 1)) === null);
+
+  const same = compareZoneHashes(shown, [...shown]);
+  check('same zones unchanged', same.status === FRESH_STATUS.UNCHANGED && same.changed === 0);
+  const moved = compareZoneHashes(shown, [shown[0], 0x99999999, shown[2], shown[3]]);
+  check('changed zone masked', moved.status === FRESH_STATUS.CHANGED && moved.changed === 0b10,
+    `0x${moved.changed.toString(16)}`);
+  const fewer = compareZoneHashes(shown, shown.slice(0, 3));
+  check('removed zone counts as change', fewer.status === FRESH_STATUS.CHANGED && fewer.changed === 0);
+  const none = compareZoneHashes([], shown);
+  check('empty device shows nothing', none.changed === 0b1111);
+}
+
+// =============================================================================
+// PSK PROVISIONING
+// =============================================================================
+
+console.log('\nPSK provisioning');
+{
+  const saved = ['WEBHOOK_SECRET', 'PSK_SECRET', 'PSK_REVOKED', 'FRESH_ENDPOINT'].map(k => [k, process.env[k]]);
+  process.env.FRESH_ENDPOINT = 'fresh.example:9999';
+  const fields = provisionDevicePsk(undefined, `https://cc.example/api/device/${token}`);
+  check('paired device gets a key', /^[0-9a-f]{64}$/.test(fields.psk || '') &&
+    derivePsk(fields.pskIdentity).toString('hex') === fields.psk && provisionFreshEndpoint().freshEndpoint);
+  check('identity names the device the pre-renderer tracks', fields.pskIdentity === identity &&
+    deviceId === deviceIdForToken(token));
+
+  const otherIdentity = pskIdentityForUrl('https://cc.example/api/device/someone-else');
+  const probe = decodeFreshQuery(encodeFreshQuery({ identity: otherIdentity, deviceId, nonce: 1, hashes: shown },
+    freshKey(derivePsk(otherIdentity))));
+  check('query about another device refused', probe !== null && verifyFreshQuery(probe) === null);
+
+  process.env.PSK_REVOKED = `cc1-0000000000000000, ${identity}`;
+  const revoked = decodeFreshQuery(encodeFreshQuery({ identity, deviceId, nonce: 1, hashes: shown }, key));
+  check('revoked identity refused', derivePsk(identity) === null && verifyFreshQuery(revoked) === null &&
+    derivePsk(otherIdentity) !== null);
+
+  // Pairing still completes, just without a key or freshness endpoint
+  const revokedUrl = `https://cc.example/api/device/${token}`;
+  check('revoked identity pairs without PSK fields',
+    Object.keys(provisionDevicePsk(undefined, revokedUrl)).length === 0 &&
+    Object.keys(provisionFreshEndpoint(undefined, revokedUrl)).length === 0);
+  const { default: pairHandler } = await import('../api/pair/[code].js');
+  global.pairingStore.set('REVOKD', { webhookUrl: revokedUrl, createdAt: Date.now() });
+  const reply = { statusCode: 200, body: null };
+  await pairHandler({ method: 'GET', query: { code: 'REVOKD' }, headers: {} }, {
+    setHeader() {},
+    status(code) { reply.statusCode = code; return this; },
+    json(body) { reply.body = body; return this; },
+    end() { return this; }
+  });
+  check('revoked device paired through /api/pair', reply.statusCode === 200 &&
+    reply.body?.status === 'paired' && reply.body.webhookUrl === revokedUrl &&
+    !('psk' in reply.body) && !('freshEndpoint' in reply.body) && !global.pairingStore.has('REVOKD'),
+    `${reply.statusCode} ${reply.body?.status}`);
+  delete process.env.PSK_REVOKED;
+
+  process.env.PSK_SECRET = 'dedicated-psk-secret';
+  check('PSK_SECRET takes precedence over WEBHOOK_SECRET', !freshKey(derivePsk(identity)).equals(key));
+
+  delete process.env.PSK_SECRET;
+  delete process.env.WEBHOOK_SECRET;
+  check('no secret, no PSK or freshness endpoint', Object.keys(provisionDevicePsk()).length === 0 &&
+    Object.keys(provisionFreshEndpoint()).length === 0 && derivePsk(identity) === null);
+
+  for (const [k, v] of saved) {
+    if (v === undefined) delete process.env[k]; else process.env[k] = v;
+  }
+}
+
+// =============================================================================
+// FRESHNESS HASHES
+// =============================================================================
+
+console.log('\nFreshness hashes');
+{
+  // Two polls a minute apart with the same departures: the clock and the
+  // countdowns moved, nothing else
+  const minute = 60000;
+  const now = Date.now();
+  const frameAt = (at, departures) => ({
+    location: 'HOME', current_time: new Date(at).toISOString().slice(11, 16), day: 'Monday', date: '3 March',
+    temp: 21, condition: 'Sunny', arrive_by: '8:52', status_type: 'normal', destination: 'WORK',
+    journey_legs: [
+      { type: 'walk', title: 'Walk to Station', minutes: 6 },
+      { type: 'train', title: 'Train to City', minutes: 18, nextDepartureTimesMs: departures },
+      { type: 'walk', title: 'Walk to Office', minutes: 4 }
+    ]
+  });
+  const departures = [now + 7 * minute, now + 19 * minute];
+  const first = frameAt(now, departures);
+  const next = frameAt(now + minute, departures);
+
+  const lookupAt = data => async id => (id === deviceId ? getFreshHashes(data) : null);
+  async function answer(shownData, currentData) {
+    const nonce = randomBytes(4).readUInt32LE(0);
+    const msg = encodeFreshQuery({ identity, deviceId, nonce, hashes: getFreshHashes(shownData) }, key);
+    const reply = await answerFreshQuery(msg, lookupAt(currentData));
+    return reply && decodeFreshReply(reply, key, nonce);
+  }
+
+  check('clock zone left out', getFreshHashes(first).length === getZoneHashes(first).length - 1);
+  const drawn = getZoneHashes(next);
+  check('drawn zones differ a minute later', getZoneHashes(first).some((hash, i) => hash !== drawn[i]));
+  const same = await answer(first, next);
+  check('consecutive minutes, same departures: unchanged', same?.status === FRESH_STATUS.UNCHANGED);
+
+  const delayed = frameAt(now + minute, [now + 9 * minute, now + 19 * minute]);
+  const changed = await answer(first, delayed);
+  check('departure moved: changed', changed?.status === FRESH_STATUS.CHANGED && changed.changed !== 0);
+}
+
+// =============================================================================
+// RESPONDER
+// =============================================================================
+
+const client = dgram.createSocket('udp4');
+await new Promise(resolve => client.bind(0, resolve));
+
+function ask(port, msg, timeoutMs = 300) {
+  return new Promise(resolve => {
+    const started = process.hrtime.bigint();
+    const timer = setTimeout(() => {
+      client.off('message', onMessage);
+      resolve(null);
+    }, timeoutMs);
+    function onMessage(reply) {
+      clearTimeout(timer);
+      client.off('message', onMessage);
+      resolve({ reply, us: Number(process.hrtime.bigint() - started) / 1000 });
+    }
+    client.on('message', onMessage);
+    client.send(msg, port, '127.0.0.1');
+  });
+}
+
+async function query(port, hashes, nonce = randomBytes(4).readUInt32LE(0)) {
+  const res = await ask(port, encodeFreshQuery({ identity, deviceId, nonce, hashes }, key));
+  return res && { ...res, decoded: decodeFreshReply(res.reply, key, nonce) };
+}
+
+console.log('\nStand-in responder');
+{
+  const standIn = await startStandInResponder({ port: 0, changeEvery: 3, quiet: true });
+
+  const first = await query(standIn.port, shown);
+  check('first poll unchanged', first?.decoded?.status === FRESH_STATUS.UNCHANGED);
+  const second = await query(standIn.port, shown);
+  check('second poll unchanged', second?.decoded?.status === FRESH_STATUS.UNCHANGED);
+  const third = await query(standIn.port, shown);
+  check('scripted change reported', third?.decoded?.status === FRESH_STATUS.CHANGED &&
+    third.decoded.changed === 1 && third.decoded.zones === shown.length);
+
+  const msg = encodeFreshQuery({ identity, deviceId, nonce: 7, hashes: shown }, key);
+  const silent = await ask(standIn.port, Buffer.concat([msg.subarray(0, -1), Buffer.from([msg[msg.length - 1] ^ 1])]));
+  check('bad tag gets no reply', silent === null);
+
+  const replayed = await ask(standIn.port, msg);
+  check('reply bound to nonce', replayed && decodeFreshReply(replayed.reply, key, 8) === null &&
+    decodeFreshReply(replayed.reply, key, 7) !== null);
+
+  const rtt = [];
+  for (let i = 0; i < 50; i++) {
+    const res = await query(standIn.port, shown);
+    if (res?.decoded) rtt.push(res.us);
+  }
+  rtt.sort((a, b) => a - b);
+  check('50 polls answered', rtt.length === 50,
+    `loopback round trip p50 ${rtt[25]?.toFixed(0)} us, max ${rtt[rtt.length - 1]?.toFixed(0)} us`);
+  await standIn.close();
+
+  const unknown = await startStandInResponder({ port: 0, unknown: true, quiet: true });
+  const res = await query(unknown.port, shown);
+  check('unknown device reported', res?.decoded?.status === FRESH_STATUS.UNKNOWN);
+  await unknown.close();
+}
+
+client.close();
+
+if (failures > 0) {
+  console.log(`\n❌ ${failures} checks failed`);
+  process.exit(1);
+}
+console.log('\n✅ All freshness checks passed');
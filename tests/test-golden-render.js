@@ -0,0 +1,378 @@
+/**
+ * CommuteCompute System™
+ * Smart Transit Display for Australian Public Transport
+ *
+ * Copyright © 2025-2026 Angus Bergman
+ *
+ * This file is part of CommuteCompute.
+ *
+ * CommuteCompute is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CommuteCompute is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with CommuteCompute. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+/**
+ * Golden-Image Equivalence: server renderer vs device renderer
+ *
+ * Each fixture in tests/golden/fixtures is rendered twice:
+ *   - server: ccdash-renderer.js renderFullScreenBMP() (the golden image)
+ *   - device: firmware dash-template.h via env:native-golden, drawing into a
+ *     FakeBBEPAPER from the timetable slice the server would send, or with
+ *     "renderer": "model", from the full data model a CC_LOCAL_RENDER
+ *     device gets (dash_render_model())
+ * The 1-bit outputs are compared region by region using the masks in
+ * tests/golden/masks.json, and both render times are recorded, so a layout
+ * drift or a slowdown on either side fails the same run.
+ *
+ * Usage:
+ *   node tests/test-golden-render.js [fixture...]
+ *   GOLDEN_REPEAT=20 node tests/test-golden-render.js
+ *
+ * The device renderer is compiled from the current tree with $CXX/c++ on
+ * every run, or taken from $CC_GOLDEN_RENDERER.
+ * Images, diffs and report.json are written to tests/golden/output/.
+ */
+
+import { execFileSync } from 'child_process';
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import { renderFullScreenBMP } from '../src/services/ccdash-renderer.js';
+import { purgeZoneCache } from '../src/services/zone-render-cache.js';
+import { parseBMP1 } from '../src/services/frame-codec.js';
+import { buildTimetableSlice } from '../src/services/timetable-slice.js';
+import { encodeModelPatch, modelFromDashboard } from '../src/services/model-patch.js';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const ROOT = path.resolve(__dirname, '..');
+const GOLDEN_DIR = path.join(__dirname, 'golden');
+const FIXTURE_DIR = path.join(GOLDEN_DIR, 'fixtures');
+const OUTPUT_DIR = path.join(GOLDEN_DIR, 'output');
+const REPEAT = Math.max(1, Number.parseInt(process.env.GOLDEN_REPEAT, 10) || 10);
+
+console.log('🧪 Golden-image tests: server renderer vs device renderer\n');
+
+// =============================================================================
+// DEVICE RENDERER
+// =============================================================================
+
+// A leftover .pio build may predate the headers under test, so it is not used
+function buildDeviceRenderer() {
+  if (process.env.CC_GOLDEN_RENDERER) return process.env.CC_GOLDEN_RENDERER;
+  const out = path.join(os.tmpdir(), `cc-golden-render-${process.pid}${process.platform === 'win32' ? '.exe' : ''}`);
+  execFileSync(process.env.CXX || 'c++', [
+    '-std=gnu++17', '-O2',
+    '-I', path.join(ROOT, 'firmware/include'),
+    path.join(ROOT, 'firmware/src/golden-render.cpp'),
+    '-o', out
+  ], { stdio: 'inherit' });
+  return out;
+}
+
+function renderDevice(renderer, fixture, name) {
+  const bmpPath = path.join(OUTPUT_DIR, `${name}.device.bmp`);
+  let args;
+  if (fixture.renderer === 'model') {
+    const modelPath = path.join(OUTPUT_DIR, `${name}.model.bin`);
+    fs.writeFileSync(modelPath, encodeModelPatch(null, modelFromDashboard(fixture.dashboard), { version: 1 }));
+    args = ['--model', modelPath];
+  } else {
+    const nowUnix = Math.floor(Date.parse(fixture.at) / 1000);
+    const slice = buildTimetableSlice({
+      legs: fixture.dashboard.journey_legs,
+      transitData: fixture.transit || {},
+      generatedAt: new Date(fixture.at),
+      timeZone: fixture.timeZone,
+      arriveBy: fixture.dashboard.arrive_by,
+      live: true
+    });
+    const slicePath = path.join(OUTPUT_DIR, `${name}.slice.bin`);
+    fs.writeFileSync(slicePath, slice);
+    args = ['--slice', slicePath, '--now', String(nowUnix), '--last-live', String(nowUnix)];
+  }
+
+  const stdout = execFileSync(renderer, [...args, '--out', bmpPath, '--repeat', String(REPEAT)], { encoding: 'utf8' });
+  return { bmp: fs.readFileSync(bmpPath), stats: JSON.parse(stdout.trim().split('\n').pop()) };
+}
+
+// =============================================================================
+// SERVER RENDERER
+// =============================================================================
+
+function renderServer(fixture, name) {
+  const times = [];
+  let bmp = null;
+  for (let i = 0; i < REPEAT; i++) {
+    purgeZoneCache();   // Time a full render, not zone cache hits
+    const started = process.hrtime.bigint();
+    bmp = renderFullScreenBMP(fixture.dashboard);
+    times.push(Number(process.hrtime.bigint() - started) / 1e6);
+  }
+  fs.writeFileSync(path.join(OUTPUT_DIR, `${name}.server.bmp`), bmp);
+  times.sort((a, b) => a - b);
+  return {
+    bmp,
+    stats: {
+      min: +times[0].toFixed(2),
+      median: +times[Math.floor(times.length / 2)].toFixed(2),
+      max: +times[times.length - 1].toFixed(2)
+    }
+  };
+}
+
+// =============================================================================
+// COMPARISON
+// =============================================================================
+
+function isBlack(img, x, y) {
+  return ((img.pixels[y * img.rowBytes + (x >> 3)] >> (7 - (x & 7))) & 1) === 0;
+}
+
+function hasColourNear(img, x, y, black, radius) {
+  for (let dy = -radius; dy <= radius; dy++) {
+    const yy = y + dy;
+    if (yy < 0 || yy >= img.height) continue;
+    for (let dx = -radius; dx <= radius; dx++) {
+      const xx = x + dx;
+      if (xx >= 0 && xx < img.width && isBlack(img, xx, yy) === black) return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Compare one rectangle; marks differing pixels in diffPixels (1 = differs)
+ */
+function compareRegion(server, device, region, diffPixels) {
+  const x0 = Math.max(0, region.x), y0 = Math.max(0, region.y);
+  const x1 = Math.min(server.width, region.x + region.w);
+  const y1 = Math.min(server.height, region.y + region.h);
+  const radius = region.mode === 'exact' ? 0 : (region.radius ?? 1);
+  let pixels = 0, diff = 0;
+
+  for (let y = y0; y < y1; y++) {
+    for (let x = x0; x < x1; x++) {
+      pixels++;
+      const a = isBlack(server, x, y);
+      const b = isBlack(device, x, y);
+      if (a === b) continue;
+      if (radius > 0 && hasColourNear(device, x, y, a, radius) && hasColourNear(server, x, y, b, radius)) continue;
+      diff++;
+      diffPixels[y * server.width + x] = 1;
+    }
+  }
+  const ratio = pixels ? diff / pixels : 0;
+  const limit = region.mode === 'exact' ? 0 : (region.maxDiff ?? 0);
+  return { name: region.name, mode: region.mode, pixels, diff, ratio: +ratio.toFixed(4), limit, pass: ratio <= limit };
+}
+
+/**
+ * Bounding box of the black pixels inside a rectangle, or null
+ */
+function inkBox(img, x0, y0, x1, y1) {
+  let box = null;
+  for (let y = y0; y < y1; y++) {
+    for (let x = x0; x < x1; x++) {
+      if (!isBlack(img, x, y)) continue;
+      if (!box) box = { x0: x, y0: y, x1: x, y1: y };
+      box.x0 = Math.min(box.x0, x);
+      box.x1 = Math.max(box.x1, x);
+      box.y0 = Math.min(box.y0, y);
+      box.y1 = Math.max(box.y1, y);
+    }
+  }
+  return box;
+}
+
+/**
+ * Text drawn in different fonts (Inter vs 8x8) cannot match pixel for
+ * pixel, but it must sit where the server puts it: both images have ink
+ * in the region or neither does, and every device pixel lies inside the
+ * server's ink box grown by `slack`. Device pixels outside it differ.
+ */
+function compareGlyphBox(server, device, region, diffPixels) {
+  const x0 = Math.max(0, region.x), y0 = Math.max(0, region.y);
+  const x1 = Math.min(server.width, region.x + region.w);
+  const y1 = Math.min(server.height, region.y + region.h);
+  const slack = region.slack ?? 8;
+  const want = inkBox(server, x0, y0, x1, y1);
+  const got = inkBox(device, x0, y0, x1, y1);
+  let pixels = 0, diff = 0;
+
+  for (let y = y0; y < y1; y++) {
+    for (let x = x0; x < x1; x++) {
+      pixels++;
+      const outside = want
+        ? x < want.x0 - slack || x > want.x1 + slack || y < want.y0 - slack || y > want.y1 + slack
+        : true;
+      // Server ink with nothing drawn on the device counts all of the server's box
+      const missing = !got && want && !outside;
+      if (!(isBlack(device, x, y) && outside) && !missing) continue;
+      diff++;
+      diffPixels[y * server.width + x] = 1;
+    }
+  }
+  const ratio = pixels ? diff / pixels : 0;
+  const limit = region.maxDiff ?? 0;
+  const box = b => (b ? `${b.x0},${b.y0}-${b.x1},${b.y1}` : 'none');
+  return {
+    name: region.name, mode: region.mode, pixels, diff, ratio: +ratio.toFixed(4), limit,
+    serverBox: box(want), deviceBox: box(got), pass: ratio <= limit
+  };
+}
+
+/**
+ * Outline bands of each leg box (same geometry as getDynamicLegZone() and
+ * dash_render_offline())
+ */
+function legRegions(legCount, rule) {
+  const regions = [];
+  const startY = 132, endY = 440, gap = 14, maxH = 52;
+  const legH = Math.min(maxH, Math.floor((endY - startY - (legCount - 1) * gap) / legCount));
+  for (let i = 0; i < legCount; i++) {
+    const x = 8, w = 784, y = startY + i * (legH + gap);
+    const bandW = w - rule.rightExclude;
+    const base = { mode: rule.mode, radius: rule.radius, maxDiff: rule.maxDiff };
+    regions.push({ ...base, name: `leg${i + 1}-top`, x, y, w: bandW, h: rule.band });
+    regions.push({ ...base, name: `leg${i + 1}-bottom`, x, y: y + legH - rule.band, w: bandW, h: rule.band });
+    regions.push({ ...base, name: `leg${i + 1}-left`, x, y, w: rule.band, h: legH });
+  }
+  return regions;
+}
+
+/**
+ * Top-down 1-bit BMP from packed rows (bit 1 = white)
+ */
+function encodeBMP1(width, height, rows) {
+  const rowBytes = Math.ceil(width / 8);
+  const stride = Math.ceil(width / 32) * 4;
+  const out = Buffer.alloc(62 + stride * height);
+  out.write('BM', 0, 'ascii');
+  out.writeUInt32LE(out.length, 2);
+  out.writeUInt32LE(62, 10);
+  out.writeUInt32LE(40, 14);
+  out.writeInt32LE(width, 18);
+  out.writeInt32LE(-height, 22);
+  out.writeUInt16LE(1, 26);
+  out.writeUInt16LE(1, 28);
+  out.writeUInt32LE(stride * height, 34);
+  out.writeUInt32LE(2, 46);
+  out.fill(0xFF, 58, 61);   // Palette: 0 black, 1 white
+  for (let y = 0; y < height; y++) rows.copy(out, 62 + y * stride, y * rowBytes, (y + 1) * rowBytes);
+  return out;
+}
+
+function writeDiffImage(width, height, diffPixels, file) {
+  const rowBytes = Math.ceil(width / 8);
+  const rows = Buffer.alloc(rowBytes * height, 0xFF);
+  for (let i = 0; i < diffPixels.length; i++) {
+    if (diffPixels[i]) {
+      const x = i % width, y = Math.floor(i / width);
+      rows[y * rowBytes + (x >> 3)] &= ~(0x80 >> (x & 7));
+    }
+  }
+  fs.writeFileSync(file, encodeBMP1(width, height, rows));
+}
+
+// =============================================================================
+// RUN
+// =============================================================================
+
+const masks = JSON.parse(fs.readFileSync(path.join(GOLDEN_DIR, 'masks.json'), 'utf8'));
+const wanted = process.argv.slice(2);
+const fixtureNames = fs.readdirSync(FIXTURE_DIR)
+  .filter(f => f.endsWith('.json'))
+  .map(f => f.replace(/\.json$/, ''))
+  .filter(name => wanted.length === 0 || wanted.includes(name))
+  .sort();
+
+if (fixtureNames.length === 0) {
+  console.error('❌ No fixtures found');
+  process.exit(1);
+}
+
+fs.mkdirSync(OUTPUT_DIR, { recursive: true });
+const renderer = buildDeviceRenderer();
+const report = { generatedAt: new Date().toISOString(), repeat: REPEAT, budgets: masks.budgets, fixtures: [] };
+let failures = 0;
+
+for (const name of fixtureNames) {
+  const fixture = JSON.parse(fs.readFileSync(path.join(FIXTURE_DIR, `${name}.json`), 'utf8'));
+  console.log(`▶ ${name}: ${fixture.description || ''}`);
+
+  const server = renderServer(fixture, name);
+  const device = renderDevice(renderer, fixture, name);
+  const serverImg = parseBMP1(server.bmp);
+  const deviceImg = parseBMP1(device.bmp);
+
+  const result = {
+    name,
+    serverMs: server.stats,
+    deviceUs: device.stats.renderUs,
+    regions: [],
+    pass: true
+  };
+
+  if (serverImg.width !== deviceImg.width || serverImg.height !== deviceImg.height) {
+    result.pass = false;
+    result.error = `Size mismatch: server ${serverImg.width}x${serverImg.height}, device ${deviceImg.width}x${deviceImg.height}`;
+  } else {
+    const activeLegs = fixture.dashboard.journey_legs.filter(l => l.state !== 'skip').length;
+    const kind = fixture.renderer || 'offline';
+    const regions = [
+      ...masks.regions.filter(r => r.mode !== 'ignore' && (!r.renderer || r.renderer === kind)),
+      ...legRegions(activeLegs, masks.legs)
+    ];
+    const diffPixels = new Uint8Array(serverImg.width * serverImg.height);
+    for (const region of regions) {
+      const r = region.mode === 'glyph-box'
+        ? compareGlyphBox(serverImg, deviceImg, region, diffPixels)
+        : compareRegion(serverImg, deviceImg, region, diffPixels);
+      result.regions.push(r);
+      if (!r.pass) result.pass = false;
+    }
+    writeDiffImage(serverImg.width, serverImg.height, diffPixels, path.join(OUTPUT_DIR, `${name}.diff.bmp`));
+  }
+
+  if (masks.budgets?.serverMs && server.stats.median > masks.budgets.serverMs) {
+    result.pass = false;
+    result.error = `Server render ${server.stats.median} ms over budget ${masks.budgets.serverMs} ms`;
+  }
+  if (masks.budgets?.deviceUs && device.stats.renderUs.median > masks.budgets.deviceUs) {
+    result.pass = false;
+    result.error = `Device render ${device.stats.renderUs.median} us over budget ${masks.budgets.deviceUs} us`;
+  }
+
+  for (const r of result.regions) {
+    const mark = r.pass ? '✅' : '❌';
+    const boxes = r.serverBox ? `, ink ${r.deviceBox} in ${r.serverBox}` : '';
+    console.log(`   ${mark} ${r.name.padEnd(14)} ${(r.ratio * 100).toFixed(2).padStart(6)}% differ (limit ${(r.limit * 100).toFixed(1)}%${boxes})`);
+  }
+  if (result.error) console.log(`   ❌ ${result.error}`);
+  console.log(`   ⏱  server ${server.stats.median} ms, device ${device.stats.renderUs.median} us (median of ${REPEAT})\n`);
+
+  if (!result.pass) failures++;
+  report.fixtures.push(result);
+}
+
+fs.writeFileSync(path.join(OUTPUT_DIR, 'report.json'), JSON.stringify(report, null, 2));
+if (!process.env.CC_GOLDEN_RENDERER) fs.rmSync(renderer, { force: true });
+console.log(`Report: ${path.relative(ROOT, path.join(OUTPUT_DIR, 'report.json'))}`);
+
+if (failures > 0) {
+  console.log(`❌ ${failures} of ${fixtureNames.length} fixtures differ`);
+  process.exit(1);
+}
+console.log(`✅ All ${fixtureNames.length} fixtures match`);
@@ -0,0 +1,180 @@
+/**
+ * CommuteCompute System™
+ * Smart Transit Display for Australian Public Transport
+ *
+ * Copyright © 2025-2026 Angus Bergman
+ *
+ * This file is part of CommuteCompute.
+ *
+ * CommuteCompute is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CommuteCompute is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with CommuteCompute. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+/**
+ * Data-Model Delta Patches: codec and per-device acknowledgement
+ *
+ * Encodes full models and patches, applies them the way CCFirm's
+ * dash-model.h does (base must match, check must verify), and walks a
+ * device through a morning of polls: first contact, minute ticks, a leg
+ * change, a lost response and a device that lost its model. Prints full
+ * model vs patch sizes (a BMP frame is ~48 KB).
+ *
+ * Usage:
+ *   node tests/test-model-patch.js
+ */
+
+import {
+  MODEL_KIND,
+  modelFromDashboard,
+  encodeModelPatch,
+  applyModelPatch,
+  nextModelVersion,
+  answerModelRequest,
+  getModelPatchStats
+} from '../src/services/model-patch.js';
+
+console.log('🧩 Testing data-model delta patches\n');
+
+let failures = 0;
+function check(name, ok, detail = '') {
+  console.log(`   ${ok ? '✅' : '❌'} ${name}${detail ? ` (${detail})` : ''}`);
+  if (!ok) failures++;
+}
+
+function dashboard(minute, overrides = {}) {
+  return {
+    location: '1 Clara St, South Yarra',
+    current_time: `7:${String(minute).padStart(2, '0')}`,
+    day: 'TUESDAY',
+    date: '14 OCTOBER',
+    temp: '17',
+    condition: 'Partly cloudy',
+    umbrella: false,
+    status_type: 'normal',
+    arrive_by: '8:50',
+    total_minutes: 38,
+    leave_in_minutes: 4,
+    journey_legs: [
+      { number: 1, type: 'walk', title: 'Walk to Norma\'s Cafe', subtitle: '3 min walk', minutes: 3, state: 'normal' },
+      { number: 2, type: 'coffee', title: 'Coffee at Norma\'s', subtitle: 'Time for coffee', minutes: 5, state: 'normal', canGet: true },
+      { number: 3, type: 'train', title: 'Sandringham line to Flinders St', subtitle: 'Next: 7:52, 8:01', minutes: 14, state: 'normal' },
+      { number: 4, type: 'walk', title: 'Walk to office', subtitle: '6 min walk', minutes: 6, state: 'normal' }
+    ],
+    destination: '80 Collins St, Melbourne',
+    ...overrides
+  };
+}
+
+// =============================================================================
+// CODEC
+// =============================================================================
+
+console.log('Codec');
+{
+  const model = modelFromDashboard(dashboard(40));
+  const full = encodeModelPatch(null, model, { version: 7 });
+  const applied = applyModelPatch(null, 0, full);
+  check('full model round trip', applied && applied.version === 7 &&
+    JSON.stringify(applied.model) === JSON.stringify(model), `${full.length} B`);
+  check('leg fields mapped', model['leg1.can_get'] === 1 && model['leg0.can_get'] === 2 &&
+    model.leg_count === 4 && model['leg4.title'] === '');
+
+  const tick = modelFromDashboard(dashboard(41));
+  const patch = encodeModelPatch(model, tick, { base: 7, version: 8 });
+  const patched = applyModelPatch(model, 7, patch);
+  check('minute tick patches only the clock', patched && patched.changed.join() === 'current_time' &&
+    patch[1] === MODEL_KIND.PATCH, `${patch.length} B vs ${full.length} B full`);
+
+  check('patch refused on the wrong base', applyModelPatch(model, 6, patch) === null);
+  const corrupt = Buffer.from(patch);
+  corrupt[8 + 3] ^= 0x01;             // First byte of the new time
+  check('corrupted value fails the check', applyModelPatch(model, 7, corrupt) === null);
+  check('truncated patch refused', applyModelPatch(model, 7, patch.subarray(0, patch.length - 1)) === null);
+
+  const longer = modelFromDashboard(dashboard(41, { location: `${'x'.repeat(60)}é` }));
+  check('strings truncated to field size', longer.location.length === 40);
+  const odd = modelFromDashboard(dashboard(41, { location: 'Café ☕' }));
+  check('non-ASCII replaced', /^[\x20-\x7e]*$/.test(odd.location), odd.location);
+
+  check('versions skip 0', nextModelVersion(0xFFFF) === 1 && nextModelVersion(1) === 2);
+}
+
+// =============================================================================
+// PER-DEVICE FLOW
+// =============================================================================
+
+console.log('\nDevice flow');
+{
+  const deviceId = 'test-model-device';
+  let held = null;
+  let heldVersion = 0;
+  const poll = async (data, { lose = false } = {}) => {
+    const answer = await answerModelRequest(deviceId, heldVersion, data);
+    if (lose) return { answer, applied: null };
+    const applied = applyModelPatch(held, heldVersion, answer.body);
+    if (applied) {
+      held = applied.model;
+      heldVersion = applied.version;
+    }
+    return { answer, applied };
+  };
+
+  let r = await poll(dashboard(40));
+  check('first contact gets a full model', r.answer.kind === MODEL_KIND.FULL && r.applied, `${r.answer.body.length} B`);
+
+  r = await poll(dashboard(40));
+  check('unchanged model: empty patch, same version', r.answer.kind === MODEL_KIND.PATCH &&
+    r.answer.ops === 0 && r.answer.version === heldVersion, `${r.answer.body.length} B`);
+
+  r = await poll(dashboard(41));
+  check('minute tick is a one-op patch', r.answer.kind === MODEL_KIND.PATCH && r.answer.ops === 1 &&
+    r.applied?.changed.join() === 'current_time', `${r.answer.body.length} B`);
+
+  const delayed = (minute) => {
+    const data = dashboard(minute, { status_type: 'delay' });
+    data.journey_legs = data.journey_legs.map(leg => leg.type === 'train'
+      ? { ...leg, subtitle: 'Next: 7:55 (+3 min)', minutes: 17, state: 'delayed' } : leg);
+    return data;
+  };
+  r = await poll(delayed(42));
+  check('delay patches the clock, status and one leg', r.applied &&
+    r.applied.changed.join() === 'current_time,status_type,leg2.subtitle,leg2.minutes,leg2.state',
+    `${r.answer.ops} ops, ${r.answer.body.length} B`);
+
+  const versionBeforeLoss = heldVersion;
+  r = await poll(delayed(43), { lose: true });
+  r = await poll(delayed(44));
+  check('lost response: next patch built from the acknowledged model', r.answer.kind === MODEL_KIND.PATCH &&
+    r.applied && heldVersion !== versionBeforeLoss);
+
+  held = null;
+  heldVersion = 0;
+  r = await poll(delayed(45));
+  check('device without a model gets a full one', r.answer.kind === MODEL_KIND.FULL && r.applied);
+
+  heldVersion = 999;
+  r = await poll(delayed(46));
+  check('unknown version gets a full model', r.answer.kind === MODEL_KIND.FULL && r.applied);
+
+  const stats = getModelPatchStats();
+  check('stats counted', stats.requests === 8 && stats.full === 3,
+    `${stats.bytesSent} B sent, ${stats.fullBytesAvoided} B saved vs full models`);
+}
+
+if (failures > 0) {
+  console.log(`\n❌ ${failures} checks failed`);
+  process.exit(1);
+}
+console.log('\n✅ All model patch checks passed');
@@ -0,0 +1,231 @@
+/**
+ * CommuteCompute System™
+ * Smart Transit Display for Australian Public Transport
+ *
+ * Copyright © 2025-2026 Angus Bergman
+ *
+ * This file is part of CommuteCompute.
+ *
+ * CommuteCompute is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CommuteCompute is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with CommuteCompute. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+/**
+ * Conditional Zone Sync (X-Zone-Hashes): server and device ends
+ *
+ * The header codec and zone selection in zone-sync.js, renderZoneDelta()
+ * for a device showing nothing, everything, or all but one zone, and the
+ * firmware decoder (zone-sync.h via env:native-zonesync) on what the
+ * server's encoder produces: the same hash vectors back, and every CCZF
+ * zone drawn through ZoneBmpSink with the pixels it was sent with.
+ *
+ * Usage:
+ *   node tests/test-zone-sync.js
+ *
+ * The device check is built from the current tree with $CXX/c++ for every
+ * run, or taken from $CC_ZONESYNC_CHECK.
+ */
+
+import { execFileSync } from 'child_process';
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import {
+  ZONE_HASH_MAX,
+  encodeZoneHashes,
+  parseZoneHashes,
+  selectChangedZones
+} from '../src/services/zone-sync.js';
+import { encodeZoneFrame, parseBMP1 } from '../src/services/frame-codec.js';
+import { renderZoneDelta, getZoneHashes } from '../src/services/ccdash-renderer.js';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const ROOT = path.resolve(__dirname, '..');
+
+console.log('🧩 Testing conditional zone sync\n');
+
+let failures = 0;
+function check(name, ok, detail = '') {
+  console.log(`   ${ok ? '✅' : '❌'} ${name}${detail ? ` (${detail})` : ''}`);
+  if (!ok) failures++;
+}
+
+const sameSet = (set, list) => set.size === new Set(list).size && list.every(h => set.has(h));
+
+// =============================================================================
+// HEADER CODEC
+// =============================================================================
+
+console.log('Header codec');
+const vectors = [
+  [],
+  [0],
+  [0xFFFFFFFF],
+  [0x12345678, 0x9ABCDEF0, 0x0BADF00D],
+  Array.from({ length: ZONE_HASH_MAX }, (_, i) => (i * 0x9E3779B9) >>> 0)
+];
+const label = hashes => `${hashes.length} hashes${hashes.length ? ` from 0x${hashes[0].toString(16)}` : ''}`;
+for (const hashes of vectors) {
+  check(`${label(hashes)} round trip`, sameSet(parseZoneHashes(encodeZoneHashes(hashes)), hashes));
+}
+check('vector capped at ZONE_HASH_MAX',
+  parseZoneHashes(encodeZoneHashes(Array.from({ length: 20 }, (_, i) => i + 1))).size === ZONE_HASH_MAX);
+
+const malformed = {
+  missing: undefined,
+  empty: '',
+  'not a string': 42,
+  'wrong version': Buffer.from([2, 1, 0, 0, 0]).toString('base64'),
+  'partial hash': Buffer.from([1, 1, 0, 0]).toString('base64'),
+  'stray byte': Buffer.from([1, 9]).toString('base64')
+};
+for (const [name, value] of Object.entries(malformed)) {
+  check(`${name} means nothing shown`, parseZoneHashes(value).size === 0);
+}
+
+// =============================================================================
+// ZONE SELECTION
+// =============================================================================
+
+console.log('\nZone selection');
+const zones = [{ id: 'a', hash: 1 }, { id: 'b', hash: 2 }, { id: 'c', hash: 3 }];
+check('nothing shown: every zone', selectChangedZones(zones, new Set()).join() === 'a,b,c');
+check('all shown: none', selectChangedZones(zones, new Set([1, 2, 3])).length === 0);
+check('one changed: just that one', selectChangedZones(zones, new Set([1, 3, 99])).join() === 'b');
+check('forceAll: every zone', selectChangedZones(zones, new Set([1, 2, 3]), true).join() === 'a,b,c');
+
+// =============================================================================
+// RENDER DELTA
+// =============================================================================
+
+console.log('\nrenderZoneDelta');
+const dashboard = {
+  location: 'HOME', current_time: '7:41', day: 'Monday', date: '3 March', temp: 21, condition: 'Sunny',
+  arrive_by: '8:52', status_type: 'normal', destination: 'WORK',
+  journey_legs: [
+    { type: 'walk', title: 'Walk to Station', minutes: 6 },
+    { type: 'train', title: 'Train to City', minutes: 18, nextDepartures: [4, 12] },
+    { type: 'walk', title: 'Walk to Office', minutes: 4 }
+  ]
+};
+const active = getZoneHashes(dashboard);
+const full = renderZoneDelta(dashboard, new Set());
+check('empty vector returns every zone', full.frames.length === active.length &&
+  full.changed.length === active.length, `${full.frames.length} frames`);
+check('hash vector covers every zone', sameSet(new Set(full.hashes), active.map(z => z.hash)));
+
+const none = renderZoneDelta(dashboard, parseZoneHashes(encodeZoneHashes(full.hashes)));
+check('matching vector returns an empty body', none.frames.length === 0 && Buffer.concat(none.frames).length === 0);
+
+const warmer = { ...dashboard, temp: 24 };
+const one = renderZoneDelta(warmer, parseZoneHashes(encodeZoneHashes(full.hashes)));
+check('one changed zone returns one frame', one.frames.length === 1 && one.changed.join() === 'header.weather',
+  one.changed.join());
+
+// =============================================================================
+// DEVICE DECODER
+// =============================================================================
+
+function buildDeviceCheck() {
+  if (process.env.CC_ZONESYNC_CHECK) return process.env.CC_ZONESYNC_CHECK;
+  const out = path.join(os.tmpdir(), `cc-zone-sync-check-${process.pid}${process.platform === 'win32' ? '.exe' : ''}`);
+  execFileSync(process.env.CXX || 'c++', [
+    '-std=gnu++17', '-O2',
+    '-I', path.join(ROOT, 'firmware/include'),
+    path.join(ROOT, 'firmware/src/zone-sync-check.cpp'),
+    '-o', out
+  ], { stdio: 'inherit' });
+  return out;
+}
+
+const device = buildDeviceCheck();
+const runDevice = args => JSON.parse(execFileSync(device, args, { encoding: 'utf8' }).trim().split('\n').pop());
+const workDir = fs.mkdtempSync(path.join(os.tmpdir(), 'cc-zone-sync-'));
+
+console.log('\nDevice: zonesync_decode()');
+for (const hashes of vectors) {
+  const encoded = encodeZoneHashes(hashes);
+  const res = runDevice(['--hashes', encoded]);
+  check(`${label(hashes)} decode as sent`, res.ok && res.hashes.join() === hashes.join() &&
+    res.encoded === encoded);
+}
+for (const [name, value] of Object.entries(malformed)) {
+  if (typeof value !== 'string' || value === '') continue;
+  const res = runDevice(['--hashes', value]);
+  check(`${name} rejected, vector untouched`, !res.ok && res.untouched);
+}
+
+console.log('\nDevice: CCZF delta through ZoneBmpSink');
+function packedRows(w, h, seed) {
+  const rowBytes = Math.ceil(w / 8);
+  const rows = Buffer.alloc(rowBytes * h);
+  let x = seed;
+  for (let i = 0; i < rows.length; i++) {
+    x = (x * 1103515245 + 12345) >>> 0;
+    rows[i] = (i % 5 === 0) ? 0xFF : x >>> 24;       // Runs and literals for PackBits
+  }
+  // Padding bits past the zone width are not pixels
+  const tail = w % 8;
+  if (tail) for (let y = 0; y < h; y++) rows[y * rowBytes + rowBytes - 1] |= 0xFF >> tail;
+  return rows;
+}
+
+function sendDelta(name, sent) {
+  const body = path.join(workDir, `${name}.cczf`);
+  const outDir = path.join(workDir, name);
+  fs.mkdirSync(outDir);
+  fs.writeFileSync(body, Buffer.concat(sent.map(({ zone, rows }, i) =>
+    encodeZoneFrame(zone, rows, i === sent.length - 1 ? 0x01 : 0))));
+  const res = runDevice(['--delta', body, '--out-dir', outDir]);
+  const drawn = sent.every(({ zone, rows }, i) => {
+    const got = res.zones[i];
+    if (!got || got.x !== zone.x || got.y !== zone.y || got.w !== zone.w || got.h !== zone.h) return false;
+    const image = parseBMP1(fs.readFileSync(path.join(outDir, `zone-${i}.bmp`)));
+    const want = Buffer.from(rows);
+    const tail = zone.w % 8;
+    if (tail) for (let y = 0; y < zone.h; y++) image.pixels[y * image.rowBytes + image.rowBytes - 1] |= 0xFF >> tail;
+    return image.width === zone.w && image.height === zone.h && image.pixels.equals(want);
+  });
+  check(`${name}: ${sent.length} zones drawn pixel-exact`, res.ok && res.zonesDrawn === sent.length && drawn,
+    `${res.zones.map(z => `${z.w}x${z.h}`).join(', ') || 'empty body'}`);
+}
+
+sendDelta('every-zone', [
+  { zone: { x: 12, y: 16, w: 320, h: 80 }, rows: packedRows(320, 80, 1) },
+  { zone: { x: 8, y: 132, w: 784, h: 54 }, rows: packedRows(784, 54, 2) },
+  { zone: { x: 0, y: 448, w: 800, h: 32 }, rows: packedRows(800, 32, 3) }
+]);
+sendDelta('empty-body', []);
+sendDelta('odd-geometry', [{ zone: { x: 13, y: 7, w: 77, h: 19 }, rows: packedRows(77, 19, 4) }]);
+
+// The server's own delta, as the zone firmware would receive it
+{
+  const body = path.join(workDir, 'server.cczf');
+  fs.writeFileSync(body, Buffer.concat(full.frames));
+  fs.mkdirSync(path.join(workDir, 'server'));
+  const res = runDevice(['--delta', body, '--out-dir', path.join(workDir, 'server')]);
+  check('renderZoneDelta() body decodes on the device', res.ok && res.zonesDrawn === full.frames.length,
+    `${res.zonesDrawn} zones`);
+}
+
+fs.rmSync(workDir, { recursive: true, force: true });
+if (!process.env.CC_ZONESYNC_CHECK) fs.rmSync(device, { force: true });
+
+if (failures > 0) {
+  console.log(`\n❌ ${failures} checks failed`);
+  process.exit(1);
+}
+console.log('\n✅ All zone sync checks passed');
@@ -0,0 +1,278 @@
+#!/usr/bin/env python3
+
+"""
+CommuteCompute™
+Smart Transit Display for Australian Public Transport
+
+Copyright © 2025-2026 Angus Bergman
+
+This file is part of CommuteCompute, licensed under AGPL-3.0-or-later.
+See LICENCE file for details.
+
+SPDX-License-Identifier: AGPL-3.0-or-later
+"""
+
+"""
+BLE Frame Push - send dashboard frames to CCFirm without WiFi
+
+Pushes compressed zone frames (CCZF, see firmware/include/frame-codec.h)
+over the optional BLE frame-push characteristic (firmware built with
+-D CC_BLE_FRAME_PUSH, env ccfirm-trmnl-blepush). The device decodes them
+into the same shadow framebuffer as HTTP fetches and refreshes the panel.
+
+Each push is timed and reported:
+  - air throughput (payload bytes / time from first to last write)
+  - frame latency (first write -> device "frame:" notification)
+  - device-side receive+decode and panel refresh times
+
+Usage:
+  python3 ble_frame_push.py --bmp dashboard.bmp
+  python3 ble_frame_push.py --url "https://your-server/api/screen?demo=normal&format=cczf"
+  python3 ble_frame_push.py --url "https://your-server/api/screen?format=bmp" --repeat 10 --json
+
+Requires: pip install bleak
+"""
+
+import argparse
+import asyncio
+import json
+import statistics
+import struct
+import sys
+import time
+import urllib.request
+
+SERVICE_UUID = "cc000001-0000-1000-8000-00805f9b34fb"
+FRAME_UUID = "cc000007-0000-1000-8000-00805f9b34fb"
+FRAME_STATUS_UUID = "cc000008-0000-1000-8000-00805f9b34fb"
+
+FRAME_FLAG_REFRESH = 0x01
+FRAME_FLAG_FULL = 0x02
+
+
+# ============================================================================
+# CCZF ENCODER (mirrors src/services/frame-codec.js)
+# ============================================================================
+
+def pack_bits(src):
+    """PackBits compression"""
+    out = bytearray()
+    i, n = 0, len(src)
+    while i < n:
+        run = 1
+        while i + run < n and run < 128 and src[i + run] == src[i]:
+            run += 1
+        if run >= 3 or (run == 2 and i + run == n):
+            out += bytes(((257 - run) & 0xFF, src[i]))
+            i += run
+            continue
+        start, lit = i, 0
+        while i < n and lit < 128:
+            if i + 2 < n and src[i] == src[i + 1] == src[i + 2]:
+                break
+            i += 1
+            lit += 1
+        out.append(lit - 1)
+        out += src[start:start + lit]
+    return bytes(out)
+
+
+def parse_bmp1(data):
+    """1-bit BMP -> (width, height, row_bytes, packed top-down rows, bit=1 white)"""
+    if data[:2] != b"BM":
+        raise ValueError("Not a BMP")
+    pixel_offset, dib_size = struct.unpack_from("<II", data, 10)
+    width, raw_height, _planes, bpp, compression = struct.unpack_from("<iiHHI", data, 18)
+    if bpp != 1 or compression != 0:
+        raise ValueError("Only uncompressed 1-bit BMPs are supported")
+    height = abs(raw_height)
+    stride = ((width + 31) // 32) * 4
+    row_bytes = (width + 7) // 8
+    pal = 14 + dib_size
+    invert = sum(data[pal:pal + 3]) > sum(data[pal + 4:pal + 7])
+
+    pixels = bytearray()
+    for y in range(height):
+        file_row = y if raw_height < 0 else height - 1 - y
+        start = pixel_offset + file_row * stride
+        row = data[start:start + row_bytes]
+        pixels += bytes(b ^ 0xFF for b in row) if invert else row
+    return width, height, row_bytes, bytes(pixels)
+
+
+def push_bands(width, height):
+    """Full-width V12 bands: header, status bar, legs, footer"""
+    return [(0, 0, width, 96), (0, 96, width, 32), (0, 128, width, height - 160), (0, height - 32, width, 32)]
+
+
+def encode_frames(bmp, previous=None, full=False):
+    """Encode a BMP into CCZF zone frames, skipping bands unchanged since previous"""
+    width, height, row_bytes, pixels = parse_bmp1(bmp)
+    prev = parse_bmp1(previous) if previous else None
+    changed = []
+    for (x, y, w, h) in push_bands(width, height):
+        # Bands are full-width, so rows can be sliced directly
+        rows = pixels[y * row_bytes:(y + h) * row_bytes]
+        if prev and prev[:2] == (width, height) and prev[3][y * row_bytes:(y + h) * row_bytes] == rows:
+            continue
+        changed.append((x, y, w, h, rows))
+
+    frames = []
+    for idx, (x, y, w, h, rows) in enumerate(changed):
+        flags = 0
+        if idx == len(changed) - 1:
+            flags = FRAME_FLAG_REFRESH | (FRAME_FLAG_FULL if full else 0)
+        payload = pack_bits(rows)
+        frames.append(b"CCZF" + struct.pack("<BBHHHHI", 1, flags, x, y, w, h, len(payload)) + payload)
+    return frames
+
+
+# ============================================================================
+# BLE PUSH
+# ============================================================================
+
+class FramePusher:
+    def __init__(self, name_prefix="CommuteCompute", address=None):
+        self.name_prefix = name_prefix
+        self.address = address
+        self.client = None
+        self.status_queue = asyncio.Queue()
+
+    async def connect(self):
+        from bleak import BleakClient, BleakScanner
+
+        if self.address:
+            device = self.address
+        else:
+            print(f"Scanning for {self.name_prefix}-*...")
+            device = await BleakScanner.find_device_by_filter(
+                lambda d, _adv: (d.name or "").startswith(self.name_prefix), timeout=15.0)
+            if not device:
+                raise RuntimeError("No CommuteCompute device found - is it in setup mode or a WiFi outage window?")
+            print(f"Found {device.name} ({device.address})")
+
+        self.client = BleakClient(device)
+        await self.client.connect()
+        await self.client.start_notify(FRAME_STATUS_UUID, self._on_status)
+        print(f"Connected, ATT payload size {self.chunk_size} bytes")
+
+    @property
+    def chunk_size(self):
+        # Write-without-response payload = MTU - 3
+        char = self.client.services.get_characteristic(FRAME_UUID)
+        return max(20, char.max_write_without_response_size)
+
+    def _on_status(self, _char, data):
+        self.status_queue.put_nowait((time.perf_counter(), data.decode(errors="replace")))
+
+    async def push(self, frames, timeout=30.0):
+        data = b"".join(frames)
+        chunk = self.chunk_size
+
+        start = time.perf_counter()
+        for i in range(0, len(data), chunk):
+            await self.client.write_gatt_char(FRAME_UUID, data[i:i + chunk], response=False)
+        sent = time.perf_counter()
+
+        while True:
+            stamp, status = await asyncio.wait_for(self.status_queue.get(), timeout)
+            if status.startswith("frame:") or status.startswith("err:"):
+                break
+
+        result = {
+            "bytes": len(data),
+            "zones": len(frames),
+            "write_ms": round((sent - start) * 1000, 1),
+            "latency_ms": round((stamp - start) * 1000, 1),
+            "throughput_kBps": round(len(data) / max(sent - start, 1e-6) / 1024, 1),
+            "status": status,
+        }
+        if status.startswith("frame:"):
+            _, dev_bytes, decode_ms, panel_ms = status.split(":")
+            result.update(device_bytes=int(dev_bytes), device_rx_decode_ms=int(decode_ms),
+                          device_panel_ms=int(panel_ms))
+        return result
+
+    async def disconnect(self):
+        if self.client:
+            await self.client.disconnect()
+
+
+def load_source(args):
+    """Returns (kind, bytes) - kind is 'bmp' or 'cczf'"""
+    if args.bmp:
+        with open(args.bmp, "rb") as f:
+            return "bmp", f.read()
+    with urllib.request.urlopen(args.url, timeout=30) as resp:
+        body = resp.read()
+    return ("bmp" if body[:2] == b"BM" else "cczf"), body
+
+
+async def run(args):
+    pusher = FramePusher(args.name, args.address)
+    await pusher.connect()
+    results = []
+    previous = None
+    try:
+        for n in range(args.repeat):
+            kind, body = load_source(args)
+            if kind == "bmp":
+                frames = encode_frames(body, previous if args.changed_only else None, full=(n == 0))
+                previous = body
+                raw = len(body)
+            else:
+                frames = [body]
+                raw = None
+            if not frames:
+                print(f"[{n + 1}] No changed zones - skipped")
+                continue
+
+            result = await pusher.push(frames)
+            if raw:
+                result["compression"] = round(raw / result["bytes"], 1)
+            results.append(result)
+            print(f"[{n + 1}] {result['bytes']} B in {result['write_ms']} ms "
+                  f"({result['throughput_kBps']} kB/s), frame latency {result['latency_ms']} ms, "
+                  f"status {result['status']}")
+            if n + 1 < args.repeat:
+                await asyncio.sleep(args.interval)
+    finally:
+        await pusher.disconnect()
+
+    ok = [r for r in results if r["status"].startswith("frame:")]
+    summary = {"pushes": len(results), "ok": len(ok)}
+    if ok:
+        summary.update(
+            throughput_kBps_median=statistics.median(r["throughput_kBps"] for r in ok),
+            latency_ms_median=statistics.median(r["latency_ms"] for r in ok),
+            latency_ms_max=max(r["latency_ms"] for r in ok),
+            panel_ms_median=statistics.median(r["device_panel_ms"] for r in ok),
+        )
+    if args.json:
+        print(json.dumps({"results": results, "summary": summary}, indent=2))
+    else:
+        print("Summary:", summary)
+    return 0 if len(ok) == len(results) else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Push dashboard frames to CCFirm over BLE")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--bmp", help="1-bit BMP file to push")
+    source.add_argument("--url", help="Server URL returning a BMP (format=bmp) or CCZF (format=cczf)")
+    parser.add_argument("--name", default="CommuteCompute", help="BLE name prefix")
+    parser.add_argument("--address", help="Connect to this BLE address instead of scanning")
+    parser.add_argument("--repeat", type=int, default=1, help="Number of pushes (benchmark)")
+    parser.add_argument("--interval", type=float, default=2.0, help="Seconds between pushes")
+    parser.add_argument("--changed-only", action="store_true", help="Only push bands that changed since the last push")
+    parser.add_argument("--json", action="store_true", help="Print a JSON report")
+    args = parser.parse_args()
+
+    try:
+        sys.exit(asyncio.run(run(args)))
+    except KeyboardInterrupt:
+        sys.exit(130)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,155 @@
+/**
+ * CommuteCompute™
+ * Smart Transit Display for Australian Public Transport
+ *
+ * Copyright © 2025-2026 Angus Bergman
+ *
+ * This file is part of CommuteCompute.
+ *
+ * CommuteCompute is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CommuteCompute is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with CommuteCompute. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+/**
+ * Stand-in UDP freshness responder (src/services/fresh-check.js)
+ *
+ * Answers device queries with scripted results instead of looking at real
+ * frames, so the firmware's check/fallback paths and "bench fresh" can be
+ * exercised on a LAN without the server, KV or pre-renderer:
+ *   - the first query from a device sets its "current" hashes to what it
+ *     sent (so it is answered unchanged)
+ *   - every --change-every'th query reports zone 0 changed (default 5),
+ *     then the device's next query is adopted afresh
+ *   - --drop PCT silently drops that share of queries (no-reply fallback)
+ *   - --unknown answers every query "unknown device"
+ * Tags are real: set WEBHOOK_SECRET to the server's so paired devices'
+ * PSKs verify. Point a device at it with FRESH_ENDPOINT=<lan-ip>:<port>
+ * when pairing.
+ *
+ * Usage:
+ *   WEBHOOK_SECRET=... node tools/fresh-responder.mjs [--port 5684]
+ *     [--change-every N] [--drop PCT] [--unknown]
+ */
+
+import dgram from 'dgram';
+import { fileURLToPath } from 'url';
+import { answerFreshQuery, decodeFreshQuery, FRESH_STATUS } from '../src/services/fresh-check.js';
+
+export const DEFAULT_FRESH_PORT = 5684;
+
+const STATUS_NAMES = ['unchanged', 'changed', 'unknown'];
+
+/**
+ * Bound stand-in responder
+ * @param {object} [options]
+ * @param {number} [options.port] - 0 picks a free port
+ * @param {number} [options.changeEvery] - Change a zone every N queries (0 = never)
+ * @param {number} [options.dropPercent]
+ * @param {boolean} [options.unknown]
+ * @param {boolean} [options.quiet]
+ * @returns {Promise<{socket: dgram.Socket, port: number, counts: object, close: function}>}
+ */
+export function startStandInResponder({
+  port = DEFAULT_FRESH_PORT,
+  changeEvery = 5,
+  dropPercent = 0,
+  unknown = false,
+  quiet = false
+} = {}) {
+  const devices = new Map();          // deviceId -> current hashes
+  const counts = { queries: 0, dropped: 0, unchanged: 0, changed: 0, unknown: 0, rejected: 0 };
+  let pending = null;                 // Hashes of the query being answered
+
+  const lookup = async (deviceId) => {
+    if (unknown) return null;
+    let current = devices.get(deviceId);
+    if (!current) {
+      current = pending.length ? [...pending] : [1];
+      devices.set(deviceId, current);
+    }
+    if (changeEvery > 0 && counts.queries % changeEvery === 0) {
+      // One-shot: the device then fetches for real and its next query
+      // (with the real server's hashes) is adopted again
+      devices.delete(deviceId);
+      return [(current[0] + 1) >>> 0, ...current.slice(1)];
+    }
+    return current;
+  };
+
+  const socket = dgram.createSocket('udp4');
+  socket.on('message', async (msg, from) => {
+    const query = decodeFreshQuery(msg);
+    counts.queries++;
+    if (dropPercent > 0 && Math.random() * 100 < dropPercent) {
+      counts.dropped++;
+      if (!quiet) console.log(`[stand-in] ${from.address} dropped`);
+      return;
+    }
+    const started = process.hrtime.bigint();
+    pending = query?.hashes || [];
+    const reply = await answerFreshQuery(msg, lookup);
+    const us = Number(process.hrtime.bigint() - started) / 1000;
+    if (!reply) {
+      counts.rejected++;
+      if (!quiet) console.log(`[stand-in] ${from.address} bad query (${msg.length} B) - no reply`);
+      return;
+    }
+    const status = reply[2];
+    counts[STATUS_NAMES[status]]++;
+    socket.send(reply, from.port, from.address);
+    if (!quiet) {
+      const mask = reply.readUInt32LE(8).toString(16).padStart(8, '0');
+      console.log(`[stand-in] ${query.identity} ${query.deviceId} ${query.hashes.length} zones -> ` +
+        `${STATUS_NAMES[status]}${status === FRESH_STATUS.CHANGED ? ` 0x${mask}` : ''} (${us.toFixed(0)} us)`);
+    }
+  });
+
+  return new Promise((resolve, reject) => {
+    socket.once('error', reject);
+    socket.bind(port, () => {
+      resolve({
+        socket,
+        port: socket.address().port,
+        counts,
+        close: () => new Promise(done => socket.close(done))
+      });
+    });
+  });
+}
+
+function parseArgs(argv) {
+  const options = {};
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === '--port') options.port = Number.parseInt(argv[++i], 10);
+    else if (arg === '--change-every') options.changeEvery = Number.parseInt(argv[++i], 10);
+    else if (arg === '--drop') options.dropPercent = Number.parseFloat(argv[++i]);
+    else if (arg === '--unknown') options.unknown = true;
+    else throw new Error(`Unknown option ${arg}`);
+  }
+  return options;
+}
+
+if (process.argv[1] === fileURLToPath(import.meta.url)) {
+  if (!process.env.WEBHOOK_SECRET) {
+    console.warn('⚠️  WEBHOOK_SECRET not set - only devices paired with the fallback key will verify');
+  }
+  const { port, counts } = await startStandInResponder(parseArgs(process.argv.slice(2)));
+  console.log(`📡 Stand-in freshness responder on UDP port ${port}`);
+  process.on('SIGINT', () => {
+    console.log(`\n${JSON.stringify(counts)}`);
+    process.exit(0);
+  });
+}
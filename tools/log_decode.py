@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+
+"""
+CommuteCompute™
+Smart Transit Display for Australian Public Transport
+
+Copyright © 2025-2026 Angus Bergman
+
+This file is part of CommuteCompute, licensed under AGPL-3.0-or-later.
+See LICENCE file for details.
+
+SPDX-License-Identifier: AGPL-3.0-or-later
+"""
+
+"""
+CCFirm Log Decoder - turn binary log dumps back into text
+
+CCFirm logs with CCLOG_x() (firmware/include/log-ring.h): each record holds
+the address of its format string plus raw argument values, kept in an RTC
+ring that survives resets. A dump (logring_dump_binary) prints a hex block
+between CCLOG-BEGIN and CCLOG-END lines; this tool finds that block in a
+serial capture, reads the format strings out of the matching firmware.elf
+and formats each record.
+
+Usage:
+  python3 log_decode.py --elf .pio/build/ccfirm-trmnl-7.1.0/firmware.elf serial.log
+  python3 serial_monitor.py --log serial.log   # capture, then decode
+  pio device monitor | python3 log_decode.py --elf firmware.elf -
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# Argument type tags (match LogArgType in log-ring.h)
+LOGARG_I32, LOGARG_U32, LOGARG_I64, LOGARG_U64 = 1, 2, 3, 4
+LOGARG_F32, LOGARG_STR_ROM, LOGARG_STR, LOGARG_PTR = 5, 6, 7, 8
+
+LEVELS = {1: 'E', 2: 'W', 3: 'I', 4: 'D'}
+SPEC_RE = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t|L)?([diuxXocspfFeEgG%])')
+
+
+class Elf:
+    """Minimal ELF reader: maps addresses of allocated sections to file bytes"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError(f'{path} is not an ELF file')
+        is64 = self.data[4] == 2
+        if self.data[5] != 1:
+            raise ValueError('Only little-endian ELF files are supported')
+        if is64:
+            shoff, = struct.unpack_from('<Q', self.data, 0x28)
+            shentsize, shnum = struct.unpack_from('<HH', self.data, 0x3A)
+        else:
+            shoff, = struct.unpack_from('<I', self.data, 0x20)
+            shentsize, shnum = struct.unpack_from('<HH', self.data, 0x2E)
+
+        self.sections = []
+        for i in range(shnum):
+            base = shoff + i * shentsize
+            if is64:
+                _, sh_type, flags, addr, offset, size = struct.unpack_from('<IIQQQQ', self.data, base)
+            else:
+                _, sh_type, flags, addr, offset, size = struct.unpack_from('<IIIIII', self.data, base)
+            # SHF_ALLOC with file contents (not SHT_NOBITS)
+            if flags & 0x2 and sh_type != 8 and size:
+                self.sections.append((addr, size, offset))
+
+    def string_at(self, addr):
+        for start, size, offset in self.sections:
+            if start <= addr < start + size:
+                pos = offset + (addr - start)
+                end = self.data.find(b'\0', pos, offset + size)
+                return self.data[pos:end if end >= 0 else offset + size].decode('utf-8', 'replace')
+        return None
+
+
+def fnv1a(text):
+    h = 0x811c9dc5
+    for b in text.encode():
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def find_dumps(lines):
+    """Yield (header fields, payload bytes) for each CCLOG block"""
+    header, hexdata = None, []
+    for line in lines:
+        line = line.strip()
+        if line.startswith('CCLOG-BEGIN'):
+            header, hexdata = line.split()[1:], []
+        elif line.startswith('CCLOG-END') and header is not None:
+            yield header, bytes.fromhex(''.join(hexdata))
+            header = None
+        elif header is not None and re.fullmatch(r'[0-9a-fA-F]+', line):
+            hexdata.append(line)
+
+
+def parse_args(payload, pos, end, argc, ptr_size, elf):
+    args = []
+    ptr_fmt = '<I' if ptr_size == 4 else '<Q'
+    for _ in range(argc):
+        if pos >= end:
+            break
+        kind = payload[pos]
+        pos += 1
+        if kind == LOGARG_I32:
+            value, = struct.unpack_from('<i', payload, pos); pos += 4
+        elif kind == LOGARG_U32:
+            value, = struct.unpack_from('<I', payload, pos); pos += 4
+        elif kind == LOGARG_I64:
+            value, = struct.unpack_from('<q', payload, pos); pos += 8
+        elif kind == LOGARG_U64:
+            value, = struct.unpack_from('<Q', payload, pos); pos += 8
+        elif kind == LOGARG_F32:
+            value, = struct.unpack_from('<f', payload, pos); pos += 4
+        elif kind == LOGARG_STR_ROM:
+            addr, = struct.unpack_from(ptr_fmt, payload, pos); pos += ptr_size
+            value = (elf.string_at(addr) if elf else None) or f'<str@0x{addr:x}>'
+        elif kind == LOGARG_STR:
+            n = payload[pos]
+            value = payload[pos + 1:pos + 1 + n].decode('utf-8', 'replace')
+            pos += 1 + n
+        elif kind == LOGARG_PTR:
+            value, = struct.unpack_from(ptr_fmt, payload, pos); pos += ptr_size
+        else:
+            break
+        args.append(value)
+    return args
+
+
+def format_record(fmt, args):
+    """printf-style formatting with the subset CCFirm uses"""
+    out, i = [], 0
+    pos = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, _, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        if i >= len(args):
+            out.append('<?>')
+            continue
+        value = args[i]
+        i += 1
+        try:
+            if conv == 'p':
+                out.append(f'0x{int(value):x}')
+            elif conv in 'diuxXoc':
+                out.append(('%' + flags + ('d' if conv in 'iu' else conv)) % int(value))
+            elif conv == 's':
+                out.append(('%' + flags + 's') % value)
+            else:
+                out.append(('%' + flags + conv) % float(value))
+        except (TypeError, ValueError):
+            out.append(f'<{value!r}>')
+    out.append(fmt[pos:])
+    return ''.join(out).rstrip('\n')
+
+
+def decode_dump(header, payload, elf):
+    version, ptr_size = int(header[0]), int(header[1])
+    build_tag, build_hash = int(header[2], 16), int(header[3], 16)
+    boots, dropped, length = (int(x) for x in header[4:7])
+    if version != 1:
+        raise ValueError(f'Unsupported log version {version}')
+
+    print(f'--- log: {length} bytes, {dropped} dropped, boot {boots} ---')
+    if elf:
+        tag = elf.string_at(build_tag)
+        if tag is None or fnv1a(tag) != build_hash:
+            print('!!! ELF does not match the firmware that wrote this log - format strings will be wrong')
+
+    hdr_fmt = '<HBBI' + ('I' if ptr_size == 4 else 'Q')
+    hdr_size = struct.calcsize(hdr_fmt)
+    pos = 0
+    while pos + hdr_size <= len(payload):
+        rec_len, level, argc, ms, fmt_addr = struct.unpack_from(hdr_fmt, payload, pos)
+        if rec_len < hdr_size or pos + rec_len > len(payload):
+            print(f'!!! Corrupt record at offset {pos}')
+            break
+        args = parse_args(payload, pos + hdr_size, pos + rec_len, argc, ptr_size, elf)
+        fmt = elf.string_at(fmt_addr) if elf else None
+        if fmt is None:
+            text = f'<fmt@0x{fmt_addr:x}> ' + ' '.join(str(a) for a in args)
+        else:
+            text = format_record(fmt, args)
+        print(f'{ms:8d} {LEVELS.get(level, "D")} {text}')
+        pos += rec_len
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode CCFirm binary log dumps')
+    parser.add_argument('input', help='Serial capture containing CCLOG-BEGIN/END blocks (- for stdin)')
+    parser.add_argument('--elf', help='firmware.elf from the build that wrote the log')
+    args = parser.parse_args()
+
+    elf = Elf(args.elf) if args.elf else None
+    stream = sys.stdin if args.input == '-' else open(args.input, encoding='utf-8', errors='replace')
+    found = False
+    with stream:
+        for header, payload in find_dumps(stream):
+            found = True
+            decode_dump(header, payload, elf)
+    if not found:
+        print('No CCLOG-BEGIN/CCLOG-END block found', file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -335,14 +335,14 @@ class SetupWizard {
 
     this.log('Prerequisites:', 'yellow');
     this.log('   - USB-C cable', 'cyan');
-    this.log('   - ESP32 flash tool (esptool.py)', 'cyan');
-    this.log('   - TRMNL firmware file\n', 'cyan');
+    this.log('   - PlatformIO Core (pio)', 'cyan');
+    this.log('   - This repository (firmware/ directory)\n', 'cyan');
 
     this.log('Steps:', 'yellow');
-    this.log('   1. Install esptool: pip install esptool', 'cyan');
+    this.log('   1. Install PlatformIO: pip install platformio', 'cyan');
     this.log('   2. Connect TRMNL OG via USB-C', 'cyan');
-    this.log('   3. Put device in flash mode (hold BOOT button while connecting)', 'cyan');
-    this.log('   4. Run: esptool.py --port /dev/ttyUSB0 write_flash 0x0 firmware.bin', 'cyan');
+    this.log('   3. If it is not detected, hold BOOT while connecting (flash mode)', 'cyan');
+    this.log('   4. Run: cd firmware && pio run -e ccfirm-trmnl-byos -t upload', 'cyan');
     this.log('   5. Wait for "Hash of data verified" message', 'cyan');
     this.log('   6. Reset device\n', 'cyan');
 
@@ -352,13 +352,15 @@ class SetupWizard {
     this.log(`   - Display Resolution: ${device.resolution.width}×${device.resolution.height}`, 'cyan');
     this.log(`   - Orientation: ${device.orientation}\n`, 'cyan');
 
-    const firmwarePath = path.join(__dirname, 'firmware', 'trmnl-byos.ino');
-    const firmwareExists = await fs.access(firmwarePath).then(() => true).catch(() => false);
+    const platformioIni = path.join(__dirname, '..', '..', 'firmware', 'platformio.ini');
+    const firmwareEnv = '[env:ccfirm-trmnl-byos]';
+    const envExists = await fs.readFile(platformioIni, 'utf8')
+      .then(ini => ini.includes(firmwareEnv)).catch(() => false);
 
-    if (firmwareExists) {
-      this.log(`✅ Firmware file found: ${firmwarePath}`, 'green');
+    if (envExists) {
+      this.log(`✅ Firmware env found: ${firmwareEnv} in ${platformioIni}`, 'green');
     } else {
-      this.log(`⚠️  Firmware file not found. Create: ${firmwarePath}`, 'yellow');
+      this.log(`⚠️  ${firmwareEnv} not found in ${platformioIni}. Run the wizard from a full checkout.`, 'yellow');
     }
 
     await this.question('\nPress Enter when firmware is flashed...');
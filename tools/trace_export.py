@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+
+"""
+CommuteCompute™
+Smart Transit Display for Australian Public Transport
+
+Copyright © 2025-2026 Angus Bergman
+
+This file is part of CommuteCompute, licensed under AGPL-3.0-or-later.
+See LICENCE file for details.
+
+SPDX-License-Identifier: AGPL-3.0-or-later
+"""
+
+"""
+CCFirm Trace Export - turn execution trace dumps into Chrome trace JSON
+
+CCFirm built with -D CC_TRACE (firmware/include/trace-ring.h) records
+begin/end, instant and counter events per task into a RAM ring. `trace
+dump` on the serial shell (or `bench-pipeline --trace` on the host) prints
+the ring between CCTRACE-BEGIN and CCTRACE-END; this tool finds those
+blocks and writes a JSON trace that https://ui.perfetto.dev and
+chrome://tracing open as a timeline with one track per task. Each dump
+becomes its own process on the timeline.
+
+Usage:
+  python3 trace_export.py serial.log -o refresh.json
+  pio device monitor | python3 trace_export.py - -o cycle.json   # type `trace dump`, then Ctrl-C
+  .pio/build/native-bench/program --trace trace.txt && python3 trace_export.py trace.txt -o bench.json
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+RECORD = struct.Struct('<IBBBxI')   # match trace_dump() in trace-ring.h
+PHASES = {ord('B'): 'B', ord('E'): 'E', ord('i'): 'i', ord('C'): 'C'}
+
+
+def find_dumps(lines):
+    """Yield (header fields, task names, event names, payload bytes) for each CCTRACE block"""
+    header = None
+    for line in lines:
+        line = line.strip()
+        if line.startswith('CCTRACE-BEGIN'):
+            header, tasks, names, hexdata = line.split()[1:], {}, {}, []
+        elif header is None:
+            continue
+        elif line.startswith('CCTRACE-END'):
+            yield header, tasks, names, bytes.fromhex(''.join(hexdata))
+            header = None
+        elif line.startswith('CCTRACE-TASK '):
+            _, tid, name = line.split(' ', 2)
+            tasks[int(tid)] = name
+        elif line.startswith('CCTRACE-NAME '):
+            _, index, name = line.split(' ', 2)
+            names[int(index)] = name
+        elif re.fullmatch(r'[0-9a-fA-F]+', line) and len(line) % 2 == 0:
+            hexdata.append(line)
+
+
+def export_dump(pid, header, tasks, names, payload, summary):
+    """Chrome trace events for one dump, timestamps from its first event"""
+    version, count, dropped = (int(x) for x in header[:3])
+    if version != 1:
+        raise ValueError(f'Unsupported trace version {version}')
+
+    # Unwrap the u32 microsecond clock; the ring is in claim order, which
+    # may lag the clock by a few us across cores, so sort afterwards
+    events, last_raw, now = [], None, 0
+    for pos in range(0, len(payload) - RECORD.size + 1, RECORD.size):
+        us, kind, tid, index, arg = RECORD.unpack_from(payload, pos)
+        if last_raw is not None:
+            delta = (us - last_raw) & 0xFFFFFFFF
+            now += delta - (1 << 32) if delta >= 1 << 31 else delta
+        last_raw = us
+        events.append((now, len(events), PHASES.get(kind), tid, names.get(index, '?'), arg))
+    events.sort()
+    start = events[0][0] if events else 0
+
+    label = f'CCFirm trace {pid}' + (f' ({dropped} dropped)' if dropped else '')
+    out = [{'ph': 'M', 'pid': pid, 'name': 'process_name', 'args': {'name': label}}]
+    for tid, name in sorted(tasks.items()):
+        out.append({'ph': 'M', 'pid': pid, 'tid': tid, 'name': 'thread_name', 'args': {'name': name}})
+        out.append({'ph': 'M', 'pid': pid, 'tid': tid, 'name': 'thread_sort_index', 'args': {'sort_index': tid}})
+
+    # Spans must nest per track: an end whose begin was overwritten is
+    # dropped, a begin still open at the end of the dump is closed there
+    open_spans = {}
+    for ts, _, ph, tid, name, arg in events:
+        ts -= start
+        if ph is None:
+            continue
+        event = {'ph': ph, 'pid': pid, 'tid': tid, 'name': name, 'ts': ts}
+        if ph == 'B':
+            open_spans.setdefault(tid, []).append((name, ts))
+        elif ph == 'E':
+            stack = open_spans.get(tid, [])
+            if not stack or stack[-1][0] != name:
+                continue
+            summary.setdefault((tasks.get(tid, str(tid)), name), []).append(ts - stack.pop()[1])
+        elif ph == 'i':
+            event['s'] = 't'
+            if arg:
+                event['args'] = {'arg': arg}
+        elif ph == 'C':
+            event['args'] = {'value': arg}
+        out.append(event)
+    end = events[-1][0] - start if events else 0
+    for tid, stack in open_spans.items():
+        for name, _ in reversed(stack):
+            out.append({'ph': 'E', 'pid': pid, 'tid': tid, 'name': name, 'ts': end, 'args': {'open': True}})
+
+    print(f'dump {pid}: {count} events, {dropped} dropped, {end / 1000:.1f} ms', file=sys.stderr)
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Export CCFirm trace dumps as Chrome/Perfetto JSON')
+    parser.add_argument('input', help='Serial capture containing CCTRACE-BEGIN/END blocks (- for stdin)')
+    parser.add_argument('-o', '--output', help='JSON file to write (default stdout)')
+    parser.add_argument('--summary', action='store_true', help='Print span count/avg/max per task and name')
+    args = parser.parse_args()
+
+    stream = sys.stdin if args.input == '-' else open(args.input, encoding='utf-8', errors='replace')
+    trace, summary, dumps = [], {}, 0
+    with stream:
+        for header, tasks, names, payload in find_dumps(stream):
+            dumps += 1
+            trace.extend(export_dump(dumps, header, tasks, names, payload, summary))
+    if not dumps:
+        print('No CCTRACE-BEGIN/CCTRACE-END block found', file=sys.stderr)
+        return 1
+
+    text = json.dumps({'traceEvents': trace, 'displayTimeUnit': 'ms'}, separators=(',', ':'))
+    if args.output:
+        with open(args.output, 'w', encoding='utf-8') as f:
+            f.write(text)
+    else:
+        print(text)
+
+    if args.summary:
+        print(f'{"task":<8} {"span":<24} {"count":>6} {"avg ms":>9} {"max ms":>9}', file=sys.stderr)
+        for (task, name), spans in sorted(summary.items()):
+            print(f'{task:<8} {name:<24} {len(spans):>6} {sum(spans) / len(spans) / 1000:>9.2f} '
+                  f'{max(spans) / 1000:>9.2f}', file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())